@@ -0,0 +1,304 @@
+// This file is part of the AMD Work Graph Ivy Generation Sample.
+//
+// Copyright (c) 2024 Advanced Micro Devices, Inc. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+// Compares the 3x4 affine transform chains of cpu/affinemath.h against the float4x4 versions of cpu/ivyutils.h,
+// which follow shaders/utils.hlsl.
+//
+// Usage: IvyAffineBenchmark [options]
+//   --count <count>    number of random ivy transforms (default 1000000)
+//   --max-ulp <ulp>    largest accepted difference to the float4x4 reference (default 0)
+// Exits with 1 if any element differs by more than --max-ulp, -0 & +0 are one ulp apart, so the default compares the
+// bit patterns. The error of both versions against a double precision evaluation is reported for comparison.
+
+#include "cpu/affinemath.h"
+#include "cpu/ivycpuengine.h"
+#include "cpu/ivyjson.h"
+#include "cpu/ivyutils.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+struct BenchmarkOptions
+{
+    uint32_t Count  = 1000000;
+    uint32_t MaxUlp = 0;
+};
+
+static bool ParseOptions(int argc, char** argv, BenchmarkOptions& options)
+{
+    for (int i = 1; i < argc; ++i)
+    {
+        const bool hasValue = (i + 1 < argc);
+        if (!strcmp(argv[i], "--count") && hasValue)
+        {
+            options.Count = static_cast<uint32_t>(strtoul(argv[++i], nullptr, 10));
+        }
+        else if (!strcmp(argv[i], "--max-ulp") && hasValue)
+        {
+            options.MaxUlp = static_cast<uint32_t>(strtoul(argv[++i], nullptr, 10));
+        }
+        else
+        {
+            fprintf(stderr, "unknown option %s\n", argv[i]);
+            return false;
+        }
+    }
+    return true;
+}
+
+// Inputs of the transform chains used by IvyBranch for one iteration
+struct ChainInput
+{
+    float3 Origin;
+    float3 Forward;
+    float3 Up;
+    float  Angles[5];
+    float  StemScale;
+    float  LeafOffset;
+};
+
+// Outputs: stem, leaf & next iteration transforms
+struct ChainOutput
+{
+    float3x4 Transforms[3];
+};
+
+static ChainInput GenerateInput(uint32_t index)
+{
+    auto random = [index](uint32_t key) { return Random(7, index, key) * 2.f - 1.f; };
+
+    ChainInput input;
+    input.Origin  = float3(random(0), random(1), random(2)) * 10.f;
+    input.Forward = float3(random(3), random(4), random(5));
+    input.Up      = float3(random(6), random(7), random(8));
+    for (uint32_t i = 0; i < 5; ++i)
+    {
+        input.Angles[i] = random(9 + i) * PI;
+    }
+    input.StemScale  = Random(7, index, 14);
+    input.LeafOffset = Random(7, index, 15) * ivyStemLength;
+
+    // Every fourth chain is axis aligned with zero angles, like the walls & floors of a scene. Most elements are
+    // then exact zeros of either sign, which the affine kernels have to reproduce.
+    if ((index % 4) == 3)
+    {
+        const float sign = (random(16) < 0.f) ? -1.f : 1.f;
+        input.Origin.y   = 0.f;
+        input.Forward    = float3(0, 0, sign);
+        input.Up         = float3(0, -sign, 0);
+        for (uint32_t i = 0; i < 5; ++i)
+        {
+            input.Angles[i] = (random(17 + i) < 0.f) ? 0.f : input.Angles[i];
+        }
+    }
+    return input;
+}
+
+static ChainOutput EvaluateFloat4x4(const ChainInput& input)
+{
+    const float4x4 transform = mmul(Translate(input.Origin), Rotate(input.Forward, input.Up), RotateY(input.Angles[0]), RotateZ(0.2f));
+
+    ChainOutput output;
+    output.Transforms[0] = float3x4(mmul(transform, RotateX(input.Angles[1]), Scale(input.StemScale, 1.f, 1.f)));
+    output.Transforms[1] = float3x4(mmul(transform, Translate(input.LeafOffset, 0, 0), RotateY(input.Angles[2]), RotateZ(input.Angles[3])));
+    output.Transforms[2] = float3x4(mmul(transform, RotateY(input.Angles[4])));
+    return output;
+}
+
+static ChainOutput EvaluateAffine(const ChainInput& input)
+{
+    const float3x4 transform =
+        Affine::mmul(Affine::Translate(input.Origin), Affine::Rotate(input.Forward, input.Up), Affine::RotateY(input.Angles[0]), Affine::RotateZ(0.2f));
+
+    ChainOutput output;
+    output.Transforms[0] = Affine::mmul(transform, Affine::RotateX(input.Angles[1]), Affine::Scale(input.StemScale, 1.f, 1.f));
+    output.Transforms[1] =
+        Affine::mmul(transform, Affine::Translate(input.LeafOffset, 0, 0), Affine::RotateY(input.Angles[2]), Affine::RotateZ(input.Angles[3]));
+    output.Transforms[2] = Affine::mmul(transform, Affine::RotateY(input.Angles[4]));
+    return output;
+}
+
+// Double precision evaluation of the same chains, starting from the float rotation matrices
+static void EvaluateDouble(const ChainInput& input, double (&result)[3][3][4])
+{
+    struct Matrix
+    {
+        double m[4][4];
+    };
+
+    auto convert = [](const float4x4& a) {
+        Matrix result;
+        for (int row = 0; row < 4; ++row)
+        {
+            for (int column = 0; column < 4; ++column)
+            {
+                result.m[row][column] = a[row][column];
+            }
+        }
+        return result;
+    };
+
+    auto multiply = [](const Matrix& a, const Matrix& b) {
+        Matrix result;
+        for (int row = 0; row < 4; ++row)
+        {
+            for (int column = 0; column < 4; ++column)
+            {
+                result.m[row][column] = 0.0;
+                for (int k = 0; k < 4; ++k)
+                {
+                    result.m[row][column] += a.m[row][k] * b.m[k][column];
+                }
+            }
+        }
+        return result;
+    };
+
+    const Matrix transform = multiply(multiply(multiply(convert(Translate(input.Origin)), convert(Rotate(input.Forward, input.Up))),
+                                               convert(RotateY(input.Angles[0]))),
+                                      convert(RotateZ(0.2f)));
+
+    const Matrix outputs[3] = {
+        multiply(multiply(transform, convert(RotateX(input.Angles[1]))), convert(Scale(input.StemScale, 1.f, 1.f))),
+        multiply(multiply(multiply(transform, convert(Translate(input.LeafOffset, 0, 0))), convert(RotateY(input.Angles[2]))), convert(RotateZ(input.Angles[3]))),
+        multiply(transform, convert(RotateY(input.Angles[4]))),
+    };
+
+    for (int i = 0; i < 3; ++i)
+    {
+        for (int row = 0; row < 3; ++row)
+        {
+            for (int column = 0; column < 4; ++column)
+            {
+                result[i][row][column] = outputs[i].m[row][column];
+            }
+        }
+    }
+}
+
+// Distance in units in the last place. -0 is one ulp below +0, since Hash() of a transform sees the sign of zero.
+static uint32_t UlpDistance(float a, float b)
+{
+    auto ordered = [](float f) {
+        const int32_t bits = static_cast<int32_t>(asuint(f));
+        return (bits < 0) ? -static_cast<int64_t>(bits & INT32_MAX) - 1 : static_cast<int64_t>(bits);
+    };
+    return static_cast<uint32_t>(std::min<int64_t>(std::abs(ordered(a) - ordered(b)), UINT32_MAX));
+}
+
+// Error relative to the ulp of the largest element of a row, since near zero elements have no meaningful ulp error
+static double RowUlpError(const float4& row, const double (&reference)[4])
+{
+    const double magnitude = std::max({std::abs(reference[0]), std::abs(reference[1]), std::abs(reference[2]), std::abs(reference[3])});
+    const double ulp       = std::max(magnitude, static_cast<double>(FLT_MIN)) * FLT_EPSILON;
+
+    double error = 0.0;
+    for (int column = 0; column < 4; ++column)
+    {
+        error = std::max(error, std::abs(row[column] - reference[column]) / ulp);
+    }
+    return error;
+}
+
+int main(int argc, char** argv)
+{
+    BenchmarkOptions options;
+    if (!ParseOptions(argc, argv, options))
+    {
+        return 1;
+    }
+
+    std::vector<ChainInput> inputs(options.Count);
+    for (uint32_t i = 0; i < options.Count; ++i)
+    {
+        inputs[i] = GenerateInput(i);
+    }
+
+    std::vector<ChainOutput> referenceOutputs(options.Count);
+    std::vector<ChainOutput> affineOutputs(options.Count);
+
+    auto measure = [&](std::vector<ChainOutput>& outputs, ChainOutput (*evaluate)(const ChainInput&)) {
+        const auto startTime = std::chrono::steady_clock::now();
+        for (uint32_t i = 0; i < options.Count; ++i)
+        {
+            outputs[i] = evaluate(inputs[i]);
+        }
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+    };
+
+    const double referenceSeconds = measure(referenceOutputs, EvaluateFloat4x4);
+    const double affineSeconds    = measure(affineOutputs, EvaluateAffine);
+
+    uint32_t maxUlp         = 0;
+    uint64_t mismatches     = 0;
+    double   referenceError = 0.0;
+    double   affineError    = 0.0;
+    for (uint32_t i = 0; i < options.Count; ++i)
+    {
+        double exact[3][3][4];
+        EvaluateDouble(inputs[i], exact);
+
+        for (int transform = 0; transform < 3; ++transform)
+        {
+            for (int row = 0; row < 3; ++row)
+            {
+                const float4& referenceRow = referenceOutputs[i].Transforms[transform][row];
+                const float4& affineRow    = affineOutputs[i].Transforms[transform][row];
+
+                for (int column = 0; column < 4; ++column)
+                {
+                    const uint32_t ulp = UlpDistance(referenceRow[column], affineRow[column]);
+                    maxUlp             = std::max(maxUlp, ulp);
+                    mismatches += (ulp > options.MaxUlp) ? 1 : 0;
+                }
+
+                referenceError = std::max(referenceError, RowUlpError(referenceRow, exact[transform][row]));
+                affineError    = std::max(affineError, RowUlpError(affineRow, exact[transform][row]));
+            }
+        }
+    }
+
+    IvyJsonWriter json;
+    json.BeginObject();
+    json.Value("simd", ivySimdInstructionSet);
+    json.Value("transforms", options.Count);
+    json.Value("float4x4_seconds", referenceSeconds);
+    json.Value("affine_seconds", affineSeconds);
+    json.Value("affine_speedup", (affineSeconds > 0.0) ? referenceSeconds / affineSeconds : 0.0);
+    json.BeginObject("validation");
+    json.Value("max_ulp", maxUlp);
+    json.Value("accepted_ulp", options.MaxUlp);
+    json.Value("mismatches", mismatches);
+    json.Value("float4x4_max_row_ulp_error", referenceError);
+    json.Value("affine_max_row_ulp_error", affineError);
+    json.EndObject();
+    json.EndObject();
+
+    printf("%s\n", json.GetString().c_str());
+
+    return (mismatches == 0) ? 0 : 1;
+}
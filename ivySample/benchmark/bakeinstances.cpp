@@ -0,0 +1,521 @@
+// This file is part of the AMD Work Graph Ivy Generation Sample.
+//
+// Copyright (c) 2024 Advanced Micro Devices, Inc. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+// Bakes the ivy of static levels to a memory-mappable instance file (see cpu/ivybakedinstances.h), which the sample
+// uploads instead of running the work graph when BakedInstanceFile is set in config/ivysampleconfig.json.
+// The instances are generated by the CPU engine in the deterministic order and stored in the encoding of the instance
+// buffers, so baking is reproducible for any thread count.
+// Large levels can be baked to a chunked file instead (see cpu/ivyinstancechunks.h), which is streamed around the camera.
+//
+// Usage: IvyBake [options] [scene.gltf ...]
+//   --output <file>            bake the entry records created by IvyRenderModule::OnInit to file
+//   --check <file>             validate a baked file and compare it against a new generation for its entry records,
+//                              exits with 1 if the file is invalid or differs
+//   --format <baked|chunked>   file format (default baked)
+//   --chunk-size <count>       instances per chunk of a chunked file (default 4096)
+//   --chunk-encoding <name>    float4x4, float3x4 or quantized encoding of the chunks (default IVY_INSTANCE_ENCODING)
+//   --mesh-extent <extent>     object space half extent of the leaf & stem meshes for the chunk bounds (default 1)
+//   --stream-radius <radius>   --check of a chunked file also streams the chunks around every entry record with this radius (default 8)
+//   --threads <count>          worker threads, 0 = hardware concurrency (default 0)
+//   --impostor-atlas <file>    additionally bake the leaf impostor atlas of the leaf mesh (see cpu/ivyleafimpostoratlas.h) to a
+//                              TGA file for LeafImpostorAtlasFile, works without --output & --check
+// Scenes default to the ones loaded by the sample (config/ivysampleconfig.json).
+
+#include "benchmarkutils.h"
+
+#include "cpu/ivybakedinstances.h"
+#include "cpu/ivygltfdocument.h"
+#include "cpu/ivyinstancechunks.h"
+#include "cpu/ivyinstanceencoding.h"
+#include "cpu/ivyjson.h"
+#include "cpu/ivyleafimpostoratlas.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cinttypes>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+struct BakeOptions
+{
+    std::vector<std::string> Scenes;
+    std::string              OutputPath;
+    std::string              CheckPath;
+    bool                     Chunked      = false;
+    IvyInstanceChunkSettings ChunkSettings;
+    float                    StreamRadius = 8.f;
+    uint32_t                 ThreadCount  = 0;
+    std::string              ImpostorAtlasPath;
+};
+
+static bool ParseOptions(int argc, char** argv, BakeOptions& options)
+{
+    for (int i = 1; i < argc; ++i)
+    {
+        const bool hasValue = (i + 1 < argc);
+        if (!strcmp(argv[i], "--output") && hasValue)
+        {
+            options.OutputPath = argv[++i];
+        }
+        else if (!strcmp(argv[i], "--check") && hasValue)
+        {
+            options.CheckPath = argv[++i];
+        }
+        else if (!strcmp(argv[i], "--format") && hasValue)
+        {
+            const char* format = argv[++i];
+            if (strcmp(format, "baked") && strcmp(format, "chunked"))
+            {
+                fprintf(stderr, "unknown format %s\n", format);
+                return false;
+            }
+            options.Chunked = !strcmp(format, "chunked");
+        }
+        else if (!strcmp(argv[i], "--chunk-size") && hasValue)
+        {
+            options.ChunkSettings.ChunkCapacity = std::max(static_cast<uint32_t>(strtoul(argv[++i], nullptr, 10)), 1u);
+        }
+        else if (!strcmp(argv[i], "--chunk-encoding") && hasValue)
+        {
+            const char* encoding = argv[++i];
+            uint32_t    e        = 0;
+            while ((e <= IVY_INSTANCE_ENCODING_QUANTIZED) && strcmp(encoding, GetInstanceEncodingName(e)))
+            {
+                ++e;
+            }
+            if (e > IVY_INSTANCE_ENCODING_QUANTIZED)
+            {
+                fprintf(stderr, "unknown encoding %s\n", encoding);
+                return false;
+            }
+            options.ChunkSettings.Encoding = e;
+        }
+        else if (!strcmp(argv[i], "--mesh-extent") && hasValue)
+        {
+            const float extent                  = static_cast<float>(strtod(argv[++i], nullptr));
+            options.ChunkSettings.MeshExtent[0] = extent;
+            options.ChunkSettings.MeshExtent[1] = extent;
+        }
+        else if (!strcmp(argv[i], "--stream-radius") && hasValue)
+        {
+            options.StreamRadius = static_cast<float>(strtod(argv[++i], nullptr));
+        }
+        else if (!strcmp(argv[i], "--threads") && hasValue)
+        {
+            options.ThreadCount = static_cast<uint32_t>(strtoul(argv[++i], nullptr, 10));
+        }
+        else if (!strcmp(argv[i], "--impostor-atlas") && hasValue)
+        {
+            options.ImpostorAtlasPath = argv[++i];
+        }
+        else if (argv[i][0] == '-')
+        {
+            fprintf(stderr, "unknown option %s\n", argv[i]);
+            return false;
+        }
+        else
+        {
+            options.Scenes.push_back(argv[i]);
+        }
+    }
+
+    if ((options.OutputPath.empty() == options.CheckPath.empty()) && (!options.OutputPath.empty() || options.ImpostorAtlasPath.empty()))
+    {
+        fprintf(stderr, "either --output or --check is required, unless only --impostor-atlas is baked\n");
+        return false;
+    }
+
+    if (options.Scenes.empty())
+    {
+        options.Scenes = GetDefaultScenes();
+    }
+
+    return true;
+}
+
+// Generates & encodes the instances of the entry records like the sample would draw them
+static IvyBakedInstances Bake(IvyCpuEngine& engine, const std::vector<IvyBranchRecord>& branchRecords, const std::vector<IvyAreaRecord>& areaRecords,
+                              IvyInstanceStreams& output)
+{
+    engine.DispatchGraph(branchRecords, areaRecords, output);
+
+    IvyBakedInstances baked;
+    for (const IvyBranchRecord& record : branchRecords)
+    {
+        baked.BranchRecords.push_back(ToBakedEntryRecord(record));
+    }
+    for (const IvyAreaRecord& record : areaRecords)
+    {
+        baked.AreaRecords.push_back(ToBakedEntryRecord(record));
+    }
+    for (const IvyInstanceData& instance : output.LeafInstances)
+    {
+        baked.LeafInstances.push_back(IvyEncodeInstance(instance));
+    }
+    for (const IvyInstanceData& instance : output.StemInstances)
+    {
+        baked.StemInstances.push_back(IvyEncodeInstance(instance));
+    }
+    baked.Arguments[0] = output.Arguments[0];
+    baked.Arguments[1] = output.Arguments[1];
+
+    return baked;
+}
+
+static IvyChunkedInstances ToChunkedInstances(const IvyBakedInstances& baked, const IvyInstanceStreams& output)
+{
+    IvyChunkedInstances chunked;
+    chunked.BranchRecords            = baked.BranchRecords;
+    chunked.AreaRecords              = baked.AreaRecords;
+    chunked.Instances[0]             = output.LeafInstances;
+    chunked.Instances[1]             = output.StemInstances;
+    chunked.IndexCountPerInstance[0] = output.Arguments[0].IndexCountPerInstance;
+    chunked.IndexCountPerInstance[1] = output.Arguments[1].IndexCountPerInstance;
+    return chunked;
+}
+
+// Compares every chunk of the file against the chunks of a new generation & streams the chunks around each entry record
+static bool CheckChunkedFile(const IvyChunkedInstanceFile& file, const IvyChunkedInstances& generated, const IvyInstanceChunkSettings& settings,
+                             float streamRadius, IvyJsonWriter& json)
+{
+    const IvyChunkedInstanceHeader& header = file.GetHeader();
+
+    IvyInstanceChunkSettings fileSettings = settings;
+    fileSettings.ChunkCapacity            = header.ChunkCapacity;
+    fileSettings.Encoding                 = header.ChunkCount ? file.GetChunks()[0].Encoding : settings.Encoding;
+
+    // all chunks are loaded once, which validates the payload checksums
+    uint32_t    failedChunks = 0;
+    std::string error;
+    for (uint32_t i = 0; i < header.ChunkCount; ++i)
+    {
+        std::vector<IvyInstanceData> instances;
+        if (!file.LoadChunk(i, instances, &error))
+        {
+            fprintf(stderr, "%s\n", error.c_str());
+            ++failedChunks;
+        }
+    }
+
+    // bounds depend on the mesh extent of the bake, so only the instances are compared
+    const std::vector<IvyEncodedInstanceChunk> generatedChunks = IvyChunkedInstanceFile::BuildChunks(generated, fileSettings);
+
+    bool chunksMatch = (generatedChunks.size() == header.ChunkCount) && (generated.Instances[0].size() == header.InstanceCount[0]) &&
+                       (generated.Instances[1].size() == header.InstanceCount[1]);
+    for (uint32_t i = 0; chunksMatch && (i < header.ChunkCount); ++i)
+    {
+        const IvyInstanceChunk& chunk          = file.GetChunks()[i];
+        const IvyInstanceChunk& generatedChunk = generatedChunks[i].Chunk;
+        chunksMatch = (chunk.Stream == generatedChunk.Stream) && (chunk.InstanceCount == generatedChunk.InstanceCount) &&
+                      (chunk.Encoding == generatedChunk.Encoding) && (chunk.Checksum == generatedChunk.Checksum) &&
+                      (std::memcmp(file.GetChunkPayload(i), generatedChunks[i].Payload.data(), generatedChunks[i].Payload.size()) == 0);
+    }
+
+    json.Value("encoding", GetInstanceEncodingName(fileSettings.Encoding));
+    json.Value("chunk_capacity", header.ChunkCapacity);
+    json.Value("chunks", header.ChunkCount);
+    json.Value("failed_chunks", failedChunks);
+    json.Value("leaf_instances", header.InstanceCount[0]);
+    json.Value("stem_instances", header.InstanceCount[1]);
+    json.Value("matches_generation", chunksMatch);
+
+    // stream around every entry record, like a camera moving from root to root
+    std::vector<float3> positions;
+    for (uint32_t i = 0; i < header.BranchRecordCount + header.AreaRecordCount; ++i)
+    {
+        const float* transform = file.GetBranchRecords()[i].Transform;
+        positions.emplace_back(transform[12], transform[13], transform[14]);
+    }
+
+    IvyInstanceChunkStreamer streamer(file, IVY_MAX_INSTANCES);
+    uint64_t                 maxResidentInstances = 0;
+    uint64_t                 loadedBytes          = 0;
+    uint32_t                 loadedChunks         = 0;
+    uint32_t                 skippedChunks        = 0;
+    const auto               streamStartTime      = std::chrono::steady_clock::now();
+    for (const float3& position : positions)
+    {
+        const IvyInstanceChunkStreamer::Statistics& statistics = streamer.Update(position, streamRadius);
+        maxResidentInstances = std::max(maxResidentInstances, statistics.ResidentInstances[0] + statistics.ResidentInstances[1]);
+        loadedBytes += statistics.LoadedBytes;
+        loadedChunks += statistics.LoadedChunks;
+        skippedChunks += statistics.SkippedChunks;
+        failedChunks += statistics.FailedChunks;
+    }
+    const double streamSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - streamStartTime).count();
+
+    json.BeginObject("streaming");
+    json.Value("radius", streamRadius);
+    json.Value("positions", static_cast<uint64_t>(positions.size()));
+    json.Value("loaded_chunks", loadedChunks);
+    json.Value("skipped_chunks", skippedChunks);
+    json.Value("loaded_bytes", loadedBytes);
+    json.Value("max_resident_instances", maxResidentInstances);
+    json.Value("seconds", streamSeconds);
+    json.EndObject();
+
+    return chunksMatch && (failedChunks == 0);
+}
+
+// Bakes the atlas from the leaf mesh of the first scene that has one, like IvyRenderModule::LoadLeafImpostorAtlas,
+// and reads the written file back to check that it holds the same texels
+static bool BakeLeafImpostorAtlas(const std::vector<std::string>& scenes, const std::string& path, IvyJsonWriter& json)
+{
+    IvyGltfDocument          document;
+    std::vector<IvyMeshData> surfaces;
+    for (size_t i = 0; (i < scenes.size()) && surfaces.empty(); ++i)
+    {
+        if (!document.Load(scenes[i]) || (document.FindMesh("Leaf") < 0) || !document.ReadMesh(document.FindMesh("Leaf"), surfaces))
+        {
+            surfaces.clear();
+        }
+    }
+    if (surfaces.empty())
+    {
+        fprintf(stderr, "no Leaf mesh found, media/Ivy/ivy.gltf has to be one of the scenes\n");
+        return false;
+    }
+
+    const auto           bakeStartTime = std::chrono::steady_clock::now();
+    IvyLeafImpostorAtlas atlas;
+    IvyBakeLeafImpostorAtlas(surfaces[0], IvyLeafImpostorAtlasSettings(), atlas);
+    const double bakeSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - bakeStartTime).count();
+
+    std::string          error;
+    IvyLeafImpostorAtlas written;
+    if (!IvyWriteLeafImpostorAtlas(path, atlas, &error) || !IvyReadLeafImpostorAtlas(path, written, &error))
+    {
+        fprintf(stderr, "%s\n", error.c_str());
+        return false;
+    }
+
+    const uint64_t checksum = IvyGetLeafImpostorAtlasChecksum(atlas);
+    char           checksumString[32];
+    snprintf(checksumString, sizeof(checksumString), "%016" PRIx64, checksum);
+
+    json.BeginObject("leaf_impostor_atlas");
+    json.Value("file", path);
+    json.Value("width", atlas.GetWidth());
+    json.Value("height", atlas.GetHeight());
+    json.Value("checksum", checksumString);
+    json.Value("coverage", IvyGetLeafImpostorAtlasCoverage(atlas));
+    json.Value("bake_seconds", bakeSeconds);
+    json.Value("matches_file", IvyGetLeafImpostorAtlasChecksum(written) == checksum);
+    json.EndObject();
+
+    return IvyGetLeafImpostorAtlasChecksum(written) == checksum;
+}
+
+int main(int argc, char** argv)
+{
+    BakeOptions options;
+    if (!ParseOptions(argc, argv, options))
+    {
+        return 1;
+    }
+
+    IvyJsonWriter json;
+    json.BeginObject();
+
+    // The atlas only needs the leaf mesh, not the generated instances
+    const bool atlasPassed = options.ImpostorAtlasPath.empty() || BakeLeafImpostorAtlas(options.Scenes, options.ImpostorAtlasPath, json);
+    if (options.OutputPath.empty() && options.CheckPath.empty())
+    {
+        json.EndObject();
+        printf("%s\n", json.GetString().c_str());
+        return atlasPassed ? 0 : 1;
+    }
+
+    json.Value("format", options.Chunked ? "chunked" : "baked");
+    json.Value("version", options.Chunked ? ivyInstanceChunkVersion : ivyBakedInstanceVersion);
+    if (!options.Chunked || options.CheckPath.empty())
+    {
+        json.Value("encoding", GetInstanceEncodingName(options.Chunked ? options.ChunkSettings.Encoding : IVY_INSTANCE_ENCODING));
+    }
+
+    // Validate first, an invalid file does not need the scenes
+    IvyBakedInstanceFile   file;
+    IvyChunkedInstanceFile chunkedFile;
+    std::string            error;
+    double                 mapSeconds = 0.0;
+    if (!options.CheckPath.empty())
+    {
+        const auto mapStartTime = std::chrono::steady_clock::now();
+        const bool valid        = options.Chunked ? chunkedFile.Open(options.CheckPath, &error) : file.Open(options.CheckPath, &error);
+        mapSeconds              = std::chrono::duration<double>(std::chrono::steady_clock::now() - mapStartTime).count();
+
+        json.Value("file", options.CheckPath);
+        json.Value("valid", valid);
+        if (!valid)
+        {
+            json.Value("error", error);
+            json.EndObject();
+            printf("%s\n", json.GetString().c_str());
+            return 1;
+        }
+    }
+
+    IvyCpuScene scene;
+    if (!LoadBenchmarkScenes(options.Scenes, scene))
+    {
+        return 1;
+    }
+
+    scene.Build();
+
+    if ((scene.GetIvyStemSurfaceIndex() < 0) || (scene.GetIvyLeafSurfaceIndex() < 0))
+    {
+        fprintf(stderr, "no Stem & Leaf meshes found, media/Ivy/ivy.gltf has to be one of the scenes\n");
+        return 1;
+    }
+
+    IvyCpuEngine engine(scene, options.ThreadCount);
+    engine.SetDeterministicOrder(true);
+
+    std::vector<IvyBranchRecord> branchRecords;
+    std::vector<IvyAreaRecord>   areaRecords;
+    bool                         passed = true;
+
+    if (!options.CheckPath.empty() && options.Chunked)
+    {
+        const IvyChunkedInstanceHeader& header = chunkedFile.GetHeader();
+        for (uint32_t i = 0; i < header.BranchRecordCount; ++i)
+        {
+            branchRecords.push_back(ToIvyBranchRecord(chunkedFile.GetBranchRecords()[i]));
+        }
+        for (uint32_t i = 0; i < header.AreaRecordCount; ++i)
+        {
+            areaRecords.push_back(ToIvyAreaRecord(chunkedFile.GetAreaRecords()[i]));
+        }
+
+        IvyInstanceStreams      output;
+        const IvyBakedInstances baked = Bake(engine, branchRecords, areaRecords, output);
+
+        json.Value("map_seconds", mapSeconds);
+        json.Value("branch_records", header.BranchRecordCount);
+        json.Value("area_records", header.AreaRecordCount);
+        json.Value("generation_seconds", engine.GetStatistics().WallSeconds);
+        passed = CheckChunkedFile(chunkedFile, ToChunkedInstances(baked, output), options.ChunkSettings, options.StreamRadius, json);
+    }
+    else if (!options.CheckPath.empty())
+    {
+        const IvyBakedInstanceHeader& header = file.GetHeader();
+        for (uint32_t i = 0; i < header.BranchRecordCount; ++i)
+        {
+            branchRecords.push_back(ToIvyBranchRecord(file.GetBranchRecords()[i]));
+        }
+        for (uint32_t i = 0; i < header.AreaRecordCount; ++i)
+        {
+            areaRecords.push_back(ToIvyAreaRecord(file.GetAreaRecords()[i]));
+        }
+
+        IvyInstanceStreams      output;
+        const IvyBakedInstances generated = Bake(engine, branchRecords, areaRecords, output);
+
+        // both are in the deterministic order, so the instances have to be bit-identical
+        const bool leafMatches = (generated.LeafInstances.size() == header.LeafInstanceCount) &&
+                                 (std::memcmp(generated.LeafInstances.data(), file.GetLeafInstances(), header.LeafInstanceCount * sizeof(IvyEncodedInstance)) == 0);
+        const bool stemMatches = (generated.StemInstances.size() == header.StemInstanceCount) &&
+                                 (std::memcmp(generated.StemInstances.data(), file.GetStemInstances(), header.StemInstanceCount * sizeof(IvyEncodedInstance)) == 0);
+        const bool argumentsMatch = (generated.Arguments[0].IndexCountPerInstance == header.Arguments[0].IndexCountPerInstance) &&
+                                    (generated.Arguments[1].IndexCountPerInstance == header.Arguments[1].IndexCountPerInstance);
+        passed = leafMatches && stemMatches && argumentsMatch;
+
+        json.Value("map_seconds", mapSeconds);
+        json.Value("branch_records", header.BranchRecordCount);
+        json.Value("area_records", header.AreaRecordCount);
+        json.Value("leaf_instances", header.LeafInstanceCount);
+        json.Value("stem_instances", header.StemInstanceCount);
+        json.Value("generation_seconds", engine.GetStatistics().WallSeconds);
+        json.Value("matches_generation", passed);
+    }
+    else if (options.Chunked)
+    {
+        GetDefaultRecords(branchRecords, areaRecords);
+
+        IvyInstanceStreams      output;
+        const IvyBakedInstances baked = Bake(engine, branchRecords, areaRecords, output);
+
+        const auto writeStartTime = std::chrono::steady_clock::now();
+        if (!IvyChunkedInstanceFile::Write(options.OutputPath, ToChunkedInstances(baked, output), options.ChunkSettings, &error) ||
+            !chunkedFile.Open(options.OutputPath, &error))
+        {
+            fprintf(stderr, "%s\n", error.c_str());
+            return 1;
+        }
+        const double writeSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - writeStartTime).count();
+
+        const IvyChunkedInstanceHeader& header = chunkedFile.GetHeader();
+
+        uint32_t fallbackChunks = 0;
+        for (uint32_t i = 0; i < header.ChunkCount; ++i)
+        {
+            fallbackChunks += (chunkedFile.GetChunks()[i].Encoding != options.ChunkSettings.Encoding) ? 1 : 0;
+        }
+
+        json.Value("file", options.OutputPath);
+        json.Value("bytes", static_cast<uint64_t>(chunkedFile.GetFileSize()));
+        json.Value("chunk_capacity", header.ChunkCapacity);
+        json.Value("chunks", header.ChunkCount);
+        json.Value("fallback_encoding_chunks", fallbackChunks);
+        json.Value("branch_records", header.BranchRecordCount);
+        json.Value("area_records", header.AreaRecordCount);
+        json.Value("leaf_instances", header.InstanceCount[0]);
+        json.Value("stem_instances", header.InstanceCount[1]);
+        json.Value("generation_seconds", engine.GetStatistics().WallSeconds);
+        json.Value("write_seconds", writeSeconds);
+    }
+    else
+    {
+        GetDefaultRecords(branchRecords, areaRecords);
+
+        IvyInstanceStreams      output;
+        const IvyBakedInstances baked = Bake(engine, branchRecords, areaRecords, output);
+
+        const auto writeStartTime = std::chrono::steady_clock::now();
+        if (!IvyBakedInstanceFile::Write(options.OutputPath, baked, &error) || !file.Open(options.OutputPath, &error))
+        {
+            fprintf(stderr, "%s\n", error.c_str());
+            return 1;
+        }
+        const double writeSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - writeStartTime).count();
+
+        json.Value("file", options.OutputPath);
+        json.Value("bytes", static_cast<uint64_t>(sizeof(IvyBakedInstanceHeader) +
+                                                  (baked.BranchRecords.size() + baked.AreaRecords.size()) * sizeof(IvyBakedEntryRecord) +
+                                                  (baked.LeafInstances.size() + baked.StemInstances.size()) * sizeof(IvyEncodedInstance)));
+        json.Value("branch_records", static_cast<uint64_t>(baked.BranchRecords.size()));
+        json.Value("area_records", static_cast<uint64_t>(baked.AreaRecords.size()));
+        json.Value("leaf_instances", static_cast<uint64_t>(baked.LeafInstances.size()));
+        json.Value("stem_instances", static_cast<uint64_t>(baked.StemInstances.size()));
+        json.Value("generation_seconds", engine.GetStatistics().WallSeconds);
+        json.Value("write_seconds", writeSeconds);
+    }
+
+    json.EndObject();
+    printf("%s\n", json.GetString().c_str());
+
+    return (passed && atlasPassed) ? 0 : 1;
+}
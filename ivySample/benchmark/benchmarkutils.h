@@ -0,0 +1,91 @@
+// This file is part of the AMD Work Graph Ivy Generation Sample.
+//
+// Copyright (c) 2024 Advanced Micro Devices, Inc. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+#pragma once
+
+// Scene & record setup shared by the headless benchmarks.
+
+#include "cpu/ivycpuengine.h"
+#include "cpu/ivygltfloader.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+/**
+ * @brief   Scenes loaded by the sample (config/ivysampleconfig.json), relative to the repository root.
+ *          Sponza is not part of the repository, without it only the ivy meshes are loaded.
+ */
+inline std::vector<std::string> GetDefaultScenes()
+{
+    const std::string sponzaPath = "media/SponzaNew/MainSponza.gltf";
+    if (FILE* pFile = fopen(sponzaPath.c_str(), "rb"))
+    {
+        fclose(pFile);
+        return {sponzaPath, "media/Ivy/ivy.gltf"};
+    }
+
+    fprintf(stderr, "%s not found, using media/Ivy/ivy.gltf only\n", sponzaPath.c_str());
+    return {"media/Ivy/ivy.gltf"};
+}
+
+/**
+ * @brief   Loads all scenes into one IvyCpuScene without building it. Prints the error and returns false on failure.
+ */
+inline bool LoadBenchmarkScenes(const std::vector<std::string>& scenePaths, IvyCpuScene& scene)
+{
+    for (const std::string& scenePath : scenePaths)
+    {
+        std::string error;
+        if (!LoadGltfScene(scenePath, scene, Mat4::identity(), &error))
+        {
+            fprintf(stderr, "failed to load %s: %s\n", scenePath.c_str(), error.c_str());
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief   Entry records created by IvyRenderModule::OnInit.
+ */
+inline void GetDefaultRecords(std::vector<IvyBranchRecord>& branchRecords, std::vector<IvyAreaRecord>& areaRecords)
+{
+    branchRecords = {
+        IvyBranchRecord{Mat4::translation(Vec3(-15.2f, 4.5f, 0.f)), 4750},
+        IvyBranchRecord{Mat4::translation(Vec3(0, 0.1f, 0)), 0},
+    };
+    areaRecords = {
+        IvyAreaRecord{Mat4::translation(Vec3(0, 17, 7)) * Mat4::scale(Vec3(15, 1, 4)), 4050, 0.14f},
+    };
+}
+
+inline double Median(std::vector<double> values)
+{
+    if (values.empty())
+    {
+        return 0.0;
+    }
+    std::sort(values.begin(), values.end());
+    return values[values.size() / 2];
+}
@@ -0,0 +1,312 @@
+// This file is part of the AMD Work Graph Ivy Generation Sample.
+//
+// Copyright (c) 2024 Advanced Micro Devices, Inc. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+// Measures build time and ray throughput of the CPU scene BVH used in place of the TLAS.
+//
+// Usage: IvyBvhBenchmark [options] [scene.gltf ...]
+//   --rays <count>       number of primary rays (default 1000000), traced one at a time
+//   --waves <count>      number of ivy-like waves (default 32768): 32 short rays from a primary hit point,
+//                        traced one at a time and as SIMD packets
+//   --threads <count>    worker threads, 0 = hardware concurrency (default 1)
+//   --bins <count>       SAH bins (default 16)
+//   --leaf-size <count>  maximum leaf size (default 4)
+//   --validate <count>   rays compared against the brute force reference (default 256)
+// Scenes default to the ones loaded by the sample (config/ivysampleconfig.json).
+
+#include "benchmarkutils.h"
+
+#include "cpu/ivycpuengine.h"
+#include "cpu/ivygltfloader.h"
+#include "cpu/ivyjson.h"
+#include "cpu/ivytaskscheduler.h"
+#include "cpu/ivyutils.h"
+#include "cpu/simdmath.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <string>
+#include <vector>
+
+struct BenchmarkOptions
+{
+    std::vector<std::string> Scenes;
+    uint32_t                 RayCount      = 1000000;
+    uint32_t                 ThreadCount   = 1;
+    uint32_t                 WaveCount     = 32768;
+    uint32_t                 ValidateCount = 256;
+    IvyBvh::BuildSettings    BvhSettings;
+};
+
+static bool ParseOptions(int argc, char** argv, BenchmarkOptions& options)
+{
+    for (int i = 1; i < argc; ++i)
+    {
+        const bool hasValue = (i + 1 < argc);
+        if (!strcmp(argv[i], "--rays") && hasValue)
+        {
+            options.RayCount = static_cast<uint32_t>(strtoul(argv[++i], nullptr, 10));
+        }
+        else if (!strcmp(argv[i], "--threads") && hasValue)
+        {
+            options.ThreadCount = static_cast<uint32_t>(strtoul(argv[++i], nullptr, 10));
+        }
+        else if (!strcmp(argv[i], "--bins") && hasValue)
+        {
+            options.BvhSettings.BinCount = static_cast<uint32_t>(strtoul(argv[++i], nullptr, 10));
+        }
+        else if (!strcmp(argv[i], "--leaf-size") && hasValue)
+        {
+            options.BvhSettings.MaxLeafSize = static_cast<uint32_t>(strtoul(argv[++i], nullptr, 10));
+        }
+        else if (!strcmp(argv[i], "--waves") && hasValue)
+        {
+            options.WaveCount = static_cast<uint32_t>(strtoul(argv[++i], nullptr, 10));
+        }
+        else if (!strcmp(argv[i], "--validate") && hasValue)
+        {
+            options.ValidateCount = static_cast<uint32_t>(strtoul(argv[++i], nullptr, 10));
+        }
+        else if (argv[i][0] == '-')
+        {
+            fprintf(stderr, "unknown option %s\n", argv[i]);
+            return false;
+        }
+        else
+        {
+            options.Scenes.push_back(argv[i]);
+        }
+    }
+
+    if (options.Scenes.empty())
+    {
+        options.Scenes = GetDefaultScenes();
+    }
+
+    return true;
+}
+
+static float3 RandomDirection(uint32_t seed, uint32_t index)
+{
+    const float z   = Random(seed, index, 0) * 2.f - 1.f;
+    const float phi = Random(seed, index, 1) * 2.f * PI;
+    const float r   = std::sqrt(std::fmax(0.f, 1.f - z * z));
+    return float3(r * std::cos(phi), r * std::sin(phi), z);
+}
+
+// Primary rays start inside the scene bounds and are unbounded
+static IvyCpuScene::Ray GeneratePrimaryRay(const IvyAabb& bounds, uint32_t index)
+{
+    const float3 extent = bounds.Max - bounds.Min;
+
+    IvyCpuScene::Ray ray;
+    ray.Origin    = bounds.Min + float3(extent.x * Random(1, index, 0), extent.y * Random(1, index, 1), extent.z * Random(1, index, 2));
+    ray.Direction = RandomDirection(2, index);
+    ray.TMax      = FLT_MAX;
+    return ray;
+}
+
+// Wave rays start on the surface hit by a primary ray and are as short as the rays of the ivy growth
+static IvyCpuScene::Ray GenerateSecondaryRay(const float3& hitPosition, const float3& hitNormal, uint32_t index)
+{
+    float3 direction = RandomDirection(3, index);
+    if (dot(direction, hitNormal) < 0.f)
+    {
+        direction = -direction;
+    }
+
+    IvyCpuScene::Ray ray;
+    ray.Origin    = hitPosition + hitNormal * 1e-3f;
+    ray.Direction = direction;
+    ray.TMax      = 2.f * ivyStemLength;
+    return ray;
+}
+
+int main(int argc, char** argv)
+{
+    BenchmarkOptions options;
+    if (!ParseOptions(argc, argv, options))
+    {
+        return 1;
+    }
+
+    IvyCpuScene scene;
+    for (const std::string& scenePath : options.Scenes)
+    {
+        std::string error;
+        if (!LoadGltfScene(scenePath, scene, Mat4::identity(), &error))
+        {
+            fprintf(stderr, "failed to load %s: %s\n", scenePath.c_str(), error.c_str());
+            return 1;
+        }
+    }
+
+    scene.Build(options.BvhSettings);
+
+    const IvyBvh::BuildStatistics& buildStatistics = scene.GetBvh().GetBuildStatistics();
+    const IvyAabb                  bounds          = scene.GetBounds();
+
+    IvyTaskScheduler scheduler(options.ThreadCount);
+
+    // Runs body(first, last) for chunks of [0, count) on all worker threads and returns the wall time
+    auto parallelFor = [&](uint32_t count, uint32_t chunkSize, const std::function<void(uint32_t, uint32_t)>& body) {
+        std::vector<IvyTaskScheduler::Task> tasks;
+        for (uint32_t first = 0; first < count; first += chunkSize)
+        {
+            const uint32_t last = std::min(first + chunkSize, count);
+            tasks.push_back([&body, first, last](uint32_t) { body(first, last); });
+        }
+
+        const auto startTime = std::chrono::steady_clock::now();
+        scheduler.Run(tasks);
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+    };
+
+    // Primary rays, traced one at a time
+    std::vector<IvyCpuScene::RayHit> primaryHits(options.RayCount);
+
+    const double primarySeconds = parallelFor(options.RayCount, 4096, [&](uint32_t first, uint32_t last) {
+        for (uint32_t i = first; i < last; ++i)
+        {
+            const IvyCpuScene::Ray ray = GeneratePrimaryRay(bounds, i);
+            primaryHits[i].Hit         = scene.TraceRay(ray.Origin, ray.Direction, ray.TMin, ray.TMax, primaryHits[i].Position, primaryHits[i].Normal);
+        }
+    });
+
+    // Ivy-like waves: ivyWaveSize short rays starting at the same surface point
+    std::vector<IvyCpuScene::Ray> waveRays;
+    for (uint32_t i = 0; (i < options.RayCount) && (waveRays.size() < static_cast<size_t>(options.WaveCount) * ivyWaveSize); ++i)
+    {
+        if (primaryHits[i].Hit)
+        {
+            for (uint32_t lane = 0; lane < ivyWaveSize; ++lane)
+            {
+                waveRays.push_back(GenerateSecondaryRay(primaryHits[i].Position, primaryHits[i].Normal, i * ivyWaveSize + lane));
+            }
+        }
+    }
+
+    const uint32_t                   waveCount = static_cast<uint32_t>(waveRays.size() / ivyWaveSize);
+    std::vector<IvyCpuScene::RayHit> scalarHits(waveRays.size());
+    std::vector<IvyCpuScene::RayHit> packetHits(waveRays.size());
+
+    const double scalarSeconds = parallelFor(waveCount, 256, [&](uint32_t first, uint32_t last) {
+        for (uint32_t i = first * ivyWaveSize; i < last * ivyWaveSize; ++i)
+        {
+            const IvyCpuScene::Ray& ray = waveRays[i];
+            scalarHits[i].Hit           = scene.TraceRay(ray.Origin, ray.Direction, ray.TMin, ray.TMax, scalarHits[i].Position, scalarHits[i].Normal);
+        }
+    });
+
+    const double packetSeconds = parallelFor(waveCount, 256, [&](uint32_t first, uint32_t last) {
+        for (uint32_t wave = first; wave < last; ++wave)
+        {
+            scene.TraceRays(&waveRays[wave * ivyWaveSize], ivyWaveSize, &packetHits[wave * ivyWaveSize]);
+        }
+    });
+
+    // Packets have to reproduce the single ray results exactly
+    uint64_t primaryHitCount = 0;
+    for (const IvyCpuScene::RayHit& hit : primaryHits)
+    {
+        primaryHitCount += hit.Hit ? 1 : 0;
+    }
+
+    uint64_t waveHitCount     = 0;
+    uint32_t packetMismatches  = 0;
+    for (size_t i = 0; i < waveRays.size(); ++i)
+    {
+        waveHitCount += scalarHits[i].Hit ? 1 : 0;
+
+        const IvyCpuScene::RayHit& a = scalarHits[i];
+        const IvyCpuScene::RayHit& b = packetHits[i];
+        if ((a.Hit != b.Hit) || memcmp(&a.Position, &b.Position, sizeof(float3)) || memcmp(&a.Normal, &b.Normal, sizeof(float3)))
+        {
+            packetMismatches++;
+        }
+    }
+
+    // Compare against the brute force reference, hits have to agree on the hit distance
+    // (the hit normal may differ where rays hit a shared edge)
+    uint32_t mismatches = 0;
+    for (uint32_t i = 0; i < options.ValidateCount; ++i)
+    {
+        const IvyCpuScene::Ray ray = GeneratePrimaryRay(bounds, i);
+
+        float3     bvhPosition, bvhNormal, referencePosition, referenceNormal;
+        const bool bvhHit       = scene.TraceRay(ray.Origin, ray.Direction, 0.f, ray.TMax, bvhPosition, bvhNormal);
+        const bool referenceHit = scene.TraceRayBruteForce(ray.Origin, ray.Direction, 0.f, ray.TMax, referencePosition, referenceNormal);
+
+        if ((bvhHit != referenceHit) || (bvhHit && (distance(bvhPosition, referencePosition) > 1e-4f * length(bounds.Max - bounds.Min))))
+        {
+            mismatches++;
+        }
+    }
+
+    IvyJsonWriter json;
+    json.BeginObject();
+    json.BeginArray("scenes");
+    for (const std::string& scenePath : options.Scenes)
+    {
+        json.Value(nullptr, scenePath);
+    }
+    json.EndArray();
+    json.Value("triangles", static_cast<uint64_t>(scene.GetTriangleCount()));
+    json.BeginObject("bvh");
+    json.Value("bins", options.BvhSettings.BinCount);
+    json.Value("max_leaf_size", options.BvhSettings.MaxLeafSize);
+    json.Value("build_seconds", buildStatistics.BuildSeconds);
+    json.Value("nodes", buildStatistics.NodeCount);
+    json.Value("leaves", buildStatistics.LeafCount);
+    json.Value("max_depth", buildStatistics.MaxDepth);
+    json.Value("largest_leaf", buildStatistics.MaxLeafSize);
+    json.Value("sah_cost", static_cast<double>(buildStatistics.SahCost));
+    json.EndObject();
+    json.BeginObject("trace");
+    json.Value("simd", ivySimdInstructionSet);
+    json.Value("threads", scheduler.GetThreadCount());
+    json.Value("primary_rays", options.RayCount);
+    json.Value("primary_hits", primaryHitCount);
+    json.Value("primary_seconds", primarySeconds);
+    json.Value("primary_rays_per_second", (primarySeconds > 0.0) ? options.RayCount / primarySeconds : 0.0);
+    json.Value("waves", waveCount);
+    json.Value("wave_rays", static_cast<uint64_t>(waveRays.size()));
+    json.Value("wave_hits", waveHitCount);
+    json.Value("scalar_seconds", scalarSeconds);
+    json.Value("scalar_rays_per_second", (scalarSeconds > 0.0) ? waveRays.size() / scalarSeconds : 0.0);
+    json.Value("packet_seconds", packetSeconds);
+    json.Value("packet_rays_per_second", (packetSeconds > 0.0) ? waveRays.size() / packetSeconds : 0.0);
+    json.Value("packet_speedup", (packetSeconds > 0.0) ? scalarSeconds / packetSeconds : 0.0);
+    json.Value("packet_mismatches", packetMismatches);
+    json.EndObject();
+    json.BeginObject("validation");
+    json.Value("rays", options.ValidateCount);
+    json.Value("mismatches", mismatches);
+    json.EndObject();
+    json.EndObject();
+
+    printf("%s\n", json.GetString().c_str());
+
+    return ((mismatches == 0) && (packetMismatches == 0)) ? 0 : 1;
+}
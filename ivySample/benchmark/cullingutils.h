@@ -0,0 +1,172 @@
+// This file is part of the AMD Work Graph Ivy Generation Sample.
+//
+// Copyright (c) 2024 Advanced Micro Devices, Inc. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+#pragma once
+
+// Cameras of the culling checks around the generated instances, shared by IvyBenchmark & the culling tests.
+
+#include "cpu/affinemath.h"
+#include "cpu/ivycpuengine.h"
+#include "cpu/ivyutils.h"
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+// The depth buffer of the occlusion culling is rendered at a low resolution
+static const float    cullingFovY        = 60.f * PI / 180.f;
+static const float    cullingAspectRatio = 16.f / 9.f;
+static const float    cullingNearPlane   = 0.1f;
+static const float    cullingFarPlane    = 1000.f;
+static const uint32_t cullingDepthWidth  = 480;
+static const uint32_t cullingDepthHeight = 270;
+// Default ImpostorDistance of the sample
+static const float    impostorDistance   = 20.f;
+
+struct CullingCamera
+{
+    const char* Name;
+    float3      Eye;
+    float3      Target;
+};
+
+/**
+ * @brief   Cameras looking at the instances from afar, from close by & away from them. Empty without instances.
+ */
+inline std::vector<CullingCamera> GetCullingCameras(const IvyInstanceStreams& output)
+{
+    IvyAabb instanceBounds;
+    for (const std::vector<IvyInstanceData>* instances : {&output.LeafInstances, &output.StemInstances})
+    {
+        for (const IvyInstanceData& instance : *instances)
+        {
+            const float3x4 transform = Affine::ToFloat3x4(instance.transform);
+            instanceBounds.Grow(float3(transform[0].w, transform[1].w, transform[2].w));
+        }
+    }
+    if (instanceBounds.IsEmpty())
+    {
+        return {};
+    }
+
+    const float3 center = instanceBounds.Center();
+    const float  radius = std::max(length(instanceBounds.Max - instanceBounds.Min) * 0.5f, 1.f);
+
+    return {
+        {"overview", center + float3(0.f, 0.5f, 1.5f) * radius, center},
+        {"side", center + float3(1.5f, 0.f, 0.f) * radius, center},
+        {"close", center + float3(0.f, 0.f, 0.25f) * radius, center},
+        {"close_side", center + float3(0.25f, 0.f, 0.f) * radius, center},
+        {"looking_away", center + float3(0.f, 0.f, 2.f) * radius, center + float3(0.f, 0.f, 3.f) * radius},
+    };
+}
+
+/**
+ * @brief   Right-handed camera looking from eye at target.
+ */
+inline void ComputeCameraAxes(const float3& eye, const float3& target, float3& xAxis, float3& yAxis, float3& zAxis)
+{
+    zAxis = normalize(eye - target);
+    xAxis = normalize(cross(float3(0, 1, 0), zAxis));
+    yAxis = cross(zAxis, xAxis);
+}
+
+/**
+ * @brief   Right-handed view & D3D projection (0 <= z <= w), like the cameras of the sample.
+ */
+inline float4x4 ComputeViewProjection(const float3& eye, const float3& target)
+{
+    float3 xAxis, yAxis, zAxis;
+    ComputeCameraAxes(eye, target, xAxis, yAxis, zAxis);
+
+    const float4x4 view(xAxis.x, xAxis.y, xAxis.z, -dot(xAxis, eye),
+                        yAxis.x, yAxis.y, yAxis.z, -dot(yAxis, eye),
+                        zAxis.x, zAxis.y, zAxis.z, -dot(zAxis, eye),
+                        0.f, 0.f, 0.f, 1.f);
+
+    const float    scaleY = 1.f / std::tan(cullingFovY * 0.5f);
+    const float4x4 projection(scaleY / cullingAspectRatio, 0.f, 0.f, 0.f,
+                              0.f, scaleY, 0.f, 0.f,
+                              0.f, 0.f, cullingFarPlane / (cullingNearPlane - cullingFarPlane), cullingNearPlane * cullingFarPlane / (cullingNearPlane - cullingFarPlane),
+                              0.f, 0.f, -1.f, 0.f);
+
+    return mul(projection, view);
+}
+
+/**
+ * @brief   Depth buffer of the scene, ray traced through the pixel centers in place of the GBuffer pass of the sample.
+ */
+inline void RenderDepth(const IvyCpuScene& scene, const float3& eye, const float3& target, const float4x4& viewProjection, std::vector<float>& depth)
+{
+    float3 xAxis, yAxis, zAxis;
+    ComputeCameraAxes(eye, target, xAxis, yAxis, zAxis);
+
+    const float tanHalfFovY = std::tan(cullingFovY * 0.5f);
+
+    depth.resize(cullingDepthWidth * cullingDepthHeight);
+
+    std::vector<IvyCpuScene::Ray>    rays(cullingDepthWidth);
+    std::vector<IvyCpuScene::RayHit> hits(cullingDepthWidth);
+    for (uint32_t y = 0; y < cullingDepthHeight; ++y)
+    {
+        const float ndcY = 1.f - (y + 0.5f) / cullingDepthHeight * 2.f;
+        for (uint32_t x = 0; x < cullingDepthWidth; ++x)
+        {
+            const float ndcX = (x + 0.5f) / cullingDepthWidth * 2.f - 1.f;
+
+            rays[x].Origin    = eye;
+            rays[x].Direction = normalize(xAxis * (ndcX * tanHalfFovY * cullingAspectRatio) + yAxis * (ndcY * tanHalfFovY) - zAxis);
+            rays[x].TMin      = 0.f;
+            rays[x].TMax      = cullingFarPlane;
+        }
+        scene.TraceRays(rays.data(), cullingDepthWidth, hits.data());
+
+        for (uint32_t x = 0; x < cullingDepthWidth; ++x)
+        {
+            float pixelDepth = 1.f;
+            if (hits[x].Hit)
+            {
+                const float4 clip = mul(viewProjection, float4(hits[x].Position, 1.f));
+                pixelDepth        = std::min(std::max(clip.z / clip.w, 0.f), 1.f);
+            }
+            depth[y * cullingDepthWidth + x] = pixelDepth;
+        }
+    }
+}
+
+/**
+ * @brief   Covers the left half of the view at viewDistance, like a screen-aligned quad drawn into the depth buffer.
+ *          The ivy hardly occludes itself, the wall gives the occlusion tests something to occlude.
+ */
+inline void AddDepthWall(const float3& eye, const float3& target, const float4x4& viewProjection, float viewDistance, std::vector<float>& depth)
+{
+    const float4 clip      = mul(viewProjection, float4(eye + normalize(target - eye) * viewDistance, 1.f));
+    const float  wallDepth = clip.z / clip.w;
+
+    for (uint32_t y = 0; y < cullingDepthHeight; ++y)
+    {
+        for (uint32_t x = 0; x < cullingDepthWidth / 2; ++x)
+        {
+            depth[y * cullingDepthWidth + x] = std::min(depth[y * cullingDepthWidth + x], wallDepth);
+        }
+    }
+}
@@ -0,0 +1,227 @@
+// This file is part of the AMD Work Graph Ivy Generation Sample.
+//
+// Copyright (c) 2024 Advanced Micro Devices, Inc. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+// Measures the precision and the encode & decode throughput of the instance encodings of shaders/ivyinstanceencoding.h. The inputs are the leaf & stem instances generated by the CPU engine and random transforms of the form
+// translation * rotation * scale(x, yz, yz).
+//
+// Usage: IvyEncodingBenchmark [options] [scene.gltf ...]
+//   --threads <count>   worker threads of the ivy generation, 0 = hardware concurrency (default 0)
+//   --count <count>     number of random transforms (default 1000000)
+// The bounds of cpu/ivyinstanceencoding.h are checked by IvyEncodingTest (ivySample/tests).
+// Scenes default to the ones loaded by the sample, or media/Ivy/ivy.gltf alone if Sponza is not available.
+
+#include "benchmarkutils.h"
+#include "encodingerror.h"
+
+#include "cpu/ivyjson.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+struct BenchmarkOptions
+{
+    std::vector<std::string> Scenes;
+    uint32_t                 ThreadCount = 0;
+    uint32_t                 Count       = 1000000;
+};
+
+static bool ParseOptions(int argc, char** argv, BenchmarkOptions& options)
+{
+    for (int i = 1; i < argc; ++i)
+    {
+        const bool hasValue = (i + 1 < argc);
+        if (!strcmp(argv[i], "--threads") && hasValue)
+        {
+            options.ThreadCount = static_cast<uint32_t>(strtoul(argv[++i], nullptr, 10));
+        }
+        else if (!strcmp(argv[i], "--count") && hasValue)
+        {
+            options.Count = static_cast<uint32_t>(strtoul(argv[++i], nullptr, 10));
+        }
+        else if (argv[i][0] == '-')
+        {
+            fprintf(stderr, "unknown option %s\n", argv[i]);
+            return false;
+        }
+        else
+        {
+            options.Scenes.push_back(argv[i]);
+        }
+    }
+
+    if (options.Scenes.empty())
+    {
+        options.Scenes = GetDefaultScenes();
+    }
+
+    return true;
+}
+
+struct EncodingResult
+{
+    uint32_t      Encoding      = 0;
+    double        EncodeSeconds = 0.0;
+    double        DecodeSeconds = 0.0;
+    EncodingError Error;
+};
+
+template <typename EncodedInstance, typename Encode, typename Decode>
+static EncodingResult RunEncoding(uint32_t encoding, const std::vector<float3x4>& transforms, Encode encode, Decode decode)
+{
+    EncodingResult result;
+    result.Encoding = encoding;
+
+    std::vector<EncodedInstance> encoded(transforms.size());
+    std::vector<float3x4>        decoded(transforms.size());
+
+    auto startTime = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < transforms.size(); ++i)
+    {
+        encoded[i] = encode(transforms[i]);
+    }
+    result.EncodeSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+
+    startTime = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < transforms.size(); ++i)
+    {
+        decoded[i] = decode(encoded[i]);
+    }
+    result.DecodeSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+
+    for (size_t i = 0; i < transforms.size(); ++i)
+    {
+        AccumulateError(transforms[i], decoded[i], result.Error);
+    }
+
+    return result;
+}
+
+static std::vector<EncodingResult> RunEncodings(const std::vector<float3x4>& transforms)
+{
+    std::vector<EncodingResult> results;
+
+    results.push_back(RunEncoding<IvyInstanceData>(
+        IVY_INSTANCE_ENCODING_FLOAT4X4,
+        transforms,
+        [](const float3x4& transform) { return IvyInstanceData{Affine::ToMat4(transform)}; },
+        [](const IvyInstanceData& instance) { return float3x4(ToFloat4x4(instance.transform)); }));
+    results.push_back(RunEncoding<IvyInstanceData3x4>(IVY_INSTANCE_ENCODING_FLOAT3X4, transforms, IvyEncodeInstance3x4, IvyDecodeInstance3x4));
+    results.push_back(RunEncoding<IvyInstanceDataQuantized>(IVY_INSTANCE_ENCODING_QUANTIZED, transforms, IvyEncodeInstanceQuantized, IvyDecodeInstanceQuantized));
+
+    return results;
+}
+
+static void WriteResults(IvyJsonWriter& json, const char* key, size_t transformCount, const std::vector<EncodingResult>& results)
+{
+    json.BeginObject(key);
+    json.Value("transforms", static_cast<uint64_t>(transformCount));
+    json.BeginArray("encodings");
+    for (const EncodingResult& result : results)
+    {
+        json.BeginObject();
+        json.Value("encoding", GetInstanceEncodingName(result.Encoding));
+        json.Value("bytes_per_instance", GetInstanceEncodingSize(result.Encoding));
+        json.Value("encode_seconds", result.EncodeSeconds);
+        json.Value("decode_seconds", result.DecodeSeconds);
+        json.Value("max_position_error", result.Error.Position);
+        json.Value("max_rotation_error", result.Error.Rotation);
+        json.Value("max_scale_error", result.Error.Scale);
+        json.Value("max_element_error", result.Error.Element);
+        json.Value("out_of_range", result.Error.OutOfRange);
+        json.EndObject();
+    }
+    json.EndArray();
+    json.EndObject();
+}
+
+int main(int argc, char** argv)
+{
+    BenchmarkOptions options;
+    if (!ParseOptions(argc, argv, options))
+    {
+        return 1;
+    }
+
+    IvyCpuScene scene;
+    if (!LoadBenchmarkScenes(options.Scenes, scene))
+    {
+        return 1;
+    }
+
+    scene.Build();
+
+    if ((scene.GetIvyStemSurfaceIndex() < 0) || (scene.GetIvyLeafSurfaceIndex() < 0))
+    {
+        fprintf(stderr, "no Stem & Leaf meshes found, media/Ivy/ivy.gltf has to be one of the scenes\n");
+        return 1;
+    }
+
+    std::vector<IvyBranchRecord> branchRecords;
+    std::vector<IvyAreaRecord>   areaRecords;
+    GetDefaultRecords(branchRecords, areaRecords);
+
+    IvyCpuEngine       engine(scene, options.ThreadCount);
+    IvyInstanceStreams output;
+    engine.DispatchGraph(branchRecords, areaRecords, output);
+
+    std::vector<float3x4> ivyTransforms;
+    for (const std::vector<IvyInstanceData>* instances : {&output.LeafInstances, &output.StemInstances})
+    {
+        for (const IvyInstanceData& instance : *instances)
+        {
+            ivyTransforms.push_back(float3x4(ToFloat4x4(instance.transform)));
+        }
+    }
+
+    std::vector<float3x4> randomTransforms(options.Count);
+    for (uint32_t i = 0; i < options.Count; ++i)
+    {
+        randomTransforms[i] = RandomTransform(i);
+    }
+
+    const std::vector<EncodingResult> ivyResults    = RunEncodings(ivyTransforms);
+    const std::vector<EncodingResult> randomResults = RunEncodings(randomTransforms);
+
+    IvyJsonWriter json;
+    json.BeginObject();
+    json.Value("selected_encoding", GetInstanceEncodingName(IVY_INSTANCE_ENCODING));
+    json.Value("max_instances", static_cast<uint32_t>(IVY_MAX_INSTANCES));
+    json.Value("instance_buffer_bytes", static_cast<uint64_t>(IVY_MAX_INSTANCES) * GetInstanceEncodingSize(IVY_INSTANCE_ENCODING));
+    json.BeginObject("quantized_bounds");
+    json.Value("position_range", static_cast<double>(IVY_INSTANCE_POSITION_RANGE));
+    json.Value("position", static_cast<double>(ivyQuantizedPositionErrorBound));
+    json.Value("rotation", static_cast<double>(ivyQuantizedRotationErrorBound));
+    json.Value("scale", static_cast<double>(ivyQuantizedScaleErrorBound));
+    json.EndObject();
+    WriteResults(json, "ivy", ivyTransforms.size(), ivyResults);
+    WriteResults(json, "random", randomTransforms.size(), randomResults);
+    json.EndObject();
+
+    printf("%s\n", json.GetString().c_str());
+
+    return 0;
+}
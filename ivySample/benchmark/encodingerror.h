@@ -0,0 +1,146 @@
+// This file is part of the AMD Work Graph Ivy Generation Sample.
+//
+// Copyright (c) 2024 Advanced Micro Devices, Inc. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+#pragma once
+
+// Precision measurement of the instance encodings, shared by IvyEncodingBenchmark & IvyEncodingTest.
+
+#include "cpu/affinemath.h"
+#include "cpu/ivyinstanceencoding.h"
+#include "cpu/ivyutils.h"
+
+#include <algorithm>
+#include <cmath>
+
+/**
+ * @brief   Random transform of the form translation * rotation * scale(x, yz, yz) within 0.8 * IVY_INSTANCE_POSITION_RANGE.
+ */
+inline float3x4 RandomTransform(uint32_t index)
+{
+    auto random = [index](uint32_t key) { return Random(23, index, key) * 2.f - 1.f; };
+
+    const float3 forward = float3(random(0), random(1), random(2));
+    const float3 up      = float3(random(3), random(4), random(5));
+    const float  scaleX  = random(6) + 1.f;
+    const float  scaleYZ = random(7) * 0.75f + 1.25f;
+    const float  range   = 0.8f * IVY_INSTANCE_POSITION_RANGE;
+
+    return Affine::mmul(Affine::Translate(random(8) * range, random(9) * range, random(10) * range),
+                        Affine::Rotate(forward, up),
+                        Affine::RotateZ(random(11) * 3.f),
+                        Affine::Scale(scaleX, scaleYZ, scaleYZ));
+}
+
+struct EncodingError
+{
+    double   Position   = 0.0;  // largest absolute error of a translation component
+    double   Rotation   = 0.0;  // largest rotation angle between original & decoded transform
+    double   Scale      = 0.0;  // largest relative error of a column length
+    double   Element    = 0.0;  // largest absolute error of a matrix element
+    uint64_t OutOfRange = 0;    // transforms outside of IVY_INSTANCE_POSITION_RANGE, not included above
+};
+
+// Orthonormal rotation of a transform, derived from its y & z columns like IvyEncodeInstanceQuantized
+inline void GetRotation(const float3x4& transform, double rotation[3][3])
+{
+    double axes[3][3] = {};
+    for (int column = 1; column < 3; ++column)
+    {
+        double lengthSquared = 0.0;
+        for (int row = 0; row < 3; ++row)
+        {
+            lengthSquared += static_cast<double>(transform[row][column]) * transform[row][column];
+        }
+        for (int row = 0; row < 3; ++row)
+        {
+            axes[column][row] = transform[row][column] / std::sqrt(lengthSquared);
+        }
+    }
+    axes[0][0] = axes[1][1] * axes[2][2] - axes[1][2] * axes[2][1];
+    axes[0][1] = axes[1][2] * axes[2][0] - axes[1][0] * axes[2][2];
+    axes[0][2] = axes[1][0] * axes[2][1] - axes[1][1] * axes[2][0];
+
+    for (int row = 0; row < 3; ++row)
+    {
+        for (int column = 0; column < 3; ++column)
+        {
+            rotation[row][column] = axes[column][row];
+        }
+    }
+}
+
+inline double GetColumnLength(const float3x4& transform, int column)
+{
+    double lengthSquared = 0.0;
+    for (int row = 0; row < 3; ++row)
+    {
+        lengthSquared += static_cast<double>(transform[row][column]) * transform[row][column];
+    }
+    return std::sqrt(lengthSquared);
+}
+
+// Adds the error of decoded against original, transforms outside of IVY_INSTANCE_POSITION_RANGE are only counted
+inline void AccumulateError(const float3x4& original, const float3x4& decoded, EncodingError& error)
+{
+    for (int row = 0; row < 3; ++row)
+    {
+        if (std::abs(original[row][3]) > IVY_INSTANCE_POSITION_RANGE)
+        {
+            ++error.OutOfRange;
+            return;
+        }
+    }
+
+    for (int row = 0; row < 3; ++row)
+    {
+        error.Position = std::max(error.Position, std::abs(static_cast<double>(decoded[row][3]) - original[row][3]));
+        for (int column = 0; column < 4; ++column)
+        {
+            error.Element = std::max(error.Element, std::abs(static_cast<double>(decoded[row][column]) - original[row][column]));
+        }
+    }
+
+    // |R0 - R1| (Frobenius norm) = 2 * sqrt(2) * sin(angle / 2), which is accurate for small angles
+    double originalRotation[3][3], decodedRotation[3][3];
+    GetRotation(original, originalRotation);
+    GetRotation(decoded, decodedRotation);
+
+    double differenceSquared = 0.0;
+    for (int row = 0; row < 3; ++row)
+    {
+        for (int column = 0; column < 3; ++column)
+        {
+            const double difference = decodedRotation[row][column] - originalRotation[row][column];
+            differenceSquared += difference * difference;
+        }
+    }
+    const double angle = 2.0 * std::asin(std::min(std::sqrt(differenceSquared) / (2.0 * std::sqrt(2.0)), 1.0));
+    error.Rotation     = std::max(error.Rotation, angle);
+
+    // relative error of the scales, below 2^-14 half precision is subnormal & the error is absolute
+    for (int column = 0; column < 3; ++column)
+    {
+        const double originalLength = GetColumnLength(original, column);
+        const double decodedLength  = GetColumnLength(decoded, column);
+        error.Scale                 = std::max(error.Scale, std::abs(decodedLength - originalLength) / std::max(originalLength, 1.0 / 16384));
+    }
+}
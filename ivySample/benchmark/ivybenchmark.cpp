@@ -0,0 +1,1102 @@
+// This file is part of the AMD Work Graph Ivy Generation Sample.
+//
+// Copyright (c) 2024 Advanced Micro Devices, Inc. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+// Runs the full ivy generation work graph (IvyArea -> IvyAreaSample -> IvyBranch) on the CPU engine
+// and reports generation performance as JSON, for tracking on machines without a GPU.
+//
+// Usage: IvyBenchmark [options] [scene.gltf ...]
+//   --threads <count>      worker threads, 0 = hardware concurrency (default 0)
+//   --runs <count>         measured dispatches (default 5), preceded by one warm-up dispatch
+//   --no-packets           trace the rays of a wave one at a time instead of as SIMD packets
+//   --write-golden <file>  store counts & checksums of the generated instances (see cpu/ivyoutputdigest.h)
+//   --check-golden <file>  compare every run against a stored golden output, exits with 1 on differences
+//   --tolerance <value>    accepted relative difference of the instance moments & bounds (default 1e-4)
+//   --exact                require bit-identical instances (in any order) instead of a tolerance
+//   --deterministic        sort the instances by (branch seed, iteration, slot), exits with 1 if the order changes between runs
+//   --frames <count>       additionally simulate frames of IvyRenderModule::Execute with an IvyIncrementalGenerator (default 0, off)
+//                          and measure the edit latency of each entry record
+//   --edit-interval <n>    change the seed of the first root every n simulated frames, 0 = never (default 60)
+//   --initial-capacity <n> instances per stream of the simulated instance arena before it grows (default 65536)
+//   --backing-memory-sweep additionally measure the dispatch time over backing memory sizes between min & max
+//   --frustum-culling      additionally cull the instances for a set of cameras
+//   --occlusion-culling    additionally test the instances within the frustum against a Hi-Z pyramid of the scene depth,
+//                          implies --frustum-culling
+//   --instance-clusters    additionally cull clusters of consecutive instances before their instances, implies --frustum-culling
+//   --mesh-lods            additionally build the LOD chains of the leaf & stem meshes & select a LOD for each
+//                          visible instance of the culling cameras, implies --frustum-culling
+//   --leaf-impostors       additionally bake the leaf impostor atlas, build the impostor quads of the leaf clusters and draw the
+//                          distant clusters as impostors, implies --instance-clusters
+// Scenes default to the ones loaded by the sample (config/ivysampleconfig.json).
+// The entry records are the ones created by IvyRenderModule::OnInit.
+
+#include "benchmarkutils.h"
+#include "cullingutils.h"
+
+#include "cpu/affinemath.h"
+#include "cpu/ivybackingmemory.h"
+#include "cpu/ivycpuhiz.h"
+#include "cpu/ivyentryrecordbuffer.h"
+#include "cpu/ivygltfdocument.h"
+#include "cpu/ivyincrementalgenerator.h"
+#include "cpu/ivyinstanceclusters.h"
+#include "cpu/ivyinstancecounthistory.h"
+#include "cpu/ivyinstanceculling.h"
+#include "cpu/ivyjson.h"
+#include "cpu/ivyleafimpostoratlas.h"
+#include "cpu/ivyleafimpostors.h"
+#include "cpu/ivymeshsimplifier.h"
+#include "cpu/ivyoutputdigest.h"
+#include "cpu/ivystartuptimer.h"
+#include "cpu/simdmath.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cinttypes>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+struct BenchmarkOptions
+{
+    std::vector<std::string> Scenes;
+    uint32_t                 ThreadCount        = 0;
+    uint32_t                 RunCount           = 5;
+    bool                     PacketTracing      = true;
+    std::string              WriteGoldenPath;
+    std::string              CheckGoldenPath;
+    double                   Tolerance          = 1e-4;
+    bool                     Exact              = false;
+    bool                     Deterministic      = false;
+    uint32_t                 FrameCount         = 0;
+    uint32_t                 EditInterval       = 60;
+    uint32_t                 InitialCapacity    = ivyDefaultInstanceArenaCapacity;
+    bool                     BackingMemorySweep = false;
+    bool                     FrustumCulling     = false;
+    bool                     OcclusionCulling   = false;
+    bool                     InstanceClusters   = false;
+    bool                     MeshLods           = false;
+    bool                     LeafImpostors      = false;
+};
+
+static bool ParseOptions(int argc, char** argv, BenchmarkOptions& options)
+{
+    for (int i = 1; i < argc; ++i)
+    {
+        const bool hasValue = (i + 1 < argc);
+        if (!strcmp(argv[i], "--threads") && hasValue)
+        {
+            options.ThreadCount = static_cast<uint32_t>(strtoul(argv[++i], nullptr, 10));
+        }
+        else if (!strcmp(argv[i], "--runs") && hasValue)
+        {
+            options.RunCount = std::max(static_cast<uint32_t>(strtoul(argv[++i], nullptr, 10)), 1u);
+        }
+        else if (!strcmp(argv[i], "--no-packets"))
+        {
+            options.PacketTracing = false;
+        }
+        else if (!strcmp(argv[i], "--write-golden") && hasValue)
+        {
+            options.WriteGoldenPath = argv[++i];
+        }
+        else if (!strcmp(argv[i], "--check-golden") && hasValue)
+        {
+            options.CheckGoldenPath = argv[++i];
+        }
+        else if (!strcmp(argv[i], "--tolerance") && hasValue)
+        {
+            options.Tolerance = strtod(argv[++i], nullptr);
+        }
+        else if (!strcmp(argv[i], "--exact"))
+        {
+            options.Exact = true;
+        }
+        else if (!strcmp(argv[i], "--deterministic"))
+        {
+            options.Deterministic = true;
+        }
+        else if (!strcmp(argv[i], "--frames") && hasValue)
+        {
+            options.FrameCount = static_cast<uint32_t>(strtoul(argv[++i], nullptr, 10));
+        }
+        else if (!strcmp(argv[i], "--edit-interval") && hasValue)
+        {
+            options.EditInterval = static_cast<uint32_t>(strtoul(argv[++i], nullptr, 10));
+        }
+        else if (!strcmp(argv[i], "--initial-capacity") && hasValue)
+        {
+            options.InitialCapacity = static_cast<uint32_t>(strtoul(argv[++i], nullptr, 10));
+        }
+        else if (!strcmp(argv[i], "--backing-memory-sweep"))
+        {
+            options.BackingMemorySweep = true;
+        }
+        else if (!strcmp(argv[i], "--frustum-culling"))
+        {
+            options.FrustumCulling = true;
+        }
+        else if (!strcmp(argv[i], "--occlusion-culling"))
+        {
+            options.FrustumCulling   = true;
+            options.OcclusionCulling = true;
+        }
+        else if (!strcmp(argv[i], "--instance-clusters"))
+        {
+            options.FrustumCulling   = true;
+            options.InstanceClusters = true;
+        }
+        else if (!strcmp(argv[i], "--mesh-lods"))
+        {
+            options.FrustumCulling = true;
+            options.MeshLods       = true;
+        }
+        else if (!strcmp(argv[i], "--leaf-impostors"))
+        {
+            options.FrustumCulling   = true;
+            options.InstanceClusters = true;
+            options.LeafImpostors    = true;
+        }
+        else if (argv[i][0] == '-')
+        {
+            fprintf(stderr, "unknown option %s\n", argv[i]);
+            return false;
+        }
+        else
+        {
+            options.Scenes.push_back(argv[i]);
+        }
+    }
+
+    if (options.Scenes.empty())
+    {
+        options.Scenes = GetDefaultScenes();
+    }
+
+    return true;
+}
+
+static bool ReadGolden(const std::string& path, IvyOutputDigest& golden)
+{
+    std::ifstream file(path, std::ios::binary);
+    if (!file)
+    {
+        fprintf(stderr, "cannot open %s\n", path.c_str());
+        return false;
+    }
+
+    std::stringstream text;
+    text << file.rdbuf();
+
+    IvyJson     json;
+    std::string error;
+    if (!IvyJson::Parse(text.str(), json, &error) || !IvyOutputDigest::Read(json["digest"], golden, &error))
+    {
+        fprintf(stderr, "failed to read %s: %s\n", path.c_str(), error.c_str());
+        return false;
+    }
+    return true;
+}
+
+static bool WriteGolden(const std::string& path, const BenchmarkOptions& options, const IvyOutputDigest& digest)
+{
+    IvyJsonWriter json;
+    json.BeginObject();
+    json.BeginArray("scenes");
+    for (const std::string& scenePath : options.Scenes)
+    {
+        json.Value(nullptr, scenePath);
+    }
+    json.EndArray();
+    digest.Write(json, "digest");
+    json.EndObject();
+
+    std::ofstream file(path, std::ios::binary);
+    file << json.GetString() << "\n";
+    if (!file)
+    {
+        fprintf(stderr, "cannot write %s\n", path.c_str());
+        return false;
+    }
+    return true;
+}
+
+// The CPU engine has no backing memory, its equivalent are the IvyBranch thread groups waiting for execution.
+// Min is one queued group per worker, max the peak of an unbounded dispatch & the granularity one group of records.
+static IvyBackingMemoryRequirements GetBackingMemoryRequirements(const IvyCpuEngine& engine)
+{
+    const IvyCpuEngine::Statistics& statistics    = engine.GetStatistics();
+    const uint64_t                  bytesPerGroup = engine.GetGenerationSettings().ThreadGroupCoalescing * sizeof(IvyBranchRecord);
+
+    IvyBackingMemoryRequirements requirements;
+    requirements.MinSizeInBytes         = statistics.ThreadCount * bytesPerGroup;
+    requirements.MaxSizeInBytes         = std::max<uint64_t>(statistics.PeakQueuedGroups, statistics.ThreadCount) * bytesPerGroup;
+    requirements.SizeGranularityInBytes = bytesPerGroup;
+    return requirements;
+}
+
+// Runs options.RunCount dispatches for each step of the sweep with the queued groups bounded by its size.
+// Returns false if a bounded dispatch generated different instances than the unbounded reference.
+static bool SweepBackingMemory(IvyCpuEngine&                       engine,
+                               const BenchmarkOptions&             options,
+                               const std::vector<IvyBranchRecord>& branchRecords,
+                               const std::vector<IvyAreaRecord>&   areaRecords,
+                               const IvyOutputDigest&              reference,
+                               IvyBackingMemorySweep&              sweep)
+{
+    const IvyBackingMemoryRequirements requirements = GetBackingMemoryRequirements(engine);
+    sweep                                           = IvyBackingMemorySweep(requirements);
+
+    bool               consistent = true;
+    IvyInstanceStreams output;
+    for (uint32_t step = 0; step < sweep.GetStepCount(); ++step)
+    {
+        engine.SetMaxQueuedBranchGroups(static_cast<uint32_t>(sweep.GetSizeInBytes(step) / requirements.SizeGranularityInBytes));
+
+        for (uint32_t run = 0; run < options.RunCount; ++run)
+        {
+            engine.DispatchGraph(branchRecords, areaRecords, output);
+            sweep.AddSample(step, engine.GetStatistics().WallSeconds);
+
+            consistent = consistent && IvyOutputDigest::Compute(output, engine.GetStatistics()).Matches(reference, options.Tolerance, options.Exact);
+        }
+    }
+
+    engine.SetMaxQueuedBranchGroups(0);
+    return consistent;
+}
+
+struct CullingResult
+{
+    std::string Camera;
+    uint64_t    VisibleInstances[2]                = {};  // [0] leaf, [1] stem, within the frustum & not occluded
+    uint64_t    OccludedInstances[2]               = {};  // within the frustum, occluded according to the Hi-Z pyramid
+    uint64_t    DepthOccludedInstances[2]          = {};  // within the frustum, occluded according to every pixel of the depth buffer
+    double      Seconds                            = 0.0;
+    double      HiZSeconds                         = 0.0;  // pyramid build
+    uint64_t    VisibleClusters[2]                 = {};   // with --instance-clusters
+    uint64_t    ClusterInstanceTests[2]            = {};   // instances of the visible clusters
+    double      ClusterSeconds                     = 0.0;
+    uint64_t    LodInstances[2][IVY_MAX_MESH_LODS] = {};  // with --mesh-lods, visible instances per selected LOD
+    uint64_t    LodTriangles[2]                    = {};  // triangles of the selected LODs of the visible instances
+    uint64_t    FullTriangles[2]                   = {};  // triangles of the visible instances with LOD 0
+    uint64_t    ImpostorClusters                   = 0;   // with --leaf-impostors, visible leaf clusters drawn as impostors
+    uint64_t    ImpostorQuads                      = 0;   // quads of these clusters
+    uint64_t    GeometryLeafInstances              = 0;   // visible leaf instances of the other clusters
+    uint64_t    LeafTriangles                      = 0;   // triangles of the visible leaf instances without impostors
+    uint64_t    ImpostorLeafTriangles              = 0;   // triangles of the leaf geometry & impostor quads
+};
+
+// LOD chain of the leaf or stem mesh, as built by IvyRenderModule::LoadMeshLods
+struct MeshLods
+{
+    IvyMeshLodChain Chain;
+    double          Seconds = 0.0;
+
+    void Build(const IvyMeshData& mesh)
+    {
+        const auto startTime = std::chrono::steady_clock::now();
+        IvyBuildMeshLodChain(mesh, IvyMeshLodSettings(), Chain);
+        Seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+    }
+
+    void Write(IvyJsonWriter& json, const char* name) const
+    {
+        json.BeginObject(name);
+        json.Value("build_seconds", Seconds);
+        json.BeginArray("lods");
+        for (const IvyMeshLod& lod : Chain.Lods)
+        {
+            json.BeginObject();
+            json.Value("triangles", lod.IndexCount / 3);
+            json.Value("vertices", lod.VertexCount);
+            json.Value("error", lod.Error);
+            json.EndObject();
+        }
+        json.EndArray();
+        json.EndObject();
+    }
+};
+
+// Leaf impostor atlas, as baked by IvyRenderModule::LoadLeafImpostorAtlas, and the impostor quads of the leaf clusters
+struct LeafImpostors
+{
+    IvyLeafImpostorAtlas             Atlas;
+    uint64_t                         Checksum  = 0;
+    double                           Seconds   = 0.0;
+    std::vector<IvyLeafImpostorQuad> Quads;
+    uint64_t                         UsedQuads = 0;
+
+    void Bake(const IvyMeshData& leafMesh)
+    {
+        const auto startTime = std::chrono::steady_clock::now();
+        IvyBakeLeafImpostorAtlas(leafMesh, IvyLeafImpostorAtlasSettings(), Atlas);
+        Seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+
+        Checksum = IvyGetLeafImpostorAtlasChecksum(Atlas);
+    }
+
+    void BuildQuads(const std::vector<IvyInstanceData>& instances, const float4& localSphere, const std::vector<IvyInstanceCluster>& clusters)
+    {
+        IvyBuildLeafImpostorQuads(instances, localSphere, clusters, Quads);
+        UsedQuads = std::count_if(Quads.begin(), Quads.end(), [](const IvyLeafImpostorQuad& quad) { return quad.instanceCount > 0; });
+    }
+
+    void Write(IvyJsonWriter& json) const
+    {
+        char checksumString[32];
+        snprintf(checksumString, sizeof(checksumString), "%016" PRIx64, Checksum);
+
+        json.BeginObject("atlas");
+        json.Value("width", Atlas.GetWidth());
+        json.Value("height", Atlas.GetHeight());
+        json.Value("checksum", checksumString);
+        json.Value("coverage", IvyGetLeafImpostorAtlasCoverage(Atlas));
+        json.Value("bake_seconds", Seconds);
+        json.EndObject();
+        json.Value("quads", UsedQuads);
+    }
+};
+
+struct ClusterStatistics
+{
+    uint64_t Ranges     = 0;
+    uint64_t Clusters   = 0;
+    double   MeanSize   = 0.0;  // instances per cluster
+    double   MeanRadius = 0.0;  // radius of the cluster bounding spheres
+
+    void Compute(const std::vector<IvyInstanceData>&  instances,
+                 const float4&                        localSphere,
+                 const std::vector<IvyInstanceRange>& ranges,
+                 std::vector<IvyInstanceCluster>&     clusters)
+    {
+        IvyBuildInstanceClusters(instances, localSphere, ranges, clusters);
+
+        Ranges   = ranges.size();
+        Clusters = clusters.size();
+        for (const IvyInstanceCluster& cluster : clusters)
+        {
+            MeanSize += cluster.instanceCount;
+            MeanRadius += IvyGetClusterBoundingSphere(cluster).w;
+        }
+        MeanSize /= std::max(clusters.size(), size_t(1));
+        MeanRadius /= std::max(clusters.size(), size_t(1));
+    }
+
+    void Write(IvyJsonWriter& json, const char* name) const
+    {
+        json.BeginObject(name);
+        json.Value("ranges", Ranges);
+        json.Value("clusters", Clusters);
+        json.Value("mean_instances", MeanSize);
+        json.Value("mean_radius", MeanRadius);
+        json.EndObject();
+    }
+};
+
+// Clusters of a stream as built by the GPU pass (consecutive runs of the draw buffers) and per IvyBranch thread group.
+// The group clusters are not built with --deterministic, which reorders the instances.
+struct InstanceClusters
+{
+    std::vector<IvyInstanceCluster> Clusters;  // runs, used for culling
+    ClusterStatistics               Runs;
+    ClusterStatistics               Groups;
+};
+
+// The LODs are selected for a full HD render target with the default LodPixelError of the sample
+static const float lodRenderHeight = 1080.f;
+static const float lodPixelError   = 1.f;
+
+// Culls the leaf clusters again with impostors, visibleInstances are the visible instances found without impostors
+static void CullLeafImpostors(const IvyFrustum&                      frustum,
+                              const IvyCpuHiZPyramid*                pHiZPyramid,
+                              const float4x4&                        viewProjection,
+                              const float4&                          localSphere,
+                              const std::vector<IvyInstanceData>&    instances,
+                              const std::vector<IvyInstanceCluster>& clusters,
+                              const LeafImpostors&                   impostors,
+                              uint32_t                               leafTriangles,
+                              const std::vector<uint32_t>&           visibleInstances,
+                              CullingResult&                         result)
+{
+    std::vector<uint32_t> geometryInstances;
+    std::vector<uint32_t> impostorClusters;
+    IvyCullInstanceClusters(frustum, pHiZPyramid, viewProjection, localSphere, instances, clusters, geometryInstances, impostorDistance, &impostorClusters);
+
+    for (uint32_t cluster : impostorClusters)
+    {
+        for (uint32_t quad = 0; quad < IVY_LEAF_IMPOSTOR_QUADS; ++quad)
+        {
+            result.ImpostorQuads += (impostors.Quads[cluster * IVY_LEAF_IMPOSTOR_QUADS + quad].instanceCount > 0) ? 1 : 0;
+        }
+    }
+
+    result.ImpostorClusters      = impostorClusters.size();
+    result.GeometryLeafInstances = geometryInstances.size();
+    result.LeafTriangles         = static_cast<uint64_t>(visibleInstances.size()) * leafTriangles;
+    result.ImpostorLeafTriangles = static_cast<uint64_t>(geometryInstances.size()) * leafTriangles + 2 * result.ImpostorQuads;
+}
+
+// Culls the generated instances with the CPU reference of shaders/ivyinstanceculling.hlsl for cameras around the instances.
+// With occlusionCulling, the instances within the frustum are also tested against the Hi-Z pyramid of the scene depth,
+// and against every pixel of the depth buffer covered by their footprint.
+// With clusters, the instances are culled again with the clusters of the GPU pass.
+// With lods, each visible instance selects a LOD like shaders/ivyinstanceculling.hlsl.
+// With impostors, the leaf clusters beyond impostorDistance are drawn as impostor quads instead of their instances.
+static std::vector<CullingResult> CullInstances(const IvyCpuScene&        scene,
+                                                const IvyInstanceStreams& output,
+                                                bool                      occlusionCulling,
+                                                const InstanceClusters*   clusters,
+                                                const MeshLods*           lods,
+                                                const LeafImpostors*      impostors)
+{
+    const std::vector<IvyInstanceData>* streams[2]      = {&output.LeafInstances, &output.StemInstances};
+    const IvyAabb                       meshBounds[2]   = {scene.GetSurfaceBounds(scene.GetIvyLeafSurfaceIndex()),
+                                                           scene.GetSurfaceBounds(scene.GetIvyStemSurfaceIndex())};
+    const float4                        localSpheres[2] = {IvyGetLocalBoundingSphere(meshBounds[0].Min, meshBounds[0].Max),
+                                                           IvyGetLocalBoundingSphere(meshBounds[1].Min, meshBounds[1].Max)};
+
+    const std::vector<CullingCamera> cameras = GetCullingCameras(output);
+
+    std::vector<CullingResult> results;
+    std::vector<uint32_t>      visibleInstances;
+    std::vector<uint32_t>      clusterVisibleInstances;
+    std::vector<float>         depth;
+    IvyCpuHiZPyramid           hiZPyramid;
+    for (const CullingCamera& camera : cameras)
+    {
+        const float4x4   viewProjection = ComputeViewProjection(camera.Eye, camera.Target);
+        const IvyFrustum frustum        = IvyFrustum::FromViewProjection(viewProjection);
+
+        CullingResult result;
+        result.Camera = camera.Name;
+
+        if (occlusionCulling)
+        {
+            RenderDepth(scene, camera.Eye, camera.Target, viewProjection, depth);
+
+            const auto startTime = std::chrono::steady_clock::now();
+            hiZPyramid.Build(depth.data(), cullingDepthWidth, cullingDepthHeight);
+            result.HiZSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+        }
+
+        for (uint32_t stream = 0; stream < 2; ++stream)
+        {
+            const std::vector<IvyInstanceData>& instances = *streams[stream];
+
+            visibleInstances.clear();
+            const auto startTime = std::chrono::steady_clock::now();
+            IvyCullInstances(frustum, localSpheres[stream], instances, visibleInstances);
+            if (occlusionCulling)
+            {
+                for (uint32_t index : visibleInstances)
+                {
+                    const float4 sphere = IvyGetInstanceBoundingSphere(Affine::ToFloat3x4(instances[index].transform), localSpheres[stream]);
+                    result.OccludedInstances[stream] += hiZPyramid.IsSphereOccluded(viewProjection, sphere) ? 1 : 0;
+                }
+            }
+            result.Seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+
+            result.VisibleInstances[stream] = visibleInstances.size() - result.OccludedInstances[stream];
+
+            if (clusters)
+            {
+                clusterVisibleInstances.clear();
+                const auto clusterStartTime = std::chrono::steady_clock::now();
+                const IvyClusterCullingStatistics clusterStatistics = IvyCullInstanceClusters(
+                    frustum, occlusionCulling ? &hiZPyramid : nullptr, viewProjection, localSpheres[stream], instances, clusters[stream].Clusters, clusterVisibleInstances);
+                result.ClusterSeconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - clusterStartTime).count();
+
+                result.VisibleClusters[stream]      = clusterStatistics.VisibleClusters;
+                result.ClusterInstanceTests[stream] = clusterStatistics.InstanceTests;
+
+                std::sort(clusterVisibleInstances.begin(), clusterVisibleInstances.end());
+
+                if (impostors && (stream == 0))
+                {
+                    CullLeafImpostors(frustum, occlusionCulling ? &hiZPyramid : nullptr, viewProjection, localSpheres[stream], instances,
+                                      clusters[stream].Clusters, *impostors, output.Arguments[0].IndexCountPerInstance / 3, clusterVisibleInstances, result);
+                }
+            }
+
+            if (lods && !lods[stream].Chain.Lods.empty())
+            {
+                const std::vector<IvyMeshLod>& chainLods = lods[stream].Chain.Lods;
+                const uint32_t                 lodCount  = std::min(static_cast<uint32_t>(chainLods.size()), static_cast<uint32_t>(IVY_MAX_MESH_LODS));
+                const float                    lodScale  = 0.5f * lodRenderHeight * length(viewProjection[1].xyz());
+
+                float4 lodErrors(0.f, 0.f, 0.f, 0.f);
+                for (uint32_t lod = 0; lod < lodCount; ++lod)
+                {
+                    lodErrors[lod] = chainLods[lod].Error;
+                }
+
+                for (uint32_t index : visibleInstances)
+                {
+                    const float4 sphere = IvyGetInstanceBoundingSphere(Affine::ToFloat3x4(instances[index].transform), localSpheres[stream]);
+                    if (occlusionCulling && hiZPyramid.IsSphereOccluded(viewProjection, sphere))
+                    {
+                        continue;
+                    }
+
+                    const uint32_t lod = IvySelectMeshLod(lodErrors, lodCount, sphere, localSpheres[stream].w, viewProjection[3], lodScale, lodPixelError);
+                    ++result.LodInstances[stream][lod];
+                    result.LodTriangles[stream] += chainLods[lod].IndexCount / 3;
+                    result.FullTriangles[stream] += chainLods[0].IndexCount / 3;
+                }
+            }
+
+            // instances the pyramid could occlude at most, see IvyOcclusionCullingTest
+            if (occlusionCulling)
+            {
+                for (uint32_t index : visibleInstances)
+                {
+                    const float4 sphere = IvyGetInstanceBoundingSphere(Affine::ToFloat3x4(instances[index].transform), localSpheres[stream]);
+                    result.DepthOccludedInstances[stream] +=
+                        IvyIsSphereOccludedByDepth(depth.data(), cullingDepthWidth, cullingDepthHeight, viewProjection, sphere) ? 1 : 0;
+                }
+            }
+        }
+        results.push_back(result);
+    }
+    return results;
+}
+
+struct PartitionEdit
+{
+    bool     Area          = false;
+    uint64_t LeafInstances = 0;
+    uint64_t StemInstances = 0;
+    double   Seconds       = 0.0;  // generation & compaction after changing the seed of this entry record only
+};
+
+struct FrameSimulation
+{
+    std::vector<double>        GeneratedFrameSeconds;
+    std::vector<double>        CachedFrameSeconds;
+    std::vector<PartitionEdit> PartitionEdits;
+    IvyInstanceCountHistory    InstanceCounts;  // draw arguments of the simulated frames
+    uint64_t                   RecordBufferSize  = 0;
+    uint64_t                   RecordUploadBytes = 0;  // dirty ranges of the entry record buffer over all frames
+    uint32_t                   ArenaCapacity     = 0;
+    uint32_t                   ArenaGrowths      = 0;
+    uint32_t                   PartitionLayouts  = 0;
+    uint32_t                   PartitionCapacity = 0;  // largest partition of the final layout
+    bool                       ArenaSaturated    = false;
+    bool                       Consistent        = true;
+};
+
+// Runs the generation part of IvyRenderModule::Execute for options.FrameCount frames, while the seed of the first root
+// is changed every options.EditInterval frames. Frames with unchanged inputs only compute the generation keys.
+// Afterwards, the seed of each entry record is changed once to measure the edit latency per partition.
+static FrameSimulation SimulateFrames(IvyCpuEngine&                engine,
+                                      const BenchmarkOptions&      options,
+                                      std::vector<IvyBranchRecord> branchRecords,
+                                      std::vector<IvyAreaRecord>   areaRecords)
+{
+    FrameSimulation         simulation;
+    IvyIncrementalGenerator generator(engine, options.InitialCapacity);
+    IvyInstanceStreams      output;
+    IvyEntryRecordBuffer    recordBuffer;
+
+    // only the dirty ranges of the persistent record buffer are uploaded, see IvyRenderModule::UploadEntryRecords,
+    // a single multi node input dispatches the regenerated partitions
+    const auto uploadRecords = [&]() {
+        recordBuffer.Assign(branchRecords, areaRecords);
+        recordBuffer.SetDispatchSlots(generator.GetDirtyPartitions());
+        for (const IvyEntryRecordBuffer::Range& range : recordBuffer.GetDirtyRanges())
+        {
+            simulation.RecordUploadBytes += range.Size;
+        }
+        recordBuffer.ClearDirtyRanges();
+    };
+
+    IvyGenerationKey sharedKey;
+    sharedKey.Add(options.Deterministic);
+
+    for (uint32_t frame = 0; frame < options.FrameCount; ++frame)
+    {
+        if ((options.EditInterval > 0) && (frame > 0) && ((frame % options.EditInterval) == 0) && !branchRecords.empty())
+        {
+            branchRecords[0].seed += 1;
+        }
+
+        const auto frameStartTime = std::chrono::steady_clock::now();
+
+        const bool generated = generator.Update(branchRecords, areaRecords, sharedKey.Get(), output);
+        if (generated)
+        {
+            uploadRecords();
+        }
+        simulation.ArenaGrowths += generator.GetStatistics().ArenaGrowths;
+        simulation.PartitionLayouts += generator.GetStatistics().PartitionLayouts;
+
+        const double frameSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - frameStartTime).count();
+        (generated ? simulation.GeneratedFrameSeconds : simulation.CachedFrameSeconds).push_back(frameSeconds);
+
+        simulation.InstanceCounts.Add(frame, output.Arguments);
+    }
+
+    if (options.FrameCount == 0)
+    {
+        return simulation;
+    }
+
+    const uint32_t partitionCount = generator.GetPartitionCount();
+
+    for (uint32_t partition = 0; partition < partitionCount; ++partition)
+    {
+        PartitionEdit edit;
+        edit.Area = (partition >= branchRecords.size());
+        if (edit.Area)
+        {
+            areaRecords[partition - branchRecords.size()].seed += 1;
+        }
+        else
+        {
+            branchRecords[partition].seed += 1;
+        }
+
+        const auto editStartTime = std::chrono::steady_clock::now();
+        generator.Update(branchRecords, areaRecords, sharedKey.Get(), output);
+        uploadRecords();
+        edit.Seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - editStartTime).count();
+        simulation.ArenaGrowths += generator.GetStatistics().ArenaGrowths;
+        simulation.PartitionLayouts += generator.GetStatistics().PartitionLayouts;
+
+        edit.LeafInstances = generator.GetPartition(partition).LeafInstances.size();
+        edit.StemInstances = generator.GetPartition(partition).StemInstances.size();
+        simulation.PartitionEdits.push_back(edit);
+    }
+
+    simulation.RecordBufferSize = recordBuffer.GetSize();
+
+    // the arena only drops instances if it cannot grow beyond IVY_MAX_INSTANCES
+    simulation.ArenaCapacity     = generator.GetArena().GetCapacity();
+    simulation.PartitionCapacity = generator.GetArena().GetMaxPartitionCapacity();
+    simulation.ArenaSaturated    = generator.GetArena().IsSaturated();
+
+    // the compacted partitions have to hold the instances generated for the final inputs
+    IvyInstanceStreams reference;
+    engine.DispatchGraph(branchRecords, areaRecords, reference);
+
+    // both digests use the statistics of the reference, only the instances are compared
+    const IvyCpuEngine::Statistics& statistics = engine.GetStatistics();
+    simulation.Consistent = IvyOutputDigest::Compute(output, statistics).Matches(IvyOutputDigest::Compute(reference, statistics), 0.0, true);
+
+    return simulation;
+}
+
+int main(int argc, char** argv)
+{
+    BenchmarkOptions options;
+    if (!ParseOptions(argc, argv, options))
+    {
+        return 1;
+    }
+
+    // same phases as the startup of the sample: content loading, acceleration structure & the first generation
+    IvyStartupTimer startup;
+
+    IvyCpuScene scene;
+    if (!LoadBenchmarkScenes(options.Scenes, scene))
+    {
+        return 1;
+    }
+    startup.EndPhase("load_scenes");
+
+    scene.Build();
+    startup.EndPhase("build_scene");
+
+    if ((scene.GetIvyStemSurfaceIndex() < 0) || (scene.GetIvyLeafSurfaceIndex() < 0))
+    {
+        fprintf(stderr, "no Stem & Leaf meshes found, media/Ivy/ivy.gltf has to be one of the scenes\n");
+        return 1;
+    }
+
+    std::vector<IvyBranchRecord> branchRecords;
+    std::vector<IvyAreaRecord>   areaRecords;
+    GetDefaultRecords(branchRecords, areaRecords);
+
+    IvyOutputDigest golden;
+    if (!options.CheckGoldenPath.empty() && !ReadGolden(options.CheckGoldenPath, golden))
+    {
+        return 1;
+    }
+
+    IvyCpuEngine engine(scene, options.ThreadCount);
+    engine.SetPacketTracing(options.PacketTracing);
+    engine.SetDeterministicOrder(options.Deterministic);
+    startup.EndPhase("create_engine");
+
+    IvyInstanceStreams output;
+
+    // warm-up, allocates the per worker output vectors
+    engine.DispatchGraph(branchRecords, areaRecords, output);
+    startup.EndPhase("first_generation");
+
+    // with --deterministic, the order of the warm-up output has to be reproduced by every run
+    const uint64_t orderHash   = IvyOutputDigest::ComputeOrderHash(output);
+    bool           orderStable = true;
+
+    // every run is checked, the instance order changes with scheduling but the digest must not
+    std::vector<double>      runSeconds;
+    std::vector<std::string> goldenDifferences;
+    IvyOutputDigest          digest;
+    for (uint32_t run = 0; run < options.RunCount; ++run)
+    {
+        engine.DispatchGraph(branchRecords, areaRecords, output);
+        runSeconds.push_back(engine.GetStatistics().WallSeconds);
+
+        digest = IvyOutputDigest::Compute(output, engine.GetStatistics());
+        if (!options.CheckGoldenPath.empty() && goldenDifferences.empty())
+        {
+            digest.Matches(golden, options.Tolerance, options.Exact, &goldenDifferences);
+        }
+        if (options.Deterministic)
+        {
+            orderStable = orderStable && (IvyOutputDigest::ComputeOrderHash(output) == orderHash);
+        }
+    }
+
+    if (!options.WriteGoldenPath.empty() && !WriteGolden(options.WriteGoldenPath, options, digest))
+    {
+        return 1;
+    }
+
+    const double medianSeconds = Median(runSeconds);
+
+    // counts do not depend on scheduling, take them from the last run
+    const IvyCpuEngine::Statistics statistics = engine.GetStatistics();
+
+    const FrameSimulation simulation = SimulateFrames(engine, options, branchRecords, areaRecords);
+
+    // [0] leaf, [1] stem
+    InstanceClusters instanceClusters[2];
+    if (options.InstanceClusters)
+    {
+        const std::vector<IvyInstanceData>*  streams[2]     = {&output.LeafInstances, &output.StemInstances};
+        const std::vector<IvyInstanceRange>* groupRanges[2] = {&output.LeafGroupRanges, &output.StemGroupRanges};
+        const int                            surfaces[2]    = {scene.GetIvyLeafSurfaceIndex(), scene.GetIvyStemSurfaceIndex()};
+
+        std::vector<IvyInstanceCluster> groupClusters;
+        for (uint32_t stream = 0; stream < 2; ++stream)
+        {
+            const IvyAabb meshBounds  = scene.GetSurfaceBounds(surfaces[stream]);
+            const float4  localSphere = IvyGetLocalBoundingSphere(meshBounds.Min, meshBounds.Max);
+
+            const std::vector<IvyInstanceRange> runRange = {IvyInstanceRange{0, static_cast<uint32_t>(streams[stream]->size())}};
+            instanceClusters[stream].Runs.Compute(*streams[stream], localSphere, runRange, instanceClusters[stream].Clusters);
+            instanceClusters[stream].Groups.Compute(*streams[stream], localSphere, *groupRanges[stream], groupClusters);
+        }
+    }
+
+    // [0] leaf, [1] stem, read from the first scene with both meshes like IvyRenderModule::LoadMeshLods
+    MeshLods      meshLods[2];
+    LeafImpostors leafImpostors;
+    if (options.MeshLods || options.LeafImpostors)
+    {
+        const char* meshNames[2] = {"Leaf", "Stem"};
+
+        IvyGltfDocument document;
+        bool            found = false;
+        for (size_t i = 0; (i < options.Scenes.size()) && !found; ++i)
+        {
+            found = document.Load(options.Scenes[i]) && (document.FindMesh(meshNames[0]) >= 0) && (document.FindMesh(meshNames[1]) >= 0);
+        }
+
+        for (uint32_t stream = 0; stream < 2; ++stream)
+        {
+            std::vector<IvyMeshData> surfaces;
+            found = found && document.ReadMesh(document.FindMesh(meshNames[stream]), surfaces) && !surfaces.empty();
+            if (found && options.MeshLods)
+            {
+                meshLods[stream].Build(surfaces[0]);
+            }
+            if (found && options.LeafImpostors && (stream == 0))
+            {
+                leafImpostors.Bake(surfaces[0]);
+            }
+        }
+
+        if (options.LeafImpostors)
+        {
+            const IvyAabb meshBounds = scene.GetSurfaceBounds(scene.GetIvyLeafSurfaceIndex());
+            leafImpostors.BuildQuads(output.LeafInstances, IvyGetLocalBoundingSphere(meshBounds.Min, meshBounds.Max), instanceClusters[0].Clusters);
+        }
+    }
+
+    const std::vector<CullingResult> cullingResults =
+        options.FrustumCulling ? CullInstances(scene,
+                                               output,
+                                               options.OcclusionCulling,
+                                               options.InstanceClusters ? instanceClusters : nullptr,
+                                               options.MeshLods ? meshLods : nullptr,
+                                               options.LeafImpostors ? &leafImpostors : nullptr)
+                               : std::vector<CullingResult>();
+
+    IvyBackingMemorySweep backingMemorySweep;
+    bool                  backingMemoryConsistent = true;
+    if (options.BackingMemorySweep)
+    {
+        // requirements are derived from the statistics of the last unbounded dispatch
+        engine.DispatchGraph(branchRecords, areaRecords, output);
+        backingMemoryConsistent = SweepBackingMemory(engine, options, branchRecords, areaRecords, digest, backingMemorySweep);
+    }
+
+    IvyJsonWriter json;
+    json.BeginObject();
+    json.BeginArray("scenes");
+    for (const std::string& scenePath : options.Scenes)
+    {
+        json.Value(nullptr, scenePath);
+    }
+    json.EndArray();
+    json.Value("triangles", static_cast<uint64_t>(scene.GetTriangleCount()));
+    json.Value("load_seconds", startup.GetPhases().front().Seconds);
+    json.Value("bvh_build_seconds", scene.GetBvh().GetBuildStatistics().BuildSeconds);
+    startup.Write(json, "startup");
+    json.Value("simd", ivySimdInstructionSet);
+    json.Value("packet_tracing", options.PacketTracing);
+    json.Value("threads", statistics.ThreadCount);
+    json.BeginArray("run_seconds");
+    for (double seconds : runSeconds)
+    {
+        json.Value(nullptr, seconds);
+    }
+    json.EndArray();
+    json.Value("min_seconds", *std::min_element(runSeconds.begin(), runSeconds.end()));
+    json.Value("median_seconds", medianSeconds);
+    json.Value("branch_records", statistics.BranchRecords);
+    json.Value("area_records", statistics.AreaRecords);
+    json.Value("area_sample_threads", statistics.AreaSampleThreads);
+    json.Value("records_per_second", (medianSeconds > 0.0) ? statistics.BranchRecords / medianSeconds : 0.0);
+    json.Value("rays", statistics.RayCount);
+    json.Value("rays_per_second", (medianSeconds > 0.0) ? statistics.RayCount / medianSeconds : 0.0);
+    json.Value("leaf_instances", static_cast<uint64_t>(output.LeafInstances.size()));
+    json.Value("stem_instances", static_cast<uint64_t>(output.StemInstances.size()));
+    json.Value("recursion_levels", statistics.RecursionLevels);
+    json.Value("steals", statistics.StealCount);
+    json.Value("peak_queued_groups", statistics.PeakQueuedGroups);
+    json.BeginArray("levels");
+    for (const IvyCpuEngine::LevelStatistics& level : statistics.Levels)
+    {
+        json.BeginObject();
+        json.Value("records", level.Records);
+        json.Value("groups", level.Groups);
+        json.Value("rays", level.RayCount);
+        json.Value("busy_seconds", level.BusySeconds);
+        json.EndObject();
+    }
+    json.EndArray();
+    digest.Write(json, "digest");
+    if (!options.CheckGoldenPath.empty())
+    {
+        json.BeginObject("golden");
+        json.Value("file", options.CheckGoldenPath);
+        json.Value("tolerance", options.Tolerance);
+        json.Value("exact", options.Exact);
+        json.Value("passed", goldenDifferences.empty());
+        json.BeginArray("differences");
+        for (const std::string& difference : goldenDifferences)
+        {
+            json.Value(nullptr, difference);
+        }
+        json.EndArray();
+        json.EndObject();
+    }
+    if (options.Deterministic)
+    {
+        // compare order_hash between invocations with different --threads to check independence of the schedule
+        char orderHashString[32];
+        snprintf(orderHashString, sizeof(orderHashString), "%016" PRIx64, orderHash);
+
+        json.BeginObject("deterministic_order");
+        json.Value("order_hash", orderHashString);
+        json.Value("stable", orderStable);
+        json.EndObject();
+    }
+    if (options.FrameCount > 0)
+    {
+        const double generatedSeconds = Median(simulation.GeneratedFrameSeconds);
+        const double cachedSeconds    = Median(simulation.CachedFrameSeconds);
+
+        json.BeginObject("generation_cache");
+        json.Value("frames", options.FrameCount);
+        json.Value("edit_interval", options.EditInterval);
+        json.Value("generated_frames", static_cast<uint64_t>(simulation.GeneratedFrameSeconds.size()));
+        json.Value("cached_frames", static_cast<uint64_t>(simulation.CachedFrameSeconds.size()));
+        json.Value("median_generated_frame_seconds", generatedSeconds);
+        json.Value("median_cached_frame_seconds", cachedSeconds);
+        // generation time of all frames relative to dispatching the whole graph every frame
+        json.Value("time_fraction", (medianSeconds > 0.0) ? (generatedSeconds * simulation.GeneratedFrameSeconds.size() + cachedSeconds * simulation.CachedFrameSeconds.size()) / (medianSeconds * options.FrameCount) : 0.0);
+        json.BeginObject("entry_record_buffer");
+        json.Value("size", simulation.RecordBufferSize);
+        json.Value("uploaded_bytes", simulation.RecordUploadBytes);
+        json.EndObject();
+        json.BeginObject("instance_counts");
+        for (uint32_t stream = 0; stream < 2; ++stream)
+        {
+            json.BeginObject((stream == 0) ? "leaf" : "stem");
+            json.Value("latest", simulation.InstanceCounts.GetLatest().InstanceCount[stream]);
+            json.Value("peak", simulation.InstanceCounts.GetPeak(stream));
+            json.Value("average", simulation.InstanceCounts.GetAverage(stream));
+            json.EndObject();
+        }
+        json.EndObject();
+        json.BeginObject("instance_arena");
+        json.Value("initial_capacity", options.InitialCapacity);
+        json.Value("capacity", simulation.ArenaCapacity);
+        json.Value("max_partition_capacity", simulation.PartitionCapacity);
+        json.Value("layouts", simulation.PartitionLayouts);
+        json.Value("growths", simulation.ArenaGrowths);
+        json.Value("saturated", simulation.ArenaSaturated);
+        json.EndObject();
+        json.BeginArray("partition_edits");
+        for (const PartitionEdit& edit : simulation.PartitionEdits)
+        {
+            json.BeginObject();
+            json.Value("entry", edit.Area ? "IvyArea" : "IvyBranch");
+            json.Value("leaf_instances", edit.LeafInstances);
+            json.Value("stem_instances", edit.StemInstances);
+            json.Value("seconds", edit.Seconds);
+            json.EndObject();
+        }
+        json.EndArray();
+        json.Value("consistent", simulation.Consistent);
+        json.EndObject();
+    }
+    if (options.FrustumCulling)
+    {
+        const uint64_t instanceCount = output.LeafInstances.size() + output.StemInstances.size();
+
+        json.BeginObject("frustum_culling");
+        if (options.OcclusionCulling)
+        {
+            json.Value("depth_width", cullingDepthWidth);
+            json.Value("depth_height", cullingDepthHeight);
+        }
+        json.BeginArray("cameras");
+        for (const CullingResult& result : cullingResults)
+        {
+            json.BeginObject();
+            json.Value("camera", result.Camera);
+            json.Value("visible_leaf_instances", result.VisibleInstances[0]);
+            json.Value("visible_stem_instances", result.VisibleInstances[1]);
+            json.Value("visible_fraction", (instanceCount > 0) ? static_cast<double>(result.VisibleInstances[0] + result.VisibleInstances[1]) / instanceCount : 0.0);
+            if (options.OcclusionCulling)
+            {
+                json.Value("occluded_leaf_instances", result.OccludedInstances[0]);
+                json.Value("occluded_stem_instances", result.OccludedInstances[1]);
+                json.Value("depth_occluded_leaf_instances", result.DepthOccludedInstances[0]);
+                json.Value("depth_occluded_stem_instances", result.DepthOccludedInstances[1]);
+                json.Value("hiz_seconds", result.HiZSeconds);
+            }
+            if (options.InstanceClusters)
+            {
+                json.Value("visible_leaf_clusters", result.VisibleClusters[0]);
+                json.Value("visible_stem_clusters", result.VisibleClusters[1]);
+                json.Value("leaf_instance_tests", result.ClusterInstanceTests[0]);
+                json.Value("stem_instance_tests", result.ClusterInstanceTests[1]);
+                json.Value("cluster_seconds", result.ClusterSeconds);
+            }
+            if (options.MeshLods)
+            {
+                const char* lodNames[2] = {"leaf_lod_instances", "stem_lod_instances"};
+                for (uint32_t stream = 0; stream < 2; ++stream)
+                {
+                    json.BeginArray(lodNames[stream]);
+                    for (size_t lod = 0; lod < std::max(meshLods[stream].Chain.Lods.size(), size_t(1)); ++lod)
+                    {
+                        json.Value(nullptr, result.LodInstances[stream][lod]);
+                    }
+                    json.EndArray();
+                }
+                const uint64_t fullTriangles = result.FullTriangles[0] + result.FullTriangles[1];
+                json.Value("lod_triangles", result.LodTriangles[0] + result.LodTriangles[1]);
+                json.Value("full_triangles", fullTriangles);
+                json.Value("lod_triangle_fraction", (fullTriangles > 0) ? static_cast<double>(result.LodTriangles[0] + result.LodTriangles[1]) / fullTriangles : 1.0);
+            }
+            if (options.LeafImpostors)
+            {
+                json.Value("impostor_leaf_clusters", result.ImpostorClusters);
+                json.Value("impostor_quads", result.ImpostorQuads);
+                json.Value("geometry_leaf_instances", result.GeometryLeafInstances);
+                json.Value("leaf_triangles", result.LeafTriangles);
+                json.Value("impostor_leaf_triangles", result.ImpostorLeafTriangles);
+                json.Value("impostor_triangle_fraction", (result.LeafTriangles > 0) ? static_cast<double>(result.ImpostorLeafTriangles) / result.LeafTriangles : 1.0);
+            }
+            json.Value("seconds", result.Seconds);
+            json.EndObject();
+        }
+        json.EndArray();
+        json.EndObject();
+    }
+    if (options.InstanceClusters)
+    {
+        const char* streamNames[2] = {"leaf", "stem"};
+
+        json.BeginObject("instance_clusters");
+        json.Value("cluster_size", IVY_INSTANCE_CLUSTER_SIZE);
+        for (uint32_t stream = 0; stream < 2; ++stream)
+        {
+            json.BeginObject(streamNames[stream]);
+            instanceClusters[stream].Runs.Write(json, "runs");
+            instanceClusters[stream].Groups.Write(json, "groups");
+            json.EndObject();
+        }
+        json.EndObject();
+    }
+    if (options.MeshLods)
+    {
+        json.BeginObject("mesh_lods");
+        json.Value("render_height", lodRenderHeight);
+        json.Value("pixel_error", lodPixelError);
+        meshLods[0].Write(json, "leaf");
+        meshLods[1].Write(json, "stem");
+        json.EndObject();
+    }
+    if (options.LeafImpostors)
+    {
+        json.BeginObject("leaf_impostors");
+        json.Value("distance", impostorDistance);
+        json.Value("group_size", IVY_LEAF_IMPOSTOR_GROUP_SIZE);
+        leafImpostors.Write(json);
+        json.EndObject();
+    }
+    if (options.BackingMemorySweep)
+    {
+        json.BeginObject("backing_memory");
+        json.Value("unit", "queued IvyBranch groups");
+        backingMemorySweep.Write(json, "sweep");
+        json.Value("consistent", backingMemoryConsistent);
+        json.EndObject();
+    }
+    json.EndObject();
+
+    printf("%s\n", json.GetString().c_str());
+
+    return (goldenDifferences.empty() && orderStable && simulation.Consistent && backingMemoryConsistent) ? 0 : 1;
+}
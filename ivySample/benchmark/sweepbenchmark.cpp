@@ -0,0 +1,353 @@
+// This file is part of the AMD Work Graph Ivy Generation Sample.
+//
+// Copyright (c) 2024 Advanced Micro Devices, Inc. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+// Sweeps the ivy generation over area density, recursion depth, iterations per record & thread group coalescing
+// and reports instance counts, memory footprint and generation time for every point.
+//
+// Usage: IvySweepBenchmark [options] [scene.gltf ...]
+//   --densities <list>   IvyAreaRecord.density values (default 0.01,0.02,0.05,0.1,0.14,0.2,0.5,1)
+//   --recursion <list>   IvyGenerationSettings::MaxRecursion values (default 4,6,8,10,12,14)
+//   --iterations <list>  IvyGenerationSettings::ThreadGroupIterations values (default 1,2,4,6,8)
+//   --coalescing <list>  IvyGenerationSettings::ThreadGroupCoalescing values (default 1,2,4,8,16,32)
+//   --grid               run all combinations instead of sweeping one parameter at a time around the defaults
+//   --threads <count>    worker threads, 0 = hardware concurrency (default 0)
+//   --runs <count>       dispatches per point, the median wall time is reported (default 3)
+//   --csv                print CSV instead of JSON
+// Lists are comma separated. Scenes & entry records are the ones of the sample, see benchmarkutils.h.
+
+#include "benchmarkutils.h"
+
+#include "cpu/ivyjson.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+struct BenchmarkOptions
+{
+    std::vector<std::string> Scenes;
+    std::vector<double>      Densities   = {0.01, 0.02, 0.05, 0.1, 0.14, 0.2, 0.5, 1.0};
+    std::vector<double>      Recursion   = {4, 6, 8, 10, 12, 14};
+    std::vector<double>      Iterations  = {1, 2, 4, 6, 8};
+    std::vector<double>      Coalescing  = {1, 2, 4, 8, 16, 32};
+    bool                     Grid        = false;
+    uint32_t                 ThreadCount = 0;
+    uint32_t                 RunCount    = 3;
+    bool                     Csv         = false;
+};
+
+// Parameters & results of a single sweep point
+struct SweepPoint
+{
+    const char*           Axis    = "";
+    float                 Density = 0.f;
+    IvyGenerationSettings Settings;
+
+    double   MedianSeconds        = 0.0;
+    uint64_t LeafInstances        = 0;
+    uint64_t StemInstances        = 0;
+    uint64_t BranchRecords        = 0;
+    uint64_t RayCount             = 0;
+    uint32_t RecursionLevels      = 0;
+    uint64_t InstanceBytes        = 0;  // leaf & stem instance buffers
+    uint64_t RecordBytes          = 0;  // all IvyBranchRecords written during generation
+    uint64_t PeakLevelRecordBytes = 0;  // IvyBranchRecords of the widest recursion level
+};
+
+static std::vector<double> ParseList(const char* text)
+{
+    std::vector<double> values;
+    while (*text)
+    {
+        char*        end   = nullptr;
+        const double value = strtod(text, &end);
+        if (end == text)
+        {
+            break;
+        }
+        values.push_back(value);
+        text = (*end == ',') ? end + 1 : end;
+    }
+    return values;
+}
+
+static bool ParseOptions(int argc, char** argv, BenchmarkOptions& options)
+{
+    for (int i = 1; i < argc; ++i)
+    {
+        const bool hasValue = (i + 1 < argc);
+        if (!strcmp(argv[i], "--densities") && hasValue)
+        {
+            options.Densities = ParseList(argv[++i]);
+        }
+        else if (!strcmp(argv[i], "--recursion") && hasValue)
+        {
+            options.Recursion = ParseList(argv[++i]);
+        }
+        else if (!strcmp(argv[i], "--iterations") && hasValue)
+        {
+            options.Iterations = ParseList(argv[++i]);
+        }
+        else if (!strcmp(argv[i], "--coalescing") && hasValue)
+        {
+            options.Coalescing = ParseList(argv[++i]);
+        }
+        else if (!strcmp(argv[i], "--grid"))
+        {
+            options.Grid = true;
+        }
+        else if (!strcmp(argv[i], "--threads") && hasValue)
+        {
+            options.ThreadCount = static_cast<uint32_t>(strtoul(argv[++i], nullptr, 10));
+        }
+        else if (!strcmp(argv[i], "--runs") && hasValue)
+        {
+            options.RunCount = std::max(static_cast<uint32_t>(strtoul(argv[++i], nullptr, 10)), 1u);
+        }
+        else if (!strcmp(argv[i], "--csv"))
+        {
+            options.Csv = true;
+        }
+        else if (argv[i][0] == '-')
+        {
+            fprintf(stderr, "unknown option %s\n", argv[i]);
+            return false;
+        }
+        else
+        {
+            options.Scenes.push_back(argv[i]);
+        }
+    }
+
+    if (options.Scenes.empty())
+    {
+        options.Scenes = GetDefaultScenes();
+    }
+
+    if (options.Densities.empty() || options.Recursion.empty() || options.Iterations.empty() || options.Coalescing.empty())
+    {
+        fprintf(stderr, "parameter lists must not be empty\n");
+        return false;
+    }
+
+    return true;
+}
+
+static std::vector<SweepPoint> GeneratePoints(const BenchmarkOptions& options, float defaultDensity)
+{
+    std::vector<SweepPoint> points;
+
+    auto addPoint = [&](const char* axis, double density, double recursion, double iterations, double coalescing) {
+        SweepPoint point;
+        point.Axis                           = axis;
+        point.Density                        = static_cast<float>(density);
+        point.Settings.MaxRecursion          = static_cast<uint32_t>(recursion);
+        point.Settings.ThreadGroupIterations = static_cast<uint32_t>(iterations);
+        point.Settings.ThreadGroupCoalescing = static_cast<uint32_t>(coalescing);
+        points.push_back(point);
+    };
+
+    if (options.Grid)
+    {
+        for (double density : options.Densities)
+        {
+            for (double recursion : options.Recursion)
+            {
+                for (double iterations : options.Iterations)
+                {
+                    for (double coalescing : options.Coalescing)
+                    {
+                        addPoint("grid", density, recursion, iterations, coalescing);
+                    }
+                }
+            }
+        }
+        return points;
+    }
+
+    // one parameter at a time, all others at the shader defaults
+    const IvyGenerationSettings defaults;
+    for (double density : options.Densities)
+    {
+        addPoint("density", density, defaults.MaxRecursion, defaults.ThreadGroupIterations, defaults.ThreadGroupCoalescing);
+    }
+    for (double recursion : options.Recursion)
+    {
+        addPoint("recursion", defaultDensity, recursion, defaults.ThreadGroupIterations, defaults.ThreadGroupCoalescing);
+    }
+    for (double iterations : options.Iterations)
+    {
+        addPoint("iterations", defaultDensity, defaults.MaxRecursion, iterations, defaults.ThreadGroupCoalescing);
+    }
+    for (double coalescing : options.Coalescing)
+    {
+        addPoint("coalescing", defaultDensity, defaults.MaxRecursion, defaults.ThreadGroupIterations, coalescing);
+    }
+    return points;
+}
+
+static void RunPoint(IvyCpuEngine&                       engine,
+                     const std::vector<IvyBranchRecord>& branchRecords,
+                     std::vector<IvyAreaRecord>          areaRecords,
+                     uint32_t                            runCount,
+                     SweepPoint&                         point)
+{
+    for (IvyAreaRecord& areaRecord : areaRecords)
+    {
+        areaRecord.density = point.Density;
+    }
+
+    engine.SetGenerationSettings(point.Settings);
+    point.Settings = engine.GetGenerationSettings();
+
+    IvyInstanceStreams  output;
+    std::vector<double> runSeconds;
+    for (uint32_t run = 0; run < runCount; ++run)
+    {
+        engine.DispatchGraph(branchRecords, areaRecords, output);
+        runSeconds.push_back(engine.GetStatistics().WallSeconds);
+    }
+
+    const IvyCpuEngine::Statistics& statistics = engine.GetStatistics();
+
+    uint64_t peakLevelRecords = 0;
+    for (const IvyCpuEngine::LevelStatistics& level : statistics.Levels)
+    {
+        peakLevelRecords = std::max(peakLevelRecords, level.Records);
+    }
+
+    point.MedianSeconds        = Median(runSeconds);
+    point.LeafInstances        = output.LeafInstances.size();
+    point.StemInstances        = output.StemInstances.size();
+    point.BranchRecords        = statistics.BranchRecords;
+    point.RayCount             = statistics.RayCount;
+    point.RecursionLevels      = statistics.RecursionLevels;
+    point.InstanceBytes        = (point.LeafInstances + point.StemInstances) * sizeof(IvyInstanceData);
+    point.RecordBytes          = point.BranchRecords * sizeof(IvyBranchRecord);
+    point.PeakLevelRecordBytes = peakLevelRecords * sizeof(IvyBranchRecord);
+}
+
+static void PrintCsv(const std::vector<SweepPoint>& points)
+{
+    printf("axis,density,recursion,iterations,coalescing,leaf_instances,stem_instances,branch_records,rays,recursion_levels,"
+           "instance_bytes,record_bytes,peak_level_record_bytes,median_seconds,records_per_second\n");
+    for (const SweepPoint& point : points)
+    {
+        printf("%s,%g,%u,%u,%u,%llu,%llu,%llu,%llu,%u,%llu,%llu,%llu,%.9g,%.9g\n",
+               point.Axis,
+               point.Density,
+               point.Settings.MaxRecursion,
+               point.Settings.ThreadGroupIterations,
+               point.Settings.ThreadGroupCoalescing,
+               static_cast<unsigned long long>(point.LeafInstances),
+               static_cast<unsigned long long>(point.StemInstances),
+               static_cast<unsigned long long>(point.BranchRecords),
+               static_cast<unsigned long long>(point.RayCount),
+               point.RecursionLevels,
+               static_cast<unsigned long long>(point.InstanceBytes),
+               static_cast<unsigned long long>(point.RecordBytes),
+               static_cast<unsigned long long>(point.PeakLevelRecordBytes),
+               point.MedianSeconds,
+               (point.MedianSeconds > 0.0) ? point.BranchRecords / point.MedianSeconds : 0.0);
+    }
+}
+
+static void PrintJson(const BenchmarkOptions& options, const IvyCpuScene& scene, uint32_t threadCount, const std::vector<SweepPoint>& points)
+{
+    IvyJsonWriter json;
+    json.BeginObject();
+    json.BeginArray("scenes");
+    for (const std::string& scenePath : options.Scenes)
+    {
+        json.Value(nullptr, scenePath);
+    }
+    json.EndArray();
+    json.Value("triangles", static_cast<uint64_t>(scene.GetTriangleCount()));
+    json.Value("threads", threadCount);
+    json.Value("runs", options.RunCount);
+    json.BeginArray("points");
+    for (const SweepPoint& point : points)
+    {
+        json.BeginObject();
+        json.Value("axis", point.Axis);
+        json.Value("density", static_cast<double>(point.Density));
+        json.Value("recursion", point.Settings.MaxRecursion);
+        json.Value("iterations", point.Settings.ThreadGroupIterations);
+        json.Value("coalescing", point.Settings.ThreadGroupCoalescing);
+        json.Value("leaf_instances", point.LeafInstances);
+        json.Value("stem_instances", point.StemInstances);
+        json.Value("branch_records", point.BranchRecords);
+        json.Value("rays", point.RayCount);
+        json.Value("recursion_levels", point.RecursionLevels);
+        json.Value("instance_bytes", point.InstanceBytes);
+        json.Value("record_bytes", point.RecordBytes);
+        json.Value("peak_level_record_bytes", point.PeakLevelRecordBytes);
+        json.Value("median_seconds", point.MedianSeconds);
+        json.Value("records_per_second", (point.MedianSeconds > 0.0) ? point.BranchRecords / point.MedianSeconds : 0.0);
+        json.EndObject();
+    }
+    json.EndArray();
+    json.EndObject();
+
+    printf("%s\n", json.GetString().c_str());
+}
+
+int main(int argc, char** argv)
+{
+    BenchmarkOptions options;
+    if (!ParseOptions(argc, argv, options))
+    {
+        return 1;
+    }
+
+    IvyCpuScene scene;
+    if (!LoadBenchmarkScenes(options.Scenes, scene))
+    {
+        return 1;
+    }
+    scene.Build();
+
+    std::vector<IvyBranchRecord> branchRecords;
+    std::vector<IvyAreaRecord>   areaRecords;
+    GetDefaultRecords(branchRecords, areaRecords);
+
+    std::vector<SweepPoint> points = GeneratePoints(options, areaRecords.front().density);
+
+    IvyCpuEngine engine(scene, options.ThreadCount);
+    for (SweepPoint& point : points)
+    {
+        RunPoint(engine, branchRecords, areaRecords, options.RunCount, point);
+    }
+
+    if (options.Csv)
+    {
+        PrintCsv(points);
+    }
+    else
+    {
+        PrintJson(options, scene, engine.GetStatistics().ThreadCount, points);
+    }
+
+    return 0;
+}
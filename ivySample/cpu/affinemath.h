@@ -0,0 +1,430 @@
+// This file is part of the AMD Work Graph Ivy Generation Sample.
+//
+// Copyright (c) 2024 Advanced Micro Devices, Inc. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+#pragma once
+
+// 3x4 affine transforms for the CPU port of the ivy generation shaders.
+//
+// The shaders chain up to five float4x4 multiplies per output (see mmul in shaders/utils.hlsl), although every
+// matrix involved is affine. Affine:: works on float3x4 (rows of the upper 3x4 part, the last row is implicitly
+// (0, 0, 0, 1)) and keeps RotateX/Y/Z, Translate & Scale as small factor types, which are expanded to 3x4 for the
+// SSE/AVX2 product. Without SIMD, multiplying by a factor only multiplies the affected elements.
+//
+// All products evaluate the sums of the float4x4 versions in cpu/ivyutils.h in the same order. The scalar kernels
+// skip multiplications by an exact 1, but still add the products with the exact zeros, since the sign of a zero
+// result depends on them & Hash() hashes the bits. Results are therefore bit-identical to the float4x4 reference,
+// including the sign of zero, see benchmark/affinebenchmark.cpp & IvyAffineEngineTest.
+//
+// float3x4 is also the 48 byte output format of the instance writers (IvyBranchGroupOutput).
+
+#include "cpu/hlslmath.h"
+#include "cpu/ivyutils.h"
+#include "cpu/simdmath.h"
+
+inline uint32_t Hash(const float3x4& mat)
+{
+    // same as Hash(float4x4) of the full affine matrix
+    return CombineSeed(Hash(mat[0]), Hash(mat[1]), Hash(mat[2]), Hash(float4(0, 0, 0, 1)));
+}
+
+namespace Affine
+{
+    // ========================
+    // Factors
+
+    struct RotationX
+    {
+        float Cos;
+        float Sin;
+    };
+
+    struct RotationY
+    {
+        float Cos;
+        float Sin;
+    };
+
+    struct RotationZ
+    {
+        float Cos;
+        float Sin;
+    };
+
+    struct Translation
+    {
+        float3 Offset;
+    };
+
+    struct Scaling
+    {
+        float3 Factor;
+    };
+
+    inline float3x4 Identity()
+    {
+        return float3x4(IdentityMatrix());
+    }
+
+    inline RotationX RotateX(float a)
+    {
+        return {std::cos(a), std::sin(a)};
+    }
+
+    inline RotationY RotateY(float a)
+    {
+        return {std::cos(a), std::sin(a)};
+    }
+
+    inline RotationZ RotateZ(float a)
+    {
+        return {std::cos(a), std::sin(a)};
+    }
+
+    inline Translation Translate(float tx, float ty, float tz)
+    {
+        return {float3(tx, ty, tz)};
+    }
+
+    inline Translation Translate(const float3& t)
+    {
+        return {t};
+    }
+
+    inline Scaling Scale(float sx, float sy, float sz)
+    {
+        return {float3(sx, sy, sz)};
+    }
+
+    inline float3x4 Rotate(const float3& forward, const float3& up)
+    {
+        const float3 y = normalize(up);
+        const float3 z = normalize(cross(forward, y));
+        const float3 x = normalize(cross(y, z));
+
+        // x, y & z are the columns of the rotation, see ::Rotate()
+        float3x4 result;
+        result[0] = float4(x.x, y.x, z.x, 0);
+        result[1] = float4(x.y, y.y, z.y, 0);
+        result[2] = float4(x.z, y.z, z.z, 0);
+        return result;
+    }
+
+    // ========================
+    // Conversions
+
+    inline float3x4 ToFloat3x4(const float3x4& mat)
+    {
+        return mat;
+    }
+
+    inline float3x4 ToFloat3x4(const RotationX& r)
+    {
+        float3x4 result;
+        result[0] = float4(1, 0, 0, 0);
+        result[1] = float4(0, r.Cos, -r.Sin, 0);
+        result[2] = float4(0, r.Sin, r.Cos, 0);
+        return result;
+    }
+
+    inline float3x4 ToFloat3x4(const RotationY& r)
+    {
+        float3x4 result;
+        result[0] = float4(r.Cos, 0, r.Sin, 0);
+        result[1] = float4(0, 1, 0, 0);
+        result[2] = float4(-r.Sin, 0, r.Cos, 0);
+        return result;
+    }
+
+    inline float3x4 ToFloat3x4(const RotationZ& r)
+    {
+        float3x4 result;
+        result[0] = float4(r.Cos, -r.Sin, 0, 0);
+        result[1] = float4(r.Sin, r.Cos, 0, 0);
+        result[2] = float4(0, 0, 1, 0);
+        return result;
+    }
+
+    inline float3x4 ToFloat3x4(const Translation& t)
+    {
+        float3x4 result;
+        result[0] = float4(1, 0, 0, t.Offset.x);
+        result[1] = float4(0, 1, 0, t.Offset.y);
+        result[2] = float4(0, 0, 1, t.Offset.z);
+        return result;
+    }
+
+    inline float3x4 ToFloat3x4(const Scaling& s)
+    {
+        float3x4 result;
+        result[0] = float4(s.Factor.x, 0, 0, 0);
+        result[1] = float4(0, s.Factor.y, 0, 0);
+        result[2] = float4(0, 0, s.Factor.z, 0);
+        return result;
+    }
+
+    // Records & instance data store matrices column-major (see ivycommon.h), the last row is dropped
+    inline float3x4 ToFloat3x4(const Mat4& mat)
+    {
+        float3x4 result;
+        for (int row = 0; row < 3; ++row)
+        {
+            result[row] = float4(mat.getElem(0, row), mat.getElem(1, row), mat.getElem(2, row), mat.getElem(3, row));
+        }
+        return result;
+    }
+
+    inline Mat4 ToMat4(const float3x4& mat)
+    {
+        return Mat4(Vec4(mat[0].x, mat[1].x, mat[2].x, 0),
+                    Vec4(mat[0].y, mat[1].y, mat[2].y, 0),
+                    Vec4(mat[0].z, mat[1].z, mat[2].z, 0),
+                    Vec4(mat[0].w, mat[1].w, mat[2].w, 1));
+    }
+
+    // ========================
+    // Transforms, equivalent to mul(float4x4, float4(p, 1)) & mul(float3x3, v)
+
+    inline float3 TransformPoint(const float3x4& mat, const float3& p)
+    {
+        return float3(dot(mat[0], float4(p, 1)), dot(mat[1], float4(p, 1)), dot(mat[2], float4(p, 1)));
+    }
+
+    inline float3 TransformVector(const float3x4& mat, const float3& v)
+    {
+        return float3(dot(mat[0].xyz(), v), dot(mat[1].xyz(), v), dot(mat[2].xyz(), v));
+    }
+
+    inline float3 GetColumn(const float3x4& mat, int column)
+    {
+        return float3(mat[0][column], mat[1][column], mat[2][column]);
+    }
+
+    // ========================
+    // Products
+
+    inline float3x4 mul(const float3x4& a, const float3x4& b)
+    {
+        float3x4 result;
+#if defined(IVY_SIMD_AVX2) || defined(IVY_SIMD_SSE)
+        // result row = a[r][0] * b[0] + a[r][1] * b[1] + a[r][2] * b[2] + a[r][3] * (0, 0, 0, 1)
+        const __m128 b0 = _mm_loadu_ps(&b[0].x);
+        const __m128 b1 = _mm_loadu_ps(&b[1].x);
+        const __m128 b2 = _mm_loadu_ps(&b[2].x);
+        const __m128 w  = _mm_set_ps(1.f, 0.f, 0.f, 0.f);
+#if defined(IVY_SIMD_AVX2)
+        // rows 0 & 1 in the two halves of one AVX register
+        const __m256 a01 = _mm256_loadu_ps(&a[0].x);
+        const __m256 b00 = _mm256_insertf128_ps(_mm256_castps128_ps256(b0), b0, 1);
+        const __m256 b11 = _mm256_insertf128_ps(_mm256_castps128_ps256(b1), b1, 1);
+        const __m256 b22 = _mm256_insertf128_ps(_mm256_castps128_ps256(b2), b2, 1);
+        const __m256 ww  = _mm256_insertf128_ps(_mm256_castps128_ps256(w), w, 1);
+
+        __m256 r01 = _mm256_mul_ps(_mm256_permute_ps(a01, 0x00), b00);
+        r01        = _mm256_add_ps(r01, _mm256_mul_ps(_mm256_permute_ps(a01, 0x55), b11));
+        r01        = _mm256_add_ps(r01, _mm256_mul_ps(_mm256_permute_ps(a01, 0xaa), b22));
+        r01        = _mm256_add_ps(r01, _mm256_mul_ps(_mm256_permute_ps(a01, 0xff), ww));
+        _mm256_storeu_ps(&result[0].x, r01);
+        const int firstRow = 2;
+#else
+        const int firstRow = 0;
+#endif
+        for (int row = firstRow; row < 3; ++row)
+        {
+            const __m128 ar = _mm_loadu_ps(&a[row].x);
+
+            __m128 r = _mm_mul_ps(_mm_shuffle_ps(ar, ar, 0x00), b0);
+            r        = _mm_add_ps(r, _mm_mul_ps(_mm_shuffle_ps(ar, ar, 0x55), b1));
+            r        = _mm_add_ps(r, _mm_mul_ps(_mm_shuffle_ps(ar, ar, 0xaa), b2));
+            r        = _mm_add_ps(r, _mm_mul_ps(_mm_shuffle_ps(ar, ar, 0xff), w));
+            _mm_storeu_ps(&result[row].x, r);
+        }
+#else
+        for (int row = 0; row < 3; ++row)
+        {
+            for (int column = 0; column < 4; ++column)
+            {
+                result[row][column] = a[row][0] * b[0][column] + a[row][1] * b[1][column] + a[row][2] * b[2][column] + a[row][3] * (column == 3 ? 1.f : 0.f);
+            }
+        }
+#endif
+        return result;
+    }
+
+#if defined(IVY_SIMD_AVX2) || defined(IVY_SIMD_SSE)
+    // The vector product evaluates all terms of the float4x4 sums anyway, so the factors are expanded to 3x4
+    inline float3x4 mul(const float3x4& a, const RotationX& b)
+    {
+        return mul(a, ToFloat3x4(b));
+    }
+
+    inline float3x4 mul(const float3x4& a, const RotationY& b)
+    {
+        return mul(a, ToFloat3x4(b));
+    }
+
+    inline float3x4 mul(const float3x4& a, const RotationZ& b)
+    {
+        return mul(a, ToFloat3x4(b));
+    }
+
+    inline float3x4 mul(const float3x4& a, const Translation& b)
+    {
+        return mul(a, ToFloat3x4(b));
+    }
+
+    inline float3x4 mul(const float3x4& a, const Scaling& b)
+    {
+        return mul(a, ToFloat3x4(b));
+    }
+
+#else
+    // Products of a row with the exact zeros of a factor. The kernels add them like the float4x4 sums do, which keeps
+    // the sign of zero results: +0 unless every term is -0 (0 * x has the sign of x).
+    inline float4 ZeroProducts(const float4& row)
+    {
+        return float4(row.x * 0.f, row.y * 0.f, row.z * 0.f, row.w * 0.f);
+    }
+
+    inline float3x4 mul(const float3x4& a, const RotationX& b)
+    {
+        float3x4 result;
+        for (int row = 0; row < 3; ++row)
+        {
+            const float4& r = a[row];
+            const float4  z = ZeroProducts(r);
+            result[row].x   = r.x + z.y + z.z + z.w;
+            result[row].y   = z.x + r.y * b.Cos + r.z * b.Sin + z.w;
+            result[row].z   = z.x + r.y * -b.Sin + r.z * b.Cos + z.w;
+            result[row].w   = z.x + z.y + z.z + r.w;
+        }
+        return result;
+    }
+
+    inline float3x4 mul(const float3x4& a, const RotationY& b)
+    {
+        float3x4 result;
+        for (int row = 0; row < 3; ++row)
+        {
+            const float4& r = a[row];
+            const float4  z = ZeroProducts(r);
+            result[row].x   = r.x * b.Cos + z.y + r.z * -b.Sin + z.w;
+            result[row].y   = z.x + r.y + z.z + z.w;
+            result[row].z   = r.x * b.Sin + z.y + r.z * b.Cos + z.w;
+            result[row].w   = z.x + z.y + z.z + r.w;
+        }
+        return result;
+    }
+
+    inline float3x4 mul(const float3x4& a, const RotationZ& b)
+    {
+        float3x4 result;
+        for (int row = 0; row < 3; ++row)
+        {
+            const float4& r = a[row];
+            const float4  z = ZeroProducts(r);
+            result[row].x   = r.x * b.Cos + r.y * b.Sin + z.z + z.w;
+            result[row].y   = r.x * -b.Sin + r.y * b.Cos + z.z + z.w;
+            result[row].z   = z.x + z.y + r.z + z.w;
+            result[row].w   = z.x + z.y + z.z + r.w;
+        }
+        return result;
+    }
+
+    inline float3x4 mul(const float3x4& a, const Translation& b)
+    {
+        float3x4 result;
+        for (int row = 0; row < 3; ++row)
+        {
+            const float4& r = a[row];
+            const float4  z = ZeroProducts(r);
+            result[row].x   = r.x + z.y + z.z + z.w;
+            result[row].y   = z.x + r.y + z.z + z.w;
+            result[row].z   = z.x + z.y + r.z + z.w;
+            result[row].w   = r.x * b.Offset.x + r.y * b.Offset.y + r.z * b.Offset.z + r.w;
+        }
+        return result;
+    }
+
+    inline float3x4 mul(const float3x4& a, const Scaling& b)
+    {
+        float3x4 result;
+        for (int row = 0; row < 3; ++row)
+        {
+            const float4& r = a[row];
+            const float4  z = ZeroProducts(r);
+            result[row].x   = r.x * b.Factor.x + z.y + z.z + z.w;
+            result[row].y   = z.x + r.y * b.Factor.y + z.z + z.w;
+            result[row].z   = z.x + z.y + r.z * b.Factor.z + z.w;
+            result[row].w   = z.x + z.y + z.z + r.w;
+        }
+        return result;
+    }
+
+    inline float3x4 mul(const Translation& a, const float3x4& b)
+    {
+        // column c of row i sums b[i][c], the zero products of the other rows of b & the offset times (0, 0, 0, 1)[c]
+        const float4 z[3] = {ZeroProducts(b[0]), ZeroProducts(b[1]), ZeroProducts(b[2])};
+        const float  t[3] = {a.Offset.x, a.Offset.y, a.Offset.z};
+        float3x4     result;
+        for (int row = 0; row < 3; ++row)
+        {
+            const float  zt = t[row] * 0.f;
+            const float4 r0 = (row == 0) ? b[0] : z[0];
+            const float4 r1 = (row == 1) ? b[1] : z[1];
+            const float4 r2 = (row == 2) ? b[2] : z[2];
+            result[row].x   = r0.x + r1.x + r2.x + zt;
+            result[row].y   = r0.y + r1.y + r2.y + zt;
+            result[row].z   = r0.z + r1.z + r2.z + zt;
+            result[row].w   = r0.w + r1.w + r2.w + t[row];
+        }
+        return result;
+    }
+
+#endif
+
+    // any other combination goes through the general product
+    template <typename A, typename B>
+    float3x4 mul(const A& a, const B& b)
+    {
+        return mul(ToFloat3x4(a), ToFloat3x4(b));
+    }
+
+    template <typename A>
+    float3x4 mmul(const A& a)
+    {
+        return ToFloat3x4(a);
+    }
+
+    /**
+     * @brief   Fused version of mmul in shaders/utils.hlsl, multiplies from left to right.
+     */
+    template <typename A, typename B, typename... Factors>
+    float3x4 mmul(const A& a, const B& b, const Factors&... rest)
+    {
+#if defined(IVY_AFFINE_FLOAT4X4)
+        // Reference build (IvyCpuFloat4x4): full float4x4 products like the shaders, the engine output has to match bit for bit
+        return float3x4(::mmul(ToFloat4x4(ToFloat3x4(a)), ToFloat4x4(ToFloat3x4(b)), ToFloat4x4(ToFloat3x4(rest))...));
+#else
+        return mmul(mul(a, b), rest...);
+#endif
+    }
+}  // namespace Affine
@@ -0,0 +1,209 @@
+// This file is part of the AMD Work Graph Ivy Generation Sample.
+//
+// Copyright (c) 2024 Advanced Micro Devices, Inc. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+#pragma once
+
+// Minimal stand-in for Cauldron's misc/math.h (Vectormath) for headless builds.
+// Only the subset used by the shared record structs in shaders/ivycommon.h and by host code
+// creating records is provided. Memory layout matches Vectormath: 16 byte aligned, column-major.
+
+#include <cmath>
+#include <cstdint>
+
+struct Vec3
+{
+    float x = 0.f;
+    float y = 0.f;
+    float z = 0.f;
+
+    Vec3() = default;
+    Vec3(float x, float y, float z)
+        : x(x)
+        , y(y)
+        , z(z)
+    {
+    }
+
+    float getX() const
+    {
+        return x;
+    }
+    float getY() const
+    {
+        return y;
+    }
+    float getZ() const
+    {
+        return z;
+    }
+
+    float operator[](int i) const
+    {
+        return (&x)[i];
+    }
+};
+
+struct alignas(16) Vec4
+{
+    float x = 0.f;
+    float y = 0.f;
+    float z = 0.f;
+    float w = 0.f;
+
+    Vec4() = default;
+    Vec4(float x, float y, float z, float w)
+        : x(x)
+        , y(y)
+        , z(z)
+        , w(w)
+    {
+    }
+    Vec4(const Vec3& xyz, float w)
+        : x(xyz.x)
+        , y(xyz.y)
+        , z(xyz.z)
+        , w(w)
+    {
+    }
+
+    float getX() const
+    {
+        return x;
+    }
+    float getY() const
+    {
+        return y;
+    }
+    float getZ() const
+    {
+        return z;
+    }
+    float getW() const
+    {
+        return w;
+    }
+    Vec3 getXYZ() const
+    {
+        return Vec3(x, y, z);
+    }
+
+    float& operator[](int i)
+    {
+        return (&x)[i];
+    }
+    float operator[](int i) const
+    {
+        return (&x)[i];
+    }
+};
+
+struct alignas(16) Mat4
+{
+    Vec4 col[4];
+
+    Mat4() = default;
+    Mat4(const Vec4& col0, const Vec4& col1, const Vec4& col2, const Vec4& col3)
+        : col{col0, col1, col2, col3}
+    {
+    }
+
+    static Mat4 identity()
+    {
+        return Mat4(Vec4(1, 0, 0, 0), Vec4(0, 1, 0, 0), Vec4(0, 0, 1, 0), Vec4(0, 0, 0, 1));
+    }
+
+    static Mat4 translation(const Vec3& t)
+    {
+        return Mat4(Vec4(1, 0, 0, 0), Vec4(0, 1, 0, 0), Vec4(0, 0, 1, 0), Vec4(t, 1));
+    }
+
+    static Mat4 scale(const Vec3& s)
+    {
+        return Mat4(Vec4(s.x, 0, 0, 0), Vec4(0, s.y, 0, 0), Vec4(0, 0, s.z, 0), Vec4(0, 0, 0, 1));
+    }
+
+    static Mat4 rotationX(float radians)
+    {
+        const float s = std::sin(radians);
+        const float c = std::cos(radians);
+        return Mat4(Vec4(1, 0, 0, 0), Vec4(0, c, s, 0), Vec4(0, -s, c, 0), Vec4(0, 0, 0, 1));
+    }
+
+    static Mat4 rotationY(float radians)
+    {
+        const float s = std::sin(radians);
+        const float c = std::cos(radians);
+        return Mat4(Vec4(c, 0, -s, 0), Vec4(0, 1, 0, 0), Vec4(s, 0, c, 0), Vec4(0, 0, 0, 1));
+    }
+
+    static Mat4 rotationZ(float radians)
+    {
+        const float s = std::sin(radians);
+        const float c = std::cos(radians);
+        return Mat4(Vec4(c, s, 0, 0), Vec4(-s, c, 0, 0), Vec4(0, 0, 1, 0), Vec4(0, 0, 0, 1));
+    }
+
+    const Vec4& getCol(int i) const
+    {
+        return col[i];
+    }
+    const Vec4& getCol3() const
+    {
+        return col[3];
+    }
+    void setCol(int i, const Vec4& v)
+    {
+        col[i] = v;
+    }
+
+    Vec4 getRow(int i) const
+    {
+        return Vec4(col[0][i], col[1][i], col[2][i], col[3][i]);
+    }
+
+    float getElem(int column, int row) const
+    {
+        return col[column][row];
+    }
+    void setElem(int column, int row, float value)
+    {
+        col[column][row] = value;
+    }
+
+    Vec4 operator*(const Vec4& v) const
+    {
+        Vec4 result;
+        for (int row = 0; row < 4; ++row)
+        {
+            result[row] = col[0][row] * v.x + col[1][row] * v.y + col[2][row] * v.z + col[3][row] * v.w;
+        }
+        return result;
+    }
+
+    Mat4 operator*(const Mat4& other) const
+    {
+        return Mat4(*this * other.col[0], *this * other.col[1], *this * other.col[2], *this * other.col[3]);
+    }
+};
+
+static_assert(sizeof(Vec4) == 16, "Vec4 must match Vectormath layout");
+static_assert(sizeof(Mat4) == 64, "Mat4 must match Vectormath layout");
@@ -0,0 +1,377 @@
+// This file is part of the AMD Work Graph Ivy Generation Sample.
+//
+// Copyright (c) 2024 Advanced Micro Devices, Inc. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+#pragma once
+
+// HLSL-style vector & matrix types for the CPU port of the ivy generation shaders.
+// Matrices follow HLSL semantics: operator[] returns a row and mul(M, v) treats v as a column vector.
+// Conversion helpers to/from Mat4 account for the column-major layout of records and instance data.
+
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+
+struct float2
+{
+    float x = 0.f;
+    float y = 0.f;
+
+    float2() = default;
+    float2(float x, float y)
+        : x(x)
+        , y(y)
+    {
+    }
+};
+
+struct float3
+{
+    float x = 0.f;
+    float y = 0.f;
+    float z = 0.f;
+
+    float3() = default;
+    explicit float3(float s)
+        : x(s)
+        , y(s)
+        , z(s)
+    {
+    }
+    float3(float x, float y, float z)
+        : x(x)
+        , y(y)
+        , z(z)
+    {
+    }
+
+    float& operator[](int i)
+    {
+        return (&x)[i];
+    }
+    float operator[](int i) const
+    {
+        return (&x)[i];
+    }
+};
+
+struct float4
+{
+    float x = 0.f;
+    float y = 0.f;
+    float z = 0.f;
+    float w = 0.f;
+
+    float4() = default;
+    float4(float x, float y, float z, float w)
+        : x(x)
+        , y(y)
+        , z(z)
+        , w(w)
+    {
+    }
+    float4(const float3& xyz, float w)
+        : x(xyz.x)
+        , y(xyz.y)
+        , z(xyz.z)
+        , w(w)
+    {
+    }
+
+    float3 xyz() const
+    {
+        return float3(x, y, z);
+    }
+
+    float& operator[](int i)
+    {
+        return (&x)[i];
+    }
+    float operator[](int i) const
+    {
+        return (&x)[i];
+    }
+};
+
+struct uint3
+{
+    uint32_t x = 0;
+    uint32_t y = 0;
+    uint32_t z = 0;
+};
+
+// ========================
+// Vector operators & intrinsics
+
+inline float3 operator+(const float3& a, const float3& b)
+{
+    return float3(a.x + b.x, a.y + b.y, a.z + b.z);
+}
+inline float3 operator-(const float3& a, const float3& b)
+{
+    return float3(a.x - b.x, a.y - b.y, a.z - b.z);
+}
+inline float3 operator-(const float3& a)
+{
+    return float3(-a.x, -a.y, -a.z);
+}
+inline float3 operator*(const float3& a, float s)
+{
+    return float3(a.x * s, a.y * s, a.z * s);
+}
+inline float3 operator*(float s, const float3& a)
+{
+    return float3(a.x * s, a.y * s, a.z * s);
+}
+inline float3 operator+(const float3& a, float s)
+{
+    return float3(a.x + s, a.y + s, a.z + s);
+}
+inline float3 operator-(const float3& a, float s)
+{
+    return float3(a.x - s, a.y - s, a.z - s);
+}
+inline float3 operator/(const float3& a, float s)
+{
+    return float3(a.x / s, a.y / s, a.z / s);
+}
+
+inline float dot(const float3& a, const float3& b)
+{
+    return a.x * b.x + a.y * b.y + a.z * b.z;
+}
+inline float dot(const float4& a, const float4& b)
+{
+    return a.x * b.x + a.y * b.y + a.z * b.z + a.w * b.w;
+}
+
+inline float3 cross(const float3& a, const float3& b)
+{
+    return float3(a.y * b.z - a.z * b.y, a.z * b.x - a.x * b.z, a.x * b.y - a.y * b.x);
+}
+
+inline float length(const float3& v)
+{
+    return std::sqrt(dot(v, v));
+}
+
+inline float distance(const float3& a, const float3& b)
+{
+    return length(b - a);
+}
+
+inline float3 normalize(const float3& v)
+{
+    return v / length(v);
+}
+
+inline bool any_isnan(const float3& v)
+{
+    return std::isnan(v.x) || std::isnan(v.y) || std::isnan(v.z);
+}
+
+inline uint32_t countbits(uint32_t value)
+{
+    value = value - ((value >> 1) & 0x55555555u);
+    value = (value & 0x33333333u) + ((value >> 2) & 0x33333333u);
+    return (((value + (value >> 4)) & 0x0f0f0f0fu) * 0x01010101u) >> 24;
+}
+
+inline uint32_t asuint(float f)
+{
+    uint32_t u;
+    std::memcpy(&u, &f, sizeof(u));
+    return u;
+}
+
+inline float asfloat(uint32_t u)
+{
+    float f;
+    std::memcpy(&f, &u, sizeof(f));
+    return f;
+}
+
+// Half precision conversion in the low 16 bits, rounds to nearest even
+inline uint32_t f32tof16(float value)
+{
+    const uint32_t bits    = asuint(value);
+    const uint32_t sign    = (bits >> 16) & 0x8000u;
+    const uint32_t absBits = bits & 0x7fffffffu;
+
+    if (absBits >= 0x7f800000u)
+    {
+        // Inf & NaN
+        return sign | ((absBits > 0x7f800000u) ? 0x7e00u : 0x7c00u);
+    }
+    if (absBits >= 0x477ff000u)
+    {
+        // >= 65520 rounds to Inf
+        return sign | 0x7c00u;
+    }
+    if (absBits < 0x38800000u)
+    {
+        // subnormal half, smaller than 2^-25 rounds to zero
+        const uint32_t exponent = absBits >> 23;
+        if (exponent < 102)
+        {
+            return sign;
+        }
+
+        const uint32_t mantissa  = (absBits & 0x7fffffu) | 0x800000u;
+        const uint32_t shift     = 126 - exponent;
+        const uint32_t remainder = mantissa & ((1u << shift) - 1);
+        const uint32_t halfway   = 1u << (shift - 1);
+
+        uint32_t half = mantissa >> shift;
+        if ((remainder > halfway) || ((remainder == halfway) && (half & 1)))
+        {
+            ++half;
+        }
+        return sign | half;
+    }
+
+    // rebias exponent from 127 to 15, a mantissa carry correctly increments the exponent
+    uint32_t       half      = (absBits - 0x38000000u) >> 13;
+    const uint32_t remainder = absBits & 0x1fffu;
+    if ((remainder > 0x1000u) || ((remainder == 0x1000u) && (half & 1)))
+    {
+        ++half;
+    }
+    return sign | half;
+}
+
+inline float f16tof32(uint32_t value)
+{
+    const uint32_t sign     = (value & 0x8000u) << 16;
+    const uint32_t exponent = (value >> 10) & 0x1fu;
+    const uint32_t mantissa = value & 0x3ffu;
+
+    if (exponent == 0)
+    {
+        // zero & subnormal, mantissa * 2^-24
+        const float magnitude = static_cast<float>(mantissa) * 5.9604644775390625e-8f;
+        return sign ? -magnitude : magnitude;
+    }
+    if (exponent == 31)
+    {
+        return asfloat(sign | 0x7f800000u | (mantissa << 13));
+    }
+    return asfloat(sign | ((exponent + 112) << 23) | (mantissa << 13));
+}
+
+// ========================
+// Matrices (row storage, HLSL semantics)
+
+struct float4x4
+{
+    float4 m[4];
+
+    float4x4() = default;
+    float4x4(const float4& r0, const float4& r1, const float4& r2, const float4& r3)
+        : m{r0, r1, r2, r3}
+    {
+    }
+    float4x4(float m00, float m01, float m02, float m03,
+             float m10, float m11, float m12, float m13,
+             float m20, float m21, float m22, float m23,
+             float m30, float m31, float m32, float m33)
+        : m{float4(m00, m01, m02, m03), float4(m10, m11, m12, m13), float4(m20, m21, m22, m23), float4(m30, m31, m32, m33)}
+    {
+    }
+
+    float4& operator[](int row)
+    {
+        return m[row];
+    }
+    const float4& operator[](int row) const
+    {
+        return m[row];
+    }
+};
+
+struct float3x4
+{
+    float4 m[3];
+
+    float3x4() = default;
+    // equivalent of the HLSL (float3x4) truncation cast
+    explicit float3x4(const float4x4& mat)
+        : m{mat[0], mat[1], mat[2]}
+    {
+    }
+
+    float4& operator[](int row)
+    {
+        return m[row];
+    }
+    const float4& operator[](int row) const
+    {
+        return m[row];
+    }
+};
+
+struct float3x3
+{
+    float3 m[3];
+
+    float3x3() = default;
+    // equivalent of the HLSL (float3x3) truncation cast
+    explicit float3x3(const float4x4& mat)
+        : m{mat[0].xyz(), mat[1].xyz(), mat[2].xyz()}
+    {
+    }
+
+    const float3& operator[](int row) const
+    {
+        return m[row];
+    }
+};
+
+inline float4 mul(const float4x4& a, const float4& v)
+{
+    return float4(dot(a[0], v), dot(a[1], v), dot(a[2], v), dot(a[3], v));
+}
+
+inline float3 mul(const float3x3& a, const float3& v)
+{
+    return float3(dot(a[0], v), dot(a[1], v), dot(a[2], v));
+}
+
+inline float4x4 mul(const float4x4& a, const float4x4& b)
+{
+    float4x4 result;
+    for (int row = 0; row < 4; ++row)
+    {
+        for (int column = 0; column < 4; ++column)
+        {
+            result[row][column] = a[row][0] * b[0][column] + a[row][1] * b[1][column] + a[row][2] * b[2][column] + a[row][3] * b[3][column];
+        }
+    }
+    return result;
+}
+
+inline float4x4 transpose(const float4x4& a)
+{
+    return float4x4(a[0][0], a[1][0], a[2][0], a[3][0],
+                    a[0][1], a[1][1], a[2][1], a[3][1],
+                    a[0][2], a[1][2], a[2][2], a[3][2],
+                    a[0][3], a[1][3], a[2][3], a[3][3]);
+}
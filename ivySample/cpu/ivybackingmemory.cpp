@@ -0,0 +1,153 @@
+// This file is part of the AMD Work Graph Ivy Generation Sample.
+//
+// Copyright (c) 2024 Advanced Micro Devices, Inc. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include "cpu/ivybackingmemory.h"
+
+#include "cpu/ivyjson.h"
+
+#include <algorithm>
+#include <fstream>
+
+bool IvyParseBackingMemoryPolicy(const std::string& name, IvyBackingMemoryPolicy& policy)
+{
+    if (name == "min")
+    {
+        policy = IvyBackingMemoryPolicy::Min;
+    }
+    else if (name == "max")
+    {
+        policy = IvyBackingMemoryPolicy::Max;
+    }
+    else if (name == "fraction")
+    {
+        policy = IvyBackingMemoryPolicy::Fraction;
+    }
+    else
+    {
+        return false;
+    }
+    return true;
+}
+
+const char* IvyGetBackingMemoryPolicyName(IvyBackingMemoryPolicy policy)
+{
+    switch (policy)
+    {
+    case IvyBackingMemoryPolicy::Min:
+        return "min";
+    case IvyBackingMemoryPolicy::Fraction:
+        return "fraction";
+    default:
+        return "max";
+    }
+}
+
+uint64_t IvySelectBackingMemorySize(const IvyBackingMemoryRequirements& requirements, IvyBackingMemoryPolicy policy, float fraction)
+{
+    const uint64_t minSize = requirements.MinSizeInBytes;
+    const uint64_t maxSize = std::max(requirements.MaxSizeInBytes, minSize);
+
+    switch (policy)
+    {
+    case IvyBackingMemoryPolicy::Min:
+        return minSize;
+    case IvyBackingMemoryPolicy::Max:
+        return maxSize;
+    default:
+        break;
+    }
+
+    fraction = std::min(std::max(fraction, 0.f), 1.f);
+
+    // sizes in between have to be min plus a multiple of the granularity, round down to stay within the fraction
+    const uint64_t granularity = std::max<uint64_t>(requirements.SizeGranularityInBytes, 1);
+    const uint64_t extraSize   = static_cast<uint64_t>(static_cast<double>(maxSize - minSize) * fraction);
+    const uint64_t size        = minSize + (extraSize / granularity) * granularity;
+
+    // the largest multiple may be below max, max itself is always valid
+    return (fraction >= 1.f) ? maxSize : std::min(size, maxSize);
+}
+
+IvyBackingMemorySweep::IvyBackingMemorySweep(const IvyBackingMemoryRequirements& requirements, const std::vector<float>& fractions)
+    : m_Requirements(requirements)
+{
+    for (float fraction : fractions)
+    {
+        Step step;
+        step.Fraction    = fraction;
+        step.SizeInBytes = IvySelectBackingMemorySize(requirements, IvyBackingMemoryPolicy::Fraction, fraction);
+        m_Steps.push_back(step);
+    }
+}
+
+void IvyBackingMemorySweep::AddSample(uint32_t step, double seconds)
+{
+    Step& target = m_Steps[step];
+
+    target.MinSeconds = (target.SampleCount == 0) ? seconds : std::min(target.MinSeconds, seconds);
+    target.TotalSeconds += seconds;
+    target.SampleCount += 1;
+}
+
+double IvyBackingMemorySweep::GetAverageSeconds(uint32_t step) const
+{
+    const Step& target = m_Steps[step];
+    return (target.SampleCount > 0) ? target.TotalSeconds / target.SampleCount : 0.0;
+}
+
+void IvyBackingMemorySweep::Write(IvyJsonWriter& json, const char* key) const
+{
+    json.BeginObject(key);
+    json.Value("min_size", m_Requirements.MinSizeInBytes);
+    json.Value("max_size", m_Requirements.MaxSizeInBytes);
+    json.Value("size_granularity", m_Requirements.SizeGranularityInBytes);
+    json.BeginArray("steps");
+    for (uint32_t step = 0; step < GetStepCount(); ++step)
+    {
+        json.BeginObject();
+        json.Value("fraction", static_cast<double>(m_Steps[step].Fraction));
+        json.Value("size", m_Steps[step].SizeInBytes);
+        json.Value("samples", m_Steps[step].SampleCount);
+        json.Value("average_seconds", GetAverageSeconds(step));
+        json.Value("min_seconds", m_Steps[step].MinSeconds);
+        json.EndObject();
+    }
+    json.EndArray();
+    json.EndObject();
+}
+
+bool IvyBackingMemorySweep::WriteFile(const std::string& path, std::string* errorMessage) const
+{
+    IvyJsonWriter json;
+    Write(json, nullptr);
+
+    std::ofstream file(path, std::ios::binary);
+    file << json.GetString() << "\n";
+    if (!file)
+    {
+        if (errorMessage)
+        {
+            *errorMessage = "cannot write " + path;
+        }
+        return false;
+    }
+    return true;
+}
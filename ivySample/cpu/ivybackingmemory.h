@@ -0,0 +1,126 @@
+// This file is part of the AMD Work Graph Ivy Generation Sample.
+//
+// Copyright (c) 2024 Advanced Micro Devices, Inc. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#pragma once
+
+// Cauldron-free, compiled into IvySample as well as IvyCpu.
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+class IvyJsonWriter;
+
+/**
+ * @brief   Mirror of D3D12_WORK_GRAPH_MEMORY_REQUIREMENTS.
+ */
+struct IvyBackingMemoryRequirements
+{
+    uint64_t MinSizeInBytes         = 0;
+    uint64_t MaxSizeInBytes         = 0;
+    uint64_t SizeGranularityInBytes = 0;
+};
+
+/**
+ * @brief   Selects the size of the work graph backing memory within its requirements.
+ *
+ * Min is the smallest size that guarantees forward progress, Max the size beyond which the work graph does not get faster.
+ * Fraction interpolates between both, such that memory-constrained configurations can trade VRAM for throughput.
+ */
+enum class IvyBackingMemoryPolicy : uint32_t
+{
+    Min,
+    Max,
+    Fraction
+};
+
+/**
+ * @brief   Parses "min", "max" or "fraction". Returns false for other names.
+ */
+bool IvyParseBackingMemoryPolicy(const std::string& name, IvyBackingMemoryPolicy& policy);
+
+const char* IvyGetBackingMemoryPolicyName(IvyBackingMemoryPolicy policy);
+
+/**
+ * @brief   Size for a policy, MinSizeInBytes plus a multiple of SizeGranularityInBytes and at most MaxSizeInBytes.
+ *          The fraction (0 = min, 1 = max) is only used by IvyBackingMemoryPolicy::Fraction.
+ */
+uint64_t IvySelectBackingMemorySize(const IvyBackingMemoryRequirements& requirements, IvyBackingMemoryPolicy policy, float fraction);
+
+/**
+ * @brief   Dispatch times of the work graph over a set of backing memory sizes.
+ *
+ * Each step is one fraction of the requirements, the caller runs the work graph with GetSizeInBytes(step)
+ * and adds the time of every dispatch to that step.
+ */
+class IvyBackingMemorySweep
+{
+public:
+    struct Step
+    {
+        float    Fraction     = 0.f;
+        uint64_t SizeInBytes  = 0;
+        uint32_t SampleCount  = 0;
+        double   TotalSeconds = 0.0;
+        double   MinSeconds   = 0.0;
+    };
+
+    IvyBackingMemorySweep() = default;
+
+    /**
+     * @brief   Creates one step per fraction, by default min, 1/8, 1/4, 1/2 & max.
+     */
+    explicit IvyBackingMemorySweep(const IvyBackingMemoryRequirements& requirements,
+                                   const std::vector<float>&           fractions = {0.f, 0.125f, 0.25f, 0.5f, 1.f});
+
+    uint32_t GetStepCount() const
+    {
+        return static_cast<uint32_t>(m_Steps.size());
+    }
+
+    const Step& GetStep(uint32_t step) const
+    {
+        return m_Steps[step];
+    }
+
+    uint64_t GetSizeInBytes(uint32_t step) const
+    {
+        return m_Steps[step].SizeInBytes;
+    }
+
+    void AddSample(uint32_t step, double seconds);
+
+    /**
+     * @brief   Average dispatch time of a step, 0 without samples.
+     */
+    double GetAverageSeconds(uint32_t step) const;
+
+    void Write(IvyJsonWriter& json, const char* key) const;
+
+    /**
+     * @brief   Writes the sweep as JSON document. Returns false and sets errorMessage (if provided) on failure.
+     */
+    bool WriteFile(const std::string& path, std::string* errorMessage = nullptr) const;
+
+private:
+    IvyBackingMemoryRequirements m_Requirements;
+    std::vector<Step>            m_Steps;
+};
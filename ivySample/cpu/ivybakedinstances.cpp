@@ -0,0 +1,221 @@
+// This file is part of the AMD Work Graph Ivy Generation Sample.
+//
+// Copyright (c) 2024 Advanced Micro Devices, Inc. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+#include "cpu/ivybakedinstances.h"
+
+#include "cpu/ivygenerationcache.h"
+
+#include <cstring>
+#include <fstream>
+
+static const char ivyBakedInstanceMagic[4] = {'I', 'V', 'Y', 'B'};
+
+static bool SetError(std::string* errorMessage, const std::string& error)
+{
+    if (errorMessage)
+    {
+        *errorMessage = error;
+    }
+    return false;
+}
+
+static size_t GetRecordsOffset()
+{
+    return sizeof(IvyBakedInstanceHeader);
+}
+
+static size_t GetLeafInstancesOffset(const IvyBakedInstanceHeader& header)
+{
+    return GetRecordsOffset() + (static_cast<size_t>(header.BranchRecordCount) + header.AreaRecordCount) * sizeof(IvyBakedEntryRecord);
+}
+
+static size_t GetStemInstancesOffset(const IvyBakedInstanceHeader& header)
+{
+    return GetLeafInstancesOffset(header) + static_cast<size_t>(header.LeafInstanceCount) * header.InstanceSize;
+}
+
+template <typename Record>
+static IvyBakedEntryRecord ToBakedEntryRecord(const Record& record, float density)
+{
+    static_assert(sizeof(record.transform) == sizeof(IvyBakedEntryRecord::Transform), "entry record transforms are expected as 16 floats");
+
+    IvyBakedEntryRecord bakedRecord = {};
+    std::memcpy(bakedRecord.Transform, &record.transform, sizeof(bakedRecord.Transform));
+    bakedRecord.Seed    = record.seed;
+    bakedRecord.Density = density;
+    return bakedRecord;
+}
+
+IvyBakedEntryRecord ToBakedEntryRecord(const IvyBranchRecord& record)
+{
+    return ToBakedEntryRecord(record, 0.f);
+}
+
+IvyBakedEntryRecord ToBakedEntryRecord(const IvyAreaRecord& record)
+{
+    return ToBakedEntryRecord(record, record.density);
+}
+
+IvyBranchRecord ToIvyBranchRecord(const IvyBakedEntryRecord& bakedRecord)
+{
+    IvyBranchRecord record = {};
+    std::memcpy(&record.transform, bakedRecord.Transform, sizeof(bakedRecord.Transform));
+    record.seed = bakedRecord.Seed;
+    return record;
+}
+
+IvyAreaRecord ToIvyAreaRecord(const IvyBakedEntryRecord& bakedRecord)
+{
+    IvyAreaRecord record = {};
+    std::memcpy(&record.transform, bakedRecord.Transform, sizeof(bakedRecord.Transform));
+    record.seed    = bakedRecord.Seed;
+    record.density = bakedRecord.Density;
+    return record;
+}
+
+bool IvyBakedInstanceFile::Open(const std::string& path, std::string* errorMessage)
+{
+    if (!m_File.Open(path, errorMessage))
+    {
+        return false;
+    }
+
+    if (!Validate(m_File.GetData(), m_File.GetSize(), errorMessage))
+    {
+        m_File.Close();
+        return false;
+    }
+    return true;
+}
+
+void IvyBakedInstanceFile::Close()
+{
+    m_File.Close();
+}
+
+const IvyBakedEntryRecord* IvyBakedInstanceFile::GetBranchRecords() const
+{
+    return reinterpret_cast<const IvyBakedEntryRecord*>(m_File.GetData() + GetRecordsOffset());
+}
+
+const IvyBakedEntryRecord* IvyBakedInstanceFile::GetAreaRecords() const
+{
+    return GetBranchRecords() + GetHeader().BranchRecordCount;
+}
+
+const IvyEncodedInstance* IvyBakedInstanceFile::GetLeafInstances() const
+{
+    return reinterpret_cast<const IvyEncodedInstance*>(m_File.GetData() + GetLeafInstancesOffset(GetHeader()));
+}
+
+const IvyEncodedInstance* IvyBakedInstanceFile::GetStemInstances() const
+{
+    return reinterpret_cast<const IvyEncodedInstance*>(m_File.GetData() + GetStemInstancesOffset(GetHeader()));
+}
+
+bool IvyBakedInstanceFile::Validate(const void* data, size_t size, std::string* errorMessage)
+{
+    if (size < sizeof(IvyBakedInstanceHeader))
+    {
+        return SetError(errorMessage, "file is smaller than the header");
+    }
+
+    IvyBakedInstanceHeader header;
+    std::memcpy(&header, data, sizeof(header));
+
+    if (std::memcmp(header.Magic, ivyBakedInstanceMagic, sizeof(header.Magic)) != 0)
+    {
+        return SetError(errorMessage, "not a baked instance file");
+    }
+    if (header.Version != ivyBakedInstanceVersion)
+    {
+        return SetError(errorMessage, "version " + std::to_string(header.Version) + " is not supported, expected " + std::to_string(ivyBakedInstanceVersion));
+    }
+    if ((header.Encoding != IVY_INSTANCE_ENCODING) || (header.InstanceSize != sizeof(IvyEncodedInstance)))
+    {
+        return SetError(errorMessage, "instance encoding " + std::to_string(header.Encoding) + " does not match IVY_INSTANCE_ENCODING " + std::to_string(IVY_INSTANCE_ENCODING));
+    }
+    if ((header.LeafInstanceCount > IVY_MAX_INSTANCES) || (header.StemInstanceCount > IVY_MAX_INSTANCES))
+    {
+        return SetError(errorMessage, "more than IVY_MAX_INSTANCES instances");
+    }
+    if ((header.Arguments[0].InstanceCount != header.LeafInstanceCount) || (header.Arguments[1].InstanceCount != header.StemInstanceCount))
+    {
+        return SetError(errorMessage, "argument buffer instance counts do not match the instances");
+    }
+
+    const size_t expectedSize = GetStemInstancesOffset(header) + static_cast<size_t>(header.StemInstanceCount) * header.InstanceSize;
+    if (size != expectedSize)
+    {
+        return SetError(errorMessage, "file size " + std::to_string(size) + " does not match the expected " + std::to_string(expectedSize) + " bytes");
+    }
+
+    IvyGenerationKey checksum;
+    checksum.AddBytes(static_cast<const uint8_t*>(data) + sizeof(header), size - sizeof(header));
+    if (checksum.Get() != header.PayloadChecksum)
+    {
+        return SetError(errorMessage, "checksum mismatch");
+    }
+
+    return true;
+}
+
+bool IvyBakedInstanceFile::Write(const std::string& path, const IvyBakedInstances& instances, std::string* errorMessage)
+{
+    if ((instances.LeafInstances.size() > IVY_MAX_INSTANCES) || (instances.StemInstances.size() > IVY_MAX_INSTANCES))
+    {
+        return SetError(errorMessage, "more than IVY_MAX_INSTANCES instances");
+    }
+
+    IvyBakedInstanceHeader header = {};
+    std::memcpy(header.Magic, ivyBakedInstanceMagic, sizeof(header.Magic));
+    header.Version                    = ivyBakedInstanceVersion;
+    header.Encoding                   = IVY_INSTANCE_ENCODING;
+    header.InstanceSize               = sizeof(IvyEncodedInstance);
+    header.BranchRecordCount          = static_cast<uint32_t>(instances.BranchRecords.size());
+    header.AreaRecordCount            = static_cast<uint32_t>(instances.AreaRecords.size());
+    header.LeafInstanceCount          = static_cast<uint32_t>(instances.LeafInstances.size());
+    header.StemInstanceCount          = static_cast<uint32_t>(instances.StemInstances.size());
+    header.Arguments[0]               = instances.Arguments[0];
+    header.Arguments[1]               = instances.Arguments[1];
+    header.Arguments[0].InstanceCount = header.LeafInstanceCount;
+    header.Arguments[1].InstanceCount = header.StemInstanceCount;
+
+    IvyGenerationKey checksum;
+    checksum.AddBytes(instances.BranchRecords.data(), instances.BranchRecords.size() * sizeof(IvyBakedEntryRecord));
+    checksum.AddBytes(instances.AreaRecords.data(), instances.AreaRecords.size() * sizeof(IvyBakedEntryRecord));
+    checksum.AddBytes(instances.LeafInstances.data(), instances.LeafInstances.size() * sizeof(IvyEncodedInstance));
+    checksum.AddBytes(instances.StemInstances.data(), instances.StemInstances.size() * sizeof(IvyEncodedInstance));
+    header.PayloadChecksum = checksum.Get();
+
+    std::ofstream file(path, std::ios::binary);
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    file.write(reinterpret_cast<const char*>(instances.BranchRecords.data()), instances.BranchRecords.size() * sizeof(IvyBakedEntryRecord));
+    file.write(reinterpret_cast<const char*>(instances.AreaRecords.data()), instances.AreaRecords.size() * sizeof(IvyBakedEntryRecord));
+    file.write(reinterpret_cast<const char*>(instances.LeafInstances.data()), instances.LeafInstances.size() * sizeof(IvyEncodedInstance));
+    file.write(reinterpret_cast<const char*>(instances.StemInstances.data()), instances.StemInstances.size() * sizeof(IvyEncodedInstance));
+    if (!file)
+    {
+        return SetError(errorMessage, "cannot write " + path);
+    }
+    return true;
+}
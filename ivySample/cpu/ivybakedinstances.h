@@ -0,0 +1,126 @@
+// This file is part of the AMD Work Graph Ivy Generation Sample.
+//
+// Copyright (c) 2024 Advanced Micro Devices, Inc. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+#pragma once
+
+// Baked ivy instances for static levels, see IvyBake (benchmark/bakeinstances.cpp).
+// Cauldron-free, compiled into IvySample as well as IvyCpu.
+
+#include "cpu/ivymappedfile.h"
+#include "shaders/ivycommon.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Incremented on every change of the file layout
+static const uint32_t ivyBakedInstanceVersion = 1;
+
+/**
+ * @brief   Header of a baked instance file, followed by the entry records (branch records first), the leaf & the stem instances.
+ */
+struct IvyBakedInstanceHeader
+{
+    char            Magic[4];           // "IVYB"
+    uint32_t        Version;            // ivyBakedInstanceVersion
+    uint32_t        Encoding;           // IVY_INSTANCE_ENCODING of the instances
+    uint32_t        InstanceSize;       // sizeof(IvyEncodedInstance)
+    uint32_t        BranchRecordCount;
+    uint32_t        AreaRecordCount;
+    uint32_t        LeafInstanceCount;  // at most IVY_MAX_INSTANCES
+    uint32_t        StemInstanceCount;  // at most IVY_MAX_INSTANCES
+    DrawIndexedArgs Arguments[2];       // argument buffer: [0] leaf, [1] stem
+    uint64_t        PayloadChecksum;    // 64 bit FNV-1a of everything after the header
+};
+
+/**
+ * @brief   IvyBranchRecord or IvyAreaRecord the instances were generated for, without padding.
+ */
+struct IvyBakedEntryRecord
+{
+    float    Transform[16];  // column-major, like Mat4
+    uint32_t Seed;
+    float    Density;        // IvyAreaRecord only
+    uint32_t Padding[2];
+};
+
+IvyBakedEntryRecord ToBakedEntryRecord(const IvyBranchRecord& record);
+IvyBakedEntryRecord ToBakedEntryRecord(const IvyAreaRecord& record);
+IvyBranchRecord     ToIvyBranchRecord(const IvyBakedEntryRecord& record);
+IvyAreaRecord       ToIvyAreaRecord(const IvyBakedEntryRecord& record);
+
+/**
+ * @brief   Contents of a baked instance file, see IvyBakedInstanceFile::Write().
+ */
+struct IvyBakedInstances
+{
+    std::vector<IvyBakedEntryRecord> BranchRecords;
+    std::vector<IvyBakedEntryRecord> AreaRecords;
+    std::vector<IvyEncodedInstance>  LeafInstances;
+    std::vector<IvyEncodedInstance>  StemInstances;
+    DrawIndexedArgs                  Arguments[2] = {};
+};
+
+/**
+ * @brief   Read-only memory mapping of a validated baked instance file.
+ *
+ * The instances are stored in the encoding of the instance buffers, so they can be uploaded without conversion.
+ * Files of another version or encoding are rejected.
+ */
+class IvyBakedInstanceFile
+{
+public:
+    /**
+     * @brief   Maps & validates the file. Returns false and sets errorMessage (if provided) on failure.
+     */
+    bool Open(const std::string& path, std::string* errorMessage = nullptr);
+    void Close();
+
+    bool IsOpen() const
+    {
+        return m_File.IsOpen();
+    }
+
+    const IvyBakedInstanceHeader& GetHeader() const
+    {
+        return *reinterpret_cast<const IvyBakedInstanceHeader*>(m_File.GetData());
+    }
+
+    const IvyBakedEntryRecord* GetBranchRecords() const;
+    const IvyBakedEntryRecord* GetAreaRecords() const;
+    const IvyEncodedInstance*  GetLeafInstances() const;
+    const IvyEncodedInstance*  GetStemInstances() const;
+
+    /**
+     * @brief   Checks header, sizes & checksum of a file in memory. Returns false and sets errorMessage (if provided) on failure.
+     */
+    static bool Validate(const void* data, size_t size, std::string* errorMessage = nullptr);
+
+    /**
+     * @brief   Writes a baked instance file. Returns false and sets errorMessage (if provided) on failure.
+     */
+    static bool Write(const std::string& path, const IvyBakedInstances& instances, std::string* errorMessage = nullptr);
+
+private:
+    IvyMappedFile m_File;
+};
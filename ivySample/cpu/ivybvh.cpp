@@ -0,0 +1,264 @@
+// This file is part of the AMD Work Graph Ivy Generation Sample.
+//
+// Copyright (c) 2024 Advanced Micro Devices, Inc. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+#include "cpu/ivybvh.h"
+
+#include <chrono>
+
+static const uint32_t MaxBinCount = 64;
+
+void IvyBvh::Clear()
+{
+    m_Nodes.clear();
+    m_PrimitiveIndices.clear();
+    m_BuildStatistics = BuildStatistics();
+}
+
+void IvyBvh::Build(const std::vector<IvyAabb>& primitiveBounds, const BuildSettings& settings)
+{
+    const auto startTime = std::chrono::steady_clock::now();
+
+    Clear();
+
+    const uint32_t primitiveCount = static_cast<uint32_t>(primitiveBounds.size());
+    if (primitiveCount == 0)
+    {
+        return;
+    }
+
+    // primitives are partitioned by value, so binning reads contiguous memory at every level
+    std::vector<BuildPrimitive> primitives(primitiveCount);
+    Node                        root;
+    IvyAabb                     rootBounds;
+    for (uint32_t i = 0; i < primitiveCount; ++i)
+    {
+        primitives[i].Bounds   = primitiveBounds[i];
+        primitives[i].Centroid = primitiveBounds[i].Center();
+        primitives[i].Index    = i;
+        rootBounds.Grow(primitiveBounds[i]);
+    }
+    root.BoundsMin      = rootBounds.Min;
+    root.BoundsMax      = rootBounds.Max;
+    root.LeftFirst      = 0;
+    root.PrimitiveCount = primitiveCount;
+
+    // a binary tree with one primitive per leaf has 2n - 1 nodes
+    m_Nodes.reserve(2 * static_cast<size_t>(primitiveCount) - 1);
+    m_Nodes.push_back(root);
+
+    struct BuildTask
+    {
+        uint32_t NodeIndex;
+        uint32_t Depth;
+    };
+    std::vector<BuildTask> tasks = {{0, 1}};
+
+    // reused by all FindSplit() calls, most nodes are small and clearing a few bins is cheaper than constructing them
+    std::vector<Bin> binScratch(3 * MaxBinCount);
+
+    while (!tasks.empty())
+    {
+        const BuildTask task = tasks.back();
+        tasks.pop_back();
+
+        const Node node = m_Nodes[task.NodeIndex];
+
+        m_BuildStatistics.MaxDepth = std::max(m_BuildStatistics.MaxDepth, task.Depth);
+
+        SplitCandidate split;
+        bool           splitNode = (node.PrimitiveCount > 1) && (task.Depth < MaxDepth) && FindSplit(node, primitives, settings, binScratch, split);
+
+        // small nodes are only split if the SAH predicts a gain
+        if (splitNode && (node.PrimitiveCount <= settings.MaxLeafSize) && (split.Cost >= settings.IntersectionCost * node.PrimitiveCount))
+        {
+            splitNode = false;
+        }
+
+        if (!splitNode)
+        {
+            m_BuildStatistics.LeafCount++;
+            m_BuildStatistics.MaxLeafSize = std::max(m_BuildStatistics.MaxLeafSize, node.PrimitiveCount);
+            continue;
+        }
+
+        const auto begin = primitives.begin() + node.LeftFirst;
+        const auto end   = begin + node.PrimitiveCount;
+        auto       mid   = std::partition(begin, end, [&](const BuildPrimitive& primitive) {
+            return static_cast<uint32_t>((primitive.Centroid[split.Axis] - split.CentroidMin) * split.BinScale) < split.Bin;
+        });
+
+        // numerical corner cases can leave one side empty, fall back to an object median split
+        IvyAabb childBounds[2] = {split.LeftBounds, split.RightBounds};
+        if ((mid == begin) || (mid == end))
+        {
+            mid = begin + node.PrimitiveCount / 2;
+            std::nth_element(begin, mid, end, [&](const BuildPrimitive& a, const BuildPrimitive& b) { return a.Centroid[split.Axis] < b.Centroid[split.Axis]; });
+
+            childBounds[0] = childBounds[1] = IvyAabb();
+            for (auto it = begin; it != end; ++it)
+            {
+                childBounds[(it < mid) ? 0 : 1].Grow(it->Bounds);
+            }
+        }
+
+        const uint32_t leftCount  = static_cast<uint32_t>(mid - begin);
+        const uint32_t childIndex = static_cast<uint32_t>(m_Nodes.size());
+
+        for (uint32_t child = 0; child < 2; ++child)
+        {
+            Node childNode;
+            childNode.LeftFirst      = (child == 0) ? node.LeftFirst : node.LeftFirst + leftCount;
+            childNode.PrimitiveCount = (child == 0) ? leftCount : node.PrimitiveCount - leftCount;
+            childNode.BoundsMin      = childBounds[child].Min;
+            childNode.BoundsMax      = childBounds[child].Max;
+
+            m_Nodes.push_back(childNode);
+        }
+
+        m_Nodes[task.NodeIndex].LeftFirst      = childIndex;
+        m_Nodes[task.NodeIndex].PrimitiveCount = 0;
+
+        tasks.push_back({childIndex + 1, task.Depth + 1});
+        tasks.push_back({childIndex, task.Depth + 1});
+    }
+
+    m_PrimitiveIndices.resize(primitiveCount);
+    for (uint32_t i = 0; i < primitiveCount; ++i)
+    {
+        m_PrimitiveIndices[i] = primitives[i].Index;
+    }
+
+    m_BuildStatistics.NodeCount = static_cast<uint32_t>(m_Nodes.size());
+
+    // SAH cost of the final tree, normalized by the root surface area
+    const float rootArea = rootBounds.SurfaceArea();
+    if (rootArea > 0.f)
+    {
+        double cost = 0.0;
+        for (const Node& node : m_Nodes)
+        {
+            IvyAabb bounds;
+            bounds.Min = node.BoundsMin;
+            bounds.Max = node.BoundsMax;
+
+            cost += bounds.SurfaceArea() * (node.IsLeaf() ? settings.IntersectionCost * node.PrimitiveCount : settings.TraversalCost);
+        }
+        m_BuildStatistics.SahCost = static_cast<float>(cost / rootArea);
+    }
+
+    m_BuildStatistics.BuildSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+}
+
+bool IvyBvh::FindSplit(const Node& node, const std::vector<BuildPrimitive>& primitives, const BuildSettings& settings, std::vector<Bin>& binScratch,
+                       SplitCandidate& split) const
+{
+    const uint32_t binCount = std::min(std::max(settings.BinCount, 2u), MaxBinCount);
+
+    IvyAabb centroidBounds;
+    for (uint32_t i = 0; i < node.PrimitiveCount; ++i)
+    {
+        centroidBounds.Grow(primitives[node.LeftFirst + i].Centroid);
+    }
+
+    IvyAabb nodeBounds;
+    nodeBounds.Min = node.BoundsMin;
+    nodeBounds.Max = node.BoundsMax;
+
+    const float nodeArea = nodeBounds.SurfaceArea();
+
+    // bin all three axes in a single pass over the primitives
+    Bin* const bins[3] = {&binScratch[0], &binScratch[binCount], &binScratch[2 * binCount]};
+    float      binScale[3];
+
+    std::fill(binScratch.begin(), binScratch.begin() + 3 * binCount, Bin());
+
+    for (uint32_t axis = 0; axis < 3; ++axis)
+    {
+        const float extent = centroidBounds.Max[axis] - centroidBounds.Min[axis];
+        binScale[axis]     = (extent > 0.f) ? binCount / extent : 0.f;
+    }
+
+    for (uint32_t i = 0; i < node.PrimitiveCount; ++i)
+    {
+        const BuildPrimitive& primitive = primitives[node.LeftFirst + i];
+
+        for (uint32_t axis = 0; axis < 3; ++axis)
+        {
+            const uint32_t bin = std::min(static_cast<uint32_t>((primitive.Centroid[axis] - centroidBounds.Min[axis]) * binScale[axis]), binCount - 1);
+
+            bins[axis][bin].Bounds.Grow(primitive.Bounds);
+            bins[axis][bin].PrimitiveCount++;
+        }
+    }
+
+    for (uint32_t axis = 0; axis < 3; ++axis)
+    {
+        // all centroids in one bin, axis cannot be split
+        if (binScale[axis] == 0.f)
+        {
+            continue;
+        }
+
+        // sweep from the right to get the area & count of all right partitions
+        IvyAabb  rightBoundsAt[MaxBinCount];
+        uint32_t rightCount[MaxBinCount];
+        IvyAabb  rightBounds;
+        uint32_t rightPrimitives = 0;
+        for (uint32_t bin = binCount - 1; bin > 0; --bin)
+        {
+            rightBounds.Grow(bins[axis][bin].Bounds);
+            rightPrimitives += bins[axis][bin].PrimitiveCount;
+            rightBoundsAt[bin] = rightBounds;
+            rightCount[bin]    = rightPrimitives;
+        }
+
+        // sweep from the left and evaluate the SAH for a split in front of each bin
+        IvyAabb  leftBounds;
+        uint32_t leftPrimitives = 0;
+        for (uint32_t bin = 1; bin < binCount; ++bin)
+        {
+            leftBounds.Grow(bins[axis][bin - 1].Bounds);
+            leftPrimitives += bins[axis][bin - 1].PrimitiveCount;
+
+            if ((leftPrimitives == 0) || (rightCount[bin] == 0))
+            {
+                continue;
+            }
+
+            const float cost = settings.TraversalCost +
+                               settings.IntersectionCost * (leftBounds.SurfaceArea() * leftPrimitives + rightBoundsAt[bin].SurfaceArea() * rightCount[bin]) /
+                                   std::max(nodeArea, FLT_MIN);
+            if (cost < split.Cost)
+            {
+                split.Axis        = axis;
+                split.Bin         = bin;
+                split.Cost        = cost;
+                split.CentroidMin = centroidBounds.Min[axis];
+                split.BinScale    = binScale[axis];
+                split.LeftBounds  = leftBounds;
+                split.RightBounds = rightBoundsAt[bin];
+            }
+        }
+    }
+
+    return split.Cost != FLT_MAX;
+}
@@ -0,0 +1,280 @@
+// This file is part of the AMD Work Graph Ivy Generation Sample.
+//
+// Copyright (c) 2024 Advanced Micro Devices, Inc. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+#pragma once
+
+#include "cpu/hlslmath.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <vector>
+
+/**
+ * @brief   Axis aligned bounding box used by IvyBvh.
+ */
+struct IvyAabb
+{
+    float3 Min = float3(FLT_MAX);
+    float3 Max = float3(-FLT_MAX);
+
+    void Grow(const float3& p)
+    {
+        Min = float3(std::min(Min.x, p.x), std::min(Min.y, p.y), std::min(Min.z, p.z));
+        Max = float3(std::max(Max.x, p.x), std::max(Max.y, p.y), std::max(Max.z, p.z));
+    }
+
+    void Grow(const IvyAabb& other)
+    {
+        Min = float3(std::min(Min.x, other.Min.x), std::min(Min.y, other.Min.y), std::min(Min.z, other.Min.z));
+        Max = float3(std::max(Max.x, other.Max.x), std::max(Max.y, other.Max.y), std::max(Max.z, other.Max.z));
+    }
+
+    bool IsEmpty() const
+    {
+        return (Min.x > Max.x) || (Min.y > Max.y) || (Min.z > Max.z);
+    }
+
+    float3 Center() const
+    {
+        return (Min + Max) * 0.5f;
+    }
+
+    float SurfaceArea() const
+    {
+        if (IsEmpty())
+        {
+            return 0.f;
+        }
+        const float3 extent = Max - Min;
+        return 2.f * (extent.x * extent.y + extent.y * extent.z + extent.z * extent.x);
+    }
+};
+
+/**
+ * @brief   Parameters of the binned SAH build, see IvyBvh::Build().
+ */
+struct IvyBvhBuildSettings
+{
+    uint32_t BinCount         = 16;
+    uint32_t MaxLeafSize      = 4;
+    // SAH cost of visiting a node relative to intersecting a primitive
+    float    TraversalCost    = 1.0f;
+    float    IntersectionCost = 1.0f;
+};
+
+/**
+ * @brief   Bounding volume hierarchy built with the binned surface area heuristic.
+ *
+ * Primitives are referenced by index into the bounds array passed to Build(). Leaves store a contiguous
+ * range of GetPrimitiveIndices(), so callers usually reorder their primitives once after building and
+ * index them directly with the leaf range.
+ */
+class IvyBvh
+{
+public:
+    /**
+     * @brief   32 byte node. Interior nodes (PrimitiveCount == 0) store the index of the left child in
+     *          LeftFirst, the right child directly follows it. Leaves store the first primitive in LeftFirst.
+     */
+    struct Node
+    {
+        float3   BoundsMin;
+        uint32_t LeftFirst      = 0;
+        float3   BoundsMax;
+        uint32_t PrimitiveCount = 0;
+
+        bool IsLeaf() const
+        {
+            return PrimitiveCount > 0;
+        }
+    };
+    static_assert(sizeof(Node) == 32, "BVH nodes are expected to fill half a cache line");
+
+    using BuildSettings = IvyBvhBuildSettings;
+
+    struct BuildStatistics
+    {
+        uint32_t NodeCount    = 0;
+        uint32_t LeafCount    = 0;
+        uint32_t MaxDepth     = 0;
+        uint32_t MaxLeafSize  = 0;
+        float    SahCost      = 0.f;
+        double   BuildSeconds = 0.0;
+    };
+
+    // Maximum depth of the tree (and traversal stack), deeper subtrees are collapsed into leaves
+    static const uint32_t MaxDepth = 64;
+
+    void Build(const std::vector<IvyAabb>& primitiveBounds, const BuildSettings& settings = BuildSettings());
+
+    void Clear();
+
+    const std::vector<Node>& GetNodes() const
+    {
+        return m_Nodes;
+    }
+
+    const std::vector<uint32_t>& GetPrimitiveIndices() const
+    {
+        return m_PrimitiveIndices;
+    }
+
+    const BuildStatistics& GetBuildStatistics() const
+    {
+        return m_BuildStatistics;
+    }
+
+    /**
+     * @brief   Visits all leaves intersected by the ray segment [tMin, tMax] in front to back order.
+     *          leafFunction(first, count, tMax) intersects the primitives of the leaf and shortens tMax
+     *          to the closest hit, which prunes the remaining traversal.
+     */
+    template <typename LeafFunction>
+    void Traverse(const float3& origin, const float3& direction, float tMin, float& tMax, LeafFunction&& leafFunction) const
+    {
+        if (m_Nodes.empty())
+        {
+            return;
+        }
+
+        const float3 inverseDirection = SafeInverse(direction);
+
+        uint32_t stack[MaxDepth];
+        uint32_t stackSize = 0;
+        uint32_t nodeIndex = 0;
+
+        if (IntersectNode(m_Nodes[0], origin, inverseDirection, tMin, tMax) == FLT_MAX)
+        {
+            return;
+        }
+
+        for (;;)
+        {
+            const Node& node = m_Nodes[nodeIndex];
+
+            if (node.IsLeaf())
+            {
+                leafFunction(node.LeftFirst, node.PrimitiveCount, tMax);
+            }
+            else
+            {
+                uint32_t near  = node.LeftFirst;
+                uint32_t far   = node.LeftFirst + 1;
+                float    tNear = IntersectNode(m_Nodes[near], origin, inverseDirection, tMin, tMax);
+                float    tFar  = IntersectNode(m_Nodes[far], origin, inverseDirection, tMin, tMax);
+
+                if (tFar < tNear)
+                {
+                    std::swap(near, far);
+                    std::swap(tNear, tFar);
+                }
+
+                if (tNear != FLT_MAX)
+                {
+                    if (tFar != FLT_MAX)
+                    {
+                        stack[stackSize++] = far;
+                    }
+                    nodeIndex = near;
+                    continue;
+                }
+            }
+
+            // pop next node, skip nodes behind the closest hit found so far
+            for (;;)
+            {
+                if (stackSize == 0)
+                {
+                    return;
+                }
+
+                nodeIndex = stack[--stackSize];
+                if (IntersectNode(m_Nodes[nodeIndex], origin, inverseDirection, tMin, tMax) != FLT_MAX)
+                {
+                    break;
+                }
+            }
+        }
+    }
+
+    /**
+     * @brief   Reciprocal of the ray direction, zero components are replaced by a tiny value of the same sign
+     *          so the slab test never evaluates 0 * inf.
+     */
+    static float3 SafeInverse(const float3& direction)
+    {
+        const float epsilon = 1e-20f;
+        return float3(1.f / ((std::fabs(direction.x) > epsilon) ? direction.x : std::copysign(epsilon, direction.x)),
+                      1.f / ((std::fabs(direction.y) > epsilon) ? direction.y : std::copysign(epsilon, direction.y)),
+                      1.f / ((std::fabs(direction.z) > epsilon) ? direction.z : std::copysign(epsilon, direction.z)));
+    }
+
+    /**
+     * @brief   Slab test, returns the entry distance or FLT_MAX if the node is missed.
+     */
+    static float IntersectNode(const Node& node, const float3& origin, const float3& inverseDirection, float tMin, float tMax)
+    {
+        const float tx0 = (node.BoundsMin.x - origin.x) * inverseDirection.x;
+        const float tx1 = (node.BoundsMax.x - origin.x) * inverseDirection.x;
+        const float ty0 = (node.BoundsMin.y - origin.y) * inverseDirection.y;
+        const float ty1 = (node.BoundsMax.y - origin.y) * inverseDirection.y;
+        const float tz0 = (node.BoundsMin.z - origin.z) * inverseDirection.z;
+        const float tz1 = (node.BoundsMax.z - origin.z) * inverseDirection.z;
+
+        const float tEnter = std::max(std::max(std::min(tx0, tx1), std::min(ty0, ty1)), std::max(std::min(tz0, tz1), tMin));
+        const float tExit  = std::min(std::min(std::max(tx0, tx1), std::max(ty0, ty1)), std::min(std::max(tz0, tz1), tMax));
+
+        return (tEnter <= tExit) ? tEnter : FLT_MAX;
+    }
+
+private:
+    struct SplitCandidate
+    {
+        uint32_t Axis        = 0;
+        uint32_t Bin         = 0;
+        float    Cost        = FLT_MAX;
+        float    CentroidMin = 0.f;
+        float    BinScale    = 0.f;
+        IvyAabb  LeftBounds;
+        IvyAabb  RightBounds;
+    };
+
+    struct BuildPrimitive
+    {
+        IvyAabb  Bounds;
+        float3   Centroid;
+        uint32_t Index;
+    };
+
+    struct Bin
+    {
+        IvyAabb  Bounds;
+        uint32_t PrimitiveCount = 0;
+    };
+
+    bool FindSplit(const Node& node, const std::vector<BuildPrimitive>& primitives, const BuildSettings& settings, std::vector<Bin>& binScratch,
+                   SplitCandidate& split) const;
+
+    std::vector<Node>     m_Nodes;
+    std::vector<uint32_t> m_PrimitiveIndices;
+    BuildStatistics       m_BuildStatistics;
+};
@@ -0,0 +1,674 @@
+// This file is part of the AMD Work Graph Ivy Generation Sample.
+//
+// Copyright (c) 2024 Advanced Micro Devices, Inc. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+#include "cpu/ivycpuengine.h"
+
+#include "cpu/affinemath.h"
+#include "cpu/ivycpuscene.h"
+#include "cpu/ivyutils.h"
+#include "cpu/ivywave.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <numeric>
+
+static uint32_t DivideAndRoundUp(uint32_t dividend, uint32_t divisor)
+{
+    return (dividend + divisor - 1) / divisor;
+}
+
+// Sorts an instance stream by its keys, see IvyCpuEngine::SetDeterministicOrder.
+// Equal keys only occur for records with equal seeds, these are ordered by their transform bits.
+static void SortInstances(std::vector<IvyInstanceData>& instances, std::vector<IvyInstanceKey>& keys)
+{
+    std::vector<uint32_t> order(instances.size());
+    std::iota(order.begin(), order.end(), 0u);
+
+    std::sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) {
+        if (keys[a].seed != keys[b].seed)
+        {
+            return keys[a].seed < keys[b].seed;
+        }
+        if (keys[a].iterationSlot != keys[b].iterationSlot)
+        {
+            return keys[a].iterationSlot < keys[b].iterationSlot;
+        }
+        return std::memcmp(&instances[a], &instances[b], sizeof(IvyInstanceData)) < 0;
+    });
+
+    std::vector<IvyInstanceData> sortedInstances(instances.size());
+    std::vector<IvyInstanceKey>  sortedKeys(keys.size());
+    for (size_t i = 0; i < order.size(); ++i)
+    {
+        sortedInstances[i] = instances[order[i]];
+        sortedKeys[i]      = keys[order[i]];
+    }
+
+    instances.swap(sortedInstances);
+    keys.swap(sortedKeys);
+}
+
+IvyCpuEngine::IvyCpuEngine(const IvyCpuScene& scene, uint32_t threadCount)
+    : m_Scene(scene)
+    , m_Scheduler(threadCount)
+    , m_Workers(m_Scheduler.GetThreadCount())
+{
+}
+
+void IvyCpuEngine::SetGenerationSettings(const IvyGenerationSettings& settings)
+{
+    m_Settings                       = settings;
+    m_Settings.ThreadGroupIterations = std::max(settings.ThreadGroupIterations, 1u);
+    m_Settings.ThreadGroupCoalescing = std::min(std::max(settings.ThreadGroupCoalescing, 1u), ivyMaxThreadGroupCoalescing);
+}
+
+void IvyCpuEngine::DispatchGraph(const std::vector<IvyBranchRecord>& branchRecords,
+                                 const std::vector<IvyAreaRecord>&   areaRecords,
+                                 IvyInstanceStreams&                 output)
+{
+    const auto startTime = std::chrono::steady_clock::now();
+
+    m_Statistics = {};
+    m_QueuedGroups.store(0);
+    m_PeakQueuedGroups.store(0);
+    m_InlineGroups.store(0);
+
+    for (WorkerState& worker : m_Workers)
+    {
+        worker.LeafInstances.clear();
+        worker.StemInstances.clear();
+        worker.LeafKeys.clear();
+        worker.StemKeys.clear();
+        worker.LeafGroupRanges.clear();
+        worker.StemGroupRanges.clear();
+        worker.Levels.assign(m_Settings.MaxRecursion + 1, LevelStatistics{});
+        worker.AreaSampleRayCount = 0;
+    }
+
+    std::vector<IvyTaskScheduler::Task> tasks;
+
+    // IvyBranch entry records, coalesced into thread groups
+    for (size_t first = 0; first < branchRecords.size(); first += m_Settings.ThreadGroupCoalescing)
+    {
+        BranchRecordBatch batch;
+        batch.RecordCount = static_cast<uint32_t>(std::min<size_t>(m_Settings.ThreadGroupCoalescing, branchRecords.size() - first));
+        std::copy_n(&branchRecords[first], batch.RecordCount, batch.Records);
+
+        tasks.emplace_back([this, batch](uint32_t workerIndex) { ExecuteBranchGroup(batch, workerIndex); });
+        AddQueuedGroup();
+    }
+
+    // IvyArea is a cheap thread launch node, run it here and schedule one task per IvyAreaSample thread group
+    for (const IvyAreaRecord& areaRecord : areaRecords)
+    {
+        IvyAreaSampleRecord sampleRecord;
+        IvyArea(areaRecord, sampleRecord);
+
+        for (uint32_t groupIndex = 0; groupIndex < sampleRecord.dispatchSize; ++groupIndex)
+        {
+            tasks.emplace_back([this, sampleRecord, groupIndex](uint32_t workerIndex) { ExecuteAreaSampleGroup(sampleRecord, groupIndex, workerIndex); });
+        }
+
+        m_Statistics.AreaSampleThreads += sampleRecord.dispatchSize * ivyAreaSampleThreadGroupSize;
+    }
+    m_Statistics.AreaRecords = areaRecords.size();
+
+    m_Scheduler.Run(tasks);
+
+    // Merge worker outputs
+    output.LeafInstances.clear();
+    output.StemInstances.clear();
+    output.LeafKeys.clear();
+    output.StemKeys.clear();
+    output.LeafGroupRanges.clear();
+    output.StemGroupRanges.clear();
+    m_Statistics.Levels.assign(m_Settings.MaxRecursion + 1, LevelStatistics{});
+
+    for (const WorkerState& worker : m_Workers)
+    {
+        for (IvyInstanceRange range : worker.LeafGroupRanges)
+        {
+            range.First += static_cast<uint32_t>(output.LeafInstances.size());
+            output.LeafGroupRanges.push_back(range);
+        }
+        for (IvyInstanceRange range : worker.StemGroupRanges)
+        {
+            range.First += static_cast<uint32_t>(output.StemInstances.size());
+            output.StemGroupRanges.push_back(range);
+        }
+
+        output.LeafInstances.insert(output.LeafInstances.end(), worker.LeafInstances.begin(), worker.LeafInstances.end());
+        output.StemInstances.insert(output.StemInstances.end(), worker.StemInstances.begin(), worker.StemInstances.end());
+        output.LeafKeys.insert(output.LeafKeys.end(), worker.LeafKeys.begin(), worker.LeafKeys.end());
+        output.StemKeys.insert(output.StemKeys.end(), worker.StemKeys.begin(), worker.StemKeys.end());
+
+        for (size_t level = 0; level < worker.Levels.size(); ++level)
+        {
+            m_Statistics.Levels[level].Records += worker.Levels[level].Records;
+            m_Statistics.Levels[level].Groups += worker.Levels[level].Groups;
+            m_Statistics.Levels[level].RayCount += worker.Levels[level].RayCount;
+            m_Statistics.Levels[level].BusySeconds += worker.Levels[level].BusySeconds;
+        }
+
+        m_Statistics.RayCount += worker.AreaSampleRayCount;
+    }
+
+    if (m_DeterministicOrder)
+    {
+        SortInstances(output.LeafInstances, output.LeafKeys);
+        SortInstances(output.StemInstances, output.StemKeys);
+
+        output.LeafGroupRanges.clear();
+        output.StemGroupRanges.clear();
+    }
+
+    while (!m_Statistics.Levels.empty() && (m_Statistics.Levels.back().Records == 0))
+    {
+        m_Statistics.Levels.pop_back();
+    }
+
+    for (const LevelStatistics& level : m_Statistics.Levels)
+    {
+        m_Statistics.BranchRecords += level.Records;
+        m_Statistics.RayCount += level.RayCount;
+    }
+
+    m_Statistics.RecursionLevels  = static_cast<uint32_t>(m_Statistics.Levels.size());
+    m_Statistics.ThreadCount      = m_Scheduler.GetThreadCount();
+    m_Statistics.StealCount       = m_Scheduler.GetStealCount();
+    m_Statistics.PeakQueuedGroups = m_PeakQueuedGroups.load();
+    m_Statistics.InlineGroups     = m_InlineGroups.load();
+
+    // Argument buffer, written by the partition compaction on the GPU (see shaders/ivyinstancepartitions.hlsl)
+    const auto& surfaces = m_Scene.GetRTInfoTables().m_cpuSurfaceBuffer;
+    for (DrawIndexedArgs& args : output.Arguments)
+    {
+        args = {};
+    }
+    if (m_Scene.GetIvyLeafSurfaceIndex() >= 0)
+    {
+        output.Arguments[0].IndexCountPerInstance = surfaces[m_Scene.GetIvyLeafSurfaceIndex()].num_indices;
+    }
+    if (m_Scene.GetIvyStemSurfaceIndex() >= 0)
+    {
+        output.Arguments[1].IndexCountPerInstance = surfaces[m_Scene.GetIvyStemSurfaceIndex()].num_indices;
+    }
+    output.Arguments[0].InstanceCount = static_cast<uint32_t>(output.LeafInstances.size());
+    output.Arguments[1].InstanceCount = static_cast<uint32_t>(output.StemInstances.size());
+
+    m_Statistics.WallSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+}
+
+void IvyCpuEngine::IvyArea(const IvyAreaRecord& record, IvyAreaSampleRecord& sampleOutput) const
+{
+    const float4x4 transform = ToFloat4x4(record.transform);
+
+    // record.transform defines a bounding box in [-1; 1]
+    // Here we compute the area of the top surface of the bounding box
+    const float xScale = length(mul(float3x3(transform), float3(1, 0, 0))) * 2;
+    const float zScale = length(mul(float3x3(transform), float3(0, 0, 1))) * 2;
+
+    const float    sampleArea  = xScale * zScale;
+    const uint32_t sampleCount = static_cast<uint32_t>(sampleArea * record.density);
+
+    sampleOutput.dispatchSize = std::min(DivideAndRoundUp(sampleCount, ivyAreaSampleThreadGroupSize), ivyAreaSampleMaxThreadGroups);
+    sampleOutput.transform    = transform;
+    sampleOutput.seed         = record.seed;
+    sampleOutput.sampleCount  = sampleCount;
+    sampleOutput.partition    = record.partition;
+}
+
+bool IvyCpuEngine::IvyAreaSample(const IvyAreaSampleRecord& record, uint32_t dtid, IvyBranchRecord& branchOutput) const
+{
+    float3 hitPosition = float3(0);
+    float3 hitNormal   = float3(0);
+    bool   hit         = false;
+
+    // trace ray from top surface (at y = 1) to bottom surface (at y = -1) of bounding box defined by record.transform
+    const float3 sampleDirection = mul(float3x3(record.transform), float3(0, -2, 0));
+
+    if (dtid < record.sampleCount)
+    {
+        const float3 samplePositionInBoundingBox = float3(Random(record.seed, dtid, 3732) * 2.f - 1.f,  //
+                                                          1.f,
+                                                          Random(record.seed, dtid, 4561) * 2.f - 1.f);
+        const float3 samplePositionWorldSpace    = mul(record.transform, float4(samplePositionInBoundingBox, 1)).xyz();
+
+        // tMin and tMax are relative to length of direction
+        hit = m_Scene.TraceRay(samplePositionWorldSpace, sampleDirection, 0.f, 1.f, hitPosition, hitNormal);
+    }
+
+    if (hit)
+    {
+        float3 forward = normalize(cross(hitNormal, sampleDirection));
+
+        if (any_isnan(forward))
+        {
+            const float3 transformForward = mul(float3x3(record.transform), float3(1, 0, 0));
+            forward                       = normalize(cross(hitNormal, transformForward));
+        }
+
+        const float3x4 transform = Affine::mmul(Affine::Translate(hitPosition),
+                                                Affine::Rotate(forward, hitNormal),
+                                                // move origin up to not place ivy inside the surface
+                                                Affine::Translate(0, 2 * ivyStemRadius, 0));
+
+        branchOutput.transform = Affine::ToMat4(transform);
+        branchOutput.seed      = CombineSeed(record.seed, dtid);
+        branchOutput.partition = record.partition;
+    }
+
+    return hit;
+}
+
+void IvyCpuEngine::TraceRays(const IvyCpuScene::Ray* rays, uint32_t rayCount, IvyCpuScene::RayHit* hits) const
+{
+    if (m_PacketTracing)
+    {
+        m_Scene.TraceRays(rays, rayCount, hits);
+        return;
+    }
+
+    for (uint32_t i = 0; i < rayCount; ++i)
+    {
+        hits[i].Hit = m_Scene.TraceRay(rays[i].Origin, rays[i].Direction, rays[i].TMin, rays[i].TMax, hits[i].Position, hits[i].Normal);
+    }
+}
+
+void IvyCpuEngine::IvyBranch(const IvyBranchRecord* inputRecords,
+                             uint32_t               inputRecordCount,
+                             uint32_t               remainingRecursionLevels,
+                             IvyBranchGroupOutput&  output) const
+{
+    // Each input record is processed by one wave; waves of a group only share the output records.
+    // Stems & leaves are appended in input record order, the GPU order depends on InterlockedAdd.
+    for (uint32_t inputRecordIndex = 0; inputRecordIndex < inputRecordCount; ++inputRecordIndex)
+    {
+        IvyBranchWave(inputRecords[inputRecordIndex], remainingRecursionLevels, output);
+    }
+}
+
+void IvyCpuEngine::IvyBranchWave(const IvyBranchRecord& inputRecord, uint32_t remainingRecursionLevels, IvyBranchGroupOutput& output) const
+{
+    const float    hitDistanceBias = 2 * ivyStemRadius;
+    const uint32_t seed            = inputRecord.seed;
+
+    // all transforms of the wave are affine, see cpu/affinemath.h
+    float3x4 transform    = Affine::ToFloat3x4(inputRecord.transform);
+    float    stemRotation = Random('E', 'F', 'E', 'U', '!');
+
+    float3x4 branchTransform = Affine::Identity();
+    bool     hasBranch       = false;
+
+    // Per lane state of the emulated wave
+    float3 forwardHitPosition[ivyWaveSize];
+    float3 forwardHitNormal[ivyWaveSize];
+    float  forwardHitDistance[ivyWaveSize];
+    float3 direction[ivyWaveSize];
+    float3 localHitPosition[ivyWaveSize];
+    float3 localHitNormal[ivyWaveSize];
+    bool   localHit[ivyWaveSize];
+
+    for (uint32_t iteration = 0; iteration < m_Settings.ThreadGroupIterations; ++iteration)
+    {
+        const float3 origin  = Affine::TransformPoint(transform, float3(0, 0, 0));
+        const float3 forward = normalize(Affine::TransformVector(transform, float3(1, 0, 0)));
+        const float3 up      = normalize(Affine::TransformVector(transform, float3(0, 1, 0)));
+
+        float3              localOrigin[ivyWaveSize];
+        bool                forwardProbeHit[ivyWaveSize] = {};
+        IvyCpuScene::Ray    forwardProbes[ivyForwardProbeCount];
+        IvyCpuScene::RayHit forwardProbeHits[ivyForwardProbeCount];
+
+        for (uint32_t lane = 0; lane < ivyWaveSize; ++lane)
+        {
+            const float3x4 localTransform =
+                Affine::mmul(transform, Affine::RotateX((lane / float(ivyForwardProbeCount)) * 2 * PI), Affine::Translate(0, ivyStemRadius, 0));
+            localOrigin[lane] = Affine::TransformPoint(localTransform, float3(0, 0, 0));
+
+            forwardHitPosition[lane] = localOrigin[lane] + forward * ivyStemLength;
+            forwardHitNormal[lane]   = float3(0, 0, 0);
+
+            if (lane < ivyForwardProbeCount)
+            {
+                forwardProbes[lane] = IvyCpuScene::Ray{localOrigin[lane], forward, 0.f, ivyStemLength};
+            }
+        }
+
+        // the forward probes of a wave are traced together
+        TraceRays(forwardProbes, ivyForwardProbeCount, forwardProbeHits);
+        output.RayCount += ivyForwardProbeCount;
+
+        for (uint32_t lane = 0; lane < ivyForwardProbeCount; ++lane)
+        {
+            forwardProbeHit[lane]    = forwardProbeHits[lane].Hit;
+            forwardHitPosition[lane] = forwardProbeHits[lane].Position;
+            forwardHitNormal[lane]   = forwardProbeHits[lane].Normal;
+        }
+
+        for (uint32_t lane = 0; lane < ivyWaveSize; ++lane)
+        {
+            forwardHitDistance[lane] = distance(localOrigin[lane], forwardHitPosition[lane]);
+        }
+
+        const float waveForwardHitDistance = WaveActiveMin(forwardHitDistance);
+        const bool  forwardHit             = WaveActiveAnyTrue(forwardProbeHit);
+
+        // Random(seed, iteration, c) for all constants c used by the iteration
+        static const uint32_t iterationRandomKeys[] = {238, 928, 456, 567, 478, 645, 46578, 4459, 387, 158, 520, 437858};
+        float                 iterationRandom[sizeof(iterationRandomKeys) / sizeof(iterationRandomKeys[0])];
+        RandomBatch(seed, iteration, iterationRandomKeys, sizeof(iterationRandomKeys) / sizeof(iterationRandomKeys[0]), iterationRandom);
+
+        const float2 leafOffset         = float2(iterationRandom[0], iterationRandom[1]);
+        const float2 leafRotationOffset = float2(iterationRandom[2] * 2.f - 1.f, iterationRandom[3] * 2.f - 1.f);
+        const float2 leafRotation       = float2(iterationRandom[4], iterationRandom[5]);
+
+        if (forwardHit)
+        {
+            const uint32_t minDistanceLaneIndex = WaveFirstLaneEqual(forwardHitDistance, waveForwardHitDistance);
+
+            const float3 waveForwardHitNormal = WaveReadLaneAt(forwardHitNormal, minDistanceLaneIndex);
+
+            const float stemScale = std::max(waveForwardHitDistance - hitDistanceBias, 0.f) / ivyStemLength;
+
+            // Draw stem
+            output.StemTransforms.push_back(Affine::mmul(transform, Affine::RotateX(stemRotation), Affine::Scale(stemScale, 1.f, 1.f)));
+            output.StemKeys.push_back(MakeIvyInstanceKey(seed, iteration, 0));
+
+            // Draw two leafes if stem is long enough
+            if (stemScale > 0.5)
+            {
+                output.LeafTransforms.push_back(Affine::mmul(transform,
+                                                             Affine::Translate(leafOffset.x * stemScale * ivyStemLength, 0, 0),
+                                                             Affine::RotateY(0.5f * leafRotationOffset.x + PI / 2.f),
+                                                             Affine::RotateZ(0.5f * leafRotation.x)));
+                output.LeafTransforms.push_back(Affine::mmul(transform,
+                                                             Affine::Translate(leafOffset.x * stemScale * ivyStemLength, 0, 0),
+                                                             Affine::RotateY(0.5f * leafRotationOffset.x - PI / 2.f),
+                                                             Affine::RotateZ(0.5f * leafRotation.x)));
+                output.LeafKeys.push_back(MakeIvyInstanceKey(seed, iteration, 0));
+                output.LeafKeys.push_back(MakeIvyInstanceKey(seed, iteration, 1));
+            }
+
+            float3 side = normalize(cross(forward, waveForwardHitNormal));
+
+            // check if side vector would be NaN
+            if (std::abs(dot(forward, normalize(waveForwardHitNormal))) == 1.f)
+            {
+                side = cross(up, waveForwardHitNormal);
+            }
+
+            // compute next transform
+            transform = Affine::mmul(Affine::Translate(origin + forward * (waveForwardHitDistance - hitDistanceBias)),
+                                     Affine::Rotate(cross(waveForwardHitNormal, side), waveForwardHitNormal),
+                                     Affine::RotateY(iterationRandom[6] * 2.f - 1.f),
+                                     Affine::RotateZ(0.2f));
+        }
+        else
+        {
+            // Draw stem
+            output.StemTransforms.push_back(Affine::mmul(transform, Affine::RotateX(stemRotation)));
+            output.StemKeys.push_back(MakeIvyInstanceKey(seed, iteration, 0));
+
+            // Draw leafes
+            output.LeafTransforms.push_back(Affine::mmul(transform,
+                                                         Affine::Translate(leafOffset.x * ivyStemLength, 0, 0),
+                                                         Affine::RotateY(0.5f * leafRotationOffset.x + PI / 2.f),
+                                                         Affine::RotateZ(0.5f * leafRotation.x)));
+            output.LeafTransforms.push_back(Affine::mmul(transform,
+                                                         Affine::Translate(leafOffset.x * ivyStemLength, 0, 0),
+                                                         Affine::RotateY(0.5f * leafRotationOffset.x - PI / 2.f),
+                                                         Affine::RotateZ(0.5f * leafRotation.x)));
+            output.LeafKeys.push_back(MakeIvyInstanceKey(seed, iteration, 0));
+            output.LeafKeys.push_back(MakeIvyInstanceKey(seed, iteration, 1));
+
+            const float3 nextOrigin = origin + forward * ivyStemLength;
+
+            IvyCpuScene::Ray    randomRays[ivyWaveSize];
+            IvyCpuScene::RayHit randomRayHits[ivyWaveSize];
+
+            // Random(seed, iteration, lane, c) for all lanes of the wave
+            float randomX[ivyWaveSize], randomY[ivyWaveSize], randomZ[ivyWaveSize];
+            RandomLaneBatch(seed, iteration, 389, ivyWaveSize, randomX);
+            RandomLaneBatch(seed, iteration, 829, ivyWaveSize, randomY);
+            RandomLaneBatch(seed, iteration, 478, ivyWaveSize, randomZ);
+
+            for (uint32_t lane = 0; lane < ivyWaveSize; ++lane)
+            {
+                const float3 randomDirection = normalize(float3(randomX[lane], randomY[lane], randomZ[lane]) * 2.f - 1.f);
+                // lane 0 traces downwards to check current surface, all other lanes trace a random direction
+                const bool  writingThread = lane == 0;
+                const float tMax          = writingThread ? 2 * ivyStemRadius : 2 * ivyStemLength;
+
+                direction[lane]  = writingThread ? -up : randomDirection;
+                randomRays[lane] = IvyCpuScene::Ray{nextOrigin, direction[lane], 0.f, tMax};
+            }
+
+            TraceRays(randomRays, ivyWaveSize, randomRayHits);
+            output.RayCount += ivyWaveSize;
+
+            for (uint32_t lane = 0; lane < ivyWaveSize; ++lane)
+            {
+                localHit[lane]         = randomRayHits[lane].Hit;
+                localHitPosition[lane] = randomRayHits[lane].Position;
+                localHitNormal[lane]   = randomRayHits[lane].Normal;
+            }
+
+            const bool downwardHit = WaveReadLaneFirst(localHit);
+            const bool anyHit      = WaveActiveAnyTrue(localHit);
+
+            if (downwardHit)
+            {
+                // Downward surface was hit; continue on current surface.
+                transform = Affine::mmul(Affine::Translate(nextOrigin), Affine::Rotate(forward, up), Affine::RotateY(iterationRandom[7]), Affine::RotateZ(0.1f));
+            }
+            else if (anyHit)
+            {
+                // No downward surface was hit, but we found another surface nearby.
+
+                // find lane with most forward random direction
+                float cosAngle[ivyWaveSize];
+                float hitCosAngle[ivyWaveSize];
+                for (uint32_t lane = 0; lane < ivyWaveSize; ++lane)
+                {
+                    cosAngle[lane]    = dot(direction[lane], forward);
+                    hitCosAngle[lane] = localHit[lane] ? cosAngle[lane] : -1.f;
+                }
+
+                const float    maxCosAngle        = WaveActiveMax(hitCosAngle);
+                const uint32_t randomHitLaneIndex = WaveFirstLaneEqual(cosAngle, maxCosAngle);
+
+                const float3 randomHitNormal   = WaveReadLaneAt(localHitNormal, randomHitLaneIndex);
+                const float3 randomHitPosition = WaveReadLaneAt(localHitPosition, randomHitLaneIndex) + randomHitNormal * hitDistanceBias;
+
+                const float3 nextForward = normalize(randomHitPosition - origin);
+                const float3 side        = cross(nextForward, randomHitNormal);
+
+                transform = Affine::mmul(Affine::Translate(nextOrigin), Affine::Rotate(nextForward, cross(side, nextForward)));
+            }
+            else
+            {
+                // No downward surface & no nearby surface. Slowly grow downward
+
+                // Start with random direction
+                float3 nextForward = normalize(float3(iterationRandom[8],  //
+                                                      iterationRandom[9],  //
+                                                      iterationRandom[10]) * 2.f - 1.f);
+                // Bias downwards
+                nextForward.y = -4;
+                nextForward   = normalize(nextForward);
+
+                float3 nextUp = normalize(cross(nextForward, forward));
+
+                // check if side vector is NaN
+                if (std::abs(dot(nextForward, forward)) == 1.f)
+                {
+                    nextUp = normalize(cross(nextForward, up));
+                }
+
+                transform = Affine::mmul(Affine::Translate(nextOrigin), Affine::Rotate(nextForward, nextUp));
+            }
+
+            const bool branch = (iterationRandom[11] > 0.8f) && !hasBranch;
+
+            if (branch)
+            {
+                hasBranch = true;
+
+                branchTransform = Affine::mmul(transform, Affine::RotateY(-0.5f));
+                transform       = Affine::mmul(transform, Affine::RotateY(0.5f));
+            }
+        }
+
+        stemRotation += 1;
+    }
+
+    bool hasNext = (Random(seed, 3489) < 0.2f) || (remainingRecursionLevels > 6);
+
+    // recursive output
+    hasNext   = hasNext && (remainingRecursionLevels > 0);
+    hasBranch = hasBranch && (remainingRecursionLevels > 0);
+
+    if (hasNext)
+    {
+        output.RecursiveRecords.push_back(IvyBranchRecord{Affine::ToMat4(transform), CombineSeed(seed, 3487, Hash(transform)), inputRecord.partition});
+    }
+
+    if (hasBranch)
+    {
+        output.RecursiveRecords.push_back(IvyBranchRecord{Affine::ToMat4(branchTransform), CombineSeed(seed, 83497, Hash(branchTransform)), inputRecord.partition});
+    }
+}
+
+void IvyCpuEngine::ExecuteAreaSampleGroup(const IvyAreaSampleRecord& record, uint32_t groupIndex, uint32_t workerIndex)
+{
+    WorkerState& worker = m_Workers[workerIndex];
+
+    std::vector<IvyBranchRecord> branchRecords;
+
+    for (uint32_t groupThreadId = 0; groupThreadId < ivyAreaSampleThreadGroupSize; ++groupThreadId)
+    {
+        const uint32_t dtid = groupIndex * ivyAreaSampleThreadGroupSize + groupThreadId;
+
+        IvyBranchRecord branchRecord;
+        if (IvyAreaSample(record, dtid, branchRecord))
+        {
+            branchRecords.push_back(branchRecord);
+        }
+
+        worker.AreaSampleRayCount += (dtid < record.sampleCount) ? 1 : 0;
+    }
+
+    SpawnBranchGroups(branchRecords, 0, workerIndex);
+}
+
+void IvyCpuEngine::ExecuteBranchGroup(const BranchRecordBatch& batch, uint32_t workerIndex)
+{
+    const auto startTime = std::chrono::steady_clock::now();
+
+    m_QueuedGroups.fetch_sub(1, std::memory_order_relaxed);
+
+    WorkerState&          worker      = m_Workers[workerIndex];
+    IvyBranchGroupOutput& groupOutput = worker.GroupOutput;
+
+    groupOutput.Clear();
+    IvyBranch(batch.Records, batch.RecordCount, m_Settings.MaxRecursion - batch.RecursionLevel, groupOutput);
+
+    AppendInstances(groupOutput, worker);
+
+    // Statistics first, the spawned groups may run inline & reuse groupOutput
+    LevelStatistics& level = worker.Levels[batch.RecursionLevel];
+    level.Records += batch.RecordCount;
+    level.Groups += 1;
+    level.RayCount += groupOutput.RayCount;
+    level.BusySeconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+
+    SpawnBranchGroups(groupOutput.RecursiveRecords, batch.RecursionLevel + 1, workerIndex);
+}
+
+void IvyCpuEngine::SpawnBranchGroups(const std::vector<IvyBranchRecord>& records, uint32_t recursionLevel, uint32_t workerIndex)
+{
+    std::vector<BranchRecordBatch> inlineBatches;
+
+    for (size_t first = 0; first < records.size(); first += m_Settings.ThreadGroupCoalescing)
+    {
+        BranchRecordBatch batch;
+        batch.RecordCount    = static_cast<uint32_t>(std::min<size_t>(m_Settings.ThreadGroupCoalescing, records.size() - first));
+        batch.RecursionLevel = recursionLevel;
+        std::copy_n(&records[first], batch.RecordCount, batch.Records);
+
+        AddQueuedGroup();
+        if ((m_MaxQueuedGroups > 0) && (m_QueuedGroups.load(std::memory_order_relaxed) > m_MaxQueuedGroups))
+        {
+            inlineBatches.push_back(batch);
+            continue;
+        }
+
+        m_Scheduler.Spawn(workerIndex, [this, batch](uint32_t workerIndex) { ExecuteBranchGroup(batch, workerIndex); });
+    }
+
+    // records is the group output of this worker, which the inline groups overwrite
+    for (const BranchRecordBatch& batch : inlineBatches)
+    {
+        m_InlineGroups.fetch_add(1, std::memory_order_relaxed);
+        ExecuteBranchGroup(batch, workerIndex);
+    }
+}
+
+void IvyCpuEngine::AddQueuedGroup()
+{
+    const uint64_t queuedGroups = m_QueuedGroups.fetch_add(1, std::memory_order_relaxed) + 1;
+
+    uint64_t peakGroups = m_PeakQueuedGroups.load(std::memory_order_relaxed);
+    while ((queuedGroups > peakGroups) && !m_PeakQueuedGroups.compare_exchange_weak(peakGroups, queuedGroups, std::memory_order_relaxed))
+    {
+    }
+}
+
+void IvyCpuEngine::AppendInstances(const IvyBranchGroupOutput& groupOutput, WorkerState& worker)
+{
+    if (!groupOutput.LeafTransforms.empty())
+    {
+        worker.LeafGroupRanges.push_back(
+            IvyInstanceRange{static_cast<uint32_t>(worker.LeafInstances.size()), static_cast<uint32_t>(groupOutput.LeafTransforms.size())});
+    }
+    if (!groupOutput.StemTransforms.empty())
+    {
+        worker.StemGroupRanges.push_back(
+            IvyInstanceRange{static_cast<uint32_t>(worker.StemInstances.size()), static_cast<uint32_t>(groupOutput.StemTransforms.size())});
+    }
+
+    // Convert 3x4 matrix to 4x4 matrix for IvyInstanceData
+    for (const float3x4& leafTransform : groupOutput.LeafTransforms)
+    {
+        worker.LeafInstances.push_back(IvyInstanceData{Affine::ToMat4(leafTransform)});
+    }
+
+    for (const float3x4& stemTransform : groupOutput.StemTransforms)
+    {
+        worker.StemInstances.push_back(IvyInstanceData{Affine::ToMat4(stemTransform)});
+    }
+
+    worker.LeafKeys.insert(worker.LeafKeys.end(), groupOutput.LeafKeys.begin(), groupOutput.LeafKeys.end());
+    worker.StemKeys.insert(worker.StemKeys.end(), groupOutput.StemKeys.begin(), groupOutput.StemKeys.end());
+}
@@ -0,0 +1,282 @@
+// This file is part of the AMD Work Graph Ivy Generation Sample.
+//
+// Copyright (c) 2024 Advanced Micro Devices, Inc. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+#pragma once
+
+#include "cpu/hlslmath.h"
+#include "cpu/ivycpuscene.h"
+#include "cpu/ivytaskscheduler.h"
+#include "shaders/ivycommon.h"
+
+#include <atomic>
+#include <vector>
+
+// ==================
+// Constants, must match shaders/common.hlsl, shaders/ivy.hlsl & shaders/area.hlsl
+
+static const float ivyStemLength = 0.2f;
+static const float ivyStemRadius = 0.01f;
+
+static const uint32_t ivyThreadGroupIterations = 4;
+static const uint32_t ivyThreadGroupCoalescing = 8;
+
+static const uint32_t ivyWaveSize          = 32;
+static const uint32_t ivyMaxRecursion      = 12;
+static const uint32_t ivyForwardProbeCount = 8;
+
+static const uint32_t ivyAreaSampleThreadGroupSize = 32;
+static const uint32_t ivyAreaSampleMaxThreadGroups = 128;
+
+// Upper bound of IvyGenerationSettings::ThreadGroupCoalescing
+static const uint32_t ivyMaxThreadGroupCoalescing = 32;
+
+/**
+ * @brief   Tunables of the ivy generation that are compile time constants in the shaders.
+ *          The defaults match shaders/ivy.hlsl & shaders/common.hlsl, other values are meant for parameter sweeps.
+ */
+struct IvyGenerationSettings
+{
+    uint32_t ThreadGroupIterations = ivyThreadGroupIterations;  // stem segments per IvyBranch record
+    uint32_t ThreadGroupCoalescing = ivyThreadGroupCoalescing;  // IvyBranch records per thread group, at most ivyMaxThreadGroupCoalescing
+    uint32_t MaxRecursion          = ivyMaxRecursion;           // IvyBranch recursion depth
+};
+
+// Record for the IvyAreaSample broadcasting node, see shaders/area.hlsl
+struct IvyAreaSampleRecord
+{
+    uint32_t dispatchSize;
+    float4x4 transform;
+    uint32_t seed;
+    uint32_t sampleCount;
+    uint32_t partition;
+};
+
+/**
+ * @brief   Outputs of a single IvyBranch thread group.
+ */
+struct IvyBranchGroupOutput
+{
+    std::vector<float3x4>        StemTransforms;
+    std::vector<float3x4>        LeafTransforms;
+    std::vector<IvyInstanceKey>  StemKeys;  // one per StemTransforms entry
+    std::vector<IvyInstanceKey>  LeafKeys;  // one per LeafTransforms entry
+    std::vector<IvyBranchRecord> RecursiveRecords;
+    uint64_t                     RayCount = 0;
+
+    void Clear()
+    {
+        StemTransforms.clear();
+        LeafTransforms.clear();
+        StemKeys.clear();
+        LeafKeys.clear();
+        RecursiveRecords.clear();
+        RayCount = 0;
+    }
+};
+
+/**
+ * @brief   Consecutive instances of a stream, e.g. the instances written by one IvyBranch thread group.
+ */
+struct IvyInstanceRange
+{
+    uint32_t First = 0;
+    uint32_t Count = 0;
+};
+
+/**
+ * @brief   CPU equivalent of the leaf/stem instance buffers & the argument buffer written by the work graph.
+ *          Instances are kept as float4x4, see cpu/ivyinstanceencoding.h for the encodings of the instance buffers.
+ */
+struct IvyInstanceStreams
+{
+    std::vector<IvyInstanceData> LeafInstances;  // m_pLeafInstanceBuffer
+    std::vector<IvyInstanceData> StemInstances;  // m_pStemInstanceBuffer
+    std::vector<IvyInstanceKey>  LeafKeys;       // m_pInstanceKeyBuffer, first half
+    std::vector<IvyInstanceKey>  StemKeys;       // m_pInstanceKeyBuffer, second half
+    DrawIndexedArgs              Arguments[2];   // m_pArgumentBuffer: [0] leaf, [1] stem
+
+    // Instances written by each IvyBranch thread group, which appends them with a single InterlockedAdd.
+    // Empty with a deterministic order, which interleaves the instances of different groups.
+    std::vector<IvyInstanceRange> LeafGroupRanges;
+    std::vector<IvyInstanceRange> StemGroupRanges;
+};
+
+/**
+ * @brief   Headless reference implementation of the ivy generation work graph.
+ *
+ * Runs the IvyArea -> IvyAreaSample -> IvyBranch nodes of shaders/area.hlsl and shaders/ivy.hlsl on the CPU.
+ * Each 32 lane wave of IvyBranch is emulated lane by lane, including the wave intrinsics (see cpu/ivywave.h),
+ * such that the generated instances match the work graph up to floating point differences and output order.
+ * The rays of a wave are traced together as SIMD packets.
+ *
+ * Thread groups are executed as tasks on a work-stealing IvyTaskScheduler: every IvyAreaSample thread group
+ * and every batch of up to IvyGenerationSettings::ThreadGroupCoalescing IvyBranch records is a task, recursive outputs are spawned
+ * as new record batches. Like on the GPU, the order of the output instances depends on scheduling,
+ * unless SetDeterministicOrder() is enabled.
+ */
+class IvyCpuEngine
+{
+public:
+    struct LevelStatistics
+    {
+        uint64_t Records     = 0;    // IvyBranch input records at this recursion level
+        uint64_t Groups      = 0;    // IvyBranch thread groups (record batches)
+        uint64_t RayCount    = 0;
+        double   BusySeconds = 0.0;  // summed over all worker threads
+    };
+
+    struct Statistics
+    {
+        uint64_t BranchRecords     = 0;
+        uint64_t AreaRecords       = 0;
+        uint64_t AreaSampleThreads = 0;
+        uint64_t RayCount          = 0;
+        uint32_t RecursionLevels   = 0;
+        uint32_t ThreadCount       = 0;
+        uint64_t StealCount        = 0;
+        uint64_t PeakQueuedGroups  = 0;  // IvyBranch thread groups waiting for execution at the same time
+        uint64_t InlineGroups      = 0;  // IvyBranch thread groups executed right away, see SetMaxQueuedBranchGroups()
+        double   WallSeconds       = 0.0;
+
+        std::vector<LevelStatistics> Levels;  // indexed by recursion level
+    };
+
+    /**
+     * @brief   Creates the engine for a built scene. A threadCount of 0 uses all hardware threads.
+     */
+    explicit IvyCpuEngine(const IvyCpuScene& scene, uint32_t threadCount = 0);
+
+    /**
+     * @brief   Runs the whole work graph for the given entry records, like DispatchGraph with
+     *          D3D12_DISPATCH_MODE_MULTI_NODE_CPU_INPUT in IvyRenderModule::Execute.
+     */
+    void DispatchGraph(const std::vector<IvyBranchRecord>& branchRecords, const std::vector<IvyAreaRecord>& areaRecords, IvyInstanceStreams& output);
+
+    const Statistics& GetStatistics() const
+    {
+        return m_Statistics;
+    }
+
+    /**
+     * @brief   Selects between SIMD packet tracing of the rays of a wave (default) and tracing one ray at a time.
+     *          Both produce identical results.
+     */
+    void SetPacketTracing(bool enabled)
+    {
+        m_PacketTracing = enabled;
+    }
+
+    /**
+     * @brief   Sorts the output instances by IvyInstanceKey after the graph has completed, like the instance sort
+     *          post-pass of IvyRenderModule. The output is then identical for any thread count & schedule.
+     */
+    void SetDeterministicOrder(bool enabled)
+    {
+        m_DeterministicOrder = enabled;
+    }
+
+    /**
+     * @brief   Bounds the IvyBranch thread groups that wait for execution, like the backing memory bounds the records in flight
+     *          of the work graph (see cpu/ivybackingmemory.h). Groups beyond the bound are executed by their producer right away,
+     *          which only changes the schedule. 0 (default) is unbounded, values below the thread count starve workers.
+     */
+    void SetMaxQueuedBranchGroups(uint32_t count)
+    {
+        m_MaxQueuedGroups = count;
+    }
+
+    /**
+     * @brief   Overrides the shader constants, see IvyGenerationSettings. Out of range values are clamped.
+     */
+    void SetGenerationSettings(const IvyGenerationSettings& settings);
+
+    const IvyGenerationSettings& GetGenerationSettings() const
+    {
+        return m_Settings;
+    }
+
+    /**
+     * @brief   IvyArea entry node (thread launch).
+     */
+    void IvyArea(const IvyAreaRecord& record, IvyAreaSampleRecord& sampleOutput) const;
+
+    /**
+     * @brief   Single thread of the IvyAreaSample broadcasting node. Returns true if an IvyBranch record was written.
+     */
+    bool IvyAreaSample(const IvyAreaSampleRecord& record, uint32_t dtid, IvyBranchRecord& branchOutput) const;
+
+    /**
+     * @brief   IvyBranch coalescing node for up to IvyGenerationSettings::ThreadGroupCoalescing input records.
+     */
+    void IvyBranch(const IvyBranchRecord* inputRecords, uint32_t inputRecordCount, uint32_t remainingRecursionLevels, IvyBranchGroupOutput& output) const;
+
+private:
+    // Batch of IvyBranch input records executed by a single thread group
+    struct BranchRecordBatch
+    {
+        IvyBranchRecord Records[ivyMaxThreadGroupCoalescing];
+        uint32_t        RecordCount    = 0;
+        uint32_t        RecursionLevel = 0;
+    };
+
+    // Per worker outputs, merged once the graph has completed
+    struct alignas(64) WorkerState
+    {
+        std::vector<IvyInstanceData>  LeafInstances;
+        std::vector<IvyInstanceData>  StemInstances;
+        std::vector<IvyInstanceKey>   LeafKeys;
+        std::vector<IvyInstanceKey>   StemKeys;
+        std::vector<IvyInstanceRange> LeafGroupRanges;
+        std::vector<IvyInstanceRange> StemGroupRanges;
+        IvyBranchGroupOutput          GroupOutput;
+        std::vector<LevelStatistics>  Levels;
+        uint64_t                      AreaSampleRayCount = 0;
+    };
+
+    // Traces the rays of an emulated wave, see SetPacketTracing()
+    void TraceRays(const IvyCpuScene::Ray* rays, uint32_t rayCount, IvyCpuScene::RayHit* hits) const;
+
+    // One wave of IvyBranch, processing a single input record
+    void IvyBranchWave(const IvyBranchRecord& inputRecord, uint32_t remainingRecursionLevels, IvyBranchGroupOutput& output) const;
+
+    // Task bodies
+    void ExecuteAreaSampleGroup(const IvyAreaSampleRecord& record, uint32_t groupIndex, uint32_t workerIndex);
+    void ExecuteBranchGroup(const BranchRecordBatch& batch, uint32_t workerIndex);
+    void SpawnBranchGroups(const std::vector<IvyBranchRecord>& records, uint32_t recursionLevel, uint32_t workerIndex);
+
+    static void AppendInstances(const IvyBranchGroupOutput& groupOutput, WorkerState& worker);
+
+    // Counts a new queued IvyBranch thread group
+    void AddQueuedGroup();
+
+    const IvyCpuScene&       m_Scene;
+    IvyTaskScheduler         m_Scheduler;
+    std::vector<WorkerState> m_Workers;
+    Statistics               m_Statistics;
+    IvyGenerationSettings    m_Settings;
+    bool                     m_PacketTracing      = true;
+    bool                     m_DeterministicOrder = false;
+    uint32_t                 m_MaxQueuedGroups    = 0;
+    std::atomic<uint64_t>    m_QueuedGroups{0};
+    std::atomic<uint64_t>    m_PeakQueuedGroups{0};
+    std::atomic<uint64_t>    m_InlineGroups{0};
+};
@@ -0,0 +1,106 @@
+// This file is part of the AMD Work Graph Ivy Generation Sample.
+//
+// Copyright (c) 2024 Advanced Micro Devices, Inc. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include "cpu/ivycpuhiz.h"
+
+#include <algorithm>
+
+void IvyCpuHiZPyramid::Build(const float* depth, uint32_t width, uint32_t height)
+{
+    m_Width  = width;
+    m_Height = height;
+
+    const uint32_t levelCount = IvyGetHiZLevelCount(width, height);
+
+    m_LevelOffsets.resize(levelCount);
+    uint32_t texelCount = 0;
+    for (uint32_t level = 0; level < levelCount; ++level)
+    {
+        m_LevelOffsets[level] = texelCount;
+        texelCount += IvyGetHiZLevelSize(width, level) * IvyGetHiZLevelSize(height, level);
+    }
+    m_Texels.resize(texelCount);
+
+    // Level 0 reads the depth buffer, every other level the previous one
+    for (uint32_t level = 0; level < levelCount; ++level)
+    {
+        const float*   source       = (level == 0) ? depth : &m_Texels[m_LevelOffsets[level - 1]];
+        const uint32_t sourceWidth  = (level == 0) ? width : IvyGetHiZLevelSize(width, level - 1);
+        const uint32_t sourceHeight = (level == 0) ? height : IvyGetHiZLevelSize(height, level - 1);
+        const uint32_t levelWidth   = IvyGetHiZLevelSize(width, level);
+        const uint32_t levelHeight  = IvyGetHiZLevelSize(height, level);
+
+        float* destination = &m_Texels[m_LevelOffsets[level]];
+        for (uint32_t y = 0; y < levelHeight; ++y)
+        {
+            const uint32_t y0 = y * 2;
+            const uint32_t y1 = std::min(y0 + 1, sourceHeight - 1);
+            for (uint32_t x = 0; x < levelWidth; ++x)
+            {
+                const uint32_t x0 = x * 2;
+                const uint32_t x1 = std::min(x0 + 1, sourceWidth - 1);
+
+                destination[y * levelWidth + x] = std::max(std::max(source[y0 * sourceWidth + x0], source[y0 * sourceWidth + x1]),
+                                                           std::max(source[y1 * sourceWidth + x0], source[y1 * sourceWidth + x1]));
+            }
+        }
+    }
+}
+
+bool IvyCpuHiZPyramid::IsSphereOccluded(const float4x4& viewProjection, const float4& sphere) const
+{
+    const IvyHiZFootprint footprint = IvyGetHiZFootprint(viewProjection, sphere, m_Width, m_Height, GetLevelCount());
+    if (!footprint.Testable)
+    {
+        return false;
+    }
+
+    const uint32_t level = footprint.Level;
+
+    float farthestDepth = 0.f;
+    for (uint32_t y = footprint.MinY >> (level + 1); y <= (footprint.MaxY >> (level + 1)); ++y)
+    {
+        for (uint32_t x = footprint.MinX >> (level + 1); x <= (footprint.MaxX >> (level + 1)); ++x)
+        {
+            farthestDepth = std::max(farthestDepth, GetTexel(level, x, y));
+        }
+    }
+    return footprint.NearestDepth > farthestDepth;
+}
+
+bool IvyIsSphereOccludedByDepth(const float* depth, uint32_t width, uint32_t height, const float4x4& viewProjection, const float4& sphere)
+{
+    const IvyHiZFootprint footprint = IvyGetHiZFootprint(viewProjection, sphere, width, height, IvyGetHiZLevelCount(width, height));
+    if (!footprint.Testable)
+    {
+        return false;
+    }
+
+    float farthestDepth = 0.f;
+    for (uint32_t y = footprint.MinY; y <= footprint.MaxY; ++y)
+    {
+        for (uint32_t x = footprint.MinX; x <= footprint.MaxX; ++x)
+        {
+            farthestDepth = std::max(farthestDepth, depth[y * width + x]);
+        }
+    }
+    return footprint.NearestDepth > farthestDepth;
+}
@@ -0,0 +1,77 @@
+// This file is part of the AMD Work Graph Ivy Generation Sample.
+//
+// Copyright (c) 2024 Advanced Micro Devices, Inc. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#pragma once
+
+// CPU reference of the Hi-Z pyramid (shaders/ivyhiz.hlsl) & the occlusion test of the culling pass
+// (shaders/ivyinstanceculling.hlsl), using the footprint of shaders/ivyhiz.h.
+
+#include "cpu/hlslmath.h"
+#include "shaders/ivycommon.h"
+#include "shaders/ivyhiz.h"
+
+#include <cstdint>
+#include <vector>
+
+/**
+ * @brief   Farthest depth pyramid of a depth buffer, in the layout of the pyramid buffer of IvyHiZPyramid.
+ */
+class IvyCpuHiZPyramid
+{
+public:
+    /**
+     * @brief   Builds all levels from width x height depth values (row by row, depth is not inverted).
+     */
+    void Build(const float* depth, uint32_t width, uint32_t height);
+
+    /**
+     * @brief   IsOccluded of shaders/ivyinstanceculling.hlsl for a world space bounding sphere.
+     */
+    bool IsSphereOccluded(const float4x4& viewProjection, const float4& sphere) const;
+
+    float GetTexel(uint32_t level, uint32_t x, uint32_t y) const
+    {
+        return m_Texels[m_LevelOffsets[level] + y * IvyGetHiZLevelSize(m_Width, level) + x];
+    }
+
+    uint32_t GetLevelCount() const
+    {
+        return static_cast<uint32_t>(m_LevelOffsets.size());
+    }
+
+    // Texels of all levels, the size of the pyramid buffer
+    size_t GetTexelCount() const
+    {
+        return m_Texels.size();
+    }
+
+private:
+    uint32_t              m_Width  = 0;
+    uint32_t              m_Height = 0;
+    std::vector<uint32_t> m_LevelOffsets;
+    std::vector<float>    m_Texels;
+};
+
+/**
+ * @brief   Occlusion test against every pixel covered by the footprint of the sphere. The pyramid covers more pixels,
+ *          so every sphere occluded according to IvyCpuHiZPyramid::IsSphereOccluded has to be occluded here as well.
+ */
+bool IvyIsSphereOccludedByDepth(const float* depth, uint32_t width, uint32_t height, const float4x4& viewProjection, const float4& sphere);
@@ -0,0 +1,482 @@
+// This file is part of the AMD Work Graph Ivy Generation Sample.
+//
+// Copyright (c) 2024 Advanced Micro Devices, Inc. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+#include "cpu/ivycpuscene.h"
+
+#include "cpu/ivyutils.h"
+#include "cpu/simdmath.h"
+
+#include <algorithm>
+#include <cstring>
+
+uint32_t IvyCpuScene::AddMesh(const std::string& name, const std::vector<SurfaceData>& surfaces)
+{
+    const uint32_t meshIndex = static_cast<uint32_t>(m_RTInfoTables.m_cpuInstanceBuffer.size());
+
+    Instance_Info instance_info{};
+    instance_info.surface_id_table_offset = static_cast<int>(m_RTInfoTables.m_cpuSurfaceIDsBuffer.size());
+    instance_info.num_surfaces            = static_cast<int>(surfaces.size());
+    instance_info.num_opaque_surfaces     = static_cast<int>(surfaces.size());
+    instance_info.node_id                 = static_cast<int>(meshIndex);
+
+    if (name == "Stem")
+    {
+        m_ivyStemSurfaceIndex = static_cast<int>(m_RTInfoTables.m_cpuSurfaceBuffer.size());
+    }
+
+    if (name == "Leaf")
+    {
+        m_ivyLeafSurfaceIndex = static_cast<int>(m_RTInfoTables.m_cpuSurfaceBuffer.size());
+    }
+
+    for (const SurfaceData& surface : surfaces)
+    {
+        m_RTInfoTables.m_cpuSurfaceIDsBuffer.push_back(static_cast<uint32_t>(m_RTInfoTables.m_cpuSurfaceBuffer.size()));
+
+        Surface_Info surface_info{};
+        memset(&surface_info, -1, sizeof(surface_info));
+        surface_info.num_indices  = static_cast<int>(surface.Indices.size());
+        surface_info.num_vertices = static_cast<int>(surface.Positions.size() / 3);
+
+        surface_info.index_offset = static_cast<int>(m_RTInfoTables.m_IndexBuffers.size());
+        surface_info.index_type   = SURFACE_INFO_INDEX_TYPE_U32;
+        m_RTInfoTables.m_IndexBuffers.push_back(surface.Indices);
+
+        surface_info.position_attribute_offset = static_cast<int>(m_RTInfoTables.m_VertexBuffers.size());
+        m_RTInfoTables.m_VertexBuffers.push_back(surface.Positions);
+
+        if (!surface.Normals.empty())
+        {
+            surface_info.normal_attribute_offset = static_cast<int>(m_RTInfoTables.m_VertexBuffers.size());
+            m_RTInfoTables.m_VertexBuffers.push_back(surface.Normals);
+        }
+
+        m_RTInfoTables.m_cpuSurfaceBuffer.push_back(surface_info);
+    }
+
+    m_RTInfoTables.m_cpuInstanceBuffer.push_back(instance_info);
+
+    return meshIndex;
+}
+
+void IvyCpuScene::AddInstance(uint32_t meshIndex, const Mat4& objectToWorld)
+{
+    m_TlasInstances.push_back(TlasInstance{ToFloat4x4(objectToWorld), meshIndex});
+}
+
+void IvyCpuScene::Build(const IvyBvh::BuildSettings& settings)
+{
+    m_Triangles.clear();
+
+    for (uint32_t tlasInstance = 0; tlasInstance < m_TlasInstances.size(); ++tlasInstance)
+    {
+        const TlasInstance&  instance = m_TlasInstances[tlasInstance];
+        const Instance_Info& iinfo    = m_RTInfoTables.m_cpuInstanceBuffer[instance.InstanceID];
+
+        for (uint32_t geometryIndex = 0; geometryIndex < static_cast<uint32_t>(iinfo.num_surfaces); ++geometryIndex)
+        {
+            const uint32_t     surface_id = m_RTInfoTables.m_cpuSurfaceIDsBuffer[iinfo.surface_id_table_offset + geometryIndex];
+            const Surface_Info sinfo      = m_RTInfoTables.m_cpuSurfaceBuffer[surface_id];
+
+            for (uint32_t primitiveIndex = 0; primitiveIndex < static_cast<uint32_t>(sinfo.num_indices / 3); ++primitiveIndex)
+            {
+                const uint3 indices = FetchIndices(sinfo, primitiveIndex);
+
+                const float3 v0 = mul(instance.ObjectToWorld, float4(FetchFloat3(sinfo.position_attribute_offset, indices.x), 1)).xyz();
+                const float3 v1 = mul(instance.ObjectToWorld, float4(FetchFloat3(sinfo.position_attribute_offset, indices.y), 1)).xyz();
+                const float3 v2 = mul(instance.ObjectToWorld, float4(FetchFloat3(sinfo.position_attribute_offset, indices.z), 1)).xyz();
+
+                m_Triangles.push_back(Triangle{v0, v1 - v0, v2 - v0, tlasInstance, geometryIndex, primitiveIndex});
+            }
+        }
+    }
+
+    std::vector<IvyAabb> triangleBounds(m_Triangles.size());
+    for (size_t i = 0; i < m_Triangles.size(); ++i)
+    {
+        const Triangle& tri = m_Triangles[i];
+        triangleBounds[i].Grow(tri.V0);
+        triangleBounds[i].Grow(tri.V0 + tri.Edge1);
+        triangleBounds[i].Grow(tri.V0 + tri.Edge2);
+    }
+
+    m_Bvh.Build(triangleBounds, settings);
+
+    // store triangles in leaf order, so leaves reference a contiguous range of m_Triangles
+    std::vector<Triangle> sortedTriangles;
+    sortedTriangles.reserve(m_Triangles.size());
+    for (const uint32_t index : m_Bvh.GetPrimitiveIndices())
+    {
+        sortedTriangles.push_back(m_Triangles[index]);
+    }
+    m_Triangles.swap(sortedTriangles);
+}
+
+IvyAabb IvyCpuScene::GetBounds() const
+{
+    IvyAabb bounds;
+    if (!m_Bvh.GetNodes().empty())
+    {
+        bounds.Min = m_Bvh.GetNodes()[0].BoundsMin;
+        bounds.Max = m_Bvh.GetNodes()[0].BoundsMax;
+    }
+    return bounds;
+}
+
+IvyAabb IvyCpuScene::GetSurfaceBounds(int surfaceIndex) const
+{
+    IvyAabb bounds;
+    if ((surfaceIndex >= 0) && (static_cast<size_t>(surfaceIndex) < m_RTInfoTables.m_cpuSurfaceBuffer.size()))
+    {
+        const Surface_Info& sinfo = m_RTInfoTables.m_cpuSurfaceBuffer[surfaceIndex];
+        for (uint32_t vertexId = 0; vertexId < static_cast<uint32_t>(sinfo.num_vertices); ++vertexId)
+        {
+            bounds.Grow(FetchFloat3(sinfo.position_attribute_offset, vertexId));
+        }
+    }
+    return bounds;
+}
+
+bool IvyCpuScene::TraceRay(const float3& origin, const float3& direction, float tMin, float tMax, float3& hitPosition, float3& hitNormal) const
+{
+    Hit closestHit;
+    closestHit.T = tMax;
+
+    m_Bvh.Traverse(origin, direction, tMin, tMax, [&](uint32_t first, uint32_t count, float& tClosest) {
+        for (uint32_t i = first; i < first + count; ++i)
+        {
+            Hit hit;
+            hit.Triangle = i;
+            if (IntersectTriangle(m_Triangles[i], origin, direction, tMin, tClosest, hit) && IsCloser(hit, closestHit))
+            {
+                closestHit = hit;
+                tClosest   = hit.T;
+            }
+        }
+    });
+
+    return ResolveHit(closestHit, origin, direction, tMax, hitPosition, hitNormal);
+}
+
+void IvyCpuScene::TraceRays(const Ray* rays, uint32_t rayCount, RayHit* hits) const
+{
+    for (uint32_t first = 0; first < rayCount; first += PacketSize)
+    {
+        // PacketSize is copied, std::min would bind the static member by reference
+        const uint32_t packetSize = PacketSize;
+        TracePacket(rays + first, std::min(packetSize, rayCount - first), hits + first);
+    }
+}
+
+void IvyCpuScene::TracePacket(const Ray* rays, uint32_t rayCount, RayHit* hits) const
+{
+    // Structure of arrays copy of the packet. Unused lanes get an empty [tMin, tMax] interval and never hit.
+    alignas(32) float origin[3][PacketSize];
+    alignas(32) float direction[3][PacketSize];
+    alignas(32) float inverseDirection[3][PacketSize];
+    alignas(32) float tMin[PacketSize];
+    alignas(32) float tClosest[PacketSize];
+
+    Hit closestHits[PacketSize];
+
+    for (uint32_t lane = 0; lane < PacketSize; ++lane)
+    {
+        const bool   used = lane < rayCount;
+        const Ray    ray  = used ? rays[lane] : Ray{float3(0, 0, 0), float3(1, 0, 0), 1.f, -1.f};
+        const float3 inv  = IvyBvh::SafeInverse(ray.Direction);
+
+        for (int axis = 0; axis < 3; ++axis)
+        {
+            origin[axis][lane]           = ray.Origin[axis];
+            direction[axis][lane]        = ray.Direction[axis];
+            inverseDirection[axis][lane] = inv[axis];
+        }
+        tMin[lane]             = ray.TMin;
+        tClosest[lane]         = ray.TMax;
+        closestHits[lane].T    = ray.TMax;
+    }
+
+    const float3x8 packetOrigin    = {float8::Load(origin[0]), float8::Load(origin[1]), float8::Load(origin[2])};
+    const float3x8 packetDirection = {float8::Load(direction[0]), float8::Load(direction[1]), float8::Load(direction[2])};
+    const float3x8 packetInverse   = {float8::Load(inverseDirection[0]), float8::Load(inverseDirection[1]), float8::Load(inverseDirection[2])};
+    const float8   packetTMin      = float8::Load(tMin);
+    float8         packetTClosest  = float8::Load(tClosest);
+
+    const float8 zero(0.f);
+    const float8 one(1.f);
+    const float8 infinity(FLT_MAX);
+
+    // Slab test of all rays against a node, same operations as IvyBvh::IntersectNode()
+    auto intersectNode = [&](const IvyBvh::Node& node, float8& tEnter) {
+        const float8 tx0 = (float8(node.BoundsMin.x) - packetOrigin.x) * packetInverse.x;
+        const float8 tx1 = (float8(node.BoundsMax.x) - packetOrigin.x) * packetInverse.x;
+        const float8 ty0 = (float8(node.BoundsMin.y) - packetOrigin.y) * packetInverse.y;
+        const float8 ty1 = (float8(node.BoundsMax.y) - packetOrigin.y) * packetInverse.y;
+        const float8 tz0 = (float8(node.BoundsMin.z) - packetOrigin.z) * packetInverse.z;
+        const float8 tz1 = (float8(node.BoundsMax.z) - packetOrigin.z) * packetInverse.z;
+
+        tEnter             = max(max(min(tx0, tx1), min(ty0, ty1)), max(min(tz0, tz1), packetTMin));
+        const float8 tExit = min(min(max(tx0, tx1), max(ty0, ty1)), min(max(tz0, tz1), packetTClosest));
+
+        const bool8 hit = tEnter <= tExit;
+        tEnter          = select(hit, tEnter, infinity);
+        return hit.Mask();
+    };
+
+    // Moeller-Trumbore for all rays against one triangle, same operations as IntersectTriangle()
+    auto intersectTriangle = [&](uint32_t triangleIndex) {
+        const Triangle& tri = m_Triangles[triangleIndex];
+
+        const float3x8 edge1 = {float8(tri.Edge1.x), float8(tri.Edge1.y), float8(tri.Edge1.z)};
+        const float3x8 edge2 = {float8(tri.Edge2.x), float8(tri.Edge2.y), float8(tri.Edge2.z)};
+        const float3x8 v0    = {float8(tri.V0.x), float8(tri.V0.y), float8(tri.V0.z)};
+
+        const float3x8 pvec   = cross(packetDirection, edge2);
+        const float8   det    = dot(edge1, pvec);
+        const float8   invDet = one / det;
+        const float3x8 tvec   = packetOrigin - v0;
+        const float8   u      = dot(tvec, pvec) * invDet;
+        const float3x8 qvec   = cross(tvec, edge1);
+        const float8   v      = dot(packetDirection, qvec) * invDet;
+        const float8   t      = dot(edge2, qvec) * invDet;
+
+        const bool8    valid  = (det != zero) & (u >= zero) & (u <= one) & (v >= zero) & ((u + v) <= one) & (t >= packetTMin) & (t <= packetTClosest);
+        const uint32_t mask   = valid.Mask();
+        if (!mask)
+        {
+            return;
+        }
+
+        alignas(32) float tLanes[PacketSize];
+        alignas(32) float uLanes[PacketSize];
+        alignas(32) float vLanes[PacketSize];
+        t.Store(tLanes);
+        u.Store(uLanes);
+        v.Store(vLanes);
+
+        for (uint32_t lane = 0; lane < PacketSize; ++lane)
+        {
+            if (!((mask >> lane) & 1))
+            {
+                continue;
+            }
+
+            Hit hit;
+            hit.T            = tLanes[lane];
+            hit.Barycentrics = float2(uLanes[lane], vLanes[lane]);
+            hit.Triangle     = triangleIndex;
+
+            if (IsCloser(hit, closestHits[lane]))
+            {
+                closestHits[lane] = hit;
+                tClosest[lane]    = hit.T;
+            }
+        }
+        packetTClosest = float8::Load(tClosest);
+    };
+
+    const std::vector<IvyBvh::Node>& nodes = m_Bvh.GetNodes();
+    if (!nodes.empty())
+    {
+        float8 tEnter;
+        if (intersectNode(nodes[0], tEnter))
+        {
+            uint32_t stack[IvyBvh::MaxDepth];
+            uint32_t stackSize = 0;
+            uint32_t nodeIndex = 0;
+
+            for (;;)
+            {
+                const IvyBvh::Node& node = nodes[nodeIndex];
+
+                if (node.IsLeaf())
+                {
+                    for (uint32_t i = node.LeftFirst; i < node.LeftFirst + node.PrimitiveCount; ++i)
+                    {
+                        intersectTriangle(i);
+                    }
+                }
+                else
+                {
+                    float8         tNear, tFar;
+                    uint32_t       near     = node.LeftFirst;
+                    uint32_t       far      = node.LeftFirst + 1;
+                    const uint32_t nearMask = intersectNode(nodes[near], tNear);
+                    const uint32_t farMask  = intersectNode(nodes[far], tFar);
+
+                    if (nearMask && farMask)
+                    {
+                        // visit the child that is closer for the majority of the packet first
+                        const uint32_t farCloser = (tFar < tNear).Mask();
+                        if (countbits(farCloser) * 2 > countbits(nearMask | farMask))
+                        {
+                            std::swap(near, far);
+                        }
+                        stack[stackSize++] = far;
+                        nodeIndex          = near;
+                        continue;
+                    }
+                    if (nearMask || farMask)
+                    {
+                        nodeIndex = nearMask ? near : far;
+                        continue;
+                    }
+                }
+
+                // pop next node, skip nodes behind the closest hits of all rays
+                bool found = false;
+                while (stackSize > 0)
+                {
+                    nodeIndex = stack[--stackSize];
+                    if (intersectNode(nodes[nodeIndex], tEnter))
+                    {
+                        found = true;
+                        break;
+                    }
+                }
+                if (!found)
+                {
+                    break;
+                }
+            }
+        }
+    }
+
+    for (uint32_t lane = 0; lane < rayCount; ++lane)
+    {
+        hits[lane].Hit = ResolveHit(closestHits[lane], rays[lane].Origin, rays[lane].Direction, rays[lane].TMax, hits[lane].Position, hits[lane].Normal);
+    }
+}
+
+bool IvyCpuScene::TraceRayBruteForce(const float3& origin, const float3& direction, float tMin, float tMax, float3& hitPosition, float3& hitNormal) const
+{
+    Hit closestHit;
+    closestHit.T = tMax;
+
+    for (uint32_t i = 0; i < m_Triangles.size(); ++i)
+    {
+        Hit hit;
+        hit.Triangle = i;
+        if (IntersectTriangle(m_Triangles[i], origin, direction, tMin, closestHit.T, hit) && IsCloser(hit, closestHit))
+        {
+            closestHit = hit;
+        }
+    }
+
+    return ResolveHit(closestHit, origin, direction, tMax, hitPosition, hitNormal);
+}
+
+bool IvyCpuScene::ResolveHit(const Hit& hit, const float3& origin, const float3& direction, float tMax, float3& hitPosition, float3& hitNormal) const
+{
+    if (hit.Triangle == ~0u)
+    {
+        hitPosition = origin + direction * tMax;
+        hitNormal   = float3(0, 1, 0);
+
+        return false;
+    }
+
+    hitPosition = origin + direction * hit.T;
+    hitNormal   = ComputeHitNormal(hit);
+
+    return true;
+}
+
+bool IvyCpuScene::IntersectTriangle(const Triangle& tri, const float3& origin, const float3& direction, float tMin, float tMax, Hit& hit)
+{
+    // Moeller-Trumbore, triangles are double sided (RAY_FLAG_FORCE_OPAQUE, no culling flags)
+    const float3 pvec = cross(direction, tri.Edge2);
+    const float  det  = dot(tri.Edge1, pvec);
+
+    if (det == 0.f)
+    {
+        return false;
+    }
+
+    const float  invDet = 1.f / det;
+    const float3 tvec   = origin - tri.V0;
+
+    // comparisons are written to also reject NaN, matching the packet version in TracePacket()
+    const float u = dot(tvec, pvec) * invDet;
+    if (!((u >= 0.f) && (u <= 1.f)))
+    {
+        return false;
+    }
+
+    const float3 qvec = cross(tvec, tri.Edge1);
+    const float  v    = dot(direction, qvec) * invDet;
+    if (!((v >= 0.f) && (u + v <= 1.f)))
+    {
+        return false;
+    }
+
+    const float t = dot(tri.Edge2, qvec) * invDet;
+    if (!((t >= tMin) && (t <= tMax)))
+    {
+        return false;
+    }
+
+    hit.T            = t;
+    hit.Barycentrics = float2(u, v);
+
+    return true;
+}
+
+uint3 IvyCpuScene::FetchIndices(const Surface_Info& sinfo, uint32_t triangleId) const
+{
+    const std::vector<uint32_t>& indexBuffer = m_RTInfoTables.m_IndexBuffers[sinfo.index_offset];
+    return uint3{indexBuffer[3 * triangleId], indexBuffer[3 * triangleId + 1], indexBuffer[3 * triangleId + 2]};
+}
+
+float3 IvyCpuScene::FetchFloat3(int offset, uint32_t vertexId) const
+{
+    const std::vector<float>& vertexBuffer = m_RTInfoTables.m_VertexBuffers[offset];
+    return float3(vertexBuffer[3 * vertexId], vertexBuffer[3 * vertexId + 1], vertexBuffer[3 * vertexId + 2]);
+}
+
+float3 IvyCpuScene::FetchNormal(const Surface_Info& sinfo, const uint3& face3, const float2& bary) const
+{
+    if (sinfo.normal_attribute_offset < 0)
+    {
+        return float3(0, 1, 0);
+    }
+
+    const float3 normal0 = FetchFloat3(sinfo.normal_attribute_offset, face3.x);
+    const float3 normal1 = FetchFloat3(sinfo.normal_attribute_offset, face3.y);
+    const float3 normal2 = FetchFloat3(sinfo.normal_attribute_offset, face3.z);
+    return normal1 * bary.x + normal2 * bary.y + normal0 * (1.f - bary.x - bary.y);
+}
+
+float3 IvyCpuScene::ComputeHitNormal(const Hit& hit) const
+{
+    const Triangle&      tri      = m_Triangles[hit.Triangle];
+    const TlasInstance&  instance = m_TlasInstances[tri.TlasInstance];
+    const Instance_Info& iinfo    = m_RTInfoTables.m_cpuInstanceBuffer[instance.InstanceID];
+
+    const uint32_t     surface_id = m_RTInfoTables.m_cpuSurfaceIDsBuffer[iinfo.surface_id_table_offset + tri.GeometryIndex];
+    const Surface_Info sinfo      = m_RTInfoTables.m_cpuSurfaceBuffer[surface_id];
+
+    const uint3  indices = FetchIndices(sinfo, tri.PrimitiveIndex);
+    const float3 normal  = FetchNormal(sinfo, indices, hit.Barycentrics);
+
+    return normalize(mul(float3x3(instance.ObjectToWorld), normal));
+}
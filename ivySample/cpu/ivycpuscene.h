@@ -0,0 +1,201 @@
+// This file is part of the AMD Work Graph Ivy Generation Sample.
+//
+// Copyright (c) 2024 Advanced Micro Devices, Inc. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+#pragma once
+
+#include "cpu/hlslmath.h"
+#include "cpu/ivybvh.h"
+#include "cpu/ivymeshdata.h"
+#include "shaders/ivycommon.h"
+
+#include <string>
+#include <vector>
+
+/**
+ * @brief   CPU copy of the scene geometry that the work graph ray traces against.
+ *
+ * Stores the same ray tracing info tables as IvyRenderModule::RTInfoTables (Instance_Info, Surface_Info,
+ * surface IDs, index & vertex buffers) together with the instances that make up the TLAS.
+ * TraceRay() follows the semantics of TraceRay() in shaders/raytracing.hlsl.
+ */
+class IvyCpuScene
+{
+public:
+    /**
+     * @brief   Geometry of a single surface (BLAS geometry) passed to AddMesh().
+     */
+    using SurfaceData = IvyMeshData;
+
+    /**
+     * @brief   Ray tracing info tables, mirrors IvyRenderModule::RTInfoTables.
+     *          Index buffers are always expanded to 32 bit indices.
+     */
+    struct RTInfoTables
+    {
+        std::vector<std::vector<float>>    m_VertexBuffers;
+        std::vector<std::vector<uint32_t>> m_IndexBuffers;
+
+        std::vector<Instance_Info> m_cpuInstanceBuffer;
+        std::vector<Surface_Info>  m_cpuSurfaceBuffer;
+        std::vector<uint32_t>      m_cpuSurfaceIDsBuffer;
+    };
+
+    /**
+     * @brief   Adds a mesh consisting of one or more surfaces. Returns the mesh index,
+     *          which is used as instance ID in the TLAS (see Instance_Info).
+     *          Meshes named "Stem" and "Leaf" are registered as ivy stem & leaf surfaces.
+     */
+    uint32_t AddMesh(const std::string& name, const std::vector<SurfaceData>& surfaces);
+
+    /**
+     * @brief   Adds an instance of a mesh to the TLAS.
+     */
+    void AddInstance(uint32_t meshIndex, const Mat4& objectToWorld);
+
+    /**
+     * @brief   Builds the acceleration structure (a SAH BVH over all world space triangles, standing in for the TLAS).
+     *          Must be called after all meshes & instances were added.
+     */
+    void Build(const IvyBvh::BuildSettings& settings = IvyBvh::BuildSettings());
+
+    /**
+     * @brief   Closest hit ray query, see TraceRay() in shaders/raytracing.hlsl.
+     *          tMin and tMax are relative to the length of direction.
+     */
+    bool TraceRay(const float3& origin, const float3& direction, float tMin, float tMax, float3& hitPosition, float3& hitNormal) const;
+
+    struct Ray
+    {
+        float3 Origin;
+        float3 Direction;
+        float  TMin = 0.f;
+        float  TMax = 0.f;
+    };
+
+    struct RayHit
+    {
+        float3 Position;
+        float3 Normal;
+        bool   Hit = false;
+    };
+
+    // Number of rays traversing the BVH together in TraceRays()
+    static const uint32_t PacketSize = 8;
+
+    /**
+     * @brief   Traces rayCount rays in packets of PacketSize using 8-wide SIMD, see cpu/simdmath.h.
+     *          Each ray gives the same result as TraceRay(). Intended for the coherent rays of a wave,
+     *          e.g. the ivyForwardProbeCount forward probes or the random-direction rays of IvyBranch.
+     */
+    void TraceRays(const Ray* rays, uint32_t rayCount, RayHit* hits) const;
+
+    /**
+     * @brief   Reference implementation of TraceRay() testing every triangle, used to validate the BVH.
+     */
+    bool TraceRayBruteForce(const float3& origin, const float3& direction, float tMin, float tMax, float3& hitPosition, float3& hitNormal) const;
+
+    const RTInfoTables& GetRTInfoTables() const
+    {
+        return m_RTInfoTables;
+    }
+
+    size_t GetTriangleCount() const
+    {
+        return m_Triangles.size();
+    }
+
+    const IvyBvh& GetBvh() const
+    {
+        return m_Bvh;
+    }
+
+    IvyAabb GetBounds() const;
+
+    /**
+     * @brief   Object space bounds of the vertices of a surface, e.g. the ivy leaf & stem meshes for frustum culling.
+     */
+    IvyAabb GetSurfaceBounds(int surfaceIndex) const;
+
+    int GetIvyStemSurfaceIndex() const
+    {
+        return m_ivyStemSurfaceIndex;
+    }
+
+    int GetIvyLeafSurfaceIndex() const
+    {
+        return m_ivyLeafSurfaceIndex;
+    }
+
+private:
+    struct TlasInstance
+    {
+        float4x4 ObjectToWorld;
+        uint32_t InstanceID;
+    };
+
+    // World space triangle with references back into the info tables
+    struct Triangle
+    {
+        float3   V0;
+        float3   Edge1;
+        float3   Edge2;
+        uint32_t TlasInstance;
+        uint32_t GeometryIndex;
+        uint32_t PrimitiveIndex;
+    };
+
+    struct Hit
+    {
+        float    T           = 0.f;
+        float2   Barycentrics;
+        uint32_t Triangle    = ~0u;
+    };
+
+    void TracePacket(const Ray* rays, uint32_t rayCount, RayHit* hits) const;
+
+    bool ResolveHit(const Hit& hit, const float3& origin, const float3& direction, float tMax, float3& hitPosition, float3& hitNormal) const;
+
+    static bool IntersectTriangle(const Triangle& tri, const float3& origin, const float3& direction, float tMin, float tMax, Hit& hit);
+
+    // Closest hit rule shared by all traversal variants, hit.T <= closestHit.T is guaranteed by the tMax of the
+    // intersection test. Hits at equal distance resolve to the lowest triangle index, so results do not depend on traversal order.
+    static bool IsCloser(const Hit& hit, const Hit& closestHit)
+    {
+        return (hit.T < closestHit.T) || (closestHit.Triangle == ~0u) || (hit.Triangle < closestHit.Triangle);
+    }
+
+    uint3  FetchIndices(const Surface_Info& sinfo, uint32_t triangleId) const;
+    float3 FetchFloat3(int offset, uint32_t vertexId) const;
+    float3 FetchNormal(const Surface_Info& sinfo, const uint3& face3, const float2& bary) const;
+    float3 ComputeHitNormal(const Hit& hit) const;
+
+    RTInfoTables              m_RTInfoTables;
+    std::vector<TlasInstance> m_TlasInstances;
+    // Triangles are stored in BVH leaf order
+    std::vector<Triangle>     m_Triangles;
+    IvyBvh                    m_Bvh;
+
+    // Index of ivy stem surface in m_cpuSurfaceBuffer
+    int m_ivyStemSurfaceIndex = -1;
+    // Index of ivy leaf surface in m_cpuSurfaceBuffer
+    int m_ivyLeafSurfaceIndex = -1;
+};
@@ -0,0 +1,302 @@
+// This file is part of the AMD Work Graph Ivy Generation Sample.
+//
+// Copyright (c) 2024 Advanced Micro Devices, Inc. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+#include "cpu/ivyentryrecordbuffer.h"
+
+#include <algorithm>
+#include <cstring>
+
+static_assert(sizeof(IvyNodeGpuInput) == 24, "must match D3D12_NODE_GPU_INPUT");
+static_assert(sizeof(IvyMultiNodeGpuInput) == sizeof(IvyNodeGpuInput), "must match D3D12_MULTI_NODE_GPU_INPUT");
+static_assert(sizeof(IvyBranchRecord) <= IvyEntryRecordBuffer::RecordSlotSize, "IvyBranchRecord does not fit into a record slot");
+static_assert(sizeof(IvyAreaRecord) <= IvyEntryRecordBuffer::RecordSlotSize, "IvyAreaRecord does not fit into a record slot");
+
+IvyEntryRecordBuffer::IvyEntryRecordBuffer(uint32_t capacity)
+{
+    Reserve(std::max(capacity, 1u));
+}
+
+void IvyEntryRecordBuffer::SetEntrypoints(uint32_t branchEntrypoint, uint32_t areaEntrypoint)
+{
+    m_Entrypoints[static_cast<uint32_t>(IvyEntryRecordType::Branch)] = branchEntrypoint;
+    m_Entrypoints[static_cast<uint32_t>(IvyEntryRecordType::Area)]   = areaEntrypoint;
+
+    WriteInputs();
+}
+
+void IvyEntryRecordBuffer::SetGpuAddress(uint64_t address)
+{
+    m_GpuAddress = address;
+
+    // the new buffer holds none of the data yet
+    WriteInputs();
+    std::fill(m_InputsDirty.begin(), m_InputsDirty.begin() + 1 + m_NodeInputCount, true);
+    std::fill(m_RecordsDirty.begin(), m_RecordsDirty.begin() + m_RecordCount, true);
+}
+
+uint32_t IvyEntryRecordBuffer::Add(const IvyBranchRecord& record)
+{
+    Reserve(m_RecordCount + 1);
+    WriteRecord(m_RecordCount, record);
+    return m_RecordCount++;
+}
+
+uint32_t IvyEntryRecordBuffer::Add(const IvyAreaRecord& record)
+{
+    Reserve(m_RecordCount + 1);
+    WriteRecord(m_RecordCount, record);
+    return m_RecordCount++;
+}
+
+void IvyEntryRecordBuffer::Update(uint32_t slot, const IvyBranchRecord& record)
+{
+    WriteRecord(slot, record);
+}
+
+void IvyEntryRecordBuffer::Update(uint32_t slot, const IvyAreaRecord& record)
+{
+    WriteRecord(slot, record);
+}
+
+void IvyEntryRecordBuffer::Remove(uint32_t slot)
+{
+    if (slot >= m_RecordCount)
+    {
+        return;
+    }
+
+    // the partition of the moved records changes with their slot
+    for (uint32_t next = slot + 1; next < m_RecordCount; ++next)
+    {
+        if (m_Types[next] == IvyEntryRecordType::Branch)
+        {
+            IvyBranchRecord record;
+            std::memcpy(&record, &m_Data[GetRecordOffset(next)], sizeof(record));
+            WriteRecord(next - 1, record);
+        }
+        else
+        {
+            IvyAreaRecord record;
+            std::memcpy(&record, &m_Data[GetRecordOffset(next)], sizeof(record));
+            WriteRecord(next - 1, record);
+        }
+    }
+
+    // the last slot is not dispatched anymore, so it does not have to be uploaded
+    --m_RecordCount;
+    m_Types[m_RecordCount]        = IvyEntryRecordType::None;
+    m_RecordsDirty[m_RecordCount] = false;
+    WriteInputs();
+}
+
+void IvyEntryRecordBuffer::Assign(const std::vector<IvyBranchRecord>& branchRecords, const std::vector<IvyAreaRecord>& areaRecords)
+{
+    const uint32_t recordCount = static_cast<uint32_t>(branchRecords.size() + areaRecords.size());
+    Reserve(recordCount);
+
+    for (uint32_t slot = 0; slot < recordCount; ++slot)
+    {
+        if (slot < branchRecords.size())
+        {
+            WriteRecord(slot, branchRecords[slot]);
+        }
+        else
+        {
+            WriteRecord(slot, areaRecords[slot - branchRecords.size()]);
+        }
+    }
+
+    while (m_RecordCount > recordCount)
+    {
+        Remove(m_RecordCount - 1);
+    }
+    if (m_RecordCount < recordCount)
+    {
+        m_RecordCount = recordCount;
+        WriteInputs();
+    }
+}
+
+void IvyEntryRecordBuffer::SetDispatchSlots(const std::vector<uint32_t>& slots)
+{
+    m_DispatchSlots = slots;
+    WriteInputs();
+}
+
+std::vector<IvyEntryRecordBuffer::Range> IvyEntryRecordBuffer::GetDirtyRanges() const
+{
+    std::vector<Range> ranges;
+
+    // adjacent dirty inputs or slots are merged into one range
+    const auto addRange = [&ranges](uint64_t offset, uint64_t size) {
+        if (!ranges.empty() && (ranges.back().Offset + ranges.back().Size == offset))
+        {
+            ranges.back().Size += size;
+        }
+        else
+        {
+            ranges.push_back({offset, size});
+        }
+    };
+
+    for (uint32_t input = 0; input < m_InputsDirty.size(); ++input)
+    {
+        if (m_InputsDirty[input])
+        {
+            addRange(GetInputOffset(input), sizeof(IvyNodeGpuInput));
+        }
+    }
+    for (uint32_t slot = 0; slot < m_Capacity; ++slot)
+    {
+        if (m_RecordsDirty[slot])
+        {
+            addRange(GetRecordOffset(slot), RecordSlotSize);
+        }
+    }
+
+    return ranges;
+}
+
+bool IvyEntryRecordBuffer::IsDirty() const
+{
+    return (std::find(m_InputsDirty.begin(), m_InputsDirty.end(), true) != m_InputsDirty.end()) ||
+           (std::find(m_RecordsDirty.begin(), m_RecordsDirty.end(), true) != m_RecordsDirty.end());
+}
+
+void IvyEntryRecordBuffer::ClearDirtyRanges()
+{
+    std::fill(m_InputsDirty.begin(), m_InputsDirty.end(), false);
+    std::fill(m_RecordsDirty.begin(), m_RecordsDirty.end(), false);
+}
+
+void IvyEntryRecordBuffer::Reserve(uint32_t capacity)
+{
+    if (capacity <= m_Capacity)
+    {
+        return;
+    }
+
+    const uint32_t previousCapacity = m_Capacity;
+    const uint64_t previousOffset   = m_RecordRegionOffset;
+    while (m_Capacity < capacity)
+    {
+        m_Capacity = std::max(2 * m_Capacity, 1u);
+    }
+
+    // records start 16 byte aligned after the multi node input & one node input per slot
+    m_RecordRegionOffset = (GetInputOffset(m_Capacity + 1) + 15) & ~15ull;
+
+    std::vector<uint8_t> data(m_RecordRegionOffset + static_cast<uint64_t>(m_Capacity) * RecordSlotSize, 0);
+    if (previousCapacity > 0)
+    {
+        std::memcpy(&data[m_RecordRegionOffset], &m_Data[previousOffset], static_cast<size_t>(previousCapacity) * RecordSlotSize);
+    }
+    m_Data.swap(data);
+
+    m_Types.resize(m_Capacity, IvyEntryRecordType::None);
+    m_InputsDirty.assign(m_Capacity + 1, false);
+    m_RecordsDirty.assign(m_Capacity, false);
+
+    // the layout moved, everything in use has to be uploaded again
+    WriteInputs();
+    std::fill(m_InputsDirty.begin(), m_InputsDirty.begin() + 1 + m_NodeInputCount, true);
+    std::fill(m_RecordsDirty.begin(), m_RecordsDirty.begin() + m_RecordCount, true);
+}
+
+void IvyEntryRecordBuffer::WriteRecord(uint32_t slot, IvyBranchRecord record)
+{
+    record.partition = slot;
+    WriteRecord(slot, IvyEntryRecordType::Branch, &record, sizeof(record));
+}
+
+void IvyEntryRecordBuffer::WriteRecord(uint32_t slot, IvyAreaRecord record)
+{
+    record.partition = slot;
+    WriteRecord(slot, IvyEntryRecordType::Area, &record, sizeof(record));
+}
+
+void IvyEntryRecordBuffer::WriteRecord(uint32_t slot, IvyEntryRecordType type, const void* record, uint32_t recordSize)
+{
+    uint8_t* pSlot = &m_Data[GetRecordOffset(slot)];
+
+    if (m_Types[slot] != type)
+    {
+        // the runs of the node inputs depend on the record types
+        m_Types[slot] = type;
+        WriteInputs();
+    }
+    else if (std::memcmp(pSlot, record, recordSize) == 0)
+    {
+        return;
+    }
+
+    std::memcpy(pSlot, record, recordSize);
+    m_RecordsDirty[slot] = true;
+}
+
+void IvyEntryRecordBuffer::WriteInputs()
+{
+    // one node input per run of consecutive slots with the same record type
+    m_NodeInputCount = 0;
+    for (size_t i = 0; i < m_DispatchSlots.size(); ++i)
+    {
+        const uint32_t slot = m_DispatchSlots[i];
+        if (slot >= m_RecordCount)
+        {
+            continue;
+        }
+
+        uint32_t runLength = 1;
+        while ((i + 1 < m_DispatchSlots.size()) && (m_DispatchSlots[i + 1] == slot + runLength) && (slot + runLength < m_RecordCount) &&
+               (m_Types[slot + runLength] == m_Types[slot]))
+        {
+            ++runLength;
+            ++i;
+        }
+
+        IvyNodeGpuInput nodeInput       = {};
+        nodeInput.EntrypointIndex       = m_Entrypoints[static_cast<uint32_t>(m_Types[slot])];
+        nodeInput.NumRecords            = runLength;
+        nodeInput.Records.StartAddress  = m_GpuAddress + GetRecordOffset(slot);
+        nodeInput.Records.StrideInBytes = RecordSlotSize;
+
+        WriteInput(1 + m_NodeInputCount, &nodeInput);
+        ++m_NodeInputCount;
+    }
+
+    IvyMultiNodeGpuInput multiNodeInput     = {};
+    multiNodeInput.NumNodeInputs            = m_NodeInputCount;
+    multiNodeInput.NodeInputs.StartAddress  = m_GpuAddress + GetInputOffset(1);
+    multiNodeInput.NodeInputs.StrideInBytes = sizeof(IvyNodeGpuInput);
+
+    WriteInput(0, &multiNodeInput);
+}
+
+void IvyEntryRecordBuffer::WriteInput(uint32_t input, const void* data)
+{
+    uint8_t* pInput = &m_Data[GetInputOffset(input)];
+    if (std::memcmp(pInput, data, sizeof(IvyNodeGpuInput)) != 0)
+    {
+        std::memcpy(pInput, data, sizeof(IvyNodeGpuInput));
+        m_InputsDirty[input] = true;
+    }
+}
@@ -0,0 +1,202 @@
+// This file is part of the AMD Work Graph Ivy Generation Sample.
+//
+// Copyright (c) 2024 Advanced Micro Devices, Inc. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+#pragma once
+
+// Cauldron-free, used by IvyRenderModule as well as the headless benchmarks.
+
+#include "shaders/ivycommon.h"
+
+#include <cstdint>
+#include <vector>
+
+// Layouts of D3D12_GPU_VIRTUAL_ADDRESS_AND_STRIDE, D3D12_NODE_GPU_INPUT & D3D12_MULTI_NODE_GPU_INPUT
+struct IvyGpuAddressAndStride
+{
+    uint64_t StartAddress;
+    uint64_t StrideInBytes;
+};
+
+struct IvyNodeGpuInput
+{
+    uint32_t               EntrypointIndex;
+    uint32_t               NumRecords;
+    IvyGpuAddressAndStride Records;
+};
+
+struct IvyMultiNodeGpuInput
+{
+    uint32_t               NumNodeInputs;
+    uint32_t               Padding;
+    IvyGpuAddressAndStride NodeInputs;
+};
+
+enum class IvyEntryRecordType : uint32_t
+{
+    None,
+    Branch,  // IvyBranchRecord
+    Area     // IvyAreaRecord
+};
+
+/**
+ * @brief   CPU image of the persistent entry record buffer of DispatchGraph with D3D12_DISPATCH_MODE_MULTI_NODE_GPU_INPUT.
+ *
+ * Every slot is the partition of one entry record, the buffer writes the slot to the partition of the record.
+ * SetDispatchSlots() selects the records of the next DispatchGraph: one multi node input, with a node input per run of
+ * consecutive slots of the same record type, such that all dirty records are dispatched at once.
+ * The buffer is laid out as [multi node input][node inputs][records], with one node input & record per slot.
+ * The capacity grows with the records, the GPU buffer then has to be recreated with GetSize() & SetGpuAddress().
+ *
+ * Records & inputs are only marked dirty if their bytes change. GetDirtyRanges() returns the byte ranges that have to
+ * be uploaded to the GPU buffer, so records are not copied every frame & not all records are copied on an edit.
+ * The node inputs depend on the GPU address of the buffer & the entrypoint indices of the work graph.
+ */
+class IvyEntryRecordBuffer
+{
+public:
+    struct Range
+    {
+        uint64_t Offset = 0;
+        uint64_t Size   = 0;
+    };
+
+    // Bytes per record, both record types fit into a slot. Also the stride of the node inputs.
+    static const uint32_t RecordSlotSize = 80;
+
+    static const uint32_t InitialCapacity = 16;
+
+    explicit IvyEntryRecordBuffer(uint32_t capacity = InitialCapacity);
+
+    /**
+     * @brief   Entrypoint indices of IvyBranch & IvyArea in the work graph, rewrites the node inputs.
+     */
+    void SetEntrypoints(uint32_t branchEntrypoint, uint32_t areaEntrypoint);
+
+    /**
+     * @brief   GPU virtual address of a new GPU buffer, rewrites the inputs & marks all records dirty.
+     */
+    void SetGpuAddress(uint64_t address);
+
+    /**
+     * @brief   Appends a record, grows the capacity if the buffer is full. Returns the slot.
+     */
+    uint32_t Add(const IvyBranchRecord& record);
+    uint32_t Add(const IvyAreaRecord& record);
+
+    void Update(uint32_t slot, const IvyBranchRecord& record);
+    void Update(uint32_t slot, const IvyAreaRecord& record);
+
+    /**
+     * @brief   Removes a record, the records of later slots move down by one slot.
+     */
+    void Remove(uint32_t slot);
+
+    /**
+     * @brief   Updates all slots to branch records followed by area records, like the partitions of IvyRenderModule.
+     */
+    void Assign(const std::vector<IvyBranchRecord>& branchRecords, const std::vector<IvyAreaRecord>& areaRecords);
+
+    /**
+     * @brief   Records of the next DispatchGraph, in ascending order. Slots beyond the records are ignored.
+     */
+    void SetDispatchSlots(const std::vector<uint32_t>& slots);
+
+    uint32_t GetRecordCount() const
+    {
+        return m_RecordCount;
+    }
+
+    uint32_t GetCapacity() const
+    {
+        return m_Capacity;
+    }
+
+    IvyEntryRecordType GetType(uint32_t slot) const
+    {
+        return m_Types[slot];
+    }
+
+    uint32_t GetNodeInputCount() const
+    {
+        return m_NodeInputCount;
+    }
+
+    const uint8_t* GetData() const
+    {
+        return m_Data.data();
+    }
+
+    uint64_t GetSize() const
+    {
+        return m_Data.size();
+    }
+
+    /**
+     * @brief   GPU address of the D3D12_MULTI_NODE_GPU_INPUT of the records set by SetDispatchSlots().
+     */
+    uint64_t GetMultiNodeInputAddress() const
+    {
+        return m_GpuAddress;
+    }
+
+    /**
+     * @brief   Sorted & merged byte ranges changed since ClearDirtyRanges().
+     */
+    std::vector<Range> GetDirtyRanges() const;
+    bool               IsDirty() const;
+    void               ClearDirtyRanges();
+
+private:
+    // Input 0 is the multi node input, input i + 1 the node input i, both have the same size
+    uint64_t GetInputOffset(uint32_t input) const
+    {
+        return static_cast<uint64_t>(input) * sizeof(IvyNodeGpuInput);
+    }
+    uint64_t GetRecordOffset(uint32_t slot) const
+    {
+        return m_RecordRegionOffset + static_cast<uint64_t>(slot) * RecordSlotSize;
+    }
+
+    // Doubles the capacity until it holds capacity records, marks all records & inputs dirty
+    void Reserve(uint32_t capacity);
+
+    // Writes a record with its slot as partition, only marks it dirty if its type or bytes changed
+    void WriteRecord(uint32_t slot, IvyBranchRecord record);
+    void WriteRecord(uint32_t slot, IvyAreaRecord record);
+    void WriteRecord(uint32_t slot, IvyEntryRecordType type, const void* record, uint32_t recordSize);
+    // Rebuilds the node inputs & the multi node input of the dispatch slots
+    void WriteInputs();
+    // Copies an input, only marks it dirty if its bytes changed
+    void WriteInput(uint32_t input, const void* data);
+
+    uint32_t                        m_Capacity            = 0;
+    uint32_t                        m_RecordCount         = 0;
+    uint32_t                        m_NodeInputCount      = 0;
+    uint64_t                        m_RecordRegionOffset  = 0;
+    uint64_t                        m_GpuAddress          = 0;
+    uint32_t                        m_Entrypoints[3]      = {};  // per IvyEntryRecordType
+    std::vector<uint8_t>            m_Data;
+    std::vector<IvyEntryRecordType> m_Types;
+    std::vector<uint32_t>           m_DispatchSlots;
+    std::vector<bool>               m_InputsDirty;   // per input, see GetInputOffset()
+    std::vector<bool>               m_RecordsDirty;  // per slot
+};
@@ -0,0 +1,174 @@
+// This file is part of the AMD Work Graph Ivy Generation Sample.
+//
+// Copyright (c) 2024 Advanced Micro Devices, Inc. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+#pragma once
+
+// Cauldron-free, used by IvyRenderModule as well as the headless benchmarks.
+
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+#include <vector>
+
+/**
+ * @brief   64 bit FNV-1a hash over the inputs of an ivy generation.
+ *
+ * Records are hashed as raw bytes, i.e. exactly as they are passed to DispatchGraph. Uninitialized padding
+ * can only cause additional regenerations, never a missed one.
+ */
+class IvyGenerationKey
+{
+public:
+    template <typename T>
+    void Add(const T& value)
+    {
+        static_assert(std::is_trivially_copyable<T>::value, "generation inputs are hashed as raw bytes");
+        AddBytes(&value, sizeof(T));
+    }
+
+    template <typename T>
+    void Add(const std::vector<T>& values)
+    {
+        static_assert(std::is_trivially_copyable<T>::value, "generation inputs are hashed as raw bytes");
+        // include the count, such that moving a record between two arrays changes the key
+        Add(static_cast<uint64_t>(values.size()));
+        AddBytes(values.data(), values.size() * sizeof(T));
+    }
+
+    void AddBytes(const void* data, size_t size)
+    {
+        const uint8_t* bytes = static_cast<const uint8_t*>(data);
+        for (size_t i = 0; i < size; ++i)
+        {
+            m_Hash = (m_Hash ^ bytes[i]) * 0x100000001b3ull;
+        }
+    }
+
+    uint64_t Get() const
+    {
+        return m_Hash;
+    }
+
+private:
+    uint64_t m_Hash = 0xcbf29ce484222325ull;
+};
+
+/**
+ * @brief   Keeps track of the inputs of the instances that are currently stored in the instance buffers.
+ *
+ * The generated ivy only depends on the entry records, the loaded scene & the generation settings, not on the camera.
+ * Callers build an IvyGenerationKey of these inputs every frame and only run the work graph if Update() returns true,
+ * otherwise the instance & argument buffers of the last generation are drawn again.
+ */
+class IvyGenerationCache
+{
+public:
+    /**
+     * @brief   Returns true if the instances have to be generated for inputKey. The key is then assumed to be
+     *          the one of the buffer contents, so the caller has to generate the instances in the same frame.
+     */
+    bool Update(uint64_t inputKey)
+    {
+        if (m_Valid && (inputKey == m_Key))
+        {
+            ++m_CachedFrameCount;
+            return false;
+        }
+
+        m_Key   = inputKey;
+        m_Valid = true;
+        ++m_GenerationCount;
+        return true;
+    }
+
+    /**
+     * @brief   Forces a regeneration on the next Update(), e.g. when the instance buffers were recreated.
+     */
+    void Invalidate()
+    {
+        m_Valid = false;
+    }
+
+    uint64_t GetGenerationCount() const
+    {
+        return m_GenerationCount;
+    }
+
+    uint64_t GetCachedFrameCount() const
+    {
+        return m_CachedFrameCount;
+    }
+
+private:
+    uint64_t m_Key              = 0;
+    bool     m_Valid            = false;
+    uint64_t m_GenerationCount  = 0;
+    uint64_t m_CachedFrameCount = 0;
+};
+
+/**
+ * @brief   IvyGenerationCache for each partition of the instance buffers, i.e. for each entry record.
+ *
+ * Only the partitions of entry records with changed inputs have to be regenerated. Inputs that affect all partitions
+ * (loaded content, generation options) and the number of partitions are passed to BeginFrame() as a shared key,
+ * a change of it invalidates every partition.
+ */
+class IvyPartitionedGenerationCache
+{
+public:
+    void BeginFrame(uint32_t partitionCount, uint64_t sharedKey)
+    {
+        IvyGenerationKey key;
+        key.Add(partitionCount);
+        key.Add(sharedKey);
+
+        if (m_Shared.Update(key.Get()))
+        {
+            m_Partitions.assign(partitionCount, IvyGenerationCache{});
+        }
+    }
+
+    /**
+     * @brief   Returns true if the partition has to be regenerated for inputKey, see IvyGenerationCache::Update().
+     */
+    bool Update(uint32_t partition, uint64_t inputKey)
+    {
+        return m_Partitions[partition].Update(inputKey);
+    }
+
+    /**
+     * @brief   Forces a regeneration of all partitions in the next frame.
+     */
+    void Invalidate()
+    {
+        m_Shared.Invalidate();
+    }
+
+    uint32_t GetPartitionCount() const
+    {
+        return static_cast<uint32_t>(m_Partitions.size());
+    }
+
+private:
+    IvyGenerationCache              m_Shared;
+    std::vector<IvyGenerationCache> m_Partitions;
+};
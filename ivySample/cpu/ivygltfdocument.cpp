@@ -0,0 +1,396 @@
+// This file is part of the AMD Work Graph Ivy Generation Sample.
+//
+// Copyright (c) 2024 Advanced Micro Devices, Inc. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+#include "cpu/ivygltfdocument.h"
+
+#include <cstring>
+#include <fstream>
+#include <iterator>
+
+namespace
+{
+    // glTF accessor component types
+    const int ComponentTypeUnsignedByte  = 5121;
+    const int ComponentTypeUnsignedShort = 5123;
+    const int ComponentTypeUnsignedInt   = 5125;
+    const int ComponentTypeFloat         = 5126;
+
+    // glTF primitive modes
+    const int PrimitiveModeTriangles = 4;
+
+    // .glb container
+    const uint32_t GlbMagic     = 0x46546c67;  // "glTF"
+    const uint32_t GlbChunkJson = 0x4e4f534a;  // "JSON"
+    const uint32_t GlbChunkBin  = 0x004e4942;  // "BIN\0"
+
+    bool ReadFile(const std::string& filePath, std::vector<uint8_t>& data)
+    {
+        std::ifstream file(filePath, std::ios::binary);
+        if (!file)
+        {
+            return false;
+        }
+
+        data.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+        return true;
+    }
+
+    bool DecodeBase64(const std::string& text, std::vector<uint8_t>& data)
+    {
+        auto decodeChar = [](char c) -> int {
+            if ((c >= 'A') && (c <= 'Z'))
+                return c - 'A';
+            if ((c >= 'a') && (c <= 'z'))
+                return c - 'a' + 26;
+            if ((c >= '0') && (c <= '9'))
+                return c - '0' + 52;
+            if (c == '+')
+                return 62;
+            if (c == '/')
+                return 63;
+            return -1;
+        };
+
+        uint32_t bits     = 0;
+        int      bitCount = 0;
+        for (const char c : text)
+        {
+            if (c == '=')
+            {
+                break;
+            }
+
+            const int value = decodeChar(c);
+            if (value < 0)
+            {
+                return false;
+            }
+
+            bits = (bits << 6) | static_cast<uint32_t>(value);
+            bitCount += 6;
+            if (bitCount >= 8)
+            {
+                bitCount -= 8;
+                data.push_back(static_cast<uint8_t>(bits >> bitCount));
+            }
+        }
+        return true;
+    }
+
+    std::string GetDirectory(const std::string& filePath)
+    {
+        const size_t separator = filePath.find_last_of("/\\");
+        return (separator == std::string::npos) ? std::string() : filePath.substr(0, separator + 1);
+    }
+
+    uint32_t ReadU32(const std::vector<uint8_t>& data, size_t offset)
+    {
+        uint32_t value;
+        memcpy(&value, data.data() + offset, sizeof(value));
+        return value;
+    }
+}  // namespace
+
+bool IvyGltfDocument::Load(const std::string& filePath, std::string* errorMessage)
+{
+    m_Json = IvyJson();
+    m_GlbBinaryChunk.clear();
+    m_Buffers.clear();
+
+    std::vector<uint8_t> fileData;
+    if (!ReadFile(filePath, fileData))
+    {
+        return Fail("cannot open " + filePath, errorMessage);
+    }
+
+    std::string jsonText;
+    if ((fileData.size() >= 12) && (ReadU32(fileData, 0) == GlbMagic))
+    {
+        if (!ParseGlb(fileData, jsonText, errorMessage))
+        {
+            return false;
+        }
+    }
+    else
+    {
+        jsonText.assign(fileData.begin(), fileData.end());
+    }
+
+    std::string jsonError;
+    if (!IvyJson::Parse(jsonText, m_Json, &jsonError))
+    {
+        return Fail(filePath + ": " + jsonError, errorMessage);
+    }
+
+    return LoadBuffers(GetDirectory(filePath), errorMessage);
+}
+
+int IvyGltfDocument::FindMesh(const std::string& name) const
+{
+    const IvyJson& meshes = m_Json["meshes"];
+    for (size_t i = 0; i < meshes.Size(); ++i)
+    {
+        if (meshes[i]["name"].AsString() == name)
+        {
+            return static_cast<int>(i);
+        }
+    }
+    return -1;
+}
+
+bool IvyGltfDocument::ReadMesh(size_t meshIndex, std::vector<IvyMeshData>& surfaces, std::string* errorMessage)
+{
+    const IvyJson& primitives = m_Json["meshes"][meshIndex]["primitives"];
+
+    surfaces.clear();
+    for (size_t i = 0; i < primitives.Size(); ++i)
+    {
+        const IvyJson& primitive = primitives[i];
+        if (static_cast<int>(primitive["mode"].AsNumber(PrimitiveModeTriangles)) != PrimitiveModeTriangles)
+        {
+            continue;
+        }
+
+        const IvyJson& attributes = primitive["attributes"];
+        if (!attributes.Contains("POSITION"))
+        {
+            continue;
+        }
+
+        IvyMeshData surface;
+        if (!ReadFloat3Accessor(static_cast<size_t>(attributes["POSITION"].AsNumber()), surface.Positions, errorMessage))
+        {
+            return false;
+        }
+        if (attributes.Contains("NORMAL") && !ReadFloat3Accessor(static_cast<size_t>(attributes["NORMAL"].AsNumber()), surface.Normals, errorMessage))
+        {
+            return false;
+        }
+
+        if (primitive.Contains("indices"))
+        {
+            if (!ReadIndexAccessor(static_cast<size_t>(primitive["indices"].AsNumber()), surface.Indices, errorMessage))
+            {
+                return false;
+            }
+        }
+        else
+        {
+            surface.Indices.resize(surface.Positions.size() / 3);
+            for (uint32_t index = 0; index < surface.Indices.size(); ++index)
+            {
+                surface.Indices[index] = index;
+            }
+        }
+
+        // drop incomplete triangles
+        surface.Indices.resize(surface.Indices.size() - surface.Indices.size() % 3);
+
+        const size_t vertexCount = surface.Positions.size() / 3;
+        for (const uint32_t index : surface.Indices)
+        {
+            if (index >= vertexCount)
+            {
+                return Fail("index out of range in mesh " + std::to_string(meshIndex), errorMessage);
+            }
+        }
+        if (!surface.Normals.empty() && (surface.Normals.size() != surface.Positions.size()))
+        {
+            return Fail("normal count does not match position count in mesh " + std::to_string(meshIndex), errorMessage);
+        }
+
+        surfaces.push_back(std::move(surface));
+    }
+    return true;
+}
+
+bool IvyGltfDocument::Fail(const std::string& message, std::string* errorMessage) const
+{
+    if (errorMessage)
+    {
+        *errorMessage = message;
+    }
+    return false;
+}
+
+bool IvyGltfDocument::ParseGlb(const std::vector<uint8_t>& fileData, std::string& jsonText, std::string* errorMessage)
+{
+    size_t offset = 12;
+    while (offset + 8 <= fileData.size())
+    {
+        const uint32_t chunkLength = ReadU32(fileData, offset);
+        const uint32_t chunkType   = ReadU32(fileData, offset + 4);
+        offset += 8;
+
+        if (offset + chunkLength > fileData.size())
+        {
+            return Fail("truncated glb chunk", errorMessage);
+        }
+
+        if (chunkType == GlbChunkJson)
+        {
+            jsonText.assign(fileData.begin() + offset, fileData.begin() + offset + chunkLength);
+        }
+        else if ((chunkType == GlbChunkBin) && m_GlbBinaryChunk.empty())
+        {
+            m_GlbBinaryChunk.assign(fileData.begin() + offset, fileData.begin() + offset + chunkLength);
+        }
+
+        offset += chunkLength;
+    }
+
+    return !jsonText.empty() || Fail("glb without JSON chunk", errorMessage);
+}
+
+bool IvyGltfDocument::LoadBuffers(const std::string& directory, std::string* errorMessage)
+{
+    const IvyJson& buffers = m_Json["buffers"];
+    m_Buffers.resize(buffers.Size());
+
+    for (size_t i = 0; i < buffers.Size(); ++i)
+    {
+        if (!buffers[i].Contains("uri"))
+        {
+            // buffer 0 without uri references the binary chunk of a .glb
+            m_Buffers[i] = m_GlbBinaryChunk;
+            continue;
+        }
+
+        const std::string& uri = buffers[i]["uri"].AsString();
+        if (uri.compare(0, 5, "data:") == 0)
+        {
+            const size_t dataStart = uri.find(";base64,");
+            if ((dataStart == std::string::npos) || !DecodeBase64(uri.substr(dataStart + 8), m_Buffers[i]))
+            {
+                return Fail("unsupported data uri in buffer " + std::to_string(i), errorMessage);
+            }
+        }
+        else if (!ReadFile(directory + uri, m_Buffers[i]))
+        {
+            return Fail("cannot open buffer " + directory + uri, errorMessage);
+        }
+    }
+
+    return true;
+}
+
+const uint8_t* IvyGltfDocument::GetAccessorData(const IvyJson& accessor, size_t elementSize, size_t& count, size_t& stride, std::string* errorMessage) const
+{
+    count = static_cast<size_t>(accessor["count"].AsNumber());
+
+    const IvyJson& bufferView = m_Json["bufferViews"][static_cast<size_t>(accessor["bufferView"].AsNumber(-1))];
+    if (bufferView.IsNull())
+    {
+        // sparse or zero initialized accessors are not supported
+        Fail("accessor without buffer view", errorMessage);
+        return nullptr;
+    }
+
+    const size_t bufferIndex = static_cast<size_t>(bufferView["buffer"].AsNumber());
+    const size_t offset      = static_cast<size_t>(bufferView["byteOffset"].AsNumber(0) + accessor["byteOffset"].AsNumber(0));
+    stride                   = static_cast<size_t>(bufferView["byteStride"].AsNumber(static_cast<double>(elementSize)));
+
+    if ((bufferIndex >= m_Buffers.size()) || ((count > 0) && (offset + (count - 1) * stride + elementSize > m_Buffers[bufferIndex].size())))
+    {
+        Fail("accessor out of buffer bounds", errorMessage);
+        return nullptr;
+    }
+
+    return m_Buffers[bufferIndex].data() + offset;
+}
+
+bool IvyGltfDocument::ReadFloat3Accessor(size_t accessorIndex, std::vector<float>& values, std::string* errorMessage) const
+{
+    const IvyJson& accessor = m_Json["accessors"][accessorIndex];
+    if ((static_cast<int>(accessor["componentType"].AsNumber()) != ComponentTypeFloat) || (accessor["type"].AsString() != "VEC3"))
+    {
+        return Fail("unsupported vertex format in accessor " + std::to_string(accessorIndex), errorMessage);
+    }
+
+    size_t               count  = 0;
+    size_t               stride = 0;
+    const uint8_t* const data   = GetAccessorData(accessor, 3 * sizeof(float), count, stride, errorMessage);
+    if (!data && (count > 0))
+    {
+        return false;
+    }
+
+    values.resize(count * 3);
+    for (size_t i = 0; i < count; ++i)
+    {
+        memcpy(&values[i * 3], data + i * stride, 3 * sizeof(float));
+    }
+    return true;
+}
+
+bool IvyGltfDocument::ReadIndexAccessor(size_t accessorIndex, std::vector<uint32_t>& indices, std::string* errorMessage) const
+{
+    const IvyJson& accessor      = m_Json["accessors"][accessorIndex];
+    const int      componentType = static_cast<int>(accessor["componentType"].AsNumber());
+
+    size_t elementSize = 0;
+    switch (componentType)
+    {
+    case ComponentTypeUnsignedByte:
+        elementSize = 1;
+        break;
+    case ComponentTypeUnsignedShort:
+        elementSize = 2;
+        break;
+    case ComponentTypeUnsignedInt:
+        elementSize = 4;
+        break;
+    default:
+        return Fail("unsupported index format in accessor " + std::to_string(accessorIndex), errorMessage);
+    }
+
+    size_t               count  = 0;
+    size_t               stride = 0;
+    const uint8_t* const data   = GetAccessorData(accessor, elementSize, count, stride, errorMessage);
+    if (!data && (count > 0))
+    {
+        return false;
+    }
+
+    indices.resize(count);
+    for (size_t i = 0; i < count; ++i)
+    {
+        const uint8_t* element = data + i * stride;
+        switch (elementSize)
+        {
+        case 1:
+            indices[i] = *element;
+            break;
+        case 2:
+        {
+            uint16_t index;
+            memcpy(&index, element, sizeof(index));
+            indices[i] = index;
+            break;
+        }
+        default:
+            memcpy(&indices[i], element, sizeof(uint32_t));
+            break;
+        }
+    }
+    return true;
+}
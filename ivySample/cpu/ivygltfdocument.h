@@ -0,0 +1,76 @@
+// This file is part of the AMD Work Graph Ivy Generation Sample.
+//
+// Copyright (c) 2024 Advanced Micro Devices, Inc. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+#pragma once
+
+#include "cpu/ivyjson.h"
+#include "cpu/ivymeshdata.h"
+
+#include <string>
+#include <vector>
+
+/**
+ * @brief   JSON, buffers & accessors of a glTF 2.0 file (.gltf with external or base64 embedded buffers, or .glb).
+ *
+ * Does not depend on the math types of the CPU engine, so the sample reads the ivy meshes with it as well
+ * (see IvyRenderModule::OnNewContentLoaded). Scene graphs are loaded by LoadGltfScene() in cpu/ivygltfloader.h.
+ */
+class IvyGltfDocument
+{
+public:
+    /**
+     * @brief   Reads & parses the file and loads all buffers. Returns false and sets errorMessage (if provided) on failure.
+     */
+    bool Load(const std::string& filePath, std::string* errorMessage = nullptr);
+
+    const IvyJson& GetJson() const
+    {
+        return m_Json;
+    }
+
+    /**
+     * @brief   Index of the first mesh with the given name, -1 if there is none.
+     */
+    int FindMesh(const std::string& name) const;
+
+    /**
+     * @brief   Reads the triangle primitives of a mesh as one surface each. Only positions, normals and indices are read,
+     *          incomplete triangles are dropped. Returns false and sets errorMessage (if provided) on invalid data.
+     */
+    bool ReadMesh(size_t meshIndex, std::vector<IvyMeshData>& surfaces, std::string* errorMessage = nullptr);
+
+private:
+    bool Fail(const std::string& message, std::string* errorMessage) const;
+
+    bool ParseGlb(const std::vector<uint8_t>& fileData, std::string& jsonText, std::string* errorMessage);
+    bool LoadBuffers(const std::string& directory, std::string* errorMessage);
+
+    // Returns a pointer to the first element of the accessor and the stride between elements
+    const uint8_t* GetAccessorData(const IvyJson& accessor, size_t elementSize, size_t& count, size_t& stride, std::string* errorMessage) const;
+
+    bool ReadFloat3Accessor(size_t accessorIndex, std::vector<float>& values, std::string* errorMessage) const;
+    bool ReadIndexAccessor(size_t accessorIndex, std::vector<uint32_t>& indices, std::string* errorMessage) const;
+
+    IvyJson                           m_Json;
+    std::vector<uint8_t>              m_GlbBinaryChunk;
+    std::vector<std::vector<uint8_t>> m_Buffers;
+};
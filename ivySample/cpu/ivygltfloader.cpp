@@ -0,0 +1,177 @@
+// This file is part of the AMD Work Graph Ivy Generation Sample.
+//
+// Copyright (c) 2024 Advanced Micro Devices, Inc. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+#include "cpu/ivygltfloader.h"
+
+#include "cpu/ivygltfdocument.h"
+
+#include <map>
+
+namespace
+{
+    class GltfLoader
+    {
+    public:
+        GltfLoader(IvyCpuScene& scene, std::string& error)
+            : m_Scene(scene)
+            , m_Error(error)
+        {
+        }
+
+        bool Load(const std::string& filePath, const Mat4& rootTransform)
+        {
+            if (!m_Document.Load(filePath, &m_Error))
+            {
+                return false;
+            }
+
+            const IvyJson& scenes     = m_Document.GetJson()["scenes"];
+            const size_t   sceneIndex = static_cast<size_t>(m_Document.GetJson()["scene"].AsNumber(0));
+            const IvyJson& rootNodes  = scenes[sceneIndex]["nodes"];
+
+            for (size_t i = 0; i < rootNodes.Size(); ++i)
+            {
+                if (!LoadNode(static_cast<size_t>(rootNodes[i].AsNumber()), rootTransform, 0))
+                {
+                    return false;
+                }
+            }
+
+            return true;
+        }
+
+    private:
+        bool Fail(const std::string& message)
+        {
+            m_Error = message;
+            return false;
+        }
+
+        static Mat4 GetNodeTransform(const IvyJson& node)
+        {
+            const IvyJson& matrix = node["matrix"];
+            if (matrix.Size() == 16)
+            {
+                // glTF matrices are column-major, as Mat4
+                Mat4 result;
+                for (int column = 0; column < 4; ++column)
+                {
+                    for (int row = 0; row < 4; ++row)
+                    {
+                        result.setElem(column, row, static_cast<float>(matrix[column * 4 + row].AsNumber()));
+                    }
+                }
+                return result;
+            }
+
+            const IvyJson& t = node["translation"];
+            const IvyJson& r = node["rotation"];
+            const IvyJson& s = node["scale"];
+
+            const Vec3 translation(static_cast<float>(t[0].AsNumber(0)), static_cast<float>(t[1].AsNumber(0)), static_cast<float>(t[2].AsNumber(0)));
+            const Vec3 scale(static_cast<float>(s[0].AsNumber(1)), static_cast<float>(s[1].AsNumber(1)), static_cast<float>(s[2].AsNumber(1)));
+
+            // unit quaternion (x, y, z, w) to rotation matrix
+            const float x = static_cast<float>(r[0].AsNumber(0));
+            const float y = static_cast<float>(r[1].AsNumber(0));
+            const float z = static_cast<float>(r[2].AsNumber(0));
+            const float w = static_cast<float>(r[3].AsNumber(1));
+
+            const Mat4 rotation(Vec4(1 - 2 * (y * y + z * z), 2 * (x * y + z * w), 2 * (x * z - y * w), 0),
+                                Vec4(2 * (x * y - z * w), 1 - 2 * (x * x + z * z), 2 * (y * z + x * w), 0),
+                                Vec4(2 * (x * z + y * w), 2 * (y * z - x * w), 1 - 2 * (x * x + y * y), 0),
+                                Vec4(0, 0, 0, 1));
+
+            return Mat4::translation(translation) * rotation * Mat4::scale(scale);
+        }
+
+        bool LoadNode(size_t nodeIndex, const Mat4& parentTransform, int depth)
+        {
+            const IvyJson& node = m_Document.GetJson()["nodes"][nodeIndex];
+            if (node.IsNull() || (depth > 256))
+            {
+                return Fail("invalid node hierarchy at node " + std::to_string(nodeIndex));
+            }
+
+            const Mat4 transform = parentTransform * GetNodeTransform(node);
+
+            if (node.Contains("mesh"))
+            {
+                uint32_t meshIndex = 0;
+                if (!GetMesh(static_cast<size_t>(node["mesh"].AsNumber()), meshIndex))
+                {
+                    return false;
+                }
+                m_Scene.AddInstance(meshIndex, transform);
+            }
+
+            const IvyJson& children = node["children"];
+            for (size_t i = 0; i < children.Size(); ++i)
+            {
+                if (!LoadNode(static_cast<size_t>(children[i].AsNumber()), transform, depth + 1))
+                {
+                    return false;
+                }
+            }
+
+            return true;
+        }
+
+        bool GetMesh(size_t gltfMeshIndex, uint32_t& meshIndex)
+        {
+            const auto it = m_MeshIndices.find(gltfMeshIndex);
+            if (it != m_MeshIndices.end())
+            {
+                meshIndex = it->second;
+                return true;
+            }
+
+            std::vector<IvyCpuScene::SurfaceData> surfaces;
+            if (!m_Document.ReadMesh(gltfMeshIndex, surfaces, &m_Error))
+            {
+                return false;
+            }
+
+            meshIndex                    = m_Scene.AddMesh(m_Document.GetJson()["meshes"][gltfMeshIndex]["name"].AsString(), surfaces);
+            m_MeshIndices[gltfMeshIndex] = meshIndex;
+            return true;
+        }
+
+        IvyCpuScene&               m_Scene;
+        std::string&               m_Error;
+        IvyGltfDocument            m_Document;
+        std::map<size_t, uint32_t> m_MeshIndices;
+    };
+}  // namespace
+
+bool LoadGltfScene(const std::string& filePath, IvyCpuScene& scene, const Mat4& rootTransform, std::string* errorMessage)
+{
+    std::string error;
+    GltfLoader  loader(scene, error);
+
+    const bool result = loader.Load(filePath, rootTransform);
+    if (!result && errorMessage)
+    {
+        *errorMessage = error;
+    }
+    return result;
+}
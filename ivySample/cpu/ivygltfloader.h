@@ -0,0 +1,38 @@
+// This file is part of the AMD Work Graph Ivy Generation Sample.
+//
+// Copyright (c) 2024 Advanced Micro Devices, Inc. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+#pragma once
+
+#include "cpu/ivycpuscene.h"
+
+#include <string>
+
+/**
+ * @brief   Loads the triangle meshes of a glTF 2.0 file (.gltf with external or base64 embedded buffers, or .glb) into scene.
+ *
+ * Every glTF mesh that is referenced by a node of the default scene is added once with IvyCpuScene::AddMesh(),
+ * each glTF primitive becomes one surface. Every node referencing a mesh adds a TLAS instance with the world transform
+ * of the node (matrix or TRS, including the node hierarchy) premultiplied with rootTransform.
+ * Only positions, normals and indices are read; materials, skins and animations are ignored.
+ * Build() is not called, so multiple files can be loaded into the same scene.
+ */
+bool LoadGltfScene(const std::string& filePath, IvyCpuScene& scene, const Mat4& rootTransform = Mat4::identity(), std::string* errorMessage = nullptr);
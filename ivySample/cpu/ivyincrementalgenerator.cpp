@@ -0,0 +1,146 @@
+// This file is part of the AMD Work Graph Ivy Generation Sample.
+//
+// Copyright (c) 2024 Advanced Micro Devices, Inc. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+#include "cpu/ivyincrementalgenerator.h"
+
+#include <algorithm>
+#include <chrono>
+
+uint32_t IvyIncrementalGenerator::RegenerateDirtyPartitions(const std::vector<IvyBranchRecord>& branchRecords,
+                                                            const std::vector<IvyAreaRecord>&   areaRecords,
+                                                            uint64_t                            sharedKey)
+{
+    const uint32_t partitionCount = static_cast<uint32_t>(branchRecords.size() + areaRecords.size());
+
+    m_Cache.BeginFrame(partitionCount, sharedKey);
+    m_Partitions.resize(partitionCount);
+    m_DirtyPartitions.clear();
+
+    // single record dispatches, all outputs of a dispatch belong to its entry record
+    std::vector<IvyBranchRecord> partitionBranchRecords;
+    std::vector<IvyAreaRecord>   partitionAreaRecords;
+    for (uint32_t partition = 0; partition < partitionCount; ++partition)
+    {
+        IvyGenerationKey partitionKey;
+        partitionBranchRecords.clear();
+        partitionAreaRecords.clear();
+        if (partition < branchRecords.size())
+        {
+            partitionKey.Add(branchRecords[partition]);
+            partitionBranchRecords.push_back(branchRecords[partition]);
+        }
+        else
+        {
+            partitionKey.Add(areaRecords[partition - branchRecords.size()]);
+            partitionAreaRecords.push_back(areaRecords[partition - branchRecords.size()]);
+        }
+
+        if (!m_Cache.Update(partition, partitionKey.Get()))
+        {
+            continue;
+        }
+
+        m_Engine.DispatchGraph(partitionBranchRecords, partitionAreaRecords, m_Partitions[partition]);
+
+        m_DirtyPartitions.push_back(partition);
+        m_Statistics.RayCount += m_Engine.GetStatistics().RayCount;
+    }
+
+    return static_cast<uint32_t>(m_DirtyPartitions.size());
+}
+
+bool IvyIncrementalGenerator::Update(const std::vector<IvyBranchRecord>& branchRecords,
+                                     const std::vector<IvyAreaRecord>&   areaRecords,
+                                     uint64_t                            sharedKey,
+                                     IvyInstanceStreams&                 output)
+{
+    m_Statistics = {};
+
+    const uint32_t partitionCount = static_cast<uint32_t>(branchRecords.size() + areaRecords.size());
+
+    IvyGenerationKey key;
+    key.Add(sharedKey);
+    key.Add(m_Engine.GetGenerationSettings());
+
+    const auto generationStartTime = std::chrono::steady_clock::now();
+
+    m_Statistics.RegeneratedPartitions = RegenerateDirtyPartitions(branchRecords, areaRecords, key.Get());
+    if (m_Statistics.RegeneratedPartitions == 0)
+    {
+        m_Statistics.GenerationSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - generationStartTime).count();
+        return false;
+    }
+
+    // the partition counters of the GPU, a new layout moves all partitions
+    m_Arena.SetPartitionCount(partitionCount);
+    for (;;)
+    {
+        std::vector<IvyInstanceArenaStatus> status(partitionCount);
+        for (uint32_t partition = 0; partition < partitionCount; ++partition)
+        {
+            status[partition].instanceCount[0] = static_cast<uint32_t>(m_Partitions[partition].LeafInstances.size());
+            status[partition].instanceCount[1] = static_cast<uint32_t>(m_Partitions[partition].StemInstances.size());
+        }
+
+        const uint32_t growCount = m_Arena.GetGrowCount();
+        if (!m_Arena.Update(status.data(), partitionCount, m_Arena.GetLayoutVersion()))
+        {
+            break;
+        }
+
+        m_Cache.Invalidate();
+        m_Statistics.PartitionLayouts += 1;
+        m_Statistics.ArenaGrowths += m_Arena.GetGrowCount() - growCount;
+        m_Statistics.RegeneratedPartitions += RegenerateDirtyPartitions(branchRecords, areaRecords, key.Get());
+    }
+
+    const auto compactionStartTime = std::chrono::steady_clock::now();
+    m_Statistics.GenerationSeconds = std::chrono::duration<double>(compactionStartTime - generationStartTime).count();
+
+    // instances beyond the partition capacity are dropped, like in the instance buffers
+    output.LeafInstances.clear();
+    output.StemInstances.clear();
+    output.LeafKeys.clear();
+    output.StemKeys.clear();
+    for (uint32_t partitionIndex = 0; partitionIndex < partitionCount; ++partitionIndex)
+    {
+        const IvyInstanceStreams& partition = m_Partitions[partitionIndex];
+        const size_t              leafCount = std::min<size_t>(partition.LeafInstances.size(), m_Arena.GetPartitionCapacity(0, partitionIndex));
+        const size_t              stemCount = std::min<size_t>(partition.StemInstances.size(), m_Arena.GetPartitionCapacity(1, partitionIndex));
+        output.LeafInstances.insert(output.LeafInstances.end(), partition.LeafInstances.begin(), partition.LeafInstances.begin() + leafCount);
+        output.StemInstances.insert(output.StemInstances.end(), partition.StemInstances.begin(), partition.StemInstances.begin() + stemCount);
+        output.LeafKeys.insert(output.LeafKeys.end(), partition.LeafKeys.begin(), partition.LeafKeys.begin() + leafCount);
+        output.StemKeys.insert(output.StemKeys.end(), partition.StemKeys.begin(), partition.StemKeys.begin() + stemCount);
+    }
+    // the index counts do not depend on the records
+    if (!m_Partitions.empty())
+    {
+        output.Arguments[0] = m_Partitions[0].Arguments[0];
+        output.Arguments[1] = m_Partitions[0].Arguments[1];
+    }
+    output.Arguments[0].InstanceCount = static_cast<uint32_t>(output.LeafInstances.size());
+    output.Arguments[1].InstanceCount = static_cast<uint32_t>(output.StemInstances.size());
+
+    m_Statistics.CompactionSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - compactionStartTime).count();
+
+    return true;
+}
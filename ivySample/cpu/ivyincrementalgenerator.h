@@ -0,0 +1,124 @@
+// This file is part of the AMD Work Graph Ivy Generation Sample.
+//
+// Copyright (c) 2024 Advanced Micro Devices, Inc. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+#pragma once
+
+#include "cpu/ivycpuengine.h"
+#include "cpu/ivygenerationcache.h"
+#include "cpu/ivyinstancearena.h"
+
+#include <vector>
+
+/**
+ * @brief   Regenerates only the entry records whose inputs changed, like the instance partitions of IvyRenderModule.
+ *
+ * Every IvyBranchRecord & IvyAreaRecord owns a partition of the instances (branch records first, then area records).
+ * The GPU dispatches all dirty entry records at once, each record carries its partition to the instances spawned from it.
+ * Update() dispatches the graph separately for each dirty entry record instead, with the same instances per partition,
+ * and then compacts all partitions into one stream, like the compaction pass on the GPU.
+ * The compacted instances are the same as the ones of a single IvyCpuEngine::DispatchGraph for all records,
+ * but in partition order.
+ *
+ * Like the GPU instance buffers, the partitions only hold IvyInstanceArena::GetPartitionCapacity() instances per stream.
+ * If a partition overflows, the arena lays out the partitions from their counts, grows if they do not fit, and all
+ * partitions are regenerated in the same Update(). Unlike on the GPU, the overflow is known right after the dispatch,
+ * so the output never misses instances below IVY_MAX_INSTANCES.
+ */
+class IvyIncrementalGenerator
+{
+public:
+    struct Statistics
+    {
+        uint32_t RegeneratedPartitions = 0;    // including the regenerations after a new layout
+        uint32_t PartitionLayouts      = 0;    // new layouts after an overflow, with or without growth
+        uint32_t ArenaGrowths          = 0;
+        uint64_t RayCount              = 0;    // of the regenerated partitions
+        double   GenerationSeconds     = 0.0;  // graph dispatches of the dirty partitions
+        double   CompactionSeconds     = 0.0;
+    };
+
+    explicit IvyIncrementalGenerator(IvyCpuEngine& engine, uint32_t initialCapacity = ivyDefaultInstanceArenaCapacity)
+        : m_Engine(engine)
+        , m_Arena(initialCapacity)
+    {
+    }
+
+    /**
+     * @brief   Regenerates the dirty partitions and writes all instances to output. sharedKey covers inputs of all
+     *          partitions (see IvyPartitionedGenerationCache::BeginFrame), the engine settings are added to it.
+     *          Returns false if nothing changed, output is then left untouched.
+     */
+    bool Update(const std::vector<IvyBranchRecord>& branchRecords,
+                const std::vector<IvyAreaRecord>&   areaRecords,
+                uint64_t                            sharedKey,
+                IvyInstanceStreams&                 output);
+
+    /**
+     * @brief   Regenerates all partitions in the next Update().
+     */
+    void Invalidate()
+    {
+        m_Cache.Invalidate();
+    }
+
+    const Statistics& GetStatistics() const
+    {
+        return m_Statistics;
+    }
+
+    uint32_t GetPartitionCount() const
+    {
+        return static_cast<uint32_t>(m_Partitions.size());
+    }
+
+    /**
+     * @brief   All generated instances of a partition, including the ones beyond the partition capacity.
+     */
+    const IvyInstanceStreams& GetPartition(uint32_t partition) const
+    {
+        return m_Partitions[partition];
+    }
+
+    /**
+     * @brief   The partitions regenerated by the last Update(), i.e. the entry record slots the GPU dispatches.
+     */
+    const std::vector<uint32_t>& GetDirtyPartitions() const
+    {
+        return m_DirtyPartitions;
+    }
+
+    const IvyInstanceArena& GetArena() const
+    {
+        return m_Arena;
+    }
+
+private:
+    // Regenerates the partitions with changed keys into m_DirtyPartitions, returns their count
+    uint32_t RegenerateDirtyPartitions(const std::vector<IvyBranchRecord>& branchRecords, const std::vector<IvyAreaRecord>& areaRecords, uint64_t sharedKey);
+
+    IvyCpuEngine&                   m_Engine;
+    IvyPartitionedGenerationCache   m_Cache;
+    IvyInstanceArena                m_Arena;
+    std::vector<IvyInstanceStreams> m_Partitions;
+    std::vector<uint32_t>           m_DirtyPartitions;
+    Statistics                      m_Statistics;
+};
@@ -0,0 +1,263 @@
+// This file is part of the AMD Work Graph Ivy Generation Sample.
+//
+// Copyright (c) 2024 Advanced Micro Devices, Inc. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#pragma once
+
+// Cauldron-free, used by IvyRenderModule as well as the headless benchmarks.
+
+#include "shaders/ivycommon.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+// Initial instances per stream, enough for the default entry records without allocating IVY_MAX_INSTANCES
+static const uint32_t ivyDefaultInstanceArenaCapacity = 65536;
+
+/**
+ * @brief   Capacity of the leaf & stem instance buffers & their layout into partitions, see IvyInstancePartitions.
+ *
+ * Every partition has an offset & a capacity per stream. IvyBranch reserves ranges of its partition with InterlockedAdd
+ * and only writes the part of a range that fits into the partition, so an overflow never writes out of bounds.
+ * The counters still include the dropped instances and are read back as IvyInstanceArenaStatus. Update() then sizes
+ * every partition from its own counter and spreads the remaining capacity evenly over all partitions as headroom.
+ * The capacity only grows if the counters of all partitions do not fit, at least doubling it, up to IVY_MAX_INSTANCES.
+ * All partitions have to be regenerated into the new layout.
+ */
+class IvyInstanceArena
+{
+public:
+    explicit IvyInstanceArena(uint32_t initialCapacity = ivyDefaultInstanceArenaCapacity, uint32_t maxCapacity = IVY_MAX_INSTANCES)
+        : m_MaxCapacity(maxCapacity)
+        , m_Capacity(std::min(std::max(initialCapacity, 1u), maxCapacity))
+    {
+    }
+
+    /**
+     * @brief   Instances per stream of the instance buffers.
+     */
+    uint32_t GetCapacity() const
+    {
+        return m_Capacity;
+    }
+
+    uint32_t GetMaxCapacity() const
+    {
+        return m_MaxCapacity;
+    }
+
+    /**
+     * @brief   Splits the capacity evenly into partitionCount partitions if the count changed.
+     *          A changed count regenerates all partitions anyway, see IvyPartitionedGenerationCache::BeginFrame().
+     */
+    void SetPartitionCount(uint32_t partitionCount)
+    {
+        if (partitionCount != m_PartitionCount)
+        {
+            m_PartitionCount = partitionCount;
+            m_PartitionOffsets[0].resize(partitionCount);
+            m_PartitionOffsets[1].resize(partitionCount);
+            m_PartitionCapacities[0].resize(partitionCount);
+            m_PartitionCapacities[1].resize(partitionCount);
+            LayoutPartitions(nullptr);
+        }
+    }
+
+    uint32_t GetPartitionCount() const
+    {
+        return m_PartitionCount;
+    }
+
+    /**
+     * @brief   First instance of a partition in the buffers of stream (0 = leaf, 1 = stem).
+     */
+    uint32_t GetPartitionOffset(uint32_t stream, uint32_t partition) const
+    {
+        return m_PartitionOffsets[stream][partition];
+    }
+
+    /**
+     * @brief   Instances of stream (0 = leaf, 1 = stem) the partition can hold.
+     */
+    uint32_t GetPartitionCapacity(uint32_t stream, uint32_t partition) const
+    {
+        return m_PartitionCapacities[stream][partition];
+    }
+
+    /**
+     * @brief   Largest partition of both streams, e.g. for the dispatch size of the compaction.
+     */
+    uint32_t GetMaxPartitionCapacity() const
+    {
+        uint32_t maxPartitionCapacity = 0;
+        for (uint32_t partition = 0; partition < m_PartitionCount; ++partition)
+        {
+            maxPartitionCapacity = std::max({maxPartitionCapacity, m_PartitionCapacities[0][partition], m_PartitionCapacities[1][partition]});
+        }
+        return maxPartitionCapacity;
+    }
+
+    /**
+     * @brief   Changes with every new partition layout, identifies the layout a status was generated with.
+     */
+    uint32_t GetLayoutVersion() const
+    {
+        return m_LayoutVersion;
+    }
+
+    /**
+     * @brief   Ensures that at least instanceCount instances per stream fit, e.g. for baked instances.
+     */
+    void Reserve(uint32_t instanceCount)
+    {
+        const uint32_t capacity = std::max(m_Capacity, std::min(RoundUpToPowerOfTwo(instanceCount), m_MaxCapacity));
+        if (capacity != m_Capacity)
+        {
+            m_Capacity = capacity;
+            LayoutPartitions(nullptr);
+        }
+    }
+
+    /**
+     * @brief   Checks the counters of the partitions (status[partitionCount]) of a generation with statusLayoutVersion.
+     *          Returns true if the layout changed, the caller then has to regenerate all partitions and reallocate
+     *          the buffers if the capacity grew. Statuses of previous layouts are ignored.
+     */
+    bool Update(const IvyInstanceArenaStatus* status, uint32_t partitionCount, uint32_t statusLayoutVersion)
+    {
+        if ((statusLayoutVersion != m_LayoutVersion) || (partitionCount != m_PartitionCount) || (partitionCount == 0))
+        {
+            return false;
+        }
+
+        // Only the stream with more instances decides about the capacity
+        uint64_t requiredCapacity = 0;
+        m_DroppedInstances        = 0;
+        for (uint32_t stream = 0; stream < 2; ++stream)
+        {
+            uint64_t streamInstanceCount = 0;
+            for (uint32_t partition = 0; partition < partitionCount; ++partition)
+            {
+                const uint32_t count = status[partition].instanceCount[stream];
+                streamInstanceCount += count;
+                m_DroppedInstances += count - std::min(count, m_PartitionCapacities[stream][partition]);
+            }
+            requiredCapacity = std::max(requiredCapacity, streamInstanceCount);
+        }
+
+        if (m_DroppedInstances == 0)
+        {
+            return false;
+        }
+
+        // A saturated layout would only drop the same instances again
+        if (requiredCapacity > m_MaxCapacity)
+        {
+            if (m_Saturated)
+            {
+                return false;
+            }
+            m_Saturated = true;
+        }
+
+        if (requiredCapacity > m_Capacity)
+        {
+            const uint64_t grownCapacity = std::max<uint64_t>(2ull * m_Capacity, RoundUpToPowerOfTwo(static_cast<uint32_t>(std::min<uint64_t>(requiredCapacity, m_MaxCapacity))));
+
+            m_Capacity = static_cast<uint32_t>(std::min<uint64_t>(grownCapacity, m_MaxCapacity));
+            ++m_GrowCount;
+        }
+
+        LayoutPartitions(status);
+        return true;
+    }
+
+    /**
+     * @brief   Capacity growths, layouts that only moved the partitions within the capacity are not counted.
+     */
+    uint32_t GetGrowCount() const
+    {
+        return m_GrowCount;
+    }
+
+    /**
+     * @brief   Instances dropped by the last checked generation.
+     */
+    uint32_t GetDroppedInstances() const
+    {
+        return m_DroppedInstances;
+    }
+
+    /**
+     * @brief   True if instances were dropped at IVY_MAX_INSTANCES, growing cannot help anymore.
+     */
+    bool IsSaturated() const
+    {
+        return m_Saturated;
+    }
+
+    static uint32_t RoundUpToPowerOfTwo(uint32_t value)
+    {
+        uint32_t powerOfTwo = 1;
+        while ((powerOfTwo < value) && (powerOfTwo < 0x80000000u))
+        {
+            powerOfTwo *= 2;
+        }
+        return powerOfTwo;
+    }
+
+private:
+    // Packs the partitions of each stream in order, every partition holds its counter from status (none without status)
+    // and an even share of the remaining capacity. Partitions beyond the capacity are truncated.
+    void LayoutPartitions(const IvyInstanceArenaStatus* status)
+    {
+        for (uint32_t stream = 0; (stream < 2) && (m_PartitionCount > 0); ++stream)
+        {
+            uint64_t instanceCount = 0;
+            for (uint32_t partition = 0; (partition < m_PartitionCount) && status; ++partition)
+            {
+                instanceCount += status[partition].instanceCount[stream];
+            }
+            const uint32_t headroom = static_cast<uint32_t>((m_Capacity - std::min<uint64_t>(instanceCount, m_Capacity)) / m_PartitionCount);
+
+            uint32_t offset = 0;
+            for (uint32_t partition = 0; partition < m_PartitionCount; ++partition)
+            {
+                const uint64_t capacity = (status ? status[partition].instanceCount[stream] : 0ull) + headroom;
+
+                m_PartitionOffsets[stream][partition]    = offset;
+                m_PartitionCapacities[stream][partition] = static_cast<uint32_t>(std::min<uint64_t>(capacity, m_Capacity - offset));
+                offset += m_PartitionCapacities[stream][partition];
+            }
+        }
+        ++m_LayoutVersion;
+    }
+
+    uint32_t              m_MaxCapacity;
+    uint32_t              m_Capacity;
+    uint32_t              m_PartitionCount = 0;
+    std::vector<uint32_t> m_PartitionOffsets[2];     // leaf & stem
+    std::vector<uint32_t> m_PartitionCapacities[2];  // leaf & stem
+    uint32_t              m_LayoutVersion    = 0;
+    uint32_t              m_GrowCount        = 0;
+    uint32_t              m_DroppedInstances = 0;
+    bool                  m_Saturated        = false;
+};
@@ -0,0 +1,525 @@
+// This file is part of the AMD Work Graph Ivy Generation Sample.
+//
+// Copyright (c) 2024 Advanced Micro Devices, Inc. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+#include "cpu/ivyinstancechunks.h"
+
+#include "cpu/affinemath.h"
+#include "cpu/ivybvh.h"
+#include "cpu/ivygenerationcache.h"
+#include "cpu/ivyinstanceencoding.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <utility>
+
+static const char ivyChunkedInstanceMagic[4] = {'I', 'V', 'Y', 'C'};
+
+static bool SetError(std::string* errorMessage, const std::string& error)
+{
+    if (errorMessage)
+    {
+        *errorMessage = error;
+    }
+    return false;
+}
+
+static size_t GetDirectoryOffset()
+{
+    return sizeof(IvyChunkedInstanceHeader);
+}
+
+static size_t GetRecordsOffset(const IvyChunkedInstanceHeader& header)
+{
+    return GetDirectoryOffset() + static_cast<size_t>(header.ChunkCount) * sizeof(IvyInstanceChunk);
+}
+
+static size_t GetPayloadsOffset(const IvyChunkedInstanceHeader& header)
+{
+    return GetRecordsOffset(header) + (static_cast<size_t>(header.BranchRecordCount) + header.AreaRecordCount) * sizeof(IvyBakedEntryRecord);
+}
+
+static uint64_t AlignChunkOffset(uint64_t offset)
+{
+    return (offset + ivyInstanceChunkAlignment - 1) / ivyInstanceChunkAlignment * ivyInstanceChunkAlignment;
+}
+
+// Spreads the low 10 bits of value to every third bit
+static uint32_t ExpandMortonBits(uint32_t value)
+{
+    value = (value | (value << 16)) & 0x030000ffu;
+    value = (value | (value << 8)) & 0x0300f00fu;
+    value = (value | (value << 4)) & 0x030c30c3u;
+    value = (value | (value << 2)) & 0x09249249u;
+    return value;
+}
+
+static uint32_t GetMortonCode(const float3& position, const IvyAabb& bounds)
+{
+    uint32_t code = 0;
+    for (int axis = 0; axis < 3; ++axis)
+    {
+        const float extent = bounds.Max[axis] - bounds.Min[axis];
+        const float unorm  = (extent > 0.f) ? (position[axis] - bounds.Min[axis]) / extent : 0.f;
+        code |= ExpandMortonBits(std::min(static_cast<uint32_t>(std::max(unorm, 0.f) * 1023.f + 0.5f), 1023u)) << axis;
+    }
+    return code;
+}
+
+static void EncodeInstance(const float3x4& transform, uint32_t encoding, uint8_t* destination)
+{
+    switch (encoding)
+    {
+    case IVY_INSTANCE_ENCODING_FLOAT4X4:
+    {
+        const IvyInstanceData instance = {Affine::ToMat4(transform)};
+        std::memcpy(destination, &instance, sizeof(instance));
+        break;
+    }
+    case IVY_INSTANCE_ENCODING_FLOAT3X4:
+    {
+        const IvyInstanceData3x4 instance = IvyEncodeInstance3x4(transform);
+        std::memcpy(destination, &instance, sizeof(instance));
+        break;
+    }
+    default:
+    {
+        const IvyInstanceDataQuantized instance = IvyEncodeInstanceQuantized(transform);
+        std::memcpy(destination, &instance, sizeof(instance));
+        break;
+    }
+    }
+}
+
+static IvyInstanceData DecodeInstance(const uint8_t* source, uint32_t encoding)
+{
+    switch (encoding)
+    {
+    case IVY_INSTANCE_ENCODING_FLOAT4X4:
+    {
+        IvyInstanceData instance;
+        std::memcpy(&instance, source, sizeof(instance));
+        return instance;
+    }
+    case IVY_INSTANCE_ENCODING_FLOAT3X4:
+    {
+        IvyInstanceData3x4 instance;
+        std::memcpy(&instance, source, sizeof(instance));
+        return IvyInstanceData{Affine::ToMat4(IvyDecodeInstance3x4(instance))};
+    }
+    default:
+    {
+        IvyInstanceDataQuantized instance;
+        std::memcpy(&instance, source, sizeof(instance));
+        return IvyInstanceData{Affine::ToMat4(IvyDecodeInstanceQuantized(instance))};
+    }
+    }
+}
+
+bool IvyChunkedInstanceFile::Open(const std::string& path, std::string* errorMessage)
+{
+    if (!m_File.Open(path, errorMessage))
+    {
+        return false;
+    }
+
+    if (!Validate(errorMessage))
+    {
+        m_File.Close();
+        return false;
+    }
+    return true;
+}
+
+void IvyChunkedInstanceFile::Close()
+{
+    m_File.Close();
+}
+
+const IvyInstanceChunk* IvyChunkedInstanceFile::GetChunks() const
+{
+    return reinterpret_cast<const IvyInstanceChunk*>(m_File.GetData() + GetDirectoryOffset());
+}
+
+const IvyBakedEntryRecord* IvyChunkedInstanceFile::GetBranchRecords() const
+{
+    return reinterpret_cast<const IvyBakedEntryRecord*>(m_File.GetData() + GetRecordsOffset(GetHeader()));
+}
+
+const IvyBakedEntryRecord* IvyChunkedInstanceFile::GetAreaRecords() const
+{
+    return GetBranchRecords() + GetHeader().BranchRecordCount;
+}
+
+const uint8_t* IvyChunkedInstanceFile::GetChunkPayload(uint32_t chunkIndex) const
+{
+    return m_File.GetData() + GetChunks()[chunkIndex].Offset;
+}
+
+bool IvyChunkedInstanceFile::LoadChunk(uint32_t chunkIndex, std::vector<IvyInstanceData>& instances, std::string* errorMessage) const
+{
+    const IvyInstanceChunk& chunk       = GetChunks()[chunkIndex];
+    const uint8_t*          payload     = GetChunkPayload(chunkIndex);
+    const size_t            payloadSize = static_cast<size_t>(chunk.InstanceCount) * chunk.InstanceSize;
+
+    IvyGenerationKey checksum;
+    checksum.AddBytes(payload, payloadSize);
+    if (checksum.Get() != chunk.Checksum)
+    {
+        return SetError(errorMessage, "checksum mismatch in chunk " + std::to_string(chunkIndex));
+    }
+
+    instances.reserve(instances.size() + chunk.InstanceCount);
+    for (uint32_t i = 0; i < chunk.InstanceCount; ++i)
+    {
+        instances.push_back(DecodeInstance(payload + static_cast<size_t>(i) * chunk.InstanceSize, chunk.Encoding));
+    }
+    return true;
+}
+
+void IvyChunkedInstanceFile::SelectChunks(const float3& position, float radius, std::vector<uint32_t>& chunkIndices) const
+{
+    std::vector<std::pair<float, uint32_t>> selectedChunks;
+
+    const IvyInstanceChunk* chunks = GetChunks();
+    for (uint32_t i = 0; i < GetHeader().ChunkCount; ++i)
+    {
+        // squared distance to the closest point of the bounds
+        float distanceSquared = 0.f;
+        for (int axis = 0; axis < 3; ++axis)
+        {
+            const float offset = std::max(std::max(chunks[i].BoundsMin[axis] - position[axis], position[axis] - chunks[i].BoundsMax[axis]), 0.f);
+            distanceSquared += offset * offset;
+        }
+        if (distanceSquared <= radius * radius)
+        {
+            selectedChunks.emplace_back(distanceSquared, i);
+        }
+    }
+
+    std::sort(selectedChunks.begin(), selectedChunks.end());
+    for (const auto& selectedChunk : selectedChunks)
+    {
+        chunkIndices.push_back(selectedChunk.second);
+    }
+}
+
+bool IvyChunkedInstanceFile::Validate(std::string* errorMessage) const
+{
+    const uint8_t* data = m_File.GetData();
+    const size_t   size = m_File.GetSize();
+
+    if (size < sizeof(IvyChunkedInstanceHeader))
+    {
+        return SetError(errorMessage, "file is smaller than the header");
+    }
+
+    const IvyChunkedInstanceHeader& header = GetHeader();
+    if (std::memcmp(header.Magic, ivyChunkedInstanceMagic, sizeof(header.Magic)) != 0)
+    {
+        return SetError(errorMessage, "not a chunked instance file");
+    }
+    if (header.Version != ivyInstanceChunkVersion)
+    {
+        return SetError(errorMessage, "version " + std::to_string(header.Version) + " is not supported, expected " + std::to_string(ivyInstanceChunkVersion));
+    }
+    if (header.ChunkCapacity == 0)
+    {
+        return SetError(errorMessage, "chunk capacity is zero");
+    }
+    if (GetPayloadsOffset(header) > size)
+    {
+        return SetError(errorMessage, "chunk directory exceeds the file size");
+    }
+
+    IvyGenerationKey checksum;
+    checksum.AddBytes(data + GetDirectoryOffset(), GetPayloadsOffset(header) - GetDirectoryOffset());
+    if (checksum.Get() != header.DirectoryChecksum)
+    {
+        return SetError(errorMessage, "directory checksum mismatch");
+    }
+
+    uint64_t instanceCount[2] = {};
+    for (uint32_t i = 0; i < header.ChunkCount; ++i)
+    {
+        const IvyInstanceChunk& chunk = GetChunks()[i];
+        const std::string       name  = "chunk " + std::to_string(i);
+        if (chunk.Stream >= IvyInstanceStreamCount)
+        {
+            return SetError(errorMessage, name + " has an invalid stream");
+        }
+        if ((chunk.InstanceCount == 0) || (chunk.InstanceCount > header.ChunkCapacity))
+        {
+            return SetError(errorMessage, name + " has an invalid instance count");
+        }
+        if ((GetInstanceEncodingSize(chunk.Encoding) == 0) || (chunk.InstanceSize != GetInstanceEncodingSize(chunk.Encoding)))
+        {
+            return SetError(errorMessage, name + " has an invalid encoding");
+        }
+        if ((chunk.Offset < GetPayloadsOffset(header)) || (chunk.Offset > size) ||
+            (static_cast<uint64_t>(chunk.InstanceCount) * chunk.InstanceSize > size - chunk.Offset))
+        {
+            return SetError(errorMessage, name + " exceeds the file size");
+        }
+        instanceCount[chunk.Stream] += chunk.InstanceCount;
+    }
+
+    if ((instanceCount[IvyInstanceStreamLeaf] != header.InstanceCount[IvyInstanceStreamLeaf]) ||
+        (instanceCount[IvyInstanceStreamStem] != header.InstanceCount[IvyInstanceStreamStem]))
+    {
+        return SetError(errorMessage, "chunk instance counts do not match the header");
+    }
+
+    return true;
+}
+
+std::vector<IvyEncodedInstanceChunk> IvyChunkedInstanceFile::BuildChunks(const IvyChunkedInstances& instances, const IvyInstanceChunkSettings& settings)
+{
+    const uint32_t chunkCapacity = std::max(settings.ChunkCapacity, 1u);
+
+    std::vector<IvyEncodedInstanceChunk> chunks;
+    for (uint32_t stream = 0; stream < IvyInstanceStreamCount; ++stream)
+    {
+        const std::vector<IvyInstanceData>& streamInstances = instances.Instances[stream];
+
+        std::vector<float3x4> transforms;
+        IvyAabb               originBounds;
+        transforms.reserve(streamInstances.size());
+        for (const IvyInstanceData& instance : streamInstances)
+        {
+            transforms.push_back(Affine::ToFloat3x4(instance.transform));
+            originBounds.Grow(float3(transforms.back()[0].w, transforms.back()[1].w, transforms.back()[2].w));
+        }
+
+        // neighbors on the Morton curve are close in space, ties are broken by the transform bits to stay independent of the input order
+        std::vector<std::pair<uint32_t, uint32_t>> order;
+        order.reserve(transforms.size());
+        for (uint32_t i = 0; i < static_cast<uint32_t>(transforms.size()); ++i)
+        {
+            order.emplace_back(GetMortonCode(float3(transforms[i][0].w, transforms[i][1].w, transforms[i][2].w), originBounds), i);
+        }
+        std::sort(order.begin(), order.end(), [&transforms](const std::pair<uint32_t, uint32_t>& a, const std::pair<uint32_t, uint32_t>& b) {
+            if (a.first != b.first)
+            {
+                return a.first < b.first;
+            }
+            return std::memcmp(&transforms[a.second], &transforms[b.second], sizeof(float3x4)) < 0;
+        });
+
+        for (size_t first = 0; first < order.size(); first += chunkCapacity)
+        {
+            const uint32_t count = static_cast<uint32_t>(std::min<size_t>(chunkCapacity, order.size() - first));
+
+            // bounds of the mesh extent box of each instance
+            IvyAabb bounds;
+            bool    inPositionRange = true;
+            for (uint32_t i = 0; i < count; ++i)
+            {
+                const float3x4& transform = transforms[order[first + i].second];
+                float3          center, extent;
+                for (int row = 0; row < 3; ++row)
+                {
+                    center[row] = transform[row].w;
+                    extent[row] = settings.MeshExtent[stream] * (std::fabs(transform[row].x) + std::fabs(transform[row].y) + std::fabs(transform[row].z));
+                    inPositionRange &= (std::fabs(center[row]) <= IVY_INSTANCE_POSITION_RANGE);
+                }
+                bounds.Grow(center - extent);
+                bounds.Grow(center + extent);
+            }
+
+            IvyEncodedInstanceChunk encodedChunk;
+            IvyInstanceChunk&       chunk = encodedChunk.Chunk;
+            chunk                         = {};
+            chunk.Stream                  = stream;
+            chunk.InstanceCount           = count;
+            chunk.Encoding                = ((settings.Encoding == IVY_INSTANCE_ENCODING_QUANTIZED) && !inPositionRange) ? IVY_INSTANCE_ENCODING_FLOAT3X4 : settings.Encoding;
+            chunk.InstanceSize            = GetInstanceEncodingSize(chunk.Encoding);
+            for (int axis = 0; axis < 3; ++axis)
+            {
+                chunk.BoundsMin[axis] = bounds.Min[axis];
+                chunk.BoundsMax[axis] = bounds.Max[axis];
+            }
+
+            encodedChunk.Payload.resize(static_cast<size_t>(count) * chunk.InstanceSize);
+            for (uint32_t i = 0; i < count; ++i)
+            {
+                EncodeInstance(transforms[order[first + i].second], chunk.Encoding, encodedChunk.Payload.data() + static_cast<size_t>(i) * chunk.InstanceSize);
+            }
+
+            IvyGenerationKey checksum;
+            checksum.AddBytes(encodedChunk.Payload.data(), encodedChunk.Payload.size());
+            chunk.Checksum = checksum.Get();
+
+            chunks.push_back(std::move(encodedChunk));
+        }
+    }
+
+    return chunks;
+}
+
+bool IvyChunkedInstanceFile::Write(const std::string& path, const IvyChunkedInstances& instances, const IvyInstanceChunkSettings& settings, std::string* errorMessage)
+{
+    if (GetInstanceEncodingSize(settings.Encoding) == 0)
+    {
+        return SetError(errorMessage, "unknown instance encoding " + std::to_string(settings.Encoding));
+    }
+
+    std::vector<IvyEncodedInstanceChunk> chunks = BuildChunks(instances, settings);
+
+    IvyChunkedInstanceHeader header = {};
+    std::memcpy(header.Magic, ivyChunkedInstanceMagic, sizeof(header.Magic));
+    header.Version                  = ivyInstanceChunkVersion;
+    header.ChunkCapacity            = std::max(settings.ChunkCapacity, 1u);
+    header.ChunkCount               = static_cast<uint32_t>(chunks.size());
+    header.BranchRecordCount        = static_cast<uint32_t>(instances.BranchRecords.size());
+    header.AreaRecordCount          = static_cast<uint32_t>(instances.AreaRecords.size());
+    header.IndexCountPerInstance[0] = instances.IndexCountPerInstance[0];
+    header.IndexCountPerInstance[1] = instances.IndexCountPerInstance[1];
+    header.InstanceCount[0]         = instances.Instances[0].size();
+    header.InstanceCount[1]         = instances.Instances[1].size();
+
+    std::vector<IvyInstanceChunk> directory;
+    uint64_t                      offset = GetPayloadsOffset(header);
+    for (IvyEncodedInstanceChunk& chunk : chunks)
+    {
+        offset             = AlignChunkOffset(offset);
+        chunk.Chunk.Offset = offset;
+        offset += chunk.Payload.size();
+        directory.push_back(chunk.Chunk);
+    }
+
+    IvyGenerationKey checksum;
+    checksum.AddBytes(directory.data(), directory.size() * sizeof(IvyInstanceChunk));
+    checksum.AddBytes(instances.BranchRecords.data(), instances.BranchRecords.size() * sizeof(IvyBakedEntryRecord));
+    checksum.AddBytes(instances.AreaRecords.data(), instances.AreaRecords.size() * sizeof(IvyBakedEntryRecord));
+    header.DirectoryChecksum = checksum.Get();
+
+    std::ofstream file(path, std::ios::binary);
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    file.write(reinterpret_cast<const char*>(directory.data()), directory.size() * sizeof(IvyInstanceChunk));
+    file.write(reinterpret_cast<const char*>(instances.BranchRecords.data()), instances.BranchRecords.size() * sizeof(IvyBakedEntryRecord));
+    file.write(reinterpret_cast<const char*>(instances.AreaRecords.data()), instances.AreaRecords.size() * sizeof(IvyBakedEntryRecord));
+
+    uint64_t                position = GetPayloadsOffset(header);
+    const std::vector<char> padding(ivyInstanceChunkAlignment, 0);
+    for (const IvyEncodedInstanceChunk& chunk : chunks)
+    {
+        file.write(padding.data(), static_cast<std::streamsize>(chunk.Chunk.Offset - position));
+        file.write(reinterpret_cast<const char*>(chunk.Payload.data()), chunk.Payload.size());
+        position = chunk.Chunk.Offset + chunk.Payload.size();
+    }
+
+    if (!file)
+    {
+        return SetError(errorMessage, "cannot write " + path);
+    }
+    return true;
+}
+
+IvyInstanceChunkStreamer::IvyInstanceChunkStreamer(const IvyChunkedInstanceFile& file, uint64_t maxResidentInstances)
+    : m_File(file)
+    , m_MaxResidentInstances(maxResidentInstances)
+    , m_FailedChunks(file.GetHeader().ChunkCount, false)
+{
+}
+
+const IvyInstanceChunkStreamer::Statistics& IvyInstanceChunkStreamer::Update(const float3& position, float radius)
+{
+    const IvyInstanceChunk* chunks = m_File.GetChunks();
+
+    m_SelectedChunks.clear();
+    m_File.SelectChunks(position, radius, m_SelectedChunks);
+
+    m_Statistics.LoadedChunks  = 0;
+    m_Statistics.EvictedChunks = 0;
+    m_Statistics.SkippedChunks = 0;
+    m_Statistics.LoadedBytes   = 0;
+
+    // evict first, such that the budget is available for the chunks that entered the radius
+    std::vector<bool> selected(m_File.GetHeader().ChunkCount, false);
+    for (uint32_t chunkIndex : m_SelectedChunks)
+    {
+        selected[chunkIndex] = true;
+    }
+    for (auto it = m_ResidentChunks.begin(); it != m_ResidentChunks.end();)
+    {
+        if (!selected[it->first])
+        {
+            m_Statistics.ResidentInstances[chunks[it->first].Stream] -= chunks[it->first].InstanceCount;
+            ++m_Statistics.EvictedChunks;
+            it = m_ResidentChunks.erase(it);
+        }
+        else
+        {
+            ++it;
+        }
+    }
+
+    for (uint32_t chunkIndex : m_SelectedChunks)
+    {
+        const IvyInstanceChunk& chunk = chunks[chunkIndex];
+        if (IsResident(chunkIndex) || m_FailedChunks[chunkIndex])
+        {
+            continue;
+        }
+        if (m_Statistics.ResidentInstances[chunk.Stream] + chunk.InstanceCount > m_MaxResidentInstances)
+        {
+            ++m_Statistics.SkippedChunks;
+            continue;
+        }
+
+        std::vector<IvyInstanceData> instances;
+        if (!m_File.LoadChunk(chunkIndex, instances))
+        {
+            m_FailedChunks[chunkIndex] = true;
+            ++m_Statistics.FailedChunks;
+            continue;
+        }
+
+        m_ResidentChunks.emplace(chunkIndex, std::move(instances));
+        m_Statistics.ResidentInstances[chunk.Stream] += chunk.InstanceCount;
+        m_Statistics.LoadedBytes += static_cast<uint64_t>(chunk.InstanceCount) * chunk.InstanceSize;
+        ++m_Statistics.LoadedChunks;
+    }
+
+    m_Statistics.ResidentChunks = static_cast<uint32_t>(m_ResidentChunks.size());
+    return m_Statistics;
+}
+
+void IvyInstanceChunkStreamer::GetResidentInstances(IvyInstanceStream stream, std::vector<IvyInstanceData>& instances) const
+{
+    std::vector<uint32_t> chunkIndices;
+    for (const auto& residentChunk : m_ResidentChunks)
+    {
+        if (m_File.GetChunks()[residentChunk.first].Stream == stream)
+        {
+            chunkIndices.push_back(residentChunk.first);
+        }
+    }
+    std::sort(chunkIndices.begin(), chunkIndices.end());
+
+    for (uint32_t chunkIndex : chunkIndices)
+    {
+        const std::vector<IvyInstanceData>& chunkInstances = m_ResidentChunks.at(chunkIndex);
+        instances.insert(instances.end(), chunkInstances.begin(), chunkInstances.end());
+    }
+}
@@ -0,0 +1,229 @@
+// This file is part of the AMD Work Graph Ivy Generation Sample.
+//
+// Copyright (c) 2024 Advanced Micro Devices, Inc. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+#pragma once
+
+// Chunked instance container for large levels, written by IvyBake --format chunked.
+// Instances are grouped into spatially coherent chunks with bounds, so a streaming reader only decodes the chunks
+// near the camera. Unlike baked instance files (cpu/ivybakedinstances.h), the instance counts are not limited by
+// IVY_MAX_INSTANCES, only the resident chunks have to fit into the instance buffers.
+
+#include "cpu/hlslmath.h"
+#include "cpu/ivybakedinstances.h"
+#include "cpu/ivymappedfile.h"
+#include "shaders/ivycommon.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Incremented on every change of the file layout
+static const uint32_t ivyInstanceChunkVersion = 1;
+
+static const uint32_t ivyDefaultInstanceChunkCapacity = 4096;
+// Chunk payloads start on page boundaries, such that loading a chunk only touches its own pages
+static const uint32_t ivyInstanceChunkAlignment = 4096;
+
+enum IvyInstanceStream : uint32_t
+{
+    IvyInstanceStreamLeaf  = 0,
+    IvyInstanceStreamStem  = 1,
+    IvyInstanceStreamCount = 2
+};
+
+/**
+ * @brief   Header of a chunked instance file, followed by the chunk directory, the entry records (branch records first)
+ *          and the chunk payloads.
+ */
+struct IvyChunkedInstanceHeader
+{
+    char     Magic[4];                  // "IVYC"
+    uint32_t Version;                   // ivyInstanceChunkVersion
+    uint32_t ChunkCapacity;             // maximum instances per chunk
+    uint32_t ChunkCount;
+    uint32_t BranchRecordCount;
+    uint32_t AreaRecordCount;
+    uint32_t IndexCountPerInstance[2];  // DrawIndexedArgs of the leaf & stem stream
+    uint64_t InstanceCount[2];          // leaf & stem instances of all chunks
+    uint64_t DirectoryChecksum;         // 64 bit FNV-1a of the chunk directory & entry records
+};
+
+/**
+ * @brief   Chunk directory entry. Each chunk holds up to ChunkCapacity instances of a single stream in a single encoding.
+ */
+struct IvyInstanceChunk
+{
+    float    BoundsMin[3];   // world space bounds of the instances
+    uint32_t Stream;         // IvyInstanceStream
+    float    BoundsMax[3];
+    uint32_t InstanceCount;
+    uint32_t Encoding;       // IVY_INSTANCE_ENCODING_* of the payload
+    uint32_t InstanceSize;   // bytes per instance in the payload
+    uint64_t Offset;         // payload offset from the start of the file
+    uint64_t Checksum;       // 64 bit FNV-1a of the payload
+};
+
+/**
+ * @brief   Chunking options of IvyChunkedInstanceFile::Write().
+ */
+struct IvyInstanceChunkSettings
+{
+    uint32_t ChunkCapacity = ivyDefaultInstanceChunkCapacity;
+    uint32_t Encoding      = IVY_INSTANCE_ENCODING;  // chunks outside of IVY_INSTANCE_POSITION_RANGE fall back from quantized to float3x4
+    float    MeshExtent[2] = {1.f, 1.f};             // half extent of the leaf & stem mesh in object space, bounds the instances
+};
+
+/**
+ * @brief   Input of IvyChunkedInstanceFile::Write(), instances in any order.
+ */
+struct IvyChunkedInstances
+{
+    std::vector<IvyBakedEntryRecord> BranchRecords;
+    std::vector<IvyBakedEntryRecord> AreaRecords;
+    std::vector<IvyInstanceData>     Instances[2];  // leaf & stem
+    uint32_t                         IndexCountPerInstance[2] = {};
+};
+
+/**
+ * @brief   Directory & payload of a single chunk, see IvyChunkedInstanceFile::BuildChunks().
+ */
+struct IvyEncodedInstanceChunk
+{
+    IvyInstanceChunk     Chunk;  // Offset is assigned by Write()
+    std::vector<uint8_t> Payload;
+};
+
+/**
+ * @brief   Read-only memory mapping of a chunked instance file.
+ *
+ * Open() only validates the header, the directory & the entry records. Payloads are validated when they are loaded,
+ * so the pages of chunks that are never loaded are never read.
+ */
+class IvyChunkedInstanceFile
+{
+public:
+    /**
+     * @brief   Maps the file & validates the directory. Returns false and sets errorMessage (if provided) on failure.
+     */
+    bool Open(const std::string& path, std::string* errorMessage = nullptr);
+    void Close();
+
+    bool IsOpen() const
+    {
+        return m_File.IsOpen();
+    }
+
+    size_t GetFileSize() const
+    {
+        return m_File.GetSize();
+    }
+
+    const IvyChunkedInstanceHeader& GetHeader() const
+    {
+        return *reinterpret_cast<const IvyChunkedInstanceHeader*>(m_File.GetData());
+    }
+
+    const IvyInstanceChunk*    GetChunks() const;
+    const IvyBakedEntryRecord* GetBranchRecords() const;
+    const IvyBakedEntryRecord* GetAreaRecords() const;
+
+    /**
+     * @brief   Encoded payload of a chunk, can be uploaded directly if the chunk encoding matches IVY_INSTANCE_ENCODING.
+     */
+    const uint8_t* GetChunkPayload(uint32_t chunkIndex) const;
+
+    /**
+     * @brief   Checks the payload checksum & decodes the instances of a chunk, appending them to instances.
+     *          Returns false and sets errorMessage (if provided) on failure.
+     */
+    bool LoadChunk(uint32_t chunkIndex, std::vector<IvyInstanceData>& instances, std::string* errorMessage = nullptr) const;
+
+    /**
+     * @brief   Appends the indices of all chunks whose bounds are within radius of position, ordered by distance.
+     */
+    void SelectChunks(const float3& position, float radius, std::vector<uint32_t>& chunkIndices) const;
+
+    /**
+     * @brief   Sorts the instances of each stream along a Morton curve & splits them into chunks of up to
+     *          settings.ChunkCapacity instances. The result only depends on the input, not on its order.
+     */
+    static std::vector<IvyEncodedInstanceChunk> BuildChunks(const IvyChunkedInstances& instances, const IvyInstanceChunkSettings& settings);
+
+    /**
+     * @brief   Writes a chunked instance file. Returns false and sets errorMessage (if provided) on failure.
+     */
+    static bool Write(const std::string& path, const IvyChunkedInstances& instances, const IvyInstanceChunkSettings& settings, std::string* errorMessage = nullptr);
+
+private:
+    bool Validate(std::string* errorMessage) const;
+
+    IvyMappedFile m_File;
+};
+
+/**
+ * @brief   Keeps the chunks around a moving position resident, within a budget of instances per stream.
+ *
+ * Update() loads the missing chunks within the streaming radius, nearest first, and evicts the chunks that left it.
+ * Chunks that do not fit into the budget are skipped until closer chunks are evicted.
+ */
+class IvyInstanceChunkStreamer
+{
+public:
+    struct Statistics
+    {
+        uint32_t LoadedChunks         = 0;  // in the last Update()
+        uint32_t EvictedChunks        = 0;  // in the last Update()
+        uint32_t SkippedChunks        = 0;  // within the radius, but over budget, in the last Update()
+        uint64_t LoadedBytes          = 0;  // payload bytes read in the last Update()
+        uint32_t ResidentChunks       = 0;
+        uint64_t ResidentInstances[2] = {};
+        uint32_t FailedChunks         = 0;  // checksum mismatches, never retried
+    };
+
+    /**
+     * @brief   The file has to stay open while the streamer is used. maxResidentInstances limits each stream,
+     *          e.g. to IVY_MAX_INSTANCES.
+     */
+    IvyInstanceChunkStreamer(const IvyChunkedInstanceFile& file, uint64_t maxResidentInstances);
+
+    const Statistics& Update(const float3& position, float radius);
+
+    /**
+     * @brief   Gathers the resident instances of a stream, in chunk order.
+     */
+    void GetResidentInstances(IvyInstanceStream stream, std::vector<IvyInstanceData>& instances) const;
+
+    bool IsResident(uint32_t chunkIndex) const
+    {
+        return m_ResidentChunks.count(chunkIndex) != 0;
+    }
+
+private:
+    const IvyChunkedInstanceFile&                              m_File;
+    uint64_t                                                   m_MaxResidentInstances;
+    std::unordered_map<uint32_t, std::vector<IvyInstanceData>> m_ResidentChunks;
+    std::vector<bool>                                          m_FailedChunks;
+    std::vector<uint32_t>                                      m_SelectedChunks;
+    Statistics                                                 m_Statistics;
+};
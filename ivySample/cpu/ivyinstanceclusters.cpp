@@ -0,0 +1,149 @@
+// This file is part of the AMD Work Graph Ivy Generation Sample.
+//
+// Copyright (c) 2024 Advanced Micro Devices, Inc. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include "cpu/ivyinstanceclusters.h"
+
+#include "cpu/affinemath.h"
+#include "cpu/ivybvh.h"
+
+#include <algorithm>
+
+static float4 GetInstanceSphere(const IvyInstanceData& instance, const float4& localSphere)
+{
+    return IvyGetInstanceBoundingSphere(Affine::ToFloat3x4(instance.transform), localSphere);
+}
+
+void IvyBuildInstanceClusters(const std::vector<IvyInstanceData>&  instances,
+                              const float4&                        localSphere,
+                              const std::vector<IvyInstanceRange>& ranges,
+                              std::vector<IvyInstanceCluster>&     clusters)
+{
+    clusters.clear();
+    for (const IvyInstanceRange& range : ranges)
+    {
+        for (uint32_t first = range.First; first < range.First + range.Count; first += IVY_INSTANCE_CLUSTER_SIZE)
+        {
+            const uint32_t count = std::min(range.First + range.Count - first, static_cast<uint32_t>(IVY_INSTANCE_CLUSTER_SIZE));
+
+            // Same min/max as the group reduction of BuildClusters
+            IvyAabb bounds;
+            for (uint32_t i = first; i < first + count; ++i)
+            {
+                const float4 sphere = GetInstanceSphere(instances[i], localSphere);
+                bounds.Grow(sphere.xyz() - sphere.w);
+                bounds.Grow(sphere.xyz() + sphere.w);
+            }
+
+            IvyInstanceCluster cluster;
+            cluster.boundsMin[0]  = bounds.Min.x;
+            cluster.boundsMin[1]  = bounds.Min.y;
+            cluster.boundsMin[2]  = bounds.Min.z;
+            cluster.firstInstance = first;
+            cluster.boundsMax[0]  = bounds.Max.x;
+            cluster.boundsMax[1]  = bounds.Max.y;
+            cluster.boundsMax[2]  = bounds.Max.z;
+            cluster.instanceCount = count;
+            clusters.push_back(cluster);
+        }
+    }
+}
+
+bool IvyValidateInstanceClusters(const std::vector<IvyInstanceData>&    instances,
+                                 const float4&                          localSphere,
+                                 const std::vector<IvyInstanceCluster>& clusters)
+{
+    // Rounding of the cluster sphere, relative to its radius
+    const float tolerance = 1e-5f;
+
+    std::vector<uint32_t> coverage(instances.size(), 0);
+    for (const IvyInstanceCluster& cluster : clusters)
+    {
+        if ((cluster.instanceCount == 0) || (cluster.instanceCount > IVY_INSTANCE_CLUSTER_SIZE) ||
+            (cluster.firstInstance + cluster.instanceCount > instances.size()))
+        {
+            return false;
+        }
+
+        const float4 clusterSphere = IvyGetClusterBoundingSphere(cluster);
+        for (uint32_t i = cluster.firstInstance; i < cluster.firstInstance + cluster.instanceCount; ++i)
+        {
+            ++coverage[i];
+
+            const float4 sphere = GetInstanceSphere(instances[i], localSphere);
+            for (uint32_t axis = 0; axis < 3; ++axis)
+            {
+                if ((sphere[axis] - sphere.w < cluster.boundsMin[axis]) || (sphere[axis] + sphere.w > cluster.boundsMax[axis]))
+                {
+                    return false;
+                }
+            }
+            if (length(sphere.xyz() - clusterSphere.xyz()) + sphere.w > clusterSphere.w * (1.f + tolerance))
+            {
+                return false;
+            }
+        }
+    }
+    return std::all_of(coverage.begin(), coverage.end(), [](uint32_t count) { return count == 1; });
+}
+
+IvyClusterCullingStatistics IvyCullInstanceClusters(const IvyFrustum&                      frustum,
+                                                    const IvyCpuHiZPyramid*                pHiZPyramid,
+                                                    const float4x4&                        viewProjection,
+                                                    const float4&                          localSphere,
+                                                    const std::vector<IvyInstanceData>&    instances,
+                                                    const std::vector<IvyInstanceCluster>& clusters,
+                                                    std::vector<uint32_t>&                 visibleInstances,
+                                                    float                                  impostorDistance,
+                                                    std::vector<uint32_t>*                 pImpostorClusters)
+{
+    const auto isVisible = [&](const float4& sphere) {
+        return frustum.IsSphereVisible(sphere) && !(pHiZPyramid && pHiZPyramid->IsSphereOccluded(viewProjection, sphere));
+    };
+
+    IvyClusterCullingStatistics statistics;
+    for (uint32_t c = 0; c < clusters.size(); ++c)
+    {
+        const IvyInstanceCluster& cluster       = clusters[c];
+        const float4              clusterSphere = IvyGetClusterBoundingSphere(cluster);
+        if (!isVisible(clusterSphere))
+        {
+            continue;
+        }
+
+        ++statistics.VisibleClusters;
+        if (pImpostorClusters && IvyUseLeafImpostors(clusterSphere, viewProjection[3], impostorDistance))
+        {
+            ++statistics.ImpostorClusters;
+            pImpostorClusters->push_back(c);
+            continue;
+        }
+        statistics.InstanceTests += cluster.instanceCount;
+
+        for (uint32_t i = cluster.firstInstance; i < cluster.firstInstance + cluster.instanceCount; ++i)
+        {
+            if (isVisible(GetInstanceSphere(instances[i], localSphere)))
+            {
+                visibleInstances.push_back(i);
+            }
+        }
+    }
+    return statistics;
+}
@@ -0,0 +1,79 @@
+// This file is part of the AMD Work Graph Ivy Generation Sample.
+//
+// Copyright (c) 2024 Advanced Micro Devices, Inc. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#pragma once
+
+// CPU reference of the instance clusters of the culling pass (BuildClusters, CullClusters & CullClusterInstances
+// of shaders/ivyinstanceculling.hlsl), using the sphere tests of shaders/ivyinstanceculling.h.
+// The GPU pass clusters consecutive runs of IVY_INSTANCE_CLUSTER_SIZE instances of the draw buffers. IvyBranch thread groups
+// write their instances as one run, so these clusters mostly match the clusters of the IvyBranch groups
+// (IvyInstanceStreams::LeafGroupRanges & StemGroupRanges), which the benchmark builds for comparison.
+
+#include "cpu/hlslmath.h"
+#include "cpu/ivycpuengine.h"
+#include "cpu/ivycpuhiz.h"
+#include "cpu/ivyinstanceculling.h"
+#include "cpu/ivyleafimpostors.h"
+#include "shaders/ivycommon.h"
+
+#include <cstdint>
+#include <vector>
+
+/**
+ * @brief   Splits each range into clusters of up to IVY_INSTANCE_CLUSTER_SIZE consecutive instances, bounded by the
+ *          bounding spheres of their instances (see IvyGetInstanceBoundingSphere). A single range over all instances
+ *          gives the clusters of BuildClusters.
+ */
+void IvyBuildInstanceClusters(const std::vector<IvyInstanceData>&  instances,
+                              const float4&                        localSphere,
+                              const std::vector<IvyInstanceRange>& ranges,
+                              std::vector<IvyInstanceCluster>&     clusters);
+
+/**
+ * @brief   Checks that the clusters cover every instance exactly once and enclose the bounding spheres of their instances.
+ */
+bool IvyValidateInstanceClusters(const std::vector<IvyInstanceData>&    instances,
+                                 const float4&                          localSphere,
+                                 const std::vector<IvyInstanceCluster>& clusters);
+
+struct IvyClusterCullingStatistics
+{
+    uint32_t VisibleClusters  = 0;
+    uint32_t InstanceTests    = 0;  // instances of the visible clusters without impostors
+    uint32_t ImpostorClusters = 0;  // visible clusters drawn as leaf impostors, their instances are not tested
+};
+
+/**
+ * @brief   CullClusters & CullClusterInstances of shaders/ivyinstanceculling.hlsl. Tests the clusters against the frustum
+ *          and, if pHiZPyramid is set, against the Hi-Z pyramid built from the depth of viewProjection, then the instances of
+ *          the visible clusters. Appends the indices of the visible instances in cluster order.
+ *          With impostorDistance > 0, visible clusters beyond it (see IvyUseLeafImpostors) are appended to pImpostorClusters
+ *          instead of testing their instances, like CullClusters does for the leaf clusters.
+ */
+IvyClusterCullingStatistics IvyCullInstanceClusters(const IvyFrustum&                      frustum,
+                                                    const IvyCpuHiZPyramid*                pHiZPyramid,
+                                                    const float4x4&                        viewProjection,
+                                                    const float4&                          localSphere,
+                                                    const std::vector<IvyInstanceData>&    instances,
+                                                    const std::vector<IvyInstanceCluster>& clusters,
+                                                    std::vector<uint32_t>&                 visibleInstances,
+                                                    float                                  impostorDistance  = 0.f,
+                                                    std::vector<uint32_t>*                 pImpostorClusters = nullptr);
@@ -0,0 +1,123 @@
+// This file is part of the AMD Work Graph Ivy Generation Sample.
+//
+// Copyright (c) 2024 Advanced Micro Devices, Inc. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+#pragma once
+
+// Cauldron-free, used by IvyRenderModule as well as the headless benchmarks.
+
+#include "shaders/ivycommon.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+/**
+ * @brief   Leaf & stem instance counts of the draw arguments over the last HistoryLength frames.
+ *
+ * IvyRenderModule adds the InstanceCount of both draw arguments as read back by IvyReadbackRing, i.e. a few frames
+ * after they were written. Streams are indexed like the argument buffer: 0 = leaf, 1 = stem.
+ */
+class IvyInstanceCountHistory
+{
+public:
+    static const uint32_t HistoryLength = 256;
+
+    struct Sample
+    {
+        uint64_t Frame            = 0;  // frame that wrote the arguments
+        uint32_t InstanceCount[2] = {};
+    };
+
+    void Add(uint64_t frame, const DrawIndexedArgs arguments[2])
+    {
+        Sample sample;
+        sample.Frame            = frame;
+        sample.InstanceCount[0] = arguments[0].InstanceCount;
+        sample.InstanceCount[1] = arguments[1].InstanceCount;
+
+        if (m_Samples.size() < HistoryLength)
+        {
+            m_Samples.push_back(sample);
+        }
+        else
+        {
+            m_Samples[m_Next] = sample;
+        }
+        m_Next = (m_Next + 1) % HistoryLength;
+
+        m_Peak[0] = std::max(m_Peak[0], sample.InstanceCount[0]);
+        m_Peak[1] = std::max(m_Peak[1], sample.InstanceCount[1]);
+    }
+
+    uint32_t GetSampleCount() const
+    {
+        return static_cast<uint32_t>(m_Samples.size());
+    }
+
+    /**
+     * @brief   Sample in order of the frames, index 0 is the oldest sample of the history.
+     */
+    const Sample& GetSample(uint32_t index) const
+    {
+        const uint32_t first = (m_Samples.size() < HistoryLength) ? 0 : m_Next;
+        return m_Samples[(first + index) % m_Samples.size()];
+    }
+
+    /**
+     * @brief   Most recent sample, all counts are zero if no sample was added yet.
+     */
+    Sample GetLatest() const
+    {
+        return m_Samples.empty() ? Sample() : GetSample(GetSampleCount() - 1);
+    }
+
+    /**
+     * @brief   Largest count of a stream since the history was created, not only within the last HistoryLength frames.
+     */
+    uint32_t GetPeak(uint32_t stream) const
+    {
+        return m_Peak[stream];
+    }
+
+    /**
+     * @brief   Mean count of a stream within the history.
+     */
+    double GetAverage(uint32_t stream) const
+    {
+        if (m_Samples.empty())
+        {
+            return 0.0;
+        }
+
+        double sum = 0.0;
+        for (const Sample& sample : m_Samples)
+        {
+            sum += sample.InstanceCount[stream];
+        }
+        return sum / m_Samples.size();
+    }
+
+private:
+    std::vector<Sample> m_Samples;
+    uint32_t            m_Next    = 0;  // index of the next sample to replace once the history is full
+    uint32_t            m_Peak[2] = {};
+};
@@ -0,0 +1,107 @@
+// This file is part of the AMD Work Graph Ivy Generation Sample.
+//
+// Copyright (c) 2024 Advanced Micro Devices, Inc. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include "cpu/ivyinstanceculling.h"
+
+#include "cpu/affinemath.h"
+
+IvyFrustum IvyFrustum::FromViewProjection(const float4x4& viewProjection)
+{
+    const float4& row0 = viewProjection[0];
+    const float4& row1 = viewProjection[1];
+    const float4& row2 = viewProjection[2];
+    const float4& row3 = viewProjection[3];
+
+    IvyFrustum frustum;
+    frustum.Planes[0] = float4(row3.x + row0.x, row3.y + row0.y, row3.z + row0.z, row3.w + row0.w);
+    frustum.Planes[1] = float4(row3.x - row0.x, row3.y - row0.y, row3.z - row0.z, row3.w - row0.w);
+    frustum.Planes[2] = float4(row3.x + row1.x, row3.y + row1.y, row3.z + row1.z, row3.w + row1.w);
+    frustum.Planes[3] = float4(row3.x - row1.x, row3.y - row1.y, row3.z - row1.z, row3.w - row1.w);
+    frustum.Planes[4] = row2;
+    frustum.Planes[5] = float4(row3.x - row2.x, row3.y - row2.y, row3.z - row2.z, row3.w - row2.w);
+
+    // Normalized planes give distances, a plane without normal (e.g. the far plane of an infinite projection) culls nothing
+    for (float4& plane : frustum.Planes)
+    {
+        const float normalLength = length(plane.xyz());
+        plane                    = (normalLength > 0.f) ? float4(plane.xyz() / normalLength, plane.w / normalLength) : float4(0, 0, 0, 1);
+    }
+    return frustum;
+}
+
+bool IvyFrustum::IsSphereVisible(const float4& sphere) const
+{
+    for (const float4& plane : Planes)
+    {
+        if (IvyIsSphereOutsidePlane(plane, sphere))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+float4 IvyGetLocalBoundingSphere(const float3& boundsMin, const float3& boundsMax)
+{
+    return float4((boundsMin + boundsMax) * 0.5f, length(boundsMax - boundsMin) * 0.5f);
+}
+
+void IvyCullInstances(const IvyFrustum&                   frustum,
+                      const float4&                       localSphere,
+                      const std::vector<IvyInstanceData>& instances,
+                      std::vector<uint32_t>&              visibleInstances)
+{
+    for (size_t i = 0; i < instances.size(); ++i)
+    {
+        const float4 sphere = IvyGetInstanceBoundingSphere(Affine::ToFloat3x4(instances[i].transform), localSphere);
+        if (frustum.IsSphereVisible(sphere))
+        {
+            visibleInstances.push_back(static_cast<uint32_t>(i));
+        }
+    }
+}
+
+bool IvyIsBoxOutsideClipVolume(const float4x4& viewProjection, const float3x4& transform, const float3& boundsMin, const float3& boundsMax)
+{
+    // Corners on a plane count as outside, the sphere test rounds differently
+    const float tolerance = 1e-4f;
+
+    // bit i: corner is outside of clip plane i (-x, +x, -y, +y, near, far)
+    uint32_t outsideAll = 0x3f;
+    for (uint32_t corner = 0; corner < 8; ++corner)
+    {
+        const float4 localCorner((corner & 1) ? boundsMax.x : boundsMin.x, (corner & 2) ? boundsMax.y : boundsMin.y, (corner & 4) ? boundsMax.z : boundsMin.z, 1.f);
+        const float4 worldCorner(dot(transform[0], localCorner), dot(transform[1], localCorner), dot(transform[2], localCorner), 1.f);
+        const float4 clip = mul(viewProjection, worldCorner);
+
+        const float limit = tolerance * std::fabs(clip.w);
+
+        uint32_t outside = 0;
+        outside |= (clip.x + clip.w <= limit) ? 0x01u : 0u;
+        outside |= (clip.w - clip.x <= limit) ? 0x02u : 0u;
+        outside |= (clip.y + clip.w <= limit) ? 0x04u : 0u;
+        outside |= (clip.w - clip.y <= limit) ? 0x08u : 0u;
+        outside |= (clip.z <= limit) ? 0x10u : 0u;
+        outside |= (clip.w - clip.z <= limit) ? 0x20u : 0u;
+        outsideAll &= outside;
+    }
+    return outsideAll != 0;
+}
@@ -0,0 +1,65 @@
+// This file is part of the AMD Work Graph Ivy Generation Sample.
+//
+// Copyright (c) 2024 Advanced Micro Devices, Inc. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#pragma once
+
+// CPU reference of the frustum culling pass (shaders/ivyinstanceculling.hlsl), using the same sphere tests
+// from shaders/ivyinstanceculling.h.
+
+#include "cpu/hlslmath.h"
+#include "shaders/ivycommon.h"
+#include "shaders/ivyinstanceculling.h"
+
+#include <cstdint>
+#include <vector>
+
+/**
+ * @brief   Frustum planes of a view projection matrix (HLSL semantics, clip volume 0 <= z <= w),
+ *          in the order & normalization of IvyInstanceCullingCBData::FrustumPlanes.
+ */
+struct IvyFrustum
+{
+    float4 Planes[6];  // left, right, bottom, top, near, far
+
+    static IvyFrustum FromViewProjection(const float4x4& viewProjection);
+
+    bool IsSphereVisible(const float4& sphere) const;
+};
+
+/**
+ * @brief   Local bounding sphere of mesh bounds, see IvyInstanceCullingCBData::LeafBoundingSphere.
+ */
+float4 IvyGetLocalBoundingSphere(const float3& boundsMin, const float3& boundsMax);
+
+/**
+ * @brief   Frustum test of shaders/ivyinstanceculling.hlsl for every instance, without the clusters of cpu/ivyinstanceclusters.h.
+ *          Appends the indices of the visible instances in their original order, the GPU pass appends them in scheduling order.
+ */
+void IvyCullInstances(const IvyFrustum&                   frustum,
+                      const float4&                       localSphere,
+                      const std::vector<IvyInstanceData>& instances,
+                      std::vector<uint32_t>&              visibleInstances);
+
+/**
+ * @brief   Tests the corners of the transformed mesh bounds against the clip volume. Returns true if all corners are
+ *          outside of the same clip plane, which holds for every instance culled by IvyCullInstances.
+ */
+bool IvyIsBoxOutsideClipVolume(const float4x4& viewProjection, const float3x4& transform, const float3& boundsMin, const float3& boundsMax);
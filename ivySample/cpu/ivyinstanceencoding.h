@@ -0,0 +1,77 @@
+// This file is part of the AMD Work Graph Ivy Generation Sample.
+//
+// Copyright (c) 2024 Advanced Micro Devices, Inc. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+#pragma once
+
+// CPU side of the instance encodings, see shaders/ivyinstanceencoding.h.
+
+#include "cpu/hlslmath.h"
+#include "cpu/ivyutils.h"
+#include "shaders/ivycommon.h"
+#include "shaders/ivyinstanceencoding.h"
+
+// Precision bounds of IvyInstanceDataQuantized for transforms within IVY_INSTANCE_POSITION_RANGE
+static const float ivyQuantizedPositionErrorBound = 2.f * IVY_INSTANCE_POSITION_RANGE / ivyPositionQuantizationMax;  // per axis, one quantization step
+static const float ivyQuantizedRotationErrorBound = 0.005f;                                                            // radians, 10 bit quaternion components
+static const float ivyQuantizedScaleErrorBound    = 1.f / 1024;                                                        // relative, for scales >= 2^-14 (normal half precision)
+
+inline const char* GetInstanceEncodingName(uint32_t encoding)
+{
+    switch (encoding)
+    {
+    case IVY_INSTANCE_ENCODING_FLOAT4X4:
+        return "float4x4";
+    case IVY_INSTANCE_ENCODING_FLOAT3X4:
+        return "float3x4";
+    case IVY_INSTANCE_ENCODING_QUANTIZED:
+        return "quantized";
+    default:
+        return "unknown";
+    }
+}
+
+inline uint32_t GetInstanceEncodingSize(uint32_t encoding)
+{
+    switch (encoding)
+    {
+    case IVY_INSTANCE_ENCODING_FLOAT4X4:
+        return sizeof(IvyInstanceData);
+    case IVY_INSTANCE_ENCODING_FLOAT3X4:
+        return sizeof(IvyInstanceData3x4);
+    case IVY_INSTANCE_ENCODING_QUANTIZED:
+        return sizeof(IvyInstanceDataQuantized);
+    default:
+        return 0;
+    }
+}
+
+// Encoding of the instance buffers selected by IVY_INSTANCE_ENCODING, like IvyEncodeInstance in shaders/ivyinstanceencoding.h
+inline IvyEncodedInstance IvyEncodeInstance(const IvyInstanceData& instance)
+{
+#if IVY_INSTANCE_ENCODING == IVY_INSTANCE_ENCODING_FLOAT4X4
+    return instance;
+#elif IVY_INSTANCE_ENCODING == IVY_INSTANCE_ENCODING_FLOAT3X4
+    return IvyEncodeInstance3x4(float3x4(ToFloat4x4(instance.transform)));
+#else
+    return IvyEncodeInstanceQuantized(float3x4(ToFloat4x4(instance.transform)));
+#endif  // IVY_INSTANCE_ENCODING
+}
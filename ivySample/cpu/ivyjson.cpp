@@ -0,0 +1,515 @@
+// This file is part of the AMD Work Graph Ivy Generation Sample.
+//
+// Copyright (c) 2024 Advanced Micro Devices, Inc. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+#include "cpu/ivyjson.h"
+
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+
+// ==================
+// Parser
+
+class IvyJsonParser
+{
+public:
+    explicit IvyJsonParser(const std::string& text)
+        : m_Text(text)
+    {
+    }
+
+    bool ParseDocument(IvyJson& value)
+    {
+        if (!ParseValue(value, 0))
+        {
+            return false;
+        }
+
+        SkipWhitespace();
+        return (m_Position == m_Text.size()) || Fail("unexpected trailing characters");
+    }
+
+    const std::string& GetError() const
+    {
+        return m_Error;
+    }
+
+private:
+    static const int MaxDepth = 256;
+
+    bool Fail(const char* message)
+    {
+        if (m_Error.empty())
+        {
+            m_Error = std::string(message) + " at offset " + std::to_string(m_Position);
+        }
+        return false;
+    }
+
+    void SkipWhitespace()
+    {
+        while ((m_Position < m_Text.size()) &&
+               ((m_Text[m_Position] == ' ') || (m_Text[m_Position] == '\t') || (m_Text[m_Position] == '\n') || (m_Text[m_Position] == '\r')))
+        {
+            ++m_Position;
+        }
+    }
+
+    bool Consume(char c)
+    {
+        SkipWhitespace();
+        if ((m_Position < m_Text.size()) && (m_Text[m_Position] == c))
+        {
+            ++m_Position;
+            return true;
+        }
+        return false;
+    }
+
+    bool ConsumeLiteral(const char* literal)
+    {
+        const size_t length = strlen(literal);
+        if (m_Text.compare(m_Position, length, literal) == 0)
+        {
+            m_Position += length;
+            return true;
+        }
+        return false;
+    }
+
+    bool ParseValue(IvyJson& value, int depth)
+    {
+        if (depth > MaxDepth)
+        {
+            return Fail("nesting too deep");
+        }
+
+        SkipWhitespace();
+        if (m_Position >= m_Text.size())
+        {
+            return Fail("unexpected end of input");
+        }
+
+        const char c = m_Text[m_Position];
+        if (c == '{')
+        {
+            return ParseObject(value, depth);
+        }
+        if (c == '[')
+        {
+            return ParseArray(value, depth);
+        }
+        if (c == '"')
+        {
+            value.m_Type = IvyJson::Type::String;
+            return ParseString(value.m_String);
+        }
+        if (ConsumeLiteral("true"))
+        {
+            value.m_Type = IvyJson::Type::Bool;
+            value.m_Bool = true;
+            return true;
+        }
+        if (ConsumeLiteral("false"))
+        {
+            value.m_Type = IvyJson::Type::Bool;
+            value.m_Bool = false;
+            return true;
+        }
+        if (ConsumeLiteral("null"))
+        {
+            value.m_Type = IvyJson::Type::Null;
+            return true;
+        }
+        return ParseNumber(value);
+    }
+
+    bool ParseObject(IvyJson& value, int depth)
+    {
+        value.m_Type = IvyJson::Type::Object;
+        ++m_Position;
+
+        if (Consume('}'))
+        {
+            return true;
+        }
+
+        do
+        {
+            SkipWhitespace();
+            std::string key;
+            if ((m_Position >= m_Text.size()) || (m_Text[m_Position] != '"') || !ParseString(key))
+            {
+                return Fail("expected object key");
+            }
+            if (!Consume(':'))
+            {
+                return Fail("expected ':'");
+            }
+            if (!ParseValue(value.m_Object[key], depth + 1))
+            {
+                return false;
+            }
+        } while (Consume(','));
+
+        return Consume('}') || Fail("expected '}'");
+    }
+
+    bool ParseArray(IvyJson& value, int depth)
+    {
+        value.m_Type = IvyJson::Type::Array;
+        ++m_Position;
+
+        if (Consume(']'))
+        {
+            return true;
+        }
+
+        do
+        {
+            value.m_Array.emplace_back();
+            if (!ParseValue(value.m_Array.back(), depth + 1))
+            {
+                return false;
+            }
+        } while (Consume(','));
+
+        return Consume(']') || Fail("expected ']'");
+    }
+
+    bool ParseString(std::string& result)
+    {
+        // skip opening quote
+        ++m_Position;
+
+        while (m_Position < m_Text.size())
+        {
+            const char c = m_Text[m_Position++];
+            if (c == '"')
+            {
+                return true;
+            }
+            if (c != '\\')
+            {
+                result.push_back(c);
+                continue;
+            }
+
+            if (m_Position >= m_Text.size())
+            {
+                break;
+            }
+
+            const char escaped = m_Text[m_Position++];
+            switch (escaped)
+            {
+            case '"':
+            case '\\':
+            case '/':
+                result.push_back(escaped);
+                break;
+            case 'b':
+                result.push_back('\b');
+                break;
+            case 'f':
+                result.push_back('\f');
+                break;
+            case 'n':
+                result.push_back('\n');
+                break;
+            case 'r':
+                result.push_back('\r');
+                break;
+            case 't':
+                result.push_back('\t');
+                break;
+            case 'u':
+            {
+                if (m_Position + 4 > m_Text.size())
+                {
+                    return Fail("invalid unicode escape");
+                }
+                const uint32_t codePoint = static_cast<uint32_t>(strtoul(m_Text.substr(m_Position, 4).c_str(), nullptr, 16));
+                m_Position += 4;
+
+                // encode as UTF-8, surrogate pairs are not combined
+                if (codePoint < 0x80)
+                {
+                    result.push_back(static_cast<char>(codePoint));
+                }
+                else if (codePoint < 0x800)
+                {
+                    result.push_back(static_cast<char>(0xc0 | (codePoint >> 6)));
+                    result.push_back(static_cast<char>(0x80 | (codePoint & 0x3f)));
+                }
+                else
+                {
+                    result.push_back(static_cast<char>(0xe0 | (codePoint >> 12)));
+                    result.push_back(static_cast<char>(0x80 | ((codePoint >> 6) & 0x3f)));
+                    result.push_back(static_cast<char>(0x80 | (codePoint & 0x3f)));
+                }
+                break;
+            }
+            default:
+                return Fail("invalid escape sequence");
+            }
+        }
+
+        return Fail("unterminated string");
+    }
+
+    bool ParseNumber(IvyJson& value)
+    {
+        const char* begin = m_Text.c_str() + m_Position;
+        char*       end   = nullptr;
+        const double number = strtod(begin, &end);
+
+        if (end == begin)
+        {
+            return Fail("unexpected character");
+        }
+
+        m_Position += end - begin;
+
+        value.m_Type   = IvyJson::Type::Number;
+        value.m_Number = number;
+        return true;
+    }
+
+    const std::string& m_Text;
+    size_t             m_Position = 0;
+    std::string        m_Error;
+};
+
+bool IvyJson::Parse(const std::string& text, IvyJson& value, std::string* errorMessage)
+{
+    value = IvyJson();
+
+    IvyJsonParser parser(text);
+    if (!parser.ParseDocument(value))
+    {
+        if (errorMessage)
+        {
+            *errorMessage = parser.GetError();
+        }
+        return false;
+    }
+
+    return true;
+}
+
+bool IvyJson::AsBool(bool defaultValue) const
+{
+    return (m_Type == Type::Bool) ? m_Bool : defaultValue;
+}
+
+double IvyJson::AsNumber(double defaultValue) const
+{
+    return (m_Type == Type::Number) ? m_Number : defaultValue;
+}
+
+const std::string& IvyJson::AsString() const
+{
+    return m_String;
+}
+
+size_t IvyJson::Size() const
+{
+    switch (m_Type)
+    {
+    case Type::Array:
+        return m_Array.size();
+    case Type::Object:
+        return m_Object.size();
+    default:
+        return 0;
+    }
+}
+
+const IvyJson& IvyJson::operator[](size_t index) const
+{
+    static const IvyJson nullValue;
+    return ((m_Type == Type::Array) && (index < m_Array.size())) ? m_Array[index] : nullValue;
+}
+
+const IvyJson& IvyJson::operator[](const std::string& key) const
+{
+    static const IvyJson nullValue;
+    if (m_Type != Type::Object)
+    {
+        return nullValue;
+    }
+
+    const auto it = m_Object.find(key);
+    return (it != m_Object.end()) ? it->second : nullValue;
+}
+
+bool IvyJson::Contains(const std::string& key) const
+{
+    return (m_Type == Type::Object) && (m_Object.find(key) != m_Object.end());
+}
+
+// ==================
+// Writer
+
+static std::string EscapeString(const std::string& value)
+{
+    std::string result;
+    for (const char c : value)
+    {
+        switch (c)
+        {
+        case '"':
+            result += "\\\"";
+            break;
+        case '\\':
+            result += "\\\\";
+            break;
+        case '\n':
+            result += "\\n";
+            break;
+        case '\t':
+            result += "\\t";
+            break;
+        default:
+            result.push_back(c);
+        }
+    }
+    return result;
+}
+
+void IvyJsonWriter::NewLine()
+{
+    m_Stream << '\n' << std::string(m_HasElements.size() * 2, ' ');
+}
+
+void IvyJsonWriter::BeginValue(const char* key)
+{
+    if (!m_HasElements.empty())
+    {
+        if (m_HasElements.back())
+        {
+            m_Stream << ',';
+        }
+        m_HasElements.back() = true;
+        NewLine();
+    }
+
+    if (key)
+    {
+        m_Stream << '"' << EscapeString(key) << "\": ";
+    }
+}
+
+IvyJsonWriter& IvyJsonWriter::BeginObject(const char* key)
+{
+    BeginValue(key);
+    m_Stream << '{';
+    m_HasElements.push_back(false);
+    return *this;
+}
+
+IvyJsonWriter& IvyJsonWriter::EndObject()
+{
+    const bool hasElements = m_HasElements.back();
+    m_HasElements.pop_back();
+    if (hasElements)
+    {
+        NewLine();
+    }
+    m_Stream << '}';
+    return *this;
+}
+
+IvyJsonWriter& IvyJsonWriter::BeginArray(const char* key)
+{
+    BeginValue(key);
+    m_Stream << '[';
+    m_HasElements.push_back(false);
+    return *this;
+}
+
+IvyJsonWriter& IvyJsonWriter::EndArray()
+{
+    const bool hasElements = m_HasElements.back();
+    m_HasElements.pop_back();
+    if (hasElements)
+    {
+        NewLine();
+    }
+    m_Stream << ']';
+    return *this;
+}
+
+IvyJsonWriter& IvyJsonWriter::Value(const char* key, const std::string& value)
+{
+    BeginValue(key);
+    m_Stream << '"' << EscapeString(value) << '"';
+    return *this;
+}
+
+IvyJsonWriter& IvyJsonWriter::Value(const char* key, const char* value)
+{
+    return Value(key, std::string(value));
+}
+
+IvyJsonWriter& IvyJsonWriter::Value(const char* key, double value)
+{
+    BeginValue(key);
+    if (std::isfinite(value))
+    {
+        m_Stream.precision(9);
+        m_Stream << value;
+    }
+    else
+    {
+        // JSON has no representation for inf/nan
+        m_Stream << "null";
+    }
+    return *this;
+}
+
+IvyJsonWriter& IvyJsonWriter::Value(const char* key, uint64_t value)
+{
+    BeginValue(key);
+    m_Stream << value;
+    return *this;
+}
+
+IvyJsonWriter& IvyJsonWriter::Value(const char* key, uint32_t value)
+{
+    return Value(key, static_cast<uint64_t>(value));
+}
+
+IvyJsonWriter& IvyJsonWriter::Value(const char* key, int value)
+{
+    BeginValue(key);
+    m_Stream << value;
+    return *this;
+}
+
+IvyJsonWriter& IvyJsonWriter::Value(const char* key, bool value)
+{
+    BeginValue(key);
+    m_Stream << (value ? "true" : "false");
+    return *this;
+}
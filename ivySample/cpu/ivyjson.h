@@ -0,0 +1,116 @@
+// This file is part of the AMD Work Graph Ivy Generation Sample.
+//
+// Copyright (c) 2024 Advanced Micro Devices, Inc. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+#pragma once
+
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+/**
+ * @brief   Minimal JSON document model used to read glTF files in headless builds.
+ */
+class IvyJson
+{
+public:
+    enum class Type
+    {
+        Null,
+        Bool,
+        Number,
+        String,
+        Array,
+        Object
+    };
+
+    /**
+     * @brief   Parses a JSON document. Returns false and sets errorMessage (if provided) on malformed input.
+     */
+    static bool Parse(const std::string& text, IvyJson& value, std::string* errorMessage = nullptr);
+
+    Type GetType() const
+    {
+        return m_Type;
+    }
+    bool IsNull() const
+    {
+        return m_Type == Type::Null;
+    }
+
+    bool               AsBool(bool defaultValue = false) const;
+    double             AsNumber(double defaultValue = 0.0) const;
+    const std::string& AsString() const;
+
+    // Number of array elements or object members
+    size_t Size() const;
+
+    // Array access, returns a null value if out of range
+    const IvyJson& operator[](size_t index) const;
+    // Object access, returns a null value if the member does not exist
+    const IvyJson& operator[](const std::string& key) const;
+    bool           Contains(const std::string& key) const;
+
+private:
+    friend class IvyJsonParser;
+
+    Type                           m_Type   = Type::Null;
+    bool                           m_Bool   = false;
+    double                         m_Number = 0.0;
+    std::string                    m_String;
+    std::vector<IvyJson>           m_Array;
+    std::map<std::string, IvyJson> m_Object;
+};
+
+/**
+ * @brief   Streaming JSON writer for benchmark reports.
+ */
+class IvyJsonWriter
+{
+public:
+    IvyJsonWriter& BeginObject(const char* key = nullptr);
+    IvyJsonWriter& EndObject();
+    IvyJsonWriter& BeginArray(const char* key = nullptr);
+    IvyJsonWriter& EndArray();
+
+    IvyJsonWriter& Value(const char* key, const std::string& value);
+    IvyJsonWriter& Value(const char* key, const char* value);
+    IvyJsonWriter& Value(const char* key, double value);
+    IvyJsonWriter& Value(const char* key, uint64_t value);
+    IvyJsonWriter& Value(const char* key, uint32_t value);
+    IvyJsonWriter& Value(const char* key, int value);
+    IvyJsonWriter& Value(const char* key, bool value);
+
+    std::string GetString() const
+    {
+        return m_Stream.str();
+    }
+
+private:
+    void BeginValue(const char* key);
+    void NewLine();
+
+    std::ostringstream m_Stream;
+    std::vector<bool>  m_HasElements;  // one entry per open object/array
+};
@@ -0,0 +1,368 @@
+// This file is part of the AMD Work Graph Ivy Generation Sample.
+//
+// Copyright (c) 2024 Advanced Micro Devices, Inc. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+#include "cpu/ivyleafimpostoratlas.h"
+
+#include "cpu/ivygenerationcache.h"
+#include "shaders/ivyrandom.h"
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <limits>
+
+namespace
+{
+    const float pi = 3.14159265358979f;
+
+    // Vertex of a placed leaf in the frame of a tile: u & v in [-1; 1] across the tile, height along the quad normal
+    struct TileVertex
+    {
+        float U;
+        float V;
+        float Height;
+        float Normal[3];
+    };
+
+    // Samples of a tile, the highest leaf along the quad normal is visible
+    struct TileSamples
+    {
+        uint32_t           Size = 0;  // per side
+        std::vector<float> Heights;
+        std::vector<float> Normals;  // 3 floats per sample
+
+        void Clear(uint32_t size)
+        {
+            Size = size;
+            Heights.assign(size * size, -std::numeric_limits<float>::infinity());
+            Normals.assign(3 * size * size, 0.f);
+        }
+
+        bool IsCovered(uint32_t sample) const
+        {
+            return Heights[sample] > -std::numeric_limits<float>::infinity();
+        }
+
+        void RasterizeTriangle(const TileVertex& v0, const TileVertex& v1, const TileVertex& v2)
+        {
+            // sample centers are at integer coordinates
+            const float scale = 0.5f * Size;
+            const float x0 = (v0.U + 1.f) * scale - 0.5f, y0 = (v0.V + 1.f) * scale - 0.5f;
+            const float x1 = (v1.U + 1.f) * scale - 0.5f, y1 = (v1.V + 1.f) * scale - 0.5f;
+            const float x2 = (v2.U + 1.f) * scale - 0.5f, y2 = (v2.V + 1.f) * scale - 0.5f;
+
+            // both sides are rasterized, leaves seen edge-on cover nothing
+            const float area = (x1 - x0) * (y2 - y0) - (x2 - x0) * (y1 - y0);
+            if (std::fabs(area) < 1e-8f)
+            {
+                return;
+            }
+
+            const int maxSample = static_cast<int>(Size) - 1;
+            const int minX      = std::max(static_cast<int>(std::ceil(std::min({x0, x1, x2}))), 0);
+            const int maxX      = std::min(static_cast<int>(std::floor(std::max({x0, x1, x2}))), maxSample);
+            const int minY      = std::max(static_cast<int>(std::ceil(std::min({y0, y1, y2}))), 0);
+            const int maxY      = std::min(static_cast<int>(std::floor(std::max({y0, y1, y2}))), maxSample);
+
+            for (int y = minY; y <= maxY; ++y)
+            {
+                for (int x = minX; x <= maxX; ++x)
+                {
+                    const float px = static_cast<float>(x);
+                    const float py = static_cast<float>(y);
+                    const float w0 = ((x1 - px) * (y2 - py) - (x2 - px) * (y1 - py)) / area;
+                    const float w1 = ((x2 - px) * (y0 - py) - (x0 - px) * (y2 - py)) / area;
+                    const float w2 = 1.f - w0 - w1;
+                    if ((w0 < 0.f) || (w1 < 0.f) || (w2 < 0.f))
+                    {
+                        continue;
+                    }
+
+                    const uint32_t sample = y * Size + x;
+                    const float    height = w0 * v0.Height + w1 * v1.Height + w2 * v2.Height;
+                    if (height <= Heights[sample])
+                    {
+                        continue;
+                    }
+
+                    // the visible side faces along the quad normal
+                    float normal[3];
+                    for (uint32_t i = 0; i < 3; ++i)
+                    {
+                        normal[i] = w0 * v0.Normal[i] + w1 * v1.Normal[i] + w2 * v2.Normal[i];
+                    }
+                    const float sign = (normal[2] < 0.f) ? -1.f : 1.f;
+
+                    Heights[sample] = height;
+                    for (uint32_t i = 0; i < 3; ++i)
+                    {
+                        Normals[3 * sample + i] = normal[i] * sign;
+                    }
+                }
+            }
+        }
+    };
+
+    uint32_t ToUnorm8(float value)
+    {
+        return static_cast<uint32_t>(std::min(std::max(value, 0.f), 1.f) * 255.f + 0.5f);
+    }
+
+    uint32_t PackTexel(const float normal[3], float coverage)
+    {
+        return ToUnorm8(normal[0] * 0.5f + 0.5f) | (ToUnorm8(normal[1] * 0.5f + 0.5f) << 8) | (ToUnorm8(normal[2] * 0.5f + 0.5f) << 16) |
+               (ToUnorm8(coverage) << 24);
+    }
+
+    // Averages the normals & coverage of the samples of each texel of a tile
+    void ResolveTile(const TileSamples& samples, uint32_t sampleCount, uint32_t tile, IvyLeafImpostorAtlas& atlas)
+    {
+        for (uint32_t y = 0; y < atlas.TileSize; ++y)
+        {
+            for (uint32_t x = 0; x < atlas.TileSize; ++x)
+            {
+                float    normal[3] = {0.f, 0.f, 0.f};
+                uint32_t covered   = 0;
+                for (uint32_t sy = 0; sy < sampleCount; ++sy)
+                {
+                    for (uint32_t sx = 0; sx < sampleCount; ++sx)
+                    {
+                        const uint32_t sample = (y * sampleCount + sy) * samples.Size + x * sampleCount + sx;
+                        if (!samples.IsCovered(sample))
+                        {
+                            continue;
+                        }
+
+                        const float* sampleNormal = &samples.Normals[3 * sample];
+                        const float  length       = std::sqrt(sampleNormal[0] * sampleNormal[0] + sampleNormal[1] * sampleNormal[1] + sampleNormal[2] * sampleNormal[2]);
+                        for (uint32_t i = 0; (i < 3) && (length > 0.f); ++i)
+                        {
+                            normal[i] += sampleNormal[i] / length;
+                        }
+                        ++covered;
+                    }
+                }
+
+                const float length = std::sqrt(normal[0] * normal[0] + normal[1] * normal[1] + normal[2] * normal[2]);
+                if (length > 0.f)
+                {
+                    normal[0] /= length;
+                    normal[1] /= length;
+                    normal[2] /= length;
+                }
+                else
+                {
+                    normal[2] = 1.f;
+                }
+
+                atlas.Texels[y * atlas.GetWidth() + tile * atlas.TileSize + x] = PackTexel(normal, static_cast<float>(covered) / (sampleCount * sampleCount));
+            }
+        }
+    }
+
+    bool SetError(std::string* errorMessage, const std::string& error)
+    {
+        if (errorMessage)
+        {
+            *errorMessage = error;
+        }
+        return false;
+    }
+
+    const uint32_t tgaHeaderSize = 18;
+}  // namespace
+
+void IvyBakeLeafImpostorAtlas(const IvyMeshData& leafMesh, const IvyLeafImpostorAtlasSettings& settings, IvyLeafImpostorAtlas& atlas)
+{
+    const uint32_t sampleCount = std::max(settings.Samples, 1u);
+
+    atlas.TileSize = std::max(settings.TileSize, 1u);
+    atlas.Texels.assign(atlas.GetWidth() * atlas.GetHeight(), 0);
+
+    // Bounding sphere of the leaf mesh, like IvyGetLocalBoundingSphere
+    const uint32_t vertexCount = static_cast<uint32_t>(leafMesh.Positions.size() / 3);
+    float          boundsMin[3] = {std::numeric_limits<float>::max(), std::numeric_limits<float>::max(), std::numeric_limits<float>::max()};
+    float          boundsMax[3] = {std::numeric_limits<float>::lowest(), std::numeric_limits<float>::lowest(), std::numeric_limits<float>::lowest()};
+    for (uint32_t vertex = 0; vertex < vertexCount; ++vertex)
+    {
+        for (uint32_t i = 0; i < 3; ++i)
+        {
+            boundsMin[i] = std::min(boundsMin[i], leafMesh.Positions[3 * vertex + i]);
+            boundsMax[i] = std::max(boundsMax[i], leafMesh.Positions[3 * vertex + i]);
+        }
+    }
+    const float center[3] = {(boundsMin[0] + boundsMax[0]) * 0.5f, (boundsMin[1] + boundsMax[1]) * 0.5f, (boundsMin[2] + boundsMax[2]) * 0.5f};
+    const float extent[3] = {boundsMax[0] - boundsMin[0], boundsMax[1] - boundsMin[1], boundsMax[2] - boundsMin[2]};
+    const float radius    = std::sqrt(extent[0] * extent[0] + extent[1] * extent[1] + extent[2] * extent[2]) * 0.5f;
+    if ((vertexCount == 0) || !(radius > 0.f))
+    {
+        return;
+    }
+
+    const bool  hasNormals = (leafMesh.Normals.size() == leafMesh.Positions.size());
+    const float leafScale  = std::min(std::max(settings.LeafScale, 0.f), 1.f);
+    const float scale      = leafScale / radius;
+
+    TileSamples             samples;
+    std::vector<TileVertex> vertices(vertexCount);
+    for (uint32_t tile = 0; tile < IVY_LEAF_IMPOSTOR_TILES; ++tile)
+    {
+        samples.Clear(atlas.TileSize * sampleCount);
+
+        for (uint32_t leaf = 0; leaf < IVY_LEAF_IMPOSTOR_GROUP_SIZE; ++leaf)
+        {
+            // The leaves stay within the tile, later leaves are not necessarily on top
+            const float angle   = 2.f * pi * Random(settings.Seed, tile, leaf, 0u);
+            const float offsetU = (2.f * Random(settings.Seed, tile, leaf, 1u) - 1.f) * (1.f - leafScale);
+            const float offsetV = (2.f * Random(settings.Seed, tile, leaf, 2u) - 1.f) * (1.f - leafScale);
+            const float height  = leafScale * Random(settings.Seed, tile, leaf, 3u);
+            const float cosine  = std::cos(angle);
+            const float sine    = std::sin(angle);
+
+            // The leaf mesh lies in its xz plane, x maps to axisU, z to axisV & y to the quad normal
+            for (uint32_t vertex = 0; vertex < vertexCount; ++vertex)
+            {
+                const float* position = &leafMesh.Positions[3 * vertex];
+                const float  dx       = position[0] - center[0];
+                const float  dy       = position[1] - center[1];
+                const float  dz       = position[2] - center[2];
+
+                TileVertex& tileVertex = vertices[vertex];
+                tileVertex.U           = scale * (cosine * dx - sine * dz) + offsetU;
+                tileVertex.V           = scale * (sine * dx + cosine * dz) + offsetV;
+                tileVertex.Height      = scale * dy + height;
+
+                const float normal[3] = {hasNormals ? leafMesh.Normals[3 * vertex] : 0.f,
+                                         hasNormals ? leafMesh.Normals[3 * vertex + 1] : 1.f,
+                                         hasNormals ? leafMesh.Normals[3 * vertex + 2] : 0.f};
+                tileVertex.Normal[0]  = cosine * normal[0] - sine * normal[2];
+                tileVertex.Normal[1]  = sine * normal[0] + cosine * normal[2];
+                tileVertex.Normal[2]  = normal[1];
+            }
+
+            for (size_t i = 0; i + 2 < leafMesh.Indices.size(); i += 3)
+            {
+                const uint32_t i0 = leafMesh.Indices[i];
+                const uint32_t i1 = leafMesh.Indices[i + 1];
+                const uint32_t i2 = leafMesh.Indices[i + 2];
+                if ((i0 < vertexCount) && (i1 < vertexCount) && (i2 < vertexCount))
+                {
+                    samples.RasterizeTriangle(vertices[i0], vertices[i1], vertices[i2]);
+                }
+            }
+        }
+
+        ResolveTile(samples, sampleCount, tile, atlas);
+    }
+}
+
+uint64_t IvyGetLeafImpostorAtlasChecksum(const IvyLeafImpostorAtlas& atlas)
+{
+    IvyGenerationKey checksum;
+    checksum.Add(atlas.TileSize);
+    checksum.Add(atlas.Texels);
+    return checksum.Get();
+}
+
+float IvyGetLeafImpostorAtlasCoverage(const IvyLeafImpostorAtlas& atlas)
+{
+    double coverage = 0.0;
+    for (uint32_t texel : atlas.Texels)
+    {
+        coverage += (texel >> 24) / 255.0;
+    }
+    return atlas.Texels.empty() ? 0.f : static_cast<float>(coverage / atlas.Texels.size());
+}
+
+bool IvyWriteLeafImpostorAtlas(const std::string& path, const IvyLeafImpostorAtlas& atlas, std::string* errorMessage)
+{
+    if ((atlas.TileSize == 0) || (atlas.GetWidth() > 0xffff) || (atlas.Texels.size() != atlas.GetWidth() * atlas.GetHeight()))
+    {
+        return SetError(errorMessage, "invalid atlas");
+    }
+
+    // Uncompressed true color with 8 bits of alpha, rows from bottom to top
+    uint8_t header[tgaHeaderSize] = {};
+    header[2]                     = 2;
+    header[12]                    = static_cast<uint8_t>(atlas.GetWidth() & 0xff);
+    header[13]                    = static_cast<uint8_t>(atlas.GetWidth() >> 8);
+    header[14]                    = static_cast<uint8_t>(atlas.GetHeight() & 0xff);
+    header[15]                    = static_cast<uint8_t>(atlas.GetHeight() >> 8);
+    header[16]                    = 32;
+    header[17]                    = 8;
+
+    // TGA stores BGRA
+    std::vector<uint8_t> pixels(4 * atlas.Texels.size());
+    for (size_t i = 0; i < atlas.Texels.size(); ++i)
+    {
+        const uint32_t texel = atlas.Texels[i];
+        pixels[4 * i]        = static_cast<uint8_t>(texel >> 16);
+        pixels[4 * i + 1]    = static_cast<uint8_t>(texel >> 8);
+        pixels[4 * i + 2]    = static_cast<uint8_t>(texel);
+        pixels[4 * i + 3]    = static_cast<uint8_t>(texel >> 24);
+    }
+
+    std::ofstream file(path, std::ios::binary);
+    file.write(reinterpret_cast<const char*>(header), sizeof(header));
+    file.write(reinterpret_cast<const char*>(pixels.data()), pixels.size());
+    if (!file)
+    {
+        return SetError(errorMessage, "cannot write " + path);
+    }
+    return true;
+}
+
+bool IvyReadLeafImpostorAtlas(const std::string& path, IvyLeafImpostorAtlas& atlas, std::string* errorMessage)
+{
+    std::ifstream file(path, std::ios::binary);
+    if (!file)
+    {
+        return SetError(errorMessage, "cannot open " + path);
+    }
+
+    uint8_t header[tgaHeaderSize] = {};
+    file.read(reinterpret_cast<char*>(header), sizeof(header));
+
+    // Only the files of IvyWriteLeafImpostorAtlas are accepted
+    const uint32_t width  = header[12] | (header[13] << 8);
+    const uint32_t height = header[14] | (header[15] << 8);
+    if (!file || (header[0] != 0) || (header[1] != 0) || (header[2] != 2) || (header[16] != 32) || (header[17] != 8) || (height == 0) ||
+        (width != height * IVY_LEAF_IMPOSTOR_TILES))
+    {
+        return SetError(errorMessage, path + " is not a leaf impostor atlas");
+    }
+
+    std::vector<uint8_t> pixels(4 * width * height);
+    file.read(reinterpret_cast<char*>(pixels.data()), pixels.size());
+    if (!file)
+    {
+        return SetError(errorMessage, path + " is truncated");
+    }
+
+    atlas.TileSize = height;
+    atlas.Texels.resize(width * height);
+    for (size_t i = 0; i < atlas.Texels.size(); ++i)
+    {
+        atlas.Texels[i] = pixels[4 * i + 2] | (pixels[4 * i + 1] << 8) | (pixels[4 * i] << 16) | (static_cast<uint32_t>(pixels[4 * i + 3]) << 24);
+    }
+    return true;
+}
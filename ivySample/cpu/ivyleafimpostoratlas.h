@@ -0,0 +1,86 @@
+// This file is part of the AMD Work Graph Ivy Generation Sample.
+//
+// Copyright (c) 2024 Advanced Micro Devices, Inc. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+#pragma once
+
+// Offline bake of the leaf impostor atlas, which textures the impostor quads of distant leaf clusters (see shaders/ivyleafimpostor.h).
+// Each tile shows IVY_LEAF_IMPOSTOR_GROUP_SIZE leaves of the leaf mesh, placed with deterministic random positions & rotations
+// in the frame of a quad, and rasterized orthographically along the quad normal on the CPU.
+// Does not depend on the math types of the CPU engine, so the sample bakes the atlas at content load
+// (see IvyRenderModule::LoadLeafImpostorAtlas), IvyBake --impostor-atlas writes it to a file and IvyBenchmark --leaf-impostors checks it.
+
+#include "cpu/ivymeshdata.h"
+#include "shaders/ivycommon.h"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+struct IvyLeafImpostorAtlasSettings
+{
+    uint32_t TileSize  = 64;     // texels per side of a tile
+    uint32_t Samples   = 2;      // samples per texel & side
+    float    LeafScale = 0.35f;  // bounding sphere radius of a leaf relative to the half extent of a tile
+    uint32_t Seed      = 0;      // of the leaf placement
+};
+
+/**
+ * @brief   IVY_LEAF_IMPOSTOR_TILES tiles side by side, row 0 is the -axisV edge of the quads.
+ *          Each texel packs the normal in the quad frame (axisU, axisV, normal) as rgb = normal * 0.5 + 0.5 and the coverage as
+ *          alpha, 8 bits each with red in the lowest byte (R8G8B8A8_UNORM).
+ */
+struct IvyLeafImpostorAtlas
+{
+    uint32_t              TileSize = 0;
+    std::vector<uint32_t> Texels;
+
+    uint32_t GetWidth() const
+    {
+        return TileSize * IVY_LEAF_IMPOSTOR_TILES;
+    }
+
+    uint32_t GetHeight() const
+    {
+        return TileSize;
+    }
+};
+
+/**
+ * @brief   Bakes the atlas from the leaf mesh, the result only depends on the mesh & the settings.
+ */
+void IvyBakeLeafImpostorAtlas(const IvyMeshData& leafMesh, const IvyLeafImpostorAtlasSettings& settings, IvyLeafImpostorAtlas& atlas);
+
+/**
+ * @brief   64 bit FNV-1a of the size & texels, identical for identical bakes.
+ */
+uint64_t IvyGetLeafImpostorAtlasChecksum(const IvyLeafImpostorAtlas& atlas);
+
+/**
+ * @brief   Mean coverage of the texels.
+ */
+float IvyGetLeafImpostorAtlasCoverage(const IvyLeafImpostorAtlas& atlas);
+
+/**
+ * @brief   Writes & reads the atlas as uncompressed 32 bit TGA file. Return false and set errorMessage (if provided) on failure.
+ */
+bool IvyWriteLeafImpostorAtlas(const std::string& path, const IvyLeafImpostorAtlas& atlas, std::string* errorMessage = nullptr);
+bool IvyReadLeafImpostorAtlas(const std::string& path, IvyLeafImpostorAtlas& atlas, std::string* errorMessage = nullptr);
@@ -0,0 +1,143 @@
+// This file is part of the AMD Work Graph Ivy Generation Sample.
+//
+// Copyright (c) 2024 Advanced Micro Devices, Inc. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+#include "cpu/ivyleafimpostors.h"
+
+#include "cpu/affinemath.h"
+#include "shaders/ivyinstanceculling.h"
+
+#include <algorithm>
+#include <cmath>
+
+// Tree reduction of a group like BuildClusters, lanes beyond the instances of the group add zero
+static float3 ReduceGroup(float3 (&values)[IVY_LEAF_IMPOSTOR_GROUP_SIZE])
+{
+    for (uint32_t stride = IVY_LEAF_IMPOSTOR_GROUP_SIZE / 2; stride > 0; stride /= 2)
+    {
+        for (uint32_t lane = 0; lane < stride; ++lane)
+        {
+            values[lane] = values[lane] + values[lane + stride];
+        }
+    }
+    return values[0];
+}
+
+void IvyBuildLeafImpostorQuads(const std::vector<IvyInstanceData>&    instances,
+                               const float4&                          localSphere,
+                               const std::vector<IvyInstanceCluster>& clusters,
+                               std::vector<IvyLeafImpostorQuad>&      quads)
+{
+    quads.clear();
+    for (const IvyInstanceCluster& cluster : clusters)
+    {
+        for (uint32_t group = 0; group < IVY_LEAF_IMPOSTOR_QUADS; ++group)
+        {
+            const uint32_t groupFirst = group * IVY_LEAF_IMPOSTOR_GROUP_SIZE;
+            const uint32_t groupCount = (cluster.instanceCount > groupFirst) ? std::min(cluster.instanceCount - groupFirst, static_cast<uint32_t>(IVY_LEAF_IMPOSTOR_GROUP_SIZE)) : 0;
+
+            float4 spheres[IVY_LEAF_IMPOSTOR_GROUP_SIZE];
+            float3 centers[IVY_LEAF_IMPOSTOR_GROUP_SIZE];
+            float3 normals[IVY_LEAF_IMPOSTOR_GROUP_SIZE];
+            float3 tangents[IVY_LEAF_IMPOSTOR_GROUP_SIZE];
+            for (uint32_t lane = 0; lane < groupCount; ++lane)
+            {
+                const float3x4 transform = Affine::ToFloat3x4(instances[cluster.firstInstance + groupFirst + lane].transform);
+
+                spheres[lane]  = IvyGetInstanceBoundingSphere(transform, localSphere);
+                centers[lane]  = spheres[lane].xyz();
+                normals[lane]  = IvyGetLeafImpostorAxis(transform, 1);
+                tangents[lane] = IvyGetLeafImpostorAxis(transform, 0);
+            }
+
+            const float3 center = ReduceGroup(centers) / static_cast<float>(std::max(groupCount, 1u));
+            const float3 normal = IvyGetLeafImpostorNormal(ReduceGroup(normals));
+            const float3 axisU  = IvyGetLeafImpostorAxisU(normal, ReduceGroup(tangents));
+            const float3 axisV  = cross(axisU, normal);
+
+            float2 extent(0.f, 0.f);
+            for (uint32_t lane = 0; lane < groupCount; ++lane)
+            {
+                const float2 leafExtent = IvyGetLeafImpostorExtent(spheres[lane], center, axisU, axisV);
+                extent.x                = std::max(extent.x, leafExtent.x);
+                extent.y                = std::max(extent.y, leafExtent.y);
+            }
+
+            quads.push_back(IvyMakeLeafImpostorQuad(center, normal, axisU, extent, cluster.firstInstance + groupFirst, groupCount));
+        }
+    }
+}
+
+bool IvyValidateLeafImpostorQuads(const std::vector<IvyInstanceData>&     instances,
+                                  const float4&                           localSphere,
+                                  const std::vector<IvyInstanceCluster>&  clusters,
+                                  const std::vector<IvyLeafImpostorQuad>& quads)
+{
+    // Rounding of the axes & extents, relative to their length
+    const float tolerance = 1e-4f;
+
+    if (quads.size() != clusters.size() * IVY_LEAF_IMPOSTOR_QUADS)
+    {
+        return false;
+    }
+
+    for (size_t c = 0; c < clusters.size(); ++c)
+    {
+        const IvyInstanceCluster& cluster      = clusters[c];
+        uint32_t                  clusterCount = 0;
+        for (uint32_t group = 0; group < IVY_LEAF_IMPOSTOR_QUADS; ++group)
+        {
+            const IvyLeafImpostorQuad& quad = quads[c * IVY_LEAF_IMPOSTOR_QUADS + group];
+            clusterCount += quad.instanceCount;
+            if ((quad.instanceCount == 0) || (quad.tile >= IVY_LEAF_IMPOSTOR_TILES))
+            {
+                continue;
+            }
+
+            const float3 center(quad.center[0], quad.center[1], quad.center[2]);
+            const float3 axisU(quad.axisU[0], quad.axisU[1], quad.axisU[2]);
+            const float3 axisV(quad.axisV[0], quad.axisV[1], quad.axisV[2]);
+            const float  extentU = length(axisU);
+            const float  extentV = length(axisV);
+            if (!(extentU > 0.f) || !(extentV > 0.f) || (std::fabs(dot(axisU, axisV)) > tolerance * extentU * extentV))
+            {
+                return false;
+            }
+
+            const uint32_t first = cluster.firstInstance + group * IVY_LEAF_IMPOSTOR_GROUP_SIZE;
+            for (uint32_t i = first; i < first + quad.instanceCount; ++i)
+            {
+                const float4 sphere = IvyGetInstanceBoundingSphere(Affine::ToFloat3x4(instances[i].transform), localSphere);
+                const float3 offset = sphere.xyz() - center;
+                if ((std::fabs(dot(offset, axisU / extentU)) + sphere.w > extentU * (1.f + tolerance)) ||
+                    (std::fabs(dot(offset, axisV / extentV)) + sphere.w > extentV * (1.f + tolerance)))
+                {
+                    return false;
+                }
+            }
+        }
+        if (clusterCount != cluster.instanceCount)
+        {
+            return false;
+        }
+    }
+    return true;
+}
@@ -0,0 +1,51 @@
+// This file is part of the AMD Work Graph Ivy Generation Sample.
+//
+// Copyright (c) 2024 Advanced Micro Devices, Inc. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+#pragma once
+
+// CPU reference of the leaf impostor quads built by BuildClusters (shaders/ivyinstanceculling.hlsl), using the functions of
+// shaders/ivyleafimpostor.h. The clusters beyond the impostor distance are selected by IvyCullInstanceClusters.
+
+#include "cpu/hlslmath.h"
+#include "cpu/ivycpuengine.h"
+#include "shaders/ivycommon.h"
+#include "shaders/ivyleafimpostor.h"
+
+#include <cstdint>
+#include <vector>
+
+/**
+ * @brief   IVY_LEAF_IMPOSTOR_QUADS quads per cluster of leaf instances, with the sums in the order of the group reduction of BuildClusters.
+ */
+void IvyBuildLeafImpostorQuads(const std::vector<IvyInstanceData>&    instances,
+                               const float4&                          localSphere,
+                               const std::vector<IvyInstanceCluster>& clusters,
+                               std::vector<IvyLeafImpostorQuad>&      quads);
+
+/**
+ * @brief   Checks that the quads have orthogonal axes, cover the leaf instances of their cluster once and enclose the
+ *          bounding spheres of their leaves within the quad plane.
+ */
+bool IvyValidateLeafImpostorQuads(const std::vector<IvyInstanceData>&     instances,
+                                  const float4&                           localSphere,
+                                  const std::vector<IvyInstanceCluster>&  clusters,
+                                  const std::vector<IvyLeafImpostorQuad>& quads);
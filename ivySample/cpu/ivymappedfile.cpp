@@ -0,0 +1,141 @@
+// This file is part of the AMD Work Graph Ivy Generation Sample.
+//
+// Copyright (c) 2024 Advanced Micro Devices, Inc. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+#include "cpu/ivymappedfile.h"
+
+#if defined(_WIN32)
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif  // _WIN32
+
+static bool SetError(std::string* errorMessage, const std::string& error)
+{
+    if (errorMessage)
+    {
+        *errorMessage = error;
+    }
+    return false;
+}
+
+IvyMappedFile::~IvyMappedFile()
+{
+    Close();
+}
+
+bool IvyMappedFile::Open(const std::string& path, std::string* errorMessage)
+{
+    Close();
+
+#if defined(_WIN32)
+    HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE)
+    {
+        return SetError(errorMessage, "cannot open " + path);
+    }
+
+    LARGE_INTEGER fileSize;
+    HANDLE        mapping = nullptr;
+    const void*   data    = nullptr;
+    if (GetFileSizeEx(file, &fileSize) && (fileSize.QuadPart > 0))
+    {
+        mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        data    = mapping ? MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0) : nullptr;
+    }
+    if (!data)
+    {
+        if (mapping)
+        {
+            CloseHandle(mapping);
+        }
+        CloseHandle(file);
+        return SetError(errorMessage, "cannot map " + path);
+    }
+
+    m_FileHandle    = file;
+    m_MappingHandle = mapping;
+    m_pData         = static_cast<const uint8_t*>(data);
+    m_Size          = static_cast<size_t>(fileSize.QuadPart);
+#else
+    const int file = open(path.c_str(), O_RDONLY);
+    if (file < 0)
+    {
+        return SetError(errorMessage, "cannot open " + path);
+    }
+
+    struct stat fileStatus;
+    void*       data = MAP_FAILED;
+    if ((fstat(file, &fileStatus) == 0) && (fileStatus.st_size > 0))
+    {
+        data = mmap(nullptr, static_cast<size_t>(fileStatus.st_size), PROT_READ, MAP_PRIVATE, file, 0);
+    }
+    // the mapping stays valid after closing the file
+    close(file);
+
+    if (data == MAP_FAILED)
+    {
+        return SetError(errorMessage, "cannot map " + path);
+    }
+
+    m_pData = static_cast<const uint8_t*>(data);
+    m_Size  = static_cast<size_t>(fileStatus.st_size);
+#endif  // _WIN32
+
+    return true;
+}
+
+void IvyMappedFile::Close()
+{
+#if defined(_WIN32)
+    if (m_pData)
+    {
+        UnmapViewOfFile(m_pData);
+    }
+    if (m_MappingHandle)
+    {
+        CloseHandle(m_MappingHandle);
+    }
+    if (m_FileHandle)
+    {
+        CloseHandle(m_FileHandle);
+    }
+    m_FileHandle    = nullptr;
+    m_MappingHandle = nullptr;
+#else
+    if (m_pData)
+    {
+        munmap(const_cast<uint8_t*>(m_pData), m_Size);
+    }
+#endif  // _WIN32
+
+    m_pData = nullptr;
+    m_Size  = 0;
+}
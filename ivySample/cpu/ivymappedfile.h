@@ -0,0 +1,73 @@
+// This file is part of the AMD Work Graph Ivy Generation Sample.
+//
+// Copyright (c) 2024 Advanced Micro Devices, Inc. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+#pragma once
+
+// Cauldron-free, compiled into IvySample as well as IvyCpu.
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+/**
+ * @brief   Read-only memory mapping of a whole file.
+ *
+ * Pages are only read from disk when they are accessed, so large files can be mapped without becoming resident.
+ */
+class IvyMappedFile
+{
+public:
+    IvyMappedFile() = default;
+    ~IvyMappedFile();
+
+    IvyMappedFile(const IvyMappedFile&)            = delete;
+    IvyMappedFile& operator=(const IvyMappedFile&) = delete;
+
+    /**
+     * @brief   Maps the file. Returns false and sets errorMessage (if provided) on failure, empty files cannot be mapped.
+     */
+    bool Open(const std::string& path, std::string* errorMessage = nullptr);
+    void Close();
+
+    bool IsOpen() const
+    {
+        return m_pData != nullptr;
+    }
+
+    const uint8_t* GetData() const
+    {
+        return m_pData;
+    }
+
+    size_t GetSize() const
+    {
+        return m_Size;
+    }
+
+private:
+    const uint8_t* m_pData = nullptr;
+    size_t         m_Size  = 0;
+#if defined(_WIN32)
+    void* m_FileHandle    = nullptr;
+    void* m_MappingHandle = nullptr;
+#endif  // _WIN32
+};
@@ -0,0 +1,570 @@
+// This file is part of the AMD Work Graph Ivy Generation Sample.
+//
+// Copyright (c) 2024 Advanced Micro Devices, Inc. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+#include "cpu/ivymeshsimplifier.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <functional>
+#include <map>
+#include <queue>
+#include <tuple>
+
+namespace
+{
+    struct Vector3
+    {
+        double x = 0.0;
+        double y = 0.0;
+        double z = 0.0;
+    };
+
+    Vector3 operator+(const Vector3& a, const Vector3& b)
+    {
+        return Vector3{a.x + b.x, a.y + b.y, a.z + b.z};
+    }
+    Vector3 operator-(const Vector3& a, const Vector3& b)
+    {
+        return Vector3{a.x - b.x, a.y - b.y, a.z - b.z};
+    }
+    Vector3 operator*(const Vector3& a, double s)
+    {
+        return Vector3{a.x * s, a.y * s, a.z * s};
+    }
+    double Dot(const Vector3& a, const Vector3& b)
+    {
+        return a.x * b.x + a.y * b.y + a.z * b.z;
+    }
+    Vector3 Cross(const Vector3& a, const Vector3& b)
+    {
+        return Vector3{a.y * b.z - a.z * b.y, a.z * b.x - a.x * b.z, a.x * b.y - a.y * b.x};
+    }
+    double Length(const Vector3& a)
+    {
+        return std::sqrt(Dot(a, a));
+    }
+
+    Vector3 GetVector(const std::vector<float>& values, uint32_t index)
+    {
+        return Vector3{values[index * 3], values[index * 3 + 1], values[index * 3 + 2]};
+    }
+
+    // Sum of the squared distances to a set of planes, symmetric 4x4 matrix (upper triangle)
+    struct Quadric
+    {
+        double m[10] = {};
+
+        static Quadric FromPlane(const Vector3& normal, double distance, double weight)
+        {
+            const double plane[4] = {normal.x, normal.y, normal.z, distance};
+
+            Quadric quadric;
+            for (int row = 0, i = 0; row < 4; ++row)
+            {
+                for (int column = row; column < 4; ++column, ++i)
+                {
+                    quadric.m[i] = plane[row] * plane[column] * weight;
+                }
+            }
+            return quadric;
+        }
+
+        void Add(const Quadric& other)
+        {
+            for (int i = 0; i < 10; ++i)
+            {
+                m[i] += other.m[i];
+            }
+        }
+
+        double Evaluate(const Vector3& p) const
+        {
+            return m[0] * p.x * p.x + 2 * m[1] * p.x * p.y + 2 * m[2] * p.x * p.z + 2 * m[3] * p.x + m[4] * p.y * p.y + 2 * m[5] * p.y * p.z +
+                   2 * m[6] * p.y + m[7] * p.z * p.z + 2 * m[8] * p.z + m[9];
+        }
+    };
+
+    // Moves the welded vertex From onto To
+    struct Collapse
+    {
+        double   Cost;
+        uint32_t From;
+        uint32_t To;
+        uint32_t FromVersion;
+        uint32_t ToVersion;
+
+        // Ties are broken by the vertices, such that the result does not depend on the queue implementation
+        bool operator>(const Collapse& other) const
+        {
+            return std::tie(Cost, From, To) > std::tie(other.Cost, other.From, other.To);
+        }
+    };
+
+    class MeshSimplifier
+    {
+    public:
+        MeshSimplifier(const IvyMeshData& mesh, const std::vector<uint32_t>& indices, float boundaryWeight)
+            : m_Mesh(mesh)
+        {
+            WeldVertices();
+
+            for (size_t i = 0; i + 2 < indices.size(); i += 3)
+            {
+                if ((m_Weld[indices[i]] != m_Weld[indices[i + 1]]) && (m_Weld[indices[i + 1]] != m_Weld[indices[i + 2]]) &&
+                    (m_Weld[indices[i + 2]] != m_Weld[indices[i]]))
+                {
+                    m_Corners.insert(m_Corners.end(), {indices[i], indices[i + 1], indices[i + 2]});
+                }
+            }
+
+            const uint32_t triangleCount = static_cast<uint32_t>(m_Corners.size() / 3);
+            m_TriangleAlive.assign(triangleCount, true);
+            m_AliveTriangles = triangleCount;
+
+            InitQuadrics(boundaryWeight);
+
+            for (uint32_t triangle = 0; triangle < triangleCount; ++triangle)
+            {
+                for (uint32_t corner = 0; corner < 3; ++corner)
+                {
+                    m_VertexTriangles[GetWelded(triangle, corner)].push_back(triangle);
+                }
+            }
+            for (uint32_t vertex = 0; vertex < m_Positions.size(); ++vertex)
+            {
+                PushCollapses(vertex);
+            }
+        }
+
+        void Run(uint32_t targetTriangleCount)
+        {
+            while ((m_AliveTriangles > targetTriangleCount) && !m_Queue.empty())
+            {
+                const Collapse collapse = m_Queue.top();
+                m_Queue.pop();
+
+                if ((collapse.FromVersion != m_Versions[collapse.From]) || (collapse.ToVersion != m_Versions[collapse.To]) || m_Collapsed[collapse.From] ||
+                    m_Collapsed[collapse.To] || FlipsTriangle(collapse.From, collapse.To))
+                {
+                    continue;
+                }
+
+                Apply(collapse.From, collapse.To);
+            }
+        }
+
+        void GetIndices(std::vector<uint32_t>& indices) const
+        {
+            indices.clear();
+            for (uint32_t triangle = 0; triangle < m_TriangleAlive.size(); ++triangle)
+            {
+                if (m_TriangleAlive[triangle])
+                {
+                    indices.insert(indices.end(), m_Corners.begin() + triangle * 3, m_Corners.begin() + triangle * 3 + 3);
+                }
+            }
+        }
+
+    private:
+        uint32_t GetWelded(uint32_t triangle, uint32_t corner) const
+        {
+            return m_Weld[m_Corners[triangle * 3 + corner]];
+        }
+
+        // Vertices with identical positions form one welded vertex
+        void WeldVertices()
+        {
+            const uint32_t vertexCount = static_cast<uint32_t>(m_Mesh.Positions.size() / 3);
+
+            std::map<std::tuple<float, float, float>, uint32_t> positions;
+            m_Weld.resize(vertexCount);
+            for (uint32_t vertex = 0; vertex < vertexCount; ++vertex)
+            {
+                const auto key    = std::make_tuple(m_Mesh.Positions[vertex * 3], m_Mesh.Positions[vertex * 3 + 1], m_Mesh.Positions[vertex * 3 + 2]);
+                const auto result = positions.emplace(key, static_cast<uint32_t>(m_Positions.size()));
+                if (result.second)
+                {
+                    m_Positions.push_back(GetVector(m_Mesh.Positions, vertex));
+                    m_Members.emplace_back();
+                }
+                m_Weld[vertex] = result.first->second;
+                m_Members[m_Weld[vertex]].push_back(vertex);
+            }
+
+            m_Quadrics.resize(m_Positions.size());
+            m_VertexTriangles.resize(m_Positions.size());
+            m_Versions.assign(m_Positions.size(), 0);
+            m_Collapsed.assign(m_Positions.size(), false);
+        }
+
+        Vector3 GetTriangleNormal(uint32_t triangle) const
+        {
+            const Vector3& p0 = m_Positions[GetWelded(triangle, 0)];
+            const Vector3& p1 = m_Positions[GetWelded(triangle, 1)];
+            const Vector3& p2 = m_Positions[GetWelded(triangle, 2)];
+            return Cross(p1 - p0, p2 - p0);
+        }
+
+        // Planes of the triangles, and planes through the open edges perpendicular to their triangle
+        void InitQuadrics(float boundaryWeight)
+        {
+            std::map<std::pair<uint32_t, uint32_t>, uint32_t> edgeTriangles;
+            for (uint32_t triangle = 0; triangle < m_TriangleAlive.size(); ++triangle)
+            {
+                for (uint32_t corner = 0; corner < 3; ++corner)
+                {
+                    const uint32_t a = GetWelded(triangle, corner);
+                    const uint32_t b = GetWelded(triangle, (corner + 1) % 3);
+                    ++edgeTriangles[std::make_pair(std::min(a, b), std::max(a, b))];
+                }
+            }
+
+            for (uint32_t triangle = 0; triangle < m_TriangleAlive.size(); ++triangle)
+            {
+                const Vector3 normal       = GetTriangleNormal(triangle);
+                const double  normalLength = Length(normal);
+                if (normalLength <= 0.0)
+                {
+                    continue;
+                }
+                const Vector3 unitNormal = normal * (1.0 / normalLength);
+                const Quadric plane      = Quadric::FromPlane(unitNormal, -Dot(unitNormal, m_Positions[GetWelded(triangle, 0)]), 1.0);
+
+                for (uint32_t corner = 0; corner < 3; ++corner)
+                {
+                    const uint32_t a = GetWelded(triangle, corner);
+                    const uint32_t b = GetWelded(triangle, (corner + 1) % 3);
+                    m_Quadrics[a].Add(plane);
+
+                    if (edgeTriangles[std::make_pair(std::min(a, b), std::max(a, b))] == 1)
+                    {
+                        const Vector3 edgeNormal       = Cross(m_Positions[b] - m_Positions[a], unitNormal);
+                        const double  edgeNormalLength = Length(edgeNormal);
+                        if (edgeNormalLength > 0.0)
+                        {
+                            const Vector3 unitEdgeNormal = edgeNormal * (1.0 / edgeNormalLength);
+                            const Quadric edgePlane      = Quadric::FromPlane(unitEdgeNormal, -Dot(unitEdgeNormal, m_Positions[a]), boundaryWeight);
+                            m_Quadrics[a].Add(edgePlane);
+                            m_Quadrics[b].Add(edgePlane);
+                        }
+                    }
+                }
+            }
+        }
+
+        // Queues the collapses of all edges of a vertex in both directions
+        void PushCollapses(uint32_t vertex)
+        {
+            for (uint32_t triangle : m_VertexTriangles[vertex])
+            {
+                if (!m_TriangleAlive[triangle])
+                {
+                    continue;
+                }
+                for (uint32_t corner = 0; corner < 3; ++corner)
+                {
+                    const uint32_t neighbour = GetWelded(triangle, corner);
+                    if (neighbour != vertex)
+                    {
+                        PushCollapse(vertex, neighbour);
+                        PushCollapse(neighbour, vertex);
+                    }
+                }
+            }
+        }
+
+        void PushCollapse(uint32_t from, uint32_t to)
+        {
+            Quadric quadric = m_Quadrics[from];
+            quadric.Add(m_Quadrics[to]);
+
+            m_Queue.push(Collapse{std::max(quadric.Evaluate(m_Positions[to]), 0.0), from, to, m_Versions[from], m_Versions[to]});
+        }
+
+        // Rejects collapses that turn a remaining triangle by more than ~75 degrees
+        bool FlipsTriangle(uint32_t from, uint32_t to) const
+        {
+            const double minCosine = 0.25;
+
+            for (uint32_t triangle : m_VertexTriangles[from])
+            {
+                if (!m_TriangleAlive[triangle])
+                {
+                    continue;
+                }
+
+                Vector3 positions[3];
+                bool    removed = false;
+                for (uint32_t corner = 0; corner < 3; ++corner)
+                {
+                    const uint32_t vertex = GetWelded(triangle, corner);
+                    removed               = removed || (vertex == to);
+                    positions[corner]     = m_Positions[(vertex == from) ? to : vertex];
+                }
+                if (removed)
+                {
+                    continue;
+                }
+
+                const Vector3 before = GetTriangleNormal(triangle);
+                const Vector3 after  = Cross(positions[1] - positions[0], positions[2] - positions[0]);
+                if (Dot(before, after) <= minCosine * Length(before) * Length(after))
+                {
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        // Vertex of the welded vertex to with the normal closest to the one of vertex
+        uint32_t GetClosestMember(uint32_t to, uint32_t vertex) const
+        {
+            const std::vector<uint32_t>& members = m_Members[to];
+            if (m_Mesh.Normals.empty())
+            {
+                return members.front();
+            }
+
+            const Vector3 normal     = GetVector(m_Mesh.Normals, vertex);
+            uint32_t      closest    = members.front();
+            double        maxCosine  = -DBL_MAX;
+            for (uint32_t member : members)
+            {
+                const double cosine = Dot(normal, GetVector(m_Mesh.Normals, member));
+                if (cosine > maxCosine)
+                {
+                    maxCosine = cosine;
+                    closest   = member;
+                }
+            }
+            return closest;
+        }
+
+        void Apply(uint32_t from, uint32_t to)
+        {
+            for (uint32_t triangle : m_VertexTriangles[from])
+            {
+                if (!m_TriangleAlive[triangle])
+                {
+                    continue;
+                }
+
+                bool removed = false;
+                for (uint32_t corner = 0; corner < 3; ++corner)
+                {
+                    removed = removed || (GetWelded(triangle, corner) == to);
+                }
+                if (removed)
+                {
+                    m_TriangleAlive[triangle] = false;
+                    --m_AliveTriangles;
+                    continue;
+                }
+
+                for (uint32_t corner = 0; corner < 3; ++corner)
+                {
+                    uint32_t& vertex = m_Corners[triangle * 3 + corner];
+                    if (m_Weld[vertex] == from)
+                    {
+                        vertex = GetClosestMember(to, vertex);
+                    }
+                }
+                m_VertexTriangles[to].push_back(triangle);
+            }
+
+            m_Quadrics[to].Add(m_Quadrics[from]);
+            m_Collapsed[from] = true;
+            ++m_Versions[from];
+            ++m_Versions[to];
+
+            PushCollapses(to);
+        }
+
+        const IvyMeshData&                   m_Mesh;
+        std::vector<uint32_t>                m_Weld;     // welded vertex of each vertex
+        std::vector<std::vector<uint32_t>>   m_Members;  // vertices of each welded vertex
+        std::vector<Vector3>                 m_Positions;
+        std::vector<Quadric>                 m_Quadrics;
+        std::vector<std::vector<uint32_t>>   m_VertexTriangles;
+        std::vector<uint32_t>                m_Versions;  // invalidates queued collapses of changed vertices
+        std::vector<bool>                    m_Collapsed;
+        std::vector<uint32_t>                m_Corners;  // 3 vertices per triangle
+        std::vector<bool>                    m_TriangleAlive;
+        uint32_t                             m_AliveTriangles = 0;
+        std::priority_queue<Collapse, std::vector<Collapse>, std::greater<Collapse>> m_Queue;
+    };
+
+    // Closest point on a triangle, see Ericson, Real-Time Collision Detection, 5.1.5
+    Vector3 GetClosestPointOnTriangle(const Vector3& p, const Vector3& a, const Vector3& b, const Vector3& c)
+    {
+        const Vector3 ab = b - a;
+        const Vector3 ac = c - a;
+        const Vector3 ap = p - a;
+        const double  d1 = Dot(ab, ap);
+        const double  d2 = Dot(ac, ap);
+        if ((d1 <= 0.0) && (d2 <= 0.0))
+        {
+            return a;
+        }
+
+        const Vector3 bp = p - b;
+        const double  d3 = Dot(ab, bp);
+        const double  d4 = Dot(ac, bp);
+        if ((d3 >= 0.0) && (d4 <= d3))
+        {
+            return b;
+        }
+
+        const double vc = d1 * d4 - d3 * d2;
+        if ((vc <= 0.0) && (d1 >= 0.0) && (d3 <= 0.0))
+        {
+            return a + ab * (d1 / (d1 - d3));
+        }
+
+        const Vector3 cp = p - c;
+        const double  d5 = Dot(ab, cp);
+        const double  d6 = Dot(ac, cp);
+        if ((d6 >= 0.0) && (d5 <= d6))
+        {
+            return c;
+        }
+
+        const double vb = d5 * d2 - d1 * d6;
+        if ((vb <= 0.0) && (d2 >= 0.0) && (d6 <= 0.0))
+        {
+            return a + ac * (d2 / (d2 - d6));
+        }
+
+        const double va = d3 * d6 - d5 * d4;
+        if ((va <= 0.0) && ((d4 - d3) >= 0.0) && ((d5 - d6) >= 0.0))
+        {
+            return b + (c - b) * ((d4 - d3) / ((d4 - d3) + (d5 - d6)));
+        }
+
+        const double denominator = 1.0 / (va + vb + vc);
+        return a + ab * (vb * denominator) + ac * (vc * denominator);
+    }
+
+    // Appends the vertices referenced by indices in the order of their first use
+    void AppendLod(const IvyMeshData& mesh, const std::vector<uint32_t>& indices, float error, IvyMeshLodChain& chain)
+    {
+        IvyMeshLod lod;
+        lod.FirstIndex = static_cast<uint32_t>(chain.Indices.size());
+        lod.IndexCount = static_cast<uint32_t>(indices.size());
+        lod.BaseVertex = static_cast<uint32_t>(chain.Positions.size() / 3);
+        lod.Error      = error;
+
+        std::vector<uint32_t> remap(mesh.Positions.size() / 3, ~0u);
+        for (uint32_t index : indices)
+        {
+            if (remap[index] == ~0u)
+            {
+                remap[index] = lod.VertexCount++;
+                chain.Positions.insert(chain.Positions.end(), mesh.Positions.begin() + index * 3, mesh.Positions.begin() + index * 3 + 3);
+                if (!mesh.Normals.empty())
+                {
+                    chain.Normals.insert(chain.Normals.end(), mesh.Normals.begin() + index * 3, mesh.Normals.begin() + index * 3 + 3);
+                }
+            }
+            chain.Indices.push_back(remap[index]);
+        }
+        chain.Lods.push_back(lod);
+    }
+}  // namespace
+
+uint32_t IvySimplifyMesh(const IvyMeshData&           mesh,
+                         const std::vector<uint32_t>& indices,
+                         uint32_t                     targetTriangleCount,
+                         float                        boundaryWeight,
+                         std::vector<uint32_t>&       simplifiedIndices)
+{
+    MeshSimplifier simplifier(mesh, indices, boundaryWeight);
+    simplifier.Run(targetTriangleCount);
+    simplifier.GetIndices(simplifiedIndices);
+
+    return static_cast<uint32_t>(simplifiedIndices.size() / 3);
+}
+
+float IvyMeasureSimplificationError(const IvyMeshData& mesh, const std::vector<uint32_t>& simplifiedIndices)
+{
+    if (simplifiedIndices.empty())
+    {
+        return mesh.Indices.empty() ? 0.f : FLT_MAX;
+    }
+
+    std::vector<Vector3> points;
+    for (size_t i = 0; i + 2 < mesh.Indices.size(); i += 3)
+    {
+        const Vector3 p0 = GetVector(mesh.Positions, mesh.Indices[i]);
+        const Vector3 p1 = GetVector(mesh.Positions, mesh.Indices[i + 1]);
+        const Vector3 p2 = GetVector(mesh.Positions, mesh.Indices[i + 2]);
+        points.insert(points.end(), {p0, p1, p2, (p0 + p1 + p2) * (1.0 / 3.0)});
+    }
+
+    double maxDistance = 0.0;
+    for (const Vector3& point : points)
+    {
+        double minDistance = DBL_MAX;
+        for (size_t i = 0; i + 2 < simplifiedIndices.size(); i += 3)
+        {
+            const Vector3 closest = GetClosestPointOnTriangle(point,
+                                                              GetVector(mesh.Positions, simplifiedIndices[i]),
+                                                              GetVector(mesh.Positions, simplifiedIndices[i + 1]),
+                                                              GetVector(mesh.Positions, simplifiedIndices[i + 2]));
+            minDistance           = std::min(minDistance, Length(point - closest));
+        }
+        maxDistance = std::max(maxDistance, minDistance);
+    }
+    return static_cast<float>(maxDistance);
+}
+
+void IvyBuildMeshLodChain(const IvyMeshData& mesh, const IvyMeshLodSettings& settings, IvyMeshLodChain& chain)
+{
+    // LODs that remove less than this fraction of the triangles of the previous LOD are not worth a draw
+    const float minReduction = 0.1f;
+
+    chain = IvyMeshLodChain();
+
+    std::vector<uint32_t> lodIndices = mesh.Indices;
+    std::vector<uint32_t> simplifiedIndices;
+    float                 error = 0.f;
+    for (uint32_t lod = 0; lod < std::min(settings.LodCount, static_cast<uint32_t>(IVY_MAX_MESH_LODS)); ++lod)
+    {
+        if (lod > 0)
+        {
+            const uint32_t triangleCount = static_cast<uint32_t>(lodIndices.size() / 3);
+            const uint32_t target        = std::max(static_cast<uint32_t>(triangleCount * settings.TriangleRatio), 1u);
+
+            const uint32_t simplifiedCount = IvySimplifyMesh(mesh, lodIndices, target, settings.BoundaryWeight, simplifiedIndices);
+            if ((simplifiedCount == 0) || (simplifiedCount > triangleCount * (1.f - minReduction)))
+            {
+                break;
+            }
+
+            lodIndices.swap(simplifiedIndices);
+            error = std::max(error, IvyMeasureSimplificationError(mesh, lodIndices));
+        }
+
+        AppendLod(mesh, lodIndices, error, chain);
+    }
+}
@@ -0,0 +1,88 @@
+// This file is part of the AMD Work Graph Ivy Generation Sample.
+//
+// Copyright (c) 2024 Advanced Micro Devices, Inc. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+#pragma once
+
+// Quadric error mesh simplification (Garland & Heckbert) for the LOD chains of the ivy leaf & stem meshes.
+// Does not depend on the math types of the CPU engine, so the sample builds the LOD chains with it at content load
+// (see IvyRenderModule::LoadMeshLods) and IvyBenchmark --mesh-lods measures them headless.
+
+#include "cpu/ivymeshdata.h"
+#include "shaders/ivycommon.h"
+
+#include <cstdint>
+#include <vector>
+
+/**
+ * @brief   Collapses edges of the triangles in indices (referencing the vertices of mesh) until at most targetTriangleCount
+ *          triangles are left or no edge can be collapsed without flipping a triangle. Vertices with the same position are
+ *          collapsed together, so hard normal edges do not open. Each collapse moves a vertex onto a neighbour, the simplified
+ *          triangles only reference vertices of mesh. Open boundaries are weighted by boundaryWeight to keep the outline.
+ *          Returns the number of simplified triangles.
+ */
+uint32_t IvySimplifyMesh(const IvyMeshData&           mesh,
+                         const std::vector<uint32_t>& indices,
+                         uint32_t                     targetTriangleCount,
+                         float                        boundaryWeight,
+                         std::vector<uint32_t>&       simplifiedIndices);
+
+/**
+ * @brief   Largest distance of the vertices & triangle centers of mesh to the triangles in simplifiedIndices,
+ *          in the units of the mesh positions.
+ */
+float IvyMeasureSimplificationError(const IvyMeshData& mesh, const std::vector<uint32_t>& simplifiedIndices);
+
+struct IvyMeshLodSettings
+{
+    uint32_t LodCount       = IVY_MAX_MESH_LODS;
+    float    TriangleRatio  = 0.5f;  // triangles of a LOD relative to the previous one
+    float    BoundaryWeight = 10.f;
+};
+
+/**
+ * @brief   A LOD within the buffers of an IvyMeshLodChain, the draw arguments of the LOD.
+ */
+struct IvyMeshLod
+{
+    uint32_t FirstIndex  = 0;
+    uint32_t IndexCount  = 0;
+    uint32_t BaseVertex  = 0;
+    uint32_t VertexCount = 0;
+    float    Error       = 0.f;  // see IvyMeasureSimplificationError, never decreases along the chain
+};
+
+/**
+ * @brief   Vertices & indices of all LODs of a mesh, LOD 0 is the unmodified mesh.
+ */
+struct IvyMeshLodChain
+{
+    std::vector<float>      Positions;  // 3 floats per vertex
+    std::vector<float>      Normals;    // 3 floats per vertex
+    std::vector<uint32_t>   Indices;    // relative to IvyMeshLod::BaseVertex
+    std::vector<IvyMeshLod> Lods;
+};
+
+/**
+ * @brief   Simplifies each LOD from the previous one, down to settings.TriangleRatio of its triangles.
+ *          The chain ends early once a LOD cannot be simplified any further.
+ */
+void IvyBuildMeshLodChain(const IvyMeshData& mesh, const IvyMeshLodSettings& settings, IvyMeshLodChain& chain);
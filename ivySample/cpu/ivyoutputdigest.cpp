@@ -0,0 +1,280 @@
+// This file is part of the AMD Work Graph Ivy Generation Sample.
+//
+// Copyright (c) 2024 Advanced Micro Devices, Inc. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+#include "cpu/ivyoutputdigest.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <cinttypes>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+
+// splitmix64 finalizer
+static uint64_t Mix(uint64_t value)
+{
+    value = (value ^ (value >> 30)) * 0xbf58476d1ce4e5b9ull;
+    value = (value ^ (value >> 27)) * 0x94d049bb133111ebull;
+    return value ^ (value >> 31);
+}
+
+static IvyStreamDigest ComputeStreamDigest(const std::vector<IvyInstanceData>& instances)
+{
+    IvyStreamDigest digest;
+    digest.Count = instances.size();
+
+    if (instances.empty())
+    {
+        return digest;
+    }
+
+    double sum[12]       = {};
+    double squareSum[12] = {};
+    digest.OriginMin     = float3(FLT_MAX);
+    digest.OriginMax     = float3(-FLT_MAX);
+
+    for (const IvyInstanceData& instance : instances)
+    {
+        uint64_t hash = 0;
+        for (int row = 0; row < 3; ++row)
+        {
+            for (int column = 0; column < 4; ++column)
+            {
+                const float value = instance.transform.getElem(column, row);
+                const int   index = row * 4 + column;
+
+                // +0 & -0 hash equally
+                hash = Mix(hash ^ ((value == 0.f) ? 0u : asuint(value)));
+
+                sum[index] += value;
+                squareSum[index] += static_cast<double>(value) * value;
+            }
+
+            digest.OriginMin[row] = std::min(digest.OriginMin[row], instance.transform.getElem(3, row));
+            digest.OriginMax[row] = std::max(digest.OriginMax[row], instance.transform.getElem(3, row));
+        }
+
+        digest.Checksum += hash;
+    }
+
+    for (int i = 0; i < 12; ++i)
+    {
+        digest.Mean[i]      = sum[i] / digest.Count;
+        digest.Deviation[i] = std::sqrt(std::max(squareSum[i] / digest.Count - digest.Mean[i] * digest.Mean[i], 0.0));
+    }
+
+    return digest;
+}
+
+IvyOutputDigest IvyOutputDigest::Compute(const IvyInstanceStreams& streams, const IvyCpuEngine::Statistics& statistics)
+{
+    IvyOutputDigest digest;
+    digest.Leaf          = ComputeStreamDigest(streams.LeafInstances);
+    digest.Stem          = ComputeStreamDigest(streams.StemInstances);
+    digest.BranchRecords = statistics.BranchRecords;
+    digest.RayCount      = statistics.RayCount;
+    return digest;
+}
+
+uint64_t IvyOutputDigest::ComputeOrderHash(const IvyInstanceStreams& streams)
+{
+    uint64_t hash = 0;
+    for (const std::vector<IvyInstanceData>* instances : {&streams.LeafInstances, &streams.StemInstances})
+    {
+        hash = Mix(hash ^ instances->size());
+        for (const IvyInstanceData& instance : *instances)
+        {
+            for (int row = 0; row < 3; ++row)
+            {
+                for (int column = 0; column < 4; ++column)
+                {
+                    hash = Mix(hash ^ asuint(instance.transform.getElem(column, row)));
+                }
+            }
+        }
+    }
+    return hash;
+}
+
+static void WriteStreamDigest(IvyJsonWriter& json, const char* key, const IvyStreamDigest& digest)
+{
+    // 64 bit values do not survive a round trip through a JSON number
+    char checksum[32];
+    snprintf(checksum, sizeof(checksum), "%016" PRIx64, digest.Checksum);
+
+    json.BeginObject(key);
+    json.Value("count", digest.Count);
+    json.Value("checksum", checksum);
+    json.BeginArray("mean");
+    for (double mean : digest.Mean)
+    {
+        json.Value(nullptr, mean);
+    }
+    json.EndArray();
+    json.BeginArray("deviation");
+    for (double deviation : digest.Deviation)
+    {
+        json.Value(nullptr, deviation);
+    }
+    json.EndArray();
+    json.BeginArray("origin_min");
+    for (int i = 0; i < 3; ++i)
+    {
+        json.Value(nullptr, static_cast<double>(digest.OriginMin[i]));
+    }
+    json.EndArray();
+    json.BeginArray("origin_max");
+    for (int i = 0; i < 3; ++i)
+    {
+        json.Value(nullptr, static_cast<double>(digest.OriginMax[i]));
+    }
+    json.EndArray();
+    json.EndObject();
+}
+
+void IvyOutputDigest::Write(IvyJsonWriter& json, const char* key) const
+{
+    json.BeginObject(key);
+    json.Value("branch_records", BranchRecords);
+    json.Value("rays", RayCount);
+    WriteStreamDigest(json, "leaf", Leaf);
+    WriteStreamDigest(json, "stem", Stem);
+    json.EndObject();
+}
+
+static bool ReadStreamDigest(const IvyJson& json, IvyStreamDigest& digest)
+{
+    const IvyJson& mean      = json["mean"];
+    const IvyJson& deviation = json["deviation"];
+    const IvyJson& originMin = json["origin_min"];
+    const IvyJson& originMax = json["origin_max"];
+
+    if ((json["count"].GetType() != IvyJson::Type::Number) || (json["checksum"].GetType() != IvyJson::Type::String) || (mean.Size() != 12) ||
+        (deviation.Size() != 12) || (originMin.Size() != 3) || (originMax.Size() != 3))
+    {
+        return false;
+    }
+
+    digest.Count    = static_cast<uint64_t>(json["count"].AsNumber());
+    digest.Checksum = strtoull(json["checksum"].AsString().c_str(), nullptr, 16);
+    for (size_t i = 0; i < 12; ++i)
+    {
+        digest.Mean[i]      = mean[i].AsNumber();
+        digest.Deviation[i] = deviation[i].AsNumber();
+    }
+    for (size_t i = 0; i < 3; ++i)
+    {
+        digest.OriginMin[static_cast<int>(i)] = static_cast<float>(originMin[i].AsNumber());
+        digest.OriginMax[static_cast<int>(i)] = static_cast<float>(originMax[i].AsNumber());
+    }
+    return true;
+}
+
+bool IvyOutputDigest::Read(const IvyJson& json, IvyOutputDigest& digest, std::string* errorMessage)
+{
+    if ((json["branch_records"].GetType() != IvyJson::Type::Number) || (json["rays"].GetType() != IvyJson::Type::Number) ||
+        !ReadStreamDigest(json["leaf"], digest.Leaf) || !ReadStreamDigest(json["stem"], digest.Stem))
+    {
+        if (errorMessage)
+        {
+            *errorMessage = "incomplete output digest";
+        }
+        return false;
+    }
+
+    digest.BranchRecords = static_cast<uint64_t>(json["branch_records"].AsNumber());
+    digest.RayCount      = static_cast<uint64_t>(json["rays"].AsNumber());
+    return true;
+}
+
+static void CompareStreamDigest(const char*               name,
+                                const IvyStreamDigest&    digest,
+                                const IvyStreamDigest&    golden,
+                                double                    tolerance,
+                                bool                      exact,
+                                std::vector<std::string>& differences)
+{
+    char message[256];
+
+    if (digest.Count != golden.Count)
+    {
+        snprintf(message, sizeof(message), "%s count %" PRIu64 ", expected %" PRIu64, name, digest.Count, golden.Count);
+        differences.push_back(message);
+        return;
+    }
+
+    if (digest.Checksum == golden.Checksum)
+    {
+        return;
+    }
+
+    if (exact)
+    {
+        snprintf(message, sizeof(message), "%s checksum %016" PRIx64 ", expected %016" PRIx64, name, digest.Checksum, golden.Checksum);
+        differences.push_back(message);
+        return;
+    }
+
+    auto compare = [&](const char* quantity, int index, double value, double expected) {
+        if (std::abs(value - expected) > tolerance * std::max(1.0, std::abs(expected)))
+        {
+            snprintf(message, sizeof(message), "%s %s[%d] %.9g, expected %.9g", name, quantity, index, value, expected);
+            differences.push_back(message);
+        }
+    };
+
+    for (int i = 0; i < 12; ++i)
+    {
+        compare("mean", i, digest.Mean[i], golden.Mean[i]);
+        compare("deviation", i, digest.Deviation[i], golden.Deviation[i]);
+    }
+    for (int i = 0; i < 3; ++i)
+    {
+        compare("origin_min", i, digest.OriginMin[i], golden.OriginMin[i]);
+        compare("origin_max", i, digest.OriginMax[i], golden.OriginMax[i]);
+    }
+}
+
+bool IvyOutputDigest::Matches(const IvyOutputDigest& golden, double tolerance, bool exact, std::vector<std::string>* differences) const
+{
+    std::vector<std::string>  localDifferences;
+    std::vector<std::string>& result = differences ? *differences : localDifferences;
+
+    const size_t previousCount = result.size();
+
+    char message[256];
+    if (BranchRecords != golden.BranchRecords)
+    {
+        snprintf(message, sizeof(message), "branch records %" PRIu64 ", expected %" PRIu64, BranchRecords, golden.BranchRecords);
+        result.push_back(message);
+    }
+    if (RayCount != golden.RayCount)
+    {
+        snprintf(message, sizeof(message), "rays %" PRIu64 ", expected %" PRIu64, RayCount, golden.RayCount);
+        result.push_back(message);
+    }
+
+    CompareStreamDigest("leaf", Leaf, golden.Leaf, tolerance, exact, result);
+    CompareStreamDigest("stem", Stem, golden.Stem, tolerance, exact, result);
+
+    return result.size() == previousCount;
+}
@@ -0,0 +1,80 @@
+// This file is part of the AMD Work Graph Ivy Generation Sample.
+//
+// Copyright (c) 2024 Advanced Micro Devices, Inc. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+#pragma once
+
+#include "cpu/ivycpuengine.h"
+#include "cpu/ivyjson.h"
+
+#include <string>
+#include <vector>
+
+/**
+ * @brief   Order-independent summary of one instance stream.
+ *
+ * The checksum is the sum of a 64 bit hash of each transform (+0 & -0 hash equally), so it only matches if the
+ * stream holds bit-identical instances in any order. The moments & bounds are used to accept small floating
+ * point differences.
+ */
+struct IvyStreamDigest
+{
+    uint64_t Count         = 0;
+    uint64_t Checksum      = 0;
+    double   Mean[12]      = {};  // per element of the row-major 3x4 transform
+    double   Deviation[12] = {};
+    float3   OriginMin;           // bounds of the instance origins
+    float3   OriginMax;
+};
+
+/**
+ * @brief   Golden output of a generation run: leaf & stem stream digests plus the record & ray counts.
+ *          Written & checked by IvyBenchmark --write-golden / --check-golden.
+ */
+struct IvyOutputDigest
+{
+    IvyStreamDigest Leaf;
+    IvyStreamDigest Stem;
+    uint64_t        BranchRecords = 0;
+    uint64_t        RayCount      = 0;
+
+    static IvyOutputDigest Compute(const IvyInstanceStreams& streams, const IvyCpuEngine::Statistics& statistics);
+
+    /**
+     * @brief   Order-dependent hash of the leaf & stem streams. Only equal for bit-identical instances in the same
+     *          order, used to check IvyCpuEngine::SetDeterministicOrder.
+     */
+    static uint64_t ComputeOrderHash(const IvyInstanceStreams& streams);
+
+    void Write(IvyJsonWriter& json, const char* key) const;
+
+    /**
+     * @brief   Reads a digest written by Write(). Returns false and sets errorMessage (if provided) on missing members.
+     */
+    static bool Read(const IvyJson& json, IvyOutputDigest& digest, std::string* errorMessage = nullptr);
+
+    /**
+     * @brief   Compares against a golden digest. Counts have to match exactly. Moments & bounds may differ by
+     *          tolerance * max(1, |golden value|), unless exact is set, which requires identical checksums.
+     *          Returns false and appends a description of each difference to differences (if provided).
+     */
+    bool Matches(const IvyOutputDigest& golden, double tolerance, bool exact, std::vector<std::string>* differences = nullptr) const;
+};
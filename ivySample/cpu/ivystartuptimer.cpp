@@ -0,0 +1,88 @@
+// This file is part of the AMD Work Graph Ivy Generation Sample.
+//
+// Copyright (c) 2024 Advanced Micro Devices, Inc. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+#include "cpu/ivystartuptimer.h"
+
+#include "cpu/ivyjson.h"
+
+#include <fstream>
+
+IvyStartupTimer::IvyStartupTimer()
+    : m_PhaseStartTime(std::chrono::steady_clock::now())
+{
+}
+
+void IvyStartupTimer::EndPhase(const char* name)
+{
+    const auto now = std::chrono::steady_clock::now();
+
+    Phase phase;
+    phase.Name    = name;
+    phase.Seconds = std::chrono::duration<double>(now - m_PhaseStartTime).count();
+    m_Phases.push_back(phase);
+
+    m_PhaseStartTime = now;
+}
+
+double IvyStartupTimer::GetTotalSeconds() const
+{
+    double totalSeconds = 0.0;
+    for (const Phase& phase : m_Phases)
+    {
+        totalSeconds += phase.Seconds;
+    }
+    return totalSeconds;
+}
+
+void IvyStartupTimer::Write(IvyJsonWriter& json, const char* key) const
+{
+    json.BeginObject(key);
+    json.Value("total_seconds", GetTotalSeconds());
+    json.BeginArray("phases");
+    for (const Phase& phase : m_Phases)
+    {
+        json.BeginObject();
+        json.Value("name", phase.Name);
+        json.Value("seconds", phase.Seconds);
+        json.EndObject();
+    }
+    json.EndArray();
+    json.EndObject();
+}
+
+bool IvyStartupTimer::WriteFile(const std::string& path, std::string* errorMessage) const
+{
+    IvyJsonWriter json;
+    Write(json, nullptr);
+
+    std::ofstream file(path, std::ios::binary);
+    file << json.GetString() << "\n";
+    if (!file)
+    {
+        if (errorMessage)
+        {
+            *errorMessage = "cannot write " + path;
+        }
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,75 @@
+// This file is part of the AMD Work Graph Ivy Generation Sample.
+//
+// Copyright (c) 2024 Advanced Micro Devices, Inc. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+#pragma once
+
+// Cauldron-free, compiled into IvySample as well as IvyCpu.
+
+#include <chrono>
+#include <string>
+#include <vector>
+
+class IvyJsonWriter;
+
+/**
+ * @brief   Wall time of the consecutive phases of a startup, e.g. IvyRenderModule::Init.
+ *
+ * Each EndPhase() closes the phase that began with the previous EndPhase() (or the construction of the timer).
+ * The phases are reported as JSON, such that tools launching the sample repeatedly can track the cold start time.
+ */
+class IvyStartupTimer
+{
+public:
+    struct Phase
+    {
+        std::string Name;
+        double      Seconds = 0.0;
+    };
+
+    IvyStartupTimer();
+
+    /**
+     * @brief   Ends the current phase and starts the next one.
+     */
+    void EndPhase(const char* name);
+
+    const std::vector<Phase>& GetPhases() const
+    {
+        return m_Phases;
+    }
+
+    /**
+     * @brief   Sum of all ended phases.
+     */
+    double GetTotalSeconds() const;
+
+    void Write(IvyJsonWriter& json, const char* key) const;
+
+    /**
+     * @brief   Writes the phases as JSON document. Returns false and sets errorMessage (if provided) on failure.
+     */
+    bool WriteFile(const std::string& path, std::string* errorMessage = nullptr) const;
+
+private:
+    std::chrono::steady_clock::time_point m_PhaseStartTime;
+    std::vector<Phase>                    m_Phases;
+};
@@ -0,0 +1,240 @@
+// This file is part of the AMD Work Graph Ivy Generation Sample.
+//
+// Copyright (c) 2024 Advanced Micro Devices, Inc. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+#include "cpu/ivytaskscheduler.h"
+
+#include <algorithm>
+
+IvyTaskScheduler::IvyTaskScheduler(uint32_t threadCount)
+{
+    if (threadCount == 0)
+    {
+        threadCount = std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    for (uint32_t i = 0; i < threadCount; ++i)
+    {
+        m_Queues.emplace_back(std::make_unique<WorkQueue>());
+    }
+
+    // worker 0 is the thread calling Run()
+    for (uint32_t i = 1; i < threadCount; ++i)
+    {
+        m_Threads.emplace_back(&IvyTaskScheduler::ThreadMain, this, i);
+    }
+}
+
+IvyTaskScheduler::~IvyTaskScheduler()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        m_Exit = true;
+    }
+    m_StartCondition.notify_all();
+
+    for (std::thread& thread : m_Threads)
+    {
+        thread.join();
+    }
+}
+
+void IvyTaskScheduler::Run(std::vector<Task>& tasks)
+{
+    if (tasks.empty())
+    {
+        return;
+    }
+
+    for (auto& queue : m_Queues)
+    {
+        queue->StealCount = 0;
+    }
+
+    // distribute initial tasks round robin
+    m_PendingTasks = tasks.size();
+    for (size_t i = 0; i < tasks.size(); ++i)
+    {
+        WorkQueue&                  queue = *m_Queues[i % m_Queues.size()];
+        std::lock_guard<std::mutex> lock(queue.Mutex);
+        queue.Tasks.push_back(std::move(tasks[i]));
+    }
+    tasks.clear();
+
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        ++m_RunGeneration;
+        m_ActiveThreads = static_cast<uint32_t>(m_Threads.size());
+    }
+    m_StartCondition.notify_all();
+
+    WorkerLoop(0);
+
+    // wait for all other workers to leave the worker loop
+    std::unique_lock<std::mutex> lock(m_Mutex);
+    m_DoneCondition.wait(lock, [this] { return m_ActiveThreads == 0; });
+}
+
+void IvyTaskScheduler::Spawn(uint32_t workerIndex, Task&& task)
+{
+    // increment before the spawning task completes, such that m_PendingTasks never drops to zero early
+    m_PendingTasks.fetch_add(1);
+
+    {
+        WorkQueue&                  queue = *m_Queues[workerIndex];
+        std::lock_guard<std::mutex> lock(queue.Mutex);
+        queue.Tasks.push_back(std::move(task));
+    }
+
+    // an idle worker registers before its last search of the queues, so it either finds the task or sees the new version
+    if (m_IdleWorkers.load() > 0)
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_WorkMutex);
+            m_WorkVersion.fetch_add(1);
+        }
+        m_WorkCondition.notify_one();
+    }
+}
+
+uint64_t IvyTaskScheduler::GetStealCount() const
+{
+    uint64_t stealCount = 0;
+    for (const auto& queue : m_Queues)
+    {
+        stealCount += queue->StealCount;
+    }
+    return stealCount;
+}
+
+void IvyTaskScheduler::ThreadMain(uint32_t workerIndex)
+{
+    uint64_t runGeneration = 0;
+
+    while (true)
+    {
+        {
+            std::unique_lock<std::mutex> lock(m_Mutex);
+            m_StartCondition.wait(lock, [&] { return m_Exit || (m_RunGeneration != runGeneration); });
+
+            if (m_Exit)
+            {
+                return;
+            }
+
+            runGeneration = m_RunGeneration;
+        }
+
+        WorkerLoop(workerIndex);
+
+        {
+            std::lock_guard<std::mutex> lock(m_Mutex);
+            if (--m_ActiveThreads == 0)
+            {
+                m_DoneCondition.notify_all();
+            }
+        }
+    }
+}
+
+void IvyTaskScheduler::WorkerLoop(uint32_t workerIndex)
+{
+    Task task;
+
+    while (m_PendingTasks.load() > 0)
+    {
+        if (!PopLocal(workerIndex, task) && !Steal(workerIndex, task))
+        {
+            // search once more after registering as idle, a task spawned in between bumps the version
+            const uint64_t workVersion = m_WorkVersion.load();
+            m_IdleWorkers.fetch_add(1);
+            const bool found = PopLocal(workerIndex, task) || Steal(workerIndex, task);
+            if (!found)
+            {
+                WaitForWork(workVersion);
+            }
+            m_IdleWorkers.fetch_sub(1);
+
+            if (!found)
+            {
+                continue;
+            }
+        }
+
+        task(workerIndex);
+        task = nullptr;
+
+        // the last task wakes all idle workers to leave the worker loop
+        if (m_PendingTasks.fetch_sub(1) == 1)
+        {
+            {
+                std::lock_guard<std::mutex> lock(m_WorkMutex);
+                m_WorkVersion.fetch_add(1);
+            }
+            m_WorkCondition.notify_all();
+        }
+    }
+}
+
+void IvyTaskScheduler::WaitForWork(uint64_t workVersion)
+{
+    std::unique_lock<std::mutex> lock(m_WorkMutex);
+    m_WorkCondition.wait(lock, [&] { return (m_WorkVersion.load() != workVersion) || (m_PendingTasks.load() == 0); });
+}
+
+bool IvyTaskScheduler::PopLocal(uint32_t workerIndex, Task& task)
+{
+    WorkQueue&                  queue = *m_Queues[workerIndex];
+    std::lock_guard<std::mutex> lock(queue.Mutex);
+
+    if (queue.Tasks.empty())
+    {
+        return false;
+    }
+
+    task = std::move(queue.Tasks.back());
+    queue.Tasks.pop_back();
+
+    return true;
+}
+
+bool IvyTaskScheduler::Steal(uint32_t workerIndex, Task& task)
+{
+    const uint32_t queueCount = static_cast<uint32_t>(m_Queues.size());
+
+    for (uint32_t offset = 1; offset < queueCount; ++offset)
+    {
+        WorkQueue&                  victim = *m_Queues[(workerIndex + offset) % queueCount];
+        std::lock_guard<std::mutex> lock(victim.Mutex);
+
+        if (!victim.Tasks.empty())
+        {
+            task = std::move(victim.Tasks.front());
+            victim.Tasks.pop_front();
+
+            m_Queues[workerIndex]->StealCount++;
+
+            return true;
+        }
+    }
+
+    return false;
+}
@@ -0,0 +1,113 @@
+// This file is part of the AMD Work Graph Ivy Generation Sample.
+//
+// Copyright (c) 2024 Advanced Micro Devices, Inc. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * @brief   Work-stealing task scheduler for the CPU work graph.
+ *
+ * Every worker owns a deque of tasks. Workers pop their own tasks LIFO (depth first, keeps the
+ * recursive IvyBranch record tree small) and steal FIFO from other workers when they run dry,
+ * which takes the oldest and thus usually largest sub-trees.
+ * Workers that find no task block on m_WorkCondition until Spawn() queues a task or the Run() is done.
+ * The calling thread of Run() acts as worker 0.
+ */
+class IvyTaskScheduler
+{
+public:
+    // Tasks receive the index of the worker executing them
+    using Task = std::function<void(uint32_t workerIndex)>;
+
+    /**
+     * @brief   Creates the scheduler with threadCount workers (including the calling thread).
+     *          A threadCount of 0 uses all hardware threads.
+     */
+    explicit IvyTaskScheduler(uint32_t threadCount = 0);
+    ~IvyTaskScheduler();
+
+    IvyTaskScheduler(const IvyTaskScheduler&)            = delete;
+    IvyTaskScheduler& operator=(const IvyTaskScheduler&) = delete;
+
+    /**
+     * @brief   Executes the given tasks and all tasks spawned by them. Returns once all tasks are done.
+     */
+    void Run(std::vector<Task>& tasks);
+
+    /**
+     * @brief   Adds a task to the queue of the given worker. Must only be called from tasks running on that worker.
+     */
+    void Spawn(uint32_t workerIndex, Task&& task);
+
+    uint32_t GetThreadCount() const
+    {
+        return static_cast<uint32_t>(m_Queues.size());
+    }
+
+    /**
+     * @brief   Number of tasks stolen from other workers during the last Run().
+     */
+    uint64_t GetStealCount() const;
+
+private:
+    struct alignas(64) WorkQueue
+    {
+        std::mutex       Mutex;
+        std::deque<Task> Tasks;
+        uint64_t         StealCount = 0;  // only accessed by the owning worker
+    };
+
+    void ThreadMain(uint32_t workerIndex);
+    void WorkerLoop(uint32_t workerIndex);
+    bool PopLocal(uint32_t workerIndex, Task& task);
+    bool Steal(uint32_t workerIndex, Task& task);
+    // Blocks until a task might have been queued since workVersion or all tasks are done
+    void WaitForWork(uint64_t workVersion);
+
+    std::vector<std::unique_ptr<WorkQueue>> m_Queues;
+    std::vector<std::thread>                m_Threads;
+
+    // number of queued or running tasks of the current Run()
+    std::atomic<uint64_t> m_PendingTasks{0};
+
+    // idle workers, Spawn() only notifies m_WorkCondition if a worker may be waiting
+    std::mutex              m_WorkMutex;
+    std::condition_variable m_WorkCondition;
+    std::atomic<uint64_t>   m_WorkVersion{0};
+    std::atomic<uint32_t>   m_IdleWorkers{0};
+
+    std::mutex              m_Mutex;
+    std::condition_variable m_StartCondition;
+    std::condition_variable m_DoneCondition;
+    uint64_t                m_RunGeneration = 0;
+    uint32_t                m_ActiveThreads = 0;
+    bool                    m_Exit          = false;
+};
@@ -0,0 +1,181 @@
+// This file is part of the AMD Work Graph Ivy Generation Sample.
+//
+// Copyright (c) 2024 Advanced Micro Devices, Inc. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+#pragma once
+
+// C++ port of shaders/utils.hlsl.
+// Keep in sync with the HLSL version, the CPU engine relies on identical random sequences.
+
+#include "cpu/hlslmath.h"
+#include "shaders/ivycommon.h"
+#include "shaders/ivyrandom.h"
+
+static const float PI = 3.14159265359f;
+
+// ========================
+// Bit Utils
+
+inline bool IsBitSet(uint32_t data, int bitIndex)
+{
+    return (data & (1u << bitIndex)) != 0;
+}
+
+inline int BitSign(uint32_t data, int bitIndex)
+{
+    return IsBitSet(data, bitIndex) ? 1 : -1;
+}
+
+// ========================
+// Randon & Noise functions, see shaders/ivyrandom.h for Hash(uint), Hash(float), CombineSeed & Random
+
+inline uint32_t Hash(const float3& vec)
+{
+    return CombineSeed(Hash(vec.x), Hash(vec.y), Hash(vec.z));
+}
+
+inline uint32_t Hash(const float4& vec)
+{
+    return CombineSeed(Hash(vec.x), Hash(vec.y), Hash(vec.z), Hash(vec.w));
+}
+
+inline uint32_t Hash(const float4x4& mat)
+{
+    return CombineSeed(Hash(mat[0]), Hash(mat[1]), Hash(mat[2]), Hash(mat[3]));
+}
+
+// ========================
+// Matrix Utils
+
+inline float4x4 IdentityMatrix()
+{
+    return float4x4(1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1);
+}
+
+inline float4x4 ToFloat4x4(const float3x4& mat)
+{
+    return float4x4(mat[0], mat[1], mat[2], float4(0, 0, 0, 1));
+}
+
+// Records & instance data store matrices column-major (see ivycommon.h)
+inline float4x4 ToFloat4x4(const Mat4& mat)
+{
+    float4x4 result;
+    for (int row = 0; row < 4; ++row)
+    {
+        for (int column = 0; column < 4; ++column)
+        {
+            result[row][column] = mat.getElem(column, row);
+        }
+    }
+    return result;
+}
+
+inline Mat4 ToMat4(const float4x4& mat)
+{
+    Mat4 result;
+    for (int row = 0; row < 4; ++row)
+    {
+        for (int column = 0; column < 4; ++column)
+        {
+            result.setElem(column, row, mat[row][column]);
+        }
+    }
+    return result;
+}
+
+inline float4x4 mmul(const float4x4& a)
+{
+    return a;
+}
+
+template <typename... Matrices>
+float4x4 mmul(const float4x4& a, const float4x4& b, const Matrices&... rest)
+{
+    return mmul(mul(a, b), rest...);
+}
+
+inline float4x4 RotateX(float a)
+{
+    return float4x4(
+        1, 0, 0, 0,
+        0, std::cos(a), -std::sin(a), 0,
+        0, std::sin(a), std::cos(a), 0,
+        0, 0, 0, 1
+    );
+}
+
+inline float4x4 RotateY(float a)
+{
+    return float4x4(
+        std::cos(a), 0, std::sin(a), 0,
+        0, 1, 0, 0,
+        -std::sin(a), 0, std::cos(a), 0,
+        0, 0, 0, 1
+    );
+}
+
+inline float4x4 RotateZ(float a)
+{
+    return float4x4(
+        std::cos(a), -std::sin(a), 0, 0,
+        std::sin(a), std::cos(a), 0, 0,
+        0, 0, 1, 0,
+        0, 0, 0, 1
+    );
+}
+
+inline float4x4 Rotate(const float3& forward, const float3& up)
+{
+    float4x4     rot = IdentityMatrix();
+    const float3 y   = normalize(up);
+    const float3 z   = normalize(cross(forward, y));
+    const float3 x   = normalize(cross(y, z));
+    rot[0]           = float4(x, 0);
+    rot[1]           = float4(y, 0);
+    rot[2]           = float4(z, 0);
+    return transpose(rot);
+}
+
+inline float4x4 Translate(float tx, float ty, float tz)
+{
+    return float4x4(
+        1, 0, 0, tx,
+        0, 1, 0, ty,
+        0, 0, 1, tz,
+        0, 0, 0, 1
+    );
+}
+
+inline float4x4 Translate(const float3& t)
+{
+    return Translate(t.x, t.y, t.z);
+}
+
+inline float4x4 Scale(float sx, float sy, float sz)
+{
+    return float4x4(
+        sx, 0, 0, 0,
+        0, sy, 0, 0,
+        0, 0, sz, 0,
+        0, 0, 0, 1
+    );
+}
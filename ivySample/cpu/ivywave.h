@@ -0,0 +1,110 @@
+// This file is part of the AMD Work Graph Ivy Generation Sample.
+//
+// Copyright (c) 2024 Advanced Micro Devices, Inc. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+#pragma once
+
+// CPU equivalents of the HLSL wave intrinsics used by the ivy shaders.
+// A wave is emulated as an array holding the value of every lane; all lanes are active.
+
+#include "cpu/simdmath.h"
+
+#include <cstddef>
+#include <cstdint>
+
+template <size_t LaneCount>
+inline float WaveActiveMin(const float (&laneValues)[LaneCount])
+{
+    static_assert((LaneCount % 8) == 0, "lane count must be a multiple of the SIMD width");
+
+    float8 result = float8::Load(laneValues);
+    for (size_t lane = 8; lane < LaneCount; lane += 8)
+    {
+        result = min(float8::Load(laneValues + lane), result);
+    }
+    return reduce_min(result);
+}
+
+template <size_t LaneCount>
+inline float WaveActiveMax(const float (&laneValues)[LaneCount])
+{
+    static_assert((LaneCount % 8) == 0, "lane count must be a multiple of the SIMD width");
+
+    float8 result = float8::Load(laneValues);
+    for (size_t lane = 8; lane < LaneCount; lane += 8)
+    {
+        result = max(float8::Load(laneValues + lane), result);
+    }
+    return reduce_max(result);
+}
+
+template <size_t LaneCount>
+inline uint32_t WaveActiveMin(const uint32_t (&laneValues)[LaneCount])
+{
+    uint32_t result = laneValues[0];
+    for (size_t lane = 1; lane < LaneCount; ++lane)
+    {
+        result = (laneValues[lane] < result) ? laneValues[lane] : result;
+    }
+    return result;
+}
+
+template <size_t LaneCount>
+inline bool WaveActiveAnyTrue(const bool (&laneValues)[LaneCount])
+{
+    for (size_t lane = 0; lane < LaneCount; ++lane)
+    {
+        if (laneValues[lane])
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+template <typename T, size_t LaneCount>
+inline const T& WaveReadLaneAt(const T (&laneValues)[LaneCount], uint32_t laneIndex)
+{
+    return laneValues[laneIndex];
+}
+
+template <typename T, size_t LaneCount>
+inline const T& WaveReadLaneFirst(const T (&laneValues)[LaneCount])
+{
+    return laneValues[0];
+}
+
+/**
+ * @brief   Index of the first lane holding value, WaveGetLaneCount() - 1 if there is none.
+ *          Equivalent of WaveActiveMin(laneValue == value ? WaveGetLaneIndex() : WaveGetLaneCount() - 1).
+ */
+template <size_t LaneCount>
+inline uint32_t WaveFirstLaneEqual(const float (&laneValues)[LaneCount], float value)
+{
+    for (uint32_t lane = 0; lane < LaneCount; ++lane)
+    {
+        if (laneValues[lane] == value)
+        {
+            return lane;
+        }
+    }
+    return LaneCount - 1;
+}
@@ -0,0 +1,338 @@
+// This file is part of the AMD Work Graph Ivy Generation Sample.
+//
+// Copyright (c) 2024 Advanced Micro Devices, Inc. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+#pragma once
+
+// 8-wide float & mask types for packet ray tracing, following the naming of cpu/hlslmath.h.
+// Uses AVX2 if the compiler targets it (IVY_CPU_AVX2 build option), two SSE registers on other x86 targets
+// and plain arrays elsewhere. All backends perform the same IEEE operations, so results are identical.
+
+#include <cstdint>
+
+#if defined(__AVX2__)
+#define IVY_SIMD_AVX2 1
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && (_M_IX86_FP >= 2))
+#define IVY_SIMD_SSE 1
+#include <emmintrin.h>
+#else
+#include <algorithm>
+#endif
+
+#if defined(IVY_SIMD_AVX2)
+static const char* const ivySimdInstructionSet = "avx2";
+#elif defined(IVY_SIMD_SSE)
+static const char* const ivySimdInstructionSet = "sse2";
+#else
+static const char* const ivySimdInstructionSet = "scalar";
+#endif
+
+struct bool8
+{
+#if defined(IVY_SIMD_AVX2)
+    __m256 v;
+#elif defined(IVY_SIMD_SSE)
+    __m128 lo;
+    __m128 hi;
+#else
+    uint32_t v[8];
+#endif
+
+    // bit i is set if lane i is true
+    uint32_t Mask() const
+    {
+#if defined(IVY_SIMD_AVX2)
+        return static_cast<uint32_t>(_mm256_movemask_ps(v));
+#elif defined(IVY_SIMD_SSE)
+        return static_cast<uint32_t>(_mm_movemask_ps(lo) | (_mm_movemask_ps(hi) << 4));
+#else
+        uint32_t mask = 0;
+        for (int i = 0; i < 8; ++i)
+        {
+            mask |= (v[i] ? 1u : 0u) << i;
+        }
+        return mask;
+#endif
+    }
+
+    static bool8 FromMask(uint32_t mask)
+    {
+        bool8 result;
+#if defined(IVY_SIMD_AVX2)
+        const __m256i bits = _mm256_setr_epi32(1, 2, 4, 8, 16, 32, 64, 128);
+        result.v = _mm256_castsi256_ps(_mm256_cmpeq_epi32(_mm256_and_si256(_mm256_set1_epi32(static_cast<int>(mask)), bits), bits));
+#elif defined(IVY_SIMD_SSE)
+        const __m128i bitsLo = _mm_setr_epi32(1, 2, 4, 8);
+        const __m128i bitsHi = _mm_setr_epi32(16, 32, 64, 128);
+        const __m128i m      = _mm_set1_epi32(static_cast<int>(mask));
+        result.lo            = _mm_castsi128_ps(_mm_cmpeq_epi32(_mm_and_si128(m, bitsLo), bitsLo));
+        result.hi            = _mm_castsi128_ps(_mm_cmpeq_epi32(_mm_and_si128(m, bitsHi), bitsHi));
+#else
+        for (int i = 0; i < 8; ++i)
+        {
+            result.v[i] = ((mask >> i) & 1) ? ~0u : 0u;
+        }
+#endif
+        return result;
+    }
+};
+
+inline bool8 operator&(const bool8& a, const bool8& b)
+{
+    bool8 result;
+#if defined(IVY_SIMD_AVX2)
+    result.v = _mm256_and_ps(a.v, b.v);
+#elif defined(IVY_SIMD_SSE)
+    result.lo = _mm_and_ps(a.lo, b.lo);
+    result.hi = _mm_and_ps(a.hi, b.hi);
+#else
+    for (int i = 0; i < 8; ++i)
+    {
+        result.v[i] = a.v[i] & b.v[i];
+    }
+#endif
+    return result;
+}
+
+inline bool8 operator|(const bool8& a, const bool8& b)
+{
+    bool8 result;
+#if defined(IVY_SIMD_AVX2)
+    result.v = _mm256_or_ps(a.v, b.v);
+#elif defined(IVY_SIMD_SSE)
+    result.lo = _mm_or_ps(a.lo, b.lo);
+    result.hi = _mm_or_ps(a.hi, b.hi);
+#else
+    for (int i = 0; i < 8; ++i)
+    {
+        result.v[i] = a.v[i] | b.v[i];
+    }
+#endif
+    return result;
+}
+
+struct float8
+{
+#if defined(IVY_SIMD_AVX2)
+    __m256 v;
+#elif defined(IVY_SIMD_SSE)
+    __m128 lo;
+    __m128 hi;
+#else
+    float v[8];
+#endif
+
+    float8() = default;
+    explicit float8(float s)
+    {
+#if defined(IVY_SIMD_AVX2)
+        v = _mm256_set1_ps(s);
+#elif defined(IVY_SIMD_SSE)
+        lo = hi = _mm_set1_ps(s);
+#else
+        for (int i = 0; i < 8; ++i)
+        {
+            v[i] = s;
+        }
+#endif
+    }
+
+    static float8 Load(const float* p)
+    {
+        float8 result;
+#if defined(IVY_SIMD_AVX2)
+        result.v = _mm256_loadu_ps(p);
+#elif defined(IVY_SIMD_SSE)
+        result.lo = _mm_loadu_ps(p);
+        result.hi = _mm_loadu_ps(p + 4);
+#else
+        for (int i = 0; i < 8; ++i)
+        {
+            result.v[i] = p[i];
+        }
+#endif
+        return result;
+    }
+
+    void Store(float* p) const
+    {
+#if defined(IVY_SIMD_AVX2)
+        _mm256_storeu_ps(p, v);
+#elif defined(IVY_SIMD_SSE)
+        _mm_storeu_ps(p, lo);
+        _mm_storeu_ps(p + 4, hi);
+#else
+        for (int i = 0; i < 8; ++i)
+        {
+            p[i] = v[i];
+        }
+#endif
+    }
+};
+
+#if defined(IVY_SIMD_AVX2)
+#define IVY_FLOAT8_BINARY_OP(name, avxOp, sseOp, scalarExpr) \
+    inline float8 name(const float8& a, const float8& b)   \
+    {                                                        \
+        float8 result;                                       \
+        result.v = avxOp(a.v, b.v);                          \
+        return result;                                       \
+    }
+#define IVY_FLOAT8_COMPARE_OP(name, avxPredicate, sseOp, scalarExpr) \
+    inline bool8 name(const float8& a, const float8& b)            \
+    {                                                                 \
+        bool8 result;                                                 \
+        result.v = _mm256_cmp_ps(a.v, b.v, avxPredicate);             \
+        return result;                                                \
+    }
+#elif defined(IVY_SIMD_SSE)
+#define IVY_FLOAT8_BINARY_OP(name, avxOp, sseOp, scalarExpr) \
+    inline float8 name(const float8& a, const float8& b)   \
+    {                                                        \
+        float8 result;                                       \
+        result.lo = sseOp(a.lo, b.lo);                       \
+        result.hi = sseOp(a.hi, b.hi);                       \
+        return result;                                       \
+    }
+#define IVY_FLOAT8_COMPARE_OP(name, avxPredicate, sseOp, scalarExpr) \
+    inline bool8 name(const float8& a, const float8& b)            \
+    {                                                                 \
+        bool8 result;                                                 \
+        result.lo = sseOp(a.lo, b.lo);                                \
+        result.hi = sseOp(a.hi, b.hi);                                \
+        return result;                                                \
+    }
+#else
+#define IVY_FLOAT8_BINARY_OP(name, avxOp, sseOp, scalarExpr) \
+    inline float8 name(const float8& a, const float8& b)   \
+    {                                                        \
+        float8 result;                                       \
+        for (int i = 0; i < 8; ++i)                          \
+        {                                                    \
+            const float x = a.v[i];                          \
+            const float y = b.v[i];                          \
+            result.v[i]   = scalarExpr;                      \
+        }                                                    \
+        return result;                                       \
+    }
+#define IVY_FLOAT8_COMPARE_OP(name, avxPredicate, sseOp, scalarExpr) \
+    inline bool8 name(const float8& a, const float8& b)            \
+    {                                                                 \
+        bool8 result;                                                 \
+        for (int i = 0; i < 8; ++i)                                   \
+        {                                                             \
+            const float x = a.v[i];                                   \
+            const float y = b.v[i];                                   \
+            result.v[i]   = (scalarExpr) ? ~0u : 0u;                  \
+        }                                                             \
+        return result;                                                \
+    }
+#endif
+
+IVY_FLOAT8_BINARY_OP(operator+, _mm256_add_ps, _mm_add_ps, x + y)
+IVY_FLOAT8_BINARY_OP(operator-, _mm256_sub_ps, _mm_sub_ps, x - y)
+IVY_FLOAT8_BINARY_OP(operator*, _mm256_mul_ps, _mm_mul_ps, x * y)
+IVY_FLOAT8_BINARY_OP(operator/, _mm256_div_ps, _mm_div_ps, x / y)
+// min/max return the second operand if either is NaN, like std::min(b, a) / std::max(b, a) on scalars
+IVY_FLOAT8_BINARY_OP(min, _mm256_min_ps, _mm_min_ps, (x < y) ? x : y)
+IVY_FLOAT8_BINARY_OP(max, _mm256_max_ps, _mm_max_ps, (x > y) ? x : y)
+
+IVY_FLOAT8_COMPARE_OP(operator<, _CMP_LT_OQ, _mm_cmplt_ps, x < y)
+IVY_FLOAT8_COMPARE_OP(operator<=, _CMP_LE_OQ, _mm_cmple_ps, x <= y)
+IVY_FLOAT8_COMPARE_OP(operator>, _CMP_GT_OQ, _mm_cmpgt_ps, x > y)
+IVY_FLOAT8_COMPARE_OP(operator>=, _CMP_GE_OQ, _mm_cmpge_ps, x >= y)
+IVY_FLOAT8_COMPARE_OP(operator==, _CMP_EQ_OQ, _mm_cmpeq_ps, x == y)
+IVY_FLOAT8_COMPARE_OP(operator!=, _CMP_NEQ_UQ, _mm_cmpneq_ps, x != y)
+
+#undef IVY_FLOAT8_BINARY_OP
+#undef IVY_FLOAT8_COMPARE_OP
+
+// Per lane mask ? a : b
+inline float8 select(const bool8& mask, const float8& a, const float8& b)
+{
+    float8 result;
+#if defined(IVY_SIMD_AVX2)
+    result.v = _mm256_blendv_ps(b.v, a.v, mask.v);
+#elif defined(IVY_SIMD_SSE)
+    result.lo = _mm_or_ps(_mm_and_ps(mask.lo, a.lo), _mm_andnot_ps(mask.lo, b.lo));
+    result.hi = _mm_or_ps(_mm_and_ps(mask.hi, a.hi), _mm_andnot_ps(mask.hi, b.hi));
+#else
+    for (int i = 0; i < 8; ++i)
+    {
+        result.v[i] = mask.v[i] ? a.v[i] : b.v[i];
+    }
+#endif
+    return result;
+}
+
+// Minimum over all lanes
+inline float reduce_min(const float8& a)
+{
+    alignas(32) float lanes[8];
+    a.Store(lanes);
+
+    float result = lanes[0];
+    for (int i = 1; i < 8; ++i)
+    {
+        result = (lanes[i] < result) ? lanes[i] : result;
+    }
+    return result;
+}
+
+// Maximum over all lanes
+inline float reduce_max(const float8& a)
+{
+    alignas(32) float lanes[8];
+    a.Store(lanes);
+
+    float result = lanes[0];
+    for (int i = 1; i < 8; ++i)
+    {
+        result = (lanes[i] > result) ? lanes[i] : result;
+    }
+    return result;
+}
+
+/**
+ * @brief   Eight 3D vectors in structure of arrays layout.
+ */
+struct float3x8
+{
+    float8 x;
+    float8 y;
+    float8 z;
+};
+
+inline float3x8 operator-(const float3x8& a, const float3x8& b)
+{
+    return float3x8{a.x - b.x, a.y - b.y, a.z - b.z};
+}
+
+inline float8 dot(const float3x8& a, const float3x8& b)
+{
+    return a.x * b.x + a.y * b.y + a.z * b.z;
+}
+
+inline float3x8 cross(const float3x8& a, const float3x8& b)
+{
+    return float3x8{a.y * b.z - a.z * b.y, a.z * b.x - a.x * b.z, a.x * b.y - a.y * b.x};
+}
@@ -0,0 +1,202 @@
+// This file is part of the AMD Work Graph Ivy Generation Sample.
+//
+// Copyright (c) 2024 Advanced Micro Devices, Inc. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+#pragma once
+
+#include "render/buffer.h"
+#include "render/commandlist.h"
+#include "render/dynamicbufferpool.h"
+#include "render/parameterset.h"
+#include "render/pipelineobject.h"
+#include "render/rootsignature.h"
+#include "render/texture.h"
+#include "ivyretiredbuffers.h"
+#include "shaders/ivycommon.h"
+
+#include <vector>
+
+/**
+ * @brief   Hi-Z pyramid of the GBuffer depth for the occlusion culling of IvyInstanceCulling (see shaders/ivyhiz.hlsl).
+ *
+ * GBufferRenderModule has drawn the scene before the ivy, so the depth buffer already holds all occluders of the frame
+ * and no depth of a previous frame has to be reprojected. Each texel holds the farthest depth of the texels below,
+ * all levels are stored in m_pPyramidBuffer (see IvyGetHiZLevelSize), which rests in the NonPixelShaderResource state.
+ * The CPU reference is cpu/ivycpuhiz.h, see IvyBenchmark --occlusion-culling.
+ */
+struct IvyHiZPyramid
+{
+    cauldron::Buffer*         m_pPyramidBuffer                   = nullptr;  // m_capacity texels
+    cauldron::RootSignature*  m_pRootSignature                   = nullptr;
+    cauldron::ParameterSet*   m_pParameterSet                    = nullptr;
+    cauldron::PipelineObject* m_pDepthPipeline                   = nullptr;
+    cauldron::PipelineObject* m_pLevelPipeline                   = nullptr;
+    uint32_t                  m_capacity                         = 0;  // texels of all levels
+    uint32_t                  m_width                            = 0;  // size of the depth buffer of the last Build()
+    uint32_t                  m_height                           = 0;
+    uint32_t                  m_levelCount                       = 0;
+    uint32_t                  m_levelOffsets[IVY_MAX_HIZ_LEVELS] = {};
+
+    static const uint32_t ThreadGroupSize = 8;  // ivyHiZThreadGroupSize
+
+    ~IvyHiZPyramid()
+    {
+        delete m_pPyramidBuffer;
+        delete m_pDepthPipeline;
+        delete m_pLevelPipeline;
+        delete m_pParameterSet;
+        delete m_pRootSignature;
+    }
+
+    /**
+     * @brief   Allocates the pyramid for a depth buffer of up to width x height pixels, i.e. the render resolution.
+     */
+    void Init(uint32_t width, uint32_t height)
+    {
+        cauldron::RootSignatureDesc rootSigDesc;
+        rootSigDesc.AddConstantBufferView(1, cauldron::ShaderBindStage::Compute, 1);  // b1: IvyHiZCBData
+        rootSigDesc.AddTextureSRVSet(0, cauldron::ShaderBindStage::Compute, 1);       // t0: depth buffer
+        rootSigDesc.AddBufferUAVSet(0, cauldron::ShaderBindStage::Compute, 1);        // u0: pyramid
+        rootSigDesc.m_PipelineType = cauldron::PipelineType::Compute;
+
+        m_pRootSignature = cauldron::RootSignature::CreateRootSignature(L"IvyHiZPyramid_RootSignature", rootSigDesc);
+
+        m_pParameterSet = cauldron::ParameterSet::CreateParameterSet(m_pRootSignature);
+        m_pParameterSet->SetRootConstantBufferResource(cauldron::GetDynamicBufferPool()->GetResource(), sizeof(IvyHiZCBData), 0);
+
+        m_pDepthPipeline = CreatePipeline(L"BuildHiZFromDepth");
+        m_pLevelPipeline = CreatePipeline(L"BuildHiZLevel");
+
+        Resize(width, height);
+    }
+
+    /**
+     * @brief   Reallocates the pyramid for a depth buffer of up to width x height pixels, e.g. after the render
+     *          resolution changed. The old buffer is retired to pRetiredBuffers, without it it must not be in use
+     *          by the GPU anymore.
+     */
+    void Resize(uint32_t width, uint32_t height, IvyRetiredBuffers* pRetiredBuffers = nullptr)
+    {
+        const uint32_t texelCount = GetTexelCount(width, height);
+        if (m_pPyramidBuffer && (texelCount == m_capacity))
+        {
+            return;
+        }
+
+        IvyReleaseBuffer(m_pPyramidBuffer, pRetiredBuffers);
+
+        m_capacity = texelCount;
+
+        cauldron::BufferDesc pyramidDesc = cauldron::BufferDesc::Data(
+            L"Ivy_HiZPyramidBuffer", sizeof(float) * m_capacity, sizeof(float), 0, cauldron::ResourceFlags::AllowUnorderedAccess);
+        m_pPyramidBuffer = cauldron::Buffer::CreateBufferResource(&pyramidDesc, cauldron::ResourceState::NonPixelShaderResource);
+
+        m_pParameterSet->SetBufferUAV(m_pPyramidBuffer, 0);
+    }
+
+    /**
+     * @brief   Builds all levels from the width x height pixels of the depth buffer, which has to be
+     *          readable by compute shaders (NonPixelShaderResource). A pyramid that is too small for the
+     *          depth buffer is resized, the old buffer is retired to pRetiredBuffers.
+     */
+    void Build(cauldron::CommandList*   pCmdList,
+               const cauldron::Texture* pDepthTexture,
+               uint32_t                 width,
+               uint32_t                 height,
+               IvyRetiredBuffers*       pRetiredBuffers)
+    {
+        // Resized with the render resolution, see IvyRenderModule::OnResize
+        if (GetTexelCount(width, height) > m_capacity)
+        {
+            Resize(width, height, pRetiredBuffers);
+        }
+
+        m_width      = width;
+        m_height     = height;
+        m_levelCount = IvyGetHiZLevelCount(width, height);
+
+        uint32_t levelOffset = 0;
+        for (uint32_t level = 0; level < m_levelCount; ++level)
+        {
+            m_levelOffsets[level] = levelOffset;
+            levelOffset += IvyGetHiZLevelSize(width, level) * IvyGetHiZLevelSize(height, level);
+        }
+
+        // The depth texture is recreated on resize, so it is bound every frame
+        m_pParameterSet->SetTextureSRV(pDepthTexture, cauldron::ViewDimension::Texture2D, 0);
+
+        cauldron::Barrier barrier = cauldron::Barrier::Transition(
+            m_pPyramidBuffer->GetResource(), cauldron::ResourceState::NonPixelShaderResource, cauldron::ResourceState::UnorderedAccess);
+        cauldron::ResourceBarrier(pCmdList, 1, &barrier);
+
+        for (uint32_t level = 0; level < m_levelCount; ++level)
+        {
+            IvyHiZCBData constants         = {};
+            constants.HiZSourceOffset      = (level == 0) ? 0 : m_levelOffsets[level - 1];
+            constants.HiZSourceWidth       = (level == 0) ? width : IvyGetHiZLevelSize(width, level - 1);
+            constants.HiZSourceHeight      = (level == 0) ? height : IvyGetHiZLevelSize(height, level - 1);
+            constants.HiZDestinationOffset = m_levelOffsets[level];
+            constants.HiZDestinationWidth  = IvyGetHiZLevelSize(width, level);
+            constants.HiZDestinationHeight = IvyGetHiZLevelSize(height, level);
+
+            cauldron::BufferAddressInfo constantsInfo = cauldron::GetDynamicBufferPool()->AllocConstantBuffer(sizeof(IvyHiZCBData), &constants);
+            m_pParameterSet->UpdateRootConstantBuffer(&constantsInfo, 0);
+
+            cauldron::PipelineObject* pPipeline = (level == 0) ? m_pDepthPipeline : m_pLevelPipeline;
+            cauldron::SetPipelineState(pCmdList, pPipeline);
+            m_pParameterSet->Bind(pCmdList, pPipeline);
+
+            cauldron::Dispatch(pCmdList,
+                               (constants.HiZDestinationWidth + ThreadGroupSize - 1) / ThreadGroupSize,
+                               (constants.HiZDestinationHeight + ThreadGroupSize - 1) / ThreadGroupSize,
+                               1);
+
+            // Each level reads the previous one
+            barrier = cauldron::Barrier::UAV(m_pPyramidBuffer->GetResource());
+            cauldron::ResourceBarrier(pCmdList, 1, &barrier);
+        }
+
+        barrier = cauldron::Barrier::Transition(
+            m_pPyramidBuffer->GetResource(), cauldron::ResourceState::UnorderedAccess, cauldron::ResourceState::NonPixelShaderResource);
+        cauldron::ResourceBarrier(pCmdList, 1, &barrier);
+    }
+
+private:
+    static uint32_t GetTexelCount(uint32_t width, uint32_t height)
+    {
+        uint32_t       texelCount = 0;
+        const uint32_t levelCount = IvyGetHiZLevelCount(width, height);
+        for (uint32_t level = 0; level < levelCount; ++level)
+        {
+            texelCount += IvyGetHiZLevelSize(width, level) * IvyGetHiZLevelSize(height, level);
+        }
+        return texelCount;
+    }
+
+    cauldron::PipelineObject* CreatePipeline(const wchar_t* entryPoint)
+    {
+        cauldron::PipelineDesc psoDesc;
+        psoDesc.SetRootSignature(m_pRootSignature);
+        psoDesc.AddShaderDesc(cauldron::ShaderBuildDesc::Compute(L"ivyhiz.hlsl", entryPoint, cauldron::ShaderModel::SM6_0, nullptr));
+
+        return cauldron::PipelineObject::CreatePipelineObject(entryPoint, psoDesc);
+    }
+};
@@ -0,0 +1,485 @@
+// This file is part of the AMD Work Graph Ivy Generation Sample.
+//
+// Copyright (c) 2024 Advanced Micro Devices, Inc. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+#pragma once
+
+#include "render/buffer.h"
+#include "render/commandlist.h"
+#include "render/dynamicbufferpool.h"
+#include "render/indirectworkload.h"
+#include "render/parameterset.h"
+#include "render/pipelineobject.h"
+#include "render/rootsignature.h"
+#include "cpu/ivymeshsimplifier.h"
+#include "ivyhiz.h"
+#include "ivyretiredbuffers.h"
+#include "shaders/ivycommon.h"
+
+#include <algorithm>
+#include <initializer_list>
+#include <utility>
+#include <vector>
+
+// State of the culled draw arguments, drawn indirectly & read by the vertex shader of IvyRenderIndirect
+static const cauldron::ResourceState IvyCulledArgumentBufferState = cauldron::ResourceState::IndirectArgument | cauldron::ResourceState::NonPixelShaderResource;
+
+/**
+ * @brief   Frustum & occlusion culling pass between the instance generation & ExecuteIndirect (see shaders/ivyinstanceculling.hlsl).
+ *
+ * Tests the bounding sphere of every leaf & stem instance against the frustum planes of the camera, optionally followed by
+ * a test against the Hi-Z pyramid of the scene depth (see IvyHiZPyramid), and compacts the visible instances into
+ * separate draw buffers, which are then drawn instead of the generated ones.
+ * Consecutive runs of IVY_INSTANCE_CLUSTER_SIZE instances form clusters with the bounds of their instances, which
+ * are culled first. Only the instances of visible clusters are tested, with one indirectly dispatched thread group per cluster.
+ * Each IvyBranch thread group writes its instances as one run and the partition compaction keeps their order,
+ * so the instances of a cluster mostly belong to the same IvyBranch group (see cpu/ivyinstanceclusters.h).
+ * With the LODs of SetMeshLods(), each visible instance selects the coarsest LOD whose error stays below a pixel threshold
+ * (see IvySelectMeshLod). The culled buffers hold a draw per LOD and a single region of m_capacity instances per stream:
+ * the visible instances are counted per LOD first, the counts are summed up into the StartInstanceLocation of each LOD draw
+ * and the instances are then copied to the range of their LOD, see GetArgumentOffset().
+ * Visible leaf clusters beyond the impostor distance skip their instances and are appended to m_pImpostorClusterBuffer instead,
+ * which IvyLeafImpostors draws with the impostor quads of m_pImpostorQuadBuffer (see shaders/ivyleafimpostor.h).
+ * The cluster bounds only depend on the generated instances and are rebuilt with BuildClusters() when these change.
+ * The generated buffers are left untouched, such that cached frames can cull them again with a new camera.
+ * Source & culled buffers rest in the states used by ExecuteIndirect (IndirectArgument & NonPixelShaderResource).
+ * The culled draw arguments are also read by the vertex shader of IvyRenderIndirect for the first instance of each LOD,
+ * as SV_InstanceID does not include StartInstanceLocation.
+ * The CPU references are cpu/ivyinstanceculling.h & cpu/ivycpuhiz.h, see IvyBenchmark --frustum-culling & --occlusion-culling.
+ */
+struct IvyInstanceCulling
+{
+    cauldron::Buffer*           m_pArgumentBuffer         = nullptr;  // DrawIndexedArgs (leaf, stem) of each LOD of the visible instances
+    cauldron::Buffer*           m_pLeafInstanceBuffer     = nullptr;  // m_capacity instances, LODs from StartInstanceLocation of their draw
+    cauldron::Buffer*           m_pStemInstanceBuffer     = nullptr;  // m_capacity instances, LODs from StartInstanceLocation of their draw
+    cauldron::Buffer*           m_pLodSlotBuffer          = nullptr;  // LOD & slot within the LOD of the leaf & stem instances
+    cauldron::Buffer*           m_pClusterBuffer          = nullptr;  // m_clusterCapacity leaf & stem clusters
+    cauldron::Buffer*           m_pVisibleClusterBuffer   = nullptr;  // m_clusterCapacity leaf & stem cluster indices
+    cauldron::Buffer*           m_pClusterDispatchBuffer  = nullptr;  // DispatchArgs (leaf, stem), thread group per visible cluster
+    cauldron::Buffer*           m_pImpostorQuadBuffer     = nullptr;  // IVY_LEAF_IMPOSTOR_QUADS quads per leaf cluster
+    cauldron::Buffer*           m_pImpostorClusterBuffer  = nullptr;  // m_clusterCapacity indices of leaf clusters drawn as impostors
+    cauldron::Buffer*           m_pImpostorArgumentBuffer = nullptr;  // DrawArgs, instance per impostor cluster
+    cauldron::Buffer*           m_pDummyHiZBuffer         = nullptr;  // single float bound as t3 without a Hi-Z pyramid, never read
+    cauldron::IndirectWorkload* m_pDispatchWorkload       = nullptr;
+    cauldron::RootSignature*    m_pRootSignature          = nullptr;
+    cauldron::ParameterSet*     m_pParameterSet           = nullptr;
+    cauldron::PipelineObject*   m_pBuildClustersPipeline  = nullptr;
+    cauldron::PipelineObject*   m_pResetPipeline          = nullptr;
+    cauldron::PipelineObject*   m_pCullClustersPipeline   = nullptr;
+    cauldron::PipelineObject*   m_pCullInstancesPipeline  = nullptr;
+    cauldron::PipelineObject*   m_pResolveLodsPipeline    = nullptr;
+    cauldron::PipelineObject*   m_pScatterPipeline        = nullptr;
+    uint32_t                    m_capacity                = 0;  // instances per stream
+    uint32_t                    m_clusterCapacity         = 0;  // clusters per stream
+
+    // LODs of the leaf & stem meshes, see SetMeshLods()
+    uint32_t m_lodCounts[2]                      = {};
+    float    m_lodErrors[2][IVY_MAX_MESH_LODS]   = {};
+    uint32_t m_lodDraws[2][IVY_MAX_MESH_LODS][4] = {};
+
+    static const uint32_t ThreadGroupSize = 256;  // ivyCullingThreadGroupSize
+
+    ~IvyInstanceCulling()
+    {
+        delete m_pArgumentBuffer;
+        delete m_pLeafInstanceBuffer;
+        delete m_pStemInstanceBuffer;
+        delete m_pLodSlotBuffer;
+        delete m_pClusterBuffer;
+        delete m_pVisibleClusterBuffer;
+        delete m_pClusterDispatchBuffer;
+        delete m_pImpostorQuadBuffer;
+        delete m_pImpostorClusterBuffer;
+        delete m_pImpostorArgumentBuffer;
+        delete m_pDummyHiZBuffer;
+        delete m_pDispatchWorkload;
+        delete m_pBuildClustersPipeline;
+        delete m_pResetPipeline;
+        delete m_pCullClustersPipeline;
+        delete m_pCullInstancesPipeline;
+        delete m_pResolveLodsPipeline;
+        delete m_pScatterPipeline;
+        delete m_pParameterSet;
+        delete m_pRootSignature;
+    }
+
+    void Init(uint32_t capacity)
+    {
+        cauldron::BufferDesc argumentDesc = cauldron::BufferDesc::Data(
+            L"Ivy_CulledArgumentBuffer", sizeof(DrawIndexedArgs) * 2 * IVY_MAX_MESH_LODS, sizeof(DrawIndexedArgs), 0, cauldron::ResourceFlags::AllowUnorderedAccess);
+        m_pArgumentBuffer = cauldron::Buffer::CreateBufferResource(&argumentDesc, IvyCulledArgumentBufferState);
+
+        cauldron::BufferDesc dispatchDesc = cauldron::BufferDesc::Data(
+            L"Ivy_ClusterDispatchBuffer", sizeof(DispatchArgs) * 2, sizeof(DispatchArgs), 0, cauldron::ResourceFlags::AllowUnorderedAccess);
+        m_pClusterDispatchBuffer = cauldron::Buffer::CreateBufferResource(&dispatchDesc, cauldron::ResourceState::IndirectArgument);
+
+        cauldron::BufferDesc impostorArgumentDesc = cauldron::BufferDesc::Data(
+            L"Ivy_ImpostorArgumentBuffer", sizeof(DrawArgs), sizeof(DrawArgs), 0, cauldron::ResourceFlags::AllowUnorderedAccess);
+        m_pImpostorArgumentBuffer = cauldron::Buffer::CreateBufferResource(&impostorArgumentDesc, cauldron::ResourceState::IndirectArgument);
+
+        // The structured SRV of t3 needs a buffer with the stride of g_hiZBuffer
+        cauldron::BufferDesc dummyHiZDesc = cauldron::BufferDesc::Data(L"Ivy_DummyHiZBuffer", sizeof(float), sizeof(float), 0, cauldron::ResourceFlags::None);
+        m_pDummyHiZBuffer                 = cauldron::Buffer::CreateBufferResource(&dummyHiZDesc, cauldron::ResourceState::NonPixelShaderResource);
+
+        m_pDispatchWorkload = cauldron::IndirectWorkload::CreateIndirectWorkload(cauldron::IndirectCommandType::Dispatch);
+
+        cauldron::RootSignatureDesc rootSigDesc;
+        rootSigDesc.AddConstantBufferView(1, cauldron::ShaderBindStage::Compute, 1);  // b1: IvyInstanceCullingCBData
+        rootSigDesc.AddBufferSRVSet(0, cauldron::ShaderBindStage::Compute, 4);        // t0-t2: generated draw arguments & instances, t3: Hi-Z pyramid
+        rootSigDesc.AddBufferUAVSet(0, cauldron::ShaderBindStage::Compute, 10);       // u0-u2: culled draw arguments & instances, u3-u5: clusters, u6-u8: impostors, u9: LOD slots
+        rootSigDesc.m_PipelineType = cauldron::PipelineType::Compute;
+
+        m_pRootSignature = cauldron::RootSignature::CreateRootSignature(L"IvyInstanceCulling_RootSignature", rootSigDesc);
+
+        m_pParameterSet = cauldron::ParameterSet::CreateParameterSet(m_pRootSignature);
+        m_pParameterSet->SetRootConstantBufferResource(cauldron::GetDynamicBufferPool()->GetResource(), sizeof(IvyInstanceCullingCBData), 0);
+        m_pParameterSet->SetBufferUAV(m_pArgumentBuffer, 0);
+        m_pParameterSet->SetBufferUAV(m_pClusterDispatchBuffer, 5);
+        m_pParameterSet->SetBufferUAV(m_pImpostorArgumentBuffer, 8);
+
+        m_pBuildClustersPipeline = CreatePipeline(L"BuildClusters");
+        m_pResetPipeline         = CreatePipeline(L"ResetCulling");
+        m_pCullClustersPipeline  = CreatePipeline(L"CullClusters");
+        m_pCullInstancesPipeline = CreatePipeline(L"CullClusterInstances");
+        m_pResolveLodsPipeline   = CreatePipeline(L"ResolveLodRegions");
+        m_pScatterPipeline       = CreatePipeline(L"ScatterClusterInstances");
+
+        Resize(capacity);
+    }
+
+    /**
+     * @brief   Reallocates the culled instance & cluster buffers for capacity instances per stream, the clusters have to
+     *          be built again.
+     *          The old buffers are retired to pRetiredBuffers, without it they must not be in use by the GPU anymore.
+     */
+    void Resize(uint32_t capacity, IvyRetiredBuffers* pRetiredBuffers = nullptr)
+    {
+        IvyReleaseBuffer(m_pLeafInstanceBuffer, pRetiredBuffers);
+        IvyReleaseBuffer(m_pStemInstanceBuffer, pRetiredBuffers);
+        IvyReleaseBuffer(m_pLodSlotBuffer, pRetiredBuffers);
+        IvyReleaseBuffer(m_pClusterBuffer, pRetiredBuffers);
+        IvyReleaseBuffer(m_pVisibleClusterBuffer, pRetiredBuffers);
+        IvyReleaseBuffer(m_pImpostorQuadBuffer, pRetiredBuffers);
+        IvyReleaseBuffer(m_pImpostorClusterBuffer, pRetiredBuffers);
+
+        m_capacity        = capacity;
+        m_clusterCapacity = (capacity + IVY_INSTANCE_CLUSTER_SIZE - 1) / IVY_INSTANCE_CLUSTER_SIZE;
+
+        cauldron::BufferDesc clusterDesc = cauldron::BufferDesc::Data(
+            L"Ivy_ClusterBuffer", sizeof(IvyInstanceCluster) * 2 * m_clusterCapacity, sizeof(IvyInstanceCluster), 0, cauldron::ResourceFlags::AllowUnorderedAccess);
+        m_pClusterBuffer = cauldron::Buffer::CreateBufferResource(&clusterDesc, cauldron::ResourceState::UnorderedAccess);
+
+        cauldron::BufferDesc visibleClusterDesc = cauldron::BufferDesc::Data(
+            L"Ivy_VisibleClusterBuffer", sizeof(uint32_t) * 2 * m_clusterCapacity, sizeof(uint32_t), 0, cauldron::ResourceFlags::AllowUnorderedAccess);
+        m_pVisibleClusterBuffer = cauldron::Buffer::CreateBufferResource(&visibleClusterDesc, cauldron::ResourceState::UnorderedAccess);
+
+        m_pParameterSet->SetBufferUAV(m_pClusterBuffer, 3);
+        m_pParameterSet->SetBufferUAV(m_pVisibleClusterBuffer, 4);
+
+        // Read by IvyLeafImpostors, rest in the state of its vertex shader
+        cauldron::BufferDesc impostorQuadDesc = cauldron::BufferDesc::Data(L"Ivy_ImpostorQuadBuffer",
+                                                                           sizeof(IvyLeafImpostorQuad) * IVY_LEAF_IMPOSTOR_QUADS * m_clusterCapacity,
+                                                                           sizeof(IvyLeafImpostorQuad),
+                                                                           0,
+                                                                           cauldron::ResourceFlags::AllowUnorderedAccess);
+        m_pImpostorQuadBuffer = cauldron::Buffer::CreateBufferResource(&impostorQuadDesc, cauldron::ResourceState::NonPixelShaderResource);
+
+        cauldron::BufferDesc impostorClusterDesc = cauldron::BufferDesc::Data(
+            L"Ivy_ImpostorClusterBuffer", sizeof(uint32_t) * m_clusterCapacity, sizeof(uint32_t), 0, cauldron::ResourceFlags::AllowUnorderedAccess);
+        m_pImpostorClusterBuffer = cauldron::Buffer::CreateBufferResource(&impostorClusterDesc, cauldron::ResourceState::NonPixelShaderResource);
+
+        m_pParameterSet->SetBufferUAV(m_pImpostorQuadBuffer, 6);
+        m_pParameterSet->SetBufferUAV(m_pImpostorClusterBuffer, 7);
+
+        cauldron::BufferDesc instanceDesc = cauldron::BufferDesc::Data(
+            L"Ivy_CulledLeafInstanceBuffer", sizeof(IvyEncodedInstance) * m_capacity, sizeof(IvyEncodedInstance), 0, cauldron::ResourceFlags::AllowUnorderedAccess);
+        m_pLeafInstanceBuffer = cauldron::Buffer::CreateBufferResource(&instanceDesc, cauldron::ResourceState::NonPixelShaderResource);
+        instanceDesc.Name     = L"Ivy_CulledStemInstanceBuffer";
+        m_pStemInstanceBuffer = cauldron::Buffer::CreateBufferResource(&instanceDesc, cauldron::ResourceState::NonPixelShaderResource);
+
+        m_pParameterSet->SetBufferUAV(m_pLeafInstanceBuffer, 1);
+        m_pParameterSet->SetBufferUAV(m_pStemInstanceBuffer, 2);
+
+        // Only written & read by the culling passes
+        cauldron::BufferDesc lodSlotDesc = cauldron::BufferDesc::Data(
+            L"Ivy_LodSlotBuffer", sizeof(uint32_t) * 2 * m_capacity, sizeof(uint32_t), 0, cauldron::ResourceFlags::AllowUnorderedAccess);
+        m_pLodSlotBuffer = cauldron::Buffer::CreateBufferResource(&lodSlotDesc, cauldron::ResourceState::UnorderedAccess);
+
+        m_pParameterSet->SetBufferUAV(m_pLodSlotBuffer, 9);
+    }
+
+    /**
+     * @brief   Sets the LODs of the leaf (stream 0) or stem (stream 1) mesh, whose indices & vertices are drawn with the
+     *          culled arguments. Without LODs, the culled arguments draw the indices of the generated ones as LOD 0.
+     */
+    void SetMeshLods(uint32_t stream, const std::vector<IvyMeshLod>& lods)
+    {
+        m_lodCounts[stream] = std::min(static_cast<uint32_t>(lods.size()), static_cast<uint32_t>(IVY_MAX_MESH_LODS));
+        for (uint32_t lod = 0; lod < m_lodCounts[stream]; ++lod)
+        {
+            m_lodErrors[stream][lod]   = lods[lod].Error;
+            m_lodDraws[stream][lod][0] = lods[lod].IndexCount;
+            m_lodDraws[stream][lod][1] = lods[lod].FirstIndex;
+            m_lodDraws[stream][lod][2] = lods[lod].BaseVertex;
+        }
+    }
+
+    /**
+     * @brief   Byte offset of the culled draw arguments of a LOD of the leaf (stream 0) or stem (stream 1) instances,
+     *          which are stored from the StartInstanceLocation of the draw in the culled instance buffer of the stream.
+     */
+    static uint32_t GetArgumentOffset(uint32_t stream, uint32_t lod)
+    {
+        return (stream * IVY_MAX_MESH_LODS + lod) * sizeof(DrawIndexedArgs);
+    }
+
+    /**
+     * @brief   Computes the bounds of the clusters of the generated instances & the impostor quads of the leaf clusters.
+     *          The spheres are the local bounds of the leaf & stem meshes (xyz = center, w = radius).
+     */
+    void BuildClusters(cauldron::CommandList*  pCmdList,
+                       const Vec4&             leafBoundingSphere,
+                       const Vec4&             stemBoundingSphere,
+                       const cauldron::Buffer* pArgumentBuffer,
+                       const cauldron::Buffer* pLeafInstanceBuffer,
+                       const cauldron::Buffer* pStemInstanceBuffer)
+    {
+        BindSources(pArgumentBuffer, pLeafInstanceBuffer, pStemInstanceBuffer, nullptr);
+
+        IvyInstanceCullingCBData constants = {};
+        SetSphere(leafBoundingSphere, constants.LeafBoundingSphere);
+        SetSphere(stemBoundingSphere, constants.StemBoundingSphere);
+        constants.CullingCapacity = m_capacity;
+        constants.ClusterCapacity = m_clusterCapacity;
+
+        cauldron::Barrier barriers[] = {
+            cauldron::Barrier::Transition(pArgumentBuffer->GetResource(), cauldron::ResourceState::IndirectArgument, cauldron::ResourceState::NonPixelShaderResource),
+            cauldron::Barrier::Transition(m_pImpostorQuadBuffer->GetResource(), cauldron::ResourceState::NonPixelShaderResource, cauldron::ResourceState::UnorderedAccess)};
+        cauldron::ResourceBarrier(pCmdList, 2, barriers);
+
+        // y = 0: leaf clusters, y = 1: stem clusters
+        Dispatch(pCmdList, m_pBuildClustersPipeline, constants, m_clusterCapacity, 2, 1);
+        UAVBarrier(pCmdList, {m_pClusterBuffer});
+
+        for (cauldron::Barrier& barrier : barriers)
+        {
+            std::swap(barrier.SourceState, barrier.DestState);
+        }
+        cauldron::ResourceBarrier(pCmdList, 2, barriers);
+    }
+
+    /**
+     * @brief   Culls the generated instances with the frustum of viewProjection. The spheres are the local bounds of
+     *          the leaf & stem meshes (xyz = center, w = radius). With occlusionCulling, the instances within the frustum
+     *          are also tested against hiZPyramid, which has to be built from the depth of the same viewProjection.
+     *          lodScale is the number of pixels per world space unit at w = 1, 0 selects LOD 0 for all instances.
+     *          Visible leaf clusters beyond impostorDistance (view depth) are drawn as impostors, 0 disables the impostors.
+     */
+    void Execute(cauldron::CommandList*  pCmdList,
+                 const Mat4&             viewProjection,
+                 const Vec4&             leafBoundingSphere,
+                 const Vec4&             stemBoundingSphere,
+                 const cauldron::Buffer* pArgumentBuffer,
+                 const cauldron::Buffer* pLeafInstanceBuffer,
+                 const cauldron::Buffer* pStemInstanceBuffer,
+                 const IvyHiZPyramid&    hiZPyramid,
+                 bool                    occlusionCulling,
+                 float                   lodScale,
+                 float                   lodPixelError,
+                 float                   impostorDistance)
+    {
+        BindSources(pArgumentBuffer, pLeafInstanceBuffer, pStemInstanceBuffer, hiZPyramid.m_pPyramidBuffer);
+
+        IvyInstanceCullingCBData constants = {};
+        constants.CullingViewProjection    = viewProjection;
+        SetFrustumPlanes(viewProjection, constants);
+        SetSphere(leafBoundingSphere, constants.LeafBoundingSphere);
+        SetSphere(stemBoundingSphere, constants.StemBoundingSphere);
+        constants.CullingCapacity  = m_capacity;
+        constants.ClusterCapacity  = m_clusterCapacity;
+        constants.OcclusionCulling = (occlusionCulling && (hiZPyramid.m_levelCount > 0)) ? 1 : 0;
+        constants.HiZWidth         = hiZPyramid.m_width;
+        constants.HiZHeight        = hiZPyramid.m_height;
+        constants.HiZLevelCount    = hiZPyramid.m_levelCount;
+        for (uint32_t level = 0; level < IVY_MAX_HIZ_LEVELS; ++level)
+        {
+            constants.HiZLevelOffsets[level] = hiZPyramid.m_levelOffsets[level];
+        }
+        SetLodConstants(lodScale, lodPixelError, constants);
+        constants.ImpostorDistance = impostorDistance;
+
+        std::vector<cauldron::Barrier> barriers;
+        barriers.push_back(cauldron::Barrier::Transition(
+            pArgumentBuffer->GetResource(), cauldron::ResourceState::IndirectArgument, cauldron::ResourceState::NonPixelShaderResource));
+        barriers.push_back(cauldron::Barrier::Transition(m_pArgumentBuffer->GetResource(), IvyCulledArgumentBufferState, cauldron::ResourceState::UnorderedAccess));
+        barriers.push_back(cauldron::Barrier::Transition(
+            m_pLeafInstanceBuffer->GetResource(), cauldron::ResourceState::NonPixelShaderResource, cauldron::ResourceState::UnorderedAccess));
+        barriers.push_back(cauldron::Barrier::Transition(
+            m_pStemInstanceBuffer->GetResource(), cauldron::ResourceState::NonPixelShaderResource, cauldron::ResourceState::UnorderedAccess));
+        barriers.push_back(cauldron::Barrier::Transition(
+            m_pImpostorArgumentBuffer->GetResource(), cauldron::ResourceState::IndirectArgument, cauldron::ResourceState::UnorderedAccess));
+        barriers.push_back(cauldron::Barrier::Transition(
+            m_pImpostorClusterBuffer->GetResource(), cauldron::ResourceState::NonPixelShaderResource, cauldron::ResourceState::UnorderedAccess));
+        barriers.push_back(cauldron::Barrier::Transition(
+            m_pClusterDispatchBuffer->GetResource(), cauldron::ResourceState::IndirectArgument, cauldron::ResourceState::UnorderedAccess));
+        cauldron::ResourceBarrier(pCmdList, static_cast<uint32_t>(barriers.size()), barriers.data());
+
+        Dispatch(pCmdList, m_pResetPipeline, constants, 1, 1, 1);
+        UAVBarrier(pCmdList, {m_pArgumentBuffer, m_pClusterDispatchBuffer, m_pImpostorArgumentBuffer});
+
+        // y = 0: leaf clusters, y = 1: stem clusters
+        Dispatch(pCmdList, m_pCullClustersPipeline, constants, (m_clusterCapacity + ThreadGroupSize - 1) / ThreadGroupSize, 2, 1);
+        UAVBarrier(pCmdList, {m_pVisibleClusterBuffer, m_pImpostorClusterBuffer});
+
+        cauldron::Barrier dispatchBarrier = cauldron::Barrier::Transition(
+            m_pClusterDispatchBuffer->GetResource(), cauldron::ResourceState::UnorderedAccess, cauldron::ResourceState::IndirectArgument);
+        cauldron::ResourceBarrier(pCmdList, 1, &dispatchBarrier);
+
+        // Counts the visible instances of each LOD, then copies them to the range of their LOD within the region of the stream
+        DispatchVisibleClusters(pCmdList, m_pCullInstancesPipeline, constants);
+        UAVBarrier(pCmdList, {m_pArgumentBuffer, m_pLodSlotBuffer});
+
+        Dispatch(pCmdList, m_pResolveLodsPipeline, constants, 1, 1, 1);
+        UAVBarrier(pCmdList, {m_pArgumentBuffer});
+
+        DispatchVisibleClusters(pCmdList, m_pScatterPipeline, constants);
+
+        // The dispatch arguments are already back in the IndirectArgument state
+        barriers.pop_back();
+        for (cauldron::Barrier& barrier : barriers)
+        {
+            std::swap(barrier.SourceState, barrier.DestState);
+        }
+        cauldron::ResourceBarrier(pCmdList, static_cast<uint32_t>(barriers.size()), barriers.data());
+    }
+
+private:
+    // The Hi-Z pyramid is not read by BuildClusters, which binds the leaf instances in its place
+    void BindSources(const cauldron::Buffer* pArgumentBuffer,
+                     const cauldron::Buffer* pLeafInstanceBuffer,
+                     const cauldron::Buffer* pStemInstanceBuffer,
+                     const cauldron::Buffer* pHiZBuffer)
+    {
+        m_pParameterSet->SetBufferSRV(pArgumentBuffer, 0);
+        m_pParameterSet->SetBufferSRV(pLeafInstanceBuffer, 1);
+        m_pParameterSet->SetBufferSRV(pStemInstanceBuffer, 2);
+        m_pParameterSet->SetBufferSRV(pHiZBuffer ? pHiZBuffer : m_pDummyHiZBuffer, 3);
+    }
+
+    // Same planes & normalization as IvyFrustum::FromViewProjection
+    static void SetFrustumPlanes(const Mat4& viewProjection, IvyInstanceCullingCBData& constants)
+    {
+        const Vec4 row0 = viewProjection.getRow(0);
+        const Vec4 row1 = viewProjection.getRow(1);
+        const Vec4 row2 = viewProjection.getRow(2);
+        const Vec4 row3 = viewProjection.getRow(3);
+
+        const Vec4 planes[6] = {row3 + row0, row3 - row0, row3 + row1, row3 - row1, row2, row3 - row2};
+        for (uint32_t i = 0; i < 6; ++i)
+        {
+            const float normalLength = length(planes[i].getXYZ());
+            const Vec4  plane        = (normalLength > 0.f) ? planes[i] / normalLength : Vec4(0.f, 0.f, 0.f, 1.f);
+
+            constants.FrustumPlanes[i][0] = plane.getX();
+            constants.FrustumPlanes[i][1] = plane.getY();
+            constants.FrustumPlanes[i][2] = plane.getZ();
+            constants.FrustumPlanes[i][3] = plane.getW();
+        }
+    }
+
+    void SetLodConstants(float lodScale, float lodPixelError, IvyInstanceCullingCBData& constants) const
+    {
+        constants.LodScale      = lodScale;
+        constants.LodPixelError = lodPixelError;
+        constants.LeafLodCount  = (lodScale > 0.f) ? m_lodCounts[0] : std::min(m_lodCounts[0], 1u);
+        constants.StemLodCount  = (lodScale > 0.f) ? m_lodCounts[1] : std::min(m_lodCounts[1], 1u);
+        for (uint32_t lod = 0; lod < IVY_MAX_MESH_LODS; ++lod)
+        {
+            constants.LeafLodErrors[lod] = m_lodErrors[0][lod];
+            constants.StemLodErrors[lod] = m_lodErrors[1][lod];
+            for (uint32_t i = 0; i < 4; ++i)
+            {
+                constants.LeafLodDraws[lod][i] = m_lodDraws[0][lod][i];
+                constants.StemLodDraws[lod][i] = m_lodDraws[1][lod][i];
+            }
+        }
+    }
+
+    static void SetSphere(const Vec4& sphere, float destination[4])
+    {
+        destination[0] = sphere.getX();
+        destination[1] = sphere.getY();
+        destination[2] = sphere.getZ();
+        destination[3] = sphere.getW();
+    }
+
+    cauldron::PipelineObject* CreatePipeline(const wchar_t* entryPoint)
+    {
+        cauldron::PipelineDesc psoDesc;
+        psoDesc.SetRootSignature(m_pRootSignature);
+        psoDesc.AddShaderDesc(cauldron::ShaderBuildDesc::Compute(L"ivyinstanceculling.hlsl", entryPoint, cauldron::ShaderModel::SM6_0, nullptr));
+
+        return cauldron::PipelineObject::CreatePipelineObject(entryPoint, psoDesc);
+    }
+
+    void Dispatch(cauldron::CommandList*          pCmdList,
+                  cauldron::PipelineObject*       pPipeline,
+                  const IvyInstanceCullingCBData& constants,
+                  uint32_t                        groupCountX,
+                  uint32_t                        groupCountY,
+                  uint32_t                        groupCountZ)
+    {
+        cauldron::BufferAddressInfo constantsInfo = cauldron::GetDynamicBufferPool()->AllocConstantBuffer(sizeof(IvyInstanceCullingCBData), &constants);
+        m_pParameterSet->UpdateRootConstantBuffer(&constantsInfo, 0);
+
+        cauldron::SetPipelineState(pCmdList, pPipeline);
+        m_pParameterSet->Bind(pCmdList, pPipeline);
+
+        cauldron::Dispatch(pCmdList, groupCountX, groupCountY, groupCountZ);
+    }
+
+    // One thread group per visible cluster of each stream
+    void DispatchVisibleClusters(cauldron::CommandList* pCmdList, cauldron::PipelineObject* pPipeline, IvyInstanceCullingCBData constants)
+    {
+        for (uint32_t stream = 0; stream < 2; ++stream)
+        {
+            constants.CullingStream = stream;
+
+            cauldron::BufferAddressInfo constantsInfo = cauldron::GetDynamicBufferPool()->AllocConstantBuffer(sizeof(IvyInstanceCullingCBData), &constants);
+            m_pParameterSet->UpdateRootConstantBuffer(&constantsInfo, 0);
+
+            cauldron::SetPipelineState(pCmdList, pPipeline);
+            m_pParameterSet->Bind(pCmdList, pPipeline);
+
+            cauldron::ExecuteIndirect(pCmdList, m_pDispatchWorkload, m_pClusterDispatchBuffer, 1, stream * sizeof(DispatchArgs));
+        }
+    }
+
+    static void UAVBarrier(cauldron::CommandList* pCmdList, std::initializer_list<const cauldron::Buffer*> buffers)
+    {
+        std::vector<cauldron::Barrier> barriers;
+        for (const cauldron::Buffer* pBuffer : buffers)
+        {
+            barriers.push_back(cauldron::Barrier::UAV(pBuffer->GetResource()));
+        }
+        cauldron::ResourceBarrier(pCmdList, static_cast<uint32_t>(barriers.size()), barriers.data());
+    }
+};
@@ -0,0 +1,305 @@
+// This file is part of the AMD Work Graph Ivy Generation Sample.
+//
+// Copyright (c) 2024 Advanced Micro Devices, Inc. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+#pragma once
+
+#include "render/buffer.h"
+#include "render/commandlist.h"
+#include "render/dynamicbufferpool.h"
+#include "render/parameterset.h"
+#include "render/pipelineobject.h"
+#include "render/rootsignature.h"
+#include "cpu/ivyinstancearena.h"
+#include "ivyretiredbuffers.h"
+#include "shaders/ivycommon.h"
+
+// D3D12 Cauldron implementation for the layout upload
+#include "render/dx12/buffer_dx12.h"
+#include "render/dx12/commandlist_dx12.h"
+#include "render/dx12/gpuresource_dx12.h"
+
+#include <algorithm>
+#include <initializer_list>
+#include <utility>
+#include <vector>
+
+/**
+ * @brief   Instance buffer partitions of the entry records & the compaction into the draw buffers (see shaders/ivyinstancepartitions.hlsl).
+ *
+ * The work graph writes to the partition buffers, laid out per stream & entry record by IvyInstanceArena.
+ * IvyRenderModule dispatches only the changed entry records, such that editing a single root only regrows that root.
+ * Every record carries its partition, the graph looks up its offsets & capacities in m_pLayoutBuffer.
+ * Compact() then rebuilds the draw buffers & arguments from all partitions.
+ * All buffers except m_pLayoutBuffer are expected in the UnorderedAccess state. The counters in m_pCounterBuffer include
+ * the instances dropped by full partitions, they are read back as IvyInstanceArenaStatus to lay out the partitions again
+ * or to grow the buffers with Resize(). The counters & the layout grow with the partitions in UploadLayout().
+ */
+struct IvyInstancePartitions
+{
+    cauldron::Buffer*         m_pCounterBuffer       = nullptr;  // uint2 (leaf, stem) per partition, m_partitionCapacity partitions
+    cauldron::Buffer*         m_pLeafPartitionBuffer = nullptr;  // m_capacity instances
+    cauldron::Buffer*         m_pStemPartitionBuffer = nullptr;  // m_capacity instances
+    cauldron::Buffer*         m_pKeyBuffer           = nullptr;  // 2 * m_capacity keys
+    cauldron::Buffer*         m_pLayoutBuffer        = nullptr;  // IvyInstancePartition per partition, m_partitionCapacity partitions
+    cauldron::RootSignature*  m_pRootSignature       = nullptr;
+    cauldron::ParameterSet*   m_pParameterSet        = nullptr;
+    cauldron::PipelineObject* m_pResetPipeline       = nullptr;
+    cauldron::PipelineObject* m_pCompactPipeline     = nullptr;
+    uint32_t                  m_capacity             = 0;  // instances per stream of all partitions
+    uint32_t                  m_partitionCapacity    = 0;
+
+    static const uint32_t ResetThreadGroupSize     = 64;   // ivyResetThreadGroupSize
+    static const uint32_t ThreadGroupSize          = 256;  // ivyCompactionThreadGroupSize
+    static const uint32_t InitialPartitionCapacity = 16;
+
+    ~IvyInstancePartitions()
+    {
+        delete m_pCounterBuffer;
+        delete m_pLeafPartitionBuffer;
+        delete m_pStemPartitionBuffer;
+        delete m_pKeyBuffer;
+        delete m_pLayoutBuffer;
+        delete m_pResetPipeline;
+        delete m_pCompactPipeline;
+        delete m_pParameterSet;
+        delete m_pRootSignature;
+    }
+
+    void Init(uint32_t capacity)
+    {
+        cauldron::RootSignatureDesc rootSigDesc;
+        rootSigDesc.AddConstantBufferView(1, cauldron::ShaderBindStage::Compute, 1);  // b1: IvyInstancePartitionCBData
+        rootSigDesc.AddBufferUAVSet(0, cauldron::ShaderBindStage::Compute, 8);        // u0-u3: draw arguments, instances & keys, u4-u7: partition counters, instances & keys
+        rootSigDesc.AddBufferSRVSet(0, cauldron::ShaderBindStage::Compute, 1);        // t0: partition layout
+        rootSigDesc.m_PipelineType = cauldron::PipelineType::Compute;
+
+        m_pRootSignature = cauldron::RootSignature::CreateRootSignature(L"IvyInstancePartitions_RootSignature", rootSigDesc);
+
+        m_pParameterSet = cauldron::ParameterSet::CreateParameterSet(m_pRootSignature);
+        m_pParameterSet->SetRootConstantBufferResource(cauldron::GetDynamicBufferPool()->GetResource(), sizeof(IvyInstancePartitionCBData), 0);
+
+        ReservePartitions(nullptr, InitialPartitionCapacity, nullptr);
+
+        m_pResetPipeline   = CreatePipeline(L"ResetPartitions");
+        m_pCompactPipeline = CreatePipeline(L"CompactPartitions");
+
+        Resize(capacity);
+    }
+
+    /**
+     * @brief   Reallocates the partition buffers for capacity instances per stream, all partitions have to be regenerated.
+     *          The old buffers are retired to pRetiredBuffers, without it they must not be in use by the GPU anymore.
+     */
+    void Resize(uint32_t capacity, IvyRetiredBuffers* pRetiredBuffers = nullptr)
+    {
+        IvyReleaseBuffer(m_pLeafPartitionBuffer, pRetiredBuffers);
+        IvyReleaseBuffer(m_pStemPartitionBuffer, pRetiredBuffers);
+        IvyReleaseBuffer(m_pKeyBuffer, pRetiredBuffers);
+
+        m_capacity = capacity;
+
+        cauldron::BufferDesc leafDesc = cauldron::BufferDesc::Data(
+            L"Ivy_LeafPartitionBuffer", sizeof(IvyEncodedInstance) * m_capacity, sizeof(IvyEncodedInstance), 0, cauldron::ResourceFlags::AllowUnorderedAccess);
+        m_pLeafPartitionBuffer = cauldron::Buffer::CreateBufferResource(&leafDesc, cauldron::ResourceState::UnorderedAccess);
+
+        cauldron::BufferDesc stemDesc = cauldron::BufferDesc::Data(
+            L"Ivy_StemPartitionBuffer", sizeof(IvyEncodedInstance) * m_capacity, sizeof(IvyEncodedInstance), 0, cauldron::ResourceFlags::AllowUnorderedAccess);
+        m_pStemPartitionBuffer = cauldron::Buffer::CreateBufferResource(&stemDesc, cauldron::ResourceState::UnorderedAccess);
+
+        cauldron::BufferDesc keyDesc = cauldron::BufferDesc::Data(
+            L"Ivy_PartitionKeyBuffer", sizeof(IvyInstanceKey) * 2 * m_capacity, sizeof(IvyInstanceKey), 0, cauldron::ResourceFlags::AllowUnorderedAccess);
+        m_pKeyBuffer = cauldron::Buffer::CreateBufferResource(&keyDesc, cauldron::ResourceState::UnorderedAccess);
+
+        m_pParameterSet->SetBufferUAV(m_pLeafPartitionBuffer, 5);
+        m_pParameterSet->SetBufferUAV(m_pStemPartitionBuffer, 6);
+        m_pParameterSet->SetBufferUAV(m_pKeyBuffer, 7);
+    }
+
+    /**
+     * @brief   Uploads the offsets & capacities of the arena layout to m_pLayoutBuffer, which is left in the
+     *          NonPixelShaderResource state, and marks the partitions the next dispatch regenerates.
+     *          Buffers that are too small for the partitions are retired to pRetiredBuffers.
+     */
+    void UploadLayout(cauldron::CommandList*       pCmdList,
+                      const IvyInstanceArena&      arena,
+                      const std::vector<uint32_t>& regeneratedPartitions,
+                      IvyRetiredBuffers*           pRetiredBuffers)
+    {
+        const uint32_t partitionCount = std::max(arena.GetPartitionCount(), 1u);
+        if (partitionCount > m_partitionCapacity)
+        {
+            ReservePartitions(pCmdList, std::max(partitionCount, 2 * m_partitionCapacity), pRetiredBuffers);
+        }
+
+        std::vector<IvyInstancePartition> layout(partitionCount);
+        for (uint32_t partition = 0; partition < arena.GetPartitionCount(); ++partition)
+        {
+            for (uint32_t stream = 0; stream < 2; ++stream)
+            {
+                layout[partition].offset[stream]   = arena.GetPartitionOffset(stream, partition);
+                layout[partition].capacity[stream] = arena.GetPartitionCapacity(stream, partition);
+            }
+        }
+        for (uint32_t partition : regeneratedPartitions)
+        {
+            layout[partition].regenerate = 1;
+        }
+
+        cauldron::Barrier barrier = cauldron::Barrier::Transition(
+            m_pLayoutBuffer->GetResource(), cauldron::ResourceState::NonPixelShaderResource, cauldron::ResourceState::CopyDest);
+        cauldron::ResourceBarrier(pCmdList, 1, &barrier);
+
+        // The dynamic buffer pool is an upload ring, its allocations stay valid until the GPU has completed the frame
+        const uint32_t              layoutSize      = static_cast<uint32_t>(sizeof(IvyInstancePartition) * layout.size());
+        cauldron::BufferAddressInfo uploadInfo      = cauldron::GetDynamicBufferPool()->AllocConstantBuffer(layoutSize, layout.data());
+        ID3D12Resource*             pUploadResource = cauldron::GetDynamicBufferPool()->GetResource()->GetImpl()->DX12Resource();
+        const UINT64                uploadOffset    = uploadInfo.GetImpl()->GPUBufferView - pUploadResource->GetGPUVirtualAddress();
+        pCmdList->GetImpl()->DX12CmdList()->CopyBufferRegion(
+            m_pLayoutBuffer->GetResource()->GetImpl()->DX12Resource(), 0, pUploadResource, uploadOffset, layoutSize);
+
+        std::swap(barrier.SourceState, barrier.DestState);
+        cauldron::ResourceBarrier(pCmdList, 1, &barrier);
+    }
+
+    /**
+     * @brief   Resets the counters of the partitions marked by UploadLayout(), has to precede the work graph dispatch.
+     */
+    void Reset(cauldron::CommandList* pCmdList, uint32_t partitionCount)
+    {
+        IvyInstancePartitionCBData constants = {};
+        constants.PartitionCount             = partitionCount;
+
+        Dispatch(pCmdList, m_pResetPipeline, constants, (partitionCount + ResetThreadGroupSize - 1) / ResetThreadGroupSize, 1, 1);
+        UAVBarrier(pCmdList, {m_pCounterBuffer});
+    }
+
+    /**
+     * @brief   Packs the instances & keys of all partitions of the arena layout into the draw buffers and writes
+     *          the draw arguments.
+     */
+    void Compact(cauldron::CommandList*  pCmdList,
+                 const IvyInstanceArena& arena,
+                 uint32_t                leafIndexCount,
+                 uint32_t                stemIndexCount,
+                 const cauldron::Buffer* pArgumentBuffer,
+                 const cauldron::Buffer* pLeafInstanceBuffer,
+                 const cauldron::Buffer* pStemInstanceBuffer,
+                 const cauldron::Buffer* pInstanceKeyBuffer)
+    {
+        m_pParameterSet->SetBufferUAV(pArgumentBuffer, 0);
+        m_pParameterSet->SetBufferUAV(pLeafInstanceBuffer, 1);
+        m_pParameterSet->SetBufferUAV(pStemInstanceBuffer, 2);
+        m_pParameterSet->SetBufferUAV(pInstanceKeyBuffer, 3);
+
+        // Work graph outputs have to be complete before compacting
+        UAVBarrier(pCmdList, {m_pCounterBuffer, m_pLeafPartitionBuffer, m_pStemPartitionBuffer, m_pKeyBuffer});
+
+        IvyInstancePartitionCBData constants = {};
+        constants.PartitionCount             = arena.GetPartitionCount();
+        constants.LeafIndexCount             = leafIndexCount;
+        constants.StemIndexCount             = stemIndexCount;
+        constants.ArenaCapacity              = m_capacity;
+
+        // z = 0: leaf instances, z = 1: stem instances
+        // The first thread of the last partition writes the draw arguments, even if all partitions are empty
+        const uint32_t groupCountX = std::max((arena.GetMaxPartitionCapacity() + ThreadGroupSize - 1) / ThreadGroupSize, 1u);
+        Dispatch(pCmdList, m_pCompactPipeline, constants, groupCountX, constants.PartitionCount, 2);
+        UAVBarrier(pCmdList, {pArgumentBuffer, pLeafInstanceBuffer, pStemInstanceBuffer, pInstanceKeyBuffer});
+    }
+
+private:
+    // Reallocates the counters & the layout for partitionCount partitions, the counters of the old buffer are copied
+    void ReservePartitions(cauldron::CommandList* pCmdList, uint32_t partitionCount, IvyRetiredBuffers* pRetiredBuffers)
+    {
+        cauldron::Buffer* pOldCounterBuffer = m_pCounterBuffer;
+        IvyReleaseBuffer(m_pLayoutBuffer, pRetiredBuffers);
+
+        cauldron::BufferDesc counterDesc = cauldron::BufferDesc::Data(
+            L"Ivy_PartitionCounterBuffer", sizeof(uint32_t) * 2 * partitionCount, sizeof(uint32_t) * 2, 0, cauldron::ResourceFlags::AllowUnorderedAccess);
+        m_pCounterBuffer = cauldron::Buffer::CreateBufferResource(&counterDesc, cauldron::ResourceState::UnorderedAccess);
+
+        cauldron::BufferDesc layoutDesc = cauldron::BufferDesc::Data(
+            L"Ivy_PartitionLayoutBuffer", sizeof(IvyInstancePartition) * partitionCount, sizeof(IvyInstancePartition), 0, cauldron::ResourceFlags::None);
+        m_pLayoutBuffer = cauldron::Buffer::CreateBufferResource(&layoutDesc, cauldron::ResourceState::NonPixelShaderResource);
+
+        // Partitions that are not regenerated keep their counters for the compaction
+        if (pOldCounterBuffer)
+        {
+            cauldron::Barrier barriers[2] = {
+                cauldron::Barrier::Transition(pOldCounterBuffer->GetResource(), cauldron::ResourceState::UnorderedAccess, cauldron::ResourceState::CopySource),
+                cauldron::Barrier::Transition(m_pCounterBuffer->GetResource(), cauldron::ResourceState::UnorderedAccess, cauldron::ResourceState::CopyDest)};
+            cauldron::ResourceBarrier(pCmdList, 2, barriers);
+
+            pCmdList->GetImpl()->DX12CmdList()->CopyBufferRegion(m_pCounterBuffer->GetResource()->GetImpl()->DX12Resource(),
+                                                                 0,
+                                                                 pOldCounterBuffer->GetResource()->GetImpl()->DX12Resource(),
+                                                                 0,
+                                                                 sizeof(uint32_t) * 2 * m_partitionCapacity);
+
+            std::swap(barriers[0].SourceState, barriers[0].DestState);
+            std::swap(barriers[1].SourceState, barriers[1].DestState);
+            cauldron::ResourceBarrier(pCmdList, 2, barriers);
+
+            IvyReleaseBuffer(pOldCounterBuffer, pRetiredBuffers);
+        }
+
+        m_partitionCapacity = partitionCount;
+
+        m_pParameterSet->SetBufferUAV(m_pCounterBuffer, 4);
+        m_pParameterSet->SetBufferSRV(m_pLayoutBuffer, 0);
+    }
+
+    cauldron::PipelineObject* CreatePipeline(const wchar_t* entryPoint)
+    {
+        cauldron::PipelineDesc psoDesc;
+        psoDesc.SetRootSignature(m_pRootSignature);
+        psoDesc.AddShaderDesc(cauldron::ShaderBuildDesc::Compute(L"ivyinstancepartitions.hlsl", entryPoint, cauldron::ShaderModel::SM6_0, nullptr));
+
+        return cauldron::PipelineObject::CreatePipelineObject(entryPoint, psoDesc);
+    }
+
+    void Dispatch(cauldron::CommandList*            pCmdList,
+                  cauldron::PipelineObject*         pPipeline,
+                  const IvyInstancePartitionCBData& constants,
+                  uint32_t                          groupCountX,
+                  uint32_t                          groupCountY,
+                  uint32_t                          groupCountZ)
+    {
+        cauldron::BufferAddressInfo constantsInfo = cauldron::GetDynamicBufferPool()->AllocConstantBuffer(sizeof(IvyInstancePartitionCBData), &constants);
+        m_pParameterSet->UpdateRootConstantBuffer(&constantsInfo, 0);
+
+        cauldron::SetPipelineState(pCmdList, pPipeline);
+        m_pParameterSet->Bind(pCmdList, pPipeline);
+
+        cauldron::Dispatch(pCmdList, groupCountX, groupCountY, groupCountZ);
+    }
+
+    static void UAVBarrier(cauldron::CommandList* pCmdList, std::initializer_list<const cauldron::Buffer*> buffers)
+    {
+        std::vector<cauldron::Barrier> barriers;
+        for (const cauldron::Buffer* pBuffer : buffers)
+        {
+            barriers.push_back(cauldron::Barrier::UAV(pBuffer->GetResource()));
+        }
+        cauldron::ResourceBarrier(pCmdList, static_cast<uint32_t>(barriers.size()), barriers.data());
+    }
+};
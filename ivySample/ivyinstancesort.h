@@ -0,0 +1,191 @@
+// This file is part of the AMD Work Graph Ivy Generation Sample.
+//
+// Copyright (c) 2024 Advanced Micro Devices, Inc. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+#pragma once
+
+#include "render/buffer.h"
+#include "render/commandlist.h"
+#include "render/dynamicbufferpool.h"
+#include "render/parameterset.h"
+#include "render/pipelineobject.h"
+#include "render/rootsignature.h"
+#include "cpu/ivyinstancearena.h"
+#include "ivyretiredbuffers.h"
+#include "shaders/ivycommon.h"
+
+#include <initializer_list>
+#include <vector>
+
+/**
+ * @brief   Compute post-pass that sorts the leaf & stem instance buffers by IvyInstanceKey (see shaders/ivyinstancesort.hlsl).
+ *
+ * IvyBranch compacts its outputs with InterlockedAdd, which makes the instance order depend on scheduling.
+ * After sorting, both instance buffers hold the same instances in the same order for every frame & GPU,
+ * matching IvyCpuEngine::SetDeterministicOrder up to instances with equal keys.
+ * All buffers are expected in the UnorderedAccess state.
+ * The sort & scratch buffers are sized for the capacity of the instance arena, see Resize().
+ */
+struct IvyInstanceSort
+{
+    cauldron::Buffer*         m_pSortEntryBuffer       = nullptr;  // 2 * m_sortCapacity entries
+    cauldron::Buffer*         m_pScratchInstanceBuffer = nullptr;  // 2 * m_capacity instances
+    cauldron::RootSignature*  m_pRootSignature         = nullptr;
+    cauldron::ParameterSet*   m_pParameterSet          = nullptr;
+    cauldron::PipelineObject* m_pInitPipeline          = nullptr;
+    cauldron::PipelineObject* m_pSortStepPipeline      = nullptr;
+    cauldron::PipelineObject* m_pGatherPipeline        = nullptr;
+    cauldron::PipelineObject* m_pCopyPipeline          = nullptr;
+    uint32_t                  m_capacity               = 0;  // instances per stream
+    uint32_t                  m_sortCapacity           = 0;  // power of two >= m_capacity, at least 2 thread groups
+
+    static const uint32_t ThreadGroupSize = 256;  // ivySortThreadGroupSize
+
+    ~IvyInstanceSort()
+    {
+        delete m_pSortEntryBuffer;
+        delete m_pScratchInstanceBuffer;
+        delete m_pInitPipeline;
+        delete m_pSortStepPipeline;
+        delete m_pGatherPipeline;
+        delete m_pCopyPipeline;
+        delete m_pParameterSet;
+        delete m_pRootSignature;
+    }
+
+    void Init(uint32_t capacity)
+    {
+        cauldron::RootSignatureDesc rootSigDesc;
+        rootSigDesc.AddConstantBufferView(1, cauldron::ShaderBindStage::Compute, 1);  // b1: IvyInstanceSortCBData
+        rootSigDesc.AddBufferUAVSet(0, cauldron::ShaderBindStage::Compute, 6);        // u0: arguments, u1/u2: leaf/stem instances, u3: keys, u4: entries, u5: scratch
+        rootSigDesc.m_PipelineType = cauldron::PipelineType::Compute;
+
+        m_pRootSignature = cauldron::RootSignature::CreateRootSignature(L"IvyInstanceSort_RootSignature", rootSigDesc);
+
+        m_pParameterSet = cauldron::ParameterSet::CreateParameterSet(m_pRootSignature);
+        m_pParameterSet->SetRootConstantBufferResource(cauldron::GetDynamicBufferPool()->GetResource(), sizeof(IvyInstanceSortCBData), 0);
+
+        m_pInitPipeline     = CreatePipeline(L"InitSortEntries");
+        m_pSortStepPipeline = CreatePipeline(L"BitonicSortStep");
+        m_pGatherPipeline   = CreatePipeline(L"GatherInstances");
+        m_pCopyPipeline     = CreatePipeline(L"CopyInstances");
+
+        Resize(capacity);
+    }
+
+    /**
+     * @brief   Reallocates the sort & scratch buffers for capacity instances per stream.
+     *          The old buffers are retired to pRetiredBuffers, without it they must not be in use by the GPU anymore.
+     */
+    void Resize(uint32_t capacity, IvyRetiredBuffers* pRetiredBuffers = nullptr)
+    {
+        IvyReleaseBuffer(m_pSortEntryBuffer, pRetiredBuffers);
+        IvyReleaseBuffer(m_pScratchInstanceBuffer, pRetiredBuffers);
+
+        m_capacity     = capacity;
+        m_sortCapacity = std::max(IvyInstanceArena::RoundUpToPowerOfTwo(capacity), 2 * ThreadGroupSize);
+
+        cauldron::BufferDesc entryDesc = cauldron::BufferDesc::Data(
+            L"Ivy_InstanceSortEntryBuffer", sizeof(uint32_t) * 4 * 2 * m_sortCapacity, sizeof(uint32_t) * 4, 0, cauldron::ResourceFlags::AllowUnorderedAccess);
+        m_pSortEntryBuffer = cauldron::Buffer::CreateBufferResource(&entryDesc, cauldron::ResourceState::UnorderedAccess);
+
+        cauldron::BufferDesc scratchDesc = cauldron::BufferDesc::Data(
+            L"Ivy_InstanceSortScratchBuffer", sizeof(IvyEncodedInstance) * 2 * m_capacity, sizeof(IvyEncodedInstance), 0, cauldron::ResourceFlags::AllowUnorderedAccess);
+        m_pScratchInstanceBuffer = cauldron::Buffer::CreateBufferResource(&scratchDesc, cauldron::ResourceState::UnorderedAccess);
+
+        m_pParameterSet->SetBufferUAV(m_pSortEntryBuffer, 4);
+        m_pParameterSet->SetBufferUAV(m_pScratchInstanceBuffer, 5);
+    }
+
+    void Execute(cauldron::CommandList*  pCmdList,
+                 const cauldron::Buffer* pArgumentBuffer,
+                 const cauldron::Buffer* pLeafInstanceBuffer,
+                 const cauldron::Buffer* pStemInstanceBuffer,
+                 const cauldron::Buffer* pInstanceKeyBuffer)
+    {
+        m_pParameterSet->SetBufferUAV(pArgumentBuffer, 0);
+        m_pParameterSet->SetBufferUAV(pLeafInstanceBuffer, 1);
+        m_pParameterSet->SetBufferUAV(pStemInstanceBuffer, 2);
+        m_pParameterSet->SetBufferUAV(pInstanceKeyBuffer, 3);
+
+        // Work graph outputs have to be complete before sorting
+        UAVBarrier(pCmdList, {pArgumentBuffer, pLeafInstanceBuffer, pStemInstanceBuffer, pInstanceKeyBuffer});
+
+        const uint32_t entryGroupCount = m_sortCapacity / ThreadGroupSize;
+
+        Dispatch(pCmdList, m_pInitPipeline, 0, 0, entryGroupCount);
+        UAVBarrier(pCmdList, {m_pSortEntryBuffer});
+
+        // Threads of pairs beyond the instance count return early, so sorting the full capacity stays cheap for small counts
+        for (uint32_t blockSize = 2; blockSize <= m_sortCapacity; blockSize *= 2)
+        {
+            for (uint32_t stepSize = blockSize / 2; stepSize > 0; stepSize /= 2)
+            {
+                Dispatch(pCmdList, m_pSortStepPipeline, blockSize, stepSize, entryGroupCount / 2);
+                UAVBarrier(pCmdList, {m_pSortEntryBuffer});
+            }
+        }
+
+        Dispatch(pCmdList, m_pGatherPipeline, 0, 0, entryGroupCount);
+        UAVBarrier(pCmdList, {m_pScratchInstanceBuffer});
+
+        Dispatch(pCmdList, m_pCopyPipeline, 0, 0, entryGroupCount);
+        UAVBarrier(pCmdList, {pLeafInstanceBuffer, pStemInstanceBuffer});
+    }
+
+private:
+    cauldron::PipelineObject* CreatePipeline(const wchar_t* entryPoint)
+    {
+        cauldron::PipelineDesc psoDesc;
+        psoDesc.SetRootSignature(m_pRootSignature);
+        psoDesc.AddShaderDesc(cauldron::ShaderBuildDesc::Compute(L"ivyinstancesort.hlsl", entryPoint, cauldron::ShaderModel::SM6_0, nullptr));
+
+        return cauldron::PipelineObject::CreatePipelineObject(entryPoint, psoDesc);
+    }
+
+    void Dispatch(cauldron::CommandList* pCmdList, cauldron::PipelineObject* pPipeline, uint32_t blockSize, uint32_t stepSize, uint32_t groupCount)
+    {
+        IvyInstanceSortCBData constants = {};
+        constants.BlockSize             = blockSize;
+        constants.StepSize              = stepSize;
+        constants.ArenaCapacity         = m_capacity;
+        constants.SortCapacity          = m_sortCapacity;
+
+        cauldron::BufferAddressInfo constantsInfo = cauldron::GetDynamicBufferPool()->AllocConstantBuffer(sizeof(IvyInstanceSortCBData), &constants);
+        m_pParameterSet->UpdateRootConstantBuffer(&constantsInfo, 0);
+
+        cauldron::SetPipelineState(pCmdList, pPipeline);
+        m_pParameterSet->Bind(pCmdList, pPipeline);
+
+        // y = 0: leaf instances, y = 1: stem instances
+        cauldron::Dispatch(pCmdList, groupCount, 2, 1);
+    }
+
+    static void UAVBarrier(cauldron::CommandList* pCmdList, std::initializer_list<const cauldron::Buffer*> buffers)
+    {
+        std::vector<cauldron::Barrier> barriers;
+        for (const cauldron::Buffer* pBuffer : buffers)
+        {
+            barriers.push_back(cauldron::Barrier::UAV(pBuffer->GetResource()));
+        }
+        cauldron::ResourceBarrier(pCmdList, static_cast<uint32_t>(barriers.size()), barriers.data());
+    }
+};
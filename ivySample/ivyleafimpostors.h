@@ -0,0 +1,171 @@
+// This file is part of the AMD Work Graph Ivy Generation Sample.
+//
+// Copyright (c) 2024 Advanced Micro Devices, Inc. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+#pragma once
+
+#include "render/buffer.h"
+#include "render/commandlist.h"
+#include "render/device.h"
+#include "render/dynamicbufferpool.h"
+#include "render/dynamicresourcepool.h"
+#include "render/indirectworkload.h"
+#include "render/parameterset.h"
+#include "render/pipelineobject.h"
+#include "render/rootsignature.h"
+#include "render/texture.h"
+#include "cpu/ivyleafimpostoratlas.h"
+#include "ivyinstanceculling.h"
+#include "shaders/ivycommon.h"
+
+/**
+ * @brief   Draws the distant leaf clusters selected by IvyInstanceCulling as impostor quads, see shaders/ivyleafimpostor_indirect.hlsl.
+ *
+ * The quads are built with the clusters (IvyInstanceCulling::BuildClusters), the impostor clusters & their draw arguments are written
+ * by IvyInstanceCulling::Execute. The atlas is baked on the CPU (see cpu/ivyleafimpostoratlas.h) and uploaded as structured buffer
+ * of packed texels, so the pass does not need a texture upload path or a sampler.
+ */
+struct IvyLeafImpostors
+{
+    cauldron::IndirectWorkload* m_pIndirectWorkload = nullptr;
+    cauldron::RootSignature*    m_pRootSignature    = nullptr;
+    cauldron::ParameterSet*     m_pParameterSet     = nullptr;
+    cauldron::PipelineObject*   m_pPipelineObject   = nullptr;
+    const cauldron::Buffer*     m_pAtlasBuffer      = nullptr;  // IvyLeafImpostorAtlas::Texels
+    uint32_t                    m_atlasTileSize     = 0;
+
+    // The quad & cluster buffers are recreated by IvyInstanceCulling::Resize
+    const cauldron::Buffer* m_pBoundQuadBuffer    = nullptr;
+    const cauldron::Buffer* m_pBoundClusterBuffer = nullptr;
+
+    // Atlas texels with lower coverage are discarded
+    float m_alphaThreshold = 0.5f;
+
+    ~IvyLeafImpostors()
+    {
+        delete m_pIndirectWorkload;
+        delete m_pParameterSet;
+        delete m_pRootSignature;
+        delete m_pPipelineObject;
+    }
+
+    void Init(const cauldron::Texture* pAlbedoRT,
+              const cauldron::Texture* pNormalRT,
+              const cauldron::Texture* pAoRoughnessMetallicRT,
+              const cauldron::Texture* pMotionRT,
+              const cauldron::Texture* pDepthRT)
+    {
+        m_pIndirectWorkload = cauldron::IndirectWorkload::CreateIndirectWorkload(cauldron::IndirectCommandType::Draw);
+
+        cauldron::RootSignatureDesc rootSigDesc;
+        rootSigDesc.AddConstantBufferView(0, cauldron::ShaderBindStage::VertexAndPixel, 1);  // IvyLeafImpostorCBData
+        rootSigDesc.AddBufferSRVSet(0, cauldron::ShaderBindStage::VertexAndPixel, 3);        // t0: quads, t1: impostor clusters, t2: atlas
+        rootSigDesc.m_PipelineType = cauldron::PipelineType::Graphics;
+
+        m_pRootSignature = cauldron::RootSignature::CreateRootSignature(L"IvyLeafImpostors_RootSignature", rootSigDesc);
+        m_pParameterSet  = cauldron::ParameterSet::CreateParameterSet(m_pRootSignature);
+        m_pParameterSet->SetRootConstantBufferResource(cauldron::GetDynamicBufferPool()->GetResource(), sizeof(IvyLeafImpostorCBData), 0);
+
+        cauldron::PipelineDesc psoDesc;
+        psoDesc.SetRootSignature(m_pRootSignature);
+        psoDesc.AddShaderDesc(cauldron::ShaderBuildDesc::Vertex(L"ivyleafimpostor_indirect.hlsl", L"VSMain", cauldron::ShaderModel::SM6_0, nullptr));
+        psoDesc.AddShaderDesc(cauldron::ShaderBuildDesc::Pixel(L"ivyleafimpostor_indirect.hlsl", L"PSMain", cauldron::ShaderModel::SM6_0, nullptr));
+
+        // The corners are fetched from the quad buffer, no vertex input
+        psoDesc.AddInputLayout(std::vector<cauldron::InputLayoutDesc>());
+
+        // Quads are seen from both sides
+        cauldron::RasterDesc rasterDesc;
+        rasterDesc.CullingMode           = cauldron::CullMode::None;
+        rasterDesc.FrontCounterClockwise = true;
+        psoDesc.AddRasterStateDescription(&rasterDesc);
+        psoDesc.AddPrimitiveTopology(cauldron::PrimitiveTopologyType::Triangle);
+
+        // Same depth state & render targets as IvyRenderIndirect
+        cauldron::DepthDesc depthDesc;
+        depthDesc.DepthEnable      = true;
+        depthDesc.DepthWriteEnable = true;
+        depthDesc.DepthFunc        = cauldron::ComparisonFunc::LessEqual;
+        psoDesc.AddDepthState(&depthDesc);
+
+        cauldron::ResourceFormat colorFormats[4] = {pAlbedoRT->GetFormat(), pNormalRT->GetFormat(), pAoRoughnessMetallicRT->GetFormat(), pMotionRT->GetFormat()};
+        psoDesc.AddRenderTargetFormats(4, colorFormats, pDepthRT->GetFormat());
+
+        m_pPipelineObject = cauldron::PipelineObject::CreatePipelineObject(L"IvyLeafImpostors_PSO", psoDesc);
+    }
+
+    /**
+     * @brief   Uploads the baked (or loaded) atlas, replaces the previous one.
+     */
+    void UploadAtlas(const IvyLeafImpostorAtlas& atlas)
+    {
+        const uint32_t atlasSize = static_cast<uint32_t>(sizeof(uint32_t) * atlas.Texels.size());
+
+        cauldron::BufferDesc atlasDesc = cauldron::BufferDesc::Data(L"Ivy_LeafImpostorAtlas", atlasSize, sizeof(uint32_t), 0, cauldron::ResourceFlags::None);
+        m_pAtlasBuffer                 = cauldron::GetDynamicResourcePool()->CreateBuffer(&atlasDesc, cauldron::ResourceState::CopyDest);
+        const_cast<cauldron::Buffer*>(m_pAtlasBuffer)->CopyData(atlas.Texels.data(), atlasSize);
+
+        const cauldron::Barrier barrier = cauldron::Barrier::Transition(
+            m_pAtlasBuffer->GetResource(), cauldron::ResourceState::CopyDest, cauldron::ResourceState::PixelShaderResource);
+        cauldron::GetDevice()->ExecuteResourceTransitionImmediate(1, &barrier);
+
+        m_pParameterSet->SetBufferSRV(m_pAtlasBuffer, 2);
+        m_atlasTileSize = atlas.TileSize;
+    }
+
+    bool IsValid() const
+    {
+        return m_pPipelineObject && m_pAtlasBuffer;
+    }
+
+    /**
+     * @brief   Draws the impostor clusters of the last IvyInstanceCulling::Execute, between BeginRaster & EndRaster of the GBuffer.
+     */
+    void Render(cauldron::CommandList* pCmdList, const Mat4& viewProjection, const IvyInstanceCulling& culling)
+    {
+        if (!IsValid() || !culling.m_pImpostorArgumentBuffer)
+            return;
+
+        if ((culling.m_pImpostorQuadBuffer != m_pBoundQuadBuffer) || (culling.m_pImpostorClusterBuffer != m_pBoundClusterBuffer))
+        {
+            m_pParameterSet->SetBufferSRV(culling.m_pImpostorQuadBuffer, 0);
+            m_pParameterSet->SetBufferSRV(culling.m_pImpostorClusterBuffer, 1);
+            m_pBoundQuadBuffer    = culling.m_pImpostorQuadBuffer;
+            m_pBoundClusterBuffer = culling.m_pImpostorClusterBuffer;
+        }
+
+        IvyLeafImpostorCBData constants;
+        constants.ImpostorViewProjection = viewProjection;
+        constants.AtlasTileSize          = m_atlasTileSize;
+        constants.AtlasWidth             = m_atlasTileSize * IVY_LEAF_IMPOSTOR_TILES;
+        constants.AlphaThreshold         = m_alphaThreshold;
+        constants.AtlasPadding           = 0;
+
+        cauldron::BufferAddressInfo constantsInfo = cauldron::GetDynamicBufferPool()->AllocConstantBuffer(sizeof(IvyLeafImpostorCBData), &constants);
+        m_pParameterSet->UpdateRootConstantBuffer(&constantsInfo, 0);
+
+        cauldron::SetPipelineState(pCmdList, m_pPipelineObject);
+        cauldron::SetPrimitiveTopology(pCmdList, cauldron::PrimitiveTopology::TriangleList);
+        m_pParameterSet->Bind(pCmdList, m_pPipelineObject);
+
+        cauldron::ExecuteIndirect(pCmdList, m_pIndirectWorkload, culling.m_pImpostorArgumentBuffer, 1 /*drawCount*/, 0);
+    }
+};
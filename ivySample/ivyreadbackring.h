@@ -0,0 +1,176 @@
+// This file is part of the AMD Work Graph Ivy Generation Sample.
+//
+// Copyright (c) 2024 Advanced Micro Devices, Inc. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+#pragma once
+
+#include "misc/assert.h"
+#include "render/buffer.h"
+#include "render/commandlist.h"
+#include "render/device.h"
+
+// D3D12 Cauldron implementation
+#include "render/dx12/commandlist_dx12.h"
+#include "render/dx12/device_dx12.h"
+#include "render/dx12/gpuresource_dx12.h"
+
+// d3dx12 for the readback heap
+#include "d3dx12/d3dx12.h"
+
+#include <cstdint>
+#include <string>
+#include <utility>
+
+/**
+ * @brief   Ring of readback slots for small GPU buffers, read without ever waiting for the GPU.
+ *
+ * Copy() records a copy into the slot of the current frame, BeginFrame() returns the copy of the same slot
+ * SlotCount frames later. Cauldron has at most 3 frames in flight, so that copy has completed by then.
+ * Slots of frames without a copy stay empty. Resize() drops all copies that were not returned yet.
+ */
+struct IvyReadbackRing
+{
+    static const uint32_t SlotCount = 4;
+
+    ID3D12Resource* m_pReadbackBuffer                    = nullptr;
+    ID3D12Resource* m_pRetiredReadbackBuffers[SlotCount] = {};  // replaced by Resize() in the frame of the slot
+    const uint8_t*  m_pData                              = nullptr;  // persistently mapped
+    uint32_t        m_slotSize                           = 0;
+    uint32_t        m_slot                               = SlotCount - 1;  // slot of the current frame
+    bool            m_slotWritten[SlotCount]             = {};
+    std::wstring    m_name;
+
+    ~IvyReadbackRing()
+    {
+        if (m_pReadbackBuffer)
+        {
+            m_pReadbackBuffer->Release();
+        }
+        for (uint32_t slot = 0; slot < SlotCount; ++slot)
+        {
+            ReleaseRetiredBuffer(slot);
+        }
+    }
+
+    void Init(const wchar_t* name, uint32_t slotSize)
+    {
+        m_name     = name;
+        m_slotSize = slotSize;
+
+        const CD3DX12_HEAP_PROPERTIES heapProperties(D3D12_HEAP_TYPE_READBACK);
+        const CD3DX12_RESOURCE_DESC   bufferDesc = CD3DX12_RESOURCE_DESC::Buffer(static_cast<UINT64>(m_slotSize) * SlotCount);
+        CauldronThrowOnFail(cauldron::GetDevice()->GetImpl()->DX12Device()->CreateCommittedResource(
+            &heapProperties, D3D12_HEAP_FLAG_NONE, &bufferDesc, D3D12_RESOURCE_STATE_COPY_DEST, nullptr, IID_PPV_ARGS(&m_pReadbackBuffer)));
+        m_pReadbackBuffer->SetName(name);
+
+        void* pData = nullptr;
+        CauldronThrowOnFail(m_pReadbackBuffer->Map(0, nullptr, &pData));
+        m_pData = static_cast<const uint8_t*>(pData);
+    }
+
+    /**
+     * @brief   Reallocates the slots for slotSize bytes. Copies of frames in flight may still target the old buffer,
+     *          it is released SlotCount frames later.
+     */
+    void Resize(uint32_t slotSize)
+    {
+        ReleaseRetiredBuffer(m_slot);
+        m_pRetiredReadbackBuffers[m_slot] = m_pReadbackBuffer;
+        m_pReadbackBuffer                 = nullptr;
+
+        const std::wstring name = m_name;
+        Invalidate();
+        Init(name.c_str(), slotSize);
+    }
+
+    /**
+     * @brief   Advances to the slot of the next frame, has to be called once per frame before Copy().
+     *          Returns the copy of SlotCount frames ago, or nullptr if that frame did not copy.
+     */
+    const void* BeginFrame()
+    {
+        m_slot = (m_slot + 1) % SlotCount;
+        ReleaseRetiredBuffer(m_slot);
+
+        const bool written    = m_slotWritten[m_slot];
+        m_slotWritten[m_slot] = false;
+        return written ? m_pData + m_slot * m_slotSize : nullptr;
+    }
+
+    /**
+     * @brief   Slot of the current frame, e.g. to keep additional CPU data along with a copy.
+     */
+    uint32_t GetSlot() const
+    {
+        return m_slot;
+    }
+
+    /**
+     * @brief   Drops all copies that were not returned by BeginFrame() yet.
+     */
+    void Invalidate()
+    {
+        for (bool& written : m_slotWritten)
+        {
+            written = false;
+        }
+    }
+
+    /**
+     * @brief   Copies the first m_slotSize bytes of pBuffer, which is in state & returned to it, to the slot of the current frame.
+     */
+    void Copy(cauldron::CommandList* pCmdList, const cauldron::Buffer* pBuffer, cauldron::ResourceState state)
+    {
+        cauldron::Barrier barrier = cauldron::Barrier::Transition(pBuffer->GetResource(), state, cauldron::ResourceState::CopySource);
+        cauldron::ResourceBarrier(pCmdList, 1, &barrier);
+
+        pCmdList->GetImpl()->DX12CmdList()->CopyBufferRegion(
+            m_pReadbackBuffer, static_cast<UINT64>(m_slot) * m_slotSize, pBuffer->GetResource()->GetImpl()->DX12Resource(), 0, m_slotSize);
+
+        std::swap(barrier.SourceState, barrier.DestState);
+        cauldron::ResourceBarrier(pCmdList, 1, &barrier);
+
+        m_slotWritten[m_slot] = true;
+    }
+
+    /**
+     * @brief   Resolves queryCount queries of pQueryHeap, starting at startQuery, to the slot of the current frame.
+     */
+    void ResolveQueryData(cauldron::CommandList* pCmdList, ID3D12QueryHeap* pQueryHeap, D3D12_QUERY_TYPE type, uint32_t startQuery, uint32_t queryCount)
+    {
+        CauldronAssert(cauldron::ASSERT_CRITICAL, queryCount * sizeof(UINT64) <= m_slotSize, L"Resolved queries exceed the readback slot.");
+
+        pCmdList->GetImpl()->DX12CmdList()->ResolveQueryData(
+            pQueryHeap, type, startQuery, queryCount, m_pReadbackBuffer, static_cast<UINT64>(m_slot) * m_slotSize);
+
+        m_slotWritten[m_slot] = true;
+    }
+
+private:
+    void ReleaseRetiredBuffer(uint32_t slot)
+    {
+        if (m_pRetiredReadbackBuffers[slot])
+        {
+            m_pRetiredReadbackBuffers[slot]->Release();
+            m_pRetiredReadbackBuffers[slot] = nullptr;
+        }
+    }
+};
@@ -3,6 +3,8 @@
 #include "render/indirectworkload.h"
 #include "render/buffer.h"
 #include "render/commandlist.h"
+#include "render/device.h"
+#include "render/dynamicresourcepool.h"
 #include "render/gpuresource.h"
 #include "render/pipelineobject.h"
 #include "render/rootsignature.h"
@@ -10,10 +12,58 @@
 #include "core/framework.h"
 #include "misc/assert.h"
 #include "misc/math.h"
+#include "cpu/ivymeshsimplifier.h"
 #include "shaders/ivycommon.h"
 #include "shadercompiler.h"
 #include <dxcapi.h>
 
+#include <algorithm>
+#include <string>
+#include <vector>
+
+/**
+ * @brief   GPU copy of the LOD chain of the leaf or stem mesh (see cpu/ivymeshsimplifier.h), drawn by IvyRenderIndirect
+ *          in place of the vertex & index buffers of the loaded surface. LOD 0 has the indices of the surface.
+ */
+struct IvyMeshLodBuffers
+{
+    const cauldron::Buffer* m_pPositionBuffer = nullptr;
+    const cauldron::Buffer* m_pNormalBuffer   = nullptr;
+    const cauldron::Buffer* m_pIndexBuffer    = nullptr;
+    std::vector<IvyMeshLod> m_lods;
+
+    void Upload(const std::wstring& name, const IvyMeshLodChain& chain)
+    {
+        const uint32_t vertexSize = static_cast<uint32_t>(sizeof(float) * chain.Positions.size());
+        const uint32_t indexSize  = static_cast<uint32_t>(sizeof(uint32_t) * chain.Indices.size());
+
+        cauldron::BufferDesc positionDesc = cauldron::BufferDesc::Vertex((name + L"_LodPositions").c_str(), vertexSize, sizeof(float) * 3);
+        m_pPositionBuffer                 = cauldron::GetDynamicResourcePool()->CreateBuffer(&positionDesc, cauldron::ResourceState::CopyDest);
+        const_cast<cauldron::Buffer*>(m_pPositionBuffer)->CopyData(chain.Positions.data(), vertexSize);
+
+        cauldron::BufferDesc normalDesc = cauldron::BufferDesc::Vertex((name + L"_LodNormals").c_str(), vertexSize, sizeof(float) * 3);
+        m_pNormalBuffer                 = cauldron::GetDynamicResourcePool()->CreateBuffer(&normalDesc, cauldron::ResourceState::CopyDest);
+        const_cast<cauldron::Buffer*>(m_pNormalBuffer)->CopyData(chain.Normals.data(), vertexSize);
+
+        cauldron::BufferDesc indexDesc = cauldron::BufferDesc::Index((name + L"_LodIndices").c_str(), indexSize, cauldron::ResourceFormat::R32_UINT);
+        m_pIndexBuffer                 = cauldron::GetDynamicResourcePool()->CreateBuffer(&indexDesc, cauldron::ResourceState::CopyDest);
+        const_cast<cauldron::Buffer*>(m_pIndexBuffer)->CopyData(chain.Indices.data(), indexSize);
+
+        const cauldron::Barrier barriers[] = {
+            cauldron::Barrier::Transition(m_pPositionBuffer->GetResource(), cauldron::ResourceState::CopyDest, cauldron::ResourceState::VertexBufferResource),
+            cauldron::Barrier::Transition(m_pNormalBuffer->GetResource(), cauldron::ResourceState::CopyDest, cauldron::ResourceState::VertexBufferResource),
+            cauldron::Barrier::Transition(m_pIndexBuffer->GetResource(), cauldron::ResourceState::CopyDest, cauldron::ResourceState::IndexBufferResource)};
+        cauldron::GetDevice()->ExecuteResourceTransitionImmediate(3, barriers);
+
+        m_lods = chain.Lods;
+    }
+
+    bool IsValid() const
+    {
+        return m_pIndexBuffer && !m_lods.empty();
+    }
+};
+
 struct IvyRenderIndirect
 {
     cauldron::IndirectWorkload* m_pIndirectWorkload = nullptr;
@@ -21,8 +71,10 @@ struct IvyRenderIndirect
     cauldron::ParameterSet*     m_pParameterSet     = nullptr;  // Own ParameterSet
     cauldron::PipelineObject*   m_pPipelineObject   = nullptr;
     
-    // Track binding state to avoid redundant SetBufferSRV calls
-    bool m_instanceBuffersBound = false;
+    // Track binding state to avoid redundant SetBufferSRV calls, the drawn buffers change with culling & instance buffer growth
+    const cauldron::Buffer* m_pBoundLeafInstanceBuffer = nullptr;
+    const cauldron::Buffer* m_pBoundStemInstanceBuffer = nullptr;
+    const cauldron::Buffer* m_pBoundArgumentBuffer     = nullptr;
     
 
     ~IvyRenderIndirect()
@@ -50,8 +102,8 @@ struct IvyRenderIndirect
         // Create independent Graphics Root Signature for ExecuteIndirect
         cauldron::RootSignatureDesc execIndirectRootSigDesc;
         execIndirectRootSigDesc.AddConstantBufferView(0, cauldron::ShaderBindStage::Vertex, 1);        // ViewProjection CBV
-        execIndirectRootSigDesc.AddBufferSRVSet(0, cauldron::ShaderBindStage::Vertex, 2);             // Instance buffer SRV Array (t0, t1)
-        execIndirectRootSigDesc.AddConstantBufferView(1, cauldron::ShaderBindStage::Vertex, 1);       // instance_buffer_index (b1)
+        execIndirectRootSigDesc.AddBufferSRVSet(0, cauldron::ShaderBindStage::Vertex, 3);             // Instance buffer SRV Array (t0, t1), draw arguments (t2)
+        execIndirectRootSigDesc.AddConstantBufferView(1, cauldron::ShaderBindStage::Vertex, 1);       // instance_buffer_index, argument_index & read_instance_offset (b1)
         execIndirectRootSigDesc.m_PipelineType = cauldron::PipelineType::Graphics;
         
         m_pRootSignature = cauldron::RootSignature::CreateRootSignature(L"ExecuteIndirect_RootSignature", execIndirectRootSigDesc);
@@ -61,7 +113,7 @@ struct IvyRenderIndirect
         
         // Initialize root constant buffer resources
         m_pParameterSet->SetRootConstantBufferResource(cauldron::GetDynamicBufferPool()->GetResource(), sizeof(Mat4), 0);     // b0: ViewProjection
-        m_pParameterSet->SetRootConstantBufferResource(cauldron::GetDynamicBufferPool()->GetResource(), sizeof(uint32_t) * 4, 1); // b1: instance_buffer_index (padded to 16 bytes)
+        m_pParameterSet->SetRootConstantBufferResource(cauldron::GetDynamicBufferPool()->GetResource(), sizeof(uint32_t) * 4, 1); // b1: instance_buffer_index, argument_index, read_instance_offset (padded to 16 bytes)
 
         // Create Pipeline State Object
         cauldron::PipelineDesc psoDesc;
@@ -114,6 +166,17 @@ struct IvyRenderIndirect
     }
 
 
+    /**
+     * @brief   Forces the instance buffers to be bound again, has to be called when they are recreated
+     *          (a new buffer may reuse the address of the deleted one).
+     */
+    void InvalidateInstanceBuffers()
+    {
+        m_pBoundLeafInstanceBuffer = nullptr;
+        m_pBoundStemInstanceBuffer = nullptr;
+        m_pBoundArgumentBuffer     = nullptr;
+    }
+
     void Render(cauldron::CommandList* pCmdList,  // Pass command list to ensure consistency
                 const Mat4& viewProjectionMatrix,
                 const cauldron::Buffer* pArgumentBuffer,  // Now passed from IvyRenderModule
@@ -123,7 +186,11 @@ struct IvyRenderIndirect
                 int ivyStemSurfaceIndex = -1,
                 const std::vector<Surface_Info>* pSurfaceBuffer = nullptr,
                 const cauldron::Buffer* pStemInstanceBuffer = nullptr,
-                const cauldron::Buffer* pLeafInstanceBuffer = nullptr)
+                const cauldron::Buffer* pLeafInstanceBuffer = nullptr,
+                const IvyMeshLodBuffers* pMeshLods = nullptr,  // leaf & stem LOD chains
+                uint32_t argumentLodCount = 1,                 // draw arguments per stream, IVY_MAX_MESH_LODS for IvyInstanceCulling
+                bool lodInstanceOffsets = false)               // the instances of each LOD start at StartInstanceLocation of its draw,
+                                                               // pArgumentBuffer is then also read by the vertex shader
     {
         static bool sLoggedOnce = false;
         if (!sLoggedOnce)
@@ -151,16 +218,21 @@ struct IvyRenderIndirect
 
         // Note: Root constants will be updated per draw call using UpdateRootConstantBuffer for better performance
 
-        // Bind instance buffers once (if not already bound)
-        if (!m_instanceBuffersBound && (pLeafInstanceBuffer || pStemInstanceBuffer))
+        // Bind instance buffers only when they changed
+        if (pLeafInstanceBuffer && (pLeafInstanceBuffer != m_pBoundLeafInstanceBuffer))
+        {
+            m_pParameterSet->SetBufferSRV(pLeafInstanceBuffer, 0);  // t0: Leaf instance buffer
+            m_pBoundLeafInstanceBuffer = pLeafInstanceBuffer;
+        }
+        if (pStemInstanceBuffer && (pStemInstanceBuffer != m_pBoundStemInstanceBuffer))
+        {
+            m_pParameterSet->SetBufferSRV(pStemInstanceBuffer, 1);  // t1: Stem instance buffer
+            m_pBoundStemInstanceBuffer = pStemInstanceBuffer;
+        }
+        if (lodInstanceOffsets && (pArgumentBuffer != m_pBoundArgumentBuffer))
         {
-            if (pLeafInstanceBuffer)
-                m_pParameterSet->SetBufferSRV(pLeafInstanceBuffer, 0);  // t0: Leaf instance buffer
-            if (pStemInstanceBuffer)
-                m_pParameterSet->SetBufferSRV(pStemInstanceBuffer, 1);  // t1: Stem instance buffer
-                
-            m_instanceBuffersBound = true;
-            cauldron::CauldronWarning(L"[IvyRenderIndirect] Instance buffers bound to t0 and t1");
+            m_pParameterSet->SetBufferSRV(pArgumentBuffer, 2);  // t2: Draw arguments
+            m_pBoundArgumentBuffer = pArgumentBuffer;
         }
 
         // Note: ParameterSet will be bound for each draw call after setting instance_buffer_index
@@ -168,54 +240,41 @@ struct IvyRenderIndirect
         // Note: Argument buffer is now initialized by IvyRenderModule each frame
         // and will be modified by work graph compute nodes via AtomicAdd operations
 
-        // Execute leaf geometry if valid
-        if (ivyLeafSurfaceIndex >= 0 && pVertexBuffers && pIndexBuffers && pSurfaceBuffer)
+        // Execute leaf (buffer index 0) & stem (buffer index 1) geometry if valid
+        const int surfaceIndices[2] = {ivyLeafSurfaceIndex, ivyStemSurfaceIndex};
+        for (uint32_t stream = 0; stream < 2; ++stream)
         {
-            const Surface_Info& leafSurfaceInfo = (*pSurfaceBuffer)[ivyLeafSurfaceIndex];
-            
-            // Set vertex and index buffers for leaf geometry
-            cauldron::BufferAddressInfo positionBufferInfo = (*pVertexBuffers)[leafSurfaceInfo.position_attribute_offset]->GetAddressInfo();
-            cauldron::BufferAddressInfo normalBufferInfo = (*pVertexBuffers)[leafSurfaceInfo.normal_attribute_offset]->GetAddressInfo();
-            
-            cauldron::BufferAddressInfo vertexBuffers[2] = { positionBufferInfo, normalBufferInfo };
-            cauldron::SetVertexBuffers(pCmdList, 0, 2, vertexBuffers);
+            if (surfaceIndices[stream] < 0 || !pVertexBuffers || !pIndexBuffers || !pSurfaceBuffer)
+                continue;
 
-            cauldron::BufferAddressInfo indexBufferInfo = (*pIndexBuffers)[leafSurfaceInfo.index_offset]->GetAddressInfo();
-            cauldron::SetIndexBuffer(pCmdList, &indexBufferInfo);
+            const Surface_Info& surfaceInfo = (*pSurfaceBuffer)[surfaceIndices[stream]];
 
-            uint32_t leafBufferIndex[4] = {0, 0, 0, 0};  // Padded to 16 bytes alignment
-            cauldron::BufferAddressInfo leafIndexBufferInfo = cauldron::GetDynamicBufferPool()->AllocConstantBuffer(sizeof(uint32_t) * 4, leafBufferIndex);
-            m_pParameterSet->UpdateRootConstantBuffer(&leafIndexBufferInfo, 1);  // Set instance_buffer_index = 0 for leaf (b1)
-            m_pParameterSet->Bind(pCmdList, m_pPipelineObject);                  // Bind with updated constant
+            // The LOD chain replaces the surface buffers, its LOD 0 also matches the generated draw arguments
+            const IvyMeshLodBuffers* pLods = (pMeshLods && pMeshLods[stream].IsValid()) ? &pMeshLods[stream] : nullptr;
 
-            // Execute first draw command (leaf) using offset 0
-            cauldron::ExecuteIndirect(pCmdList, m_pIndirectWorkload, pArgumentBuffer, 1 /*drawCount*/, 0 /*offset*/);
-            cauldron::CauldronWarning(L"[IvyRenderIndirect] Executed leaf geometry with buffer index 0");
-        }
+            // Set vertex and index buffers for the geometry
+            cauldron::BufferAddressInfo positionBufferInfo = pLods ? pLods->m_pPositionBuffer->GetAddressInfo() : (*pVertexBuffers)[surfaceInfo.position_attribute_offset]->GetAddressInfo();
+            cauldron::BufferAddressInfo normalBufferInfo   = pLods ? pLods->m_pNormalBuffer->GetAddressInfo() : (*pVertexBuffers)[surfaceInfo.normal_attribute_offset]->GetAddressInfo();
 
-        // Execute stem geometry if valid
-        if (ivyStemSurfaceIndex >= 0 && pVertexBuffers && pIndexBuffers && pSurfaceBuffer)
-        {
-            const Surface_Info& stemSurfaceInfo = (*pSurfaceBuffer)[ivyStemSurfaceIndex];
-            
-            // Set vertex and index buffers for stem geometry
-            cauldron::BufferAddressInfo positionBufferInfo = (*pVertexBuffers)[stemSurfaceInfo.position_attribute_offset]->GetAddressInfo();
-            cauldron::BufferAddressInfo normalBufferInfo = (*pVertexBuffers)[stemSurfaceInfo.normal_attribute_offset]->GetAddressInfo();
-            
             cauldron::BufferAddressInfo vertexBuffers[2] = { positionBufferInfo, normalBufferInfo };
             cauldron::SetVertexBuffers(pCmdList, 0, 2, vertexBuffers);
 
-            cauldron::BufferAddressInfo indexBufferInfo = (*pIndexBuffers)[stemSurfaceInfo.index_offset]->GetAddressInfo();
+            cauldron::BufferAddressInfo indexBufferInfo = pLods ? pLods->m_pIndexBuffer->GetAddressInfo() : (*pIndexBuffers)[surfaceInfo.index_offset]->GetAddressInfo();
             cauldron::SetIndexBuffer(pCmdList, &indexBufferInfo);
 
-            uint32_t stemBufferIndex[4] = {1, 0, 0, 0};  // Padded to 16 bytes alignment
-            cauldron::BufferAddressInfo stemIndexBufferInfo = cauldron::GetDynamicBufferPool()->AllocConstantBuffer(sizeof(uint32_t) * 4, stemBufferIndex);
-            m_pParameterSet->UpdateRootConstantBuffer(&stemIndexBufferInfo, 1);  // Set instance_buffer_index = 1 for stem (b1)
-            m_pParameterSet->Bind(pCmdList, m_pPipelineObject);                  // Bind with updated constant
-
-            // Execute second draw command (stem) using offset sizeof(DrawIndexedArgs)
-            cauldron::ExecuteIndirect(pCmdList, m_pIndirectWorkload, pArgumentBuffer, 1 /*drawCount*/, sizeof(DrawIndexedArgs) /*offset*/);
-            cauldron::CauldronWarning(L"[IvyRenderIndirect] Executed stem geometry with buffer index 1");
+            // One draw per LOD, each LOD draws its own range of the instance buffer
+            const uint32_t lodCount = pLods ? std::min(argumentLodCount, static_cast<uint32_t>(pLods->m_lods.size())) : 1;
+            for (uint32_t lod = 0; lod < lodCount; ++lod)
+            {
+                const uint32_t argumentIndex      = stream * argumentLodCount + lod;
+                uint32_t       bufferSelection[4] = {stream, argumentIndex, lodInstanceOffsets ? 1u : 0u, 0};  // Padded to 16 bytes alignment
+                cauldron::BufferAddressInfo bufferSelectionInfo = cauldron::GetDynamicBufferPool()->AllocConstantBuffer(sizeof(uint32_t) * 4, bufferSelection);
+                m_pParameterSet->UpdateRootConstantBuffer(&bufferSelectionInfo, 1);  // Set instance_buffer_index, argument_index & read_instance_offset (b1)
+                m_pParameterSet->Bind(pCmdList, m_pPipelineObject);                  // Bind with updated constant
+
+                const uint32_t argumentOffset = argumentIndex * sizeof(DrawIndexedArgs);
+                cauldron::ExecuteIndirect(pCmdList, m_pIndirectWorkload, pArgumentBuffer, 1 /*drawCount*/, argumentOffset);
+            }
         }
     }
 };
@@ -24,6 +24,7 @@
 #include "core/framework.h"
 #include "core/scene.h"
 #include "misc/assert.h"
+#include "misc/helpers.h"
 
 #include "core/components/meshcomponent.h"
 
@@ -50,11 +51,19 @@
 // shader compiler
 #include "shadercompiler.h"
 
+// baked instances of static levels
+#include "cpu/ivybakedinstances.h"
+// leaf & stem meshes of the LOD chains
+#include "cpu/ivygltfdocument.h"
+// duration of the Init phases
+#include "cpu/ivystartuptimer.h"
+
 // ImGuizmo
 #include "imgui.h"
 #include "imgui_internal.h"
 #include "ImGuizmo.h"
 
+#include <algorithm>
 #include <sstream>
 #include <unordered_map>
 
@@ -63,6 +72,20 @@ using namespace cauldron;
 // Name for work graph program inside the state object
 static const wchar_t* WorkGraphProgramName = L"WorkGraph";
 
+// DispatchGraph reads the GPU input records & node inputs like indirect arguments
+static const ResourceState EntryRecordBufferState = ResourceState::IndirectArgument | ResourceState::NonPixelShaderResource;
+
+// IvyEntryRecordBuffer writes the GPU input layouts of DispatchGraph without including d3d12.h
+static_assert(sizeof(IvyNodeGpuInput) == sizeof(D3D12_NODE_GPU_INPUT), "IvyNodeGpuInput must match D3D12_NODE_GPU_INPUT");
+static_assert(sizeof(IvyMultiNodeGpuInput) == sizeof(D3D12_MULTI_NODE_GPU_INPUT), "IvyMultiNodeGpuInput must match D3D12_MULTI_NODE_GPU_INPUT");
+
+// Local bounding sphere (xyz = center, w = radius) of the bounds of a surface, see IvyInstanceCulling
+static Vec4 GetBoundingSphere(const Surface* pSurface)
+{
+    // Radius() holds the half extents of the bounds
+    return Vec4(pSurface->Center().getXYZ(), length(pSurface->Radius().getXYZ()));
+}
+
 IvyRenderModule::IvyRenderModule()
     : RenderModule(L"IvyRenderModule")
 {
@@ -79,6 +102,10 @@ IvyRenderModule::~IvyRenderModule()
         delete m_pStemInstanceBuffer;
     if (m_pLeafInstanceBuffer)
         delete m_pLeafInstanceBuffer;
+    if (m_pInstanceKeyBuffer)
+        delete m_pInstanceKeyBuffer;
+    if (m_pEntryRecordBuffer)
+        delete m_pEntryRecordBuffer;
 
     // Delete work graph
     if (m_pWorkGraphStateObject)
@@ -89,44 +116,138 @@ IvyRenderModule::~IvyRenderModule()
         delete m_pWorkGraphRootSignature;
     if (m_pWorkGraphBackingMemoryBuffer)
         delete m_pWorkGraphBackingMemoryBuffer;
+    if (m_pDispatchTimestampHeap)
+        m_pDispatchTimestampHeap->Release();
 }
 
 void IvyRenderModule::Init(const json& initData)
 {
+    // Cold start matters for tools that launch the sample repeatedly, see StartupTimingFile
+    IvyStartupTimer startup;
+
     InitTextures();
+    startup.EndPhase("textures");
+
+    // The backing memory trades VRAM for work graph throughput, see cpu/ivybackingmemory.h
+    const std::string backingMemoryPolicy = initData.value("WorkGraphBackingMemory", std::string("max"));
+    if (!IvyParseBackingMemoryPolicy(backingMemoryPolicy, m_backingMemoryPolicy))
+    {
+        CauldronWarning(L"Unknown WorkGraphBackingMemory %s, using max.", StringToWString(backingMemoryPolicy).c_str());
+    }
+    m_backingMemoryFraction    = initData.value("WorkGraphBackingMemoryFraction", 0.5f);
+    m_backingMemorySweepFrames = std::max(initData.value("BackingMemorySweepFrames", 64u), 1u);
+    m_backingMemorySweepFile   = initData.value("BackingMemorySweepFile", std::string("ivybackingmemorysweep.json"));
+
     InitWorkGraphProgram();
+    startup.EndPhase("work_graph_program");
+
+    // The entry records stay on the GPU, only changed records are uploaded before their dispatch
+    m_entryRecords.SetEntrypoints(m_WorkGraphEntryPoints.IvyBranch, m_WorkGraphEntryPoints.IvyArea);
+    CreateEntryRecordBuffer();
 
     // Create argument buffer for ExecuteIndirect (shared with work graph)
+    // Zero instances until the partition compaction writes the arguments, which gates all reads of the instance buffers
     DrawIndexedArgs dummyArgs[2] = {};  // Two draw commands: leaf and stem
     BufferDesc argsDesc = BufferDesc::Data(L"Ivy_ArgumentBuffer", sizeof(DrawIndexedArgs) * 2, sizeof(DrawIndexedArgs), 0, ResourceFlags::AllowUnorderedAccess);
     m_pArgumentBuffer = Buffer::CreateBufferResource(&argsDesc, ResourceState::IndirectArgument);
-    // Note: Initial data will be set by Entry Node in work graph, not by CPU
+    m_pArgumentBuffer->CopyData(dummyArgs, sizeof(dummyArgs));
 
-    // Create instance buffers as StructuredBuffer
-    const uint32_t maxInstances = 500000;  // Support up to 5 * 10^5 instances
-    BufferDesc instanceDesc = BufferDesc::Data(L"Ivy_StemInstanceBuffer", sizeof(IvyInstanceData) * maxInstances, sizeof(IvyInstanceData), 0, ResourceFlags::AllowUnorderedAccess);
-    m_pStemInstanceBuffer = Buffer::CreateBufferResource(&instanceDesc, ResourceState::NonPixelShaderResource);
-    instanceDesc.Name = L"Ivy_LeafInstanceBuffer";
-    m_pLeafInstanceBuffer = Buffer::CreateBufferResource(&instanceDesc, ResourceState::NonPixelShaderResource);
-    
-    // Initialize instance buffer with identity matrices
-    // Work graph will populate the actual transform data
-    std::vector<IvyInstanceData> initialInstances(maxInstances);
-    
-    for (uint32_t i = 0; i < maxInstances; ++i)
+    // Static levels can replace the work graph with instances baked by IvyBake, until an entry record is edited
+    const std::string    bakedInstancePath = initData.value("BakedInstanceFile", std::string());
+    IvyBakedInstanceFile bakedInstances;
+    std::string          bakedInstanceError;
+    if (!bakedInstancePath.empty() && !bakedInstances.Open(bakedInstancePath, &bakedInstanceError))
+    {
+        CauldronWarning(L"Cannot use baked ivy instances %s: %s", StringToWString(bakedInstancePath).c_str(), StringToWString(bakedInstanceError).c_str());
+    }
+    startup.EndPhase("open_baked_instances");
+
+    // The instance buffers start small & grow up to IVY_MAX_INSTANCES once the work graph drops instances
+    m_instanceArena = IvyInstanceArena(initData.value("InitialInstanceCapacity", ivyDefaultInstanceArenaCapacity));
+    if (bakedInstances.IsOpen())
+    {
+        const IvyBakedInstanceHeader& header = bakedInstances.GetHeader();
+        m_instanceArena.Reserve(std::max(header.LeafInstanceCount, header.StemInstanceCount));
+    }
+    const uint32_t instanceCapacity = m_instanceArena.GetCapacity();
+
+    // Create instance buffers as StructuredBuffer, instances are encoded as selected by IVY_INSTANCE_ENCODING
+    CreateInstanceBuffers(instanceCapacity);
+    startup.EndPhase("instance_buffers");
+
+    if (bakedInstances.IsOpen())
     {
-        initialInstances[i].transform = Mat4::identity(); // Identity matrix, work graph will overwrite
+        // Upload straight from the mapped file, the instances are already in the encoding of the buffers
+        const IvyBakedInstanceHeader& header = bakedInstances.GetHeader();
+        if (header.LeafInstanceCount > 0)
+        {
+            m_pLeafInstanceBuffer->CopyData(bakedInstances.GetLeafInstances(), header.LeafInstanceCount * sizeof(IvyEncodedInstance));
+        }
+        if (header.StemInstanceCount > 0)
+        {
+            m_pStemInstanceBuffer->CopyData(bakedInstances.GetStemInstances(), header.StemInstanceCount * sizeof(IvyEncodedInstance));
+        }
+        m_pArgumentBuffer->CopyData(header.Arguments, sizeof(header.Arguments));
+        startup.EndPhase("upload_baked_instances");
     }
-    
-    // Upload initial data to buffers (work graph will modify these)
-    m_pStemInstanceBuffer->CopyData(initialInstances.data(), initialInstances.size() * sizeof(IvyInstanceData));
-    m_pLeafInstanceBuffer->CopyData(initialInstances.data(), initialInstances.size() * sizeof(IvyInstanceData));
+
+    m_deterministicInstanceOrder = initData.value("DeterministicInstanceOrder", false);
+    m_ivyInstanceSort.Init(instanceCapacity);
+    m_ivyInstancePartitions.Init(instanceCapacity);
+
+    m_frustumCulling   = initData.value("FrustumCulling", true);
+    m_occlusionCulling = initData.value("OcclusionCulling", true);
+    m_ivyInstanceCulling.Init(instanceCapacity);
+    m_meshLods      = initData.value("MeshLods", true);
+    m_lodPixelError = initData.value("LodPixelError", 1.f);
+    m_ivyMeshFile   = initData.value("IvyMeshFile", std::string("../media/Ivy/ivy.gltf"));
+    m_leafImpostors         = initData.value("LeafImpostors", true);
+    m_impostorDistance      = initData.value("ImpostorDistance", 20.f);
+    m_leafImpostorAtlasFile = initData.value("LeafImpostorAtlasFile", std::string());
+    m_ivyHiZPyramid.Init(GetFramework()->GetResolutionInfo().RenderWidth, GetFramework()->GetResolutionInfo().RenderHeight);
+
+    // Statuses & draw arguments are read back without waiting for the GPU
+    m_arenaStatusReadback.Init(L"Ivy_ArenaStatusReadback", sizeof(IvyInstanceArenaStatus) * m_ivyInstancePartitions.m_partitionCapacity);
+    m_argumentReadback.Init(L"Ivy_ArgumentReadback", sizeof(DrawIndexedArgs) * 2);
+
+    // Two timestamps around the dispatches of each frame in flight
+    D3D12_QUERY_HEAP_DESC timestampHeapDesc = {};
+    timestampHeapDesc.Type                  = D3D12_QUERY_HEAP_TYPE_TIMESTAMP;
+    timestampHeapDesc.Count                 = 2 * IvyReadbackRing::SlotCount;
+    CauldronThrowOnFail(GetDevice()->GetImpl()->DX12Device()->CreateQueryHeap(&timestampHeapDesc, IID_PPV_ARGS(&m_pDispatchTimestampHeap)));
+    m_dispatchTimestampReadback.Init(L"Ivy_DispatchTimestampReadback", sizeof(UINT64) * 2);
+
+    UINT64 timestampFrequency = 0;
+    CauldronThrowOnFail(GetDevice()->GetImpl()->DX12CmdQueue(CommandQueue::Graphics)->GetTimestampFrequency(&timestampFrequency));
+    m_timestampFrequency = static_cast<double>(timestampFrequency);
+    startup.EndPhase("instance_passes");
+
+    m_cacheGeneratedIvy = initData.value("CacheGeneratedIvy", true);
+
+    m_GenerationUISection             = {};
+    m_GenerationUISection.SectionName = "Ivy Generation";
+    m_GenerationUISection.AddCheckBox("Deterministic instance order", &m_deterministicInstanceOrder);
+    m_GenerationUISection.AddCheckBox("Cache generated ivy", &m_cacheGeneratedIvy);
+    m_GenerationUISection.AddCheckBox("Frustum culling", &m_frustumCulling);
+    m_GenerationUISection.AddCheckBox("Occlusion culling", &m_occlusionCulling);
+    m_GenerationUISection.AddCheckBox("Mesh LODs", &m_meshLods);
+    m_GenerationUISection.AddFloatSlider("LOD pixel error", &m_lodPixelError, 0.25f, 16.f);
+    m_GenerationUISection.AddCheckBox("Leaf impostors", &m_leafImpostors);
+    m_GenerationUISection.AddFloatSlider("Impostor distance", &m_impostorDistance, 1.f, 200.f);
+    m_GenerationUISection.AddCheckBox("Show instance counts", &m_showInstanceCounts);
+    m_GenerationUISection.AddCheckBox("Show backing memory", &m_showBackingMemory);
+    GetUIManager()->RegisterUIElements(m_GenerationUISection);
 
     m_ivyRenderIndirect.Init(m_pGBufferAlbedoOutput,
                              m_pGBufferNormalOutput,
                              m_pGBufferAoRoughnessMetallicOutput,
                              m_pGBufferMotionOutput,
                              m_pGBufferDepthOutput);
+    m_ivyLeafImpostors.Init(m_pGBufferAlbedoOutput,
+                            m_pGBufferNormalOutput,
+                            m_pGBufferAoRoughnessMetallicOutput,
+                            m_pGBufferMotionOutput,
+                            m_pGBufferDepthOutput);
 
     // Use ImGui hooks to render 3D user interface
     ImGuiContextHook hook = {};
@@ -137,12 +258,45 @@ void IvyRenderModule::Init(const json& initData)
     hook.Type     = ImGuiContextHookType_EndFramePre;
     hook.UserData = this;
     ImGui::AddContextHook(ImGui::GetCurrentContext(), &hook);
+    startup.EndPhase("render_indirect_and_ui");
 
     m_ivyBranchRecords.emplace_back(IvyBranchRecord{Mat4::translation(Vec3(-15.2f, 4.5f, 0.f)), 4750});
     m_ivyBranchRecords.emplace_back(IvyBranchRecord{Mat4::translation(Vec3(0, 0.1f, 0))});
 
     m_ivyAreaRecords.emplace_back(IvyAreaRecord{Mat4::translation(Vec3(0, 17, 7)) * Mat4::scale(Vec3(15, 1, 4)), 4050, 0.14f});
 
+    if (bakedInstances.IsOpen())
+    {
+        // The baked instances belong to the entry records of the file
+        const IvyBakedInstanceHeader& header = bakedInstances.GetHeader();
+
+        m_ivyBranchRecords.clear();
+        for (uint32_t i = 0; i < header.BranchRecordCount; ++i)
+        {
+            m_ivyBranchRecords.push_back(ToIvyBranchRecord(bakedInstances.GetBranchRecords()[i]));
+        }
+        m_ivyAreaRecords.clear();
+        for (uint32_t i = 0; i < header.AreaRecordCount; ++i)
+        {
+            m_ivyAreaRecords.push_back(ToIvyAreaRecord(bakedInstances.GetAreaRecords()[i]));
+        }
+
+        IvyGenerationKey recordKey;
+        recordKey.Add(m_ivyBranchRecords);
+        recordKey.Add(m_ivyAreaRecords);
+        m_bakedRecordKey    = recordKey.Get();
+        m_useBakedInstances = true;
+    }
+
+    startup.EndPhase("entry_records");
+
+    const std::string startupTimingPath = initData.value("StartupTimingFile", std::string());
+    std::string       startupTimingError;
+    if (!startupTimingPath.empty() && !startup.WriteFile(startupTimingPath, &startupTimingError))
+    {
+        CauldronWarning(L"Cannot write the ivy startup timing: %s", StringToWString(startupTimingError).c_str());
+    }
+
     // Register for content change updates
     GetContentManager()->AddContentListener(this);
 
@@ -153,6 +307,8 @@ void IvyRenderModule::Execute(double deltaTime, cauldron::CommandList* pCmdList)
 {
     std::lock_guard<std::mutex> pipelineLock(m_CriticalSection);
 
+    m_retiredBuffers.BeginFrame();
+
     // Update Ivy UI if needed
     if (m_updateIvyUI)
     {
@@ -205,6 +361,13 @@ void IvyRenderModule::Execute(double deltaTime, cauldron::CommandList* pCmdList)
 
     GPUScopedProfileCapture shadingMarker(pCmdList, L"Ivy Generation");
 
+    // The GBuffer depth holds the scene without the ivy, the pyramid has to be built before the ivy is drawn
+    const bool occlusionCulling = m_frustumCulling && m_occlusionCulling;
+    if (occlusionCulling)
+    {
+        m_ivyHiZPyramid.Build(pCmdList, m_pGBufferDepthOutput, width, height, &m_retiredBuffers);
+    }
+
     std::vector<Barrier> barriers;
     barriers.push_back(Barrier::Transition(m_pGBufferAlbedoOutput->GetResource(),
                                            ResourceState::NonPixelShaderResource | ResourceState::PixelShaderResource,
@@ -238,90 +401,243 @@ void IvyRenderModule::Execute(double deltaTime, cauldron::CommandList* pCmdList)
     workGraphData.IvyStemSurfaceIndex    = m_ivyStemSurfaceIndex;
     workGraphData.IvyLeafSurfaceIndex    = m_ivyLeafSurfaceIndex;
 
-    // Transition buffers: ShaderResource -> UnorderedAccess for work graph
-    std::vector<Barrier> uavBarriers;
-    uavBarriers.push_back(Barrier::Transition(m_pArgumentBuffer->GetResource(),
-                                              ResourceState::IndirectArgument,
-                                              ResourceState::UnorderedAccess));
-    uavBarriers.push_back(Barrier::Transition(m_pLeafInstanceBuffer->GetResource(),
-                                              ResourceState::NonPixelShaderResource,
-                                              ResourceState::UnorderedAccess));
-    uavBarriers.push_back(Barrier::Transition(m_pStemInstanceBuffer->GetResource(),
-                                              ResourceState::NonPixelShaderResource,
-                                              ResourceState::UnorderedAccess));
-    ResourceBarrier(pCmdList, static_cast<uint32_t>(uavBarriers.size()), uavBarriers.data());
-
-    BufferAddressInfo workGraphDataInfo = GetDynamicBufferPool()->AllocConstantBuffer(sizeof(WorkGraphCBData), &workGraphData);
-    m_pWorkGraphParameterSet->UpdateRootConstantBuffer(&workGraphDataInfo, 0);
-    
-    m_pWorkGraphParameterSet->SetBufferUAV(m_pArgumentBuffer, 0); // Bind argument buffer to u0
-    m_pWorkGraphParameterSet->SetBufferUAV(m_pLeafInstanceBuffer, 1); // Bind leaf instance buffer to u1
-    m_pWorkGraphParameterSet->SetBufferUAV(m_pStemInstanceBuffer, 2); // Bind stem instance buffer to u2
-    m_pWorkGraphParameterSet->SetAccelerationStructure(GetScene()->GetASManager()->GetTLAS(), 0);
-    
-    // Bind all the parameters
-    m_pWorkGraphParameterSet->Bind(pCmdList, nullptr);
-
-    // Dispatch the work graph
-    {
-        D3D12_NODE_CPU_INPUT inputs[3];
-
-        // IvyBranch records (re-enabled for leaf generation)
-        inputs[0].EntrypointIndex     = m_WorkGraphEntryPoints.IvyBranch;
-        inputs[0].NumRecords          = static_cast<UINT>(m_ivyBranchRecords.size());
-        inputs[0].pRecords            = m_ivyBranchRecords.data();
-        inputs[0].RecordStrideInBytes = sizeof(IvyBranchRecord);
-
-        inputs[1].EntrypointIndex     = m_WorkGraphEntryPoints.IvyArea;
-        inputs[1].NumRecords          = static_cast<UINT>(m_ivyAreaRecords.size());
-        inputs[1].pRecords            = m_ivyAreaRecords.data();
-        inputs[1].RecordStrideInBytes = sizeof(IvyAreaRecord);
-
-        D3D12_DISPATCH_GRAPH_DESC dispatchDesc                = {};
-        dispatchDesc.Mode                                     = D3D12_DISPATCH_MODE_MULTI_NODE_CPU_INPUT;
-        dispatchDesc.MultiNodeCPUInput                        = {};
-        dispatchDesc.MultiNodeCPUInput.NumNodeInputs          = 2;
-        dispatchDesc.MultiNodeCPUInput.pNodeInputs            = inputs;
-        dispatchDesc.MultiNodeCPUInput.NodeInputStrideInBytes = sizeof(D3D12_NODE_CPU_INPUT);
+    // Every entry record owns a partition of the instances, see IvyInstancePartitions
+    const uint32_t branchRecordCount = static_cast<uint32_t>(m_ivyBranchRecords.size());
+    const uint32_t partitionCount    = branchRecordCount + static_cast<uint32_t>(m_ivyAreaRecords.size());
+
+    // Instances dropped by a previous generation lay out the partitions again or grow the arena,
+    // which regenerates all partitions
+    if (UpdateInstanceArena())
+    {
+        m_generationCache.Invalidate();
+    }
+    m_instanceArena.SetPartitionCount(partitionCount);
+    workGraphData.InstanceCapacity = m_instanceArena.GetCapacity();
+
+    // The instances do not depend on the camera, so only the partitions of changed entry records are regenerated.
+    // Other partitions & the draw buffers still hold the output of previous generations.
+    // Inputs of all entry records invalidate every partition.
+    IvyGenerationKey sharedKey;
+    sharedKey.Add(m_contentVersion);
+    sharedKey.Add(m_ivyStemSurfaceIndex);
+    sharedKey.Add(m_ivyLeafSurfaceIndex);
+    sharedKey.Add(m_deterministicInstanceOrder);
+
+    // Baked instances are drawn until an entry record changes, the partitions are then all generated in the first frame
+    if (m_useBakedInstances)
+    {
+        IvyGenerationKey recordKey;
+        recordKey.Add(m_ivyBranchRecords);
+        recordKey.Add(m_ivyAreaRecords);
+        m_useBakedInstances = (recordKey.Get() == m_bakedRecordKey);
+    }
+
+    // Every frame of a backing memory sweep measures the dispatches of all partitions
+    const bool backingMemorySweep = UpdateBackingMemorySweep();
+    if (!m_cacheGeneratedIvy || backingMemorySweep)
+    {
+        m_generationCache.Invalidate();
+    }
+    m_generationCache.BeginFrame(partitionCount, sharedKey.Get());
+
+    std::vector<uint32_t> dirtyPartitions;
+    for (uint32_t partition = 0; (partition < partitionCount) && !m_useBakedInstances; ++partition)
+    {
+        IvyGenerationKey partitionKey;
+        if (partition < branchRecordCount)
+        {
+            partitionKey.Add(m_ivyBranchRecords[partition]);
+        }
+        else
+        {
+            partitionKey.Add(m_ivyAreaRecords[partition - branchRecordCount]);
+        }
+
+        if (m_generationCache.Update(partition, partitionKey.Get()))
+        {
+            dirtyPartitions.push_back(partition);
+        }
+    }
+
+    if (!dirtyPartitions.empty())
+    {
+        // Transition buffers: ShaderResource -> UnorderedAccess for the partition compaction
+        std::vector<Barrier> uavBarriers;
+        uavBarriers.push_back(Barrier::Transition(m_pArgumentBuffer->GetResource(),
+                                                  ResourceState::IndirectArgument,
+                                                  ResourceState::UnorderedAccess));
+        uavBarriers.push_back(Barrier::Transition(m_pLeafInstanceBuffer->GetResource(),
+                                                  ResourceState::NonPixelShaderResource,
+                                                  ResourceState::UnorderedAccess));
+        uavBarriers.push_back(Barrier::Transition(m_pStemInstanceBuffer->GetResource(),
+                                                  ResourceState::NonPixelShaderResource,
+                                                  ResourceState::UnorderedAccess));
+        ResourceBarrier(pCmdList, static_cast<uint32_t>(uavBarriers.size()), uavBarriers.data());
+
+        // The records carry their partition, the graph reads the offsets & capacities from the layout buffer,
+        // which also marks the partitions whose counters are reset
+        m_ivyInstancePartitions.UploadLayout(pCmdList, m_instanceArena, dirtyPartitions, &m_retiredBuffers);
+        m_ivyInstancePartitions.Reset(pCmdList, partitionCount);
+        if (m_arenaStatusReadback.m_slotSize < sizeof(IvyInstanceArenaStatus) * m_ivyInstancePartitions.m_partitionCapacity)
+        {
+            m_arenaStatusReadback.Resize(sizeof(IvyInstanceArenaStatus) * m_ivyInstancePartitions.m_partitionCapacity);
+        }
+
+        // Edited entry records are uploaded to their slots of the record buffer, the inputs select the dirty slots
+        m_entryRecords.Assign(m_ivyBranchRecords, m_ivyAreaRecords);
+        m_entryRecords.SetDispatchSlots(dirtyPartitions);
+        if (m_entryRecords.GetSize() > m_pEntryRecordBuffer->GetDesc().Size)
+        {
+            CreateEntryRecordBuffer();
+        }
+        UploadEntryRecords(pCmdList);
+
+        // The work graph writes to the partition buffers
+        m_pWorkGraphParameterSet->SetBufferUAV(m_ivyInstancePartitions.m_pCounterBuffer, 0); // Bind partition counters to u0
+        m_pWorkGraphParameterSet->SetBufferUAV(m_ivyInstancePartitions.m_pLeafPartitionBuffer, 1); // Bind leaf partition buffer to u1
+        m_pWorkGraphParameterSet->SetBufferUAV(m_ivyInstancePartitions.m_pStemPartitionBuffer, 2); // Bind stem partition buffer to u2
+        m_pWorkGraphParameterSet->SetBufferUAV(m_ivyInstancePartitions.m_pKeyBuffer, 3); // Bind partition key buffer to u3
+        m_pWorkGraphParameterSet->SetAccelerationStructure(GetScene()->GetASManager()->GetTLAS(), 0);
+        m_pWorkGraphParameterSet->SetBufferSRV(m_ivyInstancePartitions.m_pLayoutBuffer, 1); // Bind partition layout to t1
 
         // Get ID3D12GraphicsCommandList10 from Cauldron command list
         ID3D12GraphicsCommandList10* commandList;
         CauldronThrowOnFail(pCmdList->GetImpl()->DX12CmdList()->QueryInterface(IID_PPV_ARGS(&commandList)));
 
+        // GPU time of the dispatch, read back IvyReadbackRing::SlotCount frames later
+        const uint32_t timestampSlot = m_dispatchTimestampReadback.GetSlot();
+        commandList->EndQuery(m_pDispatchTimestampHeap, D3D12_QUERY_TYPE_TIMESTAMP, 2 * timestampSlot);
+
+        BufferAddressInfo workGraphDataInfo = GetDynamicBufferPool()->AllocConstantBuffer(sizeof(WorkGraphCBData), &workGraphData);
+        m_pWorkGraphParameterSet->UpdateRootConstantBuffer(&workGraphDataInfo, 0);
+
+        // Bind all the parameters
+        m_pWorkGraphParameterSet->Bind(pCmdList, nullptr);
+
+        // A single dispatch of all dirty entry records, the node inputs point to their slots of the record buffer
+        D3D12_DISPATCH_GRAPH_DESC dispatchDesc = {};
+        dispatchDesc.Mode                      = D3D12_DISPATCH_MODE_MULTI_NODE_GPU_INPUT;
+        dispatchDesc.MultiNodeGPUInput         = m_entryRecords.GetMultiNodeInputAddress();
+
         commandList->SetProgram(&m_WorkGraphProgramDesc);
         commandList->DispatchGraph(&dispatchDesc);
 
+        // Clear backing memory initialization flag, as the graph has run at least once now
+        m_WorkGraphProgramDesc.WorkGraph.Flags &= ~D3D12_SET_WORK_GRAPH_FLAG_INITIALIZE;
+
+        // The next dispatch reuses the backing memory
+        Barrier backingMemoryBarrier = Barrier::UAV(m_pWorkGraphBackingMemoryBuffer->GetResource());
+        ResourceBarrier(pCmdList, 1, &backingMemoryBarrier);
+
+        commandList->EndQuery(m_pDispatchTimestampHeap, D3D12_QUERY_TYPE_TIMESTAMP, 2 * timestampSlot + 1);
+        m_dispatchTimestampReadback.ResolveQueryData(pCmdList, m_pDispatchTimestampHeap, D3D12_QUERY_TYPE_TIMESTAMP, 2 * timestampSlot, 2);
+        m_dispatchTimestampSteps[timestampSlot] = m_backingMemorySweepStep;
+
         // Release command list (only releases additional reference created by QueryInterface)
         commandList->Release();
 
-        // Clear backing memory initialization flag, as the graph has run at least once now
-        m_WorkGraphProgramDesc.WorkGraph.Flags &= ~D3D12_SET_WORK_GRAPH_FLAG_INITIALIZE;
+        // Rebuild the draw buffers from all partitions
+        const auto&    surfaces       = m_RTInfoTables.m_cpuSurfaceBuffer;
+        const uint32_t leafIndexCount = (m_ivyLeafSurfaceIndex >= 0) ? surfaces[m_ivyLeafSurfaceIndex].num_indices : 0;
+        const uint32_t stemIndexCount = (m_ivyStemSurfaceIndex >= 0) ? surfaces[m_ivyStemSurfaceIndex].num_indices : 0;
+        m_ivyInstancePartitions.Compact(pCmdList,
+                                        m_instanceArena,
+                                        leafIndexCount,
+                                        stemIndexCount,
+                                        m_pArgumentBuffer,
+                                        m_pLeafInstanceBuffer,
+                                        m_pStemInstanceBuffer,
+                                        m_pInstanceKeyBuffer);
+
+        // UpdateInstanceArena checks the partition counters IvyReadbackRing::SlotCount frames later
+        m_arenaStatusReadback.Copy(pCmdList, m_ivyInstancePartitions.m_pCounterBuffer, ResourceState::UnorderedAccess);
+        m_arenaStatusGenerations[m_arenaStatusReadback.GetSlot()].LayoutVersion  = m_instanceArena.GetLayoutVersion();
+        m_arenaStatusGenerations[m_arenaStatusReadback.GetSlot()].PartitionCount = partitionCount;
+
+        // Restore a scheduling independent instance order
+        if (m_deterministicInstanceOrder)
+        {
+            m_ivyInstanceSort.Execute(pCmdList, m_pArgumentBuffer, m_pLeafInstanceBuffer, m_pStemInstanceBuffer, m_pInstanceKeyBuffer);
+        }
+
+        // Add barriers: Unordered Access -> appropriate states for ExecuteIndirect
+        std::vector<Barrier> postWorkGraphBarriers;
+        postWorkGraphBarriers.push_back(Barrier::Transition(m_pArgumentBuffer->GetResource(),
+                                                            ResourceState::UnorderedAccess,
+                                                            ResourceState::IndirectArgument));
+        postWorkGraphBarriers.push_back(Barrier::Transition(m_pLeafInstanceBuffer->GetResource(),
+                                                            ResourceState::UnorderedAccess,
+                                                            ResourceState::NonPixelShaderResource));
+        postWorkGraphBarriers.push_back(Barrier::Transition(m_pStemInstanceBuffer->GetResource(),
+                                                            ResourceState::UnorderedAccess,
+                                                            ResourceState::NonPixelShaderResource));
+        ResourceBarrier(pCmdList, static_cast<uint32_t>(postWorkGraphBarriers.size()), postWorkGraphBarriers.data());
+
+        m_instanceClustersDirty = true;
+    }
+
+    // Instance counts of every frame, also of cached frames & baked instances
+    if (const DrawIndexedArgs* pArguments = static_cast<const DrawIndexedArgs*>(m_argumentReadback.BeginFrame()))
+    {
+        m_instanceCounts.Add(m_frameIndex - IvyReadbackRing::SlotCount, pArguments);
     }
+    m_argumentReadback.Copy(pCmdList, m_pArgumentBuffer, ResourceState::IndirectArgument);
+
+    // The generated instances do not depend on the camera, culling runs every frame, also for cached frames
+    const Buffer* pDrawArgumentBuffer     = m_pArgumentBuffer;
+    const Buffer* pDrawLeafInstanceBuffer = m_pLeafInstanceBuffer;
+    const Buffer* pDrawStemInstanceBuffer = m_pStemInstanceBuffer;
+    if (m_frustumCulling)
+    {
+        if (m_instanceClustersDirty)
+        {
+            m_ivyInstanceCulling.BuildClusters(pCmdList,
+                                               m_ivyLeafBoundingSphere,
+                                               m_ivyStemBoundingSphere,
+                                               m_pArgumentBuffer,
+                                               m_pLeafInstanceBuffer,
+                                               m_pStemInstanceBuffer);
+            m_instanceClustersDirty = false;
+        }
 
-    // Add barriers: Unordered Access -> appropriate states for ExecuteIndirect
-    std::vector<Barrier> postWorkGraphBarriers;
-    postWorkGraphBarriers.push_back(Barrier::Transition(m_pArgumentBuffer->GetResource(),
-                                                        ResourceState::UnorderedAccess,
-                                                        ResourceState::IndirectArgument));
-    postWorkGraphBarriers.push_back(Barrier::Transition(m_pLeafInstanceBuffer->GetResource(),
-                                                        ResourceState::UnorderedAccess,
-                                                        ResourceState::NonPixelShaderResource));
-    postWorkGraphBarriers.push_back(Barrier::Transition(m_pStemInstanceBuffer->GetResource(),
-                                                        ResourceState::UnorderedAccess,
-                                                        ResourceState::NonPixelShaderResource));
-    ResourceBarrier(pCmdList, static_cast<uint32_t>(postWorkGraphBarriers.size()), postWorkGraphBarriers.data());
+        m_ivyInstanceCulling.Execute(pCmdList,
+                                     workGraphData.ViewProjection,
+                                     m_ivyLeafBoundingSphere,
+                                     m_ivyStemBoundingSphere,
+                                     m_pArgumentBuffer,
+                                     m_pLeafInstanceBuffer,
+                                     m_pStemInstanceBuffer,
+                                     m_ivyHiZPyramid,
+                                     occlusionCulling,
+                                     m_meshLods ? 0.5f * height * length(workGraphData.ViewProjection.getRow(1).getXYZ()) : 0.f,
+                                     m_lodPixelError,
+                                     m_leafImpostors ? m_impostorDistance : 0.f);
+
+        pDrawArgumentBuffer     = m_ivyInstanceCulling.m_pArgumentBuffer;
+        pDrawLeafInstanceBuffer = m_ivyInstanceCulling.m_pLeafInstanceBuffer;
+        pDrawStemInstanceBuffer = m_ivyInstanceCulling.m_pStemInstanceBuffer;
+    }
 
     // Indirect draw ivy (both leaf and stem)
     m_ivyRenderIndirect.Render(pCmdList,  // Pass command list for consistency
                                workGraphData.ViewProjection,
-                               m_pArgumentBuffer,  // Pass argument buffer
+                               pDrawArgumentBuffer,  // Pass argument buffer
                                &m_RTInfoTables.m_VertexBuffers, 
                                &m_RTInfoTables.m_IndexBuffers, 
                                m_ivyLeafSurfaceIndex,
                                m_ivyStemSurfaceIndex,
                                &m_RTInfoTables.m_cpuSurfaceBuffer,
-                               m_pStemInstanceBuffer,
-                               m_pLeafInstanceBuffer);
+                               pDrawStemInstanceBuffer,
+                               pDrawLeafInstanceBuffer,
+                               m_ivyMeshLods,
+                               m_frustumCulling ? IVY_MAX_MESH_LODS : 1,
+                               m_frustumCulling);
+
+    // Leaf clusters culled as impostors
+    if (m_frustumCulling && m_leafImpostors)
+    {
+        m_ivyLeafImpostors.Render(pCmdList, workGraphData.ViewProjection, m_ivyInstanceCulling);
+    }
 
     EndRaster(pCmdList, nullptr);
 
@@ -332,10 +648,204 @@ void IvyRenderModule::Execute(double deltaTime, cauldron::CommandList* pCmdList)
     }
 
     ResourceBarrier(pCmdList, static_cast<uint32_t>(barriers.size()), barriers.data());
+
+    ++m_frameIndex;
+}
+
+void IvyRenderModule::CreateBackingMemory(uint64_t sizeInBytes)
+{
+    // The old backing memory may still be referenced by frames in flight
+    IvyReleaseBuffer(m_pWorkGraphBackingMemoryBuffer, &m_retiredBuffers);
+
+    m_WorkGraphProgramDesc.WorkGraph.BackingMemory = {};
+    if (sizeInBytes > 0)
+    {
+        BufferDesc bufferDesc = BufferDesc::Data(L"MeshNodeSample_WorkGraphBackingMemory",
+                                                 static_cast<uint32_t>(sizeInBytes),
+                                                 1,
+                                                 D3D12_WORK_GRAPHS_BACKING_MEMORY_ALIGNMENT_IN_BYTES,
+                                                 ResourceFlags::AllowUnorderedAccess);
+
+        m_pWorkGraphBackingMemoryBuffer = Buffer::CreateBufferResource(&bufferDesc, ResourceState::UnorderedAccess);
+
+        const auto addressInfo                                      = m_pWorkGraphBackingMemoryBuffer->GetAddressInfo();
+        m_WorkGraphProgramDesc.WorkGraph.BackingMemory.StartAddress = addressInfo.GetImpl()->GPUBufferView;
+        m_WorkGraphProgramDesc.WorkGraph.BackingMemory.SizeInBytes  = addressInfo.GetImpl()->SizeInBytes;
+    }
+
+    // Set flag to initialize backing memory.
+    // We'll clear this flag once we've run the work graph for the first time.
+    m_WorkGraphProgramDesc.WorkGraph.Flags |= D3D12_SET_WORK_GRAPH_FLAG_INITIALIZE;
+}
+
+void IvyRenderModule::StartBackingMemorySweep()
+{
+    m_backingMemorySweep      = IvyBackingMemorySweep(m_backingMemoryRequirements);
+    m_backingMemorySweepStep  = 0;
+    m_backingMemorySweepFrame = 0;
+    CreateBackingMemory(m_backingMemorySweep.GetSizeInBytes(0));
+}
+
+bool IvyRenderModule::UpdateBackingMemorySweep()
+{
+    // Dispatch times arrive IvyReadbackRing::SlotCount frames late, along with the sweep step they were measured in
+    if (const UINT64* pTimestamps = static_cast<const UINT64*>(m_dispatchTimestampReadback.BeginFrame()))
+    {
+        m_dispatchSeconds = static_cast<double>(pTimestamps[1] - pTimestamps[0]) / m_timestampFrequency;
+
+        const int32_t step = m_dispatchTimestampSteps[m_dispatchTimestampReadback.GetSlot()];
+        if ((step >= 0) && (static_cast<uint32_t>(step) < m_backingMemorySweep.GetStepCount()))
+        {
+            m_backingMemorySweep.AddSample(step, m_dispatchSeconds);
+        }
+    }
+
+    if (m_backingMemorySweepStep < 0)
+    {
+        return false;
+    }
+
+    const uint32_t stepCount = m_backingMemorySweep.GetStepCount();
+    if (static_cast<uint32_t>(m_backingMemorySweepStep) < stepCount)
+    {
+        if (m_backingMemorySweepFrame == m_backingMemorySweepFrames)
+        {
+            m_backingMemorySweepFrame = 0;
+            if (static_cast<uint32_t>(++m_backingMemorySweepStep) < stepCount)
+            {
+                CreateBackingMemory(m_backingMemorySweep.GetSizeInBytes(m_backingMemorySweepStep));
+            }
+        }
+
+        if (static_cast<uint32_t>(m_backingMemorySweepStep) < stepCount)
+        {
+            ++m_backingMemorySweepFrame;
+            return true;
+        }
+    }
+
+    // The times of the last step arrive IvyReadbackRing::SlotCount frames after its last dispatch
+    if (++m_backingMemorySweepFrame <= IvyReadbackRing::SlotCount)
+    {
+        return false;
+    }
+
+    std::string sweepError;
+    if (!m_backingMemorySweep.WriteFile(m_backingMemorySweepFile, &sweepError))
+    {
+        CauldronWarning(L"Cannot write the backing memory sweep: %s", StringToWString(sweepError).c_str());
+    }
+
+    m_backingMemorySweepStep = -1;
+    CreateBackingMemory(IvySelectBackingMemorySize(m_backingMemoryRequirements, m_backingMemoryPolicy, m_backingMemoryFraction));
+    return false;
+}
+
+void IvyRenderModule::CreateEntryRecordBuffer()
+{
+    // The old buffer may still be referenced by frames in flight, the new one needs all records & inputs
+    IvyReleaseBuffer(m_pEntryRecordBuffer, &m_retiredBuffers);
+
+    BufferDesc recordDesc = BufferDesc::Data(L"Ivy_EntryRecordBuffer", static_cast<uint32_t>(m_entryRecords.GetSize()), IvyEntryRecordBuffer::RecordSlotSize, 0, ResourceFlags::None);
+    m_pEntryRecordBuffer  = Buffer::CreateBufferResource(&recordDesc, EntryRecordBufferState);
+    m_entryRecords.SetGpuAddress(m_pEntryRecordBuffer->GetResource()->GetImpl()->DX12Resource()->GetGPUVirtualAddress());
+}
+
+void IvyRenderModule::UploadEntryRecords(CommandList* pCmdList)
+{
+    const std::vector<IvyEntryRecordBuffer::Range> ranges = m_entryRecords.GetDirtyRanges();
+    if (ranges.empty())
+    {
+        return;
+    }
+
+    Barrier barrier = Barrier::Transition(m_pEntryRecordBuffer->GetResource(), EntryRecordBufferState, ResourceState::CopyDest);
+    ResourceBarrier(pCmdList, 1, &barrier);
+
+    // The dynamic buffer pool is an upload ring, its allocations stay valid until the GPU has completed the frame
+    ID3D12Resource* pUploadResource = GetDynamicBufferPool()->GetResource()->GetImpl()->DX12Resource();
+    ID3D12Resource* pRecordResource = m_pEntryRecordBuffer->GetResource()->GetImpl()->DX12Resource();
+    for (const IvyEntryRecordBuffer::Range& range : ranges)
+    {
+        BufferAddressInfo uploadInfo   = GetDynamicBufferPool()->AllocConstantBuffer(static_cast<uint32_t>(range.Size), m_entryRecords.GetData() + range.Offset);
+        const UINT64      uploadOffset = uploadInfo.GetImpl()->GPUBufferView - pUploadResource->GetGPUVirtualAddress();
+        pCmdList->GetImpl()->DX12CmdList()->CopyBufferRegion(pRecordResource, range.Offset, pUploadResource, uploadOffset, range.Size);
+    }
+
+    std::swap(barrier.SourceState, barrier.DestState);
+    ResourceBarrier(pCmdList, 1, &barrier);
+
+    m_entryRecords.ClearDirtyRanges();
+}
+
+void IvyRenderModule::CreateInstanceBuffers(uint32_t capacity)
+{
+    // The old buffers may still be referenced by frames in flight
+    IvyReleaseBuffer(m_pStemInstanceBuffer, &m_retiredBuffers);
+    IvyReleaseBuffer(m_pLeafInstanceBuffer, &m_retiredBuffers);
+    IvyReleaseBuffer(m_pInstanceKeyBuffer, &m_retiredBuffers);
+
+    // The buffers are not initialized, the draw arguments limit all reads to the compacted instances
+    BufferDesc instanceDesc = BufferDesc::Data(L"Ivy_StemInstanceBuffer", sizeof(IvyEncodedInstance) * capacity, sizeof(IvyEncodedInstance), 0, ResourceFlags::AllowUnorderedAccess);
+    m_pStemInstanceBuffer = Buffer::CreateBufferResource(&instanceDesc, ResourceState::NonPixelShaderResource);
+    instanceDesc.Name = L"Ivy_LeafInstanceBuffer";
+    m_pLeafInstanceBuffer = Buffer::CreateBufferResource(&instanceDesc, ResourceState::NonPixelShaderResource);
+
+    // Sort keys for the deterministic instance order, only written & read on the GPU
+    BufferDesc keyDesc = BufferDesc::Data(L"Ivy_InstanceKeyBuffer", sizeof(IvyInstanceKey) * 2 * capacity, sizeof(IvyInstanceKey), 0, ResourceFlags::AllowUnorderedAccess);
+    m_pInstanceKeyBuffer = Buffer::CreateBufferResource(&keyDesc, ResourceState::UnorderedAccess);
+}
+
+bool IvyRenderModule::UpdateInstanceArena()
+{
+    // Status of the generation IvyReadbackRing::SlotCount frames ago, if that frame ran the work graph
+    const IvyInstanceArenaStatus* status = static_cast<const IvyInstanceArenaStatus*>(m_arenaStatusReadback.BeginFrame());
+    if (!status)
+    {
+        return false;
+    }
+
+    const ArenaStatusGeneration& generation       = m_arenaStatusGenerations[m_arenaStatusReadback.GetSlot()];
+    const uint32_t               previousCapacity = m_instanceArena.GetCapacity();
+    if (!m_instanceArena.Update(status, generation.PartitionCount, generation.LayoutVersion))
+    {
+        if (m_instanceArena.IsSaturated() && !m_instanceArenaWarning)
+        {
+            CauldronWarning(L"Ivy generation dropped %u instances beyond the maximum of %u instances per stream.",
+                            m_instanceArena.GetDroppedInstances(),
+                            m_instanceArena.GetMaxCapacity());
+            m_instanceArenaWarning = true;
+        }
+        return false;
+    }
+
+    // A new layout within the capacity reuses the buffers, the old buffers are retired instead of waiting for the frames in flight
+    const uint32_t capacity = m_instanceArena.GetCapacity();
+    if (capacity != previousCapacity)
+    {
+        CreateInstanceBuffers(capacity);
+        m_ivyInstancePartitions.Resize(capacity, &m_retiredBuffers);
+        m_ivyInstanceSort.Resize(capacity, &m_retiredBuffers);
+        m_ivyInstanceCulling.Resize(capacity, &m_retiredBuffers);
+        m_instanceClustersDirty = true;
+        m_ivyRenderIndirect.InvalidateInstanceBuffers();
+    }
+
+    // Statuses of the generations with the old layout are outdated
+    m_arenaStatusReadback.Invalidate();
+
+    return true;
 }
 
 void IvyRenderModule::OnResize(const cauldron::ResolutionInfo& resInfo)
 {
+    if (!ModuleReady())
+    {
+        return;
+    }
+
+    // The pyramid covers the GBuffer depth, which is rendered at the render resolution
+    m_ivyHiZPyramid.Resize(resInfo.RenderWidth, resInfo.RenderHeight, &m_retiredBuffers);
 }
 
 void IvyRenderModule::InitTextures()
@@ -359,8 +869,9 @@ void IvyRenderModule::InitWorkGraphProgram()
     // Create root signature for work graph
     RootSignatureDesc workGraphRootSigDesc;
     workGraphRootSigDesc.AddConstantBufferView(0, ShaderBindStage::Compute, 1);
-    workGraphRootSigDesc.AddBufferUAVSet(0, ShaderBindStage::Compute, 3); // u0: argument buffer, u1: leaf instance buffer, u2: stem instance buffer
+    workGraphRootSigDesc.AddBufferUAVSet(0, ShaderBindStage::Compute, 4); // u0: partition counters, u1: leaf partition buffer, u2: stem partition buffer, u3: partition keys
     workGraphRootSigDesc.AddRTAccelerationStructureSet(0, ShaderBindStage::Compute, 1);
+    workGraphRootSigDesc.AddBufferSRVSet(1, ShaderBindStage::Compute, 1); // t1: partition layout
 
     workGraphRootSigDesc.AddBufferSRVSet(RAYTRACING_INFO_BEGIN_SLOT + 0, ShaderBindStage::Compute, 1);
     workGraphRootSigDesc.AddBufferSRVSet(RAYTRACING_INFO_BEGIN_SLOT + 1, ShaderBindStage::Compute, 1);
@@ -546,35 +1057,20 @@ void IvyRenderModule::InitWorkGraphProgram()
     const auto workGraphIndex = workGraphProperties->GetWorkGraphIndex(WorkGraphProgramName);
 
     // Set the input record limit. This is required for work graphs with mesh nodes.
-    workGraphProperties->SetMaximumInputRecords(workGraphIndex, static_cast<UINT>(m_ivyBranchRecords.size() + m_ivyAreaRecords.size()), 2);
-
-    // Create backing memory buffer
-    D3D12_WORK_GRAPH_MEMORY_REQUIREMENTS memoryRequirements = {};
-    workGraphProperties->GetWorkGraphMemoryRequirements(workGraphIndex, &memoryRequirements);
-    if (memoryRequirements.MaxSizeInBytes > 0)
-    {
-        BufferDesc bufferDesc = BufferDesc::Data(L"MeshNodeSample_WorkGraphBackingMemory",
-                                                 static_cast<uint32_t>(memoryRequirements.MaxSizeInBytes),
-                                                 1,
-                                                 D3D12_WORK_GRAPHS_BACKING_MEMORY_ALIGNMENT_IN_BYTES,
-                                                 ResourceFlags::AllowUnorderedAccess);
-
-        m_pWorkGraphBackingMemoryBuffer = Buffer::CreateBufferResource(&bufferDesc, ResourceState::UnorderedAccess);
-    }
+    // Every dispatch has the single entry record of its partition, independent of the number of entry records.
+    workGraphProperties->SetMaximumInputRecords(workGraphIndex, 1, 1);
 
     // Prepare work graph desc
     m_WorkGraphProgramDesc.Type                        = D3D12_PROGRAM_TYPE_WORK_GRAPH;
     m_WorkGraphProgramDesc.WorkGraph.ProgramIdentifier = stateObjectProperties->GetProgramIdentifier(WorkGraphProgramName);
-    // Set flag to initialize backing memory.
-    // We'll clear this flag once we've run the work graph for the first time.
-    m_WorkGraphProgramDesc.WorkGraph.Flags = D3D12_SET_WORK_GRAPH_FLAG_INITIALIZE;
-    // Set backing memory
-    if (m_pWorkGraphBackingMemoryBuffer)
-    {
-        const auto addressInfo                                      = m_pWorkGraphBackingMemoryBuffer->GetAddressInfo();
-        m_WorkGraphProgramDesc.WorkGraph.BackingMemory.StartAddress = addressInfo.GetImpl()->GPUBufferView;
-        m_WorkGraphProgramDesc.WorkGraph.BackingMemory.SizeInBytes  = addressInfo.GetImpl()->SizeInBytes;
-    }
+
+    // Create backing memory buffer, sized by the WorkGraphBackingMemory policy
+    D3D12_WORK_GRAPH_MEMORY_REQUIREMENTS memoryRequirements = {};
+    workGraphProperties->GetWorkGraphMemoryRequirements(workGraphIndex, &memoryRequirements);
+    m_backingMemoryRequirements.MinSizeInBytes         = memoryRequirements.MinSizeInBytes;
+    m_backingMemoryRequirements.MaxSizeInBytes         = memoryRequirements.MaxSizeInBytes;
+    m_backingMemoryRequirements.SizeGranularityInBytes = memoryRequirements.SizeGranularityInBytes;
+    CreateBackingMemory(IvySelectBackingMemorySize(m_backingMemoryRequirements, m_backingMemoryPolicy, m_backingMemoryFraction));
 
     // Query entry point indices
     m_WorkGraphEntryPoints.IvyBranch = workGraphProperties->GetEntrypointIndex(workGraphIndex, {L"IvyBranch", 0});
@@ -660,11 +1156,97 @@ void IvyRenderModule::RenderUserInterface()
             }
         }
     }
+
+    if (m_showInstanceCounts)
+    {
+        RenderInstanceCountUserInterface();
+    }
+
+    if (m_showBackingMemory)
+    {
+        RenderBackingMemoryUserInterface();
+    }
+}
+
+void IvyRenderModule::RenderInstanceCountUserInterface()
+{
+    const IvyInstanceCountHistory::Sample latest = m_instanceCounts.GetLatest();
+
+    ImGui::Begin("Ivy Instance Counts", &m_showInstanceCounts, ImGuiWindowFlags_AlwaysAutoResize);
+    ImGui::Text("Frame %llu, %u frames behind", static_cast<unsigned long long>(latest.Frame), IvyReadbackRing::SlotCount);
+    ImGui::Text("Capacity: %u instances per stream", m_instanceArena.GetCapacity());
+
+    const char* streamNames[2] = {"Leaf", "Stem"};
+    for (uint32_t stream = 0; stream < 2; ++stream)
+    {
+        ImGui::Text("%s: %u (peak %u, average %.0f)",
+                    streamNames[stream],
+                    latest.InstanceCount[stream],
+                    m_instanceCounts.GetPeak(stream),
+                    m_instanceCounts.GetAverage(stream));
+
+        // ImGui takes a getter with a single user pointer, the stream is selected by the plot
+        struct PlotData
+        {
+            const IvyInstanceCountHistory* pHistory;
+            uint32_t                       Stream;
+        } plotData = {&m_instanceCounts, stream};
+
+        ImGui::PlotLines(streamNames[stream],
+                         [](void* pData, int index) {
+                             const PlotData* pPlotData = static_cast<const PlotData*>(pData);
+                             return static_cast<float>(pPlotData->pHistory->GetSample(index).InstanceCount[pPlotData->Stream]);
+                         },
+                         &plotData,
+                         static_cast<int>(m_instanceCounts.GetSampleCount()),
+                         0,
+                         nullptr,
+                         0.f,
+                         static_cast<float>(m_instanceArena.GetCapacity()),
+                         ImVec2(256.f, 48.f));
+    }
+    ImGui::End();
+}
+
+void IvyRenderModule::RenderBackingMemoryUserInterface()
+{
+    const float mebibyte = 1024.f * 1024.f;
+
+    ImGui::Begin("Work Graph Backing Memory", &m_showBackingMemory, ImGuiWindowFlags_AlwaysAutoResize);
+    ImGui::Text("Requirements: %.2f - %.2f MiB",
+                m_backingMemoryRequirements.MinSizeInBytes / mebibyte,
+                m_backingMemoryRequirements.MaxSizeInBytes / mebibyte);
+    ImGui::Text("Size: %.2f MiB (%s)",
+                m_WorkGraphProgramDesc.WorkGraph.BackingMemory.SizeInBytes / mebibyte,
+                IvyGetBackingMemoryPolicyName(m_backingMemoryPolicy));
+    ImGui::Text("Dispatch time: %.3f ms, %u frames behind", m_dispatchSeconds * 1000.0, IvyReadbackRing::SlotCount);
+
+    if (m_backingMemorySweepStep >= 0)
+    {
+        ImGui::Text("Sweep step %d of %u", m_backingMemorySweepStep + 1, m_backingMemorySweep.GetStepCount());
+    }
+    else if (ImGui::Button("Sweep backing memory"))
+    {
+        StartBackingMemorySweep();
+    }
+
+    for (uint32_t step = 0; step < m_backingMemorySweep.GetStepCount(); ++step)
+    {
+        ImGui::Text("%.2f MiB: %.3f ms (%u dispatches)",
+                    m_backingMemorySweep.GetSizeInBytes(step) / mebibyte,
+                    m_backingMemorySweep.GetAverageSeconds(step) * 1000.0,
+                    m_backingMemorySweep.GetStep(step).SampleCount);
+    }
+    ImGui::End();
 }
 
 void IvyRenderModule::OnNewContentLoaded(ContentBlock* pContentBlock)
 {
     std::lock_guard<std::mutex> pipelineLock(m_CriticalSection);
+
+    // New geometry changes the ray traced surfaces, regenerate the ivy
+    ++m_contentVersion;
+
     // Material
 
     const size_t materialIdOffset = m_RTInfoTables.m_cpuMaterialBuffer.size();
@@ -718,6 +1300,7 @@ void IvyRenderModule::OnNewContentLoaded(ContentBlock* pContentBlock)
     MeshComponentMgr* pMeshComponentManager = MeshComponentMgr::Get();
 
     std::unordered_map<uint32_t, const Mesh*> meshIdxToMesh;
+    bool                                      ivyMeshesLoaded = false;
 
     uint32_t nodeID = 0, surfaceID = 0;
     for (auto* pEntityData : pContentBlock->EntityDataBlocks)
@@ -753,12 +1336,16 @@ void IvyRenderModule::OnNewContentLoaded(ContentBlock* pContentBlock)
 
                 if (pMeshData->m_Name == L"..\\media\\Ivy\\Stem")
                 {
-                    m_ivyStemSurfaceIndex = static_cast<int>(m_RTInfoTables.m_cpuSurfaceBuffer.size());
+                    m_ivyStemSurfaceIndex   = static_cast<int>(m_RTInfoTables.m_cpuSurfaceBuffer.size());
+                    m_ivyStemBoundingSphere = GetBoundingSphere(pMesh->GetSurface(0));
+                    ivyMeshesLoaded         = true;
                 }
 
                 if (pMeshData->m_Name == L"..\\media\\Ivy\\Leaf")
                 {
-                    m_ivyLeafSurfaceIndex = static_cast<int>(m_RTInfoTables.m_cpuSurfaceBuffer.size());
+                    m_ivyLeafSurfaceIndex   = static_cast<int>(m_RTInfoTables.m_cpuSurfaceBuffer.size());
+                    m_ivyLeafBoundingSphere = GetBoundingSphere(pMesh->GetSurface(0));
+                    ivyMeshesLoaded         = true;
                 }
 
                 for (uint32_t i = 0; i < numSurfaces; ++i)
@@ -872,6 +1459,11 @@ void IvyRenderModule::OnNewContentLoaded(ContentBlock* pContentBlock)
         }
     }
 
+    if (ivyMeshesLoaded)
+    {
+        LoadMeshLods();
+    }
+
     if (m_RTInfoTables.m_cpuSurfaceBuffer.size() > 0)
     {
         // Upload
@@ -934,8 +1526,65 @@ void IvyRenderModule::OnNewContentLoaded(ContentBlock* pContentBlock)
     }
 }
 
+void IvyRenderModule::LoadMeshLods()
+{
+    IvyGltfDocument document;
+    std::string     error;
+    if (!document.Load(m_ivyMeshFile, &error))
+    {
+        CauldronWarning(L"Cannot build the ivy mesh LODs: %s", StringToWString(error).c_str());
+        return;
+    }
+
+    // [0] leaf, [1] stem, same streams as IvyInstanceCulling
+    const char* meshNames[2] = {"Leaf", "Stem"};
+    for (uint32_t stream = 0; stream < 2; ++stream)
+    {
+        std::vector<IvyMeshData> surfaces;
+
+        const int meshIndex = document.FindMesh(meshNames[stream]);
+        if ((meshIndex < 0) || !document.ReadMesh(meshIndex, surfaces, &error) || surfaces.empty() || (surfaces[0].Normals.size() != surfaces[0].Positions.size()))
+        {
+            CauldronWarning(L"Cannot build the LODs of the ivy mesh %s: %s", StringToWString(meshNames[stream]).c_str(), StringToWString(error).c_str());
+            continue;
+        }
+
+        IvyMeshLodChain chain;
+        IvyBuildMeshLodChain(surfaces[0], IvyMeshLodSettings(), chain);
+
+        m_ivyMeshLods[stream].Upload(StringToWString(std::string("Ivy_") + meshNames[stream]), chain);
+        m_ivyInstanceCulling.SetMeshLods(stream, chain.Lods);
+
+        if (stream == 0)
+        {
+            LoadLeafImpostorAtlas(surfaces[0]);
+        }
+    }
+}
+
+void IvyRenderModule::LoadLeafImpostorAtlas(const IvyMeshData& leafMesh)
+{
+    IvyLeafImpostorAtlas atlas;
+    std::string          error;
+    if (m_leafImpostorAtlasFile.empty())
+    {
+        IvyBakeLeafImpostorAtlas(leafMesh, IvyLeafImpostorAtlasSettings(), atlas);
+    }
+    else if (!IvyReadLeafImpostorAtlas(m_leafImpostorAtlasFile, atlas, &error))
+    {
+        CauldronWarning(L"Cannot load the leaf impostor atlas: %s", StringToWString(error).c_str());
+        IvyBakeLeafImpostorAtlas(leafMesh, IvyLeafImpostorAtlasSettings(), atlas);
+    }
+
+    m_ivyLeafImpostors.UploadAtlas(atlas);
+}
+
 void IvyRenderModule::OnContentUnloaded(ContentBlock* pContentBlock)
 {
+    std::lock_guard<std::mutex> pipelineLock(m_CriticalSection);
+
+    ++m_contentVersion;
+
     for (auto materialInfo : m_RTInfoTables.m_cpuMaterialBuffer)
     {
         if (materialInfo.albedo_tex_id > 0)
@@ -25,6 +25,18 @@
 #include "render/shaderbuilder.h"
 #include "core/contentmanager.h"
 #include "core/uimanager.h"
+#include "cpu/ivybackingmemory.h"
+#include "cpu/ivyentryrecordbuffer.h"
+#include "cpu/ivygenerationcache.h"
+#include "cpu/ivyinstancearena.h"
+#include "cpu/ivyinstancecounthistory.h"
+#include "ivyhiz.h"
+#include "ivyinstanceculling.h"
+#include "ivyinstancepartitions.h"
+#include "ivyinstancesort.h"
+#include "ivyleafimpostors.h"
+#include "ivyreadbackring.h"
+#include "ivyretiredbuffers.h"
 #include "ivyrender_indirect.h"
 
 // common files with shaders
@@ -65,6 +77,14 @@ public:
      */
     void OnResize(const cauldron::ResolutionInfo& resInfo) override;
 
+    /**
+     * @brief   Leaf & stem instance counts of the draw arguments, IvyReadbackRing::SlotCount frames behind the GPU.
+     */
+    const IvyInstanceCountHistory& GetInstanceCounts() const
+    {
+        return m_instanceCounts;
+    }
+
 private:
     /**
      * @brief   Create and initialize textures required for rendering and shading.
@@ -74,6 +94,46 @@ private:
      * @brief   Create and initialize the work graph program with mesh nodes.
      */
     void InitWorkGraphProgram();
+    /**
+     * @brief   (Re)creates the leaf & stem instance buffers and the instance key buffer for capacity instances per stream.
+     */
+    void CreateInstanceBuffers(uint32_t capacity);
+    /**
+     * @brief   Grows the instance arena if a previous generation dropped instances, see IvyInstanceArena.
+     *          Returns true if the instance buffers were reallocated.
+     */
+    bool UpdateInstanceArena();
+    /**
+     * @brief   (Re)creates the work graph backing memory, the next dispatch initializes it.
+     */
+    void CreateBackingMemory(uint64_t sizeInBytes);
+    /**
+     * @brief   Starts measuring the dispatch time for each step of a backing memory sweep, BackingMemorySweepFrames frames per step.
+     */
+    void StartBackingMemorySweep();
+    /**
+     * @brief   Collects the dispatch times & advances the backing memory sweep. Returns true if all partitions have to be regenerated.
+     */
+    bool UpdateBackingMemorySweep();
+
+    /**
+     * @brief   Renders the instance counts of the last frames, see GetInstanceCounts().
+     */
+    void RenderInstanceCountUserInterface();
+    /**
+     * @brief   Renders the backing memory size, the dispatch time & the results of the last backing memory sweep.
+     */
+    void RenderBackingMemoryUserInterface();
+
+    /**
+     * @brief   (Re)creates m_pEntryRecordBuffer for the capacity of m_entryRecords, the old buffer is retired.
+     */
+    void CreateEntryRecordBuffer();
+
+    /**
+     * @brief   Copies the dirty ranges of m_entryRecords to m_pEntryRecordBuffer.
+     */
+    void UploadEntryRecords(cauldron::CommandList* pCmdList);
 
     /**
      * @brief   Renders 3D user interface for manipulating ivy generation.
@@ -84,6 +144,17 @@ private:
      * Prepare surface information for raytracing passes.
      */
     virtual void OnNewContentLoaded(cauldron::ContentBlock* pContentBlock) override;
+
+    /**
+     * @brief   Builds & uploads the LOD chains of the leaf & stem meshes from m_ivyMeshFile, Cauldron keeps no CPU copy of the loaded vertices.
+     *          Also bakes the leaf impostor atlas from the leaf mesh, or loads it from m_leafImpostorAtlasFile.
+     */
+    void LoadMeshLods();
+
+    /**
+     * @brief   Bakes or loads the leaf impostor atlas & uploads it to m_ivyLeafImpostors.
+     */
+    void LoadLeafImpostorAtlas(const IvyMeshData& leafMesh);
     /**
      * @copydoc ContentListener::OnContentUnloaded()
      */
@@ -121,7 +192,50 @@ private:
     int                          m_selectedIvyArea = -1;
     bool                         m_updateIvyUI     = false;
 
+    // Entry records of all partitions, persistent on the GPU for D3D12_DISPATCH_MODE_MULTI_NODE_GPU_INPUT
+    IvyEntryRecordBuffer m_entryRecords;
+    cauldron::Buffer*    m_pEntryRecordBuffer = nullptr;
+
     cauldron::UISection m_UISection;
+    cauldron::UISection m_GenerationUISection;
+
+    // Sort instances by IvyInstanceKey after the work graph, see IvyInstanceSort
+    bool            m_deterministicInstanceOrder = false;
+    IvyInstanceSort m_ivyInstanceSort;
+
+    // Partitions of the instance buffers per entry record, only changed records are regenerated
+    IvyInstancePartitions m_ivyInstancePartitions;
+
+    // Only draw the instances within the view frustum & not hidden behind the scene, see IvyInstanceCulling
+    bool               m_frustumCulling   = true;
+    bool               m_occlusionCulling = true;  // requires m_frustumCulling
+    IvyInstanceCulling m_ivyInstanceCulling;
+    IvyHiZPyramid      m_ivyHiZPyramid;
+    Vec4               m_ivyLeafBoundingSphere = Vec4(0.f, 0.f, 0.f, 0.f);  // local bounds of the leaf & stem meshes
+    Vec4               m_ivyStemBoundingSphere = Vec4(0.f, 0.f, 0.f, 0.f);
+    // The cluster bounds are rebuilt when the generated instances change, also for the baked instances
+    bool               m_instanceClustersDirty = true;
+
+    // Simplified LODs of the leaf & stem meshes, selected per instance by IvyInstanceCulling, see cpu/ivymeshsimplifier.h
+    bool              m_meshLods      = true;
+    float             m_lodPixelError = 1.f;  // accepted screen space error of a LOD in pixels
+    std::string       m_ivyMeshFile;          // glTF file of the leaf & stem meshes, read again for their vertices
+    IvyMeshLodBuffers m_ivyMeshLods[2];       // leaf, stem
+
+    // Visible leaf clusters beyond m_impostorDistance are drawn as impostor quads, requires m_frustumCulling
+    bool             m_leafImpostors    = true;
+    float            m_impostorDistance = 20.f;  // view depth of the nearest point of a cluster
+    std::string      m_leafImpostorAtlasFile;    // atlas written by IvyBake --impostor-atlas, baked at content load if empty
+    IvyLeafImpostors m_ivyLeafImpostors;
+
+    // Skip the work graph for entry records with unchanged inputs, see IvyPartitionedGenerationCache
+    bool                          m_cacheGeneratedIvy = true;
+    IvyPartitionedGenerationCache m_generationCache;
+    uint64_t                      m_contentVersion = 0;  // incremented whenever scene content is loaded or unloaded
+
+    // Instances uploaded from BakedInstanceFile, drawn while the entry records match the ones of the file
+    bool     m_useBakedInstances = false;
+    uint64_t m_bakedRecordKey    = 0;
 
     std::mutex m_CriticalSection;
 
@@ -163,4 +277,49 @@ private:
     // Instance buffers for ExecuteIndirect rendering
     cauldron::Buffer* m_pStemInstanceBuffer = nullptr;
     cauldron::Buffer* m_pLeafInstanceBuffer = nullptr;
+
+    // Sort keys of the leaf (first arena capacity) & stem instances, written by the partition compaction
+    cauldron::Buffer* m_pInstanceKeyBuffer = nullptr;
+
+    // Capacity of the instance buffers, grown when the partitions report dropped instances
+    IvyInstanceArena m_instanceArena;
+    bool             m_instanceArenaWarning = false;
+
+    // Readback of the partition counters after the compaction & the generation they belong to
+    struct ArenaStatusGeneration
+    {
+        uint32_t LayoutVersion  = 0;  // arena layout of the generation
+        uint32_t PartitionCount = 0;
+    };
+    IvyReadbackRing       m_arenaStatusReadback;
+    ArenaStatusGeneration m_arenaStatusGenerations[IvyReadbackRing::SlotCount];
+
+    // Buffers replaced by the arena growth & backing memory resizes, deleted once the frames in flight completed
+    IvyRetiredBuffers m_retiredBuffers;
+
+    // Readback of the draw arguments of every frame
+    IvyReadbackRing         m_argumentReadback;
+    IvyInstanceCountHistory m_instanceCounts;
+    bool                    m_showInstanceCounts = false;
+    uint64_t                m_frameIndex         = 0;
+
+    // Size of the work graph backing memory, selected by WorkGraphBackingMemory within the requirements of the work graph
+    IvyBackingMemoryRequirements m_backingMemoryRequirements;
+    IvyBackingMemoryPolicy       m_backingMemoryPolicy   = IvyBackingMemoryPolicy::Max;
+    float                        m_backingMemoryFraction = 0.5f;
+    bool                         m_showBackingMemory     = false;
+
+    // GPU time of the work graph dispatches of a frame, resolved from timestamps at the start & end of the dispatches
+    ID3D12QueryHeap* m_pDispatchTimestampHeap = nullptr;
+    IvyReadbackRing  m_dispatchTimestampReadback;
+    int32_t          m_dispatchTimestampSteps[IvyReadbackRing::SlotCount] = {};  // sweep step of each slot, -1 outside of a sweep
+    double           m_timestampFrequency                                 = 1.0;
+    double           m_dispatchSeconds                                    = 0.0;
+
+    // Backing memory sweep, m_backingMemorySweepStep is -1 while no sweep is running
+    IvyBackingMemorySweep m_backingMemorySweep;
+    uint32_t              m_backingMemorySweepFrames = 64;
+    std::string           m_backingMemorySweepFile;
+    int32_t               m_backingMemorySweepStep   = -1;
+    uint32_t              m_backingMemorySweepFrame  = 0;
 };
\ No newline at end of file
@@ -0,0 +1,94 @@
+// This file is part of the AMD Work Graph Ivy Generation Sample.
+//
+// Copyright (c) 2024 Advanced Micro Devices, Inc. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+#pragma once
+
+#include "render/buffer.h"
+#include "ivyreadbackring.h"
+
+#include <cstdint>
+#include <vector>
+
+/**
+ * @brief   Defers deleting buffers that may still be referenced by frames in flight, so growing a buffer does not stall the GPU.
+ *
+ * Retire() keeps a buffer in the slot of the current frame, BeginFrame() deletes the buffers of the same slot SlotCount frames
+ * later. Like IvyReadbackRing, this relies on Cauldron having at most 3 frames in flight, so those frames have completed by then.
+ */
+struct IvyRetiredBuffers
+{
+    static const uint32_t SlotCount = IvyReadbackRing::SlotCount;
+
+    std::vector<cauldron::Buffer*> m_buffers[SlotCount];
+    uint32_t                       m_slot = SlotCount - 1;  // slot of the current frame
+
+    ~IvyRetiredBuffers()
+    {
+        for (std::vector<cauldron::Buffer*>& buffers : m_buffers)
+        {
+            for (cauldron::Buffer* pBuffer : buffers)
+            {
+                delete pBuffer;
+            }
+        }
+    }
+
+    /**
+     * @brief   Advances to the slot of the next frame, has to be called once per frame before Retire().
+     *          Deletes the buffers retired SlotCount frames ago.
+     */
+    void BeginFrame()
+    {
+        m_slot = (m_slot + 1) % SlotCount;
+
+        for (cauldron::Buffer* pBuffer : m_buffers[m_slot])
+        {
+            delete pBuffer;
+        }
+        m_buffers[m_slot].clear();
+    }
+
+    void Retire(cauldron::Buffer* pBuffer)
+    {
+        if (pBuffer)
+        {
+            m_buffers[m_slot].push_back(pBuffer);
+        }
+    }
+};
+
+/**
+ * @brief   Releases a buffer that is about to be replaced. Without pRetiredBuffers the buffer is deleted right away and must not
+ *          be in use by the GPU anymore.
+ */
+inline void IvyReleaseBuffer(cauldron::Buffer*& pBuffer, IvyRetiredBuffers* pRetiredBuffers)
+{
+    if (pRetiredBuffers)
+    {
+        pRetiredBuffers->Retire(pBuffer);
+    }
+    else
+    {
+        delete pBuffer;
+    }
+    pBuffer = nullptr;
+}
@@ -28,6 +28,7 @@ struct IvyAreaSampleRecord
     float4x4 transform;
     uint     seed;
     uint     sampleCount;
+    uint     partition;
 };
 
 static const uint ivyAreaSampleThreadGroupSize = 32;
@@ -51,27 +52,6 @@ void IvyArea(
 {
     const IvyAreaRecord record = inputRecord.Get();
     
-    // Initialize argument buffer in Entry Node
-    // Set InstanceCount to 0, IndexCountPerInstance to correct values
-    if (IvyLeafSurfaceIndex >= 0)
-    {
-        g_argumentBuffer[0].InstanceCount = 0;
-        g_argumentBuffer[0].IndexCountPerInstance = g_surface_info[IvyLeafSurfaceIndex].num_indices;
-        g_argumentBuffer[0].StartIndexLocation = 0;
-        g_argumentBuffer[0].BaseVertexLocation = 0;
-        g_argumentBuffer[0].StartInstanceLocation = 0;
-    }
-    
-    // Initialize stem argument buffer
-    if (IvyStemSurfaceIndex >= 0)
-    {
-        g_argumentBuffer[1].InstanceCount = 0;
-        g_argumentBuffer[1].IndexCountPerInstance = g_surface_info[IvyStemSurfaceIndex].num_indices;
-        g_argumentBuffer[1].StartIndexLocation = 0;
-        g_argumentBuffer[1].BaseVertexLocation = 0;
-        g_argumentBuffer[1].StartInstanceLocation = 0;
-    }
-
     // record.transform defines a bounding box in [-1; 1]
     // Here we compute the area of the top surface of the bounding box
     const float xScale = length(mul((float3x3)record.transform, float3(1, 0, 0))) * 2;
@@ -86,6 +66,7 @@ void IvyArea(
     outputRecord.Get().transform    = record.transform;
     outputRecord.Get().seed         = record.seed;
     outputRecord.Get().sampleCount  = sampleCount;
+    outputRecord.Get().partition    = record.partition;
 
     outputRecord.OutputComplete();
 }
@@ -142,7 +123,8 @@ void IvyAreaSample(
             // move origin up to not place ivy inside the surface
             Translate(0, 2 * ivyStemRadius, 0)
         );
-        outputRecord.Get(0).seed = CombineSeed(record.seed, dtid);
+        outputRecord.Get(0).seed      = CombineSeed(record.seed, dtid);
+        outputRecord.Get(0).partition = record.partition;
     }
 
     outputRecord.OutputComplete();
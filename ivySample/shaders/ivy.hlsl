@@ -20,6 +20,7 @@
 // THE SOFTWARE.
 
 #include "common.hlsl"
+#include "ivyinstanceencoding.h"
 #include "raytracing.hlsl"
 
 static const uint ivyWaveSize = 32;
@@ -30,6 +31,14 @@ static const uint ivyForwardProbeCount = 8;
 groupshared uint outputStemCount;
 groupshared uint outputLeafCount;
 
+// Sort keys of the output records, written to g_instanceKeyBuffer for the deterministic instance order
+groupshared IvyInstanceKey outputStemKeys[maxStemsPerRecord];
+groupshared IvyInstanceKey outputLeafKeys[maxLeavesPerRecord];
+
+// Input record of each output, the records of a group may belong to different partitions
+groupshared uint outputStemInputRecords[maxStemsPerRecord];
+groupshared uint outputLeafInputRecords[maxLeavesPerRecord];
+
 [WaveSize(ivyWaveSize)]
 [Shader("node")]
 [NodeIsProgramEntry]
@@ -134,6 +143,8 @@ void IvyBranch(
                         RotateX(stemRotation),
                         Scale(stemScale, 1.f, 1.f)
                     );
+                    outputStemKeys[stemOutputIndex]         = MakeIvyInstanceKey(seed, iteration, 0);
+                    outputStemInputRecords[stemOutputIndex] = inputRecordIndex;
                 }
 
                 // Draw two leafes if stem is long enough
@@ -142,6 +153,11 @@ void IvyBranch(
                     int leafOutputIndex;
                     InterlockedAdd(outputLeafCount, 2, leafOutputIndex);
 
+                    outputLeafKeys[leafOutputIndex + 0]         = MakeIvyInstanceKey(seed, iteration, 0);
+                    outputLeafKeys[leafOutputIndex + 1]         = MakeIvyInstanceKey(seed, iteration, 1);
+                    outputLeafInputRecords[leafOutputIndex + 0] = inputRecordIndex;
+                    outputLeafInputRecords[leafOutputIndex + 1] = inputRecordIndex;
+
                     ivyLeafOutputRecord.Get().transform[leafOutputIndex + 0] = (float3x4)mmul(
                         transform,
                         Translate(leafOffset.x * stemScale * ivyStemLength, 0, 0),
@@ -184,11 +200,18 @@ void IvyBranch(
                         transform,
                         RotateX(stemRotation)
                     );
+                    outputStemKeys[stemOutputIndex]         = MakeIvyInstanceKey(seed, iteration, 0);
+                    outputStemInputRecords[stemOutputIndex] = inputRecordIndex;
 
                     // Draw leafes
                     int leafOutputIndex;
                     InterlockedAdd(outputLeafCount, 2, leafOutputIndex);
 
+                    outputLeafKeys[leafOutputIndex + 0]         = MakeIvyInstanceKey(seed, iteration, 0);
+                    outputLeafKeys[leafOutputIndex + 1]         = MakeIvyInstanceKey(seed, iteration, 1);
+                    outputLeafInputRecords[leafOutputIndex + 0] = inputRecordIndex;
+                    outputLeafInputRecords[leafOutputIndex + 1] = inputRecordIndex;
+
                     ivyLeafOutputRecord.Get().transform[leafOutputIndex + 0] = (float3x4)mmul(
                         transform,
                         Translate(leafOffset.x * ivyStemLength, 0, 0),
@@ -303,18 +326,21 @@ void IvyBranch(
 
     if (writingThread && (hasNext || hasBranch))
     {
-        const uint seed = inputRecord.Get(inputRecordIndex).seed;
+        const uint seed      = inputRecord.Get(inputRecordIndex).seed;
+        const uint partition = inputRecord.Get(inputRecordIndex).partition;
 
         if (hasNext)
         {
             recursiveOutputRecord.Get(0).transform = transform;
             recursiveOutputRecord.Get(0).seed      = CombineSeed(seed, 3487, Hash(transform));
+            recursiveOutputRecord.Get(0).partition = partition;
         }
 
         if (hasBranch)
         {
             recursiveOutputRecord.Get(hasNext).transform = branchTransform;
             recursiveOutputRecord.Get(hasNext).seed      = CombineSeed(seed, 83497, Hash(branchTransform));
+            recursiveOutputRecord.Get(hasNext).partition = partition;
         }
     }
 
@@ -322,46 +348,59 @@ void IvyBranch(
 
     GroupMemoryBarrierWithGroupSync();
 
-    if (groupThreadId == 0)  // Only group's first thread handles writing to instance buffers
-    {        
-        // Get starting index for writing leaf instances
-        uint leafInstanceStartIndex;
-        InterlockedAdd(g_argumentBuffer[0].InstanceCount, outputLeafCount, leafInstanceStartIndex);
-        
-        // Write all leaf transforms to the instance buffer
+    // One thread per input record writes the instances of that record to the partition of its entry record
+    if (groupThreadId < inputRecord.Count())
+    {
+        const uint                 partitionIndex = inputRecord.Get(groupThreadId).partition;
+        const IvyInstancePartition partition      = g_partitionBuffer[partitionIndex];
+
+        uint recordLeafCount = 0;
         for (uint leafIdx = 0; leafIdx < outputLeafCount; leafIdx++)
         {
-            float3x4 leafTransform = ivyLeafOutputRecord.Get().transform[leafIdx];
-            
-            // Convert 3x4 matrix to 4x4 matrix for IvyInstanceData
-            float4x4 fullTransform = float4x4(
-                leafTransform._m00, leafTransform._m01, leafTransform._m02, leafTransform._m03,
-                leafTransform._m10, leafTransform._m11, leafTransform._m12, leafTransform._m13,
-                leafTransform._m20, leafTransform._m21, leafTransform._m22, leafTransform._m23,
-                0.0f,               0.0f,               0.0f,               1.0f
-            );
-            
-            g_leafInstanceBuffer[leafInstanceStartIndex + leafIdx].transform = fullTransform;
+            recordLeafCount += (outputLeafInputRecords[leafIdx] == groupThreadId) ? 1 : 0;
         }
-        
-        // Get starting index for writing stem instances
-        uint stemInstanceStartIndex;
-        InterlockedAdd(g_argumentBuffer[1].InstanceCount, outputStemCount, stemInstanceStartIndex);
-        
-        // Write all stem transforms to the instance buffer
+
+        uint recordStemCount = 0;
         for (uint stemIdx = 0; stemIdx < outputStemCount; stemIdx++)
         {
-            float3x4 stemTransform = ivyStemOutputRecord.Get().transform[stemIdx];
-            
-            // Convert 3x4 matrix to 4x4 matrix for IvyInstanceData
-            float4x4 fullTransform = float4x4(
-                stemTransform._m00, stemTransform._m01, stemTransform._m02, stemTransform._m03,
-                stemTransform._m10, stemTransform._m11, stemTransform._m12, stemTransform._m13,
-                stemTransform._m20, stemTransform._m21, stemTransform._m22, stemTransform._m23,
-                0.0f,               0.0f,               0.0f,               1.0f
-            );
-            
-            g_stemInstanceBuffer[stemInstanceStartIndex + stemIdx].transform = fullTransform;
+            recordStemCount += (outputStemInputRecords[stemIdx] == groupThreadId) ? 1 : 0;
+        }
+
+        // Get starting index for writing leaf instances
+        uint leafInstanceIndex;
+        InterlockedAdd(g_partitionCounterBuffer[partitionIndex].x, recordLeafCount, leafInstanceIndex);
+
+        // Write the leaf transforms of the record to the instance buffer
+        // Instances beyond the capacity of the partition are dropped, the counter still includes them
+        for (uint leafIdx = 0; (leafIdx < outputLeafCount) && (leafInstanceIndex < partition.capacity.x); leafIdx++)
+        {
+            if (outputLeafInputRecords[leafIdx] == groupThreadId)
+            {
+                float3x4 leafTransform = ivyLeafOutputRecord.Get().transform[leafIdx];
+
+                // Encode 3x4 matrix as selected by IVY_INSTANCE_ENCODING
+                g_leafInstanceBuffer[partition.offset.x + leafInstanceIndex] = IvyEncodeInstance(leafTransform);
+                g_instanceKeyBuffer[partition.offset.x + leafInstanceIndex]  = outputLeafKeys[leafIdx];
+                leafInstanceIndex++;
+            }
+        }
+
+        // Get starting index for writing stem instances
+        uint stemInstanceIndex;
+        InterlockedAdd(g_partitionCounterBuffer[partitionIndex].y, recordStemCount, stemInstanceIndex);
+
+        // Write the stem transforms of the record to the instance buffer
+        for (uint stemIdx = 0; (stemIdx < outputStemCount) && (stemInstanceIndex < partition.capacity.y); stemIdx++)
+        {
+            if (outputStemInputRecords[stemIdx] == groupThreadId)
+            {
+                float3x4 stemTransform = ivyStemOutputRecord.Get().transform[stemIdx];
+
+                // Encode 3x4 matrix as selected by IVY_INSTANCE_ENCODING
+                g_stemInstanceBuffer[partition.offset.y + stemInstanceIndex]                    = IvyEncodeInstance(stemTransform);
+                g_instanceKeyBuffer[InstanceCapacity + partition.offset.y + stemInstanceIndex] = outputStemKeys[stemIdx];
+                stemInstanceIndex++;
+            }
         }
     }
 
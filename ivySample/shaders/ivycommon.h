@@ -22,19 +22,25 @@
 #pragma once
 
 #if __cplusplus
+#if defined(IVY_HEADLESS)
+// Headless builds (CPU engine, benchmarks) do not link against Cauldron
+#include "cpu/headlessmath.h"
+#else
 #include "misc/math.h"
+#endif  // IVY_HEADLESS
 #endif  // __cplusplus
 
 #if __cplusplus
 struct WorkGraphCBData
 {
-    Mat4 ViewProjection;
-    Mat4 PreviousViewProjection;
-    Mat4 InverseViewProjection;
-    Vec4 CameraPosition;
-    Vec4 PreviousCameraPosition;
-    int  IvyStemSurfaceIndex;
-    int  IvyLeafSurfaceIndex;
+    Mat4     ViewProjection;
+    Mat4     PreviousViewProjection;
+    Mat4     InverseViewProjection;
+    Vec4     CameraPosition;
+    Vec4     PreviousCameraPosition;
+    int      IvyStemSurfaceIndex;
+    int      IvyLeafSurfaceIndex;
+    uint32_t InstanceCapacity;  // instances per stream of the arena, offset of the stem keys
 };
 #else
 cbuffer WorkGraphCBData : register(b0)
@@ -46,18 +52,22 @@ cbuffer WorkGraphCBData : register(b0)
     float4 PreviousCameraPosition;
     int    IvyStemSurfaceIndex;
     int    IvyLeafSurfaceIndex;
+    uint   InstanceCapacity;
 }
 #endif  // __cplusplus
 
 // Entry node records
+// partition is the entry record that owns the instances, also in the records spawned from it, see IvyInstancePartitions
 struct IvyBranchRecord
 {
 #if __cplusplus
     Mat4         transform;
     unsigned int seed;
+    unsigned int partition;
 #else
     float4x4     transform;
     unsigned int seed;
+    unsigned int partition;
 #endif  // __cplusplus
 };
 
@@ -67,10 +77,12 @@ struct IvyAreaRecord
     Mat4         transform;
     unsigned int seed;
     float        density;
+    unsigned int partition;
 #else
     float4x4     transform;
     unsigned int seed;
     float        density;
+    unsigned int partition;
 #endif  // __cplusplus
 };
 
@@ -164,6 +176,23 @@ struct DrawIndexedArgs
     uint32_t StartInstanceLocation;
 };
 
+// ExecuteIndirect dispatch arguments structure
+struct DispatchArgs
+{
+    uint32_t ThreadGroupCountX;
+    uint32_t ThreadGroupCountY;
+    uint32_t ThreadGroupCountZ;
+};
+
+// ExecuteIndirect non-indexed draw arguments structure
+struct DrawArgs
+{
+    uint32_t VertexCountPerInstance;
+    uint32_t InstanceCount;
+    uint32_t StartVertexLocation;
+    uint32_t StartInstanceLocation;
+};
+
 // Instance data for ExecuteIndirect rendering
 struct IvyInstanceData
 {
@@ -172,4 +201,236 @@ struct IvyInstanceData
 #else
     float4x4 transform;
 #endif  // __cplusplus
-};
\ No newline at end of file
+};
+
+// Encodings of the leaf & stem instance buffers, see shaders/ivyinstanceencoding.h
+#define IVY_INSTANCE_ENCODING_FLOAT4X4  0  // IvyInstanceData, 64 bytes
+#define IVY_INSTANCE_ENCODING_FLOAT3X4  1  // IvyInstanceData3x4, 48 bytes, lossless
+#define IVY_INSTANCE_ENCODING_QUANTIZED 2  // IvyInstanceDataQuantized, 16 bytes
+
+#ifndef IVY_INSTANCE_ENCODING
+#define IVY_INSTANCE_ENCODING IVY_INSTANCE_ENCODING_FLOAT3X4
+#endif  // IVY_INSTANCE_ENCODING
+
+// Quantized instance positions cover [-IVY_INSTANCE_POSITION_RANGE; IVY_INSTANCE_POSITION_RANGE] on each axis
+#define IVY_INSTANCE_POSITION_RANGE 128.0f
+
+// Rows of the 3x4 affine instance transform, the last row is always (0, 0, 0, 1)
+struct IvyInstanceData3x4
+{
+#if __cplusplus
+    float rows[3][4];
+#else
+    float4 rows[3];
+#endif  // __cplusplus
+};
+
+// Quantized position, rotation & scale, see shaders/ivyinstanceencoding.h
+struct IvyInstanceDataQuantized
+{
+#if __cplusplus
+    uint32_t data[4];
+#else
+    uint4 data;
+#endif  // __cplusplus
+};
+
+#if IVY_INSTANCE_ENCODING == IVY_INSTANCE_ENCODING_FLOAT4X4
+typedef IvyInstanceData IvyEncodedInstance;
+#elif IVY_INSTANCE_ENCODING == IVY_INSTANCE_ENCODING_FLOAT3X4
+typedef IvyInstanceData3x4 IvyEncodedInstance;
+#else
+typedef IvyInstanceDataQuantized IvyEncodedInstance;
+#endif  // IVY_INSTANCE_ENCODING
+
+// Upper bound of the leaf & stem instance buffers, which grow up to this capacity (see cpu/ivyinstancearena.h)
+#define IVY_MAX_INSTANCES 500000
+// Power of two >= IVY_MAX_INSTANCES, upper bound of the sort entries per stream of the instance sort post-pass
+#define IVY_INSTANCE_SORT_CAPACITY 524288
+// Upper bound of the levels of the Hi-Z pyramid for occlusion culling, covers depth buffers up to 65536 pixels wide
+#define IVY_MAX_HIZ_LEVELS 16
+
+// Instances per cluster of the culling pass. Clusters are culled before their instances, see shaders/ivyinstanceculling.hlsl
+#define IVY_INSTANCE_CLUSTER_SIZE 64
+// Upper bound of the LODs of the leaf & stem meshes, selected per instance by the culling pass (one float4 of LOD errors)
+#define IVY_MAX_MESH_LODS 4
+// Leaf instances per impostor quad, distant leaf clusters are drawn as one quad per group, see shaders/ivyleafimpostor.h
+#define IVY_LEAF_IMPOSTOR_GROUP_SIZE 16
+#define IVY_LEAF_IMPOSTOR_QUADS      (IVY_INSTANCE_CLUSTER_SIZE / IVY_LEAF_IMPOSTOR_GROUP_SIZE)
+// Tiles of the leaf impostor atlas, side by side in a row, see cpu/ivyleafimpostoratlas.h
+#define IVY_LEAF_IMPOSTOR_TILES 4
+
+// Consecutive instances of a leaf or stem instance buffer & the bounds of their bounding spheres
+struct IvyInstanceCluster
+{
+#if __cplusplus
+    float        boundsMin[3];
+    unsigned int firstInstance;
+    float        boundsMax[3];
+    unsigned int instanceCount;
+#else
+    float3       boundsMin;
+    unsigned int firstInstance;
+    float3       boundsMax;
+    unsigned int instanceCount;
+#endif  // __cplusplus
+};
+
+// Oriented quad standing in for a group of IVY_LEAF_IMPOSTOR_GROUP_SIZE leaf instances of a cluster,
+// the corners are center +- axisU +- axisV, the leaves face cross(axisV, axisU)
+struct IvyLeafImpostorQuad
+{
+#if __cplusplus
+    float        center[3];
+    unsigned int tile;           // tile of the impostor atlas
+    float        axisU[3];       // scaled by the half extent of the quad
+    unsigned int instanceCount;  // 0: unused quad of a partial cluster
+    float        axisV[3];
+    unsigned int padding;
+#else
+    float3       center;
+    unsigned int tile;
+    float3       axisU;
+    unsigned int instanceCount;
+    float3       axisV;
+    unsigned int padding;
+#endif  // __cplusplus
+};
+
+// Sort key of a leaf or stem instance for the deterministic instance order.
+// InterlockedAdd compaction makes the instance order depend on scheduling, sorting by
+// (seed of the writing IvyBranch record, iteration, slot) restores a stable order.
+struct IvyInstanceKey
+{
+    unsigned int seed;
+    unsigned int iterationSlot;  // iteration << 2 | slot, slot is 0 for stems and 0/1 for the two leaves
+};
+
+// Instances of one partition in the partition buffers (g_partitionBuffer), laid out by cpu/ivyinstancearena.h
+struct IvyInstancePartition
+{
+#if __cplusplus
+    unsigned int offset[2];    // first leaf & stem instance
+    unsigned int capacity[2];  // leaf & stem instances
+    unsigned int regenerate;   // 1 if the current dispatch regenerates the partition, ResetPartitions clears its counters
+#else
+    uint2 offset;
+    uint2 capacity;
+    uint  regenerate;
+#endif  // __cplusplus
+};
+
+// Instance counters of one partition (g_partitionCounterBuffer), read back by IvyRenderModule to lay out
+// the instance arena, see cpu/ivyinstancearena.h
+struct IvyInstanceArenaStatus
+{
+    unsigned int instanceCount[2];  // leaf & stem instances, including the ones dropped beyond the partition capacity
+};
+
+#if __cplusplus
+inline IvyInstanceKey MakeIvyInstanceKey(unsigned int seed, unsigned int iteration, unsigned int slot)
+#else
+IvyInstanceKey MakeIvyInstanceKey(unsigned int seed, unsigned int iteration, unsigned int slot)
+#endif  // __cplusplus
+{
+    IvyInstanceKey key;
+    key.seed          = seed;
+    key.iterationSlot = (iteration << 2) | slot;
+    return key;
+}
+
+// Width or height of a level of the Hi-Z pyramid for a depth buffer of the given size.
+// Each texel of level 0 holds the farthest depth of 2x2 pixels, each texel of level n + 1 the farthest of 2x2 texels of level n.
+#if __cplusplus
+inline unsigned int IvyGetHiZLevelSize(unsigned int size, unsigned int level)
+#else
+unsigned int IvyGetHiZLevelSize(unsigned int size, unsigned int level)
+#endif  // __cplusplus
+{
+    return (size + (2u << level) - 1) >> (level + 1);
+}
+
+// Levels of the Hi-Z pyramid down to a single texel, at most IVY_MAX_HIZ_LEVELS
+#if __cplusplus
+inline unsigned int IvyGetHiZLevelCount(unsigned int width, unsigned int height)
+#else
+unsigned int IvyGetHiZLevelCount(unsigned int width, unsigned int height)
+#endif  // __cplusplus
+{
+    unsigned int levelCount = 1;
+    while ((levelCount < IVY_MAX_HIZ_LEVELS) && ((IvyGetHiZLevelSize(width, levelCount - 1) > 1) || (IvyGetHiZLevelSize(height, levelCount - 1) > 1)))
+    {
+        ++levelCount;
+    }
+    return levelCount;
+}
+
+#if __cplusplus
+// Constants of the instance sort post-pass, declared as cbuffer (b1) in shaders/ivyinstancesort.hlsl
+struct IvyInstanceSortCBData
+{
+    uint32_t BlockSize;      // bitonic block size k
+    uint32_t StepSize;       // bitonic compare distance j
+    uint32_t ArenaCapacity;  // instances per stream, offset of the stem keys & instances
+    uint32_t SortCapacity;   // power of two >= ArenaCapacity, sort entries per stream
+};
+
+// Constants of the instance partition passes, declared as cbuffer (b1) in shaders/ivyinstancepartitions.hlsl
+struct IvyInstancePartitionCBData
+{
+    uint32_t PartitionCount;  // IvyInstancePartition entries of the layout buffer
+    uint32_t LeafIndexCount;  // IndexCountPerInstance of the leaf & stem draws
+    uint32_t StemIndexCount;
+    uint32_t ArenaCapacity;   // WorkGraphCBData::InstanceCapacity
+};
+
+// Constants of the frustum & occlusion culling pass, declared as cbuffer (b1) in shaders/ivyinstanceculling.hlsl
+struct IvyInstanceCullingCBData
+{
+    Mat4     CullingViewProjection;                // projects the instance bounds onto the Hi-Z pyramid
+    float    FrustumPlanes[6][4];                  // left, right, bottom, top, near, far, see shaders/ivyinstanceculling.h
+    float    LeafBoundingSphere[4];                // local bounds of the leaf & stem meshes
+    float    StemBoundingSphere[4];
+    uint32_t CullingCapacity;                      // instances per stream of the culled buffers
+    uint32_t OcclusionCulling;                     // 1: test the instances within the frustum against the Hi-Z pyramid
+    uint32_t HiZWidth;                             // size of the depth buffer of the pyramid
+    uint32_t HiZHeight;
+    uint32_t HiZLevelCount;
+    uint32_t ClusterCapacity;                      // clusters per stream, offset of the stem clusters
+    uint32_t CullingStream;                        // stream of the instances culled by CullClusterInstances
+    uint32_t CullingPadding;
+    uint32_t HiZLevelOffsets[IVY_MAX_HIZ_LEVELS];  // first texel of each level in the pyramid buffer
+    float    LodScale;                             // pixels per world space unit at w = 1, see IvySelectMeshLod
+    float    LodPixelError;                        // accepted screen space error of a LOD in pixels
+    uint32_t LeafLodCount;                         // LODs of the leaf & stem meshes, 0: draw the generated arguments as LOD 0
+    uint32_t StemLodCount;
+    float    LeafLodErrors[IVY_MAX_MESH_LODS];     // object space error of each LOD
+    float    StemLodErrors[IVY_MAX_MESH_LODS];
+    uint32_t LeafLodDraws[IVY_MAX_MESH_LODS][4];   // index count, first index, base vertex & padding of each LOD
+    uint32_t StemLodDraws[IVY_MAX_MESH_LODS][4];
+    float    ImpostorDistance;                     // leaf clusters beyond this view depth are drawn as impostors, 0: never
+    uint32_t ImpostorPadding[3];
+};
+
+// Constants of the leaf impostor pass, declared as cbuffer (b0) in shaders/ivyleafimpostor_indirect.hlsl
+struct IvyLeafImpostorCBData
+{
+    Mat4     ImpostorViewProjection;
+    uint32_t AtlasTileSize;   // texels per side of a tile
+    uint32_t AtlasWidth;      // IVY_LEAF_IMPOSTOR_TILES * AtlasTileSize
+    float    AlphaThreshold;  // texels with lower coverage are discarded
+    uint32_t AtlasPadding;
+};
+
+// Constants of a Hi-Z pyramid level, declared as cbuffer (b1) in shaders/ivyhiz.hlsl
+struct IvyHiZCBData
+{
+    uint32_t HiZSourceOffset;  // first texel of the previous level, unused for level 0
+    uint32_t HiZSourceWidth;   // size of the previous level or of the depth buffer
+    uint32_t HiZSourceHeight;
+    uint32_t HiZDestinationOffset;
+    uint32_t HiZDestinationWidth;
+    uint32_t HiZDestinationHeight;
+    uint32_t HiZPadding[2];
+};
+#endif  // __cplusplus
@@ -0,0 +1,113 @@
+// This file is part of the AMD Work Graph Ivy Generation Sample.
+//
+// Copyright (c) 2024 Advanced Micro Devices, Inc. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+#pragma once
+
+// Occlusion test of the leaf & stem instances against the Hi-Z pyramid, shared between shaders/ivyinstanceculling.hlsl
+// and the CPU reference (cpu/ivycpuhiz.h). The pyramid holds the farthest depth of the scene (depth is not inverted),
+// see IvyGetHiZLevelSize in shaders/ivycommon.h for its layout.
+// The bounding sphere of an instance (see shaders/ivyinstanceculling.h) is projected with the corners of its bounding box.
+// The instance is occluded if the nearest depth of these corners is farther than the farthest depth of all pixels
+// covered by the projected rectangle, which is looked up in at most 2x2 texels of a single pyramid level.
+
+#ifndef IVY_SHARED_FUNCTION
+#if __cplusplus
+#define IVY_SHARED_FUNCTION inline
+#else
+#define IVY_SHARED_FUNCTION
+#endif  // __cplusplus
+#endif  // IVY_SHARED_FUNCTION
+
+struct IvyHiZFootprint
+{
+    unsigned int Testable;      // 0 if the bounds reach behind the camera, such instances are never occluded
+    unsigned int Level;         // pyramid level at which MinX..MaxX & MinY..MaxY cover at most 2x2 texels
+    unsigned int MinX;          // pixel rectangle of the depth buffer, clamped to the depth buffer
+    unsigned int MinY;
+    unsigned int MaxX;
+    unsigned int MaxY;
+    float        NearestDepth;  // nearest depth of the bounds
+};
+
+// Pixel of a normalized coordinate, clamped to the depth buffer
+IVY_SHARED_FUNCTION unsigned int IvyGetHiZPixel(float coordinate, unsigned int size)
+{
+    const float        clamped = (coordinate < 0.f) ? 0.f : ((coordinate > 1.f) ? 1.f : coordinate);
+    const unsigned int pixel   = (unsigned int)(clamped * size);
+    return (pixel < size) ? pixel : (size - 1);
+}
+
+IVY_SHARED_FUNCTION IvyHiZFootprint IvyGetHiZFootprint(float4x4 viewProjection, float4 sphere, unsigned int width, unsigned int height, unsigned int levelCount)
+{
+    IvyHiZFootprint footprint;
+    footprint.Testable     = 1;
+    footprint.Level        = 0;
+    footprint.MinX         = 0;
+    footprint.MinY         = 0;
+    footprint.MaxX         = 0;
+    footprint.MaxY         = 0;
+    footprint.NearestDepth = 1.f;
+
+    float minU = 1.f;
+    float minV = 1.f;
+    float maxU = 0.f;
+    float maxV = 0.f;
+    for (unsigned int corner = 0; corner < 8; ++corner)
+    {
+        const float4 position = float4(sphere.x + ((corner & 1) ? sphere.w : -sphere.w),
+                                       sphere.y + ((corner & 2) ? sphere.w : -sphere.w),
+                                       sphere.z + ((corner & 4) ? sphere.w : -sphere.w),
+                                       1.f);
+        const float4 clip     = mul(viewProjection, position);
+        if (clip.w <= 0.f)
+        {
+            footprint.Testable = 0;
+            return footprint;
+        }
+
+        // Clip space to texture coordinates, y points down
+        const float u     = clip.x / clip.w * 0.5f + 0.5f;
+        const float v     = 0.5f - clip.y / clip.w * 0.5f;
+        const float depth = clip.z / clip.w;
+
+        minU                   = (u < minU) ? u : minU;
+        minV                   = (v < minV) ? v : minV;
+        maxU                   = (u > maxU) ? u : maxU;
+        maxV                   = (v > maxV) ? v : maxV;
+        footprint.NearestDepth = (depth < footprint.NearestDepth) ? depth : footprint.NearestDepth;
+    }
+
+    // Pixels outside of the depth buffer are outside of the frustum, so only the clamped rectangle is tested
+    footprint.MinX = IvyGetHiZPixel(minU, width);
+    footprint.MinY = IvyGetHiZPixel(minV, height);
+    footprint.MaxX = IvyGetHiZPixel(maxU, width);
+    footprint.MaxY = IvyGetHiZPixel(maxV, height);
+
+    // Texel x of level n covers the pixels x << (n + 1) to ((x + 1) << (n + 1)) - 1
+    while ((footprint.Level + 1 < levelCount) &&
+           (((footprint.MaxX >> (footprint.Level + 1)) - (footprint.MinX >> (footprint.Level + 1)) > 1) ||
+            ((footprint.MaxY >> (footprint.Level + 1)) - (footprint.MinY >> (footprint.Level + 1)) > 1)))
+    {
+        ++footprint.Level;
+    }
+    return footprint;
+}
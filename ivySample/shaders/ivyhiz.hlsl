@@ -0,0 +1,79 @@
+// This file is part of the AMD Work Graph Ivy Generation Sample.
+//
+// Copyright (c) 2024 Advanced Micro Devices, Inc. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+// Hi-Z pyramid of the GBuffer depth for the occlusion culling of the ivy instances, see ivyhiz.h.
+// All levels are stored in a single buffer, level by level & row by row.
+//
+//  1. BuildHiZFromDepth:  level 0, farthest depth of 2x2 pixels of the depth buffer
+//  2. BuildHiZLevel:      level n + 1, farthest depth of 2x2 texels of level n
+// Texels at an odd edge of the source cover the last row or column only.
+
+#include "ivycommon.h"
+
+static const uint ivyHiZThreadGroupSize = 8;
+
+cbuffer IvyHiZCBData : register(b1)
+{
+    uint  HiZSourceOffset;
+    uint  HiZSourceWidth;
+    uint  HiZSourceHeight;
+    uint  HiZDestinationOffset;
+    uint  HiZDestinationWidth;
+    uint  HiZDestinationHeight;
+    uint2 HiZPadding;
+}
+
+Texture2D<float>          g_depthTexture : register(t0);
+RWStructuredBuffer<float> g_hiZBuffer : register(u0);
+
+[numthreads(ivyHiZThreadGroupSize, ivyHiZThreadGroupSize, 1)]
+void BuildHiZFromDepth(uint2 dtid : SV_DispatchThreadID)
+{
+    if ((dtid.x >= HiZDestinationWidth) || (dtid.y >= HiZDestinationHeight))
+    {
+        return;
+    }
+
+    const uint2 source0 = dtid * 2;
+    const uint2 source1 = min(source0 + 1, uint2(HiZSourceWidth, HiZSourceHeight) - 1);
+
+    const float depth = max(max(g_depthTexture.Load(int3(source0.x, source0.y, 0)), g_depthTexture.Load(int3(source1.x, source0.y, 0))),
+                            max(g_depthTexture.Load(int3(source0.x, source1.y, 0)), g_depthTexture.Load(int3(source1.x, source1.y, 0))));
+
+    g_hiZBuffer[HiZDestinationOffset + dtid.y * HiZDestinationWidth + dtid.x] = depth;
+}
+
+[numthreads(ivyHiZThreadGroupSize, ivyHiZThreadGroupSize, 1)]
+void BuildHiZLevel(uint2 dtid : SV_DispatchThreadID)
+{
+    if ((dtid.x >= HiZDestinationWidth) || (dtid.y >= HiZDestinationHeight))
+    {
+        return;
+    }
+
+    const uint2 source0 = dtid * 2;
+    const uint2 source1 = min(source0 + 1, uint2(HiZSourceWidth, HiZSourceHeight) - 1);
+
+    const float depth = max(max(g_hiZBuffer[HiZSourceOffset + source0.y * HiZSourceWidth + source0.x], g_hiZBuffer[HiZSourceOffset + source0.y * HiZSourceWidth + source1.x]),
+                            max(g_hiZBuffer[HiZSourceOffset + source1.y * HiZSourceWidth + source0.x], g_hiZBuffer[HiZSourceOffset + source1.y * HiZSourceWidth + source1.x]));
+
+    g_hiZBuffer[HiZDestinationOffset + dtid.y * HiZDestinationWidth + dtid.x] = depth;
+}
@@ -0,0 +1,97 @@
+// This file is part of the AMD Work Graph Ivy Generation Sample.
+//
+// Copyright (c) 2024 Advanced Micro Devices, Inc. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#pragma once
+
+// Frustum culling of the leaf & stem instances, shared between shaders/ivyinstanceculling.hlsl and the CPU reference
+// (via cpu/ivyinstanceculling.h). Each instance is tested with the bounding sphere of its mesh, transformed by the instance:
+//   localSphere  xyz = center of the mesh bounds, w = radius (half diagonal of the mesh bounds)
+//   plane        xyz = normalized inward normal, w = distance, a point p is inside if dot(plane.xyz, p) + plane.w >= 0
+// The sphere encloses the transformed mesh bounds, so an instance is only culled if it is entirely outside a plane.
+// Clusters of instances (see IvyInstanceCluster) are tested first with a sphere enclosing the spheres of their instances.
+// Visible instances select one of the simplified LODs of their mesh (see cpu/ivymeshsimplifier.h) by projected error.
+
+#ifndef IVY_SHARED_FUNCTION
+#if __cplusplus
+#define IVY_SHARED_FUNCTION inline
+#else
+#define IVY_SHARED_FUNCTION
+#endif  // __cplusplus
+#endif  // IVY_SHARED_FUNCTION
+
+// World space bounding sphere of an instance, the radius is scaled by the largest axis scale of the transform
+IVY_SHARED_FUNCTION float4 IvyGetInstanceBoundingSphere(float3x4 transform, float4 localSphere)
+{
+    const float4 localCenter = float4(localSphere.x, localSphere.y, localSphere.z, 1.f);
+    const float3 center      = float3(dot(transform[0], localCenter), dot(transform[1], localCenter), dot(transform[2], localCenter));
+
+    const float scaleX   = length(float3(transform[0].x, transform[1].x, transform[2].x));
+    const float scaleY   = length(float3(transform[0].y, transform[1].y, transform[2].y));
+    const float scaleZ   = length(float3(transform[0].z, transform[1].z, transform[2].z));
+    const float scaleXY  = (scaleX > scaleY) ? scaleX : scaleY;
+    const float maxScale = (scaleXY > scaleZ) ? scaleXY : scaleZ;
+
+    return float4(center.x, center.y, center.z, localSphere.w * maxScale);
+}
+
+IVY_SHARED_FUNCTION bool IvyIsSphereOutsidePlane(float4 plane, float4 sphere)
+{
+    return (plane.x * sphere.x + plane.y * sphere.y + plane.z * sphere.z + plane.w) < -sphere.w;
+}
+
+// Bounding sphere of a cluster, encloses the bounding spheres of its instances
+IVY_SHARED_FUNCTION float4 IvyGetClusterBoundingSphere(IvyInstanceCluster cluster)
+{
+    const float3 extent = float3(cluster.boundsMax[0] - cluster.boundsMin[0], cluster.boundsMax[1] - cluster.boundsMin[1], cluster.boundsMax[2] - cluster.boundsMin[2]);
+
+    return float4((cluster.boundsMin[0] + cluster.boundsMax[0]) * 0.5f,
+                  (cluster.boundsMin[1] + cluster.boundsMax[1]) * 0.5f,
+                  (cluster.boundsMin[2] + cluster.boundsMax[2]) * 0.5f,
+                  length(extent) * 0.5f);
+}
+
+// Coarsest LOD of a mesh whose simplification error stays below pixelError pixels on screen
+//   lodErrors        object space error of each LOD, non-decreasing, lodErrors[0] = 0
+//   sphere           world space bounding sphere of the instance, localRadius = radius of the mesh bounding sphere
+//   viewProjectionW  4th row of the view projection, gives w of a clip space position
+//   lodScale         pixels per world space unit at w = 1 (0.5 * render height * y scale of the projection)
+// The error is projected at the point of the sphere closest to the camera, instances reaching behind the camera use LOD 0.
+IVY_SHARED_FUNCTION unsigned int IvySelectMeshLod(float4       lodErrors,
+                                                  unsigned int lodCount,
+                                                  float4       sphere,
+                                                  float        localRadius,
+                                                  float4       viewProjectionW,
+                                                  float        lodScale,
+                                                  float        pixelError)
+{
+    const float w     = viewProjectionW.x * sphere.x + viewProjectionW.y * sphere.y + viewProjectionW.z * sphere.z + viewProjectionW.w - sphere.w;
+    const float scale = (localRadius > 0.f) ? sphere.w / localRadius : 1.f;
+
+    unsigned int lod = 0;
+    for (unsigned int i = 1; (i < lodCount) && (w > 0.f); ++i)
+    {
+        if (lodErrors[i] * scale * lodScale <= pixelError * w)
+        {
+            lod = i;
+        }
+    }
+    return lod;
+}
@@ -0,0 +1,456 @@
+// This file is part of the AMD Work Graph Ivy Generation Sample.
+//
+// Copyright (c) 2024 Advanced Micro Devices, Inc. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+// Frustum & occlusion culling pass between the instance generation and ExecuteIndirect.
+// Reads the draw arguments & instance buffers written by the partition compaction (or uploaded from a baked file)
+// and compacts the visible instances into the culled draw buffers, see ivyinstanceculling.h.
+// Consecutive runs of IVY_INSTANCE_CLUSTER_SIZE instances form clusters, only the instances of visible clusters are tested.
+// Each visible instance selects a LOD of its mesh (see IvySelectMeshLod), the culled buffers hold one draw per LOD
+// (g_culledArgumentBuffer[stream * IVY_MAX_MESH_LODS + lod]) and a single region of CullingCapacity instances per stream,
+// in which the instances of each LOD start at StartInstanceLocation of its draw.
+// Visible leaf clusters beyond ImpostorDistance are drawn as impostor quads (see ivyleafimpostor.h & ivyleafimpostor_indirect.hlsl)
+// instead of testing their instances.
+//
+//  1. BuildClusters:           bounds of each cluster and the impostor quads of the leaf clusters, only after the instance buffers changed
+//                              SV_GroupID: x = cluster, y = stream (0 = leaf, 1 = stem)
+//  2. ResetCulling:            copies the draw arguments with zero instances & the indices of each LOD,
+//                              and resets the cluster dispatch & impostor draw arguments
+//                              SV_DispatchThreadID = stream
+//  3. CullClusters:            tests each cluster against the frustum planes & optionally the Hi-Z pyramid (see ivyhiz.h),
+//                              and appends the visible ones to the dispatch arguments of CullClusterInstances or, for distant
+//                              leaf clusters, to the impostor draw arguments
+//                              SV_DispatchThreadID: x = cluster, y = stream
+//  4. CullClusterInstances:    same tests for each instance of a visible cluster, counts the visible ones per LOD with one
+//                              atomic per wave & LOD and stores the LOD & slot within the LOD of each instance
+//                              SV_GroupID = visible cluster, dispatched indirectly for each stream (CullingStream)
+//  5. ResolveLodRegions:       prefix sum of the instance counts of the LODs into their StartInstanceLocation
+//                              SV_DispatchThreadID = stream
+//  6. ScatterClusterInstances: copies the visible instances to StartInstanceLocation of their LOD + their slot
+//                              SV_GroupID = visible cluster, same indirect dispatch as CullClusterInstances
+
+#include "ivycommon.h"
+#include "ivyinstanceencoding.h"
+#include "ivyinstanceculling.h"
+#include "ivyhiz.h"
+#include "ivyleafimpostor.h"
+
+static const uint ivyCullingThreadGroupSize = 256;
+
+cbuffer IvyInstanceCullingCBData : register(b1)
+{
+    float4x4 CullingViewProjection;
+    float4   FrustumPlanes[6];    // left, right, bottom, top, near, far
+    float4   LeafBoundingSphere;  // local bounds of the leaf mesh
+    float4   StemBoundingSphere;  // local bounds of the stem mesh
+    uint     CullingCapacity;     // instances per stream of the culled buffers
+    uint     OcclusionCulling;    // 1: test against the Hi-Z pyramid in g_hiZBuffer
+    uint     HiZWidth;            // size of the depth buffer of the pyramid
+    uint     HiZHeight;
+    uint     HiZLevelCount;
+    uint     ClusterCapacity;     // clusters per stream, offset of the stem clusters
+    uint     CullingStream;       // stream of CullClusterInstances
+    uint     CullingPadding;
+    uint4    HiZLevelOffsets[IVY_MAX_HIZ_LEVELS / 4];
+    float    LodScale;            // pixels per world space unit at w = 1
+    float    LodPixelError;       // accepted screen space error of a LOD in pixels
+    uint     LeafLodCount;        // 0: the generated arguments are drawn as LOD 0
+    uint     StemLodCount;
+    float4   LeafLodErrors;       // object space error of each LOD
+    float4   StemLodErrors;
+    uint4    LeafLodDraws[IVY_MAX_MESH_LODS];  // index count, first index, base vertex
+    uint4    StemLodDraws[IVY_MAX_MESH_LODS];
+    float    ImpostorDistance;    // leaf clusters beyond this view depth are drawn as impostors, 0: never
+    uint3    ImpostorPadding;
+}
+
+StructuredBuffer<DrawIndexedArgs>       g_argumentBuffer : register(t0);
+StructuredBuffer<IvyEncodedInstance>    g_leafInstanceBuffer : register(t1);
+StructuredBuffer<IvyEncodedInstance>    g_stemInstanceBuffer : register(t2);
+StructuredBuffer<float>                 g_hiZBuffer : register(t3);
+RWStructuredBuffer<DrawIndexedArgs>     g_culledArgumentBuffer : register(u0);
+RWStructuredBuffer<IvyEncodedInstance>  g_culledLeafInstanceBuffer : register(u1);
+RWStructuredBuffer<IvyEncodedInstance>  g_culledStemInstanceBuffer : register(u2);
+RWStructuredBuffer<IvyInstanceCluster>  g_clusterBuffer : register(u3);
+RWStructuredBuffer<uint>                g_visibleClusterBuffer : register(u4);
+RWStructuredBuffer<DispatchArgs>        g_clusterDispatchBuffer : register(u5);
+RWStructuredBuffer<IvyLeafImpostorQuad> g_impostorQuadBuffer : register(u6);
+RWStructuredBuffer<uint>                g_impostorClusterBuffer : register(u7);
+RWStructuredBuffer<DrawArgs>            g_impostorArgumentBuffer : register(u8);
+RWStructuredBuffer<uint>                g_instanceLodSlotBuffer : register(u9);
+
+// Entry of g_instanceLodSlotBuffer for every instance of a visible cluster, LOD in the upper bits & slot within the LOD
+static const uint ivyInvisibleInstance = ~0u;
+static const uint ivyLodSlotShift      = 30;
+
+groupshared float3 clusterBoundsMin[IVY_INSTANCE_CLUSTER_SIZE];
+groupshared float3 clusterBoundsMax[IVY_INSTANCE_CLUSTER_SIZE];
+groupshared float3 impostorCenters[IVY_INSTANCE_CLUSTER_SIZE];
+groupshared float3 impostorNormals[IVY_INSTANCE_CLUSTER_SIZE];
+groupshared float3 impostorTangents[IVY_INSTANCE_CLUSTER_SIZE];
+
+uint GetInstanceCount(uint stream)
+{
+    return min(g_argumentBuffer[stream].InstanceCount, CullingCapacity);
+}
+
+IvyEncodedInstance LoadInstance(uint stream, uint index)
+{
+    return (stream == 0) ? g_leafInstanceBuffer[index] : g_stemInstanceBuffer[index];
+}
+
+float4 GetInstanceBoundingSphere(uint stream, IvyEncodedInstance instance)
+{
+    return IvyGetInstanceBoundingSphere(IvyDecodeInstance(instance), (stream == 0) ? LeafBoundingSphere : StemBoundingSphere);
+}
+
+uint GetLodCount(uint stream)
+{
+    return max((stream == 0) ? LeafLodCount : StemLodCount, 1);
+}
+
+uint SelectLod(uint stream, float4 sphere)
+{
+    return IvySelectMeshLod((stream == 0) ? LeafLodErrors : StemLodErrors,
+                            GetLodCount(stream),
+                            sphere,
+                            (stream == 0) ? LeafBoundingSphere.w : StemBoundingSphere.w,
+                            CullingViewProjection[3],
+                            LodScale,
+                            LodPixelError);
+}
+
+bool IsOccluded(float4 sphere)
+{
+    const IvyHiZFootprint footprint = IvyGetHiZFootprint(CullingViewProjection, sphere, HiZWidth, HiZHeight, HiZLevelCount);
+    if (!footprint.Testable)
+    {
+        return false;
+    }
+
+    const uint level       = footprint.Level;
+    const uint levelOffset = HiZLevelOffsets[level / 4][level % 4];
+    const uint levelWidth  = IvyGetHiZLevelSize(HiZWidth, level);
+
+    float farthestDepth = 0.f;
+    for (uint y = footprint.MinY >> (level + 1); y <= (footprint.MaxY >> (level + 1)); ++y)
+    {
+        for (uint x = footprint.MinX >> (level + 1); x <= (footprint.MaxX >> (level + 1)); ++x)
+        {
+            farthestDepth = max(farthestDepth, g_hiZBuffer[levelOffset + y * levelWidth + x]);
+        }
+    }
+    return footprint.NearestDepth > farthestDepth;
+}
+
+bool IsVisible(float4 sphere)
+{
+    bool visible = true;
+    for (uint plane = 0; plane < 6; ++plane)
+    {
+        visible = visible && !IvyIsSphereOutsidePlane(FrustumPlanes[plane], sphere);
+    }
+
+    if (visible && OcclusionCulling)
+    {
+        visible = !IsOccluded(sphere);
+    }
+    return visible;
+}
+
+// Impostor quad of each group of IVY_LEAF_IMPOSTOR_GROUP_SIZE lanes of a leaf cluster, see IvyBuildLeafImpostorQuads
+void BuildImpostorQuads(uint cluster, uint firstInstance, uint clusterInstanceCount, uint groupIndex, float3x4 transform, float4 sphere)
+{
+    const uint group      = groupIndex / IVY_LEAF_IMPOSTOR_GROUP_SIZE;
+    const uint lane       = groupIndex % IVY_LEAF_IMPOSTOR_GROUP_SIZE;
+    const uint groupFirst = group * IVY_LEAF_IMPOSTOR_GROUP_SIZE;
+    const uint groupCount = (clusterInstanceCount > groupFirst) ? min(clusterInstanceCount - groupFirst, IVY_LEAF_IMPOSTOR_GROUP_SIZE) : 0;
+    const bool leaf       = lane < groupCount;
+
+    // Lanes beyond the last instance add zero
+    impostorCenters[groupIndex]  = leaf ? sphere.xyz : float3(0.f, 0.f, 0.f);
+    impostorNormals[groupIndex]  = leaf ? IvyGetLeafImpostorAxis(transform, 1) : float3(0.f, 0.f, 0.f);
+    impostorTangents[groupIndex] = leaf ? IvyGetLeafImpostorAxis(transform, 0) : float3(0.f, 0.f, 0.f);
+    GroupMemoryBarrierWithGroupSync();
+
+    for (uint stride = IVY_LEAF_IMPOSTOR_GROUP_SIZE / 2; stride > 0; stride /= 2)
+    {
+        if (lane < stride)
+        {
+            impostorCenters[groupIndex]  = impostorCenters[groupIndex] + impostorCenters[groupIndex + stride];
+            impostorNormals[groupIndex]  = impostorNormals[groupIndex] + impostorNormals[groupIndex + stride];
+            impostorTangents[groupIndex] = impostorTangents[groupIndex] + impostorTangents[groupIndex + stride];
+        }
+        GroupMemoryBarrierWithGroupSync();
+    }
+
+    const float3 center = impostorCenters[groupFirst] / float(max(groupCount, 1));
+    const float3 normal = IvyGetLeafImpostorNormal(impostorNormals[groupFirst]);
+    const float3 axisU  = IvyGetLeafImpostorAxisU(normal, impostorTangents[groupFirst]);
+    GroupMemoryBarrierWithGroupSync();
+
+    // The extents reuse the storage of the center sums
+    impostorCenters[groupIndex] = leaf ? float3(IvyGetLeafImpostorExtent(sphere, center, axisU, cross(axisU, normal)), 0.f) : float3(0.f, 0.f, 0.f);
+    GroupMemoryBarrierWithGroupSync();
+
+    for (uint stride = IVY_LEAF_IMPOSTOR_GROUP_SIZE / 2; stride > 0; stride /= 2)
+    {
+        if (lane < stride)
+        {
+            impostorCenters[groupIndex] = max(impostorCenters[groupIndex], impostorCenters[groupIndex + stride]);
+        }
+        GroupMemoryBarrierWithGroupSync();
+    }
+
+    if (lane == 0)
+    {
+        g_impostorQuadBuffer[cluster * IVY_LEAF_IMPOSTOR_QUADS + group] =
+            IvyMakeLeafImpostorQuad(center, normal, axisU, impostorCenters[groupIndex].xy, firstInstance + groupFirst, groupCount);
+    }
+}
+
+[numthreads(IVY_INSTANCE_CLUSTER_SIZE, 1, 1)]
+void BuildClusters(uint2 groupId : SV_GroupID, uint groupIndex : SV_GroupIndex)
+{
+    const uint cluster       = groupId.x;
+    const uint stream        = groupId.y;
+    const uint firstInstance = cluster * IVY_INSTANCE_CLUSTER_SIZE;
+    const uint instanceCount = GetInstanceCount(stream);
+
+    // Uniform for the whole group
+    if (firstInstance >= instanceCount)
+    {
+        return;
+    }
+
+    // Lanes beyond the last instance repeat it, which does not change the bounds
+    const uint               clusterInstanceCount = min(instanceCount - firstInstance, IVY_INSTANCE_CLUSTER_SIZE);
+    const uint               index                = firstInstance + min(groupIndex, clusterInstanceCount - 1);
+    const IvyEncodedInstance instance             = LoadInstance(stream, index);
+    const float4             sphere               = GetInstanceBoundingSphere(stream, instance);
+
+    clusterBoundsMin[groupIndex] = sphere.xyz - sphere.w;
+    clusterBoundsMax[groupIndex] = sphere.xyz + sphere.w;
+    GroupMemoryBarrierWithGroupSync();
+
+    for (uint stride = IVY_INSTANCE_CLUSTER_SIZE / 2; stride > 0; stride /= 2)
+    {
+        if (groupIndex < stride)
+        {
+            clusterBoundsMin[groupIndex] = min(clusterBoundsMin[groupIndex], clusterBoundsMin[groupIndex + stride]);
+            clusterBoundsMax[groupIndex] = max(clusterBoundsMax[groupIndex], clusterBoundsMax[groupIndex + stride]);
+        }
+        GroupMemoryBarrierWithGroupSync();
+    }
+
+    if (groupIndex == 0)
+    {
+        IvyInstanceCluster result;
+        result.boundsMin     = clusterBoundsMin[0];
+        result.firstInstance = firstInstance;
+        result.boundsMax     = clusterBoundsMax[0];
+        result.instanceCount = clusterInstanceCount;
+
+        g_clusterBuffer[stream * ClusterCapacity + cluster] = result;
+    }
+
+    // Uniform for the whole group
+    if (stream == 0)
+    {
+        BuildImpostorQuads(cluster, firstInstance, clusterInstanceCount, groupIndex, IvyDecodeInstance(instance), sphere);
+    }
+}
+
+[numthreads(2, 1, 1)]
+void ResetCulling(uint stream : SV_DispatchThreadID)
+{
+    const uint lodCount = (stream == 0) ? LeafLodCount : StemLodCount;
+
+    // LODs beyond lodCount draw nothing
+    for (uint lod = 0; lod < IVY_MAX_MESH_LODS; ++lod)
+    {
+        DrawIndexedArgs args = g_argumentBuffer[stream];
+        args.InstanceCount   = 0;
+        if (lod < lodCount)
+        {
+            const uint4 draw = (stream == 0) ? LeafLodDraws[lod] : StemLodDraws[lod];
+
+            args.IndexCountPerInstance = draw.x;
+            args.StartIndexLocation    = draw.y;
+            args.BaseVertexLocation    = draw.z;
+        }
+        else if (lod > 0)
+        {
+            args.IndexCountPerInstance = 0;
+        }
+
+        g_culledArgumentBuffer[stream * IVY_MAX_MESH_LODS + lod] = args;
+    }
+
+    DispatchArgs dispatchArgs;
+    dispatchArgs.ThreadGroupCountX = 0;
+    dispatchArgs.ThreadGroupCountY = 1;
+    dispatchArgs.ThreadGroupCountZ = 1;
+
+    g_clusterDispatchBuffer[stream] = dispatchArgs;
+
+    // One instance per impostor cluster, drawing two triangles per quad
+    if (stream == 0)
+    {
+        DrawArgs impostorArgs;
+        impostorArgs.VertexCountPerInstance = 6 * IVY_LEAF_IMPOSTOR_QUADS;
+        impostorArgs.InstanceCount          = 0;
+        impostorArgs.StartVertexLocation    = 0;
+        impostorArgs.StartInstanceLocation  = 0;
+
+        g_impostorArgumentBuffer[0] = impostorArgs;
+    }
+}
+
+[numthreads(ivyCullingThreadGroupSize, 1, 1)]
+void CullClusters(uint2 dtid : SV_DispatchThreadID)
+{
+    const uint cluster = dtid.x;
+    const uint stream  = dtid.y;
+
+    const uint clusterCount = (GetInstanceCount(stream) + IVY_INSTANCE_CLUSTER_SIZE - 1) / IVY_INSTANCE_CLUSTER_SIZE;
+
+    float4 clusterSphere = float4(0.f, 0.f, 0.f, 0.f);
+    bool   visible       = false;
+    if (cluster < clusterCount)
+    {
+        clusterSphere = IvyGetClusterBoundingSphere(g_clusterBuffer[stream * ClusterCapacity + cluster]);
+        visible       = IsVisible(clusterSphere);
+    }
+
+    // Distant leaf clusters are drawn as impostors, their instances are not culled
+    const bool impostor      = visible && (stream == 0) && IvyUseLeafImpostors(clusterSphere, CullingViewProjection[3], ImpostorDistance);
+    const bool cullInstances = visible && !impostor;
+
+    // One atomic per wave, the thread group count of the stream is the number of visible clusters
+    const uint waveVisibleCount = WaveActiveCountBits(cullInstances);
+    uint       waveOffset       = 0;
+    if (WaveIsFirstLane() && (waveVisibleCount > 0))
+    {
+        InterlockedAdd(g_clusterDispatchBuffer[stream].ThreadGroupCountX, waveVisibleCount, waveOffset);
+    }
+    waveOffset = WaveReadLaneFirst(waveOffset);
+
+    if (cullInstances)
+    {
+        g_visibleClusterBuffer[stream * ClusterCapacity + waveOffset + WavePrefixCountBits(cullInstances)] = cluster;
+    }
+
+    // One atomic per wave, the instance count of the impostor draw is the number of impostor clusters
+    const uint waveImpostorCount = WaveActiveCountBits(impostor);
+    uint       impostorOffset    = 0;
+    if (WaveIsFirstLane() && (waveImpostorCount > 0))
+    {
+        InterlockedAdd(g_impostorArgumentBuffer[0].InstanceCount, waveImpostorCount, impostorOffset);
+    }
+    impostorOffset = WaveReadLaneFirst(impostorOffset);
+
+    if (impostor)
+    {
+        g_impostorClusterBuffer[impostorOffset + WavePrefixCountBits(impostor)] = cluster;
+    }
+}
+
+[numthreads(IVY_INSTANCE_CLUSTER_SIZE, 1, 1)]
+void CullClusterInstances(uint visibleCluster : SV_GroupID, uint groupIndex : SV_GroupIndex)
+{
+    const uint               stream  = CullingStream;
+    const IvyInstanceCluster cluster = g_clusterBuffer[stream * ClusterCapacity + g_visibleClusterBuffer[stream * ClusterCapacity + visibleCluster]];
+
+    bool visible     = false;
+    uint instanceLod = 0;
+    if (groupIndex < cluster.instanceCount)
+    {
+        const float4 sphere = GetInstanceBoundingSphere(stream, LoadInstance(stream, cluster.firstInstance + groupIndex));
+        visible             = IsVisible(sphere);
+        instanceLod         = visible ? SelectLod(stream, sphere) : 0;
+    }
+
+    // One atomic per wave & LOD, the visible lanes of a wave with the same LOD get consecutive slots
+    uint lodSlot = ivyInvisibleInstance;
+    for (uint lod = 0; lod < GetLodCount(stream); ++lod)
+    {
+        const bool write = visible && (instanceLod == lod);
+
+        const uint waveWriteCount = WaveActiveCountBits(write);
+        uint       waveOffset     = 0;
+        if (WaveIsFirstLane() && (waveWriteCount > 0))
+        {
+            InterlockedAdd(g_culledArgumentBuffer[stream * IVY_MAX_MESH_LODS + lod].InstanceCount, waveWriteCount, waveOffset);
+        }
+        waveOffset = WaveReadLaneFirst(waveOffset);
+
+        if (write)
+        {
+            lodSlot = (lod << ivyLodSlotShift) | (waveOffset + WavePrefixCountBits(write));
+        }
+    }
+
+    if (groupIndex < cluster.instanceCount)
+    {
+        g_instanceLodSlotBuffer[stream * CullingCapacity + cluster.firstInstance + groupIndex] = lodSlot;
+    }
+}
+
+// The visible instances of a stream are at most CullingCapacity, so the LODs share its region
+[numthreads(2, 1, 1)]
+void ResolveLodRegions(uint stream : SV_DispatchThreadID)
+{
+    uint startInstance = 0;
+    for (uint lod = 0; lod < IVY_MAX_MESH_LODS; ++lod)
+    {
+        g_culledArgumentBuffer[stream * IVY_MAX_MESH_LODS + lod].StartInstanceLocation = startInstance;
+        startInstance += g_culledArgumentBuffer[stream * IVY_MAX_MESH_LODS + lod].InstanceCount;
+    }
+}
+
+[numthreads(IVY_INSTANCE_CLUSTER_SIZE, 1, 1)]
+void ScatterClusterInstances(uint visibleCluster : SV_GroupID, uint groupIndex : SV_GroupIndex)
+{
+    const uint               stream  = CullingStream;
+    const IvyInstanceCluster cluster = g_clusterBuffer[stream * ClusterCapacity + g_visibleClusterBuffer[stream * ClusterCapacity + visibleCluster]];
+    if (groupIndex >= cluster.instanceCount)
+    {
+        return;
+    }
+
+    const uint instanceIndex = cluster.firstInstance + groupIndex;
+    const uint lodSlot       = g_instanceLodSlotBuffer[stream * CullingCapacity + instanceIndex];
+    if (lodSlot == ivyInvisibleInstance)
+    {
+        return;
+    }
+
+    const uint lod  = lodSlot >> ivyLodSlotShift;
+    const uint slot = g_culledArgumentBuffer[stream * IVY_MAX_MESH_LODS + lod].StartInstanceLocation + (lodSlot & ((1u << ivyLodSlotShift) - 1));
+    if (stream == 0)
+    {
+        g_culledLeafInstanceBuffer[slot] = g_leafInstanceBuffer[instanceIndex];
+    }
+    else
+    {
+        g_culledStemInstanceBuffer[slot] = g_stemInstanceBuffer[instanceIndex];
+    }
+}
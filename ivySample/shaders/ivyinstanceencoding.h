@@ -0,0 +1,262 @@
+// This file is part of the AMD Work Graph Ivy Generation Sample.
+//
+// Copyright (c) 2024 Advanced Micro Devices, Inc. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+#pragma once
+
+// Encode & decode of the leaf & stem instances, shared between the shaders and the CPU engine (via cpu/ivyinstanceencoding.h).
+// IVY_INSTANCE_ENCODING (shaders/ivycommon.h) selects the encoding of the instance buffers.
+//
+// IvyInstanceData3x4 stores the rows of the affine transform and is lossless.
+// IvyInstanceDataQuantized stores a transform of the form translation * rotation * scale(x, yz, yz) in 16 bytes,
+// which covers all ivy stems (scaled along their local x axis) & leaves:
+//   data[0], data[1]  position, 21 bit fixed point per axis in [-IVY_INSTANCE_POSITION_RANGE; IVY_INSTANCE_POSITION_RANGE]
+//   data[2]           rotation, unit quaternion as "smallest three": index of the largest component & 3 * 10 bits
+//   data[3]           scale, half precision: local x axis (low 16 bits), local y & z axes (high 16 bits)
+// The precision bounds of the quantized encoding are listed in cpu/ivyinstanceencoding.h and checked by IvyEncodingBenchmark.
+
+#if __cplusplus
+#include <cmath>
+#endif  // __cplusplus
+
+#ifndef IVY_SHARED_FUNCTION
+#if __cplusplus
+#define IVY_SHARED_FUNCTION inline
+#else
+#define IVY_SHARED_FUNCTION
+#endif  // __cplusplus
+#endif  // IVY_SHARED_FUNCTION
+
+static const unsigned int ivyPositionQuantizationMax   = (1u << 21) - 1;
+static const unsigned int ivyQuaternionQuantizationMax = (1u << 10) - 1;
+
+IVY_SHARED_FUNCTION float IvyAbs(float value)
+{
+    return (value < 0.f) ? -value : value;
+}
+
+// Maps [0; 1] to [0; maxValue], rounds to nearest
+IVY_SHARED_FUNCTION unsigned int IvyQuantizeUnorm(float value, unsigned int maxValue)
+{
+    value = (value < 0.f) ? 0.f : ((value > 1.f) ? 1.f : value);
+    return (unsigned int)(floor(value * float(maxValue) + 0.5f));
+}
+
+IVY_SHARED_FUNCTION float IvyDequantizeUnorm(unsigned int value, unsigned int maxValue)
+{
+    return float(value) / float(maxValue);
+}
+
+// ========================
+// IvyInstanceData3x4
+
+IVY_SHARED_FUNCTION IvyInstanceData3x4 IvyEncodeInstance3x4(float3x4 transform)
+{
+    IvyInstanceData3x4 instance;
+    for (int row = 0; row < 3; ++row)
+    {
+        for (int column = 0; column < 4; ++column)
+        {
+            instance.rows[row][column] = transform[row][column];
+        }
+    }
+    return instance;
+}
+
+IVY_SHARED_FUNCTION float3x4 IvyDecodeInstance3x4(IvyInstanceData3x4 instance)
+{
+    float3x4 transform;
+    for (int row = 0; row < 3; ++row)
+    {
+        for (int column = 0; column < 4; ++column)
+        {
+            transform[row][column] = instance.rows[row][column];
+        }
+    }
+    return transform;
+}
+
+// ========================
+// IvyInstanceDataQuantized
+
+IVY_SHARED_FUNCTION unsigned int IvyPackQuaternion(float4 quaternion)
+{
+    // the largest component is reconstructed from the other three, which are in [-1/sqrt(2); 1/sqrt(2)]
+    unsigned int largest = 0;
+    for (unsigned int i = 1; i < 4; ++i)
+    {
+        if (IvyAbs(quaternion[i]) > IvyAbs(quaternion[largest]))
+        {
+            largest = i;
+        }
+    }
+
+    // q & -q are the same rotation, make the largest component positive
+    const float sign = (quaternion[largest] < 0.f) ? -1.f : 1.f;
+
+    unsigned int packed = largest << 30;
+    unsigned int shift  = 20;
+    for (unsigned int j = 0; j < 4; ++j)
+    {
+        if (j != largest)
+        {
+            packed |= IvyQuantizeUnorm(quaternion[j] * sign * 0.70710678f + 0.5f, ivyQuaternionQuantizationMax) << shift;
+            shift -= 10;
+        }
+    }
+    return packed;
+}
+
+IVY_SHARED_FUNCTION float4 IvyUnpackQuaternion(unsigned int packed)
+{
+    const unsigned int largest = packed >> 30;
+
+    float4       quaternion = float4(0, 0, 0, 0);
+    float        sum        = 0.f;
+    unsigned int shift      = 20;
+    for (unsigned int i = 0; i < 4; ++i)
+    {
+        if (i != largest)
+        {
+            const float value = (IvyDequantizeUnorm((packed >> shift) & ivyQuaternionQuantizationMax, ivyQuaternionQuantizationMax) - 0.5f) * 1.41421356f;
+
+            quaternion[i] = value;
+            sum += value * value;
+            shift -= 10;
+        }
+    }
+    quaternion[largest] = sqrt((sum < 1.f) ? (1.f - sum) : 0.f);
+    return quaternion;
+}
+
+// Unit quaternion (x, y, z, w) of the rotation with columns x, y & z
+IVY_SHARED_FUNCTION float4 IvyRotationToQuaternion(float3 x, float3 y, float3 z)
+{
+    const float trace = x.x + y.y + z.z;
+
+    float4 quaternion;
+    if (trace > 0.f)
+    {
+        const float s = sqrt(trace + 1.f) * 2.f;
+        quaternion    = float4((y.z - z.y) / s, (z.x - x.z) / s, (x.y - y.x) / s, 0.25f * s);
+    }
+    else if ((x.x > y.y) && (x.x > z.z))
+    {
+        const float s = sqrt(1.f + x.x - y.y - z.z) * 2.f;
+        quaternion    = float4(0.25f * s, (y.x + x.y) / s, (z.x + x.z) / s, (y.z - z.y) / s);
+    }
+    else if (y.y > z.z)
+    {
+        const float s = sqrt(1.f + y.y - x.x - z.z) * 2.f;
+        quaternion    = float4((y.x + x.y) / s, 0.25f * s, (z.y + y.z) / s, (z.x - x.z) / s);
+    }
+    else
+    {
+        const float s = sqrt(1.f + z.z - x.x - y.y) * 2.f;
+        quaternion    = float4((z.x + x.z) / s, (z.y + y.z) / s, 0.25f * s, (x.y - y.x) / s);
+    }
+
+    const float norm = sqrt(dot(quaternion, quaternion));
+    return float4(quaternion.x / norm, quaternion.y / norm, quaternion.z / norm, quaternion.w / norm);
+}
+
+IVY_SHARED_FUNCTION IvyInstanceDataQuantized IvyEncodeInstanceQuantized(float3x4 transform)
+{
+    const float3 column0     = float3(transform[0][0], transform[1][0], transform[2][0]);
+    const float3 column1     = float3(transform[0][1], transform[1][1], transform[2][1]);
+    const float3 column2     = float3(transform[0][2], transform[1][2], transform[2][2]);
+    const float3 translation = float3(transform[0][3], transform[1][3], transform[2][3]);
+
+    // the x scale of stems can be zero, the rotation is derived from the y & z axes only
+    const float  scaleX  = length(column0);
+    const float  scaleYZ = 0.5f * (length(column1) + length(column2));
+    const float3 axisY   = normalize(column1);
+    const float3 axisZ   = normalize(column2);
+    const float3 axisX   = cross(axisY, axisZ);
+
+    unsigned int position[3];
+    for (int axis = 0; axis < 3; ++axis)
+    {
+        position[axis] = IvyQuantizeUnorm(translation[axis] / IVY_INSTANCE_POSITION_RANGE * 0.5f + 0.5f, ivyPositionQuantizationMax);
+    }
+
+    IvyInstanceDataQuantized instance;
+    instance.data[0] = position[0] | (position[1] << 21);
+    instance.data[1] = (position[1] >> 11) | (position[2] << 10);
+    instance.data[2] = IvyPackQuaternion(IvyRotationToQuaternion(axisX, axisY, axisZ));
+    instance.data[3] = f32tof16(scaleX) | (f32tof16(scaleYZ) << 16);
+    return instance;
+}
+
+IVY_SHARED_FUNCTION float3x4 IvyDecodeInstanceQuantized(IvyInstanceDataQuantized instance)
+{
+    const unsigned int positionX = instance.data[0] & ivyPositionQuantizationMax;
+    const unsigned int positionY = (instance.data[0] >> 21) | ((instance.data[1] << 11) & ivyPositionQuantizationMax);
+    const unsigned int positionZ = (instance.data[1] >> 10) & ivyPositionQuantizationMax;
+
+    const float4 q       = IvyUnpackQuaternion(instance.data[2]);
+    const float  scaleX  = f16tof32(instance.data[3] & 0xffffu);
+    const float  scaleYZ = f16tof32(instance.data[3] >> 16);
+
+    float3x4 transform;
+    transform[0][0] = (1.f - 2.f * (q.y * q.y + q.z * q.z)) * scaleX;
+    transform[1][0] = (2.f * (q.x * q.y + q.w * q.z)) * scaleX;
+    transform[2][0] = (2.f * (q.x * q.z - q.w * q.y)) * scaleX;
+    transform[0][1] = (2.f * (q.x * q.y - q.w * q.z)) * scaleYZ;
+    transform[1][1] = (1.f - 2.f * (q.x * q.x + q.z * q.z)) * scaleYZ;
+    transform[2][1] = (2.f * (q.y * q.z + q.w * q.x)) * scaleYZ;
+    transform[0][2] = (2.f * (q.x * q.z + q.w * q.y)) * scaleYZ;
+    transform[1][2] = (2.f * (q.y * q.z - q.w * q.x)) * scaleYZ;
+    transform[2][2] = (1.f - 2.f * (q.x * q.x + q.y * q.y)) * scaleYZ;
+    transform[0][3] = (IvyDequantizeUnorm(positionX, ivyPositionQuantizationMax) * 2.f - 1.f) * IVY_INSTANCE_POSITION_RANGE;
+    transform[1][3] = (IvyDequantizeUnorm(positionY, ivyPositionQuantizationMax) * 2.f - 1.f) * IVY_INSTANCE_POSITION_RANGE;
+    transform[2][3] = (IvyDequantizeUnorm(positionZ, ivyPositionQuantizationMax) * 2.f - 1.f) * IVY_INSTANCE_POSITION_RANGE;
+    return transform;
+}
+
+#if !__cplusplus
+// ========================
+// Encoding of the instance buffers, selected by IVY_INSTANCE_ENCODING
+
+IvyEncodedInstance IvyEncodeInstance(float3x4 transform)
+{
+#if IVY_INSTANCE_ENCODING == IVY_INSTANCE_ENCODING_FLOAT4X4
+    IvyInstanceData instance;
+    instance.transform = float4x4(transform[0], transform[1], transform[2], float4(0, 0, 0, 1));
+    return instance;
+#elif IVY_INSTANCE_ENCODING == IVY_INSTANCE_ENCODING_FLOAT3X4
+    return IvyEncodeInstance3x4(transform);
+#else
+    return IvyEncodeInstanceQuantized(transform);
+#endif  // IVY_INSTANCE_ENCODING
+}
+
+float3x4 IvyDecodeInstance(IvyEncodedInstance instance)
+{
+#if IVY_INSTANCE_ENCODING == IVY_INSTANCE_ENCODING_FLOAT4X4
+    return (float3x4)instance.transform;
+#elif IVY_INSTANCE_ENCODING == IVY_INSTANCE_ENCODING_FLOAT3X4
+    return IvyDecodeInstance3x4(instance);
+#else
+    return IvyDecodeInstanceQuantized(instance);
+#endif  // IVY_INSTANCE_ENCODING
+}
+#endif  // !__cplusplus
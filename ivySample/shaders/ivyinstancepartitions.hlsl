@@ -0,0 +1,122 @@
+// This file is part of the AMD Work Graph Ivy Generation Sample.
+//
+// Copyright (c) 2024 Advanced Micro Devices, Inc. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+// Instance buffer partitions for the incremental regeneration of single entry records.
+// Each IvyBranch & IvyArea entry record owns a range of leaf & stem instances in the partition buffers, given by
+// g_partitionBuffer (see cpu/ivyinstancearena.h), and a counter pair in g_partitionCounterBuffer, see ivy.hlsl.
+// Only the partitions of changed records are regenerated, the draw buffers are then rebuilt from all partitions.
+//
+//  1. ResetPartitions:   counters of the regenerated partitions = 0, before the work graph dispatch
+//  2. CompactPartitions: copies the instances & keys of all partitions to the draw buffers and writes the draw arguments
+//                        SV_DispatchThreadID: x = instance in partition, y = partition, z = stream (0 = leaf, 1 = stem)
+//                        The counters are read back as IvyInstanceArenaStatus to lay out the partitions
+
+#include "ivycommon.h"
+
+static const uint ivyResetThreadGroupSize      = 64;
+static const uint ivyCompactionThreadGroupSize = 256;
+
+cbuffer IvyInstancePartitionCBData : register(b1)
+{
+    uint PartitionCount;
+    uint LeafIndexCount;
+    uint StemIndexCount;
+    uint ArenaCapacity;  // InstanceCapacity of the work graph dispatch
+}
+
+RWStructuredBuffer<DrawIndexedArgs>    g_argumentBuffer : register(u0);
+RWStructuredBuffer<IvyEncodedInstance> g_leafInstanceBuffer : register(u1);
+RWStructuredBuffer<IvyEncodedInstance> g_stemInstanceBuffer : register(u2);
+RWStructuredBuffer<IvyInstanceKey>     g_instanceKeyBuffer : register(u3);  // leaf keys, stem keys at ArenaCapacity
+RWStructuredBuffer<uint2>              g_partitionCounterBuffer : register(u4);
+RWStructuredBuffer<IvyEncodedInstance> g_leafPartitionBuffer : register(u5);
+RWStructuredBuffer<IvyEncodedInstance> g_stemPartitionBuffer : register(u6);
+RWStructuredBuffer<IvyInstanceKey>     g_partitionKeyBuffer : register(u7);  // same layout as g_instanceKeyBuffer
+StructuredBuffer<IvyInstancePartition> g_partitionBuffer : register(t0);     // layout of the work graph dispatch
+
+uint GetPartitionOffset(uint partition, uint stream)
+{
+    return (stream == 0) ? g_partitionBuffer[partition].offset.x : g_partitionBuffer[partition].offset.y;
+}
+
+// Stored instances of a partition, the counters include dropped instances
+uint GetPartitionInstanceCount(uint partition, uint stream)
+{
+    const uint2 counter  = g_partitionCounterBuffer[partition];
+    const uint2 capacity = g_partitionBuffer[partition].capacity;
+    return (stream == 0) ? min(counter.x, capacity.x) : min(counter.y, capacity.y);
+}
+
+[numthreads(ivyResetThreadGroupSize, 1, 1)]
+void ResetPartitions(uint partition : SV_DispatchThreadID)
+{
+    if ((partition < PartitionCount) && (g_partitionBuffer[partition].regenerate != 0))
+    {
+        g_partitionCounterBuffer[partition] = uint2(0, 0);
+    }
+}
+
+[numthreads(ivyCompactionThreadGroupSize, 1, 1)]
+void CompactPartitions(uint3 dtid : SV_DispatchThreadID)
+{
+    const uint index     = dtid.x;
+    const uint partition = dtid.y;
+    const uint stream    = dtid.z;
+
+    // Partitions are packed in order, each thread sums the counters of the preceding partitions
+    uint startIndex = 0;
+    for (uint i = 0; i < partition; ++i)
+    {
+        startIndex += GetPartitionInstanceCount(i, stream);
+    }
+
+    if ((partition == PartitionCount - 1) && (index == 0))
+    {
+        DrawIndexedArgs args;
+        args.IndexCountPerInstance = (stream == 0) ? LeafIndexCount : StemIndexCount;
+        args.InstanceCount         = startIndex + GetPartitionInstanceCount(partition, stream);
+        args.StartIndexLocation    = 0;
+        args.BaseVertexLocation    = 0;
+        args.StartInstanceLocation = 0;
+
+        g_argumentBuffer[stream] = args;
+    }
+
+    if (index >= GetPartitionInstanceCount(partition, stream))
+    {
+        return;
+    }
+
+    const uint sourceIndex      = GetPartitionOffset(partition, stream) + index;
+    const uint destinationIndex = startIndex + index;
+
+    if (stream == 0)
+    {
+        g_leafInstanceBuffer[destinationIndex] = g_leafPartitionBuffer[sourceIndex];
+    }
+    else
+    {
+        g_stemInstanceBuffer[destinationIndex] = g_stemPartitionBuffer[sourceIndex];
+    }
+
+    g_instanceKeyBuffer[stream * ArenaCapacity + destinationIndex] = g_partitionKeyBuffer[stream * ArenaCapacity + sourceIndex];
+}
@@ -0,0 +1,162 @@
+// This file is part of the AMD Work Graph Ivy Generation Sample.
+//
+// Copyright (c) 2024 Advanced Micro Devices, Inc. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+// Instance sort post-pass for the deterministic instance order.
+// IvyBranch appends leaf & stem instances with InterlockedAdd, so their order depends on the scheduling of the
+// work graph. These kernels sort both instance buffers by the IvyInstanceKey written alongside each instance.
+// SV_GroupID.y selects the stream: 0 = leaf, 1 = stem.
+//
+//  1. InitSortEntries:  entry i = (key, i) for all i < InstanceCount
+//  2. BitonicSortStep:  one compare & exchange pass per (BlockSize, StepSize), see IvyInstanceSort::Execute
+//  3. GatherInstances:  scratch[i] = instances[entry[i].index]
+//  4. CopyInstances:    instances[i] = scratch[i]
+
+#include "ivycommon.h"
+
+static const uint ivySortThreadGroupSize = 256;
+
+cbuffer IvyInstanceSortCBData : register(b1)
+{
+    uint BlockSize;
+    uint StepSize;
+    uint ArenaCapacity;  // instances per stream, offset of the stem keys & scratch instances
+    uint SortCapacity;   // power of two >= ArenaCapacity, sort entries per stream
+}
+
+RWStructuredBuffer<DrawIndexedArgs>    g_argumentBuffer : register(u0);
+RWStructuredBuffer<IvyEncodedInstance> g_leafInstanceBuffer : register(u1);
+RWStructuredBuffer<IvyEncodedInstance> g_stemInstanceBuffer : register(u2);
+RWStructuredBuffer<IvyInstanceKey>     g_instanceKeyBuffer : register(u3);  // leaf keys, stem keys at ArenaCapacity
+RWStructuredBuffer<uint4>              g_sortEntryBuffer : register(u4);    // (seed, iterationSlot, instance index, 0) per entry
+RWStructuredBuffer<IvyEncodedInstance> g_scratchInstanceBuffer : register(u5);
+
+uint GetInstanceCount(uint stream)
+{
+    return min(g_argumentBuffer[stream].InstanceCount, ArenaCapacity);
+}
+
+bool EntryLess(uint4 a, uint4 b)
+{
+    if (a.x != b.x)
+    {
+        return a.x < b.x;
+    }
+    if (a.y != b.y)
+    {
+        return a.y < b.y;
+    }
+    // Equal keys only occur for IvyBranch records with equal seeds, which are not ordered deterministically
+    return a.z < b.z;
+}
+
+[numthreads(ivySortThreadGroupSize, 1, 1)]
+void InitSortEntries(uint3 dtid : SV_DispatchThreadID)
+{
+    const uint stream = dtid.y;
+    const uint index  = dtid.x;
+
+    if (index >= GetInstanceCount(stream))
+    {
+        return;
+    }
+
+    const IvyInstanceKey key = g_instanceKeyBuffer[stream * ArenaCapacity + index];
+
+    g_sortEntryBuffer[stream * SortCapacity + index] = uint4(key.seed, key.iterationSlot, index, 0);
+}
+
+// Bitonic sort with a "flip" as first step of each block, such that every compare & exchange moves the smaller
+// entry to the lower index. Entries >= InstanceCount are treated as larger than all others and are never touched.
+[numthreads(ivySortThreadGroupSize, 1, 1)]
+void BitonicSortStep(uint3 dtid : SV_DispatchThreadID)
+{
+    const uint stream = dtid.y;
+    const uint pair   = dtid.x;
+
+    uint a, b;
+    if (StepSize == BlockSize / 2)
+    {
+        const uint offset = pair % StepSize;
+        a                 = (pair / StepSize) * BlockSize + offset;
+        b                 = a - offset + BlockSize - 1 - offset;
+    }
+    else
+    {
+        const uint low = pair & (StepSize - 1);
+        a              = ((pair - low) << 1) + low;
+        b              = a + StepSize;
+    }
+
+    if (b >= GetInstanceCount(stream))
+    {
+        return;
+    }
+
+    const uint  base   = stream * SortCapacity;
+    const uint4 entryA = g_sortEntryBuffer[base + a];
+    const uint4 entryB = g_sortEntryBuffer[base + b];
+
+    if (EntryLess(entryB, entryA))
+    {
+        g_sortEntryBuffer[base + a] = entryB;
+        g_sortEntryBuffer[base + b] = entryA;
+    }
+}
+
+[numthreads(ivySortThreadGroupSize, 1, 1)]
+void GatherInstances(uint3 dtid : SV_DispatchThreadID)
+{
+    const uint stream = dtid.y;
+    const uint index  = dtid.x;
+
+    if (index >= GetInstanceCount(stream))
+    {
+        return;
+    }
+
+    const uint sourceIndex = g_sortEntryBuffer[stream * SortCapacity + index].z;
+
+    g_scratchInstanceBuffer[stream * ArenaCapacity + index] = (stream == 0) ? g_leafInstanceBuffer[sourceIndex] : g_stemInstanceBuffer[sourceIndex];
+}
+
+[numthreads(ivySortThreadGroupSize, 1, 1)]
+void CopyInstances(uint3 dtid : SV_DispatchThreadID)
+{
+    const uint stream = dtid.y;
+    const uint index  = dtid.x;
+
+    if (index >= GetInstanceCount(stream))
+    {
+        return;
+    }
+
+    const IvyEncodedInstance instance = g_scratchInstanceBuffer[stream * ArenaCapacity + index];
+
+    if (stream == 0)
+    {
+        g_leafInstanceBuffer[index] = instance;
+    }
+    else
+    {
+        g_stemInstanceBuffer[index] = instance;
+    }
+}
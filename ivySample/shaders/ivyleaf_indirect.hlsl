@@ -2,14 +2,21 @@
 // This file is part of the AMD Work Graph Ivy Generation Sample.
 
 #include "ivycommon.h"
+#include "ivyinstanceencoding.h"
 
 // Instance data buffer array - support for both leaf and stem instance buffers
-StructuredBuffer<IvyInstanceData> g_instance_data[2] : register(t0);  // t0: leaf, t1: stem
+// Instances are stored with the encoding selected by IVY_INSTANCE_ENCODING
+StructuredBuffer<IvyEncodedInstance> g_instance_data[2] : register(t0);  // t0: leaf, t1: stem
+
+// Drawn arguments, SV_InstanceID does not include their StartInstanceLocation
+StructuredBuffer<DrawIndexedArgs> g_draw_arguments : register(t2);
 
 // Buffer index constant to select which buffer to use
 cbuffer BufferSelection : register(b1)
 {
     uint instance_buffer_index;  // 0 = leaf buffer (t0), 1 = stem buffer (t1)
+    uint argument_index;         // drawn arguments in g_draw_arguments
+    uint read_instance_offset;   // 1: the instances of the draw start at its StartInstanceLocation, see IvyInstanceCulling
 };
 
 // Vertex input
@@ -33,11 +40,12 @@ PSInput VSMain(VSInput input)
     PSInput output;
     
     // Get instance transform from the selected structured buffer using descriptor array
-    float4x4 instanceTransform = g_instance_data[instance_buffer_index][input.InstanceID].transform;
+    const uint instanceOffset = read_instance_offset ? g_draw_arguments[argument_index].StartInstanceLocation : 0;
+    float3x4 instanceTransform = IvyDecodeInstance(g_instance_data[instance_buffer_index][instanceOffset + input.InstanceID]);
     
     // Apply instance transform to vertex position
     float4 localPosition = float4(input.Position, 1.0f);
-    float4 worldSpacePosition = mul(instanceTransform, localPosition);
+    float4 worldSpacePosition = float4(mul(instanceTransform, localPosition), 1.0f);
     
     output.Position = mul(ViewProjection, worldSpacePosition);
     
@@ -0,0 +1,123 @@
+// This file is part of the AMD Work Graph Ivy Generation Sample.
+//
+// Copyright (c) 2024 Advanced Micro Devices, Inc. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+#pragma once
+
+// Leaf impostors, shared between shaders/ivyinstanceculling.hlsl and the CPU reference (via cpu/ivyleafimpostors.h).
+// Each group of IVY_LEAF_IMPOSTOR_GROUP_SIZE leaf instances of a cluster gets an oriented quad (IvyLeafImpostorQuad):
+//   normal  normalized sum of the leaf normals (y axis of the leaf mesh, which lies in its xz plane)
+//   axisU   sum of the leaf x axes projected onto the quad plane, axisV = cross(axisU, normal)
+//   extent  largest distance of a leaf bounding sphere center from the quad center along each axis, plus its radius
+// The quads of a cluster replace its leaf instances beyond the impostor distance and are textured with a tile of the
+// baked impostor atlas (see cpu/ivyleafimpostoratlas.h), whose leaves are placed in the same frame.
+
+#ifndef IVY_SHARED_FUNCTION
+#if __cplusplus
+#define IVY_SHARED_FUNCTION inline
+#else
+#define IVY_SHARED_FUNCTION
+#endif  // __cplusplus
+#endif  // IVY_SHARED_FUNCTION
+
+// Normalized column of the rotation & scale part of a transform, 0: x axis, 1: y axis (leaf normal)
+IVY_SHARED_FUNCTION float3 IvyGetLeafImpostorAxis(float3x4 transform, unsigned int column)
+{
+    const float3 axis       = float3(transform[0][column], transform[1][column], transform[2][column]);
+    const float  axisLength = length(axis);
+    return (axisLength > 0.f) ? axis / axisLength : float3(0.f, 0.f, 0.f);
+}
+
+IVY_SHARED_FUNCTION float3 IvyGetLeafImpostorNormal(float3 normalSum)
+{
+    const float normalLength = length(normalSum);
+    return (normalLength > 1e-6f) ? normalSum / normalLength : float3(0.f, 1.f, 0.f);
+}
+
+// Falls back to an arbitrary axis perpendicular to the normal if the x axes of the leaves cancel out
+IVY_SHARED_FUNCTION float3 IvyGetLeafImpostorAxisU(float3 normal, float3 tangentSum)
+{
+    const float3 tangent       = tangentSum - normal * dot(normal, tangentSum);
+    const float  tangentLength = length(tangent);
+    if (tangentLength > 1e-6f)
+    {
+        return tangent / tangentLength;
+    }
+
+    const float3 reference = (normal.x * normal.x < 0.81f) ? float3(1.f, 0.f, 0.f) : float3(0.f, 0.f, 1.f);
+    return normalize(cross(normal, reference));
+}
+
+// Half extent along axisU & axisV that covers the bounding sphere of a leaf
+IVY_SHARED_FUNCTION float2 IvyGetLeafImpostorExtent(float4 sphere, float3 center, float3 axisU, float3 axisV)
+{
+    const float3 offset = float3(sphere.x - center.x, sphere.y - center.y, sphere.z - center.z);
+    const float  u      = dot(offset, axisU);
+    const float  v      = dot(offset, axisV);
+    return float2(((u < 0.f) ? -u : u) + sphere.w, ((v < 0.f) ? -v : v) + sphere.w);
+}
+
+// Neighbouring groups use different tiles of the atlas
+IVY_SHARED_FUNCTION unsigned int IvyGetLeafImpostorTile(unsigned int firstInstance)
+{
+    return (firstInstance / IVY_LEAF_IMPOSTOR_GROUP_SIZE) % IVY_LEAF_IMPOSTOR_TILES;
+}
+
+IVY_SHARED_FUNCTION IvyLeafImpostorQuad IvyMakeLeafImpostorQuad(float3       center,
+                                                                float3       normal,
+                                                                float3       axisU,
+                                                                float2       extent,
+                                                                unsigned int firstInstance,
+                                                                unsigned int instanceCount)
+{
+    const float3 u = axisU * extent.x;
+    const float3 v = cross(axisU, normal) * extent.y;
+
+    IvyLeafImpostorQuad quad;
+#if __cplusplus
+    quad.center[0] = center.x;
+    quad.center[1] = center.y;
+    quad.center[2] = center.z;
+    quad.axisU[0]  = u.x;
+    quad.axisU[1]  = u.y;
+    quad.axisU[2]  = u.z;
+    quad.axisV[0]  = v.x;
+    quad.axisV[1]  = v.y;
+    quad.axisV[2]  = v.z;
+#else
+    quad.center = center;
+    quad.axisU  = u;
+    quad.axisV  = v;
+#endif  // __cplusplus
+    quad.tile          = IvyGetLeafImpostorTile(firstInstance);
+    quad.instanceCount = instanceCount;
+    quad.padding       = 0;
+    return quad;
+}
+
+// Visible leaf clusters whose bounding sphere lies entirely beyond impostorDistance (view depth w of its nearest point)
+// are drawn as impostors, 0 disables the impostors
+IVY_SHARED_FUNCTION bool IvyUseLeafImpostors(float4 clusterSphere, float4 viewProjectionW, float impostorDistance)
+{
+    const float w = viewProjectionW.x * clusterSphere.x + viewProjectionW.y * clusterSphere.y + viewProjectionW.z * clusterSphere.z + viewProjectionW.w -
+                    clusterSphere.w;
+    return (impostorDistance > 0.f) && (w > impostorDistance);
+}
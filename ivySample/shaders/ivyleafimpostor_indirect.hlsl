@@ -0,0 +1,89 @@
+// This file is part of the AMD Work Graph Ivy Generation Sample.
+//
+// Copyright (c) 2024 Advanced Micro Devices, Inc. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+// Draws the leaf clusters that IvyInstanceCulling classified as impostors (see ivyleafimpostor.h), see ivyleafimpostors.h.
+// One instance per impostor cluster (g_impostorClusterBuffer), six vertices per impostor quad of the cluster.
+// The pixel shader textures the quads with the baked atlas (see cpu/ivyleafimpostoratlas.h), whose texels hold the normal in the
+// quad frame & the coverage, and writes the world space normal like ivyleaf_indirect.hlsl.
+
+#include "ivycommon.h"
+
+cbuffer IvyLeafImpostorCBData : register(b0)
+{
+    float4x4 ImpostorViewProjection;
+    uint     AtlasTileSize;   // texels per side of a tile
+    uint     AtlasWidth;      // IVY_LEAF_IMPOSTOR_TILES * AtlasTileSize
+    float    AlphaThreshold;  // texels with lower coverage are discarded
+    uint     AtlasPadding;
+};
+
+StructuredBuffer<IvyLeafImpostorQuad> g_impostorQuadBuffer    : register(t0);  // IVY_LEAF_IMPOSTOR_QUADS quads per leaf cluster
+StructuredBuffer<uint>                g_impostorClusterBuffer : register(t1);  // leaf clusters drawn as impostors
+StructuredBuffer<uint>                g_impostorAtlasBuffer   : register(t2);  // R8G8B8A8_UNORM texels, row 0 at -axisV
+
+struct PSInput
+{
+    float4                 Position : SV_POSITION;
+    float2                 UV       : TEXCOORD0;
+    nointerpolation uint   Tile     : TILE;
+    nointerpolation float3 AxisU    : AXISU;
+    nointerpolation float3 AxisV    : AXISV;
+};
+
+// Two triangles per quad, front facing for both windings as the pipeline does not cull
+static const float2 ivyImpostorCorners[6] = {float2(0.f, 0.f), float2(1.f, 0.f), float2(1.f, 1.f), float2(0.f, 0.f), float2(1.f, 1.f), float2(0.f, 1.f)};
+
+PSInput VSMain(uint vertexId : SV_VertexID, uint instanceId : SV_InstanceID)
+{
+    const uint                cluster = g_impostorClusterBuffer[instanceId];
+    const IvyLeafImpostorQuad quad    = g_impostorQuadBuffer[cluster * IVY_LEAF_IMPOSTOR_QUADS + vertexId / 6];
+    const float2              corner  = ivyImpostorCorners[vertexId % 6];
+
+    const float3 position = quad.center + (corner.x * 2.f - 1.f) * quad.axisU + (corner.y * 2.f - 1.f) * quad.axisV;
+
+    PSInput output;
+    // Unused quads of partially filled clusters are degenerate
+    output.Position = (quad.instanceCount > 0) ? mul(ImpostorViewProjection, float4(position, 1.f)) : float4(0.f, 0.f, 0.f, 0.f);
+    output.UV       = corner;
+    output.Tile     = quad.tile;
+    output.AxisU    = quad.axisU;
+    output.AxisV    = quad.axisV;
+    return output;
+}
+
+float4 PSMain(PSInput input) : SV_TARGET
+{
+    const uint2 texel = min(uint2(input.UV * AtlasTileSize), AtlasTileSize - 1);
+    const uint  value = g_impostorAtlasBuffer[texel.y * AtlasWidth + input.Tile * AtlasTileSize + texel.x];
+
+    const float4 atlas = float4(value & 0xff, (value >> 8) & 0xff, (value >> 16) & 0xff, value >> 24) / 255.f;
+    clip(atlas.a - AlphaThreshold);
+
+    // Quad frame (axisU, axisV, normal) with normal = cross(axisV, axisU), see IvyMakeLeafImpostorQuad
+    const float3 axisU  = normalize(input.AxisU);
+    const float3 axisV  = normalize(input.AxisV);
+    const float3 normal = cross(axisV, axisU);
+
+    const float3 quadNormal  = atlas.xyz * 2.f - 1.f;
+    const float3 worldNormal = normalize(quadNormal.x * axisU + quadNormal.y * axisV + quadNormal.z * normal);
+
+    return float4(worldNormal * 0.5f + 0.5f, 1.f);
+}
@@ -0,0 +1,191 @@
+// This file is part of the AMD Work Graph Ivy Generation Sample.
+//
+// Copyright (c) 2024 Advanced Micro Devices, Inc. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+#pragma once
+
+// Hash, CombineSeed & Random shared between the shaders (via utils.hlsl) and the CPU engine (via cpu/ivyutils.h).
+// Every branch, leaf offset and rotation of the ivy is derived from these functions, so both versions must produce
+// bit-identical results:
+// - only 32 bit unsigned integer arithmetic, which wraps identically in HLSL and C++
+// - operator precedence is made explicit, HLSL and C++ agree on it but the original code relied on it implicitly
+// - Random() converts to float with round to nearest and scales by 2^-32 (float(~0u) rounds to 2^32),
+//   which is exact, so hardware division precision does not matter
+
+#if __cplusplus
+#include <cstring>
+#define IVY_SHARED_FUNCTION inline
+#else
+#define IVY_SHARED_FUNCTION
+#endif  // __cplusplus
+
+IVY_SHARED_FUNCTION unsigned int Hash(unsigned int seed)
+{
+    seed = (seed ^ 61u) ^ (seed >> 16u);
+    seed *= 9u;
+    seed = seed ^ (seed >> 4u);
+    seed *= 0x27d4eb2du;
+    seed = seed ^ (seed >> 15u);
+    return seed;
+}
+
+IVY_SHARED_FUNCTION unsigned int CombineSeed(unsigned int a, unsigned int b)
+{
+    // xor is applied last
+    return a ^ (Hash(b) + 0x9e3779b9u + (a << 6u) + (a >> 2u));
+}
+
+IVY_SHARED_FUNCTION unsigned int CombineSeed(unsigned int a, unsigned int b, unsigned int c)
+{
+    return CombineSeed(CombineSeed(a, b), c);
+}
+
+IVY_SHARED_FUNCTION unsigned int CombineSeed(unsigned int a, unsigned int b, unsigned int c, unsigned int d)
+{
+    return CombineSeed(CombineSeed(a, b), c, d);
+}
+
+IVY_SHARED_FUNCTION unsigned int Hash(float seed)
+{
+#if __cplusplus
+    unsigned int bits;
+    memcpy(&bits, &seed, sizeof(bits));
+    return Hash(bits);
+#else
+    return Hash(asuint(seed));
+#endif  // __cplusplus
+}
+
+IVY_SHARED_FUNCTION float Random(unsigned int seed)
+{
+    return float(Hash(seed)) / float(~0u);
+}
+
+IVY_SHARED_FUNCTION float Random(unsigned int a, unsigned int b)
+{
+    return Random(CombineSeed(a, b));
+}
+
+IVY_SHARED_FUNCTION float Random(unsigned int a, unsigned int b, unsigned int c)
+{
+    return Random(CombineSeed(a, b), c);
+}
+
+IVY_SHARED_FUNCTION float Random(unsigned int a, unsigned int b, unsigned int c, unsigned int d)
+{
+    return Random(CombineSeed(a, b), c, d);
+}
+
+IVY_SHARED_FUNCTION float Random(unsigned int a, unsigned int b, unsigned int c, unsigned int d, unsigned int e)
+{
+    return Random(CombineSeed(a, b), c, d, e);
+}
+
+#if __cplusplus
+// ========================
+// Batch versions for the CPU engine, bit-identical to the scalar functions above.
+// Eight seeds are hashed at once with AVX2 if available.
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+
+inline __m256i Hash8(__m256i seed)
+{
+    seed = _mm256_xor_si256(_mm256_xor_si256(seed, _mm256_set1_epi32(61)), _mm256_srli_epi32(seed, 16));
+    seed = _mm256_mullo_epi32(seed, _mm256_set1_epi32(9));
+    seed = _mm256_xor_si256(seed, _mm256_srli_epi32(seed, 4));
+    seed = _mm256_mullo_epi32(seed, _mm256_set1_epi32(0x27d4eb2d));
+    seed = _mm256_xor_si256(seed, _mm256_srli_epi32(seed, 15));
+    return seed;
+}
+
+// CombineSeed(a[i], b) with Hash(b) precomputed
+inline __m256i CombineSeed8(__m256i a, unsigned int hashB)
+{
+    const __m256i sum = _mm256_add_epi32(_mm256_add_epi32(_mm256_set1_epi32(static_cast<int>(hashB + 0x9e3779b9u)), _mm256_slli_epi32(a, 6)),
+                                         _mm256_srli_epi32(a, 2));
+    return _mm256_xor_si256(a, sum);
+}
+
+// CombineSeed(a, b[i])
+inline __m256i CombineSeed8(unsigned int a, __m256i b)
+{
+    return _mm256_xor_si256(_mm256_set1_epi32(static_cast<int>(a)),
+                            _mm256_add_epi32(Hash8(b), _mm256_set1_epi32(static_cast<int>(0x9e3779b9u + (a << 6u) + (a >> 2u)))));
+}
+
+// Random(seed[i]): AVX2 only converts signed integers, so the upper and lower 16 bits are converted separately.
+// Both halves are exact in float, the sum is rounded once, which equals the rounding of the direct conversion.
+inline __m256 Random8(__m256i seed)
+{
+    const __m256i hash = Hash8(seed);
+    const __m256  hi   = _mm256_cvtepi32_ps(_mm256_srli_epi32(hash, 16));
+    const __m256  lo   = _mm256_cvtepi32_ps(_mm256_and_si256(hash, _mm256_set1_epi32(0xffff)));
+    const __m256  f    = _mm256_add_ps(_mm256_mul_ps(hi, _mm256_set1_ps(65536.f)), lo);
+    return _mm256_div_ps(f, _mm256_set1_ps(float(~0u)));
+}
+#endif  // __AVX2__
+
+/**
+ * @brief   result[i] = Random(a, b, c[i]) for i in [0, count).
+ */
+inline void RandomBatch(unsigned int a, unsigned int b, const unsigned int* c, unsigned int count, float* result)
+{
+    const unsigned int ab = CombineSeed(a, b);
+
+    unsigned int i = 0;
+#if defined(__AVX2__)
+    for (; i + 8 <= count; i += 8)
+    {
+        const __m256i ci = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(c + i));
+        _mm256_storeu_ps(result + i, Random8(CombineSeed8(ab, ci)));
+    }
+#endif  // __AVX2__
+    for (; i < count; ++i)
+    {
+        result[i] = Random(ab, c[i]);
+    }
+}
+
+/**
+ * @brief   result[lane] = Random(a, b, lane, d) for lane in [0, laneCount), e.g. the per lane randoms of a wave.
+ */
+inline void RandomLaneBatch(unsigned int a, unsigned int b, unsigned int d, unsigned int laneCount, float* result)
+{
+    const unsigned int ab = CombineSeed(a, b);
+
+    unsigned int lane = 0;
+#if defined(__AVX2__)
+    const unsigned int hashD = Hash(d);
+    for (; lane + 8 <= laneCount; lane += 8)
+    {
+        const __m256i lanes = _mm256_add_epi32(_mm256_set1_epi32(static_cast<int>(lane)), _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7));
+        _mm256_storeu_ps(result + lane, Random8(CombineSeed8(CombineSeed8(ab, lanes), hashD)));
+    }
+#endif  // __AVX2__
+    for (; lane < laneCount; ++lane)
+    {
+        result[lane] = Random(ab, lane, d);
+    }
+}
+#endif  // __cplusplus
+
+#undef IVY_SHARED_FUNCTION
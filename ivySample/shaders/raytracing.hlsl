@@ -23,12 +23,21 @@
 
 RaytracingAccelerationStructure Tlas : register(t0);
 
-// UAV binding for argument buffer (u0) - shared between work graph nodes
-globallycoherent RWStructuredBuffer<DrawIndexedArgs> g_argumentBuffer : register(u0);
+// UAV binding for the instance counters (u0): leaf & stem instances per partition, i.e. per entry record
+// The draw arguments are written by the partition compaction, see ivyinstancepartitions.hlsl
+globallycoherent RWStructuredBuffer<uint2> g_partitionCounterBuffer : register(u0);
 
-// UAV bindings for instance buffers - allow work graph to write transforms
-globallycoherent RWStructuredBuffer<IvyInstanceData> g_leafInstanceBuffer : register(u1);
-globallycoherent RWStructuredBuffer<IvyInstanceData> g_stemInstanceBuffer : register(u2);
+// SRV binding for the layout of the partitions (t1), indexed by the partition of the records
+StructuredBuffer<IvyInstancePartition> g_partitionBuffer : register(t1);
+
+// UAV bindings for the partitioned instance buffers - allow work graph to write transforms
+// Partition i starts at g_partitionBuffer[i].offset, see cpu/ivyinstancearena.h
+// Instances are stored with the encoding selected by IVY_INSTANCE_ENCODING, see ivyinstanceencoding.h
+globallycoherent RWStructuredBuffer<IvyEncodedInstance> g_leafInstanceBuffer : register(u1);
+globallycoherent RWStructuredBuffer<IvyEncodedInstance> g_stemInstanceBuffer : register(u2);
+
+// UAV binding for the instance sort keys (u3): leaf keys first, stem keys at offset InstanceCapacity
+RWStructuredBuffer<IvyInstanceKey> g_instanceKeyBuffer : register(u3);
 
 StructuredBuffer<Material_Info> g_material_info : DECLARE_SRV(RAYTRACING_INFO_MATERIAL);
 StructuredBuffer<Instance_Info> g_instance_info : DECLARE_SRV(RAYTRACING_INFO_INSTANCE);
@@ -39,35 +39,8 @@ int BitSign(in uint data, in int bitIndex)
 // ========================
 // Randon & Noise functions
 
-uint Hash(uint seed)
-{
-    seed = (seed ^ 61u) ^ (seed >> 16u);
-    seed *= 9u;
-    seed = seed ^ (seed >> 4u);
-    seed *= 0x27d4eb2du;
-    seed = seed ^ (seed >> 15u);
-    return seed;
-}
-
-uint CombineSeed(uint a, uint b)
-{
-    return a ^ Hash(b) + 0x9e3779b9 + (a << 6) + (a >> 2);
-}
-
-uint CombineSeed(uint a, uint b, uint c)
-{
-    return CombineSeed(CombineSeed(a, b), c);
-}
-
-uint CombineSeed(uint a, uint b, uint c, uint d)
-{
-    return CombineSeed(CombineSeed(a, b), c, d);
-}
-
-uint Hash(in float seed)
-{
-    return Hash(asuint(seed));
-}
+// Hash(uint), Hash(float), CombineSeed & Random are shared with the CPU engine
+#include "ivyrandom.h"
 
 uint Hash(in float3 vec)
 {
@@ -84,31 +57,6 @@ uint Hash(in float4x4 mat)
     return CombineSeed(Hash(mat[0]), Hash(mat[1]), Hash(mat[2]), Hash(mat[3]));
 }
 
-float Random(uint seed)
-{
-    return Hash(seed) / float(~0u);
-}
-
-float Random(uint a, uint b)
-{
-    return Random(CombineSeed(a, b));
-}
-
-float Random(uint a, uint b, uint c)
-{
-    return Random(CombineSeed(a, b), c);
-}
-
-float Random(uint a, uint b, uint c, uint d)
-{
-    return Random(CombineSeed(a, b), c, d);
-}
-
-float Random(uint a, uint b, uint c, uint d, uint e)
-{
-    return Random(CombineSeed(a, b), c, d, e);
-}
-
 // ========================
 // Matrix Utils
 
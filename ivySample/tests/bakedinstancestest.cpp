@@ -0,0 +1,206 @@
+// This file is part of the AMD Work Graph Ivy Generation Sample.
+//
+// Copyright (c) 2024 Advanced Micro Devices, Inc. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+// Writes the instances of the default entry records as baked & chunked instance file into the directory given as
+// argument, reads them back and checks that corrupted files are rejected.
+
+#include "testutils.h"
+
+#include "cpu/ivybakedinstances.h"
+#include "cpu/ivyinstancechunks.h"
+#include "cpu/ivyinstanceencoding.h"
+
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+// Small chunks, so that every stream is split into several chunks
+static const uint32_t testChunkCapacity = 256;
+
+static std::vector<char> ReadFile(const std::string& path)
+{
+    std::ifstream file(path, std::ios::binary);
+    return std::vector<char>(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+}
+
+static bool WriteFile(const std::string& path, const std::vector<char>& data)
+{
+    std::ofstream file(path, std::ios::binary);
+    file.write(data.data(), data.size());
+    return file.good();
+}
+
+static void CheckBakedFile(const std::string& path, const IvyBakedInstances& baked)
+{
+    std::string error;
+    if (!Check(IvyBakedInstanceFile::Write(path, baked, &error), "write %s: %s", path.c_str(), error.c_str()))
+    {
+        return;
+    }
+
+    IvyBakedInstanceFile file;
+    if (!Check(file.Open(path, &error), "open %s: %s", path.c_str(), error.c_str()))
+    {
+        return;
+    }
+
+    const IvyBakedInstanceHeader& header = file.GetHeader();
+    Check((header.BranchRecordCount == baked.BranchRecords.size()) && (header.AreaRecordCount == baked.AreaRecords.size()), "baked entry record counts");
+    Check((std::memcmp(file.GetBranchRecords(), baked.BranchRecords.data(), baked.BranchRecords.size() * sizeof(IvyBakedEntryRecord)) == 0) &&
+              (std::memcmp(file.GetAreaRecords(), baked.AreaRecords.data(), baked.AreaRecords.size() * sizeof(IvyBakedEntryRecord)) == 0),
+          "baked entry records");
+    Check((header.LeafInstanceCount == baked.LeafInstances.size()) &&
+              (std::memcmp(file.GetLeafInstances(), baked.LeafInstances.data(), baked.LeafInstances.size() * sizeof(IvyEncodedInstance)) == 0),
+          "baked leaf instances");
+    Check((header.StemInstanceCount == baked.StemInstances.size()) &&
+              (std::memcmp(file.GetStemInstances(), baked.StemInstances.data(), baked.StemInstances.size() * sizeof(IvyEncodedInstance)) == 0),
+          "baked stem instances");
+    Check((header.Arguments[0].IndexCountPerInstance == baked.Arguments[0].IndexCountPerInstance) &&
+              (header.Arguments[1].IndexCountPerInstance == baked.Arguments[1].IndexCountPerInstance),
+          "baked draw arguments");
+
+    // The entry records convert back to the records they were baked for
+    const IvyBakedEntryRecord branchRecord = ToBakedEntryRecord(ToIvyBranchRecord(baked.BranchRecords[0]));
+    const IvyBakedEntryRecord areaRecord   = ToBakedEntryRecord(ToIvyAreaRecord(baked.AreaRecords[0]));
+    Check(std::memcmp(&branchRecord, &baked.BranchRecords[0], sizeof(IvyBakedEntryRecord)) == 0, "IvyBranchRecord conversion");
+    Check(std::memcmp(&areaRecord, &baked.AreaRecords[0], sizeof(IvyBakedEntryRecord)) == 0, "IvyAreaRecord conversion");
+    file.Close();
+
+    std::vector<char> data = ReadFile(path);
+    Check(IvyBakedInstanceFile::Validate(data.data(), data.size()), "the written file is valid");
+
+    data.back() ^= 1;
+    Check(!IvyBakedInstanceFile::Validate(data.data(), data.size()), "a corrupted instance is rejected");
+    data.back() ^= 1;
+
+    Check(!IvyBakedInstanceFile::Validate(data.data(), data.size() - sizeof(IvyEncodedInstance)), "a truncated file is rejected");
+}
+
+static void CheckChunkedFile(const std::string& path, const IvyChunkedInstances& instances)
+{
+    IvyInstanceChunkSettings settings;
+    settings.ChunkCapacity = testChunkCapacity;
+
+    std::string error;
+    if (!Check(IvyChunkedInstanceFile::Write(path, instances, settings, &error), "write %s: %s", path.c_str(), error.c_str()))
+    {
+        return;
+    }
+
+    IvyChunkedInstanceFile file;
+    if (!Check(file.Open(path, &error), "open %s: %s", path.c_str(), error.c_str()))
+    {
+        return;
+    }
+
+    const IvyChunkedInstanceHeader& header = file.GetHeader();
+    Check((header.InstanceCount[0] == instances.Instances[0].size()) && (header.InstanceCount[1] == instances.Instances[1].size()), "chunked instance counts");
+    Check(header.ChunkCount > 2, "every stream is split into chunks of %u instances", testChunkCapacity);
+
+    uint64_t loadedInstances[2] = {};
+    for (uint32_t i = 0; i < header.ChunkCount; ++i)
+    {
+        const IvyInstanceChunk& chunk = file.GetChunks()[i];
+
+        std::vector<IvyInstanceData> chunkInstances;
+        Check(file.LoadChunk(i, chunkInstances, &error), "load chunk %u: %s", i, error.c_str());
+        Check((chunk.InstanceCount <= testChunkCapacity) && (chunkInstances.size() == chunk.InstanceCount), "instances of chunk %u", i);
+        loadedInstances[chunk.Stream] += chunkInstances.size();
+    }
+    Check((loadedInstances[0] == header.InstanceCount[0]) && (loadedInstances[1] == header.InstanceCount[1]), "the chunks hold all instances");
+
+    // Payloads are only validated when their chunk is loaded
+    const IvyInstanceChunk lastChunk = file.GetChunks()[header.ChunkCount - 1];
+    file.Close();
+
+    std::vector<char> data = ReadFile(path);
+    data[lastChunk.Offset] ^= 1;
+
+    const std::string corruptedPath = path + ".corrupted";
+    if (!Check(WriteFile(corruptedPath, data), "write %s", corruptedPath.c_str()) ||
+        !Check(file.Open(corruptedPath, &error), "a corrupted payload does not fail Open(): %s", error.c_str()))
+    {
+        return;
+    }
+
+    std::vector<IvyInstanceData> chunkInstances;
+    Check(file.LoadChunk(0, chunkInstances), "an intact chunk of a corrupted file loads");
+    Check(!file.LoadChunk(header.ChunkCount - 1, chunkInstances), "a corrupted chunk is rejected");
+}
+
+int main(int argc, char** argv)
+{
+    if (argc != 2)
+    {
+        fprintf(stderr, "Usage: IvyBakedInstancesTest <output directory>\n");
+        return 1;
+    }
+    const std::string outputDirectory = argv[1];
+
+    // Baked in the deterministic order, like IvyBake
+    IvyCpuScene        scene;
+    IvyInstanceStreams output;
+    if (!GenerateTestIvy(scene, output, true))
+    {
+        return 1;
+    }
+
+    std::vector<IvyBranchRecord> branchRecords;
+    std::vector<IvyAreaRecord>   areaRecords;
+    GetDefaultRecords(branchRecords, areaRecords);
+
+    IvyBakedInstances baked;
+    for (const IvyBranchRecord& record : branchRecords)
+    {
+        baked.BranchRecords.push_back(ToBakedEntryRecord(record));
+    }
+    for (const IvyAreaRecord& record : areaRecords)
+    {
+        baked.AreaRecords.push_back(ToBakedEntryRecord(record));
+    }
+    for (const IvyInstanceData& instance : output.LeafInstances)
+    {
+        baked.LeafInstances.push_back(IvyEncodeInstance(instance));
+    }
+    for (const IvyInstanceData& instance : output.StemInstances)
+    {
+        baked.StemInstances.push_back(IvyEncodeInstance(instance));
+    }
+    baked.Arguments[0] = output.Arguments[0];
+    baked.Arguments[1] = output.Arguments[1];
+
+    CheckBakedFile(outputDirectory + "/ivytest.ivyb", baked);
+
+    IvyChunkedInstances chunked;
+    chunked.BranchRecords            = baked.BranchRecords;
+    chunked.AreaRecords              = baked.AreaRecords;
+    chunked.Instances[0]             = output.LeafInstances;
+    chunked.Instances[1]             = output.StemInstances;
+    chunked.IndexCountPerInstance[0] = output.Arguments[0].IndexCountPerInstance;
+    chunked.IndexCountPerInstance[1] = output.Arguments[1].IndexCountPerInstance;
+
+    CheckChunkedFile(outputDirectory + "/ivytest.ivyc", chunked);
+
+    return GetTestExitCode("IvyBakedInstancesTest");
+}
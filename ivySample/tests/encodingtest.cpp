@@ -0,0 +1,90 @@
+// This file is part of the AMD Work Graph Ivy Generation Sample.
+//
+// Copyright (c) 2024 Advanced Micro Devices, Inc. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+// Checks that float4x4 & float3x4 encode the instances losslessly and that the quantized encoding stays within
+// the error bounds of cpu/ivyinstanceencoding.h, for the generated ivy instances & random transforms.
+
+#include "testutils.h"
+
+#include "benchmark/encodingerror.h"
+
+#include <vector>
+
+static const uint32_t randomTransformCount = 100000;
+
+template <typename EncodedInstance, typename Encode, typename Decode>
+static EncodingError GetEncodingError(const std::vector<float3x4>& transforms, Encode encode, Decode decode)
+{
+    EncodingError error;
+    for (const float3x4& transform : transforms)
+    {
+        const EncodedInstance encoded = encode(transform);
+        AccumulateError(transform, decode(encoded), error);
+    }
+    return error;
+}
+
+static void CheckEncodings(const char* name, const std::vector<float3x4>& transforms)
+{
+    const EncodingError float4x4Error = GetEncodingError<IvyInstanceData>(
+        transforms,
+        [](const float3x4& transform) { return IvyInstanceData{Affine::ToMat4(transform)}; },
+        [](const IvyInstanceData& instance) { return float3x4(ToFloat4x4(instance.transform)); });
+    Check((float4x4Error.Element == 0.0) && (float4x4Error.OutOfRange == 0), "%s: float4x4 is lossless (max element error %g)", name, float4x4Error.Element);
+
+    const EncodingError float3x4Error = GetEncodingError<IvyInstanceData3x4>(transforms, IvyEncodeInstance3x4, IvyDecodeInstance3x4);
+    Check((float3x4Error.Element == 0.0) && (float3x4Error.OutOfRange == 0), "%s: float3x4 is lossless (max element error %g)", name, float3x4Error.Element);
+
+    const EncodingError quantizedError = GetEncodingError<IvyInstanceDataQuantized>(transforms, IvyEncodeInstanceQuantized, IvyDecodeInstanceQuantized);
+    Check(quantizedError.Position <= ivyQuantizedPositionErrorBound, "%s: quantized position error %g <= %g", name, quantizedError.Position, ivyQuantizedPositionErrorBound);
+    Check(quantizedError.Rotation <= ivyQuantizedRotationErrorBound, "%s: quantized rotation error %g <= %g", name, quantizedError.Rotation, ivyQuantizedRotationErrorBound);
+    Check(quantizedError.Scale <= ivyQuantizedScaleErrorBound, "%s: quantized scale error %g <= %g", name, quantizedError.Scale, ivyQuantizedScaleErrorBound);
+}
+
+int main()
+{
+    IvyCpuScene        scene;
+    IvyInstanceStreams output;
+    if (!GenerateTestIvy(scene, output))
+    {
+        return 1;
+    }
+
+    std::vector<float3x4> ivyTransforms;
+    for (const std::vector<IvyInstanceData>* instances : {&output.LeafInstances, &output.StemInstances})
+    {
+        for (const IvyInstanceData& instance : *instances)
+        {
+            ivyTransforms.push_back(float3x4(ToFloat4x4(instance.transform)));
+        }
+    }
+    CheckEncodings("ivy", ivyTransforms);
+
+    std::vector<float3x4> randomTransforms(randomTransformCount);
+    for (uint32_t i = 0; i < randomTransformCount; ++i)
+    {
+        randomTransforms[i] = RandomTransform(i);
+    }
+    CheckEncodings("random", randomTransforms);
+
+    return GetTestExitCode("IvyEncodingTest");
+}
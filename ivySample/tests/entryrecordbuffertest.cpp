@@ -0,0 +1,173 @@
+// This file is part of the AMD Work Graph Ivy Generation Sample.
+//
+// Copyright (c) 2024 Advanced Micro Devices, Inc. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+// Checks that a single multi node input dispatches the records of the selected slots & that only changed slots are uploaded.
+
+#include "testutils.h"
+
+#include "cpu/ivyentryrecordbuffer.h"
+
+#include <cstring>
+#include <vector>
+
+// Arbitrary, the inputs hold absolute addresses
+static const uint64_t testGpuAddress       = 0x10000;
+static const uint32_t testBranchEntrypoint = 3;
+static const uint32_t testAreaEntrypoint   = 5;
+
+// Follows the multi node input to the records, like DispatchGraph with D3D12_DISPATCH_MODE_MULTI_NODE_GPU_INPUT.
+// Every slot of slots has to be dispatched in order, with its record & the slot as partition.
+static void CheckDispatch(const IvyEntryRecordBuffer&         buffer,
+                          const std::vector<IvyBranchRecord>& branchRecords,
+                          const std::vector<IvyAreaRecord>&   areaRecords,
+                          const std::vector<uint32_t>&        slots,
+                          const char*                         step)
+{
+    Check(buffer.GetRecordCount() == branchRecords.size() + areaRecords.size(), "%s: record count", step);
+
+    IvyMultiNodeGpuInput multiNodeInput;
+    std::memcpy(&multiNodeInput, buffer.GetData() + buffer.GetMultiNodeInputAddress() - testGpuAddress, sizeof(multiNodeInput));
+    Check(multiNodeInput.NumNodeInputs == buffer.GetNodeInputCount(), "%s: node inputs", step);
+
+    size_t dispatched = 0;
+    for (uint32_t input = 0; input < multiNodeInput.NumNodeInputs; ++input)
+    {
+        IvyNodeGpuInput nodeInput;
+        const uint64_t  nodeInputAddress = multiNodeInput.NodeInputs.StartAddress + input * multiNodeInput.NodeInputs.StrideInBytes;
+        std::memcpy(&nodeInput, buffer.GetData() + nodeInputAddress - testGpuAddress, sizeof(nodeInput));
+
+        for (uint32_t index = 0; (index < nodeInput.NumRecords) && Check(dispatched < slots.size(), "%s: dispatched records", step); ++index, ++dispatched)
+        {
+            const uint32_t slot = slots[dispatched];
+            const bool     area = (slot >= branchRecords.size());
+
+            // the buffer writes the slot to the partition of the record
+            IvyBranchRecord branchRecord = area ? IvyBranchRecord{} : branchRecords[slot];
+            IvyAreaRecord   areaRecord   = area ? areaRecords[slot - branchRecords.size()] : IvyAreaRecord{};
+            branchRecord.partition       = slot;
+            areaRecord.partition         = slot;
+
+            const void*    record     = area ? static_cast<const void*>(&areaRecord) : &branchRecord;
+            const uint32_t recordSize = area ? sizeof(IvyAreaRecord) : sizeof(IvyBranchRecord);
+            const uint64_t address    = nodeInput.Records.StartAddress + index * nodeInput.Records.StrideInBytes;
+
+            Check(buffer.GetType(slot) == (area ? IvyEntryRecordType::Area : IvyEntryRecordType::Branch), "%s: type of slot %u", step, slot);
+            Check(nodeInput.EntrypointIndex == (area ? testAreaEntrypoint : testBranchEntrypoint), "%s: entrypoint of slot %u", step, slot);
+            Check(std::memcmp(buffer.GetData() + address - testGpuAddress, record, recordSize) == 0, "%s: record of slot %u", step, slot);
+        }
+    }
+    Check(dispatched == slots.size(), "%s: %zu of %zu records dispatched", step, dispatched, slots.size());
+}
+
+static std::vector<uint32_t> GetAllSlots(const IvyEntryRecordBuffer& buffer)
+{
+    std::vector<uint32_t> slots(buffer.GetRecordCount());
+    for (uint32_t slot = 0; slot < buffer.GetRecordCount(); ++slot)
+    {
+        slots[slot] = slot;
+    }
+    return slots;
+}
+
+static uint64_t GetDirtyBytes(const IvyEntryRecordBuffer& buffer)
+{
+    uint64_t dirtyBytes = 0;
+    for (const IvyEntryRecordBuffer::Range& range : buffer.GetDirtyRanges())
+    {
+        dirtyBytes += range.Size;
+    }
+    return dirtyBytes;
+}
+
+int main()
+{
+    std::vector<IvyBranchRecord> branchRecords;
+    std::vector<IvyAreaRecord>   areaRecords;
+    GetDefaultRecords(branchRecords, areaRecords);
+    if (!Check(!branchRecords.empty() && !areaRecords.empty(), "default branch & area records"))
+    {
+        return GetTestExitCode("IvyEntryRecordBufferTest");
+    }
+
+    IvyEntryRecordBuffer buffer;
+    buffer.SetEntrypoints(testBranchEntrypoint, testAreaEntrypoint);
+    buffer.SetGpuAddress(testGpuAddress);
+
+    // all records in one dispatch, one node input for the branch records & one for the area records
+    buffer.Assign(branchRecords, areaRecords);
+    buffer.SetDispatchSlots(GetAllSlots(buffer));
+    CheckDispatch(buffer, branchRecords, areaRecords, GetAllSlots(buffer), "Assign");
+    Check(buffer.GetNodeInputCount() == 2, "one node input per run of records of the same type");
+    buffer.ClearDirtyRanges();
+
+    // unchanged records & dispatches are not uploaded again
+    buffer.Assign(branchRecords, areaRecords);
+    buffer.SetDispatchSlots(GetAllSlots(buffer));
+    Check(!buffer.IsDirty() && buffer.GetDirtyRanges().empty(), "assigning the same records marks nothing dirty");
+
+    // an edit uploads the slot of the edited record & the inputs that dispatch it
+    const uint32_t editedSlot = static_cast<uint32_t>(branchRecords.size());
+    areaRecords[0].seed += 1;
+    buffer.Assign(branchRecords, areaRecords);
+    buffer.SetDispatchSlots({editedSlot});
+    const std::vector<IvyEntryRecordBuffer::Range> editRanges = buffer.GetDirtyRanges();
+    Check((editRanges.size() == 2) && (editRanges[0].Size == sizeof(IvyMultiNodeGpuInput) + sizeof(IvyNodeGpuInput)) &&
+              (editRanges[1].Size == IvyEntryRecordBuffer::RecordSlotSize),
+          "an edit uploads one record slot & its inputs");
+    CheckDispatch(buffer, branchRecords, areaRecords, {editedSlot}, "edit");
+    buffer.ClearDirtyRanges();
+
+    // slots that are not adjacent need separate node inputs
+    buffer.SetDispatchSlots({0, editedSlot});
+    CheckDispatch(buffer, branchRecords, areaRecords, {0, editedSlot}, "sparse dispatch");
+    Check(buffer.GetNodeInputCount() == 2, "sparse dispatch: node inputs");
+    buffer.ClearDirtyRanges();
+
+    // a new GPU buffer needs all inputs & records
+    buffer.SetGpuAddress(testGpuAddress);
+    Check(GetDirtyBytes(buffer) == (1 + buffer.GetNodeInputCount()) * sizeof(IvyNodeGpuInput) + buffer.GetRecordCount() * IvyEntryRecordBuffer::RecordSlotSize,
+          "SetGpuAddress uploads all inputs & records");
+    buffer.ClearDirtyRanges();
+
+    // removing a record moves the records of later slots down & changes their partition
+    const uint32_t removedSlot = static_cast<uint32_t>(branchRecords.size()) - 1;
+    buffer.Remove(removedSlot);
+    branchRecords.pop_back();
+    buffer.SetDispatchSlots(GetAllSlots(buffer));
+    CheckDispatch(buffer, branchRecords, areaRecords, GetAllSlots(buffer), "Remove");
+    Check(buffer.GetType(buffer.GetRecordCount()) == IvyEntryRecordType::None, "the slot after the last record is empty");
+    buffer.ClearDirtyRanges();
+
+    // the capacity grows with the records
+    IvyEntryRecordBuffer smallBuffer(1);
+    smallBuffer.SetEntrypoints(testBranchEntrypoint, testAreaEntrypoint);
+    smallBuffer.SetGpuAddress(testGpuAddress);
+    const uint64_t smallSize = smallBuffer.GetSize();
+    Check(smallBuffer.Add(branchRecords[0]) == 0, "a record fits into a buffer of capacity 1");
+    Check(smallBuffer.Add(areaRecords[0]) == 1, "a full buffer grows");
+    Check((smallBuffer.GetCapacity() >= 2) && (smallBuffer.GetSize() > smallSize), "a full buffer grows: capacity");
+    smallBuffer.SetGpuAddress(testGpuAddress);
+    smallBuffer.SetDispatchSlots({0, 1});
+    CheckDispatch(smallBuffer, {branchRecords[0]}, {areaRecords[0]}, {0, 1}, "growth");
+
+    return GetTestExitCode("IvyEntryRecordBufferTest");
+}
@@ -0,0 +1,85 @@
+// This file is part of the AMD Work Graph Ivy Generation Sample.
+//
+// Copyright (c) 2024 Advanced Micro Devices, Inc. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+// Culls the generated instances for the cameras of IvyBenchmark --frustum-culling and checks that every culled
+// instance lies outside of the clip volume with all corners of its mesh bounds.
+
+#include "testutils.h"
+
+#include "benchmark/cullingutils.h"
+#include "cpu/ivyinstanceculling.h"
+
+#include <cinttypes>
+#include <vector>
+
+int main()
+{
+    IvyCpuScene        scene;
+    IvyInstanceStreams output;
+    if (!GenerateTestIvy(scene, output))
+    {
+        return 1;
+    }
+
+    const std::vector<IvyInstanceData>* streams[2]    = {&output.LeafInstances, &output.StemInstances};
+    const IvyAabb                       meshBounds[2] = {scene.GetSurfaceBounds(scene.GetIvyLeafSurfaceIndex()),
+                                                         scene.GetSurfaceBounds(scene.GetIvyStemSurfaceIndex())};
+
+    uint64_t              visibleCount = 0;
+    uint64_t              culledCount  = 0;
+    std::vector<uint32_t> visibleInstances;
+    for (const CullingCamera& camera : GetCullingCameras(output))
+    {
+        const float4x4   viewProjection = ComputeViewProjection(camera.Eye, camera.Target);
+        const IvyFrustum frustum        = IvyFrustum::FromViewProjection(viewProjection);
+
+        for (uint32_t stream = 0; stream < 2; ++stream)
+        {
+            const std::vector<IvyInstanceData>& instances   = *streams[stream];
+            const float4                        localSphere = IvyGetLocalBoundingSphere(meshBounds[stream].Min, meshBounds[stream].Max);
+
+            visibleInstances.clear();
+            IvyCullInstances(frustum, localSphere, instances, visibleInstances);
+            visibleCount += visibleInstances.size();
+            culledCount += instances.size() - visibleInstances.size();
+
+            // visibleInstances is sorted, all other instances were culled
+            size_t   visible   = 0;
+            uint32_t misculled = 0;
+            for (uint32_t i = 0; i < instances.size(); ++i)
+            {
+                if ((visible < visibleInstances.size()) && (visibleInstances[visible] == i))
+                {
+                    ++visible;
+                    continue;
+                }
+                misculled += IvyIsBoxOutsideClipVolume(viewProjection, Affine::ToFloat3x4(instances[i].transform), meshBounds[stream].Min, meshBounds[stream].Max) ? 0 : 1;
+            }
+            Check(misculled == 0, "%s: %u culled %s instances intersect the clip volume", camera.Name, misculled, (stream == 0) ? "leaf" : "stem");
+        }
+    }
+
+    // the cameras have to see part of the ivy & miss another part, otherwise the test checks nothing
+    Check((visibleCount > 0) && (culledCount > 0), "the cameras keep %" PRIu64 " & cull %" PRIu64 " instances", visibleCount, culledCount);
+
+    return GetTestExitCode("IvyFrustumCullingTest");
+}
@@ -0,0 +1,119 @@
+// This file is part of the AMD Work Graph Ivy Generation Sample.
+//
+// Copyright (c) 2024 Advanced Micro Devices, Inc. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+// Builds the instance clusters of the GPU pass & the clusters per IvyBranch thread group, checks that they cover & bound
+// their instances and that culling the clusters first finds the same visible instances as culling every instance, for the
+// cameras of IvyBenchmark --frustum-culling with & without a Hi-Z pyramid.
+
+#include "testutils.h"
+
+#include "benchmark/cullingutils.h"
+#include "cpu/ivycpuhiz.h"
+#include "cpu/ivyinstanceclusters.h"
+
+#include <algorithm>
+#include <cinttypes>
+#include <vector>
+
+int main()
+{
+    IvyCpuScene        scene;
+    IvyInstanceStreams output;
+    if (!GenerateTestIvy(scene, output))
+    {
+        return 1;
+    }
+
+    const char*                          streamNames[2] = {"leaf", "stem"};
+    const std::vector<IvyInstanceData>*  streams[2]     = {&output.LeafInstances, &output.StemInstances};
+    const std::vector<IvyInstanceRange>* groupRanges[2] = {&output.LeafGroupRanges, &output.StemGroupRanges};
+    const IvyAabb                        meshBounds[2]  = {scene.GetSurfaceBounds(scene.GetIvyLeafSurfaceIndex()),
+                                                           scene.GetSurfaceBounds(scene.GetIvyStemSurfaceIndex())};
+
+    float4                          localSpheres[2];
+    std::vector<IvyInstanceCluster> clusters[2];  // runs of the draw buffers, like the GPU pass
+    for (uint32_t stream = 0; stream < 2; ++stream)
+    {
+        localSpheres[stream] = IvyGetLocalBoundingSphere(meshBounds[stream].Min, meshBounds[stream].Max);
+
+        const std::vector<IvyInstanceRange> runRange = {IvyInstanceRange{0, static_cast<uint32_t>(streams[stream]->size())}};
+        IvyBuildInstanceClusters(*streams[stream], localSpheres[stream], runRange, clusters[stream]);
+        Check(IvyValidateInstanceClusters(*streams[stream], localSpheres[stream], clusters[stream]), "%s run clusters", streamNames[stream]);
+
+        std::vector<IvyInstanceCluster> groupClusters;
+        IvyBuildInstanceClusters(*streams[stream], localSpheres[stream], *groupRanges[stream], groupClusters);
+        Check(!groupRanges[stream]->empty() && IvyValidateInstanceClusters(*streams[stream], localSpheres[stream], groupClusters),
+              "%s group clusters", streamNames[stream]);
+    }
+
+    uint64_t              culledClusters = 0;
+    std::vector<uint32_t> visibleInstances;
+    std::vector<uint32_t> unoccludedInstances;
+    std::vector<uint32_t> clusterVisibleInstances;
+    std::vector<float>    depth;
+    IvyCpuHiZPyramid      hiZPyramid;
+    for (const CullingCamera& camera : GetCullingCameras(output))
+    {
+        const float4x4   viewProjection = ComputeViewProjection(camera.Eye, camera.Target);
+        const IvyFrustum frustum        = IvyFrustum::FromViewProjection(viewProjection);
+
+        RenderDepth(scene, camera.Eye, camera.Target, viewProjection, depth);
+        AddDepthWall(camera.Eye, camera.Target, viewProjection, 0.5f * length(camera.Target - camera.Eye), depth);
+        hiZPyramid.Build(depth.data(), cullingDepthWidth, cullingDepthHeight);
+
+        for (bool occlusionCulling : {false, true})
+        {
+            for (uint32_t stream = 0; stream < 2; ++stream)
+            {
+                const std::vector<IvyInstanceData>& instances = *streams[stream];
+
+                visibleInstances.clear();
+                IvyCullInstances(frustum, localSpheres[stream], instances, visibleInstances);
+
+                unoccludedInstances.clear();
+                for (uint32_t index : visibleInstances)
+                {
+                    const float4 sphere = IvyGetInstanceBoundingSphere(Affine::ToFloat3x4(instances[index].transform), localSpheres[stream]);
+                    if (!occlusionCulling || !hiZPyramid.IsSphereOccluded(viewProjection, sphere))
+                    {
+                        unoccludedInstances.push_back(index);
+                    }
+                }
+
+                // A cluster sphere encloses the spheres of its instances, so it is only culled if all of them are
+                clusterVisibleInstances.clear();
+                const IvyClusterCullingStatistics statistics = IvyCullInstanceClusters(
+                    frustum, occlusionCulling ? &hiZPyramid : nullptr, viewProjection, localSpheres[stream], instances, clusters[stream], clusterVisibleInstances);
+                std::sort(clusterVisibleInstances.begin(), clusterVisibleInstances.end());
+                culledClusters += clusters[stream].size() - statistics.VisibleClusters;
+
+                Check(clusterVisibleInstances == unoccludedInstances, "%s%s: culling the %s clusters first finds %zu instances instead of %zu", camera.Name,
+                      occlusionCulling ? " with Hi-Z" : "", streamNames[stream], clusterVisibleInstances.size(), unoccludedInstances.size());
+            }
+        }
+    }
+
+    // otherwise the test checks nothing
+    Check(culledClusters > 0, "the cameras cull %" PRIu64 " clusters", culledClusters);
+
+    return GetTestExitCode("IvyInstanceClustersTest");
+}
@@ -0,0 +1,150 @@
+// This file is part of the AMD Work Graph Ivy Generation Sample.
+//
+// Copyright (c) 2024 Advanced Micro Devices, Inc. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+// Bakes the leaf impostor atlas twice & checks that the bakes are identical, builds & checks the impostor quads of the
+// leaf clusters, and checks for the cameras of IvyBenchmark --frustum-culling that the clusters drawn as impostors & the
+// leaf instances drawn as geometry together are exactly the visible leaf instances.
+
+#include "testutils.h"
+
+#include "benchmark/cullingutils.h"
+#include "cpu/ivycpuhiz.h"
+#include "cpu/ivyinstanceclusters.h"
+#include "cpu/ivyleafimpostoratlas.h"
+#include "cpu/ivyleafimpostors.h"
+
+#include <algorithm>
+#include <cinttypes>
+#include <vector>
+
+static void CheckAtlas(const IvyMeshData& leafMesh)
+{
+    IvyLeafImpostorAtlas firstBake;
+    IvyLeafImpostorAtlas secondBake;
+    IvyBakeLeafImpostorAtlas(leafMesh, IvyLeafImpostorAtlasSettings(), firstBake);
+    IvyBakeLeafImpostorAtlas(leafMesh, IvyLeafImpostorAtlasSettings(), secondBake);
+
+    Check((IvyGetLeafImpostorAtlasChecksum(firstBake) == IvyGetLeafImpostorAtlasChecksum(secondBake)) && (firstBake.Texels == secondBake.Texels),
+          "the atlas bakes are identical");
+    Check(IvyGetLeafImpostorAtlasCoverage(firstBake) > 0.f, "the atlas covers leaves");
+}
+
+// Culls the leaf clusters with impostors, every visible leaf instance (visibleInstances, sorted) has to be drawn once,
+// either as geometry or by an impostor cluster. Returns the number of impostor clusters.
+static uint32_t CheckImpostorCulling(const IvyFrustum&                      frustum,
+                                     const IvyCpuHiZPyramid*                pHiZPyramid,
+                                     const float4x4&                        viewProjection,
+                                     const float4&                          localSphere,
+                                     const std::vector<IvyInstanceData>&    instances,
+                                     const std::vector<IvyInstanceCluster>& clusters,
+                                     const std::vector<uint32_t>&           visibleInstances,
+                                     const char*                            cameraName)
+{
+    std::vector<uint32_t> geometryInstances;
+    std::vector<uint32_t> impostorClusters;
+    IvyCullInstanceClusters(frustum, pHiZPyramid, viewProjection, localSphere, instances, clusters, geometryInstances, impostorDistance, &impostorClusters);
+
+    std::vector<uint32_t> drawCount(instances.size(), 0);
+    for (uint32_t index : geometryInstances)
+    {
+        ++drawCount[index];
+    }
+    for (uint32_t cluster : impostorClusters)
+    {
+        for (uint32_t i = clusters[cluster].firstInstance; i < clusters[cluster].firstInstance + clusters[cluster].instanceCount; ++i)
+        {
+            ++drawCount[i];
+        }
+    }
+
+    uint32_t missing = 0;
+    for (uint32_t index : visibleInstances)
+    {
+        missing += (drawCount[index] == 1) ? 0 : 1;
+    }
+    std::sort(geometryInstances.begin(), geometryInstances.end());
+
+    const char* hiZName = pHiZPyramid ? " with Hi-Z" : "";
+    Check(missing == 0, "%s%s: %u visible leaf instances are not drawn exactly once", cameraName, hiZName, missing);
+    Check(std::includes(visibleInstances.begin(), visibleInstances.end(), geometryInstances.begin(), geometryInstances.end()),
+          "%s%s: only visible leaf instances are drawn as geometry", cameraName, hiZName);
+
+    return static_cast<uint32_t>(impostorClusters.size());
+}
+
+int main()
+{
+    IvyMeshData leafMesh;
+    if (ReadTestMesh("Leaf", leafMesh))
+    {
+        CheckAtlas(leafMesh);
+    }
+
+    IvyCpuScene        scene;
+    IvyInstanceStreams output;
+    if (!GenerateTestIvy(scene, output))
+    {
+        return 1;
+    }
+
+    const std::vector<IvyInstanceData>& instances   = output.LeafInstances;
+    const IvyAabb                       meshBounds  = scene.GetSurfaceBounds(scene.GetIvyLeafSurfaceIndex());
+    const float4                        localSphere = IvyGetLocalBoundingSphere(meshBounds.Min, meshBounds.Max);
+
+    // runs of the draw buffer, like the GPU pass
+    const std::vector<IvyInstanceRange> runRange = {IvyInstanceRange{0, static_cast<uint32_t>(instances.size())}};
+    std::vector<IvyInstanceCluster>     clusters;
+    std::vector<IvyLeafImpostorQuad>    quads;
+    IvyBuildInstanceClusters(instances, localSphere, runRange, clusters);
+    IvyBuildLeafImpostorQuads(instances, localSphere, clusters, quads);
+    Check(IvyValidateLeafImpostorQuads(instances, localSphere, clusters, quads), "the impostor quads cover the leaves of their groups");
+
+    uint64_t              impostorClusterCount = 0;
+    std::vector<uint32_t> visibleInstances;
+    std::vector<float>    depth;
+    IvyCpuHiZPyramid      hiZPyramid;
+    for (const CullingCamera& camera : GetCullingCameras(output))
+    {
+        const float4x4   viewProjection = ComputeViewProjection(camera.Eye, camera.Target);
+        const IvyFrustum frustum        = IvyFrustum::FromViewProjection(viewProjection);
+
+        RenderDepth(scene, camera.Eye, camera.Target, viewProjection, depth);
+        AddDepthWall(camera.Eye, camera.Target, viewProjection, 0.5f * length(camera.Target - camera.Eye), depth);
+        hiZPyramid.Build(depth.data(), cullingDepthWidth, cullingDepthHeight);
+
+        for (bool occlusionCulling : {false, true})
+        {
+            const IvyCpuHiZPyramid* pHiZPyramid = occlusionCulling ? &hiZPyramid : nullptr;
+
+            visibleInstances.clear();
+            IvyCullInstanceClusters(frustum, pHiZPyramid, viewProjection, localSphere, instances, clusters, visibleInstances);
+            std::sort(visibleInstances.begin(), visibleInstances.end());
+
+            impostorClusterCount += CheckImpostorCulling(frustum, pHiZPyramid, viewProjection, localSphere, instances, clusters, visibleInstances, camera.Name);
+        }
+    }
+
+    // otherwise the test checks nothing
+    Check(impostorClusterCount > 0, "the cameras draw %" PRIu64 " clusters as impostors", impostorClusterCount);
+
+    return GetTestExitCode("IvyLeafImpostorsTest");
+}
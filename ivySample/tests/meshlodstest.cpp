@@ -0,0 +1,75 @@
+// This file is part of the AMD Work Graph Ivy Generation Sample.
+//
+// Copyright (c) 2024 Advanced Micro Devices, Inc. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+// Builds the LOD chains of the leaf & stem meshes like IvyRenderModule::LoadMeshLods and checks that every LOD has fewer
+// triangles than the previous one, valid indices & an error that does not decrease along the chain.
+
+#include "testutils.h"
+
+#include "cpu/ivymeshsimplifier.h"
+
+static void CheckLodChain(const char* meshName)
+{
+    IvyMeshData mesh;
+    if (!ReadTestMesh(meshName, mesh))
+    {
+        return;
+    }
+
+    IvyMeshLodChain chain;
+    IvyBuildMeshLodChain(mesh, IvyMeshLodSettings(), chain);
+
+    // the ivy meshes can be simplified at least once
+    if (!Check(chain.Lods.size() > 1, "%s: %zu LODs", meshName, chain.Lods.size()))
+    {
+        return;
+    }
+    Check((chain.Lods[0].IndexCount == mesh.Indices.size()) && (chain.Lods[0].Error == 0.f), "%s: LOD 0 is the unmodified mesh", meshName);
+    Check(chain.Normals.size() == chain.Positions.size(), "%s: a normal per vertex", meshName);
+
+    for (size_t lod = 0; lod < chain.Lods.size(); ++lod)
+    {
+        const IvyMeshLod& current = chain.Lods[lod];
+        if (lod > 0)
+        {
+            Check(current.IndexCount < chain.Lods[lod - 1].IndexCount, "%s: LOD %zu does not reduce the triangles", meshName, lod);
+            Check(current.Error >= chain.Lods[lod - 1].Error, "%s: the error of LOD %zu decreases", meshName, lod);
+        }
+        Check((current.IndexCount > 0) && (current.IndexCount % 3 == 0), "%s: LOD %zu has %u indices", meshName, lod, current.IndexCount);
+        Check(current.BaseVertex + current.VertexCount <= chain.Positions.size() / 3, "%s: vertices of LOD %zu", meshName, lod);
+
+        uint32_t invalidIndices = 0;
+        for (uint32_t i = 0; i < current.IndexCount; ++i)
+        {
+            invalidIndices += (chain.Indices[current.FirstIndex + i] < current.VertexCount) ? 0 : 1;
+        }
+        Check(invalidIndices == 0, "%s: %u invalid indices in LOD %zu", meshName, invalidIndices, lod);
+    }
+}
+
+int main()
+{
+    CheckLodChain("Leaf");
+    CheckLodChain("Stem");
+
+    return GetTestExitCode("IvyMeshLodsTest");
+}
@@ -0,0 +1,97 @@
+// This file is part of the AMD Work Graph Ivy Generation Sample.
+//
+// Copyright (c) 2024 Advanced Micro Devices, Inc. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+// Tests the instances within the frustum of the IvyBenchmark --frustum-culling cameras against a Hi-Z pyramid of the
+// scene depth and checks that the pyramid only occludes instances that are behind every pixel of the depth buffer they
+// cover. media/Ivy/ivy.gltf hardly occludes its own ivy, so every camera is also tested with a wall in front of half of
+// its view.
+
+#include "testutils.h"
+
+#include "benchmark/cullingutils.h"
+#include "cpu/ivycpuhiz.h"
+#include "cpu/ivyinstanceculling.h"
+
+#include <cinttypes>
+#include <vector>
+
+int main()
+{
+    IvyCpuScene        scene;
+    IvyInstanceStreams output;
+    if (!GenerateTestIvy(scene, output))
+    {
+        return 1;
+    }
+
+    const std::vector<IvyInstanceData>* streams[2]    = {&output.LeafInstances, &output.StemInstances};
+    const IvyAabb                       meshBounds[2] = {scene.GetSurfaceBounds(scene.GetIvyLeafSurfaceIndex()),
+                                                         scene.GetSurfaceBounds(scene.GetIvyStemSurfaceIndex())};
+
+    uint64_t              occludedCount = 0;
+    std::vector<uint32_t> visibleInstances;
+    std::vector<float>    depth;
+    IvyCpuHiZPyramid      hiZPyramid;
+    for (const CullingCamera& camera : GetCullingCameras(output))
+    {
+        const float4x4   viewProjection = ComputeViewProjection(camera.Eye, camera.Target);
+        const IvyFrustum frustum        = IvyFrustum::FromViewProjection(viewProjection);
+
+        for (bool wall : {false, true})
+        {
+            RenderDepth(scene, camera.Eye, camera.Target, viewProjection, depth);
+            if (wall)
+            {
+                AddDepthWall(camera.Eye, camera.Target, viewProjection, 0.5f * length(camera.Target - camera.Eye), depth);
+            }
+            hiZPyramid.Build(depth.data(), cullingDepthWidth, cullingDepthHeight);
+
+            for (uint32_t stream = 0; stream < 2; ++stream)
+            {
+                const std::vector<IvyInstanceData>& instances   = *streams[stream];
+                const float4                        localSphere = IvyGetLocalBoundingSphere(meshBounds[stream].Min, meshBounds[stream].Max);
+
+                visibleInstances.clear();
+                IvyCullInstances(frustum, localSphere, instances, visibleInstances);
+
+                // The pyramid may only miss occluded instances, never occlude visible ones
+                uint32_t misoccluded = 0;
+                for (uint32_t index : visibleInstances)
+                {
+                    const float4 sphere = IvyGetInstanceBoundingSphere(Affine::ToFloat3x4(instances[index].transform), localSphere);
+                    if (hiZPyramid.IsSphereOccluded(viewProjection, sphere))
+                    {
+                        ++occludedCount;
+                        misoccluded += IvyIsSphereOccludedByDepth(depth.data(), cullingDepthWidth, cullingDepthHeight, viewProjection, sphere) ? 0 : 1;
+                    }
+                }
+                Check(misoccluded == 0, "%s%s: %u %s instances are occluded by the Hi-Z pyramid, but not by the depth buffer", camera.Name,
+                      wall ? " with wall" : "", misoccluded, (stream == 0) ? "leaf" : "stem");
+            }
+        }
+    }
+
+    // otherwise the test checks nothing
+    Check(occludedCount > 0, "the Hi-Z pyramid occludes %" PRIu64 " instances", occludedCount);
+
+    return GetTestExitCode("IvyOcclusionCullingTest");
+}
@@ -0,0 +1,117 @@
+// This file is part of the AMD Work Graph Ivy Generation Sample.
+//
+// Copyright (c) 2024 Advanced Micro Devices, Inc. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+#pragma once
+
+// Checks & scene setup shared by the headless tests, run from the repository root so that media/ resolves.
+
+#include "benchmark/benchmarkutils.h"
+#include "cpu/ivygltfdocument.h"
+
+#include <cstdarg>
+#include <cstdint>
+#include <cstdio>
+
+inline uint32_t& GetTestFailureCount()
+{
+    static uint32_t failureCount = 0;
+    return failureCount;
+}
+
+/**
+ * @brief   Prints the formatted description of a failed check and counts it, returns condition.
+ */
+inline bool Check(bool condition, const char* format, ...)
+{
+    if (!condition)
+    {
+        va_list arguments;
+        va_start(arguments, format);
+        fprintf(stderr, "FAILED: ");
+        vfprintf(stderr, format, arguments);
+        fprintf(stderr, "\n");
+        va_end(arguments);
+
+        ++GetTestFailureCount();
+    }
+    return condition;
+}
+
+/**
+ * @brief   Exit code of the test, 1 if any check failed.
+ */
+inline int GetTestExitCode(const char* testName)
+{
+    const uint32_t failureCount = GetTestFailureCount();
+    if (failureCount > 0)
+    {
+        fprintf(stderr, "%s: %u checks failed\n", testName, failureCount);
+        return 1;
+    }
+    printf("%s passed\n", testName);
+    return 0;
+}
+
+/**
+ * @brief   Loads & builds media/Ivy/ivy.gltf, which holds the leaf & stem meshes, and generates the default entry records.
+ */
+inline bool GenerateTestIvy(IvyCpuScene& scene, IvyInstanceStreams& output, bool deterministic = false)
+{
+    if (!LoadBenchmarkScenes({"media/Ivy/ivy.gltf"}, scene))
+    {
+        return false;
+    }
+    scene.Build();
+
+    if (!Check((scene.GetIvyStemSurfaceIndex() >= 0) && (scene.GetIvyLeafSurfaceIndex() >= 0), "media/Ivy/ivy.gltf holds the Stem & Leaf meshes"))
+    {
+        return false;
+    }
+
+    std::vector<IvyBranchRecord> branchRecords;
+    std::vector<IvyAreaRecord>   areaRecords;
+    GetDefaultRecords(branchRecords, areaRecords);
+
+    IvyCpuEngine engine(scene);
+    engine.SetDeterministicOrder(deterministic);
+    engine.DispatchGraph(branchRecords, areaRecords, output);
+
+    return Check(!output.LeafInstances.empty() && !output.StemInstances.empty(), "the default entry records generate leaf & stem instances");
+}
+
+/**
+ * @brief   Reads the first surface of a mesh of media/Ivy/ivy.gltf ("Leaf" or "Stem"), like IvyRenderModule::LoadMeshLods.
+ */
+inline bool ReadTestMesh(const char* meshName, IvyMeshData& mesh)
+{
+    IvyGltfDocument          document;
+    std::vector<IvyMeshData> surfaces;
+    std::string              error;
+    const bool               found = document.Load("media/Ivy/ivy.gltf", &error) && (document.FindMesh(meshName) >= 0) &&
+                       document.ReadMesh(document.FindMesh(meshName), surfaces, &error) && !surfaces.empty();
+    if (!Check(found, "read the %s mesh of media/Ivy/ivy.gltf: %s", meshName, error.c_str()))
+    {
+        return false;
+    }
+    mesh = surfaces[0];
+    return true;
+}